@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the client itself, so its internal static functions are visible here. Its main() is renamed
+// out of the way.
+#define main ccnxSimpleFileTransferClient_Main
+#include "../ccnxSimpleFileTransfer_Client.c"
+#undef main
+
+#include <ccnx/common/ccnx_NameSegmentNumber.h>
+
+#include "ccnxSimpleFileTransfer_BenchClient.h"
+
+CCNxSimpleFileTransferBenchClient *
+ccnxSimpleFileTransferBenchClient_Create(const char *fileName, const char *outputPath, bool doRequestCompression)
+{
+    ClientState *result = parcMemory_AllocateAndClear(sizeof(ClientState));
+    assertNotNull(result, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(ClientState));
+
+    result->namePrefix = ccnxName_CreateFromCString(ccnxSimpleFileTransferCommon_NamePrefix);
+    result->commandArg[0] = (char *) ccnxSimpleFileTransferCommon_CommandFetch;
+    result->commandArg[1] = parcMemory_StringDuplicate(fileName, strlen(fileName));
+    result->streamFileDescriptor = -1;
+    result->doSaveToDisk = (outputPath != NULL);
+    result->doRequestCompression = doRequestCompression;
+    if (outputPath != NULL) {
+        result->outputPath = parcMemory_StringDuplicate(outputPath, strlen(outputPath));
+    }
+
+    return result;
+}
+
+void
+ccnxSimpleFileTransferBenchClient_Destroy(CCNxSimpleFileTransferBenchClient **clientPtr)
+{
+    ClientState *client = *clientPtr;
+
+    if (client->fileWriter != NULL) {
+        // The transfer didn't complete, so the sink is still open.
+        _closeFileSink(client, client->commandArg[1]);
+    }
+
+    ccnxName_Release(&client->namePrefix);
+    parcMemory_Deallocate((void **) &client->commandArg[1]);
+    if (client->outputPath != NULL) {
+        parcMemory_Deallocate((void **) &client->outputPath);
+    }
+    if (client->compressor != NULL) {
+        ccnxSimpleFileTransferCompressor_Release(&client->compressor);
+    }
+    if (client->chunkDigests != NULL) {
+        ccnxSimpleFileTransferChunkDigests_Release(&client->chunkDigests);
+    }
+    parcMemory_Deallocate((void **) clientPtr);
+}
+
+/**
+ * Given an Interest the client would send, create the Interest for a chunk of its answer, as the chunked Portal
+ * stack does. The given Interest is released.
+ */
+static CCNxInterest *
+_createChunkInterest(CCNxInterest **interestPtr, uint64_t chunkNumber)
+{
+    CCNxName *chunkName = ccnxName_Copy(ccnxInterest_GetName(*interestPtr));
+    ccnxInterest_Release(interestPtr);
+
+    CCNxNameSegment *chunkSegment = ccnxNameSegmentNumber_Create(CCNxNameLabelType_CHUNK, chunkNumber);
+    ccnxName_Append(chunkName, chunkSegment);
+    ccnxNameSegment_Release(&chunkSegment);
+
+    CCNxInterest *result = ccnxInterest_CreateSimple(chunkName);
+    ccnxName_Release(&chunkName);
+
+    return result;
+}
+
+CCNxInterest *
+ccnxSimpleFileTransferBenchClient_CreateStatInterest(CCNxSimpleFileTransferBenchClient *client)
+{
+    // The chunked Portal stack asks for chunk 0 of the 'stat' response, which is all there is.
+    CCNxInterest *statInterest = _createInterestForCommand(client->namePrefix, ccnxSimpleFileTransferCommon_CommandStat,
+                                                           client->commandArg[1], 0);
+    return _createChunkInterest(&statInterest, 0);
+}
+
+bool
+ccnxSimpleFileTransferBenchClient_ReceiveStat(CCNxSimpleFileTransferBenchClient *client, CCNxContentObject *contentObject)
+{
+    uint64_t version = 0;
+    uint64_t fileSize = 0;
+
+    bool result = _isResponseToCommand(contentObject, client->namePrefix, ccnxSimpleFileTransferCommon_CommandStat)
+                  && ccnxSimpleFileTransferCommon_ParseStatPayload(ccnxContentObject_GetPayload(contentObject),
+                                                                   &version, &fileSize);
+    if (result) {
+        client->fileVersion = version;
+        client->fileSize = fileSize;
+    }
+
+    return result;
+}
+
+bool
+ccnxSimpleFileTransferBenchClient_FetchDigests(CCNxSimpleFileTransferBenchClient *client,
+                                               CCNxSimpleFileTransferLoopbackProducer *producer, void *producerContext)
+{
+    CCNxSimpleFileTransferReorderBuffer *reorderBuffer = ccnxSimpleFileTransferReorderBuffer_Create(_reorderWindowSize);
+    PARCBufferComposer *composer = parcBufferComposer_Create();
+
+    bool isComplete = false;
+    for (uint64_t chunkNumber = 0; !isComplete; chunkNumber++) {
+        CCNxInterest *digestsInterest = _createInterestForCommand(client->namePrefix,
+                                                                  ccnxSimpleFileTransferCommon_CommandDigests,
+                                                                  client->commandArg[1], client->fileVersion);
+        CCNxInterest *interest = _createChunkInterest(&digestsInterest, chunkNumber);
+        CCNxContentObject *response = producer(producerContext, interest);
+        ccnxInterest_Release(&interest);
+
+        if (response == NULL) {
+            break;
+        }
+        isComplete = _receiveFileSummaryChunk(client, client->namePrefix, ccnxSimpleFileTransferCommon_CommandDigests,
+                                              response, reorderBuffer, composer);
+        ccnxContentObject_Release(&response);
+    }
+
+    if (isComplete) {
+        PARCBuffer *buffer = parcBufferComposer_ProduceBuffer(composer);
+        client->chunkDigests = ccnxSimpleFileTransferChunkDigests_CreateFromBuffer(buffer);
+        parcBuffer_Release(&buffer);
+    }
+
+    parcBufferComposer_Release(&composer);
+    ccnxSimpleFileTransferReorderBuffer_Release(&reorderBuffer);
+
+    return client->chunkDigests != NULL;
+}
+
+CCNxInterest *
+ccnxSimpleFileTransferBenchClient_CreateChunkInterest(CCNxSimpleFileTransferBenchClient *client, uint64_t chunkNumber)
+{
+    // Build the same Interest the client sends: the file's name, then the chunk segment.
+    CCNxInterest *fileInterest = _createInterestForCommand(client->namePrefix, _getFetchCommand(client),
+                                                           client->commandArg[1], client->fileVersion);
+    return _createChunkInterest(&fileInterest, chunkNumber);
+}
+
+CCNxSimpleFileTransferFetchWindow *
+ccnxSimpleFileTransferBenchClient_CreateFetchWindow(const CCNxSimpleFileTransferBenchClient *client, size_t windowSize,
+                                                    uint64_t initialRtoMicros, uint64_t nowMicros)
+{
+    return _createFetchWindow(windowSize, initialRtoMicros, nowMicros);
+}
+
+bool
+ccnxSimpleFileTransferBenchClient_Receive(CCNxSimpleFileTransferBenchClient *client, CCNxContentObject *contentObject)
+{
+    client->isChunkRejected = false;
+    _receiveContentObject(client, contentObject, client->namePrefix);
+    return !client->isChunkRejected;
+}
+
+uint64_t
+ccnxSimpleFileTransferBenchClient_GetBytesTransferred(const CCNxSimpleFileTransferBenchClient *client)
+{
+    return client->numBytesTransferred;
+}
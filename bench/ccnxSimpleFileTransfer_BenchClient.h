@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+#ifndef ccnxSimpleFileTransfer_BenchClient_h
+#define ccnxSimpleFileTransfer_BenchClient_h
+
+#include <stdint.h>
+
+#include <ccnx/common/ccnx_Interest.h>
+#include <ccnx/common/ccnx_ContentObject.h>
+
+#include "../ccnxSimpleFileTransfer_Loopback.h"
+#include "../ccnxSimpleFileTransfer_FetchWindow.h"
+
+/**
+ * The receive logic of ccnxSimpleFileTransfer_Client, without its Portal, so that it can be driven by
+ * a CCNxSimpleFileTransferLoopback. The bench takes the place of the client's fetch loop: it issues
+ * an Interest for each chunk the client's fetch window asks for, and hands each Content Object it receives
+ * to the client.
+ */
+typedef struct clientState CCNxSimpleFileTransferBenchClient;
+
+/**
+ * Create a client that fetches the specified file from the default name prefix.
+ * The client must eventually be destroyed by calling `ccnxSimpleFileTransferBenchClient_Destroy`.
+ *
+ * @param [in] fileName - the name of the file to fetch.
+ * @param [in] outputPath - where to write the file, as with the client's -o option, or NULL to discard it.
+ * @param [in] doRequestCompression - true to fetch compressed chunks, as with the client's -z option.
+ */
+CCNxSimpleFileTransferBenchClient *ccnxSimpleFileTransferBenchClient_Create(const char *fileName, const char *outputPath,
+                                                                            bool doRequestCompression);
+
+/**
+ * Destroy a client created by `ccnxSimpleFileTransferBenchClient_Create`.
+ *
+ * @param [in,out] clientPtr - a pointer to the client, which is set to NULL.
+ */
+void ccnxSimpleFileTransferBenchClient_Destroy(CCNxSimpleFileTransferBenchClient **clientPtr);
+
+/**
+ * Create the Interest that asks for the current version of the file, as ccnxSimpleFileTransfer_Client sends before
+ * fetching it. The returned CCNxInterest must eventually be released by calling ccnxInterest_Release().
+ *
+ * @param [in] client - the client.
+ * @return A new CCNxInterest.
+ */
+CCNxInterest *ccnxSimpleFileTransferBenchClient_CreateStatInterest(CCNxSimpleFileTransferBenchClient *client);
+
+/**
+ * Hand the answer to the Interest from ccnxSimpleFileTransferBenchClient_CreateStatInterest() to the client, which then
+ * fetches that version of the file.
+ *
+ * @param [in] client - the client.
+ * @param [in] contentObject - the answer.
+ * @return true if the answer held the version of the file, false otherwise.
+ */
+bool ccnxSimpleFileTransferBenchClient_ReceiveStat(CCNxSimpleFileTransferBenchClient *client,
+                                                   CCNxContentObject *contentObject);
+
+/**
+ * Fetch the chunk digests of the version of the file found by ccnxSimpleFileTransferBenchClient_ReceiveStat() from
+ * the producer, as ccnxSimpleFileTransfer_Client does before fetching it. The client then checks each chunk of
+ * the file against its digest.
+ *
+ * @param [in] client - the client.
+ * @param [in] producer - answers the client's Interests.
+ * @param [in] producerContext - passed to the producer.
+ * @return true if the client has the chunk digests, false otherwise.
+ */
+bool ccnxSimpleFileTransferBenchClient_FetchDigests(CCNxSimpleFileTransferBenchClient *client,
+                                                    CCNxSimpleFileTransferLoopbackProducer *producer, void *producerContext);
+
+/**
+ * Create the Interest for the specified chunk of the file. The returned CCNxInterest must eventually
+ * be released by calling ccnxInterest_Release().
+ *
+ * @param [in] client - the client.
+ * @param [in] chunkNumber - the chunk to ask for.
+ * @return A new CCNxInterest.
+ */
+CCNxInterest *ccnxSimpleFileTransferBenchClient_CreateChunkInterest(CCNxSimpleFileTransferBenchClient *client,
+                                                                    uint64_t chunkNumber);
+
+/**
+ * Create the window the client fetches the file's chunks with, but with the given window size and initial
+ * retransmission timeout. The newly created window must eventually be released by calling
+ * ccnxSimpleFileTransferFetchWindow_Release().
+ *
+ * @param [in] client - the client.
+ * @param [in] windowSize - the most Interests to keep outstanding.
+ * @param [in] initialRtoMicros - how long to wait before asking for a chunk again, until a round trip is measured.
+ * @param [in] nowMicros - the current time.
+ * @return A new CCNxSimpleFileTransferFetchWindow.
+ */
+CCNxSimpleFileTransferFetchWindow *ccnxSimpleFileTransferBenchClient_CreateFetchWindow(
+    const CCNxSimpleFileTransferBenchClient *client, size_t windowSize, uint64_t initialRtoMicros, uint64_t nowMicros);
+
+/**
+ * Hand a received Content Object to the client, the way ccnxSimpleFileTransfer_Client would.
+ *
+ * @param [in] client - the client.
+ * @param [in] contentObject - a chunk of the file.
+ * @return true if the client used the chunk, false if it couldn't (e.g. it was damaged), so it must be asked for again.
+ */
+bool ccnxSimpleFileTransferBenchClient_Receive(CCNxSimpleFileTransferBenchClient *client,
+                                                   CCNxContentObject *contentObject);
+
+/**
+ * Return the number of payload bytes the client has received.
+ *
+ * @param [in] client - the client.
+ * @return the number of bytes.
+ */
+uint64_t ccnxSimpleFileTransferBenchClient_GetBytesTransferred(const CCNxSimpleFileTransferBenchClient *client);
+#endif // ccnxSimpleFileTransfer_BenchClient_h
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the server itself, so its internal static functions are visible here. Its main() is renamed
+// out of the way.
+#define main ccnxSimpleFileTransferServer_Main
+#include "../ccnxSimpleFileTransfer_Server.c"
+#undef main
+
+#include "ccnxSimpleFileTransfer_BenchServer.h"
+
+CCNxSimpleFileTransferBenchServer *
+ccnxSimpleFileTransferBenchServer_Create(const char *directoryPath, size_t chunkSize, bool doPreChunkIntoMemory)
+{
+    ServerState *result = parcMemory_AllocateAndClear(sizeof(ServerState));
+    assertNotNull(result, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(ServerState));
+
+    result->namePrefix = ccnxName_CreateFromCString(ccnxSimpleFileTransferCommon_NamePrefix);
+    result->chunkSize = chunkSize;
+    result->sourceDirectoryPath = parcMemory_StringDuplicate(directoryPath, strlen(directoryPath));
+    result->doPreChunkIntoMemory = doPreChunkIntoMemory;
+    result->numPortals = 1;
+    result->chunkCache = ccnxSimpleFileTransferChunkCache_Create(0, NULL);
+    result->signatureCache = ccnxSimpleFileTransferChunkCache_Create(_signatureCacheCapacityBytes, NULL);
+    result->digestCache = ccnxSimpleFileTransferChunkCache_Create(_digestCacheCapacityBytes, NULL);
+    result->codecCache = ccnxSimpleFileTransferChunkCache_Create(_codecCacheCapacityBytes, NULL);
+    result->compressor = ccnxSimpleFileTransferCompressor_Create();
+    result->openFiles = ccnxSimpleFileTransferOpenFileCache_Create(_openFileCacheCapacity);
+    result->payloadPool = ccnxSimpleFileTransferBufferPool_Create(result->chunkSize, _payloadPoolCapacity);
+    if (doPreChunkIntoMemory) {
+        result->payloadTable = ccnxSimpleFileTransferPayloadTable_Create();
+    }
+
+    return result;
+}
+
+void
+ccnxSimpleFileTransferBenchServer_Destroy(CCNxSimpleFileTransferBenchServer **serverPtr)
+{
+    ServerState *server = *serverPtr;
+
+    ccnxName_Release(&server->namePrefix);
+    parcMemory_Deallocate((void **) &server->sourceDirectoryPath);
+    ccnxSimpleFileTransferChunkCache_Release(&server->chunkCache);
+    ccnxSimpleFileTransferChunkCache_Release(&server->signatureCache);
+    ccnxSimpleFileTransferChunkCache_Release(&server->digestCache);
+    ccnxSimpleFileTransferChunkCache_Release(&server->codecCache);
+    ccnxSimpleFileTransferCompressor_Release(&server->compressor);
+    ccnxSimpleFileTransferOpenFileCache_Release(&server->openFiles);
+    ccnxSimpleFileTransferBufferPool_Release(&server->payloadPool);
+    if (server->payloadTable != NULL) {
+        ccnxSimpleFileTransferPayloadTable_Release(&server->payloadTable);
+    }
+    parcMemory_Deallocate((void **) serverPtr);
+}
+
+CCNxContentObject *
+ccnxSimpleFileTransferBenchServer_Answer(void *server, const CCNxInterest *interest)
+{
+    return _createInterestResponse((const ServerState *) server, interest);
+}
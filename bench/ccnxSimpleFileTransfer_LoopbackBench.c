@@ -0,0 +1,433 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+/**
+ * An end-to-end benchmark of the file transfer protocol that needs no forwarder. The client's receive logic
+ * fetches a file from the server's response logic through a CCNxSimpleFileTransferLoopback, which simulates
+ * the forwarder and the link between them.
+ *
+ * Two times are reported. The virtual time is how long the transfer takes on the simulated network, and is
+ * exactly repeatable for a given set of options. The wall clock time is what the client, server and loopback
+ * code cost to run on this machine.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Memory.h>
+#include <parc/developer/parc_Stopwatch.h>
+
+#include "../ccnxSimpleFileTransfer_Common.h"
+#include "../ccnxSimpleFileTransfer_Loopback.h"
+
+#include "ccnxSimpleFileTransfer_BenchServer.h"
+#include "ccnxSimpleFileTransfer_BenchClient.h"
+
+static const char *_syntheticFileName = "bench.dat";
+
+typedef struct benchState {
+    CCNxSimpleFileTransferLoopbackConfig network;
+    size_t fileSize;                // The size of the synthetic file to fetch.
+    char *directoryPath;            // Serve this directory instead of a synthetic file.
+    char *fileName;                 // The file to fetch from directoryPath.
+    char *outputPath;               // Where the client writes the file, or NULL to discard it.
+    size_t chunkSize;
+    bool doPreChunkIntoMemory;
+    bool doRequestCompression;      // Whether the client fetches compressed chunks, as with the client's -z option.
+    size_t windowSize;              // The most Interests the consumer keeps outstanding.
+    uint64_t retransmitMicros;      // How long the consumer waits before re-sending an Interest, until it has
+                                    // measured the round trip time. 0 means derive it.
+} BenchState;
+
+typedef struct benchResult {
+    uint64_t numChunks;
+    uint64_t numBytes;
+    uint64_t numRetransmissions;
+    uint64_t smoothedRttMicros;
+    uint64_t rtoMicros;
+    uint64_t virtualMicros;
+    uint64_t wallClockMillis;
+} BenchResult;
+
+/**
+ * Create the file the benchmark fetches, filled with pseudo-random bytes, in a new temporary directory.
+ * Return the name of the directory, which must be freed.
+ */
+static char *
+_createSyntheticFile(size_t fileSize)
+{
+    char directoryTemplate[] = "/tmp/ccnxSimpleFileTransfer_bench.XXXXXX";
+    char *directory = mkdtemp(directoryTemplate);
+    assertNotNull(directory, "Could not create a temporary directory");
+
+    char *filePath = parcMemory_Format("%s/%s", directory, _syntheticFileName);
+    FILE *file = fopen(filePath, "w");
+    assertNotNull(file, "Could not create '%s'", filePath);
+
+    uint32_t random = 2463534242U;
+    for (size_t i = 0; i < fileSize; i++) {
+        random ^= random << 13;
+        random ^= random >> 17;
+        random ^= random << 5;
+        fputc((int) (random & 0xff), file);
+    }
+    fclose(file);
+    parcMemory_Deallocate((void **) &filePath);
+
+    return parcMemory_StringDuplicate(directory, strlen(directory));
+}
+
+static void
+_removeSyntheticFile(const char *directory)
+{
+    char *filePath = parcMemory_Format("%s/%s", directory, _syntheticFileName);
+    unlink(filePath);
+    rmdir(directory);
+    parcMemory_Deallocate((void **) &filePath);
+}
+
+static void
+_sendChunkInterest(CCNxSimpleFileTransferLoopback *loopback, CCNxSimpleFileTransferBenchClient *client, uint64_t chunkNumber)
+{
+    CCNxInterest *interest = ccnxSimpleFileTransferBenchClient_CreateChunkInterest(client, chunkNumber);
+    ccnxSimpleFileTransferLoopback_SendInterest(loopback, interest);
+    ccnxInterest_Release(&interest);
+}
+
+/**
+ * Fetch a file as the client does, keeping a window of outstanding Interests and asking again for each chunk
+ * that doesn't arrive within the retransmission timeout estimated from the round trip times. Until the first
+ * chunk arrives, the number of chunks is unknown, so only chunk 0 is requested.
+ *
+ * @return true if every chunk was received.
+ */
+static bool
+_runTransfer(BenchState *benchState, CCNxSimpleFileTransferLoopback *loopback,
+             CCNxSimpleFileTransferBenchClient *client, BenchResult *benchResult)
+{
+    CCNxSimpleFileTransferFetchWindow *window =
+        ccnxSimpleFileTransferBenchClient_CreateFetchWindow(client, benchState->windowSize, benchState->retransmitMicros,
+                                                            ccnxSimpleFileTransferLoopback_GetNowMicros(loopback));
+    uint64_t numReceived = 0;
+    bool hasFailed = false;
+
+    while (!ccnxSimpleFileTransferFetchWindow_IsComplete(window) && !hasFailed) {
+        uint64_t chunk;
+        while (ccnxSimpleFileTransferFetchWindow_TakeNextToSend(window, ccnxSimpleFileTransferLoopback_GetNowMicros(loopback),
+                                                                &chunk)) {
+            _sendChunkInterest(loopback, client, chunk);
+        }
+        if (ccnxSimpleFileTransferFetchWindow_HasFailed(window)) {
+            fprintf(stderr, "A chunk was never answered.\n");
+            hasFailed = true;
+            break;
+        }
+
+        // Wait no longer than it takes for the next outstanding Interest to need re-sending.
+        uint64_t deadlineMicros = ccnxSimpleFileTransferFetchWindow_GetNextTimeoutMicros(window);
+        CCNxContentObject *contentObject = ccnxSimpleFileTransferLoopback_Receive(loopback, deadlineMicros);
+
+        if (contentObject != NULL) {
+            chunk = ccnxSimpleFileTransferCommon_GetChunkNumberFromName(ccnxContentObject_GetName(contentObject));
+
+            // Duplicates (answers to re-sent Interests) are dropped, as the client does. A chunk the client can't
+            // use stays outstanding, so it's asked for again when it times out.
+            if (ccnxSimpleFileTransferFetchWindow_IsOutstanding(window, chunk)) {
+                if (!ccnxSimpleFileTransferFetchWindow_IsNumChunksKnown(window)) {
+                    ccnxSimpleFileTransferFetchWindow_SetNumChunks(window, ccnxContentObject_GetFinalChunkNumber(contentObject) + 1);
+                }
+                if (ccnxSimpleFileTransferBenchClient_Receive(client, contentObject)) {
+                    ccnxSimpleFileTransferFetchWindow_Receive(window, chunk, ccnxSimpleFileTransferLoopback_GetNowMicros(loopback));
+                    numReceived++;
+                }
+            }
+            ccnxContentObject_Release(&contentObject);
+        } else if (deadlineMicros == UINT64_MAX) {
+            hasFailed = true; // Nothing in flight and nothing to wait for.
+        }
+    }
+
+    benchResult->numChunks = numReceived;
+    benchResult->numBytes = ccnxSimpleFileTransferBenchClient_GetBytesTransferred(client);
+    benchResult->numRetransmissions = ccnxSimpleFileTransferFetchWindow_GetNumRetransmissions(window);
+    benchResult->virtualMicros = ccnxSimpleFileTransferLoopback_GetNowMicros(loopback);
+    benchResult->smoothedRttMicros = ccnxSimpleFileTransferFetchWindow_GetSmoothedRttMicros(window);
+    benchResult->rtoMicros = ccnxSimpleFileTransferFetchWindow_GetRtoMicros(window);
+
+    ccnxSimpleFileTransferFetchWindow_Release(&window);
+
+    return !hasFailed;
+}
+
+static void
+_displayResult(const BenchResult *benchResult, const CCNxSimpleFileTransferLoopbackStats *stats)
+{
+    double mb = (double) benchResult->numBytes / (double) (1024 * 1024);
+    double virtualSecs = benchResult->virtualMicros / 1000000.0;
+    double wallClockSecs = benchResult->wallClockMillis / 1000.0;
+
+    fprintf(stderr, "\nTransferred %" PRIu64 " bytes in %" PRIu64 " chunks with %" PRIu64 " retransmissions.\n",
+            benchResult->numBytes, benchResult->numChunks, benchResult->numRetransmissions);
+    fprintf(stderr, "  virtual time:    %10.3f ms (%.3f MB/sec)\n", virtualSecs * 1000.0,
+            (virtualSecs > 0) ? mb / virtualSecs : 0.0);
+    fprintf(stderr, "  wall clock time: %10" PRIu64 " ms (%.3f MB/sec)\n", benchResult->wallClockMillis,
+            (wallClockSecs > 0) ? mb / wallClockSecs : 0.0);
+    fprintf(stderr, "  interests:       %" PRIu64 " sent, %" PRIu64 " forwarded, %" PRIu64 " aggregated, %" PRIu64 " content store hits\n",
+            stats->interestsSent, stats->interestsForwarded, stats->interestsAggregated, stats->contentStoreHits);
+    fprintf(stderr, "  packets lost:    %" PRIu64 "\n", stats->packetsLost);
+    fprintf(stderr, "  round trip time: %" PRIu64 " us smoothed, %" PRIu64 " us retransmission timeout\n",
+            benchResult->smoothedRttMicros, benchResult->rtoMicros);
+}
+
+/**
+ * Display an explanation of arguments accepted by this program.
+ *
+ * @param [in] programName The name of this program.
+ */
+static void
+_displayUsage(char *programName)
+{
+    printf("\n%s, %s\n\n", ccnxSimpleFileTransferCommon_TutorialName, programName);
+
+    printf(" Benchmarks the client and server logic end-to-end through an in-memory stand-in for the forwarder.\n");
+    printf(" No forwarder needs to be running.\n\n");
+
+    printf("Usage: %s [-h] [-n fileSize] [-d <directory> -f <file>] [-o <path>] [-s chunkSize] [-m] [-z] [-w window]\n", programName);
+    printf("          [-D delayMicros] [-P producerDelayMicros] [-L loss] [-B megabitsPerSecond] [-c csSize] [-T micros] [-r seed]\n");
+    printf("    -n <bytes> the size of the synthetic file to fetch (default 16MB).\n");
+    printf("    -d <directory> -f <file> fetch <file> from <directory> instead of a synthetic file.\n");
+    printf("    -o <path> has the client write the file to <path>. By default it is discarded.\n");
+    printf("    -s <bytes> the chunk size.\n");
+    printf("    -m pre-chunk the file into memory, as with the server's -m option.\n");
+    printf("    -z fetch compressed chunks, as with the client's -z option. The synthetic file doesn't compress.\n");
+    printf("    -w <count> the number of Interests the consumer keeps outstanding (default 64).\n");
+    printf("    -D <micros> the one-way delay of the link (default 1000).\n");
+    printf("    -P <micros> the time the producer takes to answer, as seen by the forwarder (default 0).\n");
+    printf("    -L <probability> the probability that a packet is lost, from 0 to 1 (default 0).\n");
+    printf("    -B <Mbps> the link bandwidth (default unlimited).\n");
+    printf("    -c <count> the number of Content Objects in the forwarder's Content Store (default 0).\n");
+    printf("    -T <micros> the retransmission timeout until a round trip is measured (default 4 round trips plus 10ms).\n");
+    printf("    -r <seed> seeds the loss process (default 1).\n");
+    printf("Example:\n");
+    printf("  '%s -n 67108864 -D 5000 -L 0.01 -B 100' fetches 64MB over a lossy 100Mbps link with a 10ms round trip\n\n", programName);
+}
+
+static bool
+_parseCommandLine(int argc, char *argv[], BenchState *benchState)
+{
+    int c;
+    while ((c = getopt(argc, argv, "n:d:f:o:s:mzw:D:P:L:B:c:T:r:h")) != -1) {
+        switch (c) {
+            case 'n':
+                benchState->fileSize = strtoull(optarg, NULL, 10);
+                break;
+            case 'd':
+                benchState->directoryPath = optarg;
+                break;
+            case 'f':
+                benchState->fileName = optarg;
+                break;
+            case 'o':
+                benchState->outputPath = optarg;
+                break;
+            case 's':
+                benchState->chunkSize = atoi(optarg);
+                break;
+            case 'm':
+                benchState->doPreChunkIntoMemory = true;
+                break;
+            case 'z':
+                benchState->doRequestCompression = true;
+                break;
+            case 'w':
+                benchState->windowSize = atoi(optarg);
+                break;
+            case 'D':
+                benchState->network.linkDelayMicros = strtoull(optarg, NULL, 10);
+                break;
+            case 'P':
+                benchState->network.producerDelayMicros = strtoull(optarg, NULL, 10);
+                break;
+            case 'L':
+                benchState->network.lossProbability = atof(optarg);
+                break;
+            case 'B':
+                benchState->network.bandwidthBitsPerSecond = (uint64_t) (atof(optarg) * 1000000.0);
+                break;
+            case 'c':
+                benchState->network.contentStoreCapacity = atoi(optarg);
+                break;
+            case 'T':
+                benchState->retransmitMicros = strtoull(optarg, NULL, 10);
+                break;
+            case 'r':
+                benchState->network.randomSeed = (uint32_t) strtoul(optarg, NULL, 10);
+                break;
+            case 'h':
+                _displayUsage(argv[0]);
+                return false;
+            case '?':
+                if (isascii(optopt)) {
+                    fprintf(stderr, "Unknown option, or missing argument, `-%c'.\n", optopt);
+                }
+                return false;
+            default:
+                break;
+        }
+    }
+
+    if (benchState->retransmitMicros == 0) {
+        uint64_t roundTripMicros = (2 * benchState->network.linkDelayMicros) + benchState->network.producerDelayMicros;
+        benchState->retransmitMicros = (4 * roundTripMicros) + 10000;
+    }
+
+    return true;
+}
+
+static bool
+_isStateValid(BenchState *benchState)
+{
+    return (benchState->chunkSize > 0)
+           && (benchState->windowSize > 0)
+           && (benchState->fileSize > 0 || benchState->directoryPath != NULL)
+           && ((benchState->directoryPath == NULL) == (benchState->fileName == NULL))
+           && (benchState->network.lossProbability >= 0.0 && benchState->network.lossProbability < 1.0);
+}
+
+int
+main(int argc, char *argv[argc])
+{
+    int status = EXIT_FAILURE;
+
+    BenchState benchState;
+    memset(&benchState, 0, sizeof(benchState));
+    benchState.network = ccnxSimpleFileTransferLoopback_DefaultConfig;
+    benchState.fileSize = 16 * 1024 * 1024;
+    benchState.chunkSize = ccnxSimpleFileTransferCommon_DefaultChunkSize;
+    benchState.windowSize = 64;
+
+    if (!_parseCommandLine(argc, argv, &benchState)) {
+        exit(status);
+    }
+    if (!_isStateValid(&benchState)) {
+        _displayUsage(argv[0]);
+        exit(status);
+    }
+
+    char *syntheticDirectory = NULL;
+    const char *directoryPath = benchState.directoryPath;
+    const char *fileName = benchState.fileName;
+    if (directoryPath == NULL) {
+        syntheticDirectory = _createSyntheticFile(benchState.fileSize);
+        directoryPath = syntheticDirectory;
+        fileName = _syntheticFileName;
+    }
+
+    CCNxSimpleFileTransferBenchServer *server =
+        ccnxSimpleFileTransferBenchServer_Create(directoryPath, benchState.chunkSize, benchState.doPreChunkIntoMemory);
+    CCNxSimpleFileTransferBenchClient *client =
+        ccnxSimpleFileTransferBenchClient_Create(fileName, benchState.outputPath, benchState.doRequestCompression);
+    CCNxSimpleFileTransferLoopback *loopback =
+        ccnxSimpleFileTransferLoopback_Create(&benchState.network, ccnxSimpleFileTransferBenchServer_Answer, server);
+
+    // Pin the fetch to the file's current version, and get the digests of its chunks, as ccnxSimpleFileTransfer_Client
+    // does. These exchanges are made directly with the server, rather than over the simulated link.
+    CCNxInterest *statInterest = ccnxSimpleFileTransferBenchClient_CreateStatInterest(client);
+    CCNxContentObject *statResponse = ccnxSimpleFileTransferBenchServer_Answer(server, statInterest);
+    if (statResponse != NULL) {
+        if (ccnxSimpleFileTransferBenchClient_ReceiveStat(client, statResponse)) {
+            ccnxSimpleFileTransferBenchClient_FetchDigests(client, ccnxSimpleFileTransferBenchServer_Answer, server);
+        }
+        ccnxContentObject_Release(&statResponse);
+    }
+    ccnxInterest_Release(&statInterest);
+
+    BenchResult benchResult;
+    memset(&benchResult, 0, sizeof(benchResult));
+
+    PARCStopwatch *timer = parcStopwatch_Create();
+    parcStopwatch_Start(timer);
+
+    if (_runTransfer(&benchState, loopback, client, &benchResult)) {
+        status = EXIT_SUCCESS;
+    }
+
+    benchResult.wallClockMillis = parcStopwatch_ElapsedTimeMillis(timer);
+    parcStopwatch_Release(&timer);
+
+    CCNxSimpleFileTransferLoopbackStats stats = ccnxSimpleFileTransferLoopback_GetStats(loopback);
+    _displayResult(&benchResult, &stats);
+
+    ccnxSimpleFileTransferLoopback_Release(&loopback);
+    ccnxSimpleFileTransferBenchClient_Destroy(&client);
+    ccnxSimpleFileTransferBenchServer_Destroy(&server);
+
+    if (syntheticDirectory != NULL) {
+        _removeSyntheticFile(syntheticDirectory);
+        parcMemory_Deallocate((void **) &syntheticDirectory);
+    }
+
+    exit(status);
+}
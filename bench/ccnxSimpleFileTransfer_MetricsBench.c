@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+/**
+ * A micro-benchmark of the metrics bookkeeping a server's Portal loop does for every Interest it answers, with a
+ * loop on each of several threads, as with -p. Each thread either records straight into the server's shared
+ * metrics, reading the clock for each Interest, or records into a private batch that it adds to the shared
+ * metrics, with ccnxSimpleFileTransferMetrics_Flush(), once for each wakeup's worth of Interests, reading the
+ * clock once per wakeup, as the server does. It reports the cost per Interest, and the number of Interests per
+ * second that the bookkeeping alone would allow.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <ctype.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "../ccnxSimpleFileTransfer_Common.h"
+#include "../ccnxSimpleFileTransfer_Metrics.h"
+
+/**
+ * The size of the payload of each response, as with the server's default chunk size.
+ */
+static const uint64_t _payloadSize = 1200;
+
+typedef struct metrics_bench_thread {
+    pthread_t thread;
+    CCNxSimpleFileTransferMetrics *sharedMetrics;
+    uint64_t numInterests;
+    uint64_t numPerWakeup;          // 0 to record every Interest straight into the shared metrics.
+    uint64_t clockSum;              // Keeps the clock reads from being optimised away.
+} BenchThread;
+
+static uint64_t
+_getTimeInMicros(void)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return (uint64_t) now.tv_sec * 1000000 + (uint64_t) now.tv_usec;
+}
+
+static uint64_t
+_getMonotonicNanos(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000 + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * The updates the server's loop makes for one Interest: received, waited in its class's queue, built, queued
+ * to send, and sent.
+ */
+static void
+_recordInterest(CCNxSimpleFileTransferMetrics *metrics)
+{
+    ccnxSimpleFileTransferMetrics_Increment(metrics, CCNxSimpleFileTransferMetricsCounter_InterestsReceived, 1);
+    ccnxSimpleFileTransferMetrics_RecordLatency(metrics, CCNxSimpleFileTransferMetricsHistogram_FetchQueueLatency, 1000);
+
+    uint64_t buildStartTime = ccnxSimpleFileTransferMetrics_StartTimer(metrics);
+    ccnxSimpleFileTransferMetrics_RecordLatencySince(metrics, CCNxSimpleFileTransferMetricsHistogram_ResponseBuildLatency,
+                                                     buildStartTime);
+
+    uint64_t sendStartTime = ccnxSimpleFileTransferMetrics_StartTimer(metrics);
+    ccnxSimpleFileTransferMetrics_RecordLatencySince(metrics, CCNxSimpleFileTransferMetricsHistogram_SendLatency,
+                                                     sendStartTime);
+    ccnxSimpleFileTransferMetrics_Increment(metrics, CCNxSimpleFileTransferMetricsCounter_ResponsesSent, 1);
+    ccnxSimpleFileTransferMetrics_Increment(metrics, CCNxSimpleFileTransferMetricsCounter_BytesSent, _payloadSize);
+}
+
+static void *
+_runThread(void *context)
+{
+    BenchThread *benchThread = context;
+
+    if (benchThread->numPerWakeup == 0) {
+        // As each loop did before: the receive pass and the answer pass each read the clock for every Interest.
+        for (uint64_t i = 0; i < benchThread->numInterests; i++) {
+            benchThread->clockSum += _getTimeInMicros();
+            benchThread->clockSum += _getTimeInMicros();
+            _recordInterest(benchThread->sharedMetrics);
+        }
+    } else {
+        CCNxSimpleFileTransferMetrics *batch = ccnxSimpleFileTransferMetrics_Create("server");
+        for (uint64_t i = 0; i < benchThread->numInterests; i += benchThread->numPerWakeup) {
+            benchThread->clockSum += _getTimeInMicros();
+            benchThread->clockSum += _getTimeInMicros();
+            for (uint64_t j = i; j < i + benchThread->numPerWakeup && j < benchThread->numInterests; j++) {
+                _recordInterest(batch);
+            }
+            ccnxSimpleFileTransferMetrics_Flush(batch, benchThread->sharedMetrics);
+        }
+        ccnxSimpleFileTransferMetrics_Release(&batch);
+    }
+
+    return NULL;
+}
+
+/**
+ * Run the loops' bookkeeping on `numThreads` threads at once.
+ *
+ * @return The wall clock time it took, in nanoseconds.
+ */
+static uint64_t
+_runBench(unsigned int numThreads, uint64_t numInterests, uint64_t numPerWakeup)
+{
+    CCNxSimpleFileTransferMetrics *sharedMetrics = ccnxSimpleFileTransferMetrics_Create("server");
+    BenchThread *threads = parcMemory_AllocateAndClear(numThreads * sizeof(BenchThread));
+    assertNotNull(threads, "parcMemory_AllocateAndClear(%zu) returned NULL", numThreads * sizeof(BenchThread));
+
+    uint64_t startNanos = _getMonotonicNanos();
+    for (unsigned int i = 0; i < numThreads; i++) {
+        threads[i].sharedMetrics = sharedMetrics;
+        threads[i].numInterests = numInterests;
+        threads[i].numPerWakeup = numPerWakeup;
+        pthread_create(&threads[i].thread, NULL, _runThread, &threads[i]);
+    }
+    for (unsigned int i = 0; i < numThreads; i++) {
+        pthread_join(threads[i].thread, NULL);
+    }
+    uint64_t result = _getMonotonicNanos() - startNanos;
+
+    uint64_t numRecorded = ccnxSimpleFileTransferMetrics_GetCounter(sharedMetrics,
+                                                                    CCNxSimpleFileTransferMetricsCounter_ResponsesSent);
+    assertTrue(numRecorded == numThreads * numInterests, "Expected %" PRIu64 " responses, counted %" PRIu64,
+               numThreads * numInterests, numRecorded);
+
+    parcMemory_Deallocate((void **) &threads);
+    ccnxSimpleFileTransferMetrics_Release(&sharedMetrics);
+    return result;
+}
+
+static void
+_displayUsage(char *programName)
+{
+    printf("\n%s, %s\n\n", ccnxSimpleFileTransferCommon_TutorialName, programName);
+
+    printf(" Times the metrics bookkeeping of the server's Portal loops, per Interest and batched per wakeup.\n\n");
+
+    printf("Usage: %s [-h] [-t threads] [-n interests] [-b interests] [-k rounds]\n", programName);
+    printf("    -t <count> the most loops to run at once (default the number of cores). They are timed\n");
+    printf("       with one loop, two, four and so on up to this.\n");
+    printf("    -n <count> the number of Interests each loop answers (default 1000000).\n");
+    printf("    -b <count> the number of Interests answered in each wakeup (default 64).\n");
+    printf("    -k <count> the number of times to repeat each measurement, reporting the fastest (default 3).\n");
+}
+
+int
+main(int argc, char *argv[argc])
+{
+    long numCores = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned int maxThreads = (numCores > 0) ? (unsigned int) numCores : 1;
+    uint64_t numInterests = 1000000;
+    uint64_t numPerWakeup = 64;
+    unsigned int numRounds = 3;
+
+    int c;
+    while ((c = getopt(argc, argv, "t:n:b:k:h")) != -1) {
+        switch (c) {
+            case 't':
+                maxThreads = atoi(optarg);
+                break;
+            case 'n':
+                numInterests = strtoull(optarg, NULL, 10);
+                break;
+            case 'b':
+                numPerWakeup = strtoull(optarg, NULL, 10);
+                break;
+            case 'k':
+                numRounds = atoi(optarg);
+                break;
+            case 'h':
+                _displayUsage(argv[0]);
+                exit(EXIT_SUCCESS);
+            case '?':
+                if (isascii(optopt)) {
+                    fprintf(stderr, "Unknown option, or missing argument, `-%c'.\n", optopt);
+                }
+                exit(EXIT_FAILURE);
+            default:
+                break;
+        }
+    }
+    if (maxThreads == 0 || numInterests == 0 || numPerWakeup == 0 || numRounds == 0) {
+        _displayUsage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%8s %14s %14s %16s %16s\n", "loops", "per msg ns", "batched ns", "per msg int/s", "batched int/s");
+    for (unsigned int numThreads = 1; ; numThreads *= 2) {
+        if (numThreads > maxThreads) {
+            numThreads = maxThreads;
+        }
+
+        uint64_t bestNanos[2] = { UINT64_MAX, UINT64_MAX };
+        for (unsigned int round = 0; round < numRounds; round++) {
+            for (int mode = 0; mode < 2; mode++) {
+                uint64_t nanos = _runBench(numThreads, numInterests, (mode == 0) ? 0 : numPerWakeup);
+                bestNanos[mode] = (nanos < bestNanos[mode]) ? nanos : bestNanos[mode];
+            }
+        }
+
+        // The cost is per Interest on each loop; the rate is of all the loops together.
+        double totalInterests = (double) numThreads * (double) numInterests;
+        printf("%8u %14.1f %14.1f %16.0f %16.0f\n", numThreads,
+               (double) bestNanos[0] / (double) numInterests, (double) bestNanos[1] / (double) numInterests,
+               totalInterests * 1e9 / (double) bestNanos[0], totalInterests * 1e9 / (double) bestNanos[1]);
+
+        if (numThreads == maxThreads) {
+            break;
+        }
+    }
+
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+/**
+ * A micro-benchmark of the CCNxSimpleFileTransferPendingInterestTable, which a consumer uses to track its
+ * outstanding Interests. It times each of the operations a fetch makes on the table, with the table holding
+ * from a thousand to (by default) a hundred thousand Interests, and reports the average cost of each.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <ctype.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Memory.h>
+#include <parc/developer/parc_Stopwatch.h>
+
+#include "../ccnxSimpleFileTransfer_Common.h"
+#include "../ccnxSimpleFileTransfer_PendingInterestTable.h"
+
+/**
+ * The timeouts are spread over this long, as the Interests of a fetch are spread over a round trip.
+ */
+static const uint64_t _timeoutSpreadMicros = 1000 * 1000;
+static const uint64_t _tickMicros = 1000;
+
+typedef struct pending_interest_bench_result {
+    double insertNanos;
+    double lookupNanos;
+    double churnNanos;
+    double expireNanos;
+} BenchResult;
+
+/**
+ * A timeout for the i-th Interest sent after `nowMicros`. The multiplier is prime, so consecutive Interests'
+ * timeouts are scattered over the spread, as their round trips would be.
+ */
+static uint64_t
+_timeoutFor(uint64_t i, uint64_t nowMicros)
+{
+    return nowMicros + _tickMicros + ((i * 7919) % (_timeoutSpreadMicros / _tickMicros)) * _tickMicros;
+}
+
+static double
+_nanosPerOp(PARCStopwatch *stopwatch, size_t numOps)
+{
+    return (double) parcStopwatch_ElapsedTimeNanos(stopwatch) / (double) numOps;
+}
+
+static BenchResult
+_runBench(size_t numEntries)
+{
+    BenchResult result;
+    CCNxSimpleFileTransferPendingInterestTable *table =
+        ccnxSimpleFileTransferPendingInterestTable_Create(numEntries, _tickMicros, 0);
+    PARCStopwatch *stopwatch = parcStopwatch_Create();
+
+    // Fill the table, as a fetch opening its window does.
+    parcStopwatch_Start(stopwatch);
+    for (uint64_t i = 0; i < numEntries; i++) {
+        CCNxSimpleFileTransferPendingInterest *entry = ccnxSimpleFileTransferPendingInterestTable_Insert(table, i);
+        ccnxSimpleFileTransferPendingInterestTable_SetTimeout(table, entry, _timeoutFor(i, 0));
+    }
+    result.insertNanos = _nanosPerOp(stopwatch, numEntries);
+
+    // Find each entry, in the scattered order its Content Object might arrive in.
+    uint64_t numFound = 0;
+    parcStopwatch_Start(stopwatch);
+    for (uint64_t i = 0; i < numEntries; i++) {
+        if (ccnxSimpleFileTransferPendingInterestTable_Get(table, (i * 7919) % numEntries) != NULL) {
+            numFound++;
+        }
+    }
+    result.lookupNanos = _nanosPerOp(stopwatch, numEntries);
+    assertTrue(numFound == numEntries, "Expected to find all %zu entries, found %" PRIu64, numEntries, numFound);
+
+    // Slide the window along: each chunk that arrives is replaced by an Interest for the next one.
+    parcStopwatch_Start(stopwatch);
+    for (uint64_t i = 0; i < numEntries; i++) {
+        CCNxSimpleFileTransferPendingInterest *entry = ccnxSimpleFileTransferPendingInterestTable_Get(table, i);
+        ccnxSimpleFileTransferPendingInterestTable_Remove(table, entry);
+        entry = ccnxSimpleFileTransferPendingInterestTable_Insert(table, numEntries + i);
+        ccnxSimpleFileTransferPendingInterestTable_SetTimeout(table, entry, _timeoutFor(numEntries + i, 0));
+    }
+    result.churnNanos = _nanosPerOp(stopwatch, numEntries);
+
+    // Let every Interest time out, a millisecond at a time, and give up on each.
+    size_t numTimedOut = 0;
+    parcStopwatch_Start(stopwatch);
+    for (uint64_t nowMicros = 0; numTimedOut < numEntries; nowMicros += _tickMicros) {
+        CCNxSimpleFileTransferPendingInterest *entry;
+        while ((entry = ccnxSimpleFileTransferPendingInterestTable_TakeTimedOut(table, nowMicros)) != NULL) {
+            ccnxSimpleFileTransferPendingInterestTable_Remove(table, entry);
+            numTimedOut++;
+        }
+    }
+    result.expireNanos = _nanosPerOp(stopwatch, numEntries);
+
+    parcStopwatch_Release(&stopwatch);
+    ccnxSimpleFileTransferPendingInterestTable_Release(&table);
+    return result;
+}
+
+static void
+_displayUsage(char *programName)
+{
+    printf("\n%s, %s\n\n", ccnxSimpleFileTransferCommon_TutorialName, programName);
+
+    printf(" Times the operations on the table of a consumer's outstanding Interests.\n\n");
+
+    printf("Usage: %s [-h] [-n entries] [-k rounds]\n", programName);
+    printf("    -n <count> the most entries to time the table with (default 100000). It is timed with\n");
+    printf("       a thousand entries, ten times as many, and so on up to this.\n");
+    printf("    -k <count> the number of times to repeat each measurement, reporting the fastest (default 5).\n");
+}
+
+int
+main(int argc, char *argv[argc])
+{
+    size_t maxEntries = 100000;
+    unsigned int numRounds = 5;
+
+    int c;
+    while ((c = getopt(argc, argv, "n:k:h")) != -1) {
+        switch (c) {
+            case 'n':
+                maxEntries = strtoull(optarg, NULL, 10);
+                break;
+            case 'k':
+                numRounds = atoi(optarg);
+                break;
+            case 'h':
+                _displayUsage(argv[0]);
+                exit(EXIT_SUCCESS);
+            case '?':
+                if (isascii(optopt)) {
+                    fprintf(stderr, "Unknown option, or missing argument, `-%c'.\n", optopt);
+                }
+                exit(EXIT_FAILURE);
+            default:
+                break;
+        }
+    }
+    if (maxEntries == 0 || numRounds == 0) {
+        _displayUsage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%10s %12s %12s %12s %12s\n", "entries", "insert ns", "lookup ns", "churn ns", "expire ns");
+    for (size_t numEntries = (maxEntries < 1000) ? maxEntries : 1000; ; numEntries *= 10) {
+        if (numEntries > maxEntries) {
+            numEntries = maxEntries;
+        }
+
+        BenchResult best = _runBench(numEntries);
+        for (unsigned int round = 1; round < numRounds; round++) {
+            BenchResult result = _runBench(numEntries);
+            best.insertNanos = (result.insertNanos < best.insertNanos) ? result.insertNanos : best.insertNanos;
+            best.lookupNanos = (result.lookupNanos < best.lookupNanos) ? result.lookupNanos : best.lookupNanos;
+            best.churnNanos = (result.churnNanos < best.churnNanos) ? result.churnNanos : best.churnNanos;
+            best.expireNanos = (result.expireNanos < best.expireNanos) ? result.expireNanos : best.expireNanos;
+        }
+        printf("%10zu %12.1f %12.1f %12.1f %12.1f\n", numEntries,
+               best.insertNanos, best.lookupNanos, best.churnNanos, best.expireNanos);
+
+        if (numEntries == maxEntries) {
+            break;
+        }
+    }
+
+    exit(EXIT_SUCCESS);
+}
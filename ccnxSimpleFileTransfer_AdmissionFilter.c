@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <string.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "ccnxSimpleFileTransfer_AdmissionFilter.h"
+
+/**
+ * The number of rows, each indexed by a different hash of the key.
+ */
+#define _sketchDepth 4
+
+/**
+ * The most a counter can count to. Small counters are enough to tell the popular from the unpopular,
+ * and halving keeps them from saturating for long.
+ */
+static const uint8_t _maxCount = 15;
+
+struct ccnxSimpleFileTransfer_AdmissionFilter {
+    size_t width;               // The number of counters in each row, a power of 2.
+    uint8_t *counters;          // _sketchDepth rows of `width` counters.
+    uint64_t numAccesses;       // Recorded since the counters were last halved.
+    uint64_t sampleSize;        // How many accesses to record before halving the counters.
+};
+
+static uint64_t
+_hashKey(const char *key)
+{
+    // 64-bit FNV-1a.
+    uint64_t result = 0xcbf29ce484222325ULL;
+    for (const unsigned char *c = (const unsigned char *) key; *c != '\0'; c++) {
+        result ^= *c;
+        result *= 0x100000001b3ULL;
+    }
+    return result;
+}
+
+/**
+ * Compute the index of the key's counter in each row, by double hashing.
+ */
+static void
+_getIndexes(const CCNxSimpleFileTransferAdmissionFilter *filter, const char *key, size_t indexes[_sketchDepth])
+{
+    uint64_t hash = _hashKey(key);
+    uint32_t hash1 = (uint32_t) hash;
+    uint32_t hash2 = (uint32_t) (hash >> 32) | 1;
+
+    for (int row = 0; row < _sketchDepth; row++) {
+        indexes[row] = row * filter->width + ((hash1 + row * hash2) & (filter->width - 1));
+    }
+}
+
+/**
+ * Halve every counter, so that what was popular a while ago counts for less than what is popular now.
+ */
+static void
+_age(CCNxSimpleFileTransferAdmissionFilter *filter)
+{
+    for (size_t i = 0; i < _sketchDepth * filter->width; i++) {
+        filter->counters[i] >>= 1;
+    }
+    filter->numAccesses /= 2;
+}
+
+static void
+_admissionFilter_Finalize(CCNxSimpleFileTransferAdmissionFilter **filterPtr)
+{
+    CCNxSimpleFileTransferAdmissionFilter *filter = *filterPtr;
+    parcMemory_Deallocate((void **) &filter->counters);
+}
+
+parcObject_ExtendPARCObject(CCNxSimpleFileTransferAdmissionFilter,
+                            _admissionFilter_Finalize,
+                            NULL, NULL, NULL, NULL, NULL, NULL);
+
+parcObject_ImplementAcquire(ccnxSimpleFileTransferAdmissionFilter, CCNxSimpleFileTransferAdmissionFilter);
+
+parcObject_ImplementRelease(ccnxSimpleFileTransferAdmissionFilter, CCNxSimpleFileTransferAdmissionFilter);
+
+CCNxSimpleFileTransferAdmissionFilter *
+ccnxSimpleFileTransferAdmissionFilter_Create(size_t expectedNumKeys)
+{
+    CCNxSimpleFileTransferAdmissionFilter *result = parcObject_CreateAndClearInstance(CCNxSimpleFileTransferAdmissionFilter);
+
+    result->width = 64;
+    while (result->width < expectedNumKeys) {
+        result->width *= 2;
+    }
+    result->sampleSize = 10 * result->width;
+
+    result->counters = parcMemory_AllocateAndClear(_sketchDepth * result->width);
+    assertNotNull(result->counters, "parcMemory_AllocateAndClear(%zu) returned NULL", _sketchDepth * result->width);
+
+    return result;
+}
+
+void
+ccnxSimpleFileTransferAdmissionFilter_RecordAccess(CCNxSimpleFileTransferAdmissionFilter *filter, const char *key)
+{
+    size_t indexes[_sketchDepth];
+    _getIndexes(filter, key, indexes);
+
+    // Conservative update: only raise the counters that are at the current estimate. The others have been
+    // raised by other keys too, and raising them further would only make those estimates worse.
+    uint8_t estimate = _maxCount;
+    for (int row = 0; row < _sketchDepth; row++) {
+        if (filter->counters[indexes[row]] < estimate) {
+            estimate = filter->counters[indexes[row]];
+        }
+    }
+    if (estimate < _maxCount) {
+        for (int row = 0; row < _sketchDepth; row++) {
+            if (filter->counters[indexes[row]] == estimate) {
+                filter->counters[indexes[row]]++;
+            }
+        }
+    }
+
+    if (++filter->numAccesses >= filter->sampleSize) {
+        _age(filter);
+    }
+}
+
+unsigned int
+ccnxSimpleFileTransferAdmissionFilter_EstimateFrequency(const CCNxSimpleFileTransferAdmissionFilter *filter, const char *key)
+{
+    size_t indexes[_sketchDepth];
+    _getIndexes(filter, key, indexes);
+
+    unsigned int result = _maxCount;
+    for (int row = 0; row < _sketchDepth; row++) {
+        if (filter->counters[indexes[row]] < result) {
+            result = filter->counters[indexes[row]];
+        }
+    }
+    return result;
+}
+
+bool
+ccnxSimpleFileTransferAdmissionFilter_Admit(const CCNxSimpleFileTransferAdmissionFilter *filter,
+                                            const char *candidateKey, const char *victimKey)
+{
+    return ccnxSimpleFileTransferAdmissionFilter_EstimateFrequency(filter, candidateKey)
+           > ccnxSimpleFileTransferAdmissionFilter_EstimateFrequency(filter, victimKey);
+}
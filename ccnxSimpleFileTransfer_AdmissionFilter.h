@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+#ifndef ccnxSimpleFileTransfer_AdmissionFilter_h
+#define ccnxSimpleFileTransfer_AdmissionFilter_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct ccnxSimpleFileTransfer_AdmissionFilter;
+
+/**
+ * A `CCNxSimpleFileTransferAdmissionFilter` decides whether something is popular enough to be admitted to a
+ * cache, in the manner of TinyLFU.
+ *
+ * It estimates how often each key has been requested recently with a count-min sketch: a few rows of small
+ * saturating counters, each row indexed by a different hash of the key, the estimate being the smallest of
+ * the key's counters. It takes a fixed amount of memory however many keys there are, and may over-estimate but
+ * never under-estimates. So that the estimates reflect recent popularity, all the counters are halved each time
+ * a sample of accesses (10 times the width of the sketch) has been recorded.
+ *
+ * A candidate is admitted only if it is estimated to be more popular than what it would evict, so a one-off
+ * request for a cold file can't push out the hot set.
+ */
+typedef struct ccnxSimpleFileTransfer_AdmissionFilter CCNxSimpleFileTransferAdmissionFilter;
+
+/**
+ * Create a new `CCNxSimpleFileTransferAdmissionFilter`.
+ * The newly created instance must eventually be released by calling `ccnxSimpleFileTransferAdmissionFilter_Release`.
+ *
+ * @param [in] expectedNumKeys - roughly how many distinct keys are requested within a sample. This sets the
+ *                               width of the sketch, which is rounded up to a power of 2.
+ */
+CCNxSimpleFileTransferAdmissionFilter *ccnxSimpleFileTransferAdmissionFilter_Create(size_t expectedNumKeys);
+
+/**
+ * Increase the number of references to a `CCNxSimpleFileTransferAdmissionFilter` instance.
+ *
+ * @param [in] instance A pointer to the original `CCNxSimpleFileTransferAdmissionFilter`.
+ * @return The value of the input parameter @p instance.
+ *
+ * @see ccnxSimpleFileTransferAdmissionFilter_Release
+ */
+CCNxSimpleFileTransferAdmissionFilter *ccnxSimpleFileTransferAdmissionFilter_Acquire(const CCNxSimpleFileTransferAdmissionFilter *instance);
+
+/**
+ * Release a previously acquired reference to the specified instance,
+ * decrementing the reference count for the instance.
+ *
+ * @param [in,out] filterPtr A pointer to a pointer to the instance to release.
+ *
+ * @see ccnxSimpleFileTransferAdmissionFilter_Acquire
+ */
+void ccnxSimpleFileTransferAdmissionFilter_Release(CCNxSimpleFileTransferAdmissionFilter **filterPtr);
+
+/**
+ * Record a request for the specified key.
+ *
+ * @param [in] filter - the filter.
+ * @param [in] key - the key that was requested, e.g. a file name.
+ */
+void ccnxSimpleFileTransferAdmissionFilter_RecordAccess(CCNxSimpleFileTransferAdmissionFilter *filter, const char *key);
+
+/**
+ * Estimate how many times the specified key has been requested recently. The estimate saturates at 15.
+ *
+ * @param [in] filter - the filter.
+ * @param [in] key - the key.
+ */
+unsigned int ccnxSimpleFileTransferAdmissionFilter_EstimateFrequency(const CCNxSimpleFileTransferAdmissionFilter *filter,
+                                                                      const char *key);
+
+/**
+ * Return whether `candidateKey` should be admitted to a cache in place of `victimKey`, that is, whether it
+ * has been requested more often recently.
+ *
+ * @param [in] filter - the filter.
+ * @param [in] candidateKey - the key that would be admitted.
+ * @param [in] victimKey - the key that would be evicted to make room for it.
+ */
+bool ccnxSimpleFileTransferAdmissionFilter_Admit(const CCNxSimpleFileTransferAdmissionFilter *filter,
+                                                 const char *candidateKey, const char *victimKey);
+
+#endif // ccnxSimpleFileTransfer_AdmissionFilter_h
@@ -0,0 +1,467 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+#include <parc/security/parc_CryptoHasher.h>
+
+#include "ccnxSimpleFileTransfer_BlockSignatures.h"
+
+static const uint32_t _signaturesMagic = 0x53465453; // "SFTS"
+
+/**
+ * How much of the file is read at a time while computing its signatures.
+ */
+static const size_t _readSize = 1024 * 1024;
+
+typedef struct blockSignature {
+    uint32_t weak;
+    uint8_t strong[ccnxSimpleFileTransferBlockSignatures_StrongHashLength];
+} _BlockSignature;
+
+struct ccnxSimpleFileTransfer_BlockSignatures {
+    uint64_t fileSize;
+    size_t blockSize;
+    uint64_t numBlocks;
+    _BlockSignature *blocks;
+};
+
+/**
+ * The weak checksum, a byte at a time. Used for what's left over by the SSE2 version, and where there is no SSE2.
+ */
+static void
+_addToWeakChecksum(const uint8_t *data, size_t length, uint32_t *sum, uint32_t *sumOfSums)
+{
+    uint32_t a = *sum;
+    uint32_t b = *sumOfSums;
+    for (size_t i = 0; i < length; i++) {
+        a += data[i];
+        b += a;
+    }
+    *sum = a;
+    *sumOfSums = b;
+}
+
+uint32_t
+ccnxSimpleFileTransferBlockSignatures_WeakChecksum(const uint8_t *data, size_t length)
+{
+    uint32_t a = 0; // The sum of the bytes.
+    uint32_t b = 0; // The sum of the running sums, i.e. each byte weighted by how far it is from the end.
+    size_t done = 0;
+
+#if defined(__SSE2__)
+    // Sixteen bytes at a time. For each group, b gains 16 times the sum of the bytes before the group, plus the
+    // group's bytes weighted 16 down to 1. Everything is modulo 2^32, so the lanes may wrap.
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lowWeights = _mm_set_epi16(9, 10, 11, 12, 13, 14, 15, 16);
+    const __m128i highWeights = _mm_set_epi16(1, 2, 3, 4, 5, 6, 7, 8);
+
+    __m128i sums = zero;          // The sum of the bytes so far, in two 64-bit lanes.
+    __m128i sumsBefore = zero;    // The sum, over the groups, of the bytes before each group.
+    __m128i weightedSums = zero;  // The sum of the weighted bytes within each group, in four 32-bit lanes.
+
+    for (; done + 16 <= length; done += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *) (data + done));
+
+        sumsBefore = _mm_add_epi64(sumsBefore, sums);
+        sums = _mm_add_epi64(sums, _mm_sad_epu8(bytes, zero));
+
+        __m128i lowBytes = _mm_unpacklo_epi8(bytes, zero);
+        __m128i highBytes = _mm_unpackhi_epi8(bytes, zero);
+        weightedSums = _mm_add_epi32(weightedSums, _mm_madd_epi16(lowBytes, lowWeights));
+        weightedSums = _mm_add_epi32(weightedSums, _mm_madd_epi16(highBytes, highWeights));
+    }
+
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i *) lanes, sums);
+    a = (uint32_t) (lanes[0] + lanes[1]);
+
+    _mm_storeu_si128((__m128i *) lanes, sumsBefore);
+    b = (uint32_t) (16 * (lanes[0] + lanes[1]));
+
+    uint32_t weighted[4];
+    _mm_storeu_si128((__m128i *) weighted, weightedSums);
+    b += weighted[0] + weighted[1] + weighted[2] + weighted[3];
+#endif
+
+    _addToWeakChecksum(data + done, length - done, &a, &b);
+
+    return (b << 16) | (a & 0xffff);
+}
+
+uint32_t
+ccnxSimpleFileTransferBlockSignatures_RollWeakChecksum(uint32_t checksum, size_t length, uint8_t outByte, uint8_t inByte)
+{
+    // Both halves are modulo 2^16, so they can be rolled separately.
+    uint32_t a = (checksum & 0xffff) - outByte + inByte;
+    uint32_t b = (checksum >> 16) - (uint32_t) length * outByte + a;
+
+    return (b << 16) | (a & 0xffff);
+}
+
+/**
+ * The strong hash of a block: the first bytes of its SHA-256 digest.
+ */
+static void
+_computeStrongHash(PARCCryptoHasher *hasher, const uint8_t *data, size_t length,
+                   uint8_t strong[ccnxSimpleFileTransferBlockSignatures_StrongHashLength])
+{
+    parcCryptoHasher_Init(hasher);
+    parcCryptoHasher_UpdateBytes(hasher, data, length);
+    PARCCryptoHash *hash = parcCryptoHasher_Finalize(hasher);
+
+    PARCBuffer *digest = parcCryptoHash_GetDigest(hash);
+    memcpy(strong, parcBuffer_Overlay(digest, 0), ccnxSimpleFileTransferBlockSignatures_StrongHashLength);
+
+    parcCryptoHash_Release(&hash);
+}
+
+static void
+_blockSignatures_Finalize(CCNxSimpleFileTransferBlockSignatures **signaturesPtr)
+{
+    CCNxSimpleFileTransferBlockSignatures *signatures = *signaturesPtr;
+
+    if (signatures->blocks != NULL) {
+        parcMemory_Deallocate((void **) &signatures->blocks);
+    }
+}
+
+parcObject_ExtendPARCObject(CCNxSimpleFileTransferBlockSignatures,
+                            _blockSignatures_Finalize,
+                            NULL, NULL, NULL, NULL, NULL, NULL);
+
+parcObject_ImplementAcquire(ccnxSimpleFileTransferBlockSignatures, CCNxSimpleFileTransferBlockSignatures);
+
+parcObject_ImplementRelease(ccnxSimpleFileTransferBlockSignatures, CCNxSimpleFileTransferBlockSignatures);
+
+static CCNxSimpleFileTransferBlockSignatures *
+_create(uint64_t fileSize, size_t blockSize)
+{
+    CCNxSimpleFileTransferBlockSignatures *result = parcObject_CreateAndClearInstance(CCNxSimpleFileTransferBlockSignatures);
+
+    result->fileSize = fileSize;
+    result->blockSize = blockSize;
+    result->numBlocks = (fileSize + blockSize - 1) / blockSize;
+    if (result->numBlocks > 0) {
+        result->blocks = parcMemory_AllocateAndClear(result->numBlocks * sizeof(_BlockSignature));
+        assertNotNull(result->blocks, "parcMemory_AllocateAndClear(%zu) returned NULL",
+                      (size_t) (result->numBlocks * sizeof(_BlockSignature)));
+    }
+
+    return result;
+}
+
+CCNxSimpleFileTransferBlockSignatures *
+ccnxSimpleFileTransferBlockSignatures_CreateFromFile(int fileDescriptor, size_t fileSize, size_t blockSize)
+{
+    assertTrue(blockSize > 0, "The block size must be greater than 0");
+
+    CCNxSimpleFileTransferBlockSignatures *result = _create(fileSize, blockSize);
+
+    // Read whole blocks, a good many at a time.
+    size_t bufferSize = (_readSize / blockSize + 1) * blockSize;
+    uint8_t *buffer = parcMemory_Allocate(bufferSize);
+    assertNotNull(buffer, "parcMemory_Allocate(%zu) returned NULL", bufferSize);
+
+    PARCCryptoHasher *hasher = parcCryptoHasher_Create(PARCCryptoHashType_SHA256);
+
+    uint64_t blockNumber = 0;
+    uint64_t offset = 0;
+    while (result != NULL && offset < fileSize) {
+        size_t wanted = (fileSize - offset < bufferSize) ? (size_t) (fileSize - offset) : bufferSize;
+        size_t numRead = 0;
+        while (numRead < wanted) {
+            ssize_t n = pread(fileDescriptor, buffer + numRead, wanted - numRead, (off_t) (offset + numRead));
+            if (n <= 0) {
+                break;
+            }
+            numRead += (size_t) n;
+        }
+
+        if (numRead < wanted) {
+            ccnxSimpleFileTransferBlockSignatures_Release(&result); // The file was shortened, or couldn't be read.
+        } else {
+            for (size_t blockStart = 0; blockStart < numRead; blockStart += blockSize, blockNumber++) {
+                size_t length = (numRead - blockStart < blockSize) ? numRead - blockStart : blockSize;
+                _BlockSignature *block = &result->blocks[blockNumber];
+                block->weak = ccnxSimpleFileTransferBlockSignatures_WeakChecksum(buffer + blockStart, length);
+                _computeStrongHash(hasher, buffer + blockStart, length, block->strong);
+            }
+            offset += numRead;
+        }
+    }
+
+    parcCryptoHasher_Release(&hasher);
+    parcMemory_Deallocate((void **) &buffer);
+
+    return result;
+}
+
+CCNxSimpleFileTransferBlockSignatures *
+ccnxSimpleFileTransferBlockSignatures_CreateFromBuffer(const PARCBuffer *buffer)
+{
+    CCNxSimpleFileTransferBlockSignatures *result = NULL;
+
+    const size_t headerSize = 4 + 4 + 4 + 8;
+    PARCBuffer *reader = parcBuffer_Slice(buffer);
+
+    if (parcBuffer_Remaining(reader) >= headerSize && parcBuffer_GetUint32(reader) == _signaturesMagic) {
+        uint32_t blockSize = parcBuffer_GetUint32(reader);
+        uint32_t strongHashLength = parcBuffer_GetUint32(reader);
+        uint64_t fileSize = parcBuffer_GetUint64(reader);
+
+        if (blockSize > 0 && strongHashLength == ccnxSimpleFileTransferBlockSignatures_StrongHashLength) {
+            uint64_t numBlocks = (fileSize + blockSize - 1) / blockSize;
+            size_t entrySize = 4 + strongHashLength;
+            if (numBlocks <= parcBuffer_Remaining(reader) / entrySize
+                && parcBuffer_Remaining(reader) == numBlocks * entrySize) {
+                result = _create(fileSize, blockSize);
+                for (uint64_t i = 0; i < numBlocks; i++) {
+                    result->blocks[i].weak = parcBuffer_GetUint32(reader);
+                    parcBuffer_GetBytes(reader, strongHashLength, result->blocks[i].strong);
+                }
+            }
+        }
+    }
+
+    parcBuffer_Release(&reader);
+
+    return result;
+}
+
+PARCBuffer *
+ccnxSimpleFileTransferBlockSignatures_CreateBuffer(const CCNxSimpleFileTransferBlockSignatures *signatures)
+{
+    size_t size = 4 + 4 + 4 + 8 + signatures->numBlocks * (4 + ccnxSimpleFileTransferBlockSignatures_StrongHashLength);
+    PARCBuffer *result = parcBuffer_Allocate(size);
+
+    parcBuffer_PutUint32(result, _signaturesMagic);
+    parcBuffer_PutUint32(result, (uint32_t) signatures->blockSize);
+    parcBuffer_PutUint32(result, ccnxSimpleFileTransferBlockSignatures_StrongHashLength);
+    parcBuffer_PutUint64(result, signatures->fileSize);
+    for (uint64_t i = 0; i < signatures->numBlocks; i++) {
+        parcBuffer_PutUint32(result, signatures->blocks[i].weak);
+        parcBuffer_PutArray(result, ccnxSimpleFileTransferBlockSignatures_StrongHashLength, signatures->blocks[i].strong);
+    }
+
+    return parcBuffer_Flip(result);
+}
+
+uint64_t
+ccnxSimpleFileTransferBlockSignatures_GetFileSize(const CCNxSimpleFileTransferBlockSignatures *signatures)
+{
+    return signatures->fileSize;
+}
+
+size_t
+ccnxSimpleFileTransferBlockSignatures_GetBlockSize(const CCNxSimpleFileTransferBlockSignatures *signatures)
+{
+    return signatures->blockSize;
+}
+
+uint64_t
+ccnxSimpleFileTransferBlockSignatures_GetNumBlocks(const CCNxSimpleFileTransferBlockSignatures *signatures)
+{
+    return signatures->numBlocks;
+}
+
+/**
+ * A hash table from weak checksum to the full-sized blocks that have it, chained through `next`.
+ */
+typedef struct weakChecksumIndex {
+    uint64_t *buckets;      // 1 + the first block in each bucket, or 0 if it's empty.
+    uint64_t *next;         // 1 + the next block in the same bucket, or 0.
+    uint64_t mask;
+} _WeakChecksumIndex;
+
+static uint64_t
+_getBucket(const _WeakChecksumIndex *index, uint32_t weak)
+{
+    return (weak * 2654435761U) & index->mask; // Knuth's multiplicative hash spreads the low bits.
+}
+
+static void
+_createIndex(_WeakChecksumIndex *index, const CCNxSimpleFileTransferBlockSignatures *signatures, uint64_t numFullBlocks)
+{
+    uint64_t numBuckets = 16;
+    while (numBuckets < numFullBlocks * 2) {
+        numBuckets *= 2;
+    }
+    index->mask = numBuckets - 1;
+    index->buckets = parcMemory_AllocateAndClear(numBuckets * sizeof(uint64_t));
+    index->next = parcMemory_AllocateAndClear((numFullBlocks + 1) * sizeof(uint64_t));
+    assertNotNull(index->buckets, "parcMemory_AllocateAndClear(%zu) returned NULL", (size_t) (numBuckets * sizeof(uint64_t)));
+    assertNotNull(index->next, "parcMemory_AllocateAndClear(%zu) returned NULL", (size_t) ((numFullBlocks + 1) * sizeof(uint64_t)));
+
+    // Insert in reverse, so each bucket lists its blocks in order.
+    for (uint64_t i = numFullBlocks; i > 0; i--) {
+        uint64_t bucket = _getBucket(index, signatures->blocks[i - 1].weak);
+        index->next[i - 1] = index->buckets[bucket];
+        index->buckets[bucket] = i;
+    }
+}
+
+static void
+_releaseIndex(_WeakChecksumIndex *index)
+{
+    parcMemory_Deallocate((void **) &index->buckets);
+    parcMemory_Deallocate((void **) &index->next);
+}
+
+/**
+ * Look for the window of local data in the index. Every block it matches is recorded, since a file may have
+ * several identical blocks. Returns true if it matched any block not already found.
+ */
+static bool
+_matchWindow(const CCNxSimpleFileTransferBlockSignatures *signatures, const _WeakChecksumIndex *index,
+             PARCCryptoHasher *hasher, uint32_t weak, const uint8_t *window, int64_t windowOffset,
+             int64_t *localOffsets, uint64_t *numFound)
+{
+    bool result = false;
+    bool isStrongHashComputed = false;
+    uint8_t strong[ccnxSimpleFileTransferBlockSignatures_StrongHashLength];
+
+    for (uint64_t entry = index->buckets[_getBucket(index, weak)]; entry != 0; entry = index->next[entry - 1]) {
+        uint64_t block = entry - 1;
+        if (signatures->blocks[block].weak == weak && localOffsets[block] < 0) {
+            if (!isStrongHashComputed) {
+                _computeStrongHash(hasher, window, signatures->blockSize, strong);
+                isStrongHashComputed = true;
+            }
+            if (memcmp(strong, signatures->blocks[block].strong, sizeof(strong)) == 0) {
+                localOffsets[block] = windowOffset;
+                (*numFound)++;
+                result = true;
+            }
+        }
+    }
+
+    return result;
+}
+
+uint64_t
+ccnxSimpleFileTransferBlockSignatures_FindLocalBlocks(const CCNxSimpleFileTransferBlockSignatures *signatures,
+                                                      const uint8_t *localData, size_t localLength,
+                                                      int64_t *localOffsets)
+{
+    uint64_t result = 0;
+    size_t blockSize = signatures->blockSize;
+
+    for (uint64_t i = 0; i < signatures->numBlocks; i++) {
+        localOffsets[i] = -1;
+    }
+
+    // A short last block can't be found by a full-sized window, so it's only looked for at the end of the copy.
+    uint64_t numFullBlocks = signatures->fileSize / blockSize;
+
+    if (numFullBlocks > 0 && localLength >= blockSize) {
+        _WeakChecksumIndex index;
+        _createIndex(&index, signatures, numFullBlocks);
+        PARCCryptoHasher *hasher = parcCryptoHasher_Create(PARCCryptoHashType_SHA256);
+
+        size_t offset = 0;
+        uint32_t weak = ccnxSimpleFileTransferBlockSignatures_WeakChecksum(localData, blockSize);
+        while (result < numFullBlocks) {
+            bool isMatched = _matchWindow(signatures, &index, hasher, weak, localData + offset, (int64_t) offset,
+                                          localOffsets, &result);
+
+            if (isMatched && offset + 2 * blockSize <= localLength) {
+                // Carry on after the block that was found.
+                offset += blockSize;
+                weak = ccnxSimpleFileTransferBlockSignatures_WeakChecksum(localData + offset, blockSize);
+            } else if (!isMatched && offset + blockSize < localLength) {
+                weak = ccnxSimpleFileTransferBlockSignatures_RollWeakChecksum(weak, blockSize, localData[offset],
+                                                                              localData[offset + blockSize]);
+                offset++;
+            } else {
+                break; // The end of the local copy.
+            }
+        }
+
+        parcCryptoHasher_Release(&hasher);
+        _releaseIndex(&index);
+    }
+
+    if (numFullBlocks < signatures->numBlocks) {
+        size_t lastLength = (size_t) (signatures->fileSize - numFullBlocks * blockSize);
+        if (localLength >= lastLength) {
+            const uint8_t *tail = localData + localLength - lastLength;
+            const _BlockSignature *lastBlock = &signatures->blocks[numFullBlocks];
+            if (ccnxSimpleFileTransferBlockSignatures_WeakChecksum(tail, lastLength) == lastBlock->weak) {
+                uint8_t strong[ccnxSimpleFileTransferBlockSignatures_StrongHashLength];
+                PARCCryptoHasher *hasher = parcCryptoHasher_Create(PARCCryptoHashType_SHA256);
+                _computeStrongHash(hasher, tail, lastLength, strong);
+                parcCryptoHasher_Release(&hasher);
+
+                if (memcmp(strong, lastBlock->strong, sizeof(strong)) == 0) {
+                    localOffsets[numFullBlocks] = (int64_t) (localLength - lastLength);
+                    result++;
+                }
+            }
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+#ifndef ccnxSimpleFileTransfer_BlockSignatures_h
+#define ccnxSimpleFileTransfer_BlockSignatures_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <parc/algol/parc_Buffer.h>
+
+struct ccnxSimpleFileTransfer_BlockSignatures;
+
+/**
+ * A `CCNxSimpleFileTransferBlockSignatures` describes the contents of one version of a file, block by block, so
+ * that a client with an older copy of the file can tell which blocks it already has and fetch only the rest.
+ * A block is one chunk of the file, so a missing block is fetched as the chunk with the same number.
+ *
+ * Each block has a weak checksum, which can be rolled along the client's copy a byte at a time (as in rsync), and
+ * a strong hash (the first bytes of its SHA-256 digest) to confirm a block whose weak checksum matches. Finding
+ * blocks wherever they are in the client's copy means that bytes inserted or removed part way through a file only
+ * cost the blocks around them.
+ *
+ * Signatures are exchanged in network byte order.
+ */
+typedef struct ccnxSimpleFileTransfer_BlockSignatures CCNxSimpleFileTransferBlockSignatures;
+
+/**
+ * The number of bytes of a block's SHA-256 digest kept as its strong hash.
+ */
+#define ccnxSimpleFileTransferBlockSignatures_StrongHashLength 16
+
+/**
+ * Compute the weak checksum of a block of data: the rsync checksum, with the sum of the bytes in the low 16 bits
+ * and the sum of the running sums in the high 16 bits. Uses SSE2 where it's available.
+ *
+ * @param [in] data - the block.
+ * @param [in] length - the number of bytes in the block.
+ * @return The weak checksum.
+ */
+uint32_t ccnxSimpleFileTransferBlockSignatures_WeakChecksum(const uint8_t *data, size_t length);
+
+/**
+ * Given the weak checksum of a window of `length` bytes, return the weak checksum of the window one byte on.
+ *
+ * @param [in] checksum - the weak checksum of the current window.
+ * @param [in] length - the number of bytes in the window.
+ * @param [in] outByte - the first byte of the current window, which leaves it.
+ * @param [in] inByte - the byte after the current window, which joins it.
+ * @return The weak checksum of the next window.
+ */
+uint32_t ccnxSimpleFileTransferBlockSignatures_RollWeakChecksum(uint32_t checksum, size_t length, uint8_t outByte, uint8_t inByte);
+
+/**
+ * Compute the signatures of the blocks of a file, reading it from an open descriptor.
+ * The newly created instance must eventually be released by calling `ccnxSimpleFileTransferBlockSignatures_Release`.
+ *
+ * @param [in] fileDescriptor - a descriptor open for reading on the file.
+ * @param [in] fileSize - the size of the file.
+ * @param [in] blockSize - the size of each block, i.e. the chunk size. The last block may be shorter.
+ * @return A new instance, or NULL if the file couldn't be read.
+ */
+CCNxSimpleFileTransferBlockSignatures *ccnxSimpleFileTransferBlockSignatures_CreateFromFile(int fileDescriptor, size_t fileSize,
+                                                                                             size_t blockSize);
+
+/**
+ * Create a `CCNxSimpleFileTransferBlockSignatures` from the buffer created by
+ * `ccnxSimpleFileTransferBlockSignatures_CreateBuffer`, e.g. as received from the server.
+ * The newly created instance must eventually be released by calling `ccnxSimpleFileTransferBlockSignatures_Release`.
+ *
+ * @param [in] buffer - the signatures, from its position to its limit.
+ * @return A new instance, or NULL if the buffer doesn't hold valid signatures.
+ */
+CCNxSimpleFileTransferBlockSignatures *ccnxSimpleFileTransferBlockSignatures_CreateFromBuffer(const PARCBuffer *buffer);
+
+/**
+ * Increase the number of references to a `CCNxSimpleFileTransferBlockSignatures` instance.
+ *
+ * @param [in] instance A pointer to the original `CCNxSimpleFileTransferBlockSignatures`.
+ * @return The value of the input parameter @p instance.
+ *
+ * @see ccnxSimpleFileTransferBlockSignatures_Release
+ */
+CCNxSimpleFileTransferBlockSignatures *ccnxSimpleFileTransferBlockSignatures_Acquire(const CCNxSimpleFileTransferBlockSignatures *instance);
+
+/**
+ * Release a previously acquired reference to the specified instance,
+ * decrementing the reference count for the instance.
+ *
+ * @param [in,out] signaturesPtr A pointer to a pointer to the instance to release.
+ *
+ * @see ccnxSimpleFileTransferBlockSignatures_Acquire
+ */
+void ccnxSimpleFileTransferBlockSignatures_Release(CCNxSimpleFileTransferBlockSignatures **signaturesPtr);
+
+/**
+ * Encode the signatures for sending. The returned PARCBuffer must eventually be released by calling parcBuffer_Release().
+ *
+ * @param [in] signatures - the signatures.
+ * @return A new PARCBuffer, ready to be read.
+ */
+PARCBuffer *ccnxSimpleFileTransferBlockSignatures_CreateBuffer(const CCNxSimpleFileTransferBlockSignatures *signatures);
+
+/**
+ * Return the size of the file the signatures describe.
+ */
+uint64_t ccnxSimpleFileTransferBlockSignatures_GetFileSize(const CCNxSimpleFileTransferBlockSignatures *signatures);
+
+/**
+ * Return the size of each block, except perhaps the last.
+ */
+size_t ccnxSimpleFileTransferBlockSignatures_GetBlockSize(const CCNxSimpleFileTransferBlockSignatures *signatures);
+
+/**
+ * Return the number of blocks in the file. An empty file has none.
+ */
+uint64_t ccnxSimpleFileTransferBlockSignatures_GetNumBlocks(const CCNxSimpleFileTransferBlockSignatures *signatures);
+
+/**
+ * Search a local copy of the file for the blocks the signatures describe. The weak checksum is rolled along the
+ * copy a byte at a time, and a block found at one offset is looked for again after it, as rsync does.
+ *
+ * @param [in] signatures - the signatures.
+ * @param [in] localData - the local copy.
+ * @param [in] localLength - the size of the local copy.
+ * @param [out] localOffsets - an array of ccnxSimpleFileTransferBlockSignatures_GetNumBlocks() entries, each set
+ *                             to the offset in the local copy of that block, or -1 if it wasn't found.
+ * @return The number of blocks found.
+ */
+uint64_t ccnxSimpleFileTransferBlockSignatures_FindLocalBlocks(const CCNxSimpleFileTransferBlockSignatures *signatures,
+                                                               const uint8_t *localData, size_t localLength,
+                                                               int64_t *localOffsets);
+
+#endif // ccnxSimpleFileTransfer_BlockSignatures_h
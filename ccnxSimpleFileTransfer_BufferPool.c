@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "ccnxSimpleFileTransfer_BufferPool.h"
+
+struct ccnxSimpleFileTransfer_BufferPool {
+    size_t bufferCapacity;
+    PARCBuffer **buffers;       // Each holds a reference, so a buffer only we hold, and that nothing sliced, is free.
+    size_t maxBuffers;
+    size_t numBuffers;
+    size_t nextBuffer;          // Where to start looking for a free buffer.
+    uint64_t numAllocated;
+};
+
+static void
+_bufferPool_Finalize(CCNxSimpleFileTransferBufferPool **poolPtr)
+{
+    CCNxSimpleFileTransferBufferPool *pool = *poolPtr;
+
+    for (size_t i = 0; i < pool->numBuffers; i++) {
+        parcBuffer_Release(&pool->buffers[i]);
+    }
+    parcMemory_Deallocate((void **) &pool->buffers);
+}
+
+parcObject_ExtendPARCObject(CCNxSimpleFileTransferBufferPool, _bufferPool_Finalize, NULL, NULL, NULL, NULL, NULL, NULL);
+
+parcObject_ImplementAcquire(ccnxSimpleFileTransferBufferPool, CCNxSimpleFileTransferBufferPool);
+
+parcObject_ImplementRelease(ccnxSimpleFileTransferBufferPool, CCNxSimpleFileTransferBufferPool);
+
+CCNxSimpleFileTransferBufferPool *
+ccnxSimpleFileTransferBufferPool_Create(size_t bufferCapacity, size_t maxBuffers)
+{
+    assertTrue(maxBuffers > 0, "The pool must keep at least 1 buffer");
+
+    CCNxSimpleFileTransferBufferPool *result = parcObject_CreateAndClearInstance(CCNxSimpleFileTransferBufferPool);
+
+    result->bufferCapacity = bufferCapacity;
+    result->maxBuffers = maxBuffers;
+    result->buffers = parcMemory_AllocateAndClear(maxBuffers * sizeof(PARCBuffer *));
+    assertNotNull(result->buffers, "parcMemory_AllocateAndClear(%zu) returned NULL", maxBuffers * sizeof(PARCBuffer *));
+
+    return result;
+}
+
+/*
+ * A buffer is free once the pool holds the only reference to it and to its bytes. A Content Object, or the
+ * encoder under it, may keep a slice or a duplicate of the payload rather than the payload itself, and those
+ * share the buffer's PARCByteArray, not the buffer.
+ *
+ * The last reference may have been released on another thread, so order the reads of the counts before any
+ * write to the bytes.
+ */
+static bool
+_bufferPool_IsFree(PARCBuffer *buffer)
+{
+    if (parcObject_GetReferenceCount(buffer) != 1 || parcObject_GetReferenceCount(parcBuffer_Array(buffer)) != 1) {
+        return false;
+    }
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return true;
+}
+
+PARCBuffer *
+ccnxSimpleFileTransferBufferPool_GetBuffer(CCNxSimpleFileTransferBufferPool *pool)
+{
+    // Buffers are mostly released in the order they were handed out, so looking on from the last one handed out
+    // usually finds the oldest, free, at once.
+    for (size_t i = 0; i < pool->numBuffers; i++) {
+        size_t index = (pool->nextBuffer + i) % pool->numBuffers;
+        if (_bufferPool_IsFree(pool->buffers[index])) {
+            pool->nextBuffer = (index + 1) % pool->numBuffers;
+            return parcBuffer_Clear(parcBuffer_Acquire(pool->buffers[index]));
+        }
+    }
+
+    pool->numAllocated++;
+    PARCBuffer *result = parcBuffer_Allocate(pool->bufferCapacity);
+    if (pool->numBuffers < pool->maxBuffers) {
+        pool->buffers[pool->numBuffers++] = parcBuffer_Acquire(result);
+    }
+    return result;
+}
+
+uint64_t
+ccnxSimpleFileTransferBufferPool_GetNumAllocated(const CCNxSimpleFileTransferBufferPool *pool)
+{
+    return pool->numAllocated;
+}
+
+size_t
+ccnxSimpleFileTransferBufferPool_GetSize(const CCNxSimpleFileTransferBufferPool *pool)
+{
+    return pool->numBuffers;
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+#ifndef ccnxSimpleFileTransfer_BufferPool_h
+#define ccnxSimpleFileTransfer_BufferPool_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <parc/algol/parc_Buffer.h>
+
+struct ccnxSimpleFileTransfer_BufferPool;
+
+/**
+ * A `CCNxSimpleFileTransferBufferPool` recycles the PARCBuffers a server reads chunks into, so that once it has
+ * as many as it keeps in flight, serving a chunk from disk doesn't allocate a payload.
+ *
+ * The pool keeps a reference to every buffer it has handed out. A buffer is free again once the pool's is the
+ * only reference left to it and to its PARCByteArray: the Content Object it was the payload of, the messages
+ * wrapping that, and any slice or duplicate of it the encoder made, have all been released, by us and by the
+ * Portal's stack. When every buffer is still in use and the pool is full, a buffer that isn't pooled is handed
+ * out instead.
+ *
+ * Buffers may be released on any thread, but the pool itself is not safe to use from more than one thread, and
+ * it can only tell a buffer is free if the references to it are all released rather than handed on. A response
+ * that may be given to another thread, such as one shared by the in-flight table, must not have a pooled payload.
+ */
+typedef struct ccnxSimpleFileTransfer_BufferPool CCNxSimpleFileTransferBufferPool;
+
+/**
+ * Create a new, empty `CCNxSimpleFileTransferBufferPool`. Buffers are only allocated as they are needed.
+ * The newly created instance must eventually be released by calling `ccnxSimpleFileTransferBufferPool_Release`.
+ *
+ * @param [in] bufferCapacity - the capacity, in bytes, of each buffer.
+ * @param [in] maxBuffers - the most buffers to keep.
+ * @return A new instance.
+ */
+CCNxSimpleFileTransferBufferPool *ccnxSimpleFileTransferBufferPool_Create(size_t bufferCapacity, size_t maxBuffers);
+
+/**
+ * Increase the number of references to a `CCNxSimpleFileTransferBufferPool` instance.
+ *
+ * @param [in] instance A pointer to the original `CCNxSimpleFileTransferBufferPool`.
+ * @return The value of the input parameter @p instance.
+ *
+ * @see ccnxSimpleFileTransferBufferPool_Release
+ */
+CCNxSimpleFileTransferBufferPool *ccnxSimpleFileTransferBufferPool_Acquire(const CCNxSimpleFileTransferBufferPool *instance);
+
+/**
+ * Release a previously acquired reference to the specified instance,
+ * decrementing the reference count for the instance.
+ *
+ * Buffers still in use stay valid until their last reference is released.
+ *
+ * @param [in,out] poolPtr A pointer to a pointer to the instance to release.
+ *
+ * @see ccnxSimpleFileTransferBufferPool_Acquire
+ */
+void ccnxSimpleFileTransferBufferPool_Release(CCNxSimpleFileTransferBufferPool **poolPtr);
+
+/**
+ * Get a buffer that nothing else is using, cleared: its position is 0 and its limit is its capacity.
+ * The returned PARCBuffer must eventually be released by calling parcBuffer_Release(), which returns it to the pool.
+ *
+ * @param [in] pool - the pool.
+ * @return A PARCBuffer of the pool's buffer capacity.
+ */
+PARCBuffer *ccnxSimpleFileTransferBufferPool_GetBuffer(CCNxSimpleFileTransferBufferPool *pool);
+
+/**
+ * Return the number of buffers the pool has allocated, whether it kept them or not.
+ */
+uint64_t ccnxSimpleFileTransferBufferPool_GetNumAllocated(const CCNxSimpleFileTransferBufferPool *pool);
+
+/**
+ * Return the number of buffers the pool keeps.
+ */
+size_t ccnxSimpleFileTransferBufferPool_GetSize(const CCNxSimpleFileTransferBufferPool *pool);
+#endif // ccnxSimpleFileTransfer_BufferPool_h
@@ -0,0 +1,329 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/stat.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Memory.h>
+#include <parc/algol/parc_Buffer.h>
+#include <parc/algol/parc_HashMap.h>
+
+#include "ccnxSimpleFileTransfer_ChunkCache.h"
+#include "ccnxSimpleFileTransfer_AdmissionFilter.h"
+
+/**
+ * The most capacities that can be given on the command line.
+ */
+#define _maxCapacities 16
+
+/**
+ * The capacities tried when none are given, as percentages of the total size of the requested files.
+ */
+static const unsigned int _defaultCapacityPercents[] = { 1, 5, 10, 25, 50 };
+
+typedef struct {
+    char *fileName;
+    size_t sizeBytes;
+} _Request;
+
+typedef struct {
+    _Request *requests;
+    size_t numRequests;
+    size_t numFiles;
+    uint64_t totalFileBytes;    // The size of all the distinct files requested.
+} _RequestTrace;
+
+typedef struct {
+    uint64_t hits;
+    uint64_t hitBytes;
+    uint64_t requestBytes;
+    CCNxSimpleFileTransferChunkCacheStats cacheStats;
+} _ReplayResult;
+
+/**
+ * Display an explanation of arguments accepted by this program.
+ *
+ * @param [in] programName The name of this program.
+ */
+static void
+_displayUsage(char *programName)
+{
+    printf("Usage: %s [-h] [-c <MB>]... [-k <count>] [-d <directory>] <request trace>\n", programName);
+    printf("    Replays a trace of file requests against the server's pre-chunk cache (see the '-m' and '-c'\n");
+    printf("    options of ccnxSimpleFileTransfer_Server), once with each admission policy, and reports the hit\n");
+    printf("    ratios of each:\n");
+    printf("      lru      admits every file, evicting the least recently used.\n");
+    printf("      tinylfu  only admits a file requested more often recently than the files it would evict.\n");
+    printf("    The request trace has one fetch per line: '<file name> [<size in bytes>]'. Blank lines and\n");
+    printf("    lines starting with '#' are ignored.\n");
+    printf("    -c <MB> replays with a cache of <MB> megabytes. May be given more than once. By default, the\n");
+    printf("       capacities tried are 1%%, 5%%, 10%%, 25%% and 50%% of the total size of the requested files.\n");
+    printf("    -k <count> sizes the admission filter for <count> distinct files (the server uses 1024).\n");
+    printf("    -d <directory> takes the size of files that have no size in the trace from <directory>.\n");
+    printf("       Otherwise, they are taken to be 1 byte, so that the byte hit ratio is the hit ratio.\n");
+}
+
+static size_t
+_getSizeFromDirectory(const char *directoryPath, const char *fileName)
+{
+    size_t result = 1;
+
+    if (directoryPath != NULL) {
+        char filePath[PATH_MAX];
+        snprintf(filePath, sizeof(filePath), "%s/%s", directoryPath, fileName);
+        struct stat statBuffer;
+        if (stat(filePath, &statBuffer) == 0) {
+            result = statBuffer.st_size;
+        }
+    }
+    return result;
+}
+
+/**
+ * Read a request trace. The size of a file is the first size given for it.
+ */
+static bool
+_readRequestTrace(const char *traceFileName, const char *directoryPath, _RequestTrace *trace)
+{
+    FILE *traceFile = fopen(traceFileName, "r");
+    if (traceFile == NULL) {
+        return false;
+    }
+
+    memset(trace, 0, sizeof(*trace));
+    size_t capacity = 0;
+
+    // The size of each file, by name.
+    PARCHashMap *fileSizes = parcHashMap_Create();
+
+    char *line = NULL;
+    size_t lineCapacity = 0;
+    while (getline(&line, &lineCapacity, traceFile) > 0) {
+        char *saveState = NULL;
+        char *fileName = strtok_r(line, " \t\r\n", &saveState);
+        if (fileName == NULL || fileName[0] == '#') {
+            continue;
+        }
+        char *sizeString = strtok_r(NULL, " \t\r\n", &saveState);
+
+        PARCBuffer *key = parcBuffer_AllocateCString(fileName);
+        PARCBuffer *knownSize = (PARCBuffer *) parcHashMap_Get(fileSizes, key);
+        size_t sizeBytes = 0;
+        if (knownSize != NULL) {
+            sizeBytes = parcBuffer_GetUint64(knownSize);
+            parcBuffer_Rewind(knownSize);
+        } else {
+            sizeBytes = (sizeString != NULL) ? strtoull(sizeString, NULL, 10) : _getSizeFromDirectory(directoryPath, fileName);
+            PARCBuffer *size = parcBuffer_Allocate(sizeof(uint64_t));
+            parcBuffer_PutUint64(size, sizeBytes);
+            parcBuffer_Flip(size);
+            parcHashMap_Put(fileSizes, key, size);
+            parcBuffer_Release(&size);
+
+            trace->numFiles++;
+            trace->totalFileBytes += sizeBytes;
+        }
+        parcBuffer_Release(&key);
+
+        if (trace->numRequests == capacity) {
+            capacity = (capacity == 0) ? 1024 : capacity * 2;
+            trace->requests = parcMemory_Reallocate(trace->requests, capacity * sizeof(_Request));
+            assertNotNull(trace->requests, "parcMemory_Reallocate(%zu) returned NULL", capacity * sizeof(_Request));
+        }
+        _Request *request = &trace->requests[trace->numRequests++];
+        request->fileName = parcMemory_StringDuplicate(fileName, strlen(fileName));
+        request->sizeBytes = sizeBytes;
+    }
+
+    free(line);
+    parcHashMap_Release(&fileSizes);
+    fclose(traceFile);
+
+    return true;
+}
+
+static void
+_releaseRequestTrace(_RequestTrace *trace)
+{
+    for (size_t i = 0; i < trace->numRequests; i++) {
+        parcMemory_Deallocate((void **) &trace->requests[i].fileName);
+    }
+    if (trace->requests != NULL) {
+        parcMemory_Deallocate((void **) &trace->requests);
+    }
+}
+
+/**
+ * Replay the requests against a cache, the way the server uses it: each fetch is recorded, then either
+ * hits, or the file is admitted (and chunked), or it is served from disk.
+ */
+static _ReplayResult
+_replay(const _RequestTrace *trace, CCNxSimpleFileTransferChunkCache *cache)
+{
+    _ReplayResult result;
+    memset(&result, 0, sizeof(result));
+
+    // The cache only needs something to hold for each file.
+    PARCBuffer *placeholder = parcBuffer_Allocate(1);
+
+    for (size_t i = 0; i < trace->numRequests; i++) {
+        const _Request *request = &trace->requests[i];
+
+        ccnxSimpleFileTransferChunkCache_RecordRequest(cache, request->fileName);
+        result.requestBytes += request->sizeBytes;
+
+        PARCObject *cached = ccnxSimpleFileTransferChunkCache_Get(cache, request->fileName);
+        if (cached != NULL) {
+            result.hits++;
+            result.hitBytes += request->sizeBytes;
+            parcObject_Release(&cached);
+        } else if (ccnxSimpleFileTransferChunkCache_ShouldAdmit(cache, request->fileName, request->sizeBytes)) {
+            ccnxSimpleFileTransferChunkCache_Put(cache, request->fileName, placeholder, request->sizeBytes);
+        }
+    }
+
+    parcBuffer_Release(&placeholder);
+
+    result.cacheStats = ccnxSimpleFileTransferChunkCache_GetStats(cache);
+    return result;
+}
+
+static void
+_printResult(size_t capacityBytes, const char *policyName, const _RequestTrace *trace, const _ReplayResult *result)
+{
+    printf("%14zu  %-8s  %8.2f%%  %8.2f%%  %10" PRIu64 "  %10" PRIu64 "\n",
+           capacityBytes, policyName,
+           (trace->numRequests > 0) ? 100.0 * result->hits / trace->numRequests : 0.0,
+           (result->requestBytes > 0) ? 100.0 * result->hitBytes / result->requestBytes : 0.0,
+           result->cacheStats.evictions,
+           result->cacheStats.rejections);
+}
+
+int
+main(int argc, char *argv[argc])
+{
+    size_t capacities[_maxCapacities];
+    size_t numCapacities = 0;
+    size_t expectedNumFiles = 1024;
+    char *directoryPath = NULL;
+
+    int c;
+    while ((c = getopt(argc, argv, "c:k:d:h")) != -1) {
+        switch (c) {
+            case 'c': // -c 512
+                if (numCapacities < _maxCapacities) {
+                    capacities[numCapacities++] = (size_t) strtoull(optarg, NULL, 10) * 1024 * 1024;
+                }
+                break;
+            case 'k': // -k 4096
+                expectedNumFiles = strtoull(optarg, NULL, 10);
+                break;
+            case 'd': // -d /path/to/files
+                directoryPath = optarg;
+                break;
+            case 'h':
+            default:
+                _displayUsage(argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    if (optind != argc - 1) {
+        _displayUsage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    _RequestTrace trace;
+    if (!_readRequestTrace(argv[optind], directoryPath, &trace)) {
+        fprintf(stderr, "Could not read the request trace '%s'.\n", argv[optind]);
+        exit(EXIT_FAILURE);
+    }
+
+    if (numCapacities == 0) {
+        for (size_t i = 0; i < sizeof(_defaultCapacityPercents) / sizeof(_defaultCapacityPercents[0]); i++) {
+            size_t capacity = trace.totalFileBytes * _defaultCapacityPercents[i] / 100;
+            capacities[numCapacities++] = (capacity > 0) ? capacity : 1;
+        }
+    }
+
+    printf("%zu requests for %zu files totalling %" PRIu64 " bytes.\n\n", trace.numRequests, trace.numFiles, trace.totalFileBytes);
+    printf("%14s  %-8s  %9s  %9s  %10s  %10s\n", "capacity", "policy", "hits", "byte hits", "evictions", "rejections");
+
+    for (size_t i = 0; i < numCapacities; i++) {
+        CCNxSimpleFileTransferChunkCache *lru = ccnxSimpleFileTransferChunkCache_Create(capacities[i], NULL);
+        _ReplayResult lruResult = _replay(&trace, lru);
+        _printResult(capacities[i], "lru", &trace, &lruResult);
+        ccnxSimpleFileTransferChunkCache_Release(&lru);
+
+        CCNxSimpleFileTransferAdmissionFilter *filter = ccnxSimpleFileTransferAdmissionFilter_Create(expectedNumFiles);
+        CCNxSimpleFileTransferChunkCache *tinyLfu = ccnxSimpleFileTransferChunkCache_Create(capacities[i], filter);
+        _ReplayResult tinyLfuResult = _replay(&trace, tinyLfu);
+        _printResult(capacities[i], "tinylfu", &trace, &tinyLfuResult);
+        ccnxSimpleFileTransferChunkCache_Release(&tinyLfu);
+        ccnxSimpleFileTransferAdmissionFilter_Release(&filter);
+    }
+
+    _releaseRequestTrace(&trace);
+
+    exit(EXIT_SUCCESS);
+}
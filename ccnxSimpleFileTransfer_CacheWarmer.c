@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "ccnxSimpleFileTransfer_CacheWarmer.h"
+
+struct ccnxSimpleFileTransfer_CacheWarmer {
+    CCNxSimpleFileTransferCacheWarmerLoader *loader;
+    void *loaderContext;
+    unsigned int numThreads;
+    uint64_t bytesPerSecond;
+
+    char **names;
+    size_t numNames;
+    size_t namesCapacity;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t stopSignal;
+    pthread_t *threads;             // NULL until started, and again once joined.
+
+    // The following are protected by the mutex.
+    size_t nextName;                // The next name for a thread to load.
+    size_t numLoaded;
+    uint64_t paceNanos;             // When the bytes read so far may all have been read, at the warmer's rate.
+    bool isStopping;
+};
+
+static uint64_t
+_nowNanos(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+}
+
+static void *
+_warmer_Run(void *arg)
+{
+    CCNxSimpleFileTransferCacheWarmer *warmer = arg;
+
+    pthread_mutex_lock(&warmer->mutex);
+    while (!warmer->isStopping && warmer->nextName < warmer->numNames) {
+        const char *name = warmer->names[warmer->nextName++];
+        pthread_mutex_unlock(&warmer->mutex);
+
+        bool isLoaded = warmer->loader(warmer->loaderContext, warmer, name);
+
+        pthread_mutex_lock(&warmer->mutex);
+        if (isLoaded) {
+            warmer->numLoaded++;
+        }
+    }
+    pthread_mutex_unlock(&warmer->mutex);
+
+    return NULL;
+}
+
+static void
+_cacheWarmer_Finalize(CCNxSimpleFileTransferCacheWarmer **warmerPtr)
+{
+    CCNxSimpleFileTransferCacheWarmer *warmer = *warmerPtr;
+
+    ccnxSimpleFileTransferCacheWarmer_Stop(warmer);
+
+    for (size_t i = 0; i < warmer->numNames; i++) {
+        parcMemory_Deallocate((void **) &warmer->names[i]);
+    }
+    if (warmer->names != NULL) {
+        parcMemory_Deallocate((void **) &warmer->names);
+    }
+
+    pthread_cond_destroy(&warmer->stopSignal);
+    pthread_mutex_destroy(&warmer->mutex);
+}
+
+parcObject_ExtendPARCObject(CCNxSimpleFileTransferCacheWarmer,
+                            _cacheWarmer_Finalize,
+                            NULL, NULL, NULL, NULL, NULL, NULL);
+
+parcObject_ImplementAcquire(ccnxSimpleFileTransferCacheWarmer, CCNxSimpleFileTransferCacheWarmer);
+
+parcObject_ImplementRelease(ccnxSimpleFileTransferCacheWarmer, CCNxSimpleFileTransferCacheWarmer);
+
+CCNxSimpleFileTransferCacheWarmer *
+ccnxSimpleFileTransferCacheWarmer_Create(CCNxSimpleFileTransferCacheWarmerLoader *loader, void *loaderContext,
+                                         unsigned int numThreads, uint64_t bytesPerSecond)
+{
+    assertNotNull(loader, "Parameter loader must be a non-null pointer");
+    assertTrue(numThreads > 0, "Parameter numThreads must be greater than 0");
+
+    CCNxSimpleFileTransferCacheWarmer *result = parcObject_CreateAndClearInstance(CCNxSimpleFileTransferCacheWarmer);
+
+    result->loader = loader;
+    result->loaderContext = loaderContext;
+    result->numThreads = numThreads;
+    result->bytesPerSecond = bytesPerSecond;
+
+    pthread_mutex_init(&result->mutex, NULL);
+    pthread_cond_init(&result->stopSignal, NULL);
+
+    return result;
+}
+
+void
+ccnxSimpleFileTransferCacheWarmer_AddName(CCNxSimpleFileTransferCacheWarmer *warmer, const char *name)
+{
+    assertNull(warmer->threads, "Names must be added before the warmer is started");
+
+    if (warmer->numNames == warmer->namesCapacity) {
+        size_t newCapacity = (warmer->namesCapacity == 0) ? 64 : warmer->namesCapacity * 2;
+        char **newNames = parcMemory_AllocateAndClear(newCapacity * sizeof(char *));
+        assertNotNull(newNames, "parcMemory_AllocateAndClear(%zu) returned NULL", newCapacity * sizeof(char *));
+        if (warmer->names != NULL) {
+            memcpy(newNames, warmer->names, warmer->numNames * sizeof(char *));
+            parcMemory_Deallocate((void **) &warmer->names);
+        }
+        warmer->names = newNames;
+        warmer->namesCapacity = newCapacity;
+    }
+
+    warmer->names[warmer->numNames++] = parcMemory_StringDuplicate(name, strlen(name));
+}
+
+int
+ccnxSimpleFileTransferCacheWarmer_AddNamesFromFile(CCNxSimpleFileTransferCacheWarmer *warmer, const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return -1;
+    }
+
+    int result = 0;
+    char line[1024];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line[strcspn(line, " \t\r\n")] = '\0';
+        if (line[0] != '\0' && line[0] != '#') {
+            ccnxSimpleFileTransferCacheWarmer_AddName(warmer, line);
+            result++;
+        }
+    }
+    fclose(file);
+
+    return result;
+}
+
+void
+ccnxSimpleFileTransferCacheWarmer_Start(CCNxSimpleFileTransferCacheWarmer *warmer)
+{
+    assertNull(warmer->threads, "The warmer has already been started");
+
+    warmer->paceNanos = _nowNanos();
+
+    warmer->threads = parcMemory_AllocateAndClear(warmer->numThreads * sizeof(pthread_t));
+    assertNotNull(warmer->threads, "parcMemory_AllocateAndClear(%zu) returned NULL", warmer->numThreads * sizeof(pthread_t));
+
+    for (unsigned int i = 0; i < warmer->numThreads; i++) {
+        int failure = pthread_create(&warmer->threads[i], NULL, _warmer_Run, warmer);
+        assertTrue(failure == 0, "Could not start warming thread %u: %s", i, strerror(failure));
+    }
+}
+
+bool
+ccnxSimpleFileTransferCacheWarmer_Pace(CCNxSimpleFileTransferCacheWarmer *warmer, size_t numBytes)
+{
+    pthread_mutex_lock(&warmer->mutex);
+
+    if (warmer->bytesPerSecond > 0) {
+        // Don't let time spent idle be saved up for a burst later.
+        uint64_t nowNanos = _nowNanos();
+        if (warmer->paceNanos < nowNanos) {
+            warmer->paceNanos = nowNanos;
+        }
+        warmer->paceNanos += (uint64_t) ((double) numBytes * 1e9 / (double) warmer->bytesPerSecond);
+
+        // The condition variable waits on the real time clock, so convert the deadline to it.
+        uint64_t waitNanos = warmer->paceNanos - nowNanos;
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += (time_t) (waitNanos / 1000000000ULL);
+        deadline.tv_nsec += (long) (waitNanos % 1000000000ULL);
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        while (!warmer->isStopping
+               && pthread_cond_timedwait(&warmer->stopSignal, &warmer->mutex, &deadline) != ETIMEDOUT) {
+            // Spurious wakeup. Keep waiting.
+        }
+    }
+
+    bool result = !warmer->isStopping;
+    pthread_mutex_unlock(&warmer->mutex);
+
+    return result;
+}
+
+void
+ccnxSimpleFileTransferCacheWarmer_Join(CCNxSimpleFileTransferCacheWarmer *warmer)
+{
+    if (warmer->threads != NULL) {
+        for (unsigned int i = 0; i < warmer->numThreads; i++) {
+            pthread_join(warmer->threads[i], NULL);
+        }
+        parcMemory_Deallocate((void **) &warmer->threads);
+    }
+}
+
+void
+ccnxSimpleFileTransferCacheWarmer_Stop(CCNxSimpleFileTransferCacheWarmer *warmer)
+{
+    pthread_mutex_lock(&warmer->mutex);
+    warmer->isStopping = true;
+    pthread_cond_broadcast(&warmer->stopSignal);
+    pthread_mutex_unlock(&warmer->mutex);
+
+    ccnxSimpleFileTransferCacheWarmer_Join(warmer);
+}
+
+size_t
+ccnxSimpleFileTransferCacheWarmer_GetNumLoaded(CCNxSimpleFileTransferCacheWarmer *warmer)
+{
+    pthread_mutex_lock(&warmer->mutex);
+    size_t result = warmer->numLoaded;
+    pthread_mutex_unlock(&warmer->mutex);
+
+    return result;
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+#ifndef ccnxSimpleFileTransfer_CacheWarmer_h
+#define ccnxSimpleFileTransfer_CacheWarmer_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct ccnxSimpleFileTransfer_CacheWarmer;
+
+/**
+ * A `CCNxSimpleFileTransferCacheWarmer` loads a list of files into a cache on background threads, e.g. to
+ * pre-chunk the files that were popular before the server restarted, so that their first requests don't pay
+ * for reading and chunking them.
+ *
+ * Loading is paced to a number of bytes per second, so that warming doesn't starve live requests of disk
+ * bandwidth. The loader reports what it reads through `ccnxSimpleFileTransferCacheWarmer_Pace`.
+ */
+typedef struct ccnxSimpleFileTransfer_CacheWarmer CCNxSimpleFileTransferCacheWarmer;
+
+/**
+ * Load one file into the cache, calling `ccnxSimpleFileTransferCacheWarmer_Pace` as it is read.
+ * Called on one of the warmer's threads.
+ *
+ * @return true if the file was loaded.
+ */
+typedef bool (CCNxSimpleFileTransferCacheWarmerLoader)(void *loaderContext, CCNxSimpleFileTransferCacheWarmer *warmer,
+                                                        const char *name);
+
+/**
+ * Create a new `CCNxSimpleFileTransferCacheWarmer` with no files to load.
+ * The newly created instance must eventually be released by calling `ccnxSimpleFileTransferCacheWarmer_Release`.
+ *
+ * @param [in] loader - loads each file.
+ * @param [in] loaderContext - passed to `loader`.
+ * @param [in] numThreads - how many files to load at once.
+ * @param [in] bytesPerSecond - the most the loaders may read per second, together. 0 means unlimited.
+ */
+CCNxSimpleFileTransferCacheWarmer *ccnxSimpleFileTransferCacheWarmer_Create(CCNxSimpleFileTransferCacheWarmerLoader *loader,
+                                                                            void *loaderContext,
+                                                                            unsigned int numThreads,
+                                                                            uint64_t bytesPerSecond);
+
+/**
+ * Increase the number of references to a `CCNxSimpleFileTransferCacheWarmer` instance.
+ *
+ * @param [in] instance A pointer to the original `CCNxSimpleFileTransferCacheWarmer`.
+ * @return The value of the input parameter @p instance.
+ *
+ * @see ccnxSimpleFileTransferCacheWarmer_Release
+ */
+CCNxSimpleFileTransferCacheWarmer *ccnxSimpleFileTransferCacheWarmer_Acquire(const CCNxSimpleFileTransferCacheWarmer *instance);
+
+/**
+ * Release a previously acquired reference to the specified instance,
+ * decrementing the reference count for the instance. A warmer that is still loading is stopped first.
+ *
+ * @param [in,out] warmerPtr A pointer to a pointer to the instance to release.
+ *
+ * @see ccnxSimpleFileTransferCacheWarmer_Acquire
+ */
+void ccnxSimpleFileTransferCacheWarmer_Release(CCNxSimpleFileTransferCacheWarmer **warmerPtr);
+
+/**
+ * Add a file to the end of the list to load. Files are loaded in the order they are added.
+ * Must be called before `ccnxSimpleFileTransferCacheWarmer_Start`.
+ *
+ * @param [in] warmer - the warmer.
+ * @param [in] name - the name of the file, which is copied.
+ */
+void ccnxSimpleFileTransferCacheWarmer_AddName(CCNxSimpleFileTransferCacheWarmer *warmer, const char *name);
+
+/**
+ * Add the files named in a text file, one per line, to the list to load. Blank lines and lines starting
+ * with '#' are skipped, as is anything after the first space or tab on a line, so that a request trace
+ * of `<file name> <size>` lines can be used too.
+ *
+ * @param [in] warmer - the warmer.
+ * @param [in] path - the text file.
+ *
+ * @return The number of names added, or -1 if the file could not be read.
+ */
+int ccnxSimpleFileTransferCacheWarmer_AddNamesFromFile(CCNxSimpleFileTransferCacheWarmer *warmer, const char *path);
+
+/**
+ * Start loading the files on the warmer's threads. It returns immediately.
+ *
+ * @param [in] warmer - the warmer.
+ */
+void ccnxSimpleFileTransferCacheWarmer_Start(CCNxSimpleFileTransferCacheWarmer *warmer);
+
+/**
+ * Account for `numBytes` read by a loader, waiting as long as needed to keep within the warmer's rate.
+ *
+ * @param [in] warmer - the warmer.
+ * @param [in] numBytes - the number of bytes just read.
+ *
+ * @return false if the warmer is being stopped, in which case the loader should give up.
+ */
+bool ccnxSimpleFileTransferCacheWarmer_Pace(CCNxSimpleFileTransferCacheWarmer *warmer, size_t numBytes);
+
+/**
+ * Wait until every file has been loaded (or failed to load).
+ *
+ * @param [in] warmer - the warmer.
+ */
+void ccnxSimpleFileTransferCacheWarmer_Join(CCNxSimpleFileTransferCacheWarmer *warmer);
+
+/**
+ * Stop loading files, and wait for the loaders that are running to return.
+ *
+ * @param [in] warmer - the warmer.
+ */
+void ccnxSimpleFileTransferCacheWarmer_Stop(CCNxSimpleFileTransferCacheWarmer *warmer);
+
+/**
+ * Return the number of files that have been loaded so far.
+ *
+ * @param [in] warmer - the warmer.
+ */
+size_t ccnxSimpleFileTransferCacheWarmer_GetNumLoaded(CCNxSimpleFileTransferCacheWarmer *warmer);
+
+#endif // ccnxSimpleFileTransfer_CacheWarmer_h
@@ -0,0 +1,350 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <pthread.h>
+#include <string.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+#include <parc/algol/parc_HashMap.h>
+#include <parc/algol/parc_Buffer.h>
+
+#include "ccnxSimpleFileTransfer_ChunkCache.h"
+
+/**
+ * A cached entry. The entries are also kept on a list from the most to the least recently used.
+ */
+typedef struct chunkCacheEntry {
+    char *key;
+    PARCObject *value;
+    size_t sizeBytes;
+    struct chunkCacheEntry *newer;
+    struct chunkCacheEntry *older;
+} _ChunkCacheEntry;
+
+static void
+_chunkCacheEntry_Finalize(_ChunkCacheEntry **entryPtr)
+{
+    _ChunkCacheEntry *entry = *entryPtr;
+    parcMemory_Deallocate((void **) &entry->key);
+    parcObject_Release(&entry->value);
+}
+
+parcObject_ExtendPARCObject(_ChunkCacheEntry, _chunkCacheEntry_Finalize, NULL, NULL, NULL, NULL, NULL, NULL);
+
+struct ccnxSimpleFileTransfer_ChunkCache {
+    size_t capacityBytes;
+    CCNxSimpleFileTransferAdmissionFilter *admissionFilter;
+
+    pthread_mutex_t mutex;          // So a cache can be warmed by one thread while another serves from it.
+
+    PARCHashMap *entries;           // PARCBuffer key -> _ChunkCacheEntry
+    _ChunkCacheEntry *newest;
+    _ChunkCacheEntry *oldest;
+
+    CCNxSimpleFileTransferChunkCacheStats stats;
+};
+
+static _ChunkCacheEntry *
+_findEntry(const CCNxSimpleFileTransferChunkCache *cache, const char *key)
+{
+    PARCBuffer *mapKey = parcBuffer_AllocateCString(key);
+    _ChunkCacheEntry *result = (_ChunkCacheEntry *) parcHashMap_Get(cache->entries, mapKey);
+    parcBuffer_Release(&mapKey);
+    return result;
+}
+
+static void
+_unlink(CCNxSimpleFileTransferChunkCache *cache, _ChunkCacheEntry *entry)
+{
+    if (entry->newer != NULL) {
+        entry->newer->older = entry->older;
+    } else {
+        cache->newest = entry->older;
+    }
+    if (entry->older != NULL) {
+        entry->older->newer = entry->newer;
+    } else {
+        cache->oldest = entry->newer;
+    }
+    entry->newer = NULL;
+    entry->older = NULL;
+}
+
+static void
+_linkAsNewest(CCNxSimpleFileTransferChunkCache *cache, _ChunkCacheEntry *entry)
+{
+    entry->older = cache->newest;
+    entry->newer = NULL;
+    if (cache->newest != NULL) {
+        cache->newest->newer = entry;
+    } else {
+        cache->oldest = entry;
+    }
+    cache->newest = entry;
+}
+
+static void
+_removeEntry(CCNxSimpleFileTransferChunkCache *cache, _ChunkCacheEntry *entry)
+{
+    _unlink(cache, entry);
+    cache->stats.sizeBytes -= entry->sizeBytes;
+    cache->stats.numEntries--;
+
+    PARCBuffer *mapKey = parcBuffer_AllocateCString(entry->key);
+    parcHashMap_Remove(cache->entries, mapKey); // Releases the entry.
+    parcBuffer_Release(&mapKey);
+}
+
+static void
+_chunkCache_Finalize(CCNxSimpleFileTransferChunkCache **cachePtr)
+{
+    CCNxSimpleFileTransferChunkCache *cache = *cachePtr;
+
+    parcHashMap_Release(&cache->entries);
+    if (cache->admissionFilter != NULL) {
+        ccnxSimpleFileTransferAdmissionFilter_Release(&cache->admissionFilter);
+    }
+    pthread_mutex_destroy(&cache->mutex);
+}
+
+parcObject_ExtendPARCObject(CCNxSimpleFileTransferChunkCache,
+                            _chunkCache_Finalize,
+                            NULL, NULL, NULL, NULL, NULL, NULL);
+
+parcObject_ImplementAcquire(ccnxSimpleFileTransferChunkCache, CCNxSimpleFileTransferChunkCache);
+
+parcObject_ImplementRelease(ccnxSimpleFileTransferChunkCache, CCNxSimpleFileTransferChunkCache);
+
+CCNxSimpleFileTransferChunkCache *
+ccnxSimpleFileTransferChunkCache_Create(size_t capacityBytes, CCNxSimpleFileTransferAdmissionFilter *admissionFilter)
+{
+    CCNxSimpleFileTransferChunkCache *result = parcObject_CreateAndClearInstance(CCNxSimpleFileTransferChunkCache);
+
+    result->capacityBytes = capacityBytes;
+    if (admissionFilter != NULL) {
+        result->admissionFilter = ccnxSimpleFileTransferAdmissionFilter_Acquire(admissionFilter);
+    }
+    result->entries = parcHashMap_Create();
+    pthread_mutex_init(&result->mutex, NULL);
+
+    return result;
+}
+
+void
+ccnxSimpleFileTransferChunkCache_RecordRequest(CCNxSimpleFileTransferChunkCache *cache, const char *key)
+{
+    if (cache->admissionFilter != NULL) {
+        pthread_mutex_lock(&cache->mutex);
+        ccnxSimpleFileTransferAdmissionFilter_RecordAccess(cache->admissionFilter, key);
+        pthread_mutex_unlock(&cache->mutex);
+    }
+}
+
+PARCObject *
+ccnxSimpleFileTransferChunkCache_Get(CCNxSimpleFileTransferChunkCache *cache, const char *key)
+{
+    PARCObject *result = NULL;
+
+    pthread_mutex_lock(&cache->mutex);
+    _ChunkCacheEntry *entry = _findEntry(cache, key);
+    if (entry != NULL) {
+        _unlink(cache, entry);
+        _linkAsNewest(cache, entry);
+        result = parcObject_Acquire(entry->value);
+        cache->stats.hits++;
+    } else {
+        cache->stats.misses++;
+    }
+    pthread_mutex_unlock(&cache->mutex);
+
+    return result;
+}
+
+bool
+ccnxSimpleFileTransferChunkCache_ShouldAdmit(CCNxSimpleFileTransferChunkCache *cache, const char *key, size_t sizeBytes)
+{
+    bool result = true;
+
+    pthread_mutex_lock(&cache->mutex);
+    if (cache->capacityBytes > 0) {
+        if (sizeBytes > cache->capacityBytes) {
+            result = false;
+        } else if (cache->admissionFilter != NULL) {
+            // Compare the candidate with each entry that would have to go to make room for it.
+            size_t freeBytes = cache->capacityBytes - cache->stats.sizeBytes;
+            for (_ChunkCacheEntry *victim = cache->oldest; victim != NULL && freeBytes < sizeBytes; victim = victim->newer) {
+                if (strcmp(victim->key, key) != 0) {
+                    if (!ccnxSimpleFileTransferAdmissionFilter_Admit(cache->admissionFilter, key, victim->key)) {
+                        result = false;
+                        break;
+                    }
+                }
+                freeBytes += victim->sizeBytes;
+            }
+        }
+    }
+
+    if (result) {
+        cache->stats.admissions++;
+    } else {
+        cache->stats.rejections++;
+    }
+    pthread_mutex_unlock(&cache->mutex);
+
+    return result;
+}
+
+/**
+ * Add an entry, replacing any with the same key and evicting the least recently used entries to make room.
+ * The cache must be locked.
+ */
+static void
+_putEntry(CCNxSimpleFileTransferChunkCache *cache, const char *key, PARCObject *value, size_t sizeBytes)
+{
+    _ChunkCacheEntry *existing = _findEntry(cache, key);
+    if (existing != NULL) {
+        _removeEntry(cache, existing);
+    }
+
+    if (cache->capacityBytes > 0) {
+        while (cache->oldest != NULL && cache->stats.sizeBytes + sizeBytes > cache->capacityBytes) {
+            _removeEntry(cache, cache->oldest);
+            cache->stats.evictions++;
+        }
+    }
+
+    _ChunkCacheEntry *entry = parcObject_CreateAndClearInstance(_ChunkCacheEntry);
+    entry->key = parcMemory_StringDuplicate(key, strlen(key));
+    entry->value = parcObject_Acquire(value);
+    entry->sizeBytes = sizeBytes;
+
+    PARCBuffer *mapKey = parcBuffer_AllocateCString(key);
+    parcHashMap_Put(cache->entries, mapKey, entry);
+    parcBuffer_Release(&mapKey);
+
+    _linkAsNewest(cache, entry);
+    cache->stats.sizeBytes += sizeBytes;
+    cache->stats.numEntries++;
+
+    parcObject_Release((PARCObject **) &entry);
+}
+
+static bool
+_hasRoomFor(const CCNxSimpleFileTransferChunkCache *cache, const char *key, size_t sizeBytes)
+{
+    return _findEntry(cache, key) == NULL
+           && (cache->capacityBytes == 0 || cache->stats.sizeBytes + sizeBytes <= cache->capacityBytes);
+}
+
+void
+ccnxSimpleFileTransferChunkCache_Put(CCNxSimpleFileTransferChunkCache *cache, const char *key, PARCObject *value,
+                                     size_t sizeBytes)
+{
+    pthread_mutex_lock(&cache->mutex);
+    _putEntry(cache, key, value, sizeBytes);
+    pthread_mutex_unlock(&cache->mutex);
+}
+
+bool
+ccnxSimpleFileTransferChunkCache_HasRoomFor(CCNxSimpleFileTransferChunkCache *cache, const char *key, size_t sizeBytes)
+{
+    pthread_mutex_lock(&cache->mutex);
+    bool result = _hasRoomFor(cache, key, sizeBytes);
+    pthread_mutex_unlock(&cache->mutex);
+
+    return result;
+}
+
+bool
+ccnxSimpleFileTransferChunkCache_PutIfRoom(CCNxSimpleFileTransferChunkCache *cache, const char *key, PARCObject *value,
+                                           size_t sizeBytes)
+{
+    pthread_mutex_lock(&cache->mutex);
+    bool result = _hasRoomFor(cache, key, sizeBytes);
+    if (result) {
+        _putEntry(cache, key, value, sizeBytes);
+    }
+    pthread_mutex_unlock(&cache->mutex);
+
+    return result;
+}
+
+void
+ccnxSimpleFileTransferChunkCache_ForEachKey(CCNxSimpleFileTransferChunkCache *cache,
+                                            CCNxSimpleFileTransferChunkCacheKeyCallback *callback,
+                                            void *callbackContext)
+{
+    pthread_mutex_lock(&cache->mutex);
+    for (_ChunkCacheEntry *entry = cache->newest; entry != NULL; entry = entry->older) {
+        callback(callbackContext, entry->key, entry->sizeBytes);
+    }
+    pthread_mutex_unlock(&cache->mutex);
+}
+
+CCNxSimpleFileTransferChunkCacheStats
+ccnxSimpleFileTransferChunkCache_GetStats(const CCNxSimpleFileTransferChunkCache *cache)
+{
+    CCNxSimpleFileTransferChunkCache *lockable = (CCNxSimpleFileTransferChunkCache *) cache;
+
+    pthread_mutex_lock(&lockable->mutex);
+    CCNxSimpleFileTransferChunkCacheStats result = cache->stats;
+    pthread_mutex_unlock(&lockable->mutex);
+
+    return result;
+}
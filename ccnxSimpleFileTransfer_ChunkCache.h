@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+#ifndef ccnxSimpleFileTransfer_ChunkCache_h
+#define ccnxSimpleFileTransfer_ChunkCache_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <parc/algol/parc_Object.h>
+
+#include "ccnxSimpleFileTransfer_AdmissionFilter.h"
+
+struct ccnxSimpleFileTransfer_ChunkCache;
+
+/**
+ * A `CCNxSimpleFileTransferChunkCache` holds pre-chunked files (or any PARCObject) by name, up to a capacity
+ * in bytes, evicting the least recently used when it needs room.
+ *
+ * With an admission filter, a file is only admitted if it has been requested more often recently than each
+ * of the files it would evict, as recorded by `ccnxSimpleFileTransferChunkCache_RecordRequest`.
+ *
+ * A cache may be used from several threads, e.g. one warming it while another serves from it.
+ */
+typedef struct ccnxSimpleFileTransfer_ChunkCache CCNxSimpleFileTransferChunkCache;
+
+/**
+ * Counts of what a cache has done.
+ */
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t admissions;        // Candidates that ccnxSimpleFileTransferChunkCache_ShouldAdmit accepted.
+    uint64_t rejections;        // Candidates that ccnxSimpleFileTransferChunkCache_ShouldAdmit refused.
+    uint64_t evictions;
+    size_t numEntries;
+    size_t sizeBytes;
+} CCNxSimpleFileTransferChunkCacheStats;
+
+/**
+ * Called for each entry in a cache by `ccnxSimpleFileTransferChunkCache_ForEachKey`.
+ */
+typedef void (CCNxSimpleFileTransferChunkCacheKeyCallback)(void *callbackContext, const char *key, size_t sizeBytes);
+
+/**
+ * Create a new, empty `CCNxSimpleFileTransferChunkCache`.
+ * The newly created instance must eventually be released by calling `ccnxSimpleFileTransferChunkCache_Release`.
+ *
+ * @param [in] capacityBytes - the most the entries may add up to. 0 means unlimited.
+ * @param [in] admissionFilter - decides what is admitted when something must be evicted, or NULL to admit everything.
+ */
+CCNxSimpleFileTransferChunkCache *ccnxSimpleFileTransferChunkCache_Create(size_t capacityBytes,
+                                                                          CCNxSimpleFileTransferAdmissionFilter *admissionFilter);
+
+/**
+ * Increase the number of references to a `CCNxSimpleFileTransferChunkCache` instance.
+ *
+ * @param [in] instance A pointer to the original `CCNxSimpleFileTransferChunkCache`.
+ * @return The value of the input parameter @p instance.
+ *
+ * @see ccnxSimpleFileTransferChunkCache_Release
+ */
+CCNxSimpleFileTransferChunkCache *ccnxSimpleFileTransferChunkCache_Acquire(const CCNxSimpleFileTransferChunkCache *instance);
+
+/**
+ * Release a previously acquired reference to the specified instance,
+ * decrementing the reference count for the instance.
+ *
+ * @param [in,out] cachePtr A pointer to a pointer to the instance to release.
+ *
+ * @see ccnxSimpleFileTransferChunkCache_Acquire
+ */
+void ccnxSimpleFileTransferChunkCache_Release(CCNxSimpleFileTransferChunkCache **cachePtr);
+
+/**
+ * Record a request for an entry in the admission filter, whether or not it is cached. Record each request for a
+ * whole file once (e.g. when its first chunk is requested), not each chunk, or big files will seem more popular
+ * than small ones.
+ *
+ * @param [in] cache - the cache.
+ * @param [in] key - the name of the entry, e.g. a file name.
+ */
+void ccnxSimpleFileTransferChunkCache_RecordRequest(CCNxSimpleFileTransferChunkCache *cache, const char *key);
+
+/**
+ * Look up an entry, making it the most recently used.
+ * The returned PARCObject must eventually be released by calling parcObject_Release().
+ *
+ * @param [in] cache - the cache.
+ * @param [in] key - the name of the entry, e.g. a file name.
+ *
+ * @return The cached PARCObject, or NULL if there isn't one.
+ */
+PARCObject *ccnxSimpleFileTransferChunkCache_Get(CCNxSimpleFileTransferChunkCache *cache, const char *key);
+
+/**
+ * Decide whether an entry of the specified size should be added, before going to the trouble of creating it.
+ * It is refused if it is bigger than the capacity, or if there is an admission filter and it hasn't been requested
+ * more often than each of the entries that would be evicted to make room for it.
+ *
+ * @param [in] cache - the cache.
+ * @param [in] key - the name of the entry.
+ * @param [in] sizeBytes - the size of the entry.
+ */
+bool ccnxSimpleFileTransferChunkCache_ShouldAdmit(CCNxSimpleFileTransferChunkCache *cache, const char *key, size_t sizeBytes);
+
+/**
+ * Add an entry, replacing any entry with the same key, and evicting the least recently used entries to make room.
+ *
+ * @param [in] cache - the cache.
+ * @param [in] key - the name of the entry.
+ * @param [in] value - the entry, which is acquired by the cache.
+ * @param [in] sizeBytes - the size of the entry.
+ */
+void ccnxSimpleFileTransferChunkCache_Put(CCNxSimpleFileTransferChunkCache *cache, const char *key, PARCObject *value,
+                                          size_t sizeBytes);
+
+/**
+ * Decide whether an entry could be added by `ccnxSimpleFileTransferChunkCache_PutIfRoom`: that is, whether
+ * there is no entry with the same key and it fits in the free space.
+ *
+ * @param [in] cache - the cache.
+ * @param [in] key - the name of the entry.
+ * @param [in] sizeBytes - the size of the entry.
+ */
+bool ccnxSimpleFileTransferChunkCache_HasRoomFor(CCNxSimpleFileTransferChunkCache *cache, const char *key, size_t sizeBytes);
+
+/**
+ * Add an entry only if there is no entry with the same key and it fits without evicting anything. Use this
+ * for speculative entries, such as files pre-chunked at startup, that shouldn't displace ones being used.
+ * The admission filter isn't consulted.
+ *
+ * @param [in] cache - the cache.
+ * @param [in] key - the name of the entry.
+ * @param [in] value - the entry, which is acquired by the cache if it is added.
+ * @param [in] sizeBytes - the size of the entry.
+ *
+ * @return true if the entry was added.
+ */
+bool ccnxSimpleFileTransferChunkCache_PutIfRoom(CCNxSimpleFileTransferChunkCache *cache, const char *key, PARCObject *value,
+                                                size_t sizeBytes);
+
+/**
+ * Call a function with the key and size of each entry, from the most to the least recently used.
+ * The cache is locked meanwhile, so the callback must not use it.
+ *
+ * @param [in] cache - the cache.
+ * @param [in] callback - called for each entry.
+ * @param [in] callbackContext - passed to `callback`.
+ */
+void ccnxSimpleFileTransferChunkCache_ForEachKey(CCNxSimpleFileTransferChunkCache *cache,
+                                                 CCNxSimpleFileTransferChunkCacheKeyCallback *callback,
+                                                 void *callbackContext);
+
+/**
+ * Get the counts of what the cache has done.
+ *
+ * @param [in] cache - the cache.
+ */
+CCNxSimpleFileTransferChunkCacheStats ccnxSimpleFileTransferChunkCache_GetStats(const CCNxSimpleFileTransferChunkCache *cache);
+
+#endif // ccnxSimpleFileTransfer_ChunkCache_h
@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <string.h>
+#include <unistd.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+#include <parc/security/parc_CryptoHasher.h>
+
+#include "ccnxSimpleFileTransfer_ChunkDigests.h"
+
+static const uint32_t _digestsMagic = 0x53465444; // "SFTD"
+
+/**
+ * How much of the file is read at a time while computing its digests.
+ */
+static const size_t _readSize = 1024 * 1024;
+
+struct ccnxSimpleFileTransfer_ChunkDigests {
+    uint64_t fileSize;
+    size_t chunkSize;
+    uint64_t numChunks;
+    uint8_t *chunkDigests;      // numChunks digests, one after another.
+    uint8_t fileDigest[ccnxSimpleFileTransferChunkDigests_DigestLength];
+    PARCCryptoHasher *hasher;   // Reused for each digest, as creating one is much slower than hashing a chunk.
+};
+
+/**
+ * Compute the SHA-256 digest of some data.
+ */
+static void
+_computeDigest(PARCCryptoHasher *hasher, const uint8_t *data, size_t length,
+               uint8_t digest[ccnxSimpleFileTransferChunkDigests_DigestLength])
+{
+    parcCryptoHasher_Init(hasher);
+    parcCryptoHasher_UpdateBytes(hasher, data, length);
+    PARCCryptoHash *hash = parcCryptoHasher_Finalize(hasher);
+
+    PARCBuffer *hashDigest = parcCryptoHash_GetDigest(hash);
+    memcpy(digest, parcBuffer_Overlay(hashDigest, 0), ccnxSimpleFileTransferChunkDigests_DigestLength);
+
+    parcCryptoHash_Release(&hash);
+}
+
+static void
+_chunkDigests_Finalize(CCNxSimpleFileTransferChunkDigests **digestsPtr)
+{
+    CCNxSimpleFileTransferChunkDigests *digests = *digestsPtr;
+
+    if (digests->chunkDigests != NULL) {
+        parcMemory_Deallocate((void **) &digests->chunkDigests);
+    }
+    parcCryptoHasher_Release(&digests->hasher);
+}
+
+parcObject_ExtendPARCObject(CCNxSimpleFileTransferChunkDigests,
+                            _chunkDigests_Finalize,
+                            NULL, NULL, NULL, NULL, NULL, NULL);
+
+parcObject_ImplementAcquire(ccnxSimpleFileTransferChunkDigests, CCNxSimpleFileTransferChunkDigests);
+
+parcObject_ImplementRelease(ccnxSimpleFileTransferChunkDigests, CCNxSimpleFileTransferChunkDigests);
+
+static CCNxSimpleFileTransferChunkDigests *
+_create(uint64_t fileSize, size_t chunkSize)
+{
+    CCNxSimpleFileTransferChunkDigests *result = parcObject_CreateAndClearInstance(CCNxSimpleFileTransferChunkDigests);
+
+    result->fileSize = fileSize;
+    result->chunkSize = chunkSize;
+    result->numChunks = (fileSize + chunkSize - 1) / chunkSize;
+    if (result->numChunks > 0) {
+        result->chunkDigests = parcMemory_AllocateAndClear(result->numChunks * ccnxSimpleFileTransferChunkDigests_DigestLength);
+        assertNotNull(result->chunkDigests, "parcMemory_AllocateAndClear(%zu) returned NULL",
+                      (size_t) (result->numChunks * ccnxSimpleFileTransferChunkDigests_DigestLength));
+    }
+    result->hasher = parcCryptoHasher_Create(PARCCryptoHashType_SHA256);
+
+    return result;
+}
+
+/**
+ * The digest of the whole file: the digest of the chunk digests.
+ */
+static void
+_computeFileDigest(CCNxSimpleFileTransferChunkDigests *digests, uint8_t digest[ccnxSimpleFileTransferChunkDigests_DigestLength])
+{
+    _computeDigest(digests->hasher, digests->chunkDigests,
+                   (size_t) (digests->numChunks * ccnxSimpleFileTransferChunkDigests_DigestLength), digest);
+}
+
+CCNxSimpleFileTransferChunkDigests *
+ccnxSimpleFileTransferChunkDigests_CreateFromFile(int fileDescriptor, size_t fileSize, size_t chunkSize)
+{
+    assertTrue(chunkSize > 0, "The chunk size must be greater than 0");
+
+    CCNxSimpleFileTransferChunkDigests *result = _create(fileSize, chunkSize);
+
+    // Read whole chunks, a good many at a time.
+    size_t bufferSize = (_readSize / chunkSize + 1) * chunkSize;
+    uint8_t *buffer = parcMemory_Allocate(bufferSize);
+    assertNotNull(buffer, "parcMemory_Allocate(%zu) returned NULL", bufferSize);
+
+    uint64_t chunkNumber = 0;
+    uint64_t offset = 0;
+    while (result != NULL && offset < fileSize) {
+        size_t wanted = (fileSize - offset < bufferSize) ? (size_t) (fileSize - offset) : bufferSize;
+        size_t numRead = 0;
+        while (numRead < wanted) {
+            ssize_t n = pread(fileDescriptor, buffer + numRead, wanted - numRead, (off_t) (offset + numRead));
+            if (n <= 0) {
+                break;
+            }
+            numRead += (size_t) n;
+        }
+
+        if (numRead < wanted) {
+            ccnxSimpleFileTransferChunkDigests_Release(&result); // The file was shortened, or couldn't be read.
+        } else {
+            for (size_t chunkStart = 0; chunkStart < numRead; chunkStart += chunkSize, chunkNumber++) {
+                size_t length = (numRead - chunkStart < chunkSize) ? numRead - chunkStart : chunkSize;
+                _computeDigest(result->hasher, buffer + chunkStart, length,
+                               result->chunkDigests + chunkNumber * ccnxSimpleFileTransferChunkDigests_DigestLength);
+            }
+            offset += numRead;
+        }
+    }
+
+    if (result != NULL) {
+        _computeFileDigest(result, result->fileDigest);
+    }
+
+    parcMemory_Deallocate((void **) &buffer);
+
+    return result;
+}
+
+CCNxSimpleFileTransferChunkDigests *
+ccnxSimpleFileTransferChunkDigests_CreateFromBuffer(const PARCBuffer *buffer)
+{
+    CCNxSimpleFileTransferChunkDigests *result = NULL;
+
+    const size_t headerSize = 4 + 4 + 8 + ccnxSimpleFileTransferChunkDigests_DigestLength;
+    PARCBuffer *reader = parcBuffer_Slice(buffer);
+
+    if (parcBuffer_Remaining(reader) >= headerSize && parcBuffer_GetUint32(reader) == _digestsMagic) {
+        uint32_t chunkSize = parcBuffer_GetUint32(reader);
+        uint64_t fileSize = parcBuffer_GetUint64(reader);
+
+        if (chunkSize > 0) {
+            uint64_t numChunks = (fileSize + chunkSize - 1) / chunkSize;
+            if (numChunks <= parcBuffer_Remaining(reader) / ccnxSimpleFileTransferChunkDigests_DigestLength
+                && parcBuffer_Remaining(reader) == ccnxSimpleFileTransferChunkDigests_DigestLength
+                                                   + numChunks * ccnxSimpleFileTransferChunkDigests_DigestLength) {
+                result = _create(fileSize, chunkSize);
+                parcBuffer_GetBytes(reader, ccnxSimpleFileTransferChunkDigests_DigestLength, result->fileDigest);
+                if (numChunks > 0) {
+                    parcBuffer_GetBytes(reader, (size_t) (numChunks * ccnxSimpleFileTransferChunkDigests_DigestLength),
+                                        result->chunkDigests);
+                }
+
+                uint8_t fileDigest[ccnxSimpleFileTransferChunkDigests_DigestLength];
+                _computeFileDigest(result, fileDigest);
+                if (memcmp(fileDigest, result->fileDigest, sizeof(fileDigest)) != 0) {
+                    ccnxSimpleFileTransferChunkDigests_Release(&result);
+                }
+            }
+        }
+    }
+
+    parcBuffer_Release(&reader);
+
+    return result;
+}
+
+PARCBuffer *
+ccnxSimpleFileTransferChunkDigests_CreateBuffer(const CCNxSimpleFileTransferChunkDigests *digests)
+{
+    size_t size = 4 + 4 + 8 + (digests->numChunks + 1) * ccnxSimpleFileTransferChunkDigests_DigestLength;
+    PARCBuffer *result = parcBuffer_Allocate(size);
+
+    parcBuffer_PutUint32(result, _digestsMagic);
+    parcBuffer_PutUint32(result, (uint32_t) digests->chunkSize);
+    parcBuffer_PutUint64(result, digests->fileSize);
+    parcBuffer_PutArray(result, ccnxSimpleFileTransferChunkDigests_DigestLength, digests->fileDigest);
+    if (digests->numChunks > 0) {
+        parcBuffer_PutArray(result, (size_t) (digests->numChunks * ccnxSimpleFileTransferChunkDigests_DigestLength),
+                            digests->chunkDigests);
+    }
+
+    return parcBuffer_Flip(result);
+}
+
+uint64_t
+ccnxSimpleFileTransferChunkDigests_GetFileSize(const CCNxSimpleFileTransferChunkDigests *digests)
+{
+    return digests->fileSize;
+}
+
+size_t
+ccnxSimpleFileTransferChunkDigests_GetChunkSize(const CCNxSimpleFileTransferChunkDigests *digests)
+{
+    return digests->chunkSize;
+}
+
+uint64_t
+ccnxSimpleFileTransferChunkDigests_GetNumChunks(const CCNxSimpleFileTransferChunkDigests *digests)
+{
+    return digests->numChunks;
+}
+
+const uint8_t *
+ccnxSimpleFileTransferChunkDigests_GetFileDigest(const CCNxSimpleFileTransferChunkDigests *digests)
+{
+    return digests->fileDigest;
+}
+
+bool
+ccnxSimpleFileTransferChunkDigests_VerifyChunk(CCNxSimpleFileTransferChunkDigests *digests, uint64_t chunkNumber,
+                                               const PARCBuffer *chunk)
+{
+    bool result = false;
+
+    if (chunkNumber < digests->numChunks) {
+        uint8_t digest[ccnxSimpleFileTransferChunkDigests_DigestLength];
+        _computeDigest(digests->hasher, parcBuffer_Overlay((PARCBuffer *) chunk, 0), parcBuffer_Remaining(chunk), digest);
+        result = (memcmp(digest, digests->chunkDigests + chunkNumber * ccnxSimpleFileTransferChunkDigests_DigestLength,
+                         sizeof(digest)) == 0);
+    } else if (digests->numChunks == 0) {
+        result = (chunkNumber == 0 && parcBuffer_Remaining(chunk) == 0);
+    }
+
+    return result;
+}
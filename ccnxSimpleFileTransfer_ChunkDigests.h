@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+#ifndef ccnxSimpleFileTransfer_ChunkDigests_h
+#define ccnxSimpleFileTransfer_ChunkDigests_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <parc/algol/parc_Buffer.h>
+
+struct ccnxSimpleFileTransfer_ChunkDigests;
+
+/**
+ * A `CCNxSimpleFileTransferChunkDigests` holds the SHA-256 digest of each chunk of one version of a file, and a
+ * digest of the whole file, so that a client can check every chunk as it arrives, before writing it.
+ *
+ * The digest of the whole file is the SHA-256 digest of the chunk digests, in order. A client checks the chunk
+ * digests it receives against it, so a damaged list of digests is caught before any chunk is checked against it.
+ *
+ * Digests are exchanged in network byte order.
+ */
+typedef struct ccnxSimpleFileTransfer_ChunkDigests CCNxSimpleFileTransferChunkDigests;
+
+/**
+ * The number of bytes in each digest.
+ */
+#define ccnxSimpleFileTransferChunkDigests_DigestLength 32
+
+/**
+ * Compute the digests of the chunks of a file, reading it from an open descriptor.
+ * The newly created instance must eventually be released by calling `ccnxSimpleFileTransferChunkDigests_Release`.
+ *
+ * @param [in] fileDescriptor - a descriptor open for reading on the file.
+ * @param [in] fileSize - the size of the file.
+ * @param [in] chunkSize - the size of each chunk. The last chunk may be shorter.
+ * @return A new instance, or NULL if the file couldn't be read.
+ */
+CCNxSimpleFileTransferChunkDigests *ccnxSimpleFileTransferChunkDigests_CreateFromFile(int fileDescriptor, size_t fileSize,
+                                                                                       size_t chunkSize);
+
+/**
+ * Create a `CCNxSimpleFileTransferChunkDigests` from the buffer created by
+ * `ccnxSimpleFileTransferChunkDigests_CreateBuffer`, e.g. as received from the server.
+ * The newly created instance must eventually be released by calling `ccnxSimpleFileTransferChunkDigests_Release`.
+ *
+ * @param [in] buffer - the digests, from its position to its limit.
+ * @return A new instance, or NULL if the buffer doesn't hold valid digests, or its chunk digests don't match its
+ *         digest of the whole file.
+ */
+CCNxSimpleFileTransferChunkDigests *ccnxSimpleFileTransferChunkDigests_CreateFromBuffer(const PARCBuffer *buffer);
+
+/**
+ * Increase the number of references to a `CCNxSimpleFileTransferChunkDigests` instance.
+ *
+ * @param [in] instance A pointer to the original `CCNxSimpleFileTransferChunkDigests`.
+ * @return The value of the input parameter @p instance.
+ *
+ * @see ccnxSimpleFileTransferChunkDigests_Release
+ */
+CCNxSimpleFileTransferChunkDigests *ccnxSimpleFileTransferChunkDigests_Acquire(const CCNxSimpleFileTransferChunkDigests *instance);
+
+/**
+ * Release a previously acquired reference to the specified instance,
+ * decrementing the reference count for the instance.
+ *
+ * @param [in,out] digestsPtr A pointer to a pointer to the instance to release.
+ *
+ * @see ccnxSimpleFileTransferChunkDigests_Acquire
+ */
+void ccnxSimpleFileTransferChunkDigests_Release(CCNxSimpleFileTransferChunkDigests **digestsPtr);
+
+/**
+ * Encode the digests for sending. The returned PARCBuffer must eventually be released by calling parcBuffer_Release().
+ *
+ * @param [in] digests - the digests.
+ * @return A new PARCBuffer, ready to be read.
+ */
+PARCBuffer *ccnxSimpleFileTransferChunkDigests_CreateBuffer(const CCNxSimpleFileTransferChunkDigests *digests);
+
+/**
+ * Return the size of the file the digests describe.
+ */
+uint64_t ccnxSimpleFileTransferChunkDigests_GetFileSize(const CCNxSimpleFileTransferChunkDigests *digests);
+
+/**
+ * Return the size of each chunk, except perhaps the last.
+ */
+size_t ccnxSimpleFileTransferChunkDigests_GetChunkSize(const CCNxSimpleFileTransferChunkDigests *digests);
+
+/**
+ * Return the number of chunks in the file. An empty file has none.
+ */
+uint64_t ccnxSimpleFileTransferChunkDigests_GetNumChunks(const CCNxSimpleFileTransferChunkDigests *digests);
+
+/**
+ * Return the digest of the whole file, which is ccnxSimpleFileTransferChunkDigests_DigestLength bytes long.
+ */
+const uint8_t *ccnxSimpleFileTransferChunkDigests_GetFileDigest(const CCNxSimpleFileTransferChunkDigests *digests);
+
+/**
+ * Check a chunk of the file against its digest.
+ *
+ * An empty file is sent as a single, empty chunk 0, which is accepted.
+ *
+ * The digests keep a hasher to do this, so it must not be called on the same instance from more than one thread
+ * at once.
+ *
+ * @param [in] digests - the digests.
+ * @param [in] chunkNumber - the number of the chunk.
+ * @param [in] chunk - the chunk, from its position to its limit.
+ * @return true if the chunk is the one the digests describe, false if it's damaged or out of range.
+ */
+bool ccnxSimpleFileTransferChunkDigests_VerifyChunk(CCNxSimpleFileTransferChunkDigests *digests, uint64_t chunkNumber,
+                                                    const PARCBuffer *chunk);
+
+#endif // ccnxSimpleFileTransfer_ChunkDigests_h
@@ -0,0 +1,457 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "ccnxSimpleFileTransfer_ChunkStore.h"
+
+static const char _segmentMagic[8] = { 'S', 'F', 'T', 'C', 'H', 'U', 'N', 'K' };
+static const uint32_t _segmentVersion = 1;
+static const char *_segmentSuffix = ".chunks";
+
+/**
+ * The start of a segment file. It is followed by the base name, then the chunks, then the index.
+ */
+typedef struct segmentHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t chunkSize;
+
+    // The file the chunks were built from, as it was then.
+    uint64_t sourceDevice;
+    uint64_t sourceInode;
+    uint64_t sourceSize;
+    int64_t sourceModifiedSeconds;
+    int64_t sourceModifiedNanos;
+
+    uint64_t numChunks;
+    uint64_t indexOffset;           // A multiple of 8, so the index can be read in place.
+    uint32_t baseNameLength;        // The base name isn't null terminated.
+    uint32_t reserved;
+} _SegmentHeader;
+
+typedef struct segmentIndexEntry {
+    uint64_t offset;
+    uint64_t length;
+} _SegmentIndexEntry;
+
+struct ccnxSimpleFileTransfer_ChunkStore {
+    char *directoryPath;
+};
+
+struct ccnxSimpleFileTransfer_ChunkStoreSegment {
+    uint64_t numChunks;
+
+    // A stored segment, mapped into memory.
+    uint8_t *mapping;
+    size_t mappingSize;
+    const _SegmentIndexEntry *index;
+
+    // A new segment, being written to a temporary file.
+    int fileDescriptor;
+    char *tempPath;
+    char *segmentPath;
+    _SegmentHeader header;
+    _SegmentIndexEntry *newIndex;
+    uint64_t numAppended;
+    uint64_t nextOffset;
+    bool isFailed;
+    bool isCommitted;
+};
+
+/**
+ * Fill in the identity of the source file, as it is now, in a segment header.
+ */
+static bool
+_getSourceIdentity(const char *sourceFilePath, _SegmentHeader *header)
+{
+    struct stat status;
+    bool result = (stat(sourceFilePath, &status) == 0);
+
+    if (result) {
+        header->sourceDevice = (uint64_t) status.st_dev;
+        header->sourceInode = (uint64_t) status.st_ino;
+        header->sourceSize = (uint64_t) status.st_size;
+        header->sourceModifiedSeconds = (int64_t) status.st_mtime;
+#ifdef __APPLE__
+        header->sourceModifiedNanos = (int64_t) status.st_mtimespec.tv_nsec;
+#else
+        header->sourceModifiedNanos = (int64_t) status.st_mtim.tv_nsec;
+#endif
+    }
+    return result;
+}
+
+/**
+ * The file name comes from an Interest, so it must name a file in the store's directory and nowhere else.
+ */
+static bool
+_isSegmentNameSafe(const char *fileName)
+{
+    return fileName[0] != '\0'
+           && strchr(fileName, '/') == NULL
+           && strcmp(fileName, ".") != 0
+           && strcmp(fileName, "..") != 0;
+}
+
+static char *
+_createSegmentPath(const CCNxSimpleFileTransferChunkStore *store, const char *fileName)
+{
+    assertTrue(_isSegmentNameSafe(fileName), "Unsafe segment name '%s'", fileName);
+
+    size_t pathSize = strlen(store->directoryPath) + strlen(fileName) + strlen(_segmentSuffix) + 2; // +2 for '/' and null.
+    char *result = parcMemory_Allocate(pathSize);
+    assertNotNull(result, "parcMemory_Allocate(%zu) returned NULL", pathSize);
+    snprintf(result, pathSize, "%s/%s%s", store->directoryPath, fileName, _segmentSuffix);
+
+    return result;
+}
+
+static bool
+_writeFully(int fileDescriptor, const void *bytes, size_t length)
+{
+    const uint8_t *next = bytes;
+    while (length > 0) {
+        ssize_t numWritten = write(fileDescriptor, next, length);
+        if (numWritten < 0) {
+            if (errno != EINTR) {
+                return false;
+            }
+        } else {
+            next += numWritten;
+            length -= (size_t) numWritten;
+        }
+    }
+    return true;
+}
+
+static void
+_chunkStore_Finalize(CCNxSimpleFileTransferChunkStore **storePtr)
+{
+    CCNxSimpleFileTransferChunkStore *store = *storePtr;
+    parcMemory_Deallocate((void **) &store->directoryPath);
+}
+
+parcObject_ExtendPARCObject(CCNxSimpleFileTransferChunkStore,
+                            _chunkStore_Finalize,
+                            NULL, NULL, NULL, NULL, NULL, NULL);
+
+parcObject_ImplementAcquire(ccnxSimpleFileTransferChunkStore, CCNxSimpleFileTransferChunkStore);
+
+parcObject_ImplementRelease(ccnxSimpleFileTransferChunkStore, CCNxSimpleFileTransferChunkStore);
+
+static void
+_chunkStoreSegment_Finalize(CCNxSimpleFileTransferChunkStoreSegment **segmentPtr)
+{
+    CCNxSimpleFileTransferChunkStoreSegment *segment = *segmentPtr;
+
+    if (segment->mapping != NULL) {
+        munmap(segment->mapping, segment->mappingSize);
+    }
+    if (segment->fileDescriptor >= 0) {
+        close(segment->fileDescriptor);
+    }
+    if (segment->tempPath != NULL) {
+        if (!segment->isCommitted) {
+            unlink(segment->tempPath);
+        }
+        parcMemory_Deallocate((void **) &segment->tempPath);
+    }
+    if (segment->segmentPath != NULL) {
+        parcMemory_Deallocate((void **) &segment->segmentPath);
+    }
+    if (segment->newIndex != NULL) {
+        parcMemory_Deallocate((void **) &segment->newIndex);
+    }
+}
+
+parcObject_ExtendPARCObject(CCNxSimpleFileTransferChunkStoreSegment,
+                            _chunkStoreSegment_Finalize,
+                            NULL, NULL, NULL, NULL, NULL, NULL);
+
+parcObject_ImplementAcquire(ccnxSimpleFileTransferChunkStoreSegment, CCNxSimpleFileTransferChunkStoreSegment);
+
+parcObject_ImplementRelease(ccnxSimpleFileTransferChunkStoreSegment, CCNxSimpleFileTransferChunkStoreSegment);
+
+CCNxSimpleFileTransferChunkStore *
+ccnxSimpleFileTransferChunkStore_Create(const char *directoryPath)
+{
+    CCNxSimpleFileTransferChunkStore *result = NULL;
+
+    if (mkdir(directoryPath, 0755) == 0 || errno == EEXIST) {
+        result = parcObject_CreateAndClearInstance(CCNxSimpleFileTransferChunkStore);
+        result->directoryPath = parcMemory_StringDuplicate(directoryPath, strlen(directoryPath));
+    }
+
+    return result;
+}
+
+/**
+ * Check that a mapped segment is complete, and was built from the source file as it is now, for the same
+ * name and chunk size.
+ */
+static bool
+_isSegmentValid(const CCNxSimpleFileTransferChunkStoreSegment *segment, const char *sourceFilePath,
+                const char *baseName, size_t chunkSize)
+{
+    if (segment->mappingSize < sizeof(_SegmentHeader)) {
+        return false;
+    }
+    const _SegmentHeader *header = (const _SegmentHeader *) segment->mapping;
+
+    _SegmentHeader source;
+    memset(&source, 0, sizeof(source));
+
+    size_t baseNameLength = strlen(baseName);
+    uint64_t indexSize = header->numChunks * sizeof(_SegmentIndexEntry);
+
+    return memcmp(header->magic, _segmentMagic, sizeof(_segmentMagic)) == 0
+           && header->version == _segmentVersion
+           && header->chunkSize == chunkSize
+           && _getSourceIdentity(sourceFilePath, &source)
+           && header->sourceDevice == source.sourceDevice
+           && header->sourceInode == source.sourceInode
+           && header->sourceSize == source.sourceSize
+           && header->sourceModifiedSeconds == source.sourceModifiedSeconds
+           && header->sourceModifiedNanos == source.sourceModifiedNanos
+           && header->baseNameLength == baseNameLength
+           && sizeof(_SegmentHeader) + baseNameLength <= segment->mappingSize
+           && memcmp(segment->mapping + sizeof(_SegmentHeader), baseName, baseNameLength) == 0
+           && header->indexOffset % 8 == 0
+           && header->numChunks <= segment->mappingSize / sizeof(_SegmentIndexEntry)
+           && header->indexOffset <= segment->mappingSize - indexSize;
+}
+
+CCNxSimpleFileTransferChunkStoreSegment *
+ccnxSimpleFileTransferChunkStore_OpenSegment(CCNxSimpleFileTransferChunkStore *store, const char *fileName,
+                                             const char *sourceFilePath, const char *baseName, size_t chunkSize)
+{
+    CCNxSimpleFileTransferChunkStoreSegment *result = NULL;
+
+    if (!_isSegmentNameSafe(fileName)) {
+        return NULL;
+    }
+
+    char *segmentPath = _createSegmentPath(store, fileName);
+    int fileDescriptor = open(segmentPath, O_RDONLY);
+    parcMemory_Deallocate((void **) &segmentPath);
+
+    if (fileDescriptor >= 0) {
+        struct stat status;
+        if (fstat(fileDescriptor, &status) == 0 && status.st_size >= (off_t) sizeof(_SegmentHeader)) {
+            void *mapping = mmap(NULL, (size_t) status.st_size, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+            if (mapping != MAP_FAILED) {
+                result = parcObject_CreateAndClearInstance(CCNxSimpleFileTransferChunkStoreSegment);
+                result->fileDescriptor = -1;
+                result->mapping = mapping;
+                result->mappingSize = (size_t) status.st_size;
+
+                if (_isSegmentValid(result, sourceFilePath, baseName, chunkSize)) {
+                    const _SegmentHeader *header = (const _SegmentHeader *) result->mapping;
+                    result->numChunks = header->numChunks;
+                    result->index = (const _SegmentIndexEntry *) (result->mapping + header->indexOffset);
+
+                    // The chunks are normally all read, in order, as soon as the segment is opened.
+                    posix_madvise(mapping, result->mappingSize, POSIX_MADV_SEQUENTIAL);
+                } else {
+                    ccnxSimpleFileTransferChunkStoreSegment_Release(&result);
+                }
+            }
+        }
+        close(fileDescriptor); // The mapping remains.
+    }
+
+    return result;
+}
+
+CCNxSimpleFileTransferChunkStoreSegment *
+ccnxSimpleFileTransferChunkStore_CreateSegment(CCNxSimpleFileTransferChunkStore *store, const char *fileName,
+                                               const char *sourceFilePath, const char *baseName, size_t chunkSize,
+                                               uint64_t numChunks)
+{
+    if (!_isSegmentNameSafe(fileName)) {
+        return NULL;
+    }
+
+    CCNxSimpleFileTransferChunkStoreSegment *result = parcObject_CreateAndClearInstance(CCNxSimpleFileTransferChunkStoreSegment);
+    result->fileDescriptor = -1;
+    result->numChunks = numChunks;
+
+    _SegmentHeader *header = &result->header;
+    memcpy(header->magic, _segmentMagic, sizeof(_segmentMagic));
+    header->version = _segmentVersion;
+    header->chunkSize = (uint32_t) chunkSize;
+    header->numChunks = numChunks;
+    header->baseNameLength = (uint32_t) strlen(baseName);
+
+    result->segmentPath = _createSegmentPath(store, fileName);
+
+    // Several threads may build the same file at once, so each writes its own temporary file.
+    size_t tempPathSize = strlen(result->segmentPath) + sizeof(".XXXXXX");
+    result->tempPath = parcMemory_Allocate(tempPathSize);
+    assertNotNull(result->tempPath, "parcMemory_Allocate(%zu) returned NULL", tempPathSize);
+    snprintf(result->tempPath, tempPathSize, "%s.XXXXXX", result->segmentPath);
+
+    result->newIndex = parcMemory_AllocateAndClear((numChunks > 0 ? numChunks : 1) * sizeof(_SegmentIndexEntry));
+    assertNotNull(result->newIndex, "parcMemory_AllocateAndClear(%zu) returned NULL", numChunks * sizeof(_SegmentIndexEntry));
+
+    // Identify the source file before reading it, so that if it changes while being read, the segment is out of date.
+    if (_getSourceIdentity(sourceFilePath, header)) {
+        result->fileDescriptor = mkstemp(result->tempPath);
+    }
+
+    if (result->fileDescriptor >= 0) {
+        // The header is written again, complete, when the segment is committed.
+        if (_writeFully(result->fileDescriptor, header, sizeof(_SegmentHeader))
+            && _writeFully(result->fileDescriptor, baseName, header->baseNameLength)) {
+            result->nextOffset = sizeof(_SegmentHeader) + header->baseNameLength;
+        } else {
+            ccnxSimpleFileTransferChunkStoreSegment_Release(&result);
+        }
+    } else {
+        parcMemory_Deallocate((void **) &result->tempPath); // There is nothing to remove.
+        ccnxSimpleFileTransferChunkStoreSegment_Release(&result);
+    }
+
+    return result;
+}
+
+uint64_t
+ccnxSimpleFileTransferChunkStoreSegment_GetNumChunks(const CCNxSimpleFileTransferChunkStoreSegment *segment)
+{
+    return segment->numChunks;
+}
+
+PARCBuffer *
+ccnxSimpleFileTransferChunkStoreSegment_GetChunk(const CCNxSimpleFileTransferChunkStoreSegment *segment, uint64_t chunkNumber)
+{
+    PARCBuffer *result = NULL;
+
+    if (segment->mapping != NULL && chunkNumber < segment->numChunks) {
+        const _SegmentIndexEntry *entry = &segment->index[chunkNumber];
+        const _SegmentHeader *header = (const _SegmentHeader *) segment->mapping;
+
+        // Don't trust the index to stay within the chunks.
+        if (entry->offset <= header->indexOffset && entry->length <= header->indexOffset - entry->offset) {
+            result = parcBuffer_CreateFromArray(segment->mapping + entry->offset, (size_t) entry->length);
+        }
+    }
+
+    return result;
+}
+
+bool
+ccnxSimpleFileTransferChunkStoreSegment_AppendChunk(CCNxSimpleFileTransferChunkStoreSegment *segment, const PARCBuffer *chunk)
+{
+    assertTrue(segment->fileDescriptor >= 0, "Chunks can only be appended to a segment being written");
+
+    if (!segment->isFailed && segment->numAppended < segment->numChunks) {
+        size_t length = parcBuffer_Remaining(chunk);
+        const uint8_t *bytes = parcBuffer_Overlay((PARCBuffer *) chunk, 0);
+
+        if (_writeFully(segment->fileDescriptor, bytes, length)) {
+            segment->newIndex[segment->numAppended].offset = segment->nextOffset;
+            segment->newIndex[segment->numAppended].length = length;
+            segment->numAppended++;
+            segment->nextOffset += length;
+        } else {
+            segment->isFailed = true;
+        }
+    } else {
+        segment->isFailed = true;
+    }
+
+    return !segment->isFailed;
+}
+
+bool
+ccnxSimpleFileTransferChunkStoreSegment_Commit(CCNxSimpleFileTransferChunkStoreSegment *segment)
+{
+    assertTrue(segment->fileDescriptor >= 0, "Only a segment being written can be committed");
+
+    if (!segment->isFailed && segment->numAppended == segment->numChunks) {
+        static const uint8_t padding[8] = { 0 };
+        size_t paddingLength = (8 - segment->nextOffset % 8) % 8;
+        segment->header.indexOffset = segment->nextOffset + paddingLength;
+
+        // Make sure the segment is on disk before it replaces the old one, or a crash could leave a torn segment.
+        segment->isCommitted = _writeFully(segment->fileDescriptor, padding, paddingLength)
+                               && _writeFully(segment->fileDescriptor, segment->newIndex,
+                                              segment->numChunks * sizeof(_SegmentIndexEntry))
+                               && pwrite(segment->fileDescriptor, &segment->header, sizeof(_SegmentHeader), 0)
+                               == (ssize_t) sizeof(_SegmentHeader)
+                               && fsync(segment->fileDescriptor) == 0
+                               && rename(segment->tempPath, segment->segmentPath) == 0;
+    }
+
+    close(segment->fileDescriptor);
+    segment->fileDescriptor = -1;
+    segment->isFailed = !segment->isCommitted;
+
+    return segment->isCommitted;
+}
@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+#ifndef ccnxSimpleFileTransfer_ChunkStore_h
+#define ccnxSimpleFileTransfer_ChunkStore_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <parc/algol/parc_Buffer.h>
+
+struct ccnxSimpleFileTransfer_ChunkStore;
+struct ccnxSimpleFileTransfer_ChunkStoreSegment;
+
+/**
+ * A `CCNxSimpleFileTransferChunkStore` keeps the encoded, signed chunks of served files on disk, so that a
+ * restarted server can serve them again without re-chunking and re-signing the files.
+ *
+ * Each file's chunks are kept in a segment file in the store's directory. A segment records the device, inode,
+ * size and modification time of the file it was built from, and the name and chunk size it was built for,
+ * and is only used while all of these are unchanged. A segment holds the chunks one after another, followed
+ * by an index of their offsets. It is written to a temporary file and renamed into place once complete, so
+ * a store is never left with a half written segment.
+ *
+ * Segments are in the host's byte order: a store is a cache for one machine, not an exchange format.
+ */
+typedef struct ccnxSimpleFileTransfer_ChunkStore CCNxSimpleFileTransferChunkStore;
+
+/**
+ * A `CCNxSimpleFileTransferChunkStoreSegment` is either a stored segment opened for reading by
+ * `ccnxSimpleFileTransferChunkStore_OpenSegment`, or a new one being written, created by
+ * `ccnxSimpleFileTransferChunkStore_CreateSegment`.
+ */
+typedef struct ccnxSimpleFileTransfer_ChunkStoreSegment CCNxSimpleFileTransferChunkStoreSegment;
+
+/**
+ * Create a `CCNxSimpleFileTransferChunkStore` keeping its segments in the specified directory, which is
+ * created if it doesn't exist.
+ * The newly created instance must eventually be released by calling `ccnxSimpleFileTransferChunkStore_Release`.
+ *
+ * @param [in] directoryPath - the directory to keep the segments in.
+ *
+ * @return A new store, or NULL if the directory could not be created.
+ */
+CCNxSimpleFileTransferChunkStore *ccnxSimpleFileTransferChunkStore_Create(const char *directoryPath);
+
+/**
+ * Increase the number of references to a `CCNxSimpleFileTransferChunkStore` instance.
+ *
+ * @param [in] instance A pointer to the original `CCNxSimpleFileTransferChunkStore`.
+ * @return The value of the input parameter @p instance.
+ *
+ * @see ccnxSimpleFileTransferChunkStore_Release
+ */
+CCNxSimpleFileTransferChunkStore *ccnxSimpleFileTransferChunkStore_Acquire(const CCNxSimpleFileTransferChunkStore *instance);
+
+/**
+ * Release a previously acquired reference to the specified instance,
+ * decrementing the reference count for the instance.
+ *
+ * @param [in,out] storePtr A pointer to a pointer to the instance to release.
+ *
+ * @see ccnxSimpleFileTransferChunkStore_Acquire
+ */
+void ccnxSimpleFileTransferChunkStore_Release(CCNxSimpleFileTransferChunkStore **storePtr);
+
+/**
+ * Open the stored segment for a file, if there is one that was built from the file as it is now, for the
+ * same name and chunk size.
+ * The returned segment must eventually be released by calling `ccnxSimpleFileTransferChunkStoreSegment_Release`.
+ *
+ * @param [in] store - the store.
+ * @param [in] fileName - the name of the file, as served.
+ * @param [in] sourceFilePath - the path of the file the chunks are built from.
+ * @param [in] baseName - the name the chunks are served under, as a string.
+ * @param [in] chunkSize - the size of the chunks.
+ *
+ * @return The segment, or NULL if there isn't one, it is out of date, it can't be read, or @p fileName is empty,
+ *         ".", ".." or contains a '/'.
+ */
+CCNxSimpleFileTransferChunkStoreSegment *ccnxSimpleFileTransferChunkStore_OpenSegment(CCNxSimpleFileTransferChunkStore *store,
+                                                                                      const char *fileName,
+                                                                                      const char *sourceFilePath,
+                                                                                      const char *baseName,
+                                                                                      size_t chunkSize);
+
+/**
+ * Start writing a new segment for a file, recording the file as it is now. The chunks must be appended in
+ * order with `ccnxSimpleFileTransferChunkStoreSegment_AppendChunk`, and the segment replaces any older one
+ * for the file when `ccnxSimpleFileTransferChunkStoreSegment_Commit` is called. If the segment is released
+ * without being committed, it is discarded.
+ * The returned segment must eventually be released by calling `ccnxSimpleFileTransferChunkStoreSegment_Release`.
+ *
+ * @param [in] store - the store.
+ * @param [in] fileName - the name of the file, as served.
+ * @param [in] sourceFilePath - the path of the file the chunks are built from.
+ * @param [in] baseName - the name the chunks are served under, as a string.
+ * @param [in] chunkSize - the size of the chunks.
+ * @param [in] numChunks - the number of chunks that will be appended.
+ *
+ * @return The new segment, or NULL if it could not be created, or @p fileName is empty, ".", ".." or contains
+ *         a '/'.
+ */
+CCNxSimpleFileTransferChunkStoreSegment *ccnxSimpleFileTransferChunkStore_CreateSegment(CCNxSimpleFileTransferChunkStore *store,
+                                                                                        const char *fileName,
+                                                                                        const char *sourceFilePath,
+                                                                                        const char *baseName,
+                                                                                        size_t chunkSize,
+                                                                                        uint64_t numChunks);
+
+/**
+ * Increase the number of references to a `CCNxSimpleFileTransferChunkStoreSegment` instance.
+ *
+ * @param [in] instance A pointer to the original `CCNxSimpleFileTransferChunkStoreSegment`.
+ * @return The value of the input parameter @p instance.
+ *
+ * @see ccnxSimpleFileTransferChunkStoreSegment_Release
+ */
+CCNxSimpleFileTransferChunkStoreSegment *ccnxSimpleFileTransferChunkStoreSegment_Acquire(const CCNxSimpleFileTransferChunkStoreSegment *instance);
+
+/**
+ * Release a previously acquired reference to the specified instance,
+ * decrementing the reference count for the instance.
+ *
+ * @param [in,out] segmentPtr A pointer to a pointer to the instance to release.
+ *
+ * @see ccnxSimpleFileTransferChunkStoreSegment_Acquire
+ */
+void ccnxSimpleFileTransferChunkStoreSegment_Release(CCNxSimpleFileTransferChunkStoreSegment **segmentPtr);
+
+/**
+ * Return the number of chunks in a segment.
+ *
+ * @param [in] segment - the segment.
+ */
+uint64_t ccnxSimpleFileTransferChunkStoreSegment_GetNumChunks(const CCNxSimpleFileTransferChunkStoreSegment *segment);
+
+/**
+ * Get a copy of one of the chunks of a stored segment.
+ * The returned PARCBuffer must eventually be released by calling parcBuffer_Release().
+ *
+ * @param [in] segment - a segment opened by `ccnxSimpleFileTransferChunkStore_OpenSegment`.
+ * @param [in] chunkNumber - the number of the chunk.
+ *
+ * @return The chunk, or NULL if the segment has no such chunk.
+ */
+PARCBuffer *ccnxSimpleFileTransferChunkStoreSegment_GetChunk(const CCNxSimpleFileTransferChunkStoreSegment *segment,
+                                                             uint64_t chunkNumber);
+
+/**
+ * Append the next chunk to a segment being written.
+ *
+ * @param [in] segment - a segment created by `ccnxSimpleFileTransferChunkStore_CreateSegment`.
+ * @param [in] chunk - the encoded chunk, from its position to its limit.
+ *
+ * @return false if the chunk could not be written, in which case the segment will not be stored.
+ */
+bool ccnxSimpleFileTransferChunkStoreSegment_AppendChunk(CCNxSimpleFileTransferChunkStoreSegment *segment, const PARCBuffer *chunk);
+
+/**
+ * Finish writing a segment, and put it in the store in place of any older segment for the same file.
+ *
+ * @param [in] segment - a segment created by `ccnxSimpleFileTransferChunkStore_CreateSegment`, with all of its chunks appended.
+ *
+ * @return true if the segment was stored.
+ */
+bool ccnxSimpleFileTransferChunkStoreSegment_Commit(CCNxSimpleFileTransferChunkStoreSegment *segment);
+
+#endif // ccnxSimpleFileTransfer_ChunkStore_h
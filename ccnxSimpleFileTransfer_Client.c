@@ -62,20 +62,88 @@
 #include <ctype.h>
 
 #include "ccnxSimpleFileTransfer_Common.h"
+#include "ccnxSimpleFileTransfer_FileWriter.h"
+#include "ccnxSimpleFileTransfer_ReorderBuffer.h"
+#include "ccnxSimpleFileTransfer_Metrics.h"
+#include "ccnxSimpleFileTransfer_BlockSignatures.h"
+#include "ccnxSimpleFileTransfer_ChunkDigests.h"
+#include "ccnxSimpleFileTransfer_Compressor.h"
+#include "ccnxSimpleFileTransfer_FetchWindow.h"
+#include "ccnxSimpleFileTransfer_PathSelector.h"
 
 #include <ccnx/api/ccnx_Portal/ccnx_PortalRTA.h>
+#include <ccnx/common/ccnx_NameSegmentNumber.h>
 #include <parc/developer/parc_Stopwatch.h>
 #include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+
+/**
+ * The maximum number of chunks we will hold while waiting for an earlier chunk to arrive.
+ */
+static const size_t _reorderWindowSize = 4096;
+
+/**
+ * How long, in microseconds, we wait for the server to tell us the version of a file before fetching it anyway.
+ */
+static const uint64_t _statTimeoutMicroSeconds = 2 * 1000 * 1000;
+
+/**
+ * The most chunks of a file we have asked for but not received. They're kept within _reorderWindowSize of the
+ * first one still missing, so every chunk that arrives fits in the reorder buffer.
+ */
+static const size_t _fetchWindowSize = 256;
+
+/**
+ * How long, in microseconds, we wait for a chunk before asking for it again, until we've measured the round
+ * trip time to the server.
+ */
+static const uint64_t _initialRtoMicroSeconds = 1000 * 1000;
+
+/**
+ * How many times we ask for a chunk before giving up on the fetch.
+ */
+static const unsigned int _maxTransmissionsPerChunk = 6;
+
+/**
+ * The most names, after the first, that we can fetch a file under at once (e.g. from replicas of the server).
+ */
+#define _maxReplicaPrefixes 7
+
+/**
+ * The largest chunk we accept from decompressing a compressed chunk. Much larger than any chunk the server sends,
+ * but small enough that a damaged chunk can't make us allocate without limit.
+ */
+static const size_t _maxDecompressedChunkLength = 16 * 1024 * 1024;
 
 typedef struct clientState {
     CCNxName *namePrefix;
+    CCNxName *replicaPrefixes[_maxReplicaPrefixes]; // Other names the same files are served under, from more -l options.
+    uint64_t replicaVersions[_maxReplicaPrefixes];  // The version of the file under each, or 0 to not fetch from it.
+    unsigned int numReplicaPrefixes;
     char *commandArg[2];
     bool beVerbose;
     bool doSaveToDisk;
+    bool useDirectIO;
+    bool doUpdateLocalCopy;     // Whether to update an existing copy of a fetched file, fetching only what changed.
+    bool doRequestCompression;  // Whether to ask the server to compress the chunks of a fetched file.
+    char *outputPath;           // Where to write a fetched file. NULL means a file named after the remote file.
+    int streamFileDescriptor;   // When streaming to stdout, the descriptor that stdout was originally on.
+    char *metricsTarget;        // Where to export metrics, or NULL.
+    CCNxSimpleFileTransferMetrics *metrics; // NULL unless metrics are being exported.
+    unsigned int numShards;     // The number of sub-prefixes the server shards its files across, or 0 if it doesn't.
+    uint64_t fileVersion;       // The version of the file being fetched, or 0 to fetch whatever the server has.
+    uint64_t fileSize;          // The size of that version of the file.
 
     uint64_t numBytesTransferred;
     uint64_t transferTimeInMillis;
-    int fileBeingTransferred;
+    CCNxSimpleFileTransferFileWriter *fileWriter;
+    CCNxSimpleFileTransferReorderBuffer *reorderBuffer;
+    CCNxSimpleFileTransferCompressor *compressor; // Decompresses the chunks of a 'zfetch'. Created when first needed.
+    CCNxSimpleFileTransferChunkDigests *chunkDigests; // What each chunk of the file should be, or NULL if unknown.
+    bool isChunkRejected;       // Whether the last chunk received couldn't be used, so must be asked for again.
+    uint64_t numChunksDiscarded; // The chunks of the file received and discarded so far, with -m.
 } ClientState;
 
 /**
@@ -159,10 +227,90 @@ _receiveDirectoryListingChunk(ClientState *clientState,
     return result;
 }
 
+/**
+ * Open the sink that a fetched file is written to: either a local file named after the remote file,
+ * the path given with '-o' (which may be a named pipe), or stdout. Chunks are written to the sink
+ * in order, through a reorder buffer, so the sink never needs to seek.
+ *
+ * @param [in] fileName The name of the file being fetched.
+ */
+static void
+_openFileSink(ClientState *clientState, const char *fileName)
+{
+    if (clientState->outputPath == NULL) {
+        // Make sure we're starting with an empty file.
+        clientState->fileWriter =
+            ccnxSimpleFileTransferFileWriter_Create(fileName,
+                                                    ccnxSimpleFileTransferFileWriter_DefaultBufferSize,
+                                                    ccnxSimpleFileTransferFileWriter_DefaultNumberOfBuffers,
+                                                    clientState->useDirectIO);
+        assertNotNull(clientState->fileWriter, "Could not open '%s' for writing", fileName);
+    } else {
+        int fileDescriptor = clientState->streamFileDescriptor;
+        if (fileDescriptor < 0) {
+            // O_TRUNC is ignored for a named pipe, and opening one blocks until there is a reader.
+            fileDescriptor = open(clientState->outputPath, O_CREAT | O_WRONLY | O_TRUNC, 0777);
+            assertTrue(fileDescriptor >= 0, "Could not open '%s' for writing", clientState->outputPath);
+        }
+        clientState->fileWriter =
+            ccnxSimpleFileTransferFileWriter_CreateWithDescriptor(fileDescriptor,
+                                                                  ccnxSimpleFileTransferFileWriter_DefaultBufferSize,
+                                                                  ccnxSimpleFileTransferFileWriter_DefaultNumberOfBuffers);
+    }
+
+    clientState->reorderBuffer = ccnxSimpleFileTransferReorderBuffer_Create(_reorderWindowSize);
+}
+
+/**
+ * Flush and close the sink opened by _openFileSink().
+ *
+ * @param [in] fileName The name of the file being fetched.
+ */
+static void
+_closeFileSink(ClientState *clientState, const char *fileName)
+{
+    if (!ccnxSimpleFileTransferFileWriter_Close(clientState->fileWriter)) {
+        fprintf(stderr, "Error writing to '%s'. The file is incomplete.\n", fileName);
+    }
+    if (clientState->beVerbose) {
+        printf("The disk fell behind the transfer %" PRIu64 " times.\n",
+               ccnxSimpleFileTransferFileWriter_GetStallCount(clientState->fileWriter));
+    }
+    ccnxSimpleFileTransferFileWriter_Release(&clientState->fileWriter);
+    ccnxSimpleFileTransferReorderBuffer_Release(&clientState->reorderBuffer);
+}
+
+/**
+ * Check a chunk of the file against its digest, if we have the chunk digests, and say so if it doesn't match.
+ *
+ * @return true if the chunk matches its digest, or we don't have the chunk digests, false otherwise.
+ */
+static bool
+_isChunkIntact(ClientState *clientState, uint64_t chunkNumber, const PARCBuffer *payload)
+{
+    bool result = true;
+
+    if (clientState->chunkDigests != NULL) {
+        result = ccnxSimpleFileTransferChunkDigests_VerifyChunk(clientState->chunkDigests, chunkNumber, payload);
+        if (!result) {
+            fprintf(stderr, "\nChunk %" PRIu64 " of '%s' doesn't match its digest.\n", chunkNumber, clientState->commandArg[1]);
+        }
+    }
+
+    return result;
+}
+
 /*
- * Receive a chunk of a file and append it to the local file of the specified name. When the file is
+ * Receive a chunk of a file and append it to the file sink. Chunks that arrive ahead of an earlier,
+ * missing chunk are held in a reorder buffer until they can be written in order. When the file is
  * complete, print a message stating so and return true. Otherwise, print a message showing the
- * file transfer progress and return false. We assume the file chunks arrive in the correct order.
+ * file transfer progress and return false.
+ * The chunks are handed to a CCNxSimpleFileTransferFileWriter, which writes them out in the background
+ * so a slow disk (or a slow reader of a pipe) doesn't stall the receive loop.
+ *
+ * If we have the chunk digests of the file, each chunk is checked against its digest before it's used. A damaged
+ * chunk is dropped, and clientState->isChunkRejected set, so the fetch window asks for it again, on another
+ * path if there is one.
  *
  * @param [in] fileName The full path to the file to be received.
  * @param [in] payload A PARCBuffer containing the chunk of the file to write.
@@ -175,18 +323,52 @@ static bool
 _receiveFileChunk(ClientState *clientState, const char *fileName,
                   const PARCBuffer *payload, uint64_t chunkNumber, uint64_t finalChunkNumber)
 {
-    // The file is complete when the chunknumber of the current ContentObject
-    // matches the one specified in the finalChunkNumber.
-    bool isComplete = (chunkNumber == finalChunkNumber);
+    if (!_isChunkIntact(clientState, chunkNumber, payload)) {
+        clientState->isChunkRejected = true;
+        return false;
+    }
 
-    if (clientState->doSaveToDisk) {
-        if (chunkNumber == 0) {
-            // If we're the first chunk (chunk #0), then make sure we're starting with an empty file.
-            clientState->fileBeingTransferred = open(fileName, O_CREAT | O_WRONLY, 0777);
+    bool isComplete = false;
+    uint64_t numChunksReceived = 0;
+
+    if (!clientState->doSaveToDisk) {
+        // When we're discarding the chunks, the file is complete once as many chunks as it has have arrived. The
+        // final chunk may arrive before an earlier one that was lost and must be asked for again, so its arrival
+        // says nothing. The caller only hands us each chunk once.
+        numChunksReceived = ++clientState->numChunksDiscarded;
+        isComplete = (numChunksReceived > finalChunkNumber);
+    } else {
+        if (clientState->fileWriter == NULL) {
+            _openFileSink(clientState, fileName);
+        }
+
+        if (!ccnxSimpleFileTransferReorderBuffer_Put(clientState->reorderBuffer, chunkNumber, payload)) {
+            fprintf(stderr, "\nChunk %" PRIu64 " arrived too far out of order, and was dropped.\n", chunkNumber);
+        }
+
+        PARCBuffer *nextPayload = NULL;
+        while ((nextPayload = ccnxSimpleFileTransferReorderBuffer_TakeNext(clientState->reorderBuffer)) != NULL) {
+            const uint8_t *buffer = parcBuffer_Overlay(nextPayload, 0);
+            size_t length = parcBuffer_Remaining(nextPayload);
+            uint64_t writeStartTime = ccnxSimpleFileTransferMetrics_StartTimer(clientState->metrics);
+            // A compressed chunk the server framed as zeros, as from a hole in a sparse disk image, is left as a
+            // hole in ours. Other chunks are written as they are, even if they happen to be zeros.
+            bool isZeros = clientState->compressor != NULL
+                           && ccnxSimpleFileTransferCompressor_IsZeros(clientState->compressor, nextPayload);
+            bool wasWritten = isZeros ? ccnxSimpleFileTransferFileWriter_WriteZeros(clientState->fileWriter, length)
+                                      : ccnxSimpleFileTransferFileWriter_Write(clientState->fileWriter, buffer, length);
+            if (!wasWritten) {
+                fprintf(stderr, "\nError writing to '%s'\n", fileName);
+            }
+            ccnxSimpleFileTransferMetrics_RecordLatencySince(clientState->metrics,
+                                                             CCNxSimpleFileTransferMetricsHistogram_WriteLatency,
+                                                             writeStartTime);
+            parcBuffer_Release(&nextPayload);
         }
 
-        void *buffer = parcBuffer_Overlay((PARCBuffer *) payload, 0);
-        ssize_t numBytesWritten = write(clientState->fileBeingTransferred, buffer, parcBuffer_Remaining(payload));
+        // The file is complete when every chunk up to, and including, the final chunk has been written.
+        numChunksReceived = ccnxSimpleFileTransferReorderBuffer_GetNextChunkNumber(clientState->reorderBuffer);
+        isComplete = (numChunksReceived > finalChunkNumber);
     }
 
     if (isComplete) {
@@ -194,11 +376,11 @@ _receiveFileChunk(ClientState *clientState, const char *fileName,
                (unsigned long) finalChunkNumber + 1L);
 
         if (clientState->doSaveToDisk) {
-            close(clientState->fileBeingTransferred);
+            _closeFileSink(clientState, fileName);
         }
     } else {
         printf("File '%s' has been %04.2f%% transferred.\r", fileName,
-               ((float) chunkNumber / (float) finalChunkNumber) * 100.0f);
+               ((float) numChunksReceived / (float) finalChunkNumber) * 100.0f);
         fflush(stdout);
     }
 
@@ -217,7 +399,7 @@ _receiveFileChunk(ClientState *clientState, const char *fileName,
  * @return The number of chunks of the content left to transfer.
  */
 static uint64_t
-_receiveContentObject(ClientState *clientState, CCNxContentObject *contentObject)
+_receiveContentObject(ClientState *clientState, CCNxContentObject *contentObject, const CCNxName *domainPrefix)
 {
     CCNxName *contentName = ccnxContentObject_GetName(contentObject);
 
@@ -227,49 +409,88 @@ _receiveContentObject(ClientState *clientState, CCNxContentObject *contentObject
     uint64_t finalChunkNumberSpecifiedByServer = ccnxContentObject_GetFinalChunkNumber(contentObject);
 
     // Get the type of the incoming message. Was it a response to a fetch' or a 'list' command?
-    char *command = ccnxSimpleFileTransferCommon_CreateCommandStringFromName(contentName, clientState->namePrefix);
+    char *command = ccnxSimpleFileTransferCommon_CreateCommandStringFromName(contentName, domainPrefix);
 
     // Process the payload.
     PARCBuffer *payload = ccnxContentObject_GetPayload(contentObject);
     clientState->numBytesTransferred += parcBuffer_Remaining(payload);
 
+    ccnxSimpleFileTransferMetrics_Increment(clientState->metrics,
+                                            CCNxSimpleFileTransferMetricsCounter_ContentObjectsReceived, 1);
+    ccnxSimpleFileTransferMetrics_Increment(clientState->metrics,
+                                            CCNxSimpleFileTransferMetricsCounter_BytesReceived,
+                                            parcBuffer_Remaining(payload));
+
+    uint64_t result = finalChunkNumberSpecifiedByServer - chunkNumber; // number of chunks left to transfer
+
     if (strncasecmp(command, ccnxSimpleFileTransferCommon_CommandList, strlen(command)) == 0) {
         // This is a chunk of the directory listing.
         _receiveDirectoryListingChunk(clientState, payload, chunkNumber, finalChunkNumberSpecifiedByServer);
     } else if (strncasecmp(command, ccnxSimpleFileTransferCommon_CommandFetch, strlen(command)) == 0) {
         // This is a chunk of a file.
         char *fileName = ccnxSimpleFileTransferCommon_CreateFileNameFromName(contentName);
-        _receiveFileChunk(clientState, fileName, payload, chunkNumber, finalChunkNumberSpecifiedByServer);
+        if (_receiveFileChunk(clientState, fileName, payload, chunkNumber, finalChunkNumberSpecifiedByServer)) {
+            result = 0;
+        } else if (result == 0) {
+            result = 1; // The final chunk arrived, but an earlier one is still missing.
+        }
         parcMemory_Deallocate((void **) &fileName);
+    } else if (strncasecmp(command, ccnxSimpleFileTransferCommon_CommandFetchCompressed, strlen(command)) == 0) {
+        // This is a compressed chunk of a file. Decompress it, then handle it like any other chunk.
+        if (clientState->compressor == NULL) {
+            clientState->compressor = ccnxSimpleFileTransferCompressor_Create();
+        }
+        PARCBuffer *chunk = ccnxSimpleFileTransferCompressor_Decode(clientState->compressor, payload,
+                                                                    _maxDecompressedChunkLength);
+        if (chunk == NULL) {
+            // A corrupt or truncated chunk. It's dropped, and asked for again.
+            fprintf(stderr, "\nCould not decompress chunk %" PRIu64 " of the file.\n", chunkNumber);
+            clientState->isChunkRejected = true;
+            result = (result == 0) ? 1 : result;
+        } else {
+            char *fileName = ccnxSimpleFileTransferCommon_CreateFileNameFromName(contentName);
+            if (_receiveFileChunk(clientState, fileName, chunk, chunkNumber, finalChunkNumberSpecifiedByServer)) {
+                result = 0;
+            } else if (result == 0) {
+                result = 1; // The final chunk arrived, but an earlier one is still missing.
+            }
+            parcMemory_Deallocate((void **) &fileName);
+            parcBuffer_Release(&chunk);
+        }
+    } else if (strncasecmp(command, ccnxSimpleFileTransferCommon_CommandStat, strlen(command)) == 0
+               || strncasecmp(command, ccnxSimpleFileTransferCommon_CommandSums, strlen(command)) == 0
+               || strncasecmp(command, ccnxSimpleFileTransferCommon_CommandDigests, strlen(command)) == 0) {
+        // A late answer to the 'stat', 'sums' or 'digests' we sent before the fetch. It says nothing about the
+        // fetch's progress.
+        result = 1;
     } else {
         printf("ccnxSimpleFileTransfer_Client: Unknown command: %s\n", command);
     }
 
     parcMemory_Deallocate((void **) &command);
 
-    return (finalChunkNumberSpecifiedByServer - chunkNumber); // number of chunks left to transfer
+    return result;
 }
 
 /**
- * Create and return a CCNxInterest whose Name contains our commend (e.g. "fetch" or "list"),
- * and, optionally, the name of a target object (e.g. "file.txt"). The newly created CCNxInterest
- * must eventually be released by calling ccnxInterest_Release().
+ * Create and return a CCNxName that contains a command (e.g. "fetch" or "list"),
+ * and, optionally, the name of a target object (e.g. "file.txt") and the version of it that we want.
+ * The newly created CCNxName must eventually be released by calling ccnxName_Release().
  *
- * @param command The command to embed in the created CCNxInterest.
+ * @param namePrefix The name of the server, which the created CCNxName starts with.
+ * @param command The command to embed in the created CCNxName.
  * @param targetName The name of the content, if any, that the command applies to.
+ * @param version The version of the content that we want, or 0 for whatever the server has.
  *
- * @return A newly created CCNxInterest for the specified command and targetName.
+ * @return A newly created CCNxName for the specified command and targetName.
  */
-static CCNxInterest *
-_createInterest(ClientState *clientState)
+static CCNxName *
+_createNameForCommand(const CCNxName *namePrefix, const char *command, const char *targetName, uint64_t version)
 {
-    char *command = clientState->commandArg[0];
-    char *targetName = clientState->commandArg[1];
-
-    CCNxName *interestName = ccnxName_Copy(clientState->namePrefix); // Start with the prefix. We append to this.
+    CCNxName *interestName = ccnxName_Copy(namePrefix); // Start with the prefix. We append to this.
 
     // Create a NameSegment for our command, which we will append after the prefix we just created.
-    PARCBuffer *commandBuffer = parcBuffer_WrapCString(command);
+    PARCBuffer *commandBuffer = parcBuffer_WrapCString((char *) command);
     CCNxNameSegment *commandSegment = ccnxNameSegment_CreateTypeValue(CCNxNameLabelType_NAME, commandBuffer);
     parcBuffer_Release(&commandBuffer);
 
@@ -280,7 +501,7 @@ _createInterest(ClientState *clientState)
     // If we have a target, then create another NameSegment for it and append that.
     if (targetName != NULL) {
         // Create a NameSegment for our target object
-        PARCBuffer *targetBuf = parcBuffer_WrapCString(targetName);
+        PARCBuffer *targetBuf = parcBuffer_WrapCString((char *) targetName);
         CCNxNameSegment *targetSegment = ccnxNameSegment_CreateTypeValue(CCNxNameLabelType_NAME, targetBuf);
         parcBuffer_Release(&targetBuf);
 
@@ -289,12 +510,552 @@ _createInterest(ClientState *clientState)
         ccnxNameSegment_Release(&targetSegment);
     }
 
+    // If we want a particular version of the target, the version follows its name. The chunk number
+    // follows that.
+    if (version != 0) {
+        CCNxNameSegment *versionSegment = ccnxNameSegmentNumber_Create(CCNxNameLabelType_SERIAL, version);
+        ccnxName_Append(interestName, versionSegment);
+        ccnxNameSegment_Release(&versionSegment);
+    }
+
+    return interestName;
+}
+
+/**
+ * Create and return a CCNxInterest whose Name contains a command (e.g. "fetch" or "list"),
+ * and, optionally, the name of a target object (e.g. "file.txt") and the version of it that we want.
+ * The newly created CCNxInterest must eventually be released by calling ccnxInterest_Release().
+ *
+ * @param namePrefix The name of the server, which the Name of the created CCNxInterest starts with.
+ * @param command The command to embed in the created CCNxInterest.
+ * @param targetName The name of the content, if any, that the command applies to.
+ * @param version The version of the content that we want, or 0 for whatever the server has.
+ *
+ * @return A newly created CCNxInterest for the specified command and targetName.
+ */
+static CCNxInterest *
+_createInterestForCommand(const CCNxName *namePrefix, const char *command, const char *targetName, uint64_t version)
+{
+    CCNxName *interestName = _createNameForCommand(namePrefix, command, targetName, version);
+
     CCNxInterest *result = ccnxInterest_CreateSimple(interestName);
     ccnxName_Release(&interestName);
 
     return result;
 }
 
+/**
+ * Return the command that fetches the file: 'zfetch' with -z, so the server compresses the chunks, or 'fetch'.
+ */
+static const char *
+_getFetchCommand(const ClientState *clientState)
+{
+    return clientState->doRequestCompression ? ccnxSimpleFileTransferCommon_CommandFetchCompressed
+           : ccnxSimpleFileTransferCommon_CommandFetch;
+}
+
+/**
+ * Create and return a CCNxInterest for the user's command (e.g. "list") and its target, if any.
+ * A fetch is sent chunk by chunk by _fetchFile() instead.
+ * The newly created CCNxInterest must eventually be released by calling ccnxInterest_Release().
+ */
+static CCNxInterest *
+_createInterest(ClientState *clientState)
+{
+    return _createInterestForCommand(clientState->namePrefix, clientState->commandArg[0], clientState->commandArg[1],
+                                     clientState->fileVersion);
+}
+
+/**
+ * Return whether a Content Object is a response to the given command, sent to the server with the given name.
+ */
+static bool
+_isResponseToCommand(CCNxContentObject *contentObject, const CCNxName *namePrefix, const char *command)
+{
+    CCNxName *contentName = ccnxContentObject_GetName(contentObject);
+    if (!ccnxName_StartsWith(contentName, namePrefix)
+        || ccnxName_GetSegmentCount(contentName) <= ccnxName_GetSegmentCount(namePrefix)) {
+        return false;
+    }
+
+    char *responseCommand = ccnxSimpleFileTransferCommon_CreateCommandStringFromName(contentName, namePrefix);
+    bool result = (strcasecmp(responseCommand, command) == 0);
+    parcMemory_Deallocate((void **) &responseCommand);
+
+    return result;
+}
+
+/**
+ * Ask the server with the given name for the current version of the file we're fetching, and its size.
+ *
+ * @return true if the server answered in time, false otherwise (e.g. it predates versioned names).
+ */
+static bool
+_statFile(ClientState *clientState, CCNxPortal *portal, const CCNxName *namePrefix, uint64_t *version, uint64_t *fileSize)
+{
+    CCNxInterest *interest = _createInterestForCommand(namePrefix, ccnxSimpleFileTransferCommon_CommandStat,
+                                                       clientState->commandArg[1], 0);
+    CCNxMetaMessage *message = ccnxMetaMessage_CreateFromInterest(interest);
+
+    bool isAnswered = false;
+    if (ccnxPortal_Send(portal, message, CCNxStackTimeout_Never)) {
+        while (!isAnswered && !ccnxPortal_IsError(portal)) {
+            CCNxMetaMessage *response = ccnxPortal_Receive(portal, CCNxStackTimeout_MicroSeconds(_statTimeoutMicroSeconds));
+            if (response == NULL) {
+                break; // Timed out.
+            }
+            if (ccnxMetaMessage_IsContentObject(response)) {
+                CCNxContentObject *contentObject = ccnxMetaMessage_GetContentObject(response);
+                isAnswered = _isResponseToCommand(contentObject, namePrefix, ccnxSimpleFileTransferCommon_CommandStat)
+                             && ccnxSimpleFileTransferCommon_ParseStatPayload(ccnxContentObject_GetPayload(contentObject),
+                                                                              version, fileSize);
+            }
+            ccnxMetaMessage_Release(&response);
+        }
+    }
+
+    ccnxMetaMessage_Release(&message);
+    ccnxInterest_Release(&interest);
+
+    return isAnswered;
+}
+
+/**
+ * Ask the server for the current version of the file we're about to fetch. If it doesn't answer in time
+ * (e.g. it predates versioned names), we fetch the file without a version.
+ */
+static void
+_discoverFileVersion(ClientState *clientState, CCNxPortal *portal)
+{
+    uint64_t version = 0;
+    uint64_t fileSize = 0;
+
+    if (_statFile(clientState, portal, clientState->namePrefix, &version, &fileSize)) {
+        clientState->fileVersion = version;
+        clientState->fileSize = fileSize;
+        if (clientState->beVerbose) {
+            printf("Fetching version %" PRIu64 " of '%s' (%" PRIu64 " bytes).\n",
+                   version, clientState->commandArg[1], fileSize);
+        }
+    } else if (clientState->beVerbose) {
+        printf("The server didn't say which version of '%s' it has. Fetching it without a version.\n",
+               clientState->commandArg[1]);
+    }
+}
+
+/**
+ * Take a chunk of the summary fetched by _fetchFileSummary(), and add it, in order, to the chunks we have.
+ *
+ * @return true if every chunk of the summary has now been received, false otherwise.
+ */
+static bool
+_receiveFileSummaryChunk(ClientState *clientState, const CCNxName *namePrefix, const char *summaryCommand,
+                         CCNxContentObject *contentObject, CCNxSimpleFileTransferReorderBuffer *reorderBuffer,
+                         PARCBufferComposer *composer)
+{
+    bool result = false;
+
+    CCNxName *contentName = ccnxContentObject_GetName(contentObject);
+
+    // Ignore anything else, such as a late answer to the 'stat' command.
+    if (_isResponseToCommand(contentObject, namePrefix, summaryCommand)) {
+        PARCBuffer *payload = ccnxContentObject_GetPayload(contentObject);
+        clientState->numBytesTransferred += parcBuffer_Remaining(payload);
+
+        ccnxSimpleFileTransferReorderBuffer_Put(reorderBuffer,
+                                                ccnxSimpleFileTransferCommon_GetChunkNumberFromName(contentName),
+                                                payload);
+
+        PARCBuffer *nextPayload = NULL;
+        while ((nextPayload = ccnxSimpleFileTransferReorderBuffer_TakeNext(reorderBuffer)) != NULL) {
+            parcBufferComposer_PutBuffer(composer, nextPayload);
+            parcBuffer_Release(&nextPayload);
+        }
+
+        result = (ccnxSimpleFileTransferReorderBuffer_GetNextChunkNumber(reorderBuffer)
+                  > ccnxContentObject_GetFinalChunkNumber(contentObject));
+    }
+
+    return result;
+}
+
+/**
+ * Fetch a summary of a version of the file we're about to fetch, from the server with the given name, with one
+ * entry per chunk of the file, such as its block signatures ('sums') or its chunk digests ('digests').
+ * The returned PARCBuffer must eventually be released by calling parcBuffer_Release().
+ *
+ * @return The summary, or NULL if the server didn't send it in time (e.g. it predates it).
+ */
+static PARCBuffer *
+_fetchFileSummary(ClientState *clientState, CCNxPortal *portal, const CCNxName *namePrefix, uint64_t version,
+                  const char *summaryCommand)
+{
+    PARCBuffer *result = NULL;
+
+    CCNxInterest *interest = _createInterestForCommand(namePrefix, summaryCommand, clientState->commandArg[1], version);
+    CCNxMetaMessage *message = ccnxMetaMessage_CreateFromInterest(interest);
+
+    CCNxSimpleFileTransferReorderBuffer *reorderBuffer = ccnxSimpleFileTransferReorderBuffer_Create(_reorderWindowSize);
+    PARCBufferComposer *composer = parcBufferComposer_Create();
+
+    bool isComplete = false;
+    if (ccnxPortal_Send(portal, message, CCNxStackTimeout_Never)) {
+        while (!isComplete && !ccnxPortal_IsError(portal)) {
+            CCNxMetaMessage *response = ccnxPortal_Receive(portal, CCNxStackTimeout_MicroSeconds(_statTimeoutMicroSeconds));
+            if (response == NULL) {
+                break; // Timed out.
+            }
+            if (ccnxMetaMessage_IsContentObject(response)) {
+                isComplete = _receiveFileSummaryChunk(clientState, namePrefix, summaryCommand,
+                                                      ccnxMetaMessage_GetContentObject(response), reorderBuffer, composer);
+            }
+            ccnxMetaMessage_Release(&response);
+        }
+    }
+
+    if (isComplete) {
+        result = parcBufferComposer_ProduceBuffer(composer);
+    }
+
+    parcBufferComposer_Release(&composer);
+    ccnxSimpleFileTransferReorderBuffer_Release(&reorderBuffer);
+    ccnxMetaMessage_Release(&message);
+    ccnxInterest_Release(&interest);
+
+    return result;
+}
+
+/**
+ * Fetch the block signatures of the version of the file we're about to fetch. There is one block per chunk
+ * of the file, so they say which chunks of the file we may already have.
+ * The returned instance must eventually be released by calling ccnxSimpleFileTransferBlockSignatures_Release().
+ *
+ * @return The block signatures, or NULL if the server didn't send them in time (e.g. it predates them).
+ */
+static CCNxSimpleFileTransferBlockSignatures *
+_fetchBlockSignatures(ClientState *clientState, CCNxPortal *portal)
+{
+    CCNxSimpleFileTransferBlockSignatures *result = NULL;
+
+    PARCBuffer *buffer = _fetchFileSummary(clientState, portal, clientState->namePrefix, clientState->fileVersion,
+                                           ccnxSimpleFileTransferCommon_CommandSums);
+    if (buffer != NULL) {
+        result = ccnxSimpleFileTransferBlockSignatures_CreateFromBuffer(buffer);
+        parcBuffer_Release(&buffer);
+    }
+
+    return result;
+}
+
+/**
+ * Fetch the chunk digests of a version of the file we're about to fetch, from the server with the given name, so
+ * each chunk can be checked as it arrives. The digests are checked against the digest of the whole file they carry.
+ * The returned instance must eventually be released by calling ccnxSimpleFileTransferChunkDigests_Release().
+ *
+ * @return The chunk digests, or NULL if the server didn't send them in time (e.g. it predates them), or they
+ *         were damaged.
+ */
+static CCNxSimpleFileTransferChunkDigests *
+_fetchChunkDigests(ClientState *clientState, CCNxPortal *portal, const CCNxName *namePrefix, uint64_t version)
+{
+    CCNxSimpleFileTransferChunkDigests *result = NULL;
+
+    PARCBuffer *buffer = _fetchFileSummary(clientState, portal, namePrefix, version, ccnxSimpleFileTransferCommon_CommandDigests);
+    if (buffer != NULL) {
+        result = ccnxSimpleFileTransferChunkDigests_CreateFromBuffer(buffer);
+        parcBuffer_Release(&buffer);
+    }
+
+    if (result != NULL && ccnxSimpleFileTransferChunkDigests_GetFileSize(result) != clientState->fileSize) {
+        ccnxSimpleFileTransferChunkDigests_Release(&result); // Not the version we asked for.
+    }
+
+    if (result == NULL && clientState->beVerbose) {
+        printf("The server didn't send the chunk digests of '%s'. Its chunks won't be checked.\n",
+               clientState->commandArg[1]);
+    }
+
+    return result;
+}
+
+/**
+ * Write each block of the file that was found in the local copy to its place in the new copy.
+ *
+ * @return true if every block found locally was written, false otherwise.
+ */
+static bool
+_copyLocalBlocks(int fileDescriptor, const CCNxSimpleFileTransferBlockSignatures *signatures,
+                 const uint8_t *localData, const int64_t *localOffsets)
+{
+    bool result = true;
+
+    uint64_t fileSize = ccnxSimpleFileTransferBlockSignatures_GetFileSize(signatures);
+    size_t blockSize = ccnxSimpleFileTransferBlockSignatures_GetBlockSize(signatures);
+    uint64_t numBlocks = ccnxSimpleFileTransferBlockSignatures_GetNumBlocks(signatures);
+
+    for (uint64_t i = 0; i < numBlocks && result; i++) {
+        if (localOffsets[i] >= 0) {
+            uint64_t offset = i * blockSize;
+            size_t length = (fileSize - offset < blockSize) ? (size_t) (fileSize - offset) : blockSize;
+            result = (pwrite(fileDescriptor, localData + localOffsets[i], length, (off_t) offset) == (ssize_t) length);
+        }
+    }
+
+    return result;
+}
+
+static uint64_t
+_nowMicros(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000 + (uint64_t) now.tv_nsec / 1000;
+}
+
+/**
+ * Return how far ahead of the first chunk missing from a fetch, keeping up to windowSize chunks outstanding, a
+ * chunk may be asked for.
+ */
+static size_t
+_getFetchSpan(size_t windowSize)
+{
+    return (windowSize > _reorderWindowSize) ? windowSize : _reorderWindowSize;
+}
+
+/**
+ * Create a window for fetching the chunks of a file, keeping up to windowSize of them outstanding.
+ * The newly created window must eventually be released by calling ccnxSimpleFileTransferFetchWindow_Release().
+ */
+static CCNxSimpleFileTransferFetchWindow *
+_createFetchWindow(size_t windowSize, uint64_t initialRtoMicros, uint64_t nowMicros)
+{
+    return ccnxSimpleFileTransferFetchWindow_Create(windowSize, _getFetchSpan(windowSize), initialRtoMicros,
+                                                    _maxTransmissionsPerChunk, nowMicros);
+}
+
+/**
+ * Wait for the next message from the Portal, but only until one of the fetch window's Interests times out,
+ * so it can be sent again.
+ *
+ * @return The message, or NULL if none arrived in time.
+ */
+static CCNxMetaMessage *
+_receiveBeforeNextTimeout(CCNxPortal *portal, CCNxSimpleFileTransferFetchWindow *window)
+{
+    uint64_t now = _nowMicros();
+    uint64_t timeout = ccnxSimpleFileTransferFetchWindow_GetNextTimeoutMicros(window);
+
+    uint64_t waitMicros = (timeout > now) ? timeout - now : 0;
+    if (waitMicros > _initialRtoMicroSeconds) {
+        waitMicros = _initialRtoMicroSeconds;
+    }
+    return ccnxPortal_Receive(portal, CCNxStackTimeout_MicroSeconds(waitMicros));
+}
+
+/**
+ * Ask for the chunk of a file with the given number. The name of the file, and its version, are in baseName.
+ */
+static void
+_sendChunkInterest(CCNxPortal *portal, const CCNxName *baseName, uint64_t chunkNumber)
+{
+    CCNxName *name = ccnxName_Copy(baseName);
+    CCNxNameSegment *chunkSegment = ccnxNameSegmentNumber_Create(CCNxNameLabelType_CHUNK, chunkNumber);
+    ccnxName_Append(name, chunkSegment);
+    ccnxNameSegment_Release(&chunkSegment);
+
+    CCNxInterest *interest = ccnxInterest_CreateSimple(name);
+    CCNxMetaMessage *message = ccnxMetaMessage_CreateFromInterest(interest);
+    ccnxPortal_Send(portal, message, CCNxStackTimeout_Never);
+
+    ccnxMetaMessage_Release(&message);
+    ccnxInterest_Release(&interest);
+    ccnxName_Release(&name);
+}
+
+/**
+ * Fetch each chunk of the file that wasn't found in the local copy, and write it to its place in the new copy.
+ * The chunks are asked for individually, through a Portal that doesn't fetch the following chunks by itself,
+ * keeping up to _fetchWindowSize of them outstanding. A chunk that doesn't arrive in time is asked for again,
+ * as is one that doesn't match its digest.
+ *
+ * @return true if every missing chunk was fetched and written, false otherwise.
+ */
+static bool
+_fetchMissingBlocks(ClientState *clientState, CCNxPortal *portal, const CCNxSimpleFileTransferBlockSignatures *signatures,
+                    const int64_t *localOffsets, int fileDescriptor)
+{
+    uint64_t fileSize = ccnxSimpleFileTransferBlockSignatures_GetFileSize(signatures);
+    size_t blockSize = ccnxSimpleFileTransferBlockSignatures_GetBlockSize(signatures);
+    uint64_t numBlocks = ccnxSimpleFileTransferBlockSignatures_GetNumBlocks(signatures);
+
+    CCNxName *baseName = _createNameForCommand(clientState->namePrefix, ccnxSimpleFileTransferCommon_CommandFetch,
+                                               clientState->commandArg[1], clientState->fileVersion);
+
+    uint64_t numMissing = 0;
+    for (uint64_t i = 0; i < numBlocks; i++) {
+        numMissing += (localOffsets[i] < 0) ? 1 : 0;
+    }
+
+    CCNxSimpleFileTransferFetchWindow *window = _createFetchWindow(_fetchWindowSize, _initialRtoMicroSeconds, _nowMicros());
+    ccnxSimpleFileTransferFetchWindow_SetNumChunks(window, numBlocks);
+
+    uint64_t numFetched = 0;
+    bool isFailed = false;
+
+    while (!ccnxSimpleFileTransferFetchWindow_IsComplete(window) && !isFailed && !ccnxPortal_IsError(portal)) {
+        // Ask for the chunks that are due, skipping the ones we already have.
+        uint64_t nextBlock;
+        while (ccnxSimpleFileTransferFetchWindow_TakeNextToSend(window, _nowMicros(), &nextBlock)) {
+            if (localOffsets[nextBlock] < 0) {
+                _sendChunkInterest(portal, baseName, nextBlock);
+            } else {
+                ccnxSimpleFileTransferFetchWindow_Skip(window, nextBlock);
+            }
+        }
+        if (ccnxSimpleFileTransferFetchWindow_HasFailed(window)) {
+            fprintf(stderr, "\nGave up waiting for the changed chunks of '%s'.\n", clientState->commandArg[1]);
+            break;
+        }
+
+        CCNxMetaMessage *response = _receiveBeforeNextTimeout(portal, window);
+        if (response != NULL) {
+            if (ccnxMetaMessage_IsContentObject(response)) {
+                CCNxContentObject *contentObject = ccnxMetaMessage_GetContentObject(response);
+                CCNxName *contentName = ccnxContentObject_GetName(contentObject);
+                char *command = ccnxSimpleFileTransferCommon_CreateCommandStringFromName(contentName,
+                                                                                         clientState->namePrefix);
+                uint64_t chunkNumber = ccnxSimpleFileTransferCommon_GetChunkNumberFromName(contentName);
+
+                if (strcasecmp(command, ccnxSimpleFileTransferCommon_CommandFetch) == 0
+                    && ccnxSimpleFileTransferCommon_GetVersionFromName(contentName) == clientState->fileVersion
+                    && chunkNumber < numBlocks && localOffsets[chunkNumber] < 0
+                    && _isChunkIntact(clientState, chunkNumber, ccnxContentObject_GetPayload(contentObject))
+                    && ccnxSimpleFileTransferFetchWindow_Receive(window, chunkNumber, _nowMicros())) {
+                    PARCBuffer *payload = ccnxContentObject_GetPayload(contentObject);
+                    uint64_t offset = chunkNumber * blockSize;
+                    size_t length = (fileSize - offset < blockSize) ? (size_t) (fileSize - offset) : blockSize;
+
+                    if (parcBuffer_Remaining(payload) != length
+                        || pwrite(fileDescriptor, parcBuffer_Overlay(payload, 0), length, (off_t) offset) != (ssize_t) length) {
+                        fprintf(stderr, "\nError writing chunk %" PRIu64 " of '%s'\n", chunkNumber, clientState->commandArg[1]);
+                        isFailed = true;
+                    }
+
+                    clientState->numBytesTransferred += length;
+                    ccnxSimpleFileTransferMetrics_Increment(clientState->metrics,
+                                                            CCNxSimpleFileTransferMetricsCounter_ContentObjectsReceived, 1);
+                    ccnxSimpleFileTransferMetrics_Increment(clientState->metrics,
+                                                            CCNxSimpleFileTransferMetricsCounter_BytesReceived, length);
+
+                    numFetched++;
+
+                    printf("File '%s' has been %04.2f%% updated.\r", clientState->commandArg[1],
+                           ((float) numFetched / (float) numMissing) * 100.0f);
+                    fflush(stdout);
+                }
+                parcMemory_Deallocate((void **) &command);
+            }
+            ccnxMetaMessage_Release(&response);
+        }
+    }
+
+    bool result = !isFailed && ccnxSimpleFileTransferFetchWindow_IsComplete(window);
+
+    ccnxSimpleFileTransferFetchWindow_Release(&window);
+    ccnxName_Release(&baseName);
+
+    return result;
+}
+
+/**
+ * Update an existing local copy of the file we're fetching to the version found by _discoverFileVersion(),
+ * fetching only the chunks of it that we don't already have.
+ *
+ * The server sends the block signatures of that version: a weak, rolling checksum and a strong hash of each
+ * chunk. Every chunk found anywhere in the local copy, even if it has moved, is copied from it, and only the
+ * rest are fetched. The new copy is written to a temporary file next to the local copy, which replaces the
+ * local copy once it's complete, so the local copy is never left half updated.
+ *
+ * @return true if the local copy was updated, false if there is no local copy, or it couldn't be updated. In
+ *         that case, the file should be fetched in full.
+ */
+static bool
+_updateLocalCopy(ClientState *clientState, CCNxPortalFactory *factory, CCNxPortal *portal)
+{
+    bool result = false;
+
+    const char *localPath = (clientState->outputPath != NULL) ? clientState->outputPath : clientState->commandArg[1];
+
+    CCNxSimpleFileTransferBlockSignatures *signatures = NULL;
+    struct stat localStatus;
+    int localFileDescriptor = open(localPath, O_RDONLY);
+    if (localFileDescriptor >= 0 && fstat(localFileDescriptor, &localStatus) == 0 && S_ISREG(localStatus.st_mode)) {
+        signatures = _fetchBlockSignatures(clientState, portal);
+    }
+
+    if (signatures != NULL && ccnxSimpleFileTransferBlockSignatures_GetFileSize(signatures) == clientState->fileSize) {
+        uint64_t numBlocks = ccnxSimpleFileTransferBlockSignatures_GetNumBlocks(signatures);
+
+        size_t localLength = (size_t) localStatus.st_size;
+        const uint8_t *localData = NULL;
+        if (localLength > 0) {
+            localData = mmap(NULL, localLength, PROT_READ, MAP_PRIVATE, localFileDescriptor, 0);
+            if (localData == MAP_FAILED) {
+                localData = NULL;
+                localLength = 0;
+            }
+        }
+
+        int64_t *localOffsets = parcMemory_Allocate((numBlocks + 1) * sizeof(int64_t));
+        assertNotNull(localOffsets, "parcMemory_Allocate(%zu) returned NULL", (size_t) (numBlocks + 1) * sizeof(int64_t));
+        uint64_t numLocalBlocks = ccnxSimpleFileTransferBlockSignatures_FindLocalBlocks(signatures, localData, localLength,
+                                                                                        localOffsets);
+
+        char *tempPath = parcMemory_Format("%s.XXXXXX", localPath);
+        int fileDescriptor = mkstemp(tempPath);
+        if (fileDescriptor >= 0) {
+            fchmod(fileDescriptor, localStatus.st_mode & 07777);
+
+            CCNxPortal *chunkPortal = ccnxPortalFactory_CreatePortal(factory, ccnxPortalRTA_Message);
+            assertNotNull(chunkPortal, "Expected a non-null CCNxPortal pointer.");
+
+            bool isComplete = _copyLocalBlocks(fileDescriptor, signatures, localData, localOffsets)
+                              && _fetchMissingBlocks(clientState, chunkPortal, signatures, localOffsets, fileDescriptor)
+                              && ftruncate(fileDescriptor, (off_t) clientState->fileSize) == 0;
+            isComplete = (close(fileDescriptor) == 0) && isComplete;
+
+            if (isComplete && rename(tempPath, localPath) == 0) {
+                printf("File '%s' has been updated: %" PRIu64 " of its %" PRIu64 " chunks were already here, "
+                       "%" PRIu64 " were fetched.\n", localPath, numLocalBlocks, numBlocks, numBlocks - numLocalBlocks);
+                result = true;
+            } else {
+                unlink(tempPath);
+            }
+
+            ccnxPortal_Release(&chunkPortal);
+        }
+
+        parcMemory_Deallocate((void **) &tempPath);
+        parcMemory_Deallocate((void **) &localOffsets);
+        if (localData != NULL) {
+            munmap((void *) localData, localLength);
+        }
+    }
+
+    if (!result && clientState->beVerbose) {
+        printf("Could not update a local copy of '%s'. Fetching all of it.\n", clientState->commandArg[1]);
+    }
+
+    if (signatures != NULL) {
+        ccnxSimpleFileTransferBlockSignatures_Release(&signatures);
+    }
+    if (localFileDescriptor >= 0) {
+        close(localFileDescriptor);
+    }
+
+    return result;
+}
+
 /**
  * Wait for a response to a previously issued Interest. This function reads from the specified Portal
  * until the requested content is fully received. It's not very clever, as it ignores all incoming
@@ -320,7 +1081,7 @@ _receiveResponseToIssuedInterest(ClientState *clientState, CCNxPortal *portal)
                 // in the transfer. If it returns 0, it was the final block of the content
                 // and we're done.
 
-                if (_receiveContentObject(clientState, contentObject) == 0) {
+                if (_receiveContentObject(clientState, contentObject, clientState->namePrefix) == 0) {
                     isTransferComplete = true;
                 }
             }
@@ -331,6 +1092,223 @@ _receiveResponseToIssuedInterest(ClientState *clientState, CCNxPortal *portal)
     return isTransferComplete;
 }
 
+/**
+ * Find out which replicas of the server, named by the -l options after the first, have the same contents of
+ * the file as the server we found its version from, so its chunks can be fetched from them too. A replica is
+ * only used if the digest of its copy of the file, from its chunk digests, is the same. Its version of the file
+ * may differ, as the version depends on where the file is stored.
+ */
+static void
+_discoverReplicas(ClientState *clientState, CCNxPortal *portal)
+{
+    for (unsigned int i = 0; i < clientState->numReplicaPrefixes; i++) {
+        const CCNxName *replicaPrefix = clientState->replicaPrefixes[i];
+        clientState->replicaVersions[i] = 0;
+
+        uint64_t version = 0;
+        uint64_t fileSize = 0;
+        if (clientState->chunkDigests != NULL && _statFile(clientState, portal, replicaPrefix, &version, &fileSize)
+            && fileSize == clientState->fileSize && version != 0) {
+            CCNxSimpleFileTransferChunkDigests *replicaDigests = _fetchChunkDigests(clientState, portal, replicaPrefix, version);
+            if (replicaDigests != NULL) {
+                if (memcmp(ccnxSimpleFileTransferChunkDigests_GetFileDigest(replicaDigests),
+                           ccnxSimpleFileTransferChunkDigests_GetFileDigest(clientState->chunkDigests),
+                           ccnxSimpleFileTransferChunkDigests_DigestLength) == 0) {
+                    clientState->replicaVersions[i] = version;
+                }
+                ccnxSimpleFileTransferChunkDigests_Release(&replicaDigests);
+            }
+        }
+
+        if (clientState->beVerbose) {
+            char *nameString = ccnxName_ToString(replicaPrefix);
+            if (clientState->replicaVersions[i] != 0) {
+                printf("Also fetching '%s' from %s (version %" PRIu64 ").\n", clientState->commandArg[1], nameString,
+                       clientState->replicaVersions[i]);
+            } else {
+                printf("Not fetching '%s' from %s: it didn't answer, or its copy differs.\n",
+                       clientState->commandArg[1], nameString);
+            }
+            parcMemory_Deallocate(&nameString);
+        }
+    }
+}
+
+/**
+ * Return the path that a Content Object came back on: the one whose name prefix its name starts with, or
+ * numPaths if there is none. If the prefixes overlap, the longest wins.
+ */
+static size_t
+_findPathOfResponse(const CCNxName *contentName, const CCNxName **pathPrefixes, size_t numPaths)
+{
+    size_t result = numPaths;
+    for (size_t i = 0; i < numPaths; i++) {
+        if (ccnxName_StartsWith(contentName, pathPrefixes[i])
+            && ccnxName_GetSegmentCount(contentName) > ccnxName_GetSegmentCount(pathPrefixes[i])
+            && (result == numPaths
+                || ccnxName_GetSegmentCount(pathPrefixes[i]) > ccnxName_GetSegmentCount(pathPrefixes[result]))) {
+            result = i;
+        }
+    }
+    return result;
+}
+
+/**
+ * Return whether a chunk's final chunk number can say how many chunks its file has. It comes from the network, so
+ * it may be missing, or so large that the number of chunks doesn't fit.
+ */
+static bool
+_isFinalChunkNumberUsable(const CCNxContentObject *contentObject)
+{
+    return ccnxContentObject_HasFinalChunkNumber(contentObject)
+           && ccnxContentObject_GetFinalChunkNumber(contentObject) < UINT64_MAX;
+}
+
+/**
+ * Fetch the file the user asked for. Each chunk is asked for individually, through a Portal that doesn't fetch
+ * the following chunks by itself, keeping up to _fetchWindowSize of them outstanding. A chunk that doesn't
+ * arrive within the timeout estimated from the round trip times so far is asked for again, so a lost Interest
+ * or chunk doesn't stall the fetch.
+ *
+ * The fetch asks for the version of the file found by _discoverFileVersion(), if there is one, so that
+ * every chunk comes from the same contents even if the file changes on the server meanwhile.
+ * With -z, it's sent as a 'zfetch', so the server compresses the chunks.
+ *
+ * If replicas of the server with the same contents were found by _discoverReplicas(), the chunks are striped
+ * across it and them by a CCNxSimpleFileTransferPathSelector, so each is given Interests in proportion to how
+ * fast it answers, and a chunk that times out on one is asked for again from another.
+ *
+ * @return true if the whole file was received, false otherwise.
+ */
+static bool
+_fetchFile(ClientState *clientState, CCNxPortalFactory *factory)
+{
+    CCNxPortal *portal = ccnxPortalFactory_CreatePortal(factory, ccnxPortalRTA_Message);
+    assertNotNull(portal, "Expected a non-null CCNxPortal pointer.");
+
+    const char *command = _getFetchCommand(clientState);
+
+    // The server is path 0, and each replica with the same contents another.
+    const CCNxName *pathPrefixes[1 + _maxReplicaPrefixes];
+    uint64_t pathVersions[1 + _maxReplicaPrefixes];
+    CCNxName *baseNames[1 + _maxReplicaPrefixes];
+    size_t numPaths = 0;
+
+    pathPrefixes[numPaths] = clientState->namePrefix;
+    pathVersions[numPaths++] = clientState->fileVersion;
+    for (unsigned int i = 0; i < clientState->numReplicaPrefixes; i++) {
+        if (clientState->replicaVersions[i] != 0) {
+            pathPrefixes[numPaths] = clientState->replicaPrefixes[i];
+            pathVersions[numPaths++] = clientState->replicaVersions[i];
+        }
+    }
+    for (size_t i = 0; i < numPaths; i++) {
+        baseNames[i] = _createNameForCommand(pathPrefixes[i], command, clientState->commandArg[1], pathVersions[i]);
+    }
+
+    CCNxSimpleFileTransferFetchWindow *window = _createFetchWindow(_fetchWindowSize, _initialRtoMicroSeconds, _nowMicros());
+    CCNxSimpleFileTransferPathSelector *selector =
+        ccnxSimpleFileTransferPathSelector_Create(numPaths, _getFetchSpan(_fetchWindowSize));
+
+    bool isTransferComplete = false;
+    bool isFetchOver = false;
+    clientState->numChunksDiscarded = 0;
+
+    while (!isFetchOver && !ccnxPortal_IsError(portal)) {
+        uint64_t chunkNumber;
+        while (ccnxSimpleFileTransferFetchWindow_TakeNextToSend(window, _nowMicros(), &chunkNumber)) {
+            size_t path = ccnxSimpleFileTransferPathSelector_SelectPath(selector, chunkNumber, _nowMicros());
+            _sendChunkInterest(portal, baseNames[path], chunkNumber);
+        }
+        if (ccnxSimpleFileTransferFetchWindow_HasFailed(window)) {
+            fprintf(stderr, "\nGave up waiting for the chunks of '%s'.\n", clientState->commandArg[1]);
+            break;
+        }
+
+        CCNxMetaMessage *response = _receiveBeforeNextTimeout(portal, window);
+        if (response != NULL) {
+            if (ccnxMetaMessage_IsContentObject(response)) {
+                CCNxContentObject *contentObject = ccnxMetaMessage_GetContentObject(response);
+                CCNxName *contentName = ccnxContentObject_GetName(contentObject);
+                size_t path = _findPathOfResponse(contentName, pathPrefixes, numPaths);
+                chunkNumber = ccnxSimpleFileTransferCommon_GetChunkNumberFromName(contentName);
+
+                if (path < numPaths
+                    && _isResponseToCommand(contentObject, pathPrefixes[path], command)
+                    && ccnxSimpleFileTransferCommon_GetVersionFromName(contentName) == pathVersions[path]
+                    && ccnxSimpleFileTransferFetchWindow_IsOutstanding(window, chunkNumber)) {
+                    // The first chunk to arrive says how many there are. One that can't is rejected like a damaged
+                    // chunk, and asked for again.
+                    clientState->isChunkRejected = false;
+                    if (!ccnxSimpleFileTransferFetchWindow_IsNumChunksKnown(window)) {
+                        if (_isFinalChunkNumberUsable(contentObject)) {
+                            ccnxSimpleFileTransferFetchWindow_SetNumChunks(window,
+                                                                           ccnxContentObject_GetFinalChunkNumber(contentObject) + 1);
+                        } else {
+                            fprintf(stderr, "\nChunk %" PRIu64 " of '%s' doesn't say how many chunks the file has.\n",
+                                    chunkNumber, clientState->commandArg[1]);
+                            clientState->isChunkRejected = true;
+                        }
+                    }
+                    uint64_t numChunksLeft = 1;
+                    if (!clientState->isChunkRejected) {
+                        numChunksLeft = _receiveContentObject(clientState, contentObject, pathPrefixes[path]);
+                    }
+
+                    // A chunk that can't be used stays outstanding, so it's asked for again when it times out,
+                    // and the path selector takes it to have timed out on this path, and tries another.
+                    if (!clientState->isChunkRejected) {
+                        ccnxSimpleFileTransferFetchWindow_Receive(window, chunkNumber, _nowMicros());
+                        ccnxSimpleFileTransferPathSelector_Receive(selector, chunkNumber, path,
+                                                                   parcBuffer_Remaining(ccnxContentObject_GetPayload(contentObject)),
+                                                                   _nowMicros());
+                        // The fetch is over once every chunk has arrived, whatever order they came in. It only
+                        // succeeded if they were all written, too.
+                        isFetchOver = ccnxSimpleFileTransferFetchWindow_IsComplete(window);
+                        isTransferComplete = isFetchOver && (numChunksLeft == 0);
+                    }
+                }
+            }
+            ccnxMetaMessage_Release(&response);
+        }
+    }
+
+    if (!isTransferComplete && clientState->fileWriter != NULL) {
+        // The transfer failed, so write out what we have, and let the next fetch start with a new sink. The chunks
+        // held after the first missing one can't be written in order, so are lost.
+        fprintf(stderr, "Discarding %zu chunks of '%s' received after the first missing one. The file is incomplete.\n",
+                ccnxSimpleFileTransferReorderBuffer_GetCount(clientState->reorderBuffer), clientState->commandArg[1]);
+        _closeFileSink(clientState, clientState->commandArg[1]);
+    }
+
+    if (clientState->beVerbose) {
+        printf("Round trip time: %" PRIu64 " us, retransmission timeout: %" PRIu64 " us, chunks asked for again: %" PRIu64 "\n",
+               ccnxSimpleFileTransferFetchWindow_GetSmoothedRttMicros(window),
+               ccnxSimpleFileTransferFetchWindow_GetRtoMicros(window),
+               ccnxSimpleFileTransferFetchWindow_GetNumRetransmissions(window));
+        for (size_t i = 0; i < numPaths && numPaths > 1; i++) {
+            char *nameString = ccnxName_ToString(pathPrefixes[i]);
+            printf("  %s: %" PRIu64 " chunks (%" PRIu64 " bytes), round trip time %" PRIu64 " us, %" PRIu64 " timeouts%s\n",
+                   nameString,
+                   ccnxSimpleFileTransferPathSelector_GetNumChunksReceived(selector, i),
+                   ccnxSimpleFileTransferPathSelector_GetNumBytesReceived(selector, i),
+                   ccnxSimpleFileTransferPathSelector_GetSmoothedRttMicros(selector, i),
+                   ccnxSimpleFileTransferPathSelector_GetNumTimeouts(selector, i),
+                   ccnxSimpleFileTransferPathSelector_IsPathUp(selector, i) ? "" : ", down");
+            parcMemory_Deallocate(&nameString);
+        }
+    }
+
+    ccnxSimpleFileTransferPathSelector_Release(&selector);
+    ccnxSimpleFileTransferFetchWindow_Release(&window);
+    for (size_t i = 0; i < numPaths; i++) {
+        ccnxName_Release(&baseNames[i]);
+    }
+    ccnxPortal_Release(&portal);
+
+    return isTransferComplete;
+}
+
 /**
  * Given a command (e.g "fetch") and an optional target name (e.g. "file.txt"), create an appropriate CCNxInterest
  * and write it to the Portal.
@@ -350,24 +1328,47 @@ _executeUserCommand(ClientState *clientState)
 
     assertNotNull(portal, "Expected a non-null CCNxPortal pointer.");
 
-    // Given the user's command and optional target, create an Interest.
-    CCNxInterest *interest = _createInterest(clientState);
-
-    // Send the Interest through the Portal, and wait for a response.
-    CCNxMetaMessage *message = ccnxMetaMessage_CreateFromInterest(interest);
-
     PARCStopwatch *timer = parcStopwatch_Create();
     parcStopwatch_Start(timer);
 
-    if (ccnxPortal_Send(portal, message, CCNxStackTimeout_Never)) {
-        result = _receiveResponseToIssuedInterest(clientState, portal);
+    // Pin a fetch to the current version of the file, so it can't change underneath us, and get the digests of
+    // that version's chunks, so each can be checked as it arrives. Then find the replicas with the same contents.
+    bool isFetch = (strcasecmp(clientState->commandArg[0], ccnxSimpleFileTransferCommon_CommandFetch) == 0);
+    if (isFetch) {
+        _discoverFileVersion(clientState, portal);
+        if (clientState->fileVersion != 0) {
+            clientState->chunkDigests = _fetchChunkDigests(clientState, portal, clientState->namePrefix,
+                                                           clientState->fileVersion);
+            _discoverReplicas(clientState, portal);
+        }
+    }
+
+    // If we already have a copy of the file, only fetch what has changed in it. A stream has no copy to update.
+    if (isFetch && clientState->doUpdateLocalCopy && clientState->fileVersion != 0
+        && clientState->doSaveToDisk && clientState->streamFileDescriptor < 0) {
+        result = _updateLocalCopy(clientState, factory, portal);
+    }
+
+    if (!result && isFetch) {
+        result = _fetchFile(clientState, factory);
+    } else if (!result) {
+        // Given the user's command and optional target, create an Interest.
+        CCNxInterest *interest = _createInterest(clientState);
+
+        // Send the Interest through the Portal, and wait for a response.
+        CCNxMetaMessage *message = ccnxMetaMessage_CreateFromInterest(interest);
+
+        if (ccnxPortal_Send(portal, message, CCNxStackTimeout_Never)) {
+            result = _receiveResponseToIssuedInterest(clientState, portal);
+        }
+
+        ccnxMetaMessage_Release(&message);
+        ccnxInterest_Release(&interest);
     }
 
     clientState->transferTimeInMillis = parcStopwatch_ElapsedTimeMillis(timer);
 
     parcStopwatch_Release(&timer);
-    ccnxMetaMessage_Release(&message);
-    ccnxInterest_Release(&interest);
     ccnxPortal_Release(&portal);
     ccnxPortalFactory_Release(&factory);
 
@@ -388,9 +1389,20 @@ _displayUsage(char *programName)
     printf(" the ccnxSimpleFileTransfer_Server application, which should be running when this application is used.\n");
     printf(" A CCNx forwarder (e.g. Athena or Metis) must also be running.\n\n");
 
-    printf("Usage: %s  [-h] [-m] [-l <name>] <[list | fetch <filename>]>\n", programName);
-    printf("    -l <name> specifies the name the server will listen for.\n");
+    printf("Usage: %s  [-h] [-m] [-d] [-u] [-z] [-o <path>] [-M <target>] [-S <count>] [-l <name> ...] <[list | fetch <filename>]>\n", programName);
+    printf("    -l <name> specifies the name the server will listen for. Give -l up to %d more times to name\n", _maxReplicaPrefixes);
+    printf("       replicas of the server: a fetch is striped across every one with the same contents of the file.\n");
     printf("    -m specifies that the incoming file not be saved to disk. Just discard the chunks as they arrive.\n");
+    printf("    -d specifies that the incoming file be written with O_DIRECT, bypassing the page cache.\n");
+    printf("    -u specifies that an existing copy of the incoming file be updated, fetching only the chunks that changed.\n");
+    printf("    -z asks the server to compress the chunks of the incoming file, for files that compress well.\n");
+    printf("       Chunks of zeros, as in the holes of a sparse file, are then sent as just their length, and left\n");
+    printf("       as holes in the file written. Without -z, they are sent and written like any other chunk.\n");
+    printf("    -o <path> specifies where to write the incoming file, instead of a file named after it.\n");
+    printf("       The file is written in order, so <path> may be a named pipe. Use '-' for stdout.\n");
+    printf("    -M <target> exports metrics in the Prometheus text format. <target> is either a file, which\n");
+    printf("       is rewritten every second, or 'unix:<path>' to serve them on a Unix domain socket.\n");
+    printf("    -S <count> fetches from a server started with '-S <count>', which shards its files across <count> names.\n");
 
     printf("Examples:\n");
     printf("  '%s list' will list the files in the directory served by ccnxSimpleFileTransfer_Server\n", programName);
@@ -398,6 +1410,10 @@ _displayUsage(char *programName)
     printf("  '%s -l ccnx:/foo/bar list' will list the files the files in ~/files, \n", programName);
     printf("      assuming there is an instance of ccnxSimpleFileTransfer_Server listening for ccnx:/foo/bar\n");
     printf("  '%s -m fetch foo.zip' will fetch foo.zip, but not save it to disk.\n", programName);
+    printf("  '%s -u fetch foo.iso' will update an older foo.iso, fetching only what has changed in it.\n", programName);
+    printf("  '%s -z fetch access.log' will fetch access.log as compressed chunks.\n", programName);
+    printf("  '%s -l ccnx:/east/files -l ccnx:/west/files fetch foo.iso' will fetch foo.iso from both replicas.\n", programName);
+    printf("  '%s -o - fetch foo.tar.zst | zstd -d | tar x' will stream foo.tar.zst into tar.\n", programName);
     printf("  '%s -h' will show this help\n\n", programName);
 }
 
@@ -418,18 +1434,71 @@ _isConfigValid(ClientState *config)
     return result;
 }
 
+/**
+ * If the server shards its files across several sub-prefixes of its name, point our name prefix at
+ * the one serving the file we want. Listings are served by the first shard. Replicas are sharded the same way.
+ */
+static void
+_selectShard(ClientState *clientState)
+{
+    if (clientState->numShards > 1) {
+        unsigned int shard = 0;
+        if (strcasecmp(clientState->commandArg[0], ccnxSimpleFileTransferCommon_CommandFetch) == 0) {
+            shard = ccnxSimpleFileTransferCommon_GetShardForFileName(clientState->commandArg[1], clientState->numShards);
+        }
+        CCNxName *shardPrefix = ccnxSimpleFileTransferCommon_CreateShardPrefix(clientState->namePrefix, shard);
+        ccnxName_Release(&clientState->namePrefix);
+        clientState->namePrefix = shardPrefix;
+
+        for (unsigned int i = 0; i < clientState->numReplicaPrefixes; i++) {
+            shardPrefix = ccnxSimpleFileTransferCommon_CreateShardPrefix(clientState->replicaPrefixes[i], shard);
+            ccnxName_Release(&clientState->replicaPrefixes[i]);
+            clientState->replicaPrefixes[i] = shardPrefix;
+        }
+    }
+}
+
 static bool
 _parseCommandLine(int argc, char *argv[], ClientState *clientState)
 {
+    bool isNamePrefixGiven = false;
+
     int c;
-    while ((c = getopt(argc, argv, "l:mvh")) != -1) {
+    while ((c = getopt(argc, argv, "l:mduzo:M:S:vh")) != -1) {
         switch (c) {
-            case 'l': // -l ccnx:/foo/bar
-                clientState->namePrefix = ccnxName_CreateFromCString(optarg);
+            case 'l': // -l ccnx:/foo/bar, then -l ccnx:/baz/bar for each replica
+                if (!isNamePrefixGiven) {
+                    ccnxName_Release(&clientState->namePrefix);
+                    clientState->namePrefix = ccnxName_CreateFromCString(optarg);
+                    isNamePrefixGiven = true;
+                } else if (clientState->numReplicaPrefixes < _maxReplicaPrefixes) {
+                    clientState->replicaPrefixes[clientState->numReplicaPrefixes++] = ccnxName_CreateFromCString(optarg);
+                } else {
+                    fprintf(stderr, "Option -l can be given at most %d times.\n", _maxReplicaPrefixes + 1);
+                    return false;
+                }
                 break;
             case 'm': // -m
                 clientState->doSaveToDisk = false;
                 break;
+            case 'd': // -d
+                clientState->useDirectIO = true;
+                break;
+            case 'u': // -u
+                clientState->doUpdateLocalCopy = true;
+                break;
+            case 'z': // -z
+                clientState->doRequestCompression = true;
+                break;
+            case 'o': // -o /path/to/output or -o -
+                clientState->outputPath = optarg;
+                break;
+            case 'M': // -M /tmp/client.prom or -M unix:/tmp/client.sock
+                clientState->metricsTarget = optarg;
+                break;
+            case 'S': // -S 8
+                clientState->numShards = atoi(optarg);
+                break;
             case 'v': // -v (verbose)
                 clientState->beVerbose = true;
                 break;
@@ -437,7 +1506,7 @@ _parseCommandLine(int argc, char *argv[], ClientState *clientState)
                 _displayUsage(argv[0]);
                 return false;
             case '?':
-                if (optopt == 'l' || optopt == 's') {
+                if (optopt == 'l' || optopt == 'o' || optopt == 'M' || optopt == 'S') {
                     fprintf(stderr, "Option -%c requires an argument.\n", optopt);
                 } else if (isascii(optopt)) {
                     fprintf(stderr, "Unknown option `-%c'.\n", optopt);
@@ -471,7 +1540,18 @@ _dumpConfig(ClientState *config)
     }
 
     printf("  namePrefix:    [%s]\n", nameString == NULL ? "MISSING" : nameString);
+    for (unsigned int i = 0; i < config->numReplicaPrefixes; i++) {
+        char *replicaString = ccnxName_ToString(config->replicaPrefixes[i]);
+        printf("  replica:       [%s]\n", replicaString);
+        parcMemory_Deallocate(&replicaString);
+    }
     printf("  doSaveToDisk:  [%s]\n", config->doSaveToDisk ? "true" : "false");
+    printf("  useDirectIO:   [%s]\n", config->useDirectIO ? "true" : "false");
+    printf("  updateLocal:   [%s]\n", config->doUpdateLocalCopy ? "true" : "false");
+    printf("  compression:   [%s]\n", config->doRequestCompression ? "true" : "false");
+    printf("  outputPath:    [%s]\n", config->outputPath == NULL ? "" : config->outputPath);
+    printf("  metrics:       [%s]\n", config->metricsTarget == NULL ? "" : config->metricsTarget);
+    printf("  numShards:     [%u]\n", config->numShards);
     printf("  beVerbose:     [%s]\n\n", config->beVerbose ? "true" : "false");
 
     printf("  Command: [%s] [%s]\n\n",
@@ -483,6 +1563,19 @@ _dumpConfig(ClientState *config)
     }
 }
 
+/**
+ * When the fetched file is being streamed to stdout, keep the original stdout for the file data and
+ * send everything we would normally print (progress, statistics) to stderr instead, so it doesn't
+ * get mixed into the stream.
+ */
+static void
+_redirectMessagesForStreaming(ClientState *clientState)
+{
+    fflush(stdout);
+    clientState->streamFileDescriptor = dup(STDOUT_FILENO);
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+}
+
 int
 main(int argc, char *argv[argc])
 {
@@ -490,17 +1583,46 @@ main(int argc, char *argv[argc])
 
     ClientState clientState;
     clientState.doSaveToDisk = true;
+    clientState.useDirectIO = false;
+    clientState.doUpdateLocalCopy = false;
+    clientState.doRequestCompression = false;
+    clientState.outputPath = NULL;
+    clientState.streamFileDescriptor = -1;
+    clientState.metricsTarget = NULL;
+    clientState.metrics = NULL;
+    clientState.numShards = 0;
+    clientState.fileVersion = 0;
+    clientState.fileSize = 0;
     clientState.beVerbose = false;
     clientState.namePrefix = ccnxName_CreateFromCString(ccnxSimpleFileTransferCommon_NamePrefix);
+    clientState.numReplicaPrefixes = 0;
+    memset(clientState.replicaVersions, 0, sizeof(clientState.replicaVersions));
     clientState.transferTimeInMillis = 0;
     clientState.numBytesTransferred = 0;
     clientState.commandArg[0] = NULL;          // 'fetch' or 'list'
     clientState.commandArg[1] = NULL;          // optional filename for 'fetch'
-    clientState.fileBeingTransferred = -1;
+    clientState.fileWriter = NULL;
+    clientState.reorderBuffer = NULL;
+    clientState.compressor = NULL;
+    clientState.chunkDigests = NULL;
+    clientState.isChunkRejected = false;
+    clientState.numChunksDiscarded = 0;
 
     if (_parseCommandLine(argc, argv, &clientState)) {
+        if (clientState.outputPath != NULL && strcmp(clientState.outputPath, "-") == 0) {
+            _redirectMessagesForStreaming(&clientState);
+        }
         _dumpConfig(&clientState);
         if (_isConfigValid(&clientState)) {
+            _selectShard(&clientState);
+
+            if (clientState.metricsTarget != NULL) {
+                clientState.metrics = ccnxSimpleFileTransferMetrics_Create("client");
+                if (!ccnxSimpleFileTransferMetrics_StartExporter(clientState.metrics, clientState.metricsTarget, 1)) {
+                    fprintf(stderr, "Could not export metrics to '%s'.\n", clientState.metricsTarget);
+                }
+            }
+
             if (_executeUserCommand(&clientState)) {
                 double mb = (double) clientState.numBytesTransferred / (double) (1024 * 1024);
                 double secs = clientState.transferTimeInMillis / 1000.0;
@@ -517,9 +1639,25 @@ main(int argc, char *argv[argc])
         }
     }
 
+    if (clientState.metrics != NULL) {
+        ccnxSimpleFileTransferMetrics_Release(&clientState.metrics);
+    }
+
+    if (clientState.compressor != NULL) {
+        ccnxSimpleFileTransferCompressor_Release(&clientState.compressor);
+    }
+
+    if (clientState.chunkDigests != NULL) {
+        ccnxSimpleFileTransferChunkDigests_Release(&clientState.chunkDigests);
+    }
+
     if (clientState.namePrefix != NULL) {
         ccnxName_Release(&clientState.namePrefix);
     }
 
+    for (unsigned int i = 0; i < clientState.numReplicaPrefixes; i++) {
+        ccnxName_Release(&clientState.replicaPrefixes[i]);
+    }
+
     exit(status);
 }
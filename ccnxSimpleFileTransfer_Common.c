@@ -57,11 +57,14 @@
  * @copyright (c) 2014-2015, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
  */
 #include <stdio.h>
+#include <inttypes.h>
 
 #include "ccnxSimpleFileTransfer_Common.h"
 
 #include <ccnx/common/ccnx_NameSegmentNumber.h>
 
+#include <parc/algol/parc_Memory.h>
+
 #include <parc/security/parc_Security.h>
 #include <parc/security/parc_Pkcs12KeyStore.h>
 #include <parc/security/parc_IdentityFile.h>
@@ -92,6 +95,26 @@ const char *ccnxSimpleFileTransferCommon_CommandFetch = "fetch";
  */
 const char *ccnxSimpleFileTransferCommon_CommandList = "list";
 
+/**
+ * The string we use for the 'stat' command.
+ */
+const char *ccnxSimpleFileTransferCommon_CommandStat = "stat";
+
+/**
+ * The string we use for the 'sums' command.
+ */
+const char *ccnxSimpleFileTransferCommon_CommandSums = "sums";
+
+/**
+ * The string we use for the 'digests' command.
+ */
+const char *ccnxSimpleFileTransferCommon_CommandDigests = "digests";
+
+/**
+ * The string we use for the 'zfetch' command.
+ */
+const char *ccnxSimpleFileTransferCommon_CommandFetchCompressed = "zfetch";
+
 PARCIdentity *
 ccnxSimpleFileTransferCommon_CreateAndGetIdentity(const char *keystoreName,
                                                   const char *keystorePassword,
@@ -163,13 +186,31 @@ ccnxSimpleFileTransferCommon_CreateWithBaseName(const CCNxName *name)
     return result;
 }
 
+uint64_t
+ccnxSimpleFileTransferCommon_GetVersionFromName(const CCNxName *name)
+{
+    uint64_t result = 0;
+
+    size_t numberOfSegmentsInName = ccnxName_GetSegmentCount(name);
+    if (numberOfSegmentsInName >= 2) {
+        CCNxNameSegment *versionSegment = ccnxName_GetSegment(name, numberOfSegmentsInName - 2);
+        if (ccnxNameSegment_GetType(versionSegment) == CCNxNameLabelType_SERIAL) {
+            result = ccnxNameSegmentNumber_Value(versionSegment);
+        }
+    }
+
+    return result;
+}
+
 char *
 ccnxSimpleFileTransferCommon_CreateFileNameFromName(const CCNxName *name)
 {
-    // For the Tutorial, the second to last NameSegment is the filename.
-    CCNxNameSegment *fileNameSegment =
-        ccnxName_GetSegment(name,
-                            ccnxName_GetSegmentCount(name) - 2); // '-2' because we want the second to last segment
+    // For the Tutorial, the second to last NameSegment is the filename, unless it's the version.
+    size_t fileNameIndex = ccnxName_GetSegmentCount(name) - 2; // '-2' because we want the second to last segment
+    if (ccnxNameSegment_GetType(ccnxName_GetSegment(name, fileNameIndex)) == CCNxNameLabelType_SERIAL) {
+        fileNameIndex--;
+    }
+    CCNxNameSegment *fileNameSegment = ccnxName_GetSegment(name, fileNameIndex);
 
     assertTrue(ccnxNameSegment_GetType(fileNameSegment) == CCNxNameLabelType_NAME,
                "Last segment is the wrong type, expected CCNxNameLabelType %02X got %02X",
@@ -199,3 +240,53 @@ ccnxSimpleFileTransferCommon_CreateCommandStringFromName(const CCNxName *name, c
     return ccnxNameSegment_ToString(commandSegment); // This memory must be freed by the caller.
 }
 
+PARCBuffer *
+ccnxSimpleFileTransferCommon_CreateStatPayload(uint64_t version, uint64_t fileSize)
+{
+    char *payloadString = parcMemory_Format("version=%" PRIu64 " size=%" PRIu64 "\n", version, fileSize);
+    PARCBuffer *result = parcBuffer_AllocateCString(payloadString);
+    parcMemory_Deallocate((void **) &payloadString);
+
+    return result;
+}
+
+bool
+ccnxSimpleFileTransferCommon_ParseStatPayload(const PARCBuffer *payload, uint64_t *version, uint64_t *fileSize)
+{
+    char *payloadString = parcBuffer_ToString(payload);
+
+    bool result = (sscanf(payloadString, "version=%" SCNu64 " size=%" SCNu64, version, fileSize) == 2);
+
+    parcMemory_Deallocate((void **) &payloadString);
+
+    return result;
+}
+
+unsigned int
+ccnxSimpleFileTransferCommon_GetShardForFileName(const char *fileName, unsigned int numShards)
+{
+    uint32_t hash = 2166136261U; // The 32-bit FNV-1a offset basis.
+    for (const unsigned char *next = (const unsigned char *) fileName; *next != 0; next++) {
+        hash ^= *next;
+        hash *= 16777619U;       // The 32-bit FNV prime.
+    }
+
+    return (numShards > 1) ? (hash % numShards) : 0;
+}
+
+CCNxName *
+ccnxSimpleFileTransferCommon_CreateShardPrefix(const CCNxName *domainPrefix, unsigned int shard)
+{
+    CCNxName *result = ccnxName_Copy(domainPrefix);
+
+    char *shardString = parcMemory_Format("shard%u", shard);
+    PARCBuffer *shardBuffer = parcBuffer_WrapCString(shardString);
+    CCNxNameSegment *shardSegment = ccnxNameSegment_CreateTypeValue(CCNxNameLabelType_NAME, shardBuffer);
+    ccnxName_Append(result, shardSegment);
+
+    ccnxNameSegment_Release(&shardSegment);
+    parcBuffer_Release(&shardBuffer);
+    parcMemory_Deallocate((void **) &shardString);
+
+    return result;
+}
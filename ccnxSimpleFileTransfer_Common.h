@@ -95,6 +95,27 @@ extern const char *ccnxSimpleFileTransferCommon_CommandFetch;
  */
 extern const char *ccnxSimpleFileTransferCommon_CommandList;
 
+/**
+ * The string we use for the 'stat' command, which returns the current version and size of a file.
+ */
+extern const char *ccnxSimpleFileTransferCommon_CommandStat;
+
+/**
+ * The string we use for the 'sums' command, which returns the block signatures of a version of a file.
+ */
+extern const char *ccnxSimpleFileTransferCommon_CommandSums;
+
+/**
+ * The string we use for the 'digests' command, which returns the chunk digests of a version of a file.
+ */
+extern const char *ccnxSimpleFileTransferCommon_CommandDigests;
+
+/**
+ * The string we use for the 'zfetch' command, which is the same as 'fetch' but returns compressed chunks.
+ * Each chunk's payload starts with the codec it was compressed with. See ccnxSimpleFileTransfer_Compressor.h.
+ */
+extern const char *ccnxSimpleFileTransferCommon_CommandFetchCompressed;
+
 
 /**
  * Creates and returns a new randomly generated Identity, which is required for signing.
@@ -147,11 +168,21 @@ uint64_t ccnxSimpleFileTransferCommon_GetChunkNumberFromName(const CCNxName *nam
  */
 CCNxName *ccnxSimpleFileTransferCommon_CreateWithBaseName(const CCNxName *name);
 
+/**
+ * Given a CCNxName instance, return the version of the file that it names. A versioned name has a
+ * Serial NameSegment holding the version between the file name and the chunk number, e.g.
+ * ccnx:/ccnx/tutorial/fetch/file.txt/Serial=1234/Chunk=7.
+ *
+ * @param [in] name A CCNxName instance from which to extract the version.
+ * @return The version encoded in the supplied CCNxName instance, or 0 if the name isn't versioned.
+ */
+uint64_t ccnxSimpleFileTransferCommon_GetVersionFromName(const CCNxName *name);
+
 /**
  * Given a CCNxName instance, structured for this tutorial, return a string representation
  * of the file name in the CCNxName. For the tutorial, this is located in the second to
- * last CCnxNameSegment in the CCNxName. The string returned here must eventually be freed
- * by calling parcMemory_Deallocate().
+ * last CCnxNameSegment in the CCNxName, or the third to last if the name is versioned. The
+ * string returned here must eventually be freed by calling parcMemory_Deallocate().
  *
  * @param [in] name A CCNxName instance from which to extract the filename.
  * @return A C string representation of the filename encoded in the supplied CCNxName instance.
@@ -169,5 +200,49 @@ char *ccnxSimpleFileTransferCommon_CreateFileNameFromName(const CCNxName *name);
  */
 char *ccnxSimpleFileTransferCommon_CreateCommandStringFromName(const CCNxName *name, const CCNxName *domainPrefix);
 
+/**
+ * Create the payload of a response to a 'stat' command: the version and the size of the file, as text
+ * (e.g. "version=1234 size=5678\n"). The returned instance must eventually be released by calling
+ * parcBuffer_Release().
+ *
+ * @param [in] version The version of the file.
+ * @param [in] fileSize The size of the file, in bytes.
+ * @return A new PARCBuffer containing the payload.
+ */
+PARCBuffer *ccnxSimpleFileTransferCommon_CreateStatPayload(uint64_t version, uint64_t fileSize);
+
+/**
+ * Parse the payload of a response to a 'stat' command, as created by ccnxSimpleFileTransferCommon_CreateStatPayload().
+ *
+ * @param [in] payload The payload of the response.
+ * @param [out] version Set to the version of the file.
+ * @param [out] fileSize Set to the size of the file, in bytes.
+ * @return true if the payload was well formed, false otherwise.
+ */
+bool ccnxSimpleFileTransferCommon_ParseStatPayload(const PARCBuffer *payload, uint64_t *version, uint64_t *fileSize);
+
+/**
+ * When the server shards files across several Portals, each Portal listens on its own sub-prefix of the
+ * domain prefix, and each file is served by exactly one of them. Given a file name, return the number of
+ * the shard that serves it. The client and the server must agree on this, so it is a stable hash (FNV-1a)
+ * of the file name.
+ *
+ * @param [in] fileName The name of the file.
+ * @param [in] numShards The number of shards the server is using.
+ * @return The shard, from 0 to numShards - 1, that serves the file.
+ */
+unsigned int ccnxSimpleFileTransferCommon_GetShardForFileName(const char *fileName, unsigned int numShards);
+
+/**
+ * Return a new CCNxName that is the prefix that the specified shard listens on. It is the domain prefix
+ * followed by a segment naming the shard, e.g. ccnx:/ccnx/tutorial/shard3. The returned instance must
+ * eventually be released by calling ccnxName_Release().
+ *
+ * @param [in] domainPrefix A CCNxName containing the domain prefix.
+ * @param [in] shard The number of the shard.
+ * @return A new CCNxName instance for the shard's prefix.
+ */
+CCNxName *ccnxSimpleFileTransferCommon_CreateShardPrefix(const CCNxName *domainPrefix, unsigned int shard);
+
 
 #endif // ccnxSimpleFileTransferCommon.h
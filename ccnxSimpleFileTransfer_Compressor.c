@@ -0,0 +1,465 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(HAVE_ZSTD)
+#include <zstd.h>
+#endif
+
+#if defined(HAVE_LZ4)
+#include <lz4.h>
+#endif
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "ccnxSimpleFileTransfer_Compressor.h"
+
+/**
+ * The length of the frame before the compressed bytes: the codec and the uncompressed length.
+ */
+static const size_t _headerLength = 1 + sizeof(uint32_t);
+
+/**
+ * The most chunks of a file compressed to choose its codec.
+ */
+static const uint64_t _maxSamples = 8;
+
+/**
+ * A codec is only used for a file if it shrinks the sampled chunks to this fraction of their size, or less.
+ */
+static const double _maxWorthwhileRatio = 0.8;
+
+/**
+ * lz4 is used instead of zstd if its output is no more than this much larger than zstd's.
+ */
+static const double _lz4Tolerance = 1.1;
+
+#if defined(HAVE_ZSTD)
+/**
+ * zstd's default level. Each chunk is compressed on its own, and is small, so higher levels gain very little.
+ */
+static const int _zstdLevel = 3;
+#endif
+
+struct ccnxSimpleFileTransfer_Compressor {
+#if defined(HAVE_ZSTD)
+    ZSTD_CCtx *zstdCompressor;
+    ZSTD_DCtx *zstdDecompressor;
+#endif
+    uint8_t *scratch;           // Where a chunk is compressed to, before it's copied into a buffer of the right size.
+    size_t scratchSize;
+    PARCBuffer *zeros;          // The zeros that chunks framed as zeros are decoded to slices of. NULL until needed.
+};
+
+static void
+_compressor_Finalize(CCNxSimpleFileTransferCompressor **compressorPtr)
+{
+    CCNxSimpleFileTransferCompressor *compressor = *compressorPtr;
+
+#if defined(HAVE_ZSTD)
+    ZSTD_freeCCtx(compressor->zstdCompressor);
+    ZSTD_freeDCtx(compressor->zstdDecompressor);
+#endif
+    if (compressor->scratch != NULL) {
+        parcMemory_Deallocate((void **) &compressor->scratch);
+    }
+    if (compressor->zeros != NULL) {
+        parcBuffer_Release(&compressor->zeros);
+    }
+}
+
+parcObject_ExtendPARCObject(CCNxSimpleFileTransferCompressor,
+                            _compressor_Finalize,
+                            NULL, NULL, NULL, NULL, NULL, NULL);
+
+parcObject_ImplementAcquire(ccnxSimpleFileTransferCompressor, CCNxSimpleFileTransferCompressor);
+
+parcObject_ImplementRelease(ccnxSimpleFileTransferCompressor, CCNxSimpleFileTransferCompressor);
+
+CCNxSimpleFileTransferCompressor *
+ccnxSimpleFileTransferCompressor_Create(void)
+{
+    CCNxSimpleFileTransferCompressor *result = parcObject_CreateAndClearInstance(CCNxSimpleFileTransferCompressor);
+
+#if defined(HAVE_ZSTD)
+    result->zstdCompressor = ZSTD_createCCtx();
+    result->zstdDecompressor = ZSTD_createDCtx();
+    assertTrue(result->zstdCompressor != NULL && result->zstdDecompressor != NULL, "Could not create the zstd contexts");
+#endif
+
+    return result;
+}
+
+bool
+ccnxSimpleFileTransferCompressor_IsAvailable(CCNxSimpleFileTransferCodec codec)
+{
+    bool result = false;
+
+    switch (codec) {
+        case CCNxSimpleFileTransferCodec_None:
+        case CCNxSimpleFileTransferCodec_Zeros:
+            result = true;
+            break;
+#if defined(HAVE_LZ4)
+        case CCNxSimpleFileTransferCodec_LZ4:
+            result = true;
+            break;
+#endif
+#if defined(HAVE_ZSTD)
+        case CCNxSimpleFileTransferCodec_Zstd:
+            result = true;
+            break;
+#endif
+        default:
+            break;
+    }
+
+    return result;
+}
+
+const char *
+ccnxSimpleFileTransferCompressor_GetCodecName(CCNxSimpleFileTransferCodec codec)
+{
+    const char *result = "unknown";
+
+    switch (codec) {
+        case CCNxSimpleFileTransferCodec_None:
+            result = "none";
+            break;
+        case CCNxSimpleFileTransferCodec_LZ4:
+            result = "lz4";
+            break;
+        case CCNxSimpleFileTransferCodec_Zstd:
+            result = "zstd";
+            break;
+        case CCNxSimpleFileTransferCodec_Zeros:
+            result = "zeros";
+            break;
+        default:
+            break;
+    }
+
+    return result;
+}
+
+/**
+ * Make sure the scratch buffer holds at least the given number of bytes.
+ */
+static void
+_reserveScratch(CCNxSimpleFileTransferCompressor *compressor, size_t size)
+{
+    if (compressor->scratchSize < size) {
+        if (compressor->scratch != NULL) {
+            parcMemory_Deallocate((void **) &compressor->scratch);
+        }
+        compressor->scratch = parcMemory_Allocate(size);
+        assertNotNull(compressor->scratch, "parcMemory_Allocate(%zu) returned NULL", size);
+        compressor->scratchSize = size;
+    }
+}
+
+/**
+ * Compress data into the scratch buffer.
+ *
+ * @return The number of compressed bytes, or 0 if the codec isn't available or failed.
+ */
+static size_t
+_compress(CCNxSimpleFileTransferCompressor *compressor, CCNxSimpleFileTransferCodec codec,
+          const uint8_t *data, size_t length)
+{
+    size_t result = 0;
+
+    switch (codec) {
+#if defined(HAVE_LZ4)
+        case CCNxSimpleFileTransferCodec_LZ4:
+            if (length <= (size_t) LZ4_MAX_INPUT_SIZE) {
+                _reserveScratch(compressor, (size_t) LZ4_compressBound((int) length));
+                int numCompressed = LZ4_compress_default((const char *) data, (char *) compressor->scratch, (int) length,
+                                                         (int) compressor->scratchSize);
+                result = (numCompressed > 0) ? (size_t) numCompressed : 0;
+            }
+            break;
+#endif
+#if defined(HAVE_ZSTD)
+        case CCNxSimpleFileTransferCodec_Zstd: {
+            _reserveScratch(compressor, ZSTD_compressBound(length));
+            size_t numCompressed = ZSTD_compressCCtx(compressor->zstdCompressor, compressor->scratch,
+                                                     compressor->scratchSize, data, length, _zstdLevel);
+            result = ZSTD_isError(numCompressed) ? 0 : numCompressed;
+            break;
+        }
+#endif
+        default:
+            break;
+    }
+
+    return result;
+}
+
+/**
+ * Decompress exactly `length` bytes.
+ *
+ * @return true if the compressed bytes were valid and decompressed to `length` bytes, false otherwise.
+ */
+static bool
+_decompress(CCNxSimpleFileTransferCompressor *compressor, CCNxSimpleFileTransferCodec codec,
+            const uint8_t *compressed, size_t compressedLength, uint8_t *output, size_t length)
+{
+    bool result = false;
+
+    switch (codec) {
+#if defined(HAVE_LZ4)
+        case CCNxSimpleFileTransferCodec_LZ4:
+            if (compressedLength <= (size_t) INT_MAX && length <= (size_t) INT_MAX) {
+                int numDecompressed = LZ4_decompress_safe((const char *) compressed, (char *) output,
+                                                          (int) compressedLength, (int) length);
+                result = (numDecompressed >= 0 && (size_t) numDecompressed == length);
+            }
+            break;
+#endif
+#if defined(HAVE_ZSTD)
+        case CCNxSimpleFileTransferCodec_Zstd: {
+            size_t numDecompressed = ZSTD_decompressDCtx(compressor->zstdDecompressor, output, length,
+                                                         compressed, compressedLength);
+            result = (!ZSTD_isError(numDecompressed) && numDecompressed == length);
+            break;
+        }
+#endif
+        default:
+            break;
+    }
+
+    return result;
+}
+
+/**
+ * The length of a chunk once it's compressed and framed, which is never more than its length plus the codec byte.
+ */
+static size_t
+_getFramedLength(CCNxSimpleFileTransferCompressor *compressor, CCNxSimpleFileTransferCodec codec,
+                 const uint8_t *data, size_t length)
+{
+    size_t result = 1 + length;
+
+    size_t compressedLength = _compress(compressor, codec, data, length);
+    if (compressedLength > 0 && _headerLength + compressedLength < result) {
+        result = _headerLength + compressedLength;
+    }
+
+    return result;
+}
+
+CCNxSimpleFileTransferCodec
+ccnxSimpleFileTransferCompressor_SelectCodecForFile(CCNxSimpleFileTransferCompressor *compressor, int fileDescriptor,
+                                                    size_t fileSize, size_t chunkSize)
+{
+    assertTrue(chunkSize > 0, "The chunk size must be greater than 0");
+
+    CCNxSimpleFileTransferCodec result = CCNxSimpleFileTransferCodec_None;
+
+    uint64_t numChunks = (fileSize + chunkSize - 1) / chunkSize;
+    uint64_t numSamples = (numChunks < _maxSamples) ? numChunks : _maxSamples;
+
+    uint8_t *sample = parcMemory_Allocate(chunkSize);
+    assertNotNull(sample, "parcMemory_Allocate(%zu) returned NULL", chunkSize);
+
+    // Chunks spread evenly across the file, as the start of a file, e.g. a header, may not be like the rest of it.
+    size_t numSampled = 0;
+    size_t lz4Length = 0;
+    size_t zstdLength = 0;
+    for (uint64_t i = 0; i < numSamples; i++) {
+        uint64_t chunkNumber = i * numChunks / numSamples;
+        ssize_t numRead = pread(fileDescriptor, sample, chunkSize, (off_t) (chunkNumber * chunkSize));
+        if (numRead > 0) {
+            numSampled += 1 + (size_t) numRead;
+            lz4Length += _getFramedLength(compressor, CCNxSimpleFileTransferCodec_LZ4, sample, (size_t) numRead);
+            zstdLength += _getFramedLength(compressor, CCNxSimpleFileTransferCodec_Zstd, sample, (size_t) numRead);
+        }
+    }
+
+    size_t maxWorthwhileLength = (size_t) (numSampled * _maxWorthwhileRatio);
+    if (numSampled > 0) {
+        if (zstdLength <= maxWorthwhileLength) {
+            result = CCNxSimpleFileTransferCodec_Zstd;
+        }
+        if (lz4Length <= maxWorthwhileLength
+            && (result == CCNxSimpleFileTransferCodec_None || lz4Length <= (size_t) (zstdLength * _lz4Tolerance))) {
+            result = CCNxSimpleFileTransferCodec_LZ4;
+        }
+    }
+
+    parcMemory_Deallocate((void **) &sample);
+
+    return result;
+}
+
+/**
+ * Whether every one of the bytes is zero.
+ */
+static bool
+_isAllZeros(const uint8_t *data, size_t length)
+{
+    return length > 0 && data[0] == 0 && memcmp(data, data + 1, length - 1) == 0;
+}
+
+PARCBuffer *
+ccnxSimpleFileTransferCompressor_EncodeZeros(size_t length)
+{
+    assertTrue(length <= UINT32_MAX, "A chunk of %zu bytes is too long to frame", length);
+
+    PARCBuffer *result = parcBuffer_Allocate(_headerLength);
+    parcBuffer_PutUint8(result, (uint8_t) CCNxSimpleFileTransferCodec_Zeros);
+    parcBuffer_PutUint32(result, (uint32_t) length);
+
+    return parcBuffer_Flip(result);
+}
+
+PARCBuffer *
+ccnxSimpleFileTransferCompressor_Encode(CCNxSimpleFileTransferCompressor *compressor, CCNxSimpleFileTransferCodec codec,
+                                        const PARCBuffer *chunk)
+{
+    size_t length = parcBuffer_Remaining(chunk);
+    const uint8_t *data = parcBuffer_Overlay((PARCBuffer *) chunk, 0);
+
+    if (length <= UINT32_MAX && _isAllZeros(data, length)) {
+        return ccnxSimpleFileTransferCompressor_EncodeZeros(length);
+    }
+
+    size_t compressedLength = 0;
+    if (codec != CCNxSimpleFileTransferCodec_None && length <= UINT32_MAX) {
+        compressedLength = _compress(compressor, codec, data, length);
+    }
+
+    PARCBuffer *result = NULL;
+    if (compressedLength > 0 && _headerLength + compressedLength < 1 + length) {
+        result = parcBuffer_Allocate(_headerLength + compressedLength);
+        parcBuffer_PutUint8(result, (uint8_t) codec);
+        parcBuffer_PutUint32(result, (uint32_t) length);
+        parcBuffer_PutArray(result, compressedLength, compressor->scratch);
+    } else {
+        result = parcBuffer_Allocate(1 + length);
+        parcBuffer_PutUint8(result, (uint8_t) CCNxSimpleFileTransferCodec_None);
+        parcBuffer_PutArray(result, length, data);
+    }
+
+    return parcBuffer_Flip(result);
+}
+
+/*
+ * Return a slice of the compressor's zeros, so a chunk of zeros costs no more than the slice, and can be told
+ * apart from other chunks by its bytes. The zeros grow to the longest chunk asked for, and chunks decoded before
+ * they grew keep the old ones.
+ */
+static PARCBuffer *
+_sliceZeros(CCNxSimpleFileTransferCompressor *compressor, size_t length)
+{
+    if (compressor->zeros == NULL || parcBuffer_Capacity(compressor->zeros) < length) {
+        if (compressor->zeros != NULL) {
+            parcBuffer_Release(&compressor->zeros);
+        }
+        compressor->zeros = parcBuffer_Allocate(length);
+        memset(parcBuffer_Overlay(compressor->zeros, 0), 0, length);
+    }
+
+    PARCBuffer *result = parcBuffer_Slice(compressor->zeros);
+    return parcBuffer_SetLimit(result, length);
+}
+
+PARCBuffer *
+ccnxSimpleFileTransferCompressor_Decode(CCNxSimpleFileTransferCompressor *compressor, const PARCBuffer *payload,
+                                        size_t maxLength)
+{
+    PARCBuffer *result = NULL;
+
+    size_t payloadLength = parcBuffer_Remaining(payload);
+    const uint8_t *frame = parcBuffer_Overlay((PARCBuffer *) payload, 0);
+
+    if (payloadLength >= 1 && frame[0] == CCNxSimpleFileTransferCodec_None) {
+        if (payloadLength - 1 <= maxLength) {
+            // The chunk is as it was, after the codec byte.
+            result = parcBuffer_Slice(payload);
+            parcBuffer_SetPosition(result, 1);
+        }
+    } else if (payloadLength >= _headerLength) {
+        size_t length = ((size_t) frame[1] << 24) | ((size_t) frame[2] << 16) | ((size_t) frame[3] << 8) | frame[4];
+
+        if (frame[0] == CCNxSimpleFileTransferCodec_Zeros) {
+            if (payloadLength == _headerLength && length <= maxLength) {
+                result = _sliceZeros(compressor, length);
+            }
+        } else if (length > 0 && length <= maxLength && payloadLength > _headerLength) {
+            result = parcBuffer_Allocate(length);
+            if (!_decompress(compressor, (CCNxSimpleFileTransferCodec) frame[0], frame + _headerLength,
+                             payloadLength - _headerLength, parcBuffer_Overlay(result, 0), length)) {
+                parcBuffer_Release(&result);
+            }
+        }
+    }
+
+    return result;
+}
+
+bool
+ccnxSimpleFileTransferCompressor_IsZeros(const CCNxSimpleFileTransferCompressor *compressor, const PARCBuffer *chunk)
+{
+    return compressor->zeros != NULL && parcBuffer_Array(chunk) == parcBuffer_Array(compressor->zeros);
+}
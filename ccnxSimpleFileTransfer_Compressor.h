@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+#ifndef ccnxSimpleFileTransfer_Compressor_h
+#define ccnxSimpleFileTransfer_Compressor_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <parc/algol/parc_Buffer.h>
+
+/**
+ * The codecs a chunk's payload may be compressed with. The value is sent as the first byte of a compressed
+ * payload. zstd and lz4 are only available if the server or client was built with them. A chunk that is all
+ * zeros, such as one in a hole of a sparse file, is sent as CCNxSimpleFileTransferCodec_Zeros, with no bytes
+ * after its length, whichever codec its file uses.
+ */
+typedef enum {
+    CCNxSimpleFileTransferCodec_None = 0,
+    CCNxSimpleFileTransferCodec_LZ4 = 1,
+    CCNxSimpleFileTransferCodec_Zstd = 2,
+    CCNxSimpleFileTransferCodec_Zeros = 3,
+} CCNxSimpleFileTransferCodec;
+
+struct ccnxSimpleFileTransfer_Compressor;
+
+/**
+ * A `CCNxSimpleFileTransferCompressor` compresses and decompresses the payloads of chunks, and decides which codec,
+ * if any, is worth using for a file. It keeps the codecs' working state between calls, so it must only be used by
+ * one thread at a time.
+ *
+ * A compressed payload is framed so that it can be decompressed on its own: a byte naming the codec, then, unless
+ * the codec is CCNxSimpleFileTransferCodec_None, the uncompressed length as a 32-bit integer in network byte order,
+ * then the compressed bytes. A chunk that doesn't get smaller is sent with CCNxSimpleFileTransferCodec_None,
+ * followed by its bytes as they are.
+ */
+typedef struct ccnxSimpleFileTransfer_Compressor CCNxSimpleFileTransferCompressor;
+
+/**
+ * Create a new `CCNxSimpleFileTransferCompressor`.
+ * The newly created instance must eventually be released by calling `ccnxSimpleFileTransferCompressor_Release`.
+ */
+CCNxSimpleFileTransferCompressor *ccnxSimpleFileTransferCompressor_Create(void);
+
+/**
+ * Increase the number of references to a `CCNxSimpleFileTransferCompressor` instance.
+ *
+ * @param [in] instance A pointer to the original `CCNxSimpleFileTransferCompressor`.
+ * @return The value of the input parameter @p instance.
+ *
+ * @see ccnxSimpleFileTransferCompressor_Release
+ */
+CCNxSimpleFileTransferCompressor *ccnxSimpleFileTransferCompressor_Acquire(const CCNxSimpleFileTransferCompressor *instance);
+
+/**
+ * Release a previously acquired reference to the specified instance,
+ * decrementing the reference count for the instance.
+ *
+ * @param [in,out] compressorPtr A pointer to a pointer to the instance to release.
+ *
+ * @see ccnxSimpleFileTransferCompressor_Acquire
+ */
+void ccnxSimpleFileTransferCompressor_Release(CCNxSimpleFileTransferCompressor **compressorPtr);
+
+/**
+ * Return whether this build can compress and decompress with the given codec.
+ */
+bool ccnxSimpleFileTransferCompressor_IsAvailable(CCNxSimpleFileTransferCodec codec);
+
+/**
+ * Return the name of a codec, e.g. "zstd", for messages.
+ */
+const char *ccnxSimpleFileTransferCompressor_GetCodecName(CCNxSimpleFileTransferCodec codec);
+
+/**
+ * Decide which codec to compress a file's chunks with, by compressing a few chunks sampled from across the file
+ * with each available codec. The codec that saves the most is chosen, unless it doesn't save enough to be worth
+ * the time, as with a file that is already compressed. lz4 is preferred if it saves nearly as much as zstd, as it
+ * is much faster.
+ *
+ * @param [in] compressor - the compressor.
+ * @param [in] fileDescriptor - a descriptor open for reading on the file.
+ * @param [in] fileSize - the size of the file.
+ * @param [in] chunkSize - the size of each chunk, which is compressed on its own.
+ * @return The codec to use, or CCNxSimpleFileTransferCodec_None.
+ */
+CCNxSimpleFileTransferCodec ccnxSimpleFileTransferCompressor_SelectCodecForFile(CCNxSimpleFileTransferCompressor *compressor,
+                                                                                int fileDescriptor, size_t fileSize,
+                                                                                size_t chunkSize);
+
+/**
+ * Compress a chunk with the given codec, and frame it. If the codec isn't available, or doesn't make the chunk
+ * smaller, the chunk is framed as it is. A chunk of zeros is framed as CCNxSimpleFileTransferCodec_Zeros.
+ * The returned PARCBuffer must eventually be released by calling parcBuffer_Release().
+ *
+ * @param [in] compressor - the compressor.
+ * @param [in] codec - the codec to compress with.
+ * @param [in] chunk - the chunk, from its position to its limit.
+ * @return A new PARCBuffer holding the framed chunk, ready to be read.
+ */
+PARCBuffer *ccnxSimpleFileTransferCompressor_Encode(CCNxSimpleFileTransferCompressor *compressor,
+                                                    CCNxSimpleFileTransferCodec codec, const PARCBuffer *chunk);
+
+/**
+ * Frame a chunk of zeros, without having to read it, as for a chunk in a hole of a sparse file.
+ * The returned PARCBuffer must eventually be released by calling parcBuffer_Release().
+ *
+ * @param [in] length - the length of the chunk.
+ * @return A new PARCBuffer holding the framed chunk, ready to be read.
+ */
+PARCBuffer *ccnxSimpleFileTransferCompressor_EncodeZeros(size_t length);
+
+/**
+ * Decompress a chunk framed by `ccnxSimpleFileTransferCompressor_Encode`.
+ * The returned PARCBuffer must eventually be released by calling parcBuffer_Release(). It must not be written
+ * to: a chunk framed as zeros is decoded to a slice of zeros the compressor shares between such chunks, without
+ * allocating or clearing any, and a chunk framed as it is to a slice of the payload.
+ *
+ * @param [in] compressor - the compressor.
+ * @param [in] payload - the framed chunk, from its position to its limit.
+ * @param [in] maxLength - the most bytes the chunk may decompress to.
+ * @return A new PARCBuffer holding the chunk, ready to be read, or NULL if the payload isn't a valid framed chunk,
+ *         is longer than maxLength, or uses a codec that isn't available.
+ */
+PARCBuffer *ccnxSimpleFileTransferCompressor_Decode(CCNxSimpleFileTransferCompressor *compressor, const PARCBuffer *payload,
+                                                    size_t maxLength);
+
+/**
+ * Whether a chunk from `ccnxSimpleFileTransferCompressor_Decode` was framed as CCNxSimpleFileTransferCodec_Zeros,
+ * so is all zeros, without looking at its bytes.
+ *
+ * @param [in] compressor - the compressor that decoded the chunk.
+ * @param [in] chunk - the decoded chunk.
+ * @return true if the chunk was framed as zeros, false if it wasn't, or it was decoded before a longer chunk of
+ *         zeros was.
+ */
+bool ccnxSimpleFileTransferCompressor_IsZeros(const CCNxSimpleFileTransferCompressor *compressor, const PARCBuffer *chunk);
+
+#endif // ccnxSimpleFileTransfer_Compressor_h
@@ -0,0 +1,432 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "ccnxSimpleFileTransfer_EventLoop.h"
+
+/**
+ * The most events collected from the operating system by one iteration of the loop.
+ */
+#define _maxEventsPerIteration 64
+
+typedef struct eventLoopWatcher {
+    int fileDescriptor;             // -1 once unwatched.
+    unsigned int events;
+    CCNxSimpleFileTransferEventLoopCallback *callback;
+    void *context;
+} _EventLoopWatcher;
+
+typedef struct eventLoopTimer {
+    uint64_t periodMillis;
+    uint64_t dueMillis;
+    CCNxSimpleFileTransferEventLoopTimerCallback *callback;
+    void *context;
+} _EventLoopTimer;
+
+struct ccnxSimpleFileTransfer_EventLoop {
+    int epollFileDescriptor;        // -1 where we use poll().
+
+    // Each watcher is allocated on its own so that epoll can keep a pointer to it. Unwatched watchers
+    // are only freed at the end of an iteration, as events for them may already have been collected.
+    _EventLoopWatcher **watchers;
+    size_t numWatchers;
+    size_t watcherCapacity;
+
+    _EventLoopTimer *timers;
+    size_t numTimers;
+    size_t timerCapacity;
+
+    bool isStopped;
+};
+
+static uint64_t
+_nowMillis(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000 + (uint64_t) now.tv_nsec / 1000000;
+}
+
+static _EventLoopWatcher *
+_findWatcher(const CCNxSimpleFileTransferEventLoop *eventLoop, int fileDescriptor)
+{
+    for (size_t i = 0; i < eventLoop->numWatchers; i++) {
+        if (eventLoop->watchers[i]->fileDescriptor == fileDescriptor) {
+            return eventLoop->watchers[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Free the watchers that have been unwatched.
+ */
+static void
+_removeUnwatched(CCNxSimpleFileTransferEventLoop *eventLoop)
+{
+    size_t numKept = 0;
+    for (size_t i = 0; i < eventLoop->numWatchers; i++) {
+        if (eventLoop->watchers[i]->fileDescriptor < 0) {
+            parcMemory_Deallocate((void **) &eventLoop->watchers[i]);
+        } else {
+            eventLoop->watchers[numKept++] = eventLoop->watchers[i];
+        }
+    }
+    eventLoop->numWatchers = numKept;
+}
+
+#ifdef __linux__
+static uint32_t
+_toEpollEvents(unsigned int events)
+{
+    uint32_t result = 0;
+    if (events & CCNxSimpleFileTransferEventLoopEvent_Readable) {
+        result |= EPOLLIN;
+    }
+    if (events & CCNxSimpleFileTransferEventLoopEvent_Writable) {
+        result |= EPOLLOUT;
+    }
+    return result;
+}
+
+static unsigned int
+_fromEpollEvents(uint32_t epollEvents)
+{
+    unsigned int result = 0;
+    if (epollEvents & EPOLLIN) {
+        result |= CCNxSimpleFileTransferEventLoopEvent_Readable;
+    }
+    if (epollEvents & EPOLLOUT) {
+        result |= CCNxSimpleFileTransferEventLoopEvent_Writable;
+    }
+    if (epollEvents & (EPOLLERR | EPOLLHUP)) {
+        result |= CCNxSimpleFileTransferEventLoopEvent_Error;
+    }
+    return result;
+}
+
+static bool
+_epollControl(CCNxSimpleFileTransferEventLoop *eventLoop, int operation, _EventLoopWatcher *watcher)
+{
+    struct epoll_event event = { .events = _toEpollEvents(watcher->events), .data.ptr = watcher };
+    return epoll_ctl(eventLoop->epollFileDescriptor, operation, watcher->fileDescriptor, &event) == 0;
+}
+
+/**
+ * Wait for events with epoll and call back for them.
+ */
+static size_t
+_waitAndDispatch(CCNxSimpleFileTransferEventLoop *eventLoop, int waitMillis)
+{
+    size_t result = 0;
+    struct epoll_event events[_maxEventsPerIteration];
+
+    int numEvents = epoll_wait(eventLoop->epollFileDescriptor, events, _maxEventsPerIteration, waitMillis);
+    for (int i = 0; i < numEvents; i++) {
+        _EventLoopWatcher *watcher = events[i].data.ptr;
+        if (watcher->fileDescriptor >= 0) {
+            watcher->callback(eventLoop, watcher->fileDescriptor, _fromEpollEvents(events[i].events), watcher->context);
+            result++;
+        }
+    }
+    return result;
+}
+
+#else // __linux__
+
+// Without epoll, the set of watched file descriptors is passed to each poll() and there is nothing to control.
+enum { EPOLL_CTL_ADD, EPOLL_CTL_MOD, EPOLL_CTL_DEL };
+
+static bool
+_epollControl(CCNxSimpleFileTransferEventLoop *eventLoop, int operation, _EventLoopWatcher *watcher)
+{
+    return true;
+}
+#endif // __linux__
+
+/**
+ * Wait for events with poll() and call back for them.
+ */
+static size_t
+_pollAndDispatch(CCNxSimpleFileTransferEventLoop *eventLoop, int waitMillis)
+{
+    size_t result = 0;
+    size_t numWatchers = eventLoop->numWatchers;
+    struct pollfd *pollFileDescriptors = parcMemory_AllocateAndClear((numWatchers + 1) * sizeof(struct pollfd));
+    _EventLoopWatcher **watchers = parcMemory_AllocateAndClear((numWatchers + 1) * sizeof(_EventLoopWatcher *));
+
+    for (size_t i = 0; i < numWatchers; i++) {
+        watchers[i] = eventLoop->watchers[i];
+        pollFileDescriptors[i].fd = watchers[i]->fileDescriptor;
+        pollFileDescriptors[i].events = ((watchers[i]->events & CCNxSimpleFileTransferEventLoopEvent_Readable) ? POLLIN : 0)
+                                        | ((watchers[i]->events & CCNxSimpleFileTransferEventLoopEvent_Writable) ? POLLOUT : 0);
+    }
+
+    if (poll(pollFileDescriptors, numWatchers, waitMillis) > 0) {
+        for (size_t i = 0; i < numWatchers; i++) {
+            short revents = pollFileDescriptors[i].revents;
+            if (revents != 0 && watchers[i]->fileDescriptor >= 0) {
+                unsigned int events = ((revents & POLLIN) ? CCNxSimpleFileTransferEventLoopEvent_Readable : 0)
+                                      | ((revents & POLLOUT) ? CCNxSimpleFileTransferEventLoopEvent_Writable : 0)
+                                      | ((revents & (POLLERR | POLLHUP | POLLNVAL)) ? CCNxSimpleFileTransferEventLoopEvent_Error : 0);
+                watchers[i]->callback(eventLoop, watchers[i]->fileDescriptor, events, watchers[i]->context);
+                result++;
+            }
+        }
+    }
+
+    parcMemory_Deallocate((void **) &watchers);
+    parcMemory_Deallocate((void **) &pollFileDescriptors);
+    return result;
+}
+
+static void
+_eventLoop_Finalize(CCNxSimpleFileTransferEventLoop **eventLoopPtr)
+{
+    CCNxSimpleFileTransferEventLoop *eventLoop = *eventLoopPtr;
+
+    for (size_t i = 0; i < eventLoop->numWatchers; i++) {
+        parcMemory_Deallocate((void **) &eventLoop->watchers[i]);
+    }
+    if (eventLoop->watchers != NULL) {
+        parcMemory_Deallocate((void **) &eventLoop->watchers);
+    }
+    if (eventLoop->timers != NULL) {
+        parcMemory_Deallocate((void **) &eventLoop->timers);
+    }
+    if (eventLoop->epollFileDescriptor >= 0) {
+        close(eventLoop->epollFileDescriptor);
+    }
+}
+
+parcObject_ExtendPARCObject(CCNxSimpleFileTransferEventLoop,
+                            _eventLoop_Finalize,
+                            NULL, NULL, NULL, NULL, NULL, NULL);
+
+parcObject_ImplementAcquire(ccnxSimpleFileTransferEventLoop, CCNxSimpleFileTransferEventLoop);
+
+parcObject_ImplementRelease(ccnxSimpleFileTransferEventLoop, CCNxSimpleFileTransferEventLoop);
+
+CCNxSimpleFileTransferEventLoop *
+ccnxSimpleFileTransferEventLoop_Create(void)
+{
+    CCNxSimpleFileTransferEventLoop *result = parcObject_CreateAndClearInstance(CCNxSimpleFileTransferEventLoop);
+
+    result->epollFileDescriptor = -1;
+#ifdef __linux__
+    result->epollFileDescriptor = epoll_create1(EPOLL_CLOEXEC);
+    if (result->epollFileDescriptor < 0) {
+        ccnxSimpleFileTransferEventLoop_Release(&result);
+    }
+#endif
+
+    return result;
+}
+
+bool
+ccnxSimpleFileTransferEventLoop_Watch(CCNxSimpleFileTransferEventLoop *eventLoop, int fileDescriptor, unsigned int events,
+                                      CCNxSimpleFileTransferEventLoopCallback *callback, void *context)
+{
+    assertTrue(fileDescriptor >= 0, "Expected a valid file descriptor, got %d", fileDescriptor);
+    assertNotNull(callback, "The callback must not be NULL");
+    assertNull(_findWatcher(eventLoop, fileDescriptor), "File descriptor %d is already watched", fileDescriptor);
+
+    _EventLoopWatcher *watcher = parcMemory_AllocateAndClear(sizeof(_EventLoopWatcher));
+    assertNotNull(watcher, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(_EventLoopWatcher));
+    watcher->fileDescriptor = fileDescriptor;
+    watcher->events = events;
+    watcher->callback = callback;
+    watcher->context = context;
+
+    if (eventLoop->epollFileDescriptor >= 0 && !_epollControl(eventLoop, EPOLL_CTL_ADD, watcher)) {
+        parcMemory_Deallocate((void **) &watcher);
+        return false;
+    }
+
+    if (eventLoop->numWatchers == eventLoop->watcherCapacity) {
+        eventLoop->watcherCapacity = (eventLoop->watcherCapacity == 0) ? 8 : eventLoop->watcherCapacity * 2;
+        eventLoop->watchers = parcMemory_Reallocate(eventLoop->watchers, eventLoop->watcherCapacity * sizeof(_EventLoopWatcher *));
+        assertNotNull(eventLoop->watchers, "parcMemory_Reallocate(%zu) returned NULL",
+                      eventLoop->watcherCapacity * sizeof(_EventLoopWatcher *));
+    }
+    eventLoop->watchers[eventLoop->numWatchers++] = watcher;
+
+    return true;
+}
+
+bool
+ccnxSimpleFileTransferEventLoop_SetEvents(CCNxSimpleFileTransferEventLoop *eventLoop, int fileDescriptor, unsigned int events)
+{
+    bool result = false;
+
+    _EventLoopWatcher *watcher = _findWatcher(eventLoop, fileDescriptor);
+    if (watcher != NULL) {
+        result = true;
+        if (watcher->events != events) {
+            watcher->events = events;
+            if (eventLoop->epollFileDescriptor >= 0) {
+                result = _epollControl(eventLoop, EPOLL_CTL_MOD, watcher);
+            }
+        }
+    }
+    return result;
+}
+
+void
+ccnxSimpleFileTransferEventLoop_Unwatch(CCNxSimpleFileTransferEventLoop *eventLoop, int fileDescriptor)
+{
+    _EventLoopWatcher *watcher = _findWatcher(eventLoop, fileDescriptor);
+    if (watcher != NULL) {
+        if (eventLoop->epollFileDescriptor >= 0) {
+            _epollControl(eventLoop, EPOLL_CTL_DEL, watcher);
+        }
+        watcher->fileDescriptor = -1;
+    }
+}
+
+void
+ccnxSimpleFileTransferEventLoop_AddTimer(CCNxSimpleFileTransferEventLoop *eventLoop, uint64_t periodMillis,
+                                         CCNxSimpleFileTransferEventLoopTimerCallback *callback, void *context)
+{
+    assertTrue(periodMillis > 0, "The period of a timer must be greater than 0");
+    assertNotNull(callback, "The callback must not be NULL");
+
+    if (eventLoop->numTimers == eventLoop->timerCapacity) {
+        eventLoop->timerCapacity = (eventLoop->timerCapacity == 0) ? 4 : eventLoop->timerCapacity * 2;
+        eventLoop->timers = parcMemory_Reallocate(eventLoop->timers, eventLoop->timerCapacity * sizeof(_EventLoopTimer));
+        assertNotNull(eventLoop->timers, "parcMemory_Reallocate(%zu) returned NULL",
+                      eventLoop->timerCapacity * sizeof(_EventLoopTimer));
+    }
+
+    _EventLoopTimer *timer = &eventLoop->timers[eventLoop->numTimers++];
+    timer->periodMillis = periodMillis;
+    timer->dueMillis = _nowMillis() + periodMillis;
+    timer->callback = callback;
+    timer->context = context;
+}
+
+size_t
+ccnxSimpleFileTransferEventLoop_RunOnce(CCNxSimpleFileTransferEventLoop *eventLoop, int maxWaitMillis)
+{
+    size_t result = 0;
+
+    // Don't wait past the next timer.
+    uint64_t now = _nowMillis();
+    int waitMillis = maxWaitMillis;
+    for (size_t i = 0; i < eventLoop->numTimers; i++) {
+        uint64_t untilDue = (eventLoop->timers[i].dueMillis > now) ? eventLoop->timers[i].dueMillis - now : 0;
+        if (waitMillis < 0 || untilDue < (uint64_t) waitMillis) {
+            waitMillis = (int) untilDue;
+        }
+    }
+
+#ifdef __linux__
+    if (eventLoop->epollFileDescriptor >= 0) {
+        result += _waitAndDispatch(eventLoop, waitMillis);
+    } else {
+        result += _pollAndDispatch(eventLoop, waitMillis);
+    }
+#else
+    result += _pollAndDispatch(eventLoop, waitMillis);
+#endif
+
+    // Timers added by the callbacks below are first due a period from now, so only look at those we have.
+    now = _nowMillis();
+    size_t numTimers = eventLoop->numTimers;
+    for (size_t i = 0; i < numTimers; i++) {
+        if (eventLoop->timers[i].dueMillis <= now) {
+            // If we have fallen behind, skip the missed periods rather than calling back for each of them.
+            eventLoop->timers[i].dueMillis += eventLoop->timers[i].periodMillis;
+            if (eventLoop->timers[i].dueMillis <= now) {
+                eventLoop->timers[i].dueMillis = now + eventLoop->timers[i].periodMillis;
+            }
+            eventLoop->timers[i].callback(eventLoop, eventLoop->timers[i].context);
+            result++;
+        }
+    }
+
+    _removeUnwatched(eventLoop);
+
+    return result;
+}
+
+void
+ccnxSimpleFileTransferEventLoop_Run(CCNxSimpleFileTransferEventLoop *eventLoop)
+{
+    eventLoop->isStopped = false;
+    while (!eventLoop->isStopped) {
+        ccnxSimpleFileTransferEventLoop_RunOnce(eventLoop, -1);
+    }
+}
+
+void
+ccnxSimpleFileTransferEventLoop_Stop(CCNxSimpleFileTransferEventLoop *eventLoop)
+{
+    eventLoop->isStopped = true;
+}
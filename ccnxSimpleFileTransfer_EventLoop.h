@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+#ifndef ccnxSimpleFileTransfer_EventLoop_h
+#define ccnxSimpleFileTransfer_EventLoop_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct ccnxSimpleFileTransfer_EventLoop;
+
+/**
+ * A `CCNxSimpleFileTransferEventLoop` waits for file descriptors to become readable or writable, and for
+ * periodic timers to come due, and calls back when they do. It uses epoll on Linux and poll() elsewhere.
+ *
+ * An event loop is used by one thread. Callbacks are called from `ccnxSimpleFileTransferEventLoop_RunOnce`
+ * (or `ccnxSimpleFileTransferEventLoop_Run`) and may watch, change or unwatch file descriptors, add timers,
+ * or stop the loop.
+ */
+typedef struct ccnxSimpleFileTransfer_EventLoop CCNxSimpleFileTransferEventLoop;
+
+/**
+ * The events a file descriptor can be watched for. Errors and hang-ups are always reported.
+ */
+typedef enum {
+    CCNxSimpleFileTransferEventLoopEvent_Readable = 0x01,
+    CCNxSimpleFileTransferEventLoopEvent_Writable = 0x02,
+    CCNxSimpleFileTransferEventLoopEvent_Error    = 0x04,
+} CCNxSimpleFileTransferEventLoopEvent;
+
+/**
+ * Called when a watched file descriptor has some of the events it is watched for.
+ *
+ * @param [in] eventLoop - the loop calling back.
+ * @param [in] fileDescriptor - the file descriptor.
+ * @param [in] events - the `CCNxSimpleFileTransferEventLoopEvent` flags that have occurred.
+ * @param [in] context - the context the file descriptor was watched with.
+ */
+typedef void (CCNxSimpleFileTransferEventLoopCallback)(CCNxSimpleFileTransferEventLoop *eventLoop,
+                                                       int fileDescriptor, unsigned int events, void *context);
+
+/**
+ * Called when a timer comes due.
+ *
+ * @param [in] eventLoop - the loop calling back.
+ * @param [in] context - the context the timer was added with.
+ */
+typedef void (CCNxSimpleFileTransferEventLoopTimerCallback)(CCNxSimpleFileTransferEventLoop *eventLoop, void *context);
+
+/**
+ * Create a new, empty `CCNxSimpleFileTransferEventLoop`.
+ * The newly created instance must eventually be released by calling `ccnxSimpleFileTransferEventLoop_Release`.
+ *
+ * @return A new event loop, or NULL if the operating system would not create one.
+ */
+CCNxSimpleFileTransferEventLoop *ccnxSimpleFileTransferEventLoop_Create(void);
+
+/**
+ * Increase the number of references to a `CCNxSimpleFileTransferEventLoop` instance.
+ *
+ * @param [in] instance A pointer to the original `CCNxSimpleFileTransferEventLoop`.
+ * @return The value of the input parameter @p instance.
+ *
+ * @see ccnxSimpleFileTransferEventLoop_Release
+ */
+CCNxSimpleFileTransferEventLoop *ccnxSimpleFileTransferEventLoop_Acquire(const CCNxSimpleFileTransferEventLoop *instance);
+
+/**
+ * Release a previously acquired reference to the specified instance,
+ * decrementing the reference count for the instance.
+ * The watched file descriptors are not closed.
+ *
+ * @param [in,out] eventLoopPtr A pointer to a pointer to the instance to release.
+ *
+ * @see ccnxSimpleFileTransferEventLoop_Acquire
+ */
+void ccnxSimpleFileTransferEventLoop_Release(CCNxSimpleFileTransferEventLoop **eventLoopPtr);
+
+/**
+ * Start watching a file descriptor.
+ *
+ * @param [in] eventLoop - the loop.
+ * @param [in] fileDescriptor - the file descriptor to watch. It must not already be watched.
+ * @param [in] events - the `CCNxSimpleFileTransferEventLoopEvent` flags to watch for. May be 0.
+ * @param [in] callback - called when any of the events occur.
+ * @param [in] context - passed to `callback`.
+ *
+ * @return true if the file descriptor is now watched, false otherwise.
+ */
+bool ccnxSimpleFileTransferEventLoop_Watch(CCNxSimpleFileTransferEventLoop *eventLoop, int fileDescriptor, unsigned int events,
+                                           CCNxSimpleFileTransferEventLoopCallback *callback, void *context);
+
+/**
+ * Change the events a watched file descriptor is watched for.
+ *
+ * @param [in] eventLoop - the loop.
+ * @param [in] fileDescriptor - a watched file descriptor.
+ * @param [in] events - the `CCNxSimpleFileTransferEventLoopEvent` flags to watch for. May be 0.
+ *
+ * @return true if the events were changed, false otherwise.
+ */
+bool ccnxSimpleFileTransferEventLoop_SetEvents(CCNxSimpleFileTransferEventLoop *eventLoop, int fileDescriptor, unsigned int events);
+
+/**
+ * Stop watching a file descriptor. Its callback will not be called again, even for events that
+ * have already been collected by the current iteration of the loop.
+ *
+ * @param [in] eventLoop - the loop.
+ * @param [in] fileDescriptor - a watched file descriptor.
+ */
+void ccnxSimpleFileTransferEventLoop_Unwatch(CCNxSimpleFileTransferEventLoop *eventLoop, int fileDescriptor);
+
+/**
+ * Add a timer that calls back every `periodMillis` milliseconds, starting `periodMillis` from now,
+ * until the loop is released.
+ *
+ * @param [in] eventLoop - the loop.
+ * @param [in] periodMillis - the period of the timer. Must be greater than 0.
+ * @param [in] callback - called each time the timer comes due.
+ * @param [in] context - passed to `callback`.
+ */
+void ccnxSimpleFileTransferEventLoop_AddTimer(CCNxSimpleFileTransferEventLoop *eventLoop, uint64_t periodMillis,
+                                              CCNxSimpleFileTransferEventLoopTimerCallback *callback, void *context);
+
+/**
+ * Wait for at most `maxWaitMillis` for any watched events or timers, and call back for them.
+ * The wait is cut short by the next timer that is due.
+ *
+ * @param [in] eventLoop - the loop.
+ * @param [in] maxWaitMillis - how long to wait. 0 polls without waiting, and -1 waits until something happens.
+ *
+ * @return The number of callbacks called.
+ */
+size_t ccnxSimpleFileTransferEventLoop_RunOnce(CCNxSimpleFileTransferEventLoop *eventLoop, int maxWaitMillis);
+
+/**
+ * Call `ccnxSimpleFileTransferEventLoop_RunOnce` until `ccnxSimpleFileTransferEventLoop_Stop` is called.
+ *
+ * @param [in] eventLoop - the loop.
+ */
+void ccnxSimpleFileTransferEventLoop_Run(CCNxSimpleFileTransferEventLoop *eventLoop);
+
+/**
+ * Make `ccnxSimpleFileTransferEventLoop_Run` return once the current iteration finishes.
+ * It must be called from the thread running the loop, usually from a callback.
+ *
+ * @param [in] eventLoop - the loop.
+ */
+void ccnxSimpleFileTransferEventLoop_Stop(CCNxSimpleFileTransferEventLoop *eventLoop);
+
+#endif // ccnxSimpleFileTransfer_EventLoop_h
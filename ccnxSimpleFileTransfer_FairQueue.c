@@ -0,0 +1,541 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <string.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "ccnxSimpleFileTransfer_FairQueue.h"
+
+/**
+ * Marks the end of a chain of queued Interests, of a bucket's chain of classes, or of a free list.
+ */
+static const uint32_t _noEntry = UINT32_MAX;
+
+typedef struct fairQueueEntry {
+    CCNxInterest *interest;
+    uint64_t queuedAtMicros;
+    uint32_t next;                  // The next Interest in the same class, or in the free list.
+} _FairQueueEntry;
+
+typedef struct fairQueueClass {
+    char *name;                     // NULL while the class isn't in use.
+    uint64_t nameHash;
+    uint32_t nextInBucket;
+    unsigned int priority;
+
+    uint32_t firstEntry;            // The class's queued Interests, oldest first, chained through their 'next'.
+    uint32_t lastEntry;
+    size_t numEntries;
+
+    uint32_t nextActive;            // The round of the priority's classes with Interests queued, while numEntries > 0.
+    uint32_t previousActive;
+    int64_t deficitBytes;
+    bool hasTurn;
+
+    double tokenBytes;
+    uint64_t refilledAtMicros;
+} _FairQueueClass;
+
+typedef struct fairQueuePriority {
+    uint32_t currentClass;          // The class whose turn it is, or _noEntry if none has anything queued.
+    size_t numActiveClasses;
+    size_t numPassedOver;           // Interests answered from higher priorities in a row while these waited.
+} _FairQueuePriority;
+
+struct ccnxSimpleFileTransfer_FairQueue {
+    size_t capacity;
+    _FairQueueEntry *entries;       // All of them, queued or free.
+    uint32_t freeEntries;
+    size_t numEntries;
+
+    size_t numClasses;              // Enough that a class with nothing queued can always be reused.
+    _FairQueueClass *classes;
+    uint32_t *buckets;              // The first class of each bucket, chained through their 'nextInBucket'.
+    uint64_t bucketMask;
+    uint32_t nextClassToReuse;      // Where to look next for a class with nothing queued.
+
+    unsigned int numPriorities;
+    _FairQueuePriority *priorities;
+    size_t maxPassedOver;
+
+    size_t quantumBytes;
+    uint64_t bytesPerSecond;
+    size_t burstBytes;
+};
+
+static void
+_fairQueue_Finalize(CCNxSimpleFileTransferFairQueue **queuePtr)
+{
+    CCNxSimpleFileTransferFairQueue *queue = *queuePtr;
+
+    for (size_t i = 0; i < queue->numClasses; i++) {
+        _FairQueueClass *class = &queue->classes[i];
+        for (uint32_t index = class->firstEntry; class->numEntries > 0; class->numEntries--) {
+            ccnxInterest_Release(&queue->entries[index].interest);
+            index = queue->entries[index].next;
+        }
+        if (class->name != NULL) {
+            parcMemory_Deallocate((void **) &class->name);
+        }
+    }
+    parcMemory_Deallocate((void **) &queue->priorities);
+    parcMemory_Deallocate((void **) &queue->buckets);
+    parcMemory_Deallocate((void **) &queue->classes);
+    parcMemory_Deallocate((void **) &queue->entries);
+}
+
+parcObject_ExtendPARCObject(CCNxSimpleFileTransferFairQueue, _fairQueue_Finalize, NULL, NULL, NULL, NULL, NULL, NULL);
+
+parcObject_ImplementAcquire(ccnxSimpleFileTransferFairQueue, CCNxSimpleFileTransferFairQueue);
+
+parcObject_ImplementRelease(ccnxSimpleFileTransferFairQueue, CCNxSimpleFileTransferFairQueue);
+
+CCNxSimpleFileTransferFairQueue *
+ccnxSimpleFileTransferFairQueue_Create(size_t capacity, unsigned int numPriorities, size_t maxPassedOver,
+                                       size_t quantumBytes, uint64_t bytesPerSecond, size_t burstBytes)
+{
+    assertTrue(capacity > 0 && capacity < _noEntry / 2, "The capacity must be from 1 to %u", _noEntry / 2 - 1);
+    assertTrue(numPriorities > 0, "There must be at least 1 priority");
+    assertTrue(quantumBytes > 0, "The quantum must be at least 1 byte");
+
+    CCNxSimpleFileTransferFairQueue *result = parcObject_CreateAndClearInstance(CCNxSimpleFileTransferFairQueue);
+
+    result->capacity = capacity;
+    result->entries = parcMemory_AllocateAndClear(capacity * sizeof(_FairQueueEntry));
+    assertNotNull(result->entries, "parcMemory_AllocateAndClear(%zu) returned NULL", capacity * sizeof(_FairQueueEntry));
+    for (size_t i = 0; i < capacity; i++) {
+        result->entries[i].next = (i + 1 < capacity) ? (uint32_t) (i + 1) : _noEntry;
+    }
+    result->freeEntries = 0;
+
+    // Only classes with Interests queued have to be kept, and there can be no more of those than Interests.
+    // Twice as many lets an idle class keep its token bucket for a while, rather than being reused at once.
+    result->numClasses = 2 * capacity;
+    result->classes = parcMemory_AllocateAndClear(result->numClasses * sizeof(_FairQueueClass));
+    assertNotNull(result->classes, "parcMemory_AllocateAndClear(%zu) returned NULL",
+                  result->numClasses * sizeof(_FairQueueClass));
+
+    size_t numBuckets = 1;
+    while (numBuckets < result->numClasses) {
+        numBuckets <<= 1;
+    }
+    result->buckets = parcMemory_Allocate(numBuckets * sizeof(uint32_t));
+    assertNotNull(result->buckets, "parcMemory_Allocate(%zu) returned NULL", numBuckets * sizeof(uint32_t));
+    for (size_t i = 0; i < numBuckets; i++) {
+        result->buckets[i] = _noEntry;
+    }
+    result->bucketMask = numBuckets - 1;
+
+    result->numPriorities = numPriorities;
+    result->priorities = parcMemory_AllocateAndClear(numPriorities * sizeof(_FairQueuePriority));
+    assertNotNull(result->priorities, "parcMemory_AllocateAndClear(%zu) returned NULL",
+                  numPriorities * sizeof(_FairQueuePriority));
+    for (unsigned int i = 0; i < numPriorities; i++) {
+        result->priorities[i].currentClass = _noEntry;
+    }
+    result->maxPassedOver = maxPassedOver;
+
+    result->quantumBytes = quantumBytes;
+    result->bytesPerSecond = bytesPerSecond;
+    result->burstBytes = (burstBytes > quantumBytes) ? burstBytes : quantumBytes;
+
+    return result;
+}
+
+/**
+ * The 64 bit FNV-1a hash of a class name.
+ */
+static uint64_t
+_hashName(const char *name)
+{
+    uint64_t result = 14695981039346656037ULL;
+    for (const unsigned char *c = (const unsigned char *) name; *c != '\0'; c++) {
+        result = (result ^ *c) * 1099511628211ULL;
+    }
+    return result;
+}
+
+static uint32_t
+_findClass(const CCNxSimpleFileTransferFairQueue *queue, const char *name, uint64_t nameHash)
+{
+    uint32_t index = queue->buckets[nameHash & queue->bucketMask];
+    while (index != _noEntry) {
+        const _FairQueueClass *class = &queue->classes[index];
+        if (class->nameHash == nameHash && strcmp(class->name, name) == 0) {
+            break;
+        }
+        index = class->nextInBucket;
+    }
+    return index;
+}
+
+/**
+ * Take a class that has nothing queued, forgetting the class it was, if any. Classes are looked at in turn, so the
+ * one taken is usually one that has had nothing queued for a while.
+ */
+static uint32_t
+_reuseClass(CCNxSimpleFileTransferFairQueue *queue)
+{
+    uint32_t result = queue->nextClassToReuse;
+    while (queue->classes[result].numEntries > 0) {
+        result = (result + 1) % queue->numClasses;
+    }
+    queue->nextClassToReuse = (result + 1) % queue->numClasses;
+
+    _FairQueueClass *class = &queue->classes[result];
+    if (class->name != NULL) {
+        uint32_t *link = &queue->buckets[class->nameHash & queue->bucketMask];
+        while (*link != result) {
+            link = &queue->classes[*link].nextInBucket;
+        }
+        *link = class->nextInBucket;
+        parcMemory_Deallocate((void **) &class->name);
+    }
+    return result;
+}
+
+static uint32_t
+_getClass(CCNxSimpleFileTransferFairQueue *queue, const char *name, unsigned int priority, uint64_t nowMicros)
+{
+    uint64_t nameHash = _hashName(name);
+    uint32_t result = _findClass(queue, name, nameHash);
+    if (result == _noEntry) {
+        result = _reuseClass(queue);
+
+        _FairQueueClass *class = &queue->classes[result];
+        class->name = parcMemory_StringDuplicate(name, strlen(name));
+        class->nameHash = nameHash;
+        class->priority = priority;
+        class->tokenBytes = (double) queue->burstBytes;
+        class->refilledAtMicros = nowMicros;
+
+        uint32_t *bucket = &queue->buckets[nameHash & queue->bucketMask];
+        class->nextInBucket = *bucket;
+        *bucket = result;
+    }
+    return result;
+}
+
+/**
+ * Add a class that now has Interests queued to the round of its priority, just before the class whose turn it is,
+ * so that it has to wait for every other class to have a turn.
+ */
+static void
+_activateClass(CCNxSimpleFileTransferFairQueue *queue, uint32_t index)
+{
+    _FairQueueClass *class = &queue->classes[index];
+    _FairQueuePriority *priority = &queue->priorities[class->priority];
+    class->deficitBytes = 0;
+    class->hasTurn = false;
+
+    if (priority->currentClass == _noEntry) {
+        class->nextActive = index;
+        class->previousActive = index;
+        priority->currentClass = index;
+    } else {
+        _FairQueueClass *current = &queue->classes[priority->currentClass];
+        class->nextActive = priority->currentClass;
+        class->previousActive = current->previousActive;
+        queue->classes[current->previousActive].nextActive = index;
+        current->previousActive = index;
+    }
+    priority->numActiveClasses++;
+}
+
+static void
+_deactivateClass(CCNxSimpleFileTransferFairQueue *queue, uint32_t index)
+{
+    _FairQueueClass *class = &queue->classes[index];
+    _FairQueuePriority *priority = &queue->priorities[class->priority];
+    if (class->nextActive == index) {
+        priority->currentClass = _noEntry;
+        priority->numPassedOver = 0;
+    } else {
+        queue->classes[class->previousActive].nextActive = class->nextActive;
+        queue->classes[class->nextActive].previousActive = class->previousActive;
+        if (priority->currentClass == index) {
+            priority->currentClass = class->nextActive;
+        }
+    }
+    class->deficitBytes = 0;
+    class->hasTurn = false;
+    priority->numActiveClasses--;
+}
+
+/**
+ * Take the oldest Interest of a class, which must have one, and when it was queued.
+ */
+static CCNxInterest *
+_removeFirstEntry(CCNxSimpleFileTransferFairQueue *queue, uint32_t classIndex, uint64_t *queuedAtMicros)
+{
+    _FairQueueClass *class = &queue->classes[classIndex];
+    uint32_t index = class->firstEntry;
+    _FairQueueEntry *entry = &queue->entries[index];
+    CCNxInterest *result = entry->interest;
+    *queuedAtMicros = entry->queuedAtMicros;
+
+    entry->interest = NULL;
+    class->firstEntry = entry->next;
+    entry->next = queue->freeEntries;
+    queue->freeEntries = index;
+    queue->numEntries--;
+
+    if (--class->numEntries == 0) {
+        _deactivateClass(queue, classIndex);
+    }
+    return result;
+}
+
+/**
+ * Drop the oldest Interest of the longest class of the lowest priority that has any.
+ */
+static void
+_dropFromLongestClass(CCNxSimpleFileTransferFairQueue *queue)
+{
+    const _FairQueuePriority *priority = &queue->priorities[queue->numPriorities - 1];
+    while (priority->numActiveClasses == 0) {
+        priority--;
+    }
+
+    uint32_t longest = priority->currentClass;
+    uint32_t index = longest;
+    for (size_t i = 0; i < priority->numActiveClasses; i++) {
+        if (queue->classes[index].numEntries > queue->classes[longest].numEntries) {
+            longest = index;
+        }
+        index = queue->classes[index].nextActive;
+    }
+
+    uint64_t queuedAtMicros;
+    CCNxInterest *dropped = _removeFirstEntry(queue, longest, &queuedAtMicros);
+    ccnxInterest_Release(&dropped);
+}
+
+bool
+ccnxSimpleFileTransferFairQueue_Enqueue(CCNxSimpleFileTransferFairQueue *queue, const char *className, unsigned int priority,
+                                        const CCNxInterest *interest, uint64_t nowMicros)
+{
+    assertTrue(priority < queue->numPriorities, "Invalid priority %u", priority);
+
+    bool result = false;
+    if (queue->numEntries == queue->capacity) {
+        _dropFromLongestClass(queue);
+        result = true;
+    }
+
+    uint32_t classIndex = _getClass(queue, className, priority, nowMicros);
+    _FairQueueClass *class = &queue->classes[classIndex];
+
+    uint32_t index = queue->freeEntries;
+    _FairQueueEntry *entry = &queue->entries[index];
+    queue->freeEntries = entry->next;
+    queue->numEntries++;
+
+    entry->interest = ccnxInterest_Acquire(interest);
+    entry->queuedAtMicros = nowMicros;
+    entry->next = _noEntry;
+    if (class->numEntries == 0) {
+        class->firstEntry = index;
+        _activateClass(queue, classIndex);
+    } else {
+        queue->entries[class->lastEntry].next = index;
+    }
+    class->lastEntry = index;
+    class->numEntries++;
+
+    return result;
+}
+
+/**
+ * Whether a class may be sent to now, refilling its token bucket for the time since it was last refilled.
+ */
+static bool
+_isWithinRate(const CCNxSimpleFileTransferFairQueue *queue, _FairQueueClass *class, uint64_t nowMicros)
+{
+    if (queue->bytesPerSecond == 0) {
+        return true;
+    }
+    if (nowMicros > class->refilledAtMicros) {
+        class->tokenBytes += (double) (nowMicros - class->refilledAtMicros) * queue->bytesPerSecond / 1000000.0;
+        if (class->tokenBytes > queue->burstBytes) {
+            class->tokenBytes = (double) queue->burstBytes;
+        }
+        class->refilledAtMicros = nowMicros;
+    }
+    return class->tokenBytes > 0;
+}
+
+/**
+ * Take the next Interest of a priority, by deficit round robin across its classes.
+ */
+static CCNxInterest *
+_dequeueFromPriority(CCNxSimpleFileTransferFairQueue *queue, _FairQueuePriority *priority, uint64_t nowMicros,
+                     size_t *classNumber, uint64_t *queuedAtMicros)
+{
+    // Each class whose turn it is either gets an Interest answered, has its turn end, or is over its rate. Stop
+    // once every class in a row has been over its rate.
+    size_t numOverRate = 0;
+    while (priority->currentClass != _noEntry && numOverRate < priority->numActiveClasses) {
+        uint32_t classIndex = priority->currentClass;
+        _FairQueueClass *class = &queue->classes[classIndex];
+
+        if (!_isWithinRate(queue, class, nowMicros)) {
+            numOverRate++;
+            class->hasTurn = false;
+            priority->currentClass = class->nextActive;
+            continue;
+        }
+        numOverRate = 0;
+
+        if (!class->hasTurn) {
+            class->deficitBytes += queue->quantumBytes;
+            class->hasTurn = true;
+        }
+        if (class->deficitBytes > 0) {
+            *classNumber = classIndex;
+            return _removeFirstEntry(queue, classIndex, queuedAtMicros);
+        }
+
+        class->hasTurn = false;
+        priority->currentClass = class->nextActive;
+    }
+    return NULL;
+}
+
+CCNxInterest *
+ccnxSimpleFileTransferFairQueue_Dequeue(CCNxSimpleFileTransferFairQueue *queue, uint64_t nowMicros, size_t *classNumber,
+                                        uint64_t *waitMicros)
+{
+    CCNxInterest *result = NULL;
+    uint64_t queuedAtMicros = 0;
+    unsigned int served = 0;
+
+    // A priority that has been passed over too many times in a row goes first, the lowest first.
+    if (queue->maxPassedOver > 0) {
+        for (served = queue->numPriorities - 1; served > 0; served--) {
+            if (queue->priorities[served].numPassedOver >= queue->maxPassedOver) {
+                result = _dequeueFromPriority(queue, &queue->priorities[served], nowMicros, classNumber, &queuedAtMicros);
+                if (result != NULL) {
+                    break;
+                }
+            }
+        }
+    }
+    if (result == NULL) {
+        for (served = 0; served < queue->numPriorities; served++) {
+            result = _dequeueFromPriority(queue, &queue->priorities[served], nowMicros, classNumber, &queuedAtMicros);
+            if (result != NULL) {
+                break;
+            }
+        }
+    }
+
+    if (result != NULL) {
+        queue->priorities[served].numPassedOver = 0;
+        for (unsigned int lower = served + 1; lower < queue->numPriorities; lower++) {
+            if (queue->priorities[lower].numActiveClasses > 0) {
+                queue->priorities[lower].numPassedOver++;
+            }
+        }
+        if (waitMicros != NULL) {
+            *waitMicros = (nowMicros > queuedAtMicros) ? nowMicros - queuedAtMicros : 0;
+        }
+    }
+    return result;
+}
+
+void
+ccnxSimpleFileTransferFairQueue_Charge(CCNxSimpleFileTransferFairQueue *queue, size_t classNumber, size_t numBytes)
+{
+    assertTrue(classNumber < queue->numClasses, "Invalid class number %zu", classNumber);
+
+    // A class that has nothing left queued starts again from nothing when it next has, so only its rate matters.
+    _FairQueueClass *class = &queue->classes[classNumber];
+    if (class->numEntries > 0) {
+        class->deficitBytes -= (int64_t) numBytes;
+    }
+    class->tokenBytes -= (double) numBytes;
+}
+
+size_t
+ccnxSimpleFileTransferFairQueue_GetSize(const CCNxSimpleFileTransferFairQueue *queue)
+{
+    return queue->numEntries;
+}
+
+size_t
+ccnxSimpleFileTransferFairQueue_GetCapacity(const CCNxSimpleFileTransferFairQueue *queue)
+{
+    return queue->capacity;
+}
+
+unsigned int
+ccnxSimpleFileTransferFairQueue_GetClassPriority(const CCNxSimpleFileTransferFairQueue *queue, size_t classNumber)
+{
+    assertTrue(classNumber < queue->numClasses, "Invalid class number %zu", classNumber);
+    return queue->classes[classNumber].priority;
+}
+
+size_t
+ccnxSimpleFileTransferFairQueue_GetClassSize(const CCNxSimpleFileTransferFairQueue *queue, const char *className)
+{
+    uint32_t index = _findClass(queue, className, _hashName(className));
+    return (index == _noEntry) ? 0 : queue->classes[index].numEntries;
+}
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+#ifndef ccnxSimpleFileTransfer_FairQueue_h
+#define ccnxSimpleFileTransfer_FairQueue_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <ccnx/common/ccnx_Interest.h>
+
+struct ccnxSimpleFileTransfer_FairQueue;
+
+/**
+ * A `CCNxSimpleFileTransferFairQueue` holds the Interests a server has received but not yet answered, in classes
+ * named by the caller (e.g. one per file being fetched), and hands them back for answering in deficit round robin
+ * order across the classes. A class that sends many Interests therefore can't make the Interests of a class that
+ * sends few wait behind all of its own.
+ *
+ * Each class takes its turn in answering as many Interests as a quantum of bytes pays for. The caller charges each
+ * answered Interest the size of its response. Optionally, each class also has a token bucket that limits how fast
+ * it may be sent to, whatever the other classes are doing.
+ *
+ * Each class also has a priority, 0 being the highest. Interests of a lower priority are only answered while no
+ * higher priority has any that can be, except that, to keep them from being starved, a priority that has been
+ * passed over a given number of times in a row while it had Interests waiting is answered next.
+ *
+ * When the queue is full, the oldest Interest of the longest class of the lowest priority is dropped to make room.
+ * Its consumer will retransmit it, and a class that is just starting isn't shut out by the busy ones.
+ */
+typedef struct ccnxSimpleFileTransfer_FairQueue CCNxSimpleFileTransferFairQueue;
+
+/**
+ * Create a new, empty `CCNxSimpleFileTransferFairQueue`.
+ * The newly created instance must eventually be released by calling `ccnxSimpleFileTransferFairQueue_Release`.
+ *
+ * @param [in] capacity - the most Interests the queue can hold.
+ * @param [in] numPriorities - how many priorities there are, at least 1.
+ * @param [in] maxPassedOver - how many Interests of higher priorities may be answered in a row while a priority
+ *                             has Interests waiting. 0 for no limit.
+ * @param [in] quantumBytes - how many bytes of responses a class may be sent in each of its turns. It must be
+ *                            at least as large as the largest charge.
+ * @param [in] bytesPerSecond - how fast each class may be sent to. 0 for no limit.
+ * @param [in] burstBytes - how many bytes a class that has been idle may be sent at once, above its rate.
+ * @return A new instance.
+ */
+CCNxSimpleFileTransferFairQueue *ccnxSimpleFileTransferFairQueue_Create(size_t capacity, unsigned int numPriorities,
+                                                                        size_t maxPassedOver, size_t quantumBytes,
+                                                                        uint64_t bytesPerSecond, size_t burstBytes);
+
+/**
+ * Increase the number of references to a `CCNxSimpleFileTransferFairQueue` instance.
+ *
+ * @param [in] instance A pointer to the original `CCNxSimpleFileTransferFairQueue`.
+ * @return The value of the input parameter @p instance.
+ *
+ * @see ccnxSimpleFileTransferFairQueue_Release
+ */
+CCNxSimpleFileTransferFairQueue *ccnxSimpleFileTransferFairQueue_Acquire(const CCNxSimpleFileTransferFairQueue *instance);
+
+/**
+ * Release a previously acquired reference to the specified instance,
+ * decrementing the reference count for the instance.
+ *
+ * The Interests still queued are released.
+ *
+ * @param [in,out] queuePtr A pointer to a pointer to the instance to release.
+ *
+ * @see ccnxSimpleFileTransferFairQueue_Acquire
+ */
+void ccnxSimpleFileTransferFairQueue_Release(CCNxSimpleFileTransferFairQueue **queuePtr);
+
+/**
+ * Queue an Interest at the back of its class. If the queue is full, an Interest is dropped first.
+ *
+ * @param [in] queue - the queue.
+ * @param [in] className - the class of the Interest. It is copied.
+ * @param [in] priority - the priority of the class, which must be the same for all of its Interests.
+ * @param [in] interest - the Interest, which is acquired.
+ * @param [in] nowMicros - the current time, in microseconds from any fixed point.
+ * @return true if an Interest was dropped to make room, false otherwise.
+ */
+bool ccnxSimpleFileTransferFairQueue_Enqueue(CCNxSimpleFileTransferFairQueue *queue, const char *className,
+                                             unsigned int priority, const CCNxInterest *interest, uint64_t nowMicros);
+
+/**
+ * Take the next Interest to answer, from the highest priority that has one, unless a lower priority has been passed
+ * over too often, and within it from the class whose turn it is. A class whose token bucket is empty is passed
+ * over until it has refilled.
+ * The returned CCNxInterest must eventually be released by calling ccnxInterest_Release().
+ *
+ * @param [in] queue - the queue.
+ * @param [in] nowMicros - the current time, which must not be earlier than in previous calls.
+ * @param [out] classNumber - set to the class the Interest was taken from, to be passed to
+ *                            `ccnxSimpleFileTransferFairQueue_Charge`.
+ * @param [out] waitMicros - if not NULL, set to how long the Interest was queued.
+ * @return The Interest, or NULL if the queue is empty or every class with Interests queued is over its rate.
+ */
+CCNxInterest *ccnxSimpleFileTransferFairQueue_Dequeue(CCNxSimpleFileTransferFairQueue *queue, uint64_t nowMicros,
+                                                      size_t *classNumber, uint64_t *waitMicros);
+
+/**
+ * Charge a class for the response to the Interest last taken from it. This must be done before anything else
+ * is queued.
+ *
+ * @param [in] queue - the queue.
+ * @param [in] classNumber - as set by `ccnxSimpleFileTransferFairQueue_Dequeue`.
+ * @param [in] numBytes - the size of the response.
+ */
+void ccnxSimpleFileTransferFairQueue_Charge(CCNxSimpleFileTransferFairQueue *queue, size_t classNumber, size_t numBytes);
+
+/**
+ * Return the number of Interests in the queue.
+ */
+size_t ccnxSimpleFileTransferFairQueue_GetSize(const CCNxSimpleFileTransferFairQueue *queue);
+
+/**
+ * Return the most Interests the queue can hold.
+ */
+size_t ccnxSimpleFileTransferFairQueue_GetCapacity(const CCNxSimpleFileTransferFairQueue *queue);
+
+/**
+ * Return the priority of a class, given its number as set by `ccnxSimpleFileTransferFairQueue_Dequeue`.
+ */
+unsigned int ccnxSimpleFileTransferFairQueue_GetClassPriority(const CCNxSimpleFileTransferFairQueue *queue, size_t classNumber);
+
+/**
+ * Return the number of Interests queued in the named class.
+ */
+size_t ccnxSimpleFileTransferFairQueue_GetClassSize(const CCNxSimpleFileTransferFairQueue *queue, const char *className);
+#endif // ccnxSimpleFileTransfer_FairQueue_h
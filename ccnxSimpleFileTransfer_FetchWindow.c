@@ -0,0 +1,335 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <inttypes.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Object.h>
+
+#include "ccnxSimpleFileTransfer_FetchWindow.h"
+#include "ccnxSimpleFileTransfer_PendingInterestTable.h"
+
+/**
+ * The bounds of the retransmission timeout. RFC 6298 recommends a minimum of a second, for the Internet; a
+ * fetch usually goes no further than a nearby forwarder or cache, so this is much lower.
+ */
+static const uint64_t _minRtoMicros = 10 * 1000;
+static const uint64_t _maxRtoMicros = 60 * 1000 * 1000;
+
+/**
+ * The timeouts are kept to the nearest millisecond.
+ */
+static const uint64_t _timerTickMicros = 1000;
+
+/**
+ * The timeout of a chunk asked for more than once doubles each time, but stops doubling after this many.
+ */
+static const unsigned int _maxBackoffShift = 16;
+
+struct ccnxSimpleFileTransfer_FetchWindow {
+    size_t windowSize;
+    size_t maxSpan;
+    CCNxSimpleFileTransferPendingInterestTable *pending;  // The chunks asked for that haven't arrived.
+
+    unsigned int maxTransmissions;
+    uint64_t numChunks;
+    bool isNumChunksKnown;
+    bool hasFailed;
+
+    uint64_t firstNotDone;              // Every chunk before this has arrived.
+    uint64_t nextToSend;                // The first chunk not yet asked for.
+    uint64_t numRetransmissions;
+
+    bool hasRttSample;
+    uint64_t smoothedRttMicros;
+    uint64_t rttVariationMicros;
+    uint64_t rtoMicros;
+};
+
+static void
+_fetchWindow_Finalize(CCNxSimpleFileTransferFetchWindow **windowPtr)
+{
+    CCNxSimpleFileTransferFetchWindow *window = *windowPtr;
+
+    ccnxSimpleFileTransferPendingInterestTable_Release(&window->pending);
+}
+
+parcObject_ExtendPARCObject(CCNxSimpleFileTransferFetchWindow, _fetchWindow_Finalize, NULL, NULL, NULL, NULL, NULL, NULL);
+
+parcObject_ImplementAcquire(ccnxSimpleFileTransferFetchWindow, CCNxSimpleFileTransferFetchWindow);
+
+parcObject_ImplementRelease(ccnxSimpleFileTransferFetchWindow, CCNxSimpleFileTransferFetchWindow);
+
+static uint64_t
+_clampRto(uint64_t rtoMicros)
+{
+    if (rtoMicros < _minRtoMicros) {
+        return _minRtoMicros;
+    }
+    if (rtoMicros > _maxRtoMicros) {
+        return _maxRtoMicros;
+    }
+    return rtoMicros;
+}
+
+CCNxSimpleFileTransferFetchWindow *
+ccnxSimpleFileTransferFetchWindow_Create(size_t windowSize, size_t maxSpan, uint64_t initialRtoMicros,
+                                         unsigned int maxTransmissions, uint64_t nowMicros)
+{
+    assertTrue(windowSize > 0, "The window size must be greater than zero");
+    assertTrue(maxSpan >= windowSize, "The span must be at least the window size");
+    assertTrue(maxTransmissions > 0, "A chunk must be asked for at least once");
+
+    CCNxSimpleFileTransferFetchWindow *result = parcObject_CreateAndClearInstance(CCNxSimpleFileTransferFetchWindow);
+
+    result->windowSize = windowSize;
+    result->maxSpan = maxSpan;
+    result->pending = ccnxSimpleFileTransferPendingInterestTable_Create(windowSize, _timerTickMicros, nowMicros);
+
+    result->maxTransmissions = maxTransmissions;
+    result->numChunks = 1;
+    result->rtoMicros = _clampRto(initialRtoMicros);
+
+    return result;
+}
+
+void
+ccnxSimpleFileTransferFetchWindow_SetNumChunks(CCNxSimpleFileTransferFetchWindow *window, uint64_t numChunks)
+{
+    assertTrue(numChunks >= window->nextToSend, "Chunks up to %" PRIu64 " have already been asked for, but the file has %" PRIu64,
+               window->nextToSend, numChunks);
+
+    window->numChunks = numChunks;
+    window->isNumChunksKnown = true;
+}
+
+bool
+ccnxSimpleFileTransferFetchWindow_IsNumChunksKnown(const CCNxSimpleFileTransferFetchWindow *window)
+{
+    return window->isNumChunksKnown;
+}
+
+/**
+ * Note that an Interest for the chunk is being sent now, and start its timer.
+ */
+static void
+_send(CCNxSimpleFileTransferFetchWindow *window, CCNxSimpleFileTransferPendingInterest *chunk, uint64_t nowMicros)
+{
+    unsigned int backoffShift = chunk->numTransmissions;
+    if (backoffShift > _maxBackoffShift) {
+        backoffShift = _maxBackoffShift;
+    }
+    uint64_t timeoutMicros = window->rtoMicros << backoffShift;
+    if (timeoutMicros > _maxRtoMicros) {
+        timeoutMicros = _maxRtoMicros;
+    }
+
+    chunk->sentAtMicros = nowMicros;
+    chunk->numTransmissions++;
+    ccnxSimpleFileTransferPendingInterestTable_SetTimeout(window->pending, chunk, nowMicros + timeoutMicros);
+}
+
+bool
+ccnxSimpleFileTransferFetchWindow_TakeNextToSend(CCNxSimpleFileTransferFetchWindow *window, uint64_t nowMicros,
+                                                 uint64_t *chunkNumber)
+{
+    if (window->hasFailed) {
+        return false;
+    }
+
+    CCNxSimpleFileTransferPendingInterest *chunk =
+        ccnxSimpleFileTransferPendingInterestTable_TakeTimedOut(window->pending, nowMicros);
+    if (chunk != NULL) {
+        if (chunk->numTransmissions >= window->maxTransmissions) {
+            window->hasFailed = true;
+            return false;
+        }
+        _send(window, chunk, nowMicros);
+        window->numRetransmissions++;
+        *chunkNumber = chunk->chunkNumber;
+        return true;
+    }
+
+    bool isInWindow = ccnxSimpleFileTransferPendingInterestTable_GetSize(window->pending) < window->windowSize
+                      && window->nextToSend < window->firstNotDone + window->maxSpan;
+    if (window->nextToSend < window->numChunks && isInWindow) {
+        chunk = ccnxSimpleFileTransferPendingInterestTable_Insert(window->pending, window->nextToSend);
+        _send(window, chunk, nowMicros);
+        window->nextToSend++;
+        *chunkNumber = chunk->chunkNumber;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Fold a round trip time into the estimate of the retransmission timeout, as in RFC 6298, section 2.
+ */
+static void
+_updateRto(CCNxSimpleFileTransferFetchWindow *window, uint64_t rttMicros)
+{
+    if (!window->hasRttSample) {
+        window->smoothedRttMicros = rttMicros;
+        window->rttVariationMicros = rttMicros / 2;
+        window->hasRttSample = true;
+    } else {
+        uint64_t deviationMicros = (rttMicros > window->smoothedRttMicros)
+                                   ? rttMicros - window->smoothedRttMicros : window->smoothedRttMicros - rttMicros;
+        window->rttVariationMicros = (3 * window->rttVariationMicros + deviationMicros) / 4;
+        window->smoothedRttMicros = (7 * window->smoothedRttMicros + rttMicros) / 8;
+    }
+
+    uint64_t variationMicros = 4 * window->rttVariationMicros;
+    if (variationMicros < _timerTickMicros) {
+        variationMicros = _timerTickMicros;
+    }
+    window->rtoMicros = _clampRto(window->smoothedRttMicros + variationMicros);
+}
+
+/**
+ * Return the chunk, if it has been asked for and hasn't arrived yet.
+ */
+static CCNxSimpleFileTransferPendingInterest *
+_findOutstanding(CCNxSimpleFileTransferFetchWindow *window, uint64_t chunkNumber)
+{
+    return ccnxSimpleFileTransferPendingInterestTable_Get(window->pending, chunkNumber);
+}
+
+static void
+_complete(CCNxSimpleFileTransferFetchWindow *window, CCNxSimpleFileTransferPendingInterest *chunk)
+{
+    ccnxSimpleFileTransferPendingInterestTable_Remove(window->pending, chunk);
+
+    while (window->firstNotDone < window->nextToSend && _findOutstanding(window, window->firstNotDone) == NULL) {
+        window->firstNotDone++;
+    }
+}
+
+bool
+ccnxSimpleFileTransferFetchWindow_IsOutstanding(CCNxSimpleFileTransferFetchWindow *window, uint64_t chunkNumber)
+{
+    return _findOutstanding(window, chunkNumber) != NULL;
+}
+
+bool
+ccnxSimpleFileTransferFetchWindow_Receive(CCNxSimpleFileTransferFetchWindow *window, uint64_t chunkNumber,
+                                          uint64_t nowMicros)
+{
+    CCNxSimpleFileTransferPendingInterest *chunk = _findOutstanding(window, chunkNumber);
+    if (chunk == NULL) {
+        return false;
+    }
+
+    // Karn's algorithm: a chunk asked for more than once may be answering any of its Interests.
+    if (chunk->numTransmissions == 1 && nowMicros >= chunk->sentAtMicros) {
+        _updateRto(window, nowMicros - chunk->sentAtMicros);
+    }
+    _complete(window, chunk);
+    return true;
+}
+
+void
+ccnxSimpleFileTransferFetchWindow_Skip(CCNxSimpleFileTransferFetchWindow *window, uint64_t chunkNumber)
+{
+    CCNxSimpleFileTransferPendingInterest *chunk = _findOutstanding(window, chunkNumber);
+    if (chunk != NULL) {
+        _complete(window, chunk);
+    }
+}
+
+uint64_t
+ccnxSimpleFileTransferFetchWindow_GetNextTimeoutMicros(CCNxSimpleFileTransferFetchWindow *window)
+{
+    return ccnxSimpleFileTransferPendingInterestTable_GetNextTimeoutMicros(window->pending);
+}
+
+bool
+ccnxSimpleFileTransferFetchWindow_IsComplete(const CCNxSimpleFileTransferFetchWindow *window)
+{
+    return window->isNumChunksKnown && window->firstNotDone >= window->numChunks;
+}
+
+bool
+ccnxSimpleFileTransferFetchWindow_HasFailed(const CCNxSimpleFileTransferFetchWindow *window)
+{
+    return window->hasFailed;
+}
+
+size_t
+ccnxSimpleFileTransferFetchWindow_GetNumOutstanding(const CCNxSimpleFileTransferFetchWindow *window)
+{
+    return ccnxSimpleFileTransferPendingInterestTable_GetSize(window->pending);
+}
+
+uint64_t
+ccnxSimpleFileTransferFetchWindow_GetNumRetransmissions(const CCNxSimpleFileTransferFetchWindow *window)
+{
+    return window->numRetransmissions;
+}
+
+uint64_t
+ccnxSimpleFileTransferFetchWindow_GetRtoMicros(const CCNxSimpleFileTransferFetchWindow *window)
+{
+    return window->rtoMicros;
+}
+
+uint64_t
+ccnxSimpleFileTransferFetchWindow_GetSmoothedRttMicros(const CCNxSimpleFileTransferFetchWindow *window)
+{
+    return window->hasRttSample ? window->smoothedRttMicros : 0;
+}
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+#ifndef ccnxSimpleFileTransfer_FetchWindow_h
+#define ccnxSimpleFileTransfer_FetchWindow_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct ccnxSimpleFileTransfer_FetchWindow;
+
+/**
+ * A `CCNxSimpleFileTransferFetchWindow` decides which chunk of a file to ask for next, and when to ask again
+ * for one that hasn't arrived. It doesn't send or receive anything itself: the caller asks it for chunks to
+ * send Interests for, and tells it which chunks arrive.
+ *
+ * Chunks are asked for in order, keeping at most `windowSize` Interests outstanding. Later chunks go on being
+ * asked for while an earlier one is missing, but no further ahead of it than `maxSpan` chunks, e.g. so they all
+ * fit in a reorder buffer. Each Interest has its own timer. When one expires, just that chunk is asked
+ * for again, and its timeout is doubled each time it's asked for again, up to a limit.
+ *
+ * The timeout starts from the retransmission timeout (RTO) estimated from the round trip times of the chunks
+ * that arrive, as TCP does (RFC 6298): a smoothed round trip time, plus four times its variation. Chunks that
+ * were asked for more than once give no round trip time, as it isn't known which Interest they answer.
+ *
+ * Until the number of chunks in the file is known, only chunk 0 is asked for.
+ */
+typedef struct ccnxSimpleFileTransfer_FetchWindow CCNxSimpleFileTransferFetchWindow;
+
+/**
+ * Create a new `CCNxSimpleFileTransferFetchWindow` for a fetch starting now.
+ * The newly created instance must eventually be released by calling `ccnxSimpleFileTransferFetchWindow_Release`.
+ *
+ * @param [in] windowSize - the most chunks to have asked for but not received.
+ * @param [in] maxSpan - how far ahead of the first chunk not received a chunk may be asked for. At least windowSize.
+ * @param [in] initialRtoMicros - the timeout to use until a round trip time has been measured.
+ * @param [in] maxTransmissions - how many times to ask for a chunk before giving up on the fetch.
+ * @param [in] nowMicros - the current time, in microseconds from any fixed point.
+ * @return A new instance.
+ */
+CCNxSimpleFileTransferFetchWindow *ccnxSimpleFileTransferFetchWindow_Create(size_t windowSize, size_t maxSpan,
+                                                                            uint64_t initialRtoMicros,
+                                                                            unsigned int maxTransmissions,
+                                                                            uint64_t nowMicros);
+
+/**
+ * Increase the number of references to a `CCNxSimpleFileTransferFetchWindow` instance.
+ *
+ * @param [in] instance A pointer to the original `CCNxSimpleFileTransferFetchWindow`.
+ * @return The value of the input parameter @p instance.
+ *
+ * @see ccnxSimpleFileTransferFetchWindow_Release
+ */
+CCNxSimpleFileTransferFetchWindow *ccnxSimpleFileTransferFetchWindow_Acquire(const CCNxSimpleFileTransferFetchWindow *instance);
+
+/**
+ * Release a previously acquired reference to the specified instance,
+ * decrementing the reference count for the instance.
+ *
+ * @param [in,out] windowPtr A pointer to a pointer to the instance to release.
+ *
+ * @see ccnxSimpleFileTransferFetchWindow_Acquire
+ */
+void ccnxSimpleFileTransferFetchWindow_Release(CCNxSimpleFileTransferFetchWindow **windowPtr);
+
+/**
+ * Set the number of chunks in the file, once it's known (e.g. from the final chunk number of chunk 0).
+ * Chunks after chunk 0 are only asked for once this has been called, so until then it must be at least 1.
+ * A number from the network must be checked by the caller first.
+ *
+ * @param [in] window - the fetch window.
+ * @param [in] numChunks - the number of chunks in the file.
+ */
+void ccnxSimpleFileTransferFetchWindow_SetNumChunks(CCNxSimpleFileTransferFetchWindow *window, uint64_t numChunks);
+
+/**
+ * Return whether the number of chunks in the file has been set.
+ */
+bool ccnxSimpleFileTransferFetchWindow_IsNumChunksKnown(const CCNxSimpleFileTransferFetchWindow *window);
+
+/**
+ * Find the next chunk to send an Interest for now, if any. Chunks whose Interests have timed out come first,
+ * then new chunks, if the window has room. Call this until it returns false, and send an Interest for each
+ * chunk it returns.
+ *
+ * If a chunk's Interest times out after it has been sent `maxTransmissions` times, the fetch fails.
+ *
+ * @param [in] window - the fetch window.
+ * @param [in] nowMicros - the current time.
+ * @param [out] chunkNumber - the chunk to send an Interest for.
+ * @return true if there's a chunk to send an Interest for, false if there's nothing more to send now.
+ */
+bool ccnxSimpleFileTransferFetchWindow_TakeNextToSend(CCNxSimpleFileTransferFetchWindow *window, uint64_t nowMicros,
+                                                      uint64_t *chunkNumber);
+
+/**
+ * Return whether a chunk has been asked for and hasn't arrived yet. A chunk that arrives but can't be used (e.g.
+ * it is damaged) shouldn't be passed to `ccnxSimpleFileTransferFetchWindow_Receive`, so it stays outstanding and
+ * is asked for again when its Interest times out.
+ *
+ * @param [in] window - the fetch window.
+ * @param [in] chunkNumber - the chunk.
+ * @return true if the chunk is being waited for, false otherwise.
+ */
+bool ccnxSimpleFileTransferFetchWindow_IsOutstanding(CCNxSimpleFileTransferFetchWindow *window, uint64_t chunkNumber);
+
+/**
+ * Tell the window a chunk has arrived. Chunks that weren't asked for, or have already arrived, are ignored.
+ *
+ * @param [in] window - the fetch window.
+ * @param [in] chunkNumber - the chunk that arrived.
+ * @param [in] nowMicros - the current time.
+ * @return true if the chunk was being waited for, false if it should be ignored.
+ */
+bool ccnxSimpleFileTransferFetchWindow_Receive(CCNxSimpleFileTransferFetchWindow *window, uint64_t chunkNumber,
+                                               uint64_t nowMicros);
+
+/**
+ * Tell the window a chunk it has just returned from `ccnxSimpleFileTransferFetchWindow_TakeNextToSend` isn't
+ * needed after all (e.g. because there's already a copy of it), so no Interest was sent for it.
+ *
+ * @param [in] window - the fetch window.
+ * @param [in] chunkNumber - the chunk that isn't needed.
+ */
+void ccnxSimpleFileTransferFetchWindow_Skip(CCNxSimpleFileTransferFetchWindow *window, uint64_t chunkNumber);
+
+/**
+ * Return the latest time to call `ccnxSimpleFileTransferFetchWindow_TakeNextToSend` again, even if no chunk
+ * arrives before then, so a timed out Interest is sent again in time.
+ *
+ * @param [in] window - the fetch window.
+ * @return The time, which may already have passed, or UINT64_MAX if no Interest is waiting for its chunk.
+ */
+uint64_t ccnxSimpleFileTransferFetchWindow_GetNextTimeoutMicros(CCNxSimpleFileTransferFetchWindow *window);
+
+/**
+ * Return whether every chunk in the file has arrived (or been skipped).
+ */
+bool ccnxSimpleFileTransferFetchWindow_IsComplete(const CCNxSimpleFileTransferFetchWindow *window);
+
+/**
+ * Return whether the fetch has failed, because a chunk didn't arrive after being asked for `maxTransmissions`
+ * times.
+ */
+bool ccnxSimpleFileTransferFetchWindow_HasFailed(const CCNxSimpleFileTransferFetchWindow *window);
+
+/**
+ * Return the number of chunks asked for that haven't arrived.
+ */
+size_t ccnxSimpleFileTransferFetchWindow_GetNumOutstanding(const CCNxSimpleFileTransferFetchWindow *window);
+
+/**
+ * Return the number of Interests sent again because an earlier one timed out.
+ */
+uint64_t ccnxSimpleFileTransferFetchWindow_GetNumRetransmissions(const CCNxSimpleFileTransferFetchWindow *window);
+
+/**
+ * Return the current retransmission timeout, before any backoff.
+ */
+uint64_t ccnxSimpleFileTransferFetchWindow_GetRtoMicros(const CCNxSimpleFileTransferFetchWindow *window);
+
+/**
+ * Return the smoothed round trip time, or 0 if none has been measured yet.
+ */
+uint64_t ccnxSimpleFileTransferFetchWindow_GetSmoothedRttMicros(const CCNxSimpleFileTransferFetchWindow *window);
+#endif // ccnxSimpleFileTransfer_FetchWindow_h
@@ -56,9 +56,16 @@
  * @author Alan Walendowski, Palo Alto Research Center (Xerox PARC)
  * @copyright (c) 2014-2015, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
  */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // for SEEK_DATA
+#endif
+
 #include <stdio.h>
+#include <errno.h>
 #include <dirent.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
 
 #include <LongBow/runtime.h>
 #include <parc/algol/parc_Memory.h>
@@ -127,6 +134,172 @@ ccnxSimpleFileTransferFileIO_GetFileSize(const char *filePath)
     return fileSize;
 }
 
+/**
+ * Hash the fields of a file's status that change when its contents do. 64-bit FNV-1a, which is plenty to
+ * tell one version of a file from the next.
+ */
+static uint64_t
+_getVersionFromStatus(const struct stat *status)
+{
+#ifdef __APPLE__
+    int64_t modifiedNanos = (int64_t) status->st_mtimespec.tv_nsec;
+#else
+    int64_t modifiedNanos = (int64_t) status->st_mtim.tv_nsec;
+#endif
+    uint64_t fields[] = {
+        (uint64_t) status->st_dev, (uint64_t) status->st_ino, (uint64_t) status->st_size,
+        (uint64_t) status->st_mtime, (uint64_t) modifiedNanos
+    };
+
+    uint64_t result = 14695981039346656037ULL; // The 64-bit FNV-1a offset basis.
+    const uint8_t *bytes = (const uint8_t *) fields;
+    for (size_t i = 0; i < sizeof(fields); i++) {
+        result ^= bytes[i];
+        result *= 1099511628211ULL;            // The 64-bit FNV prime.
+    }
+
+    return (result == 0) ? 1 : result; // 0 means 'no version'.
+}
+
+/**
+ * Open a file for reading and get its status. Returns the open descriptor, or -1 if the file couldn't be
+ * opened or isn't a regular file.
+ */
+static int
+_openRegularFile(const char *fileName, struct stat *status)
+{
+    int result = open(fileName, O_RDONLY);
+
+    if (result >= 0 && (fstat(result, status) != 0 || !S_ISREG(status->st_mode))) {
+        close(result);
+        result = -1;
+    }
+
+    return result;
+}
+
+bool
+ccnxSimpleFileTransferFileIO_GetFileVersion(const char *fileName, size_t *fileSize, uint64_t *version)
+{
+    struct stat status;
+    int fd = _openRegularFile(fileName, &status);
+
+    if (fd >= 0) {
+        *fileSize = (size_t) status.st_size;
+        *version = _getVersionFromStatus(&status);
+        close(fd);
+    }
+
+    return fd >= 0;
+}
+
+int
+ccnxSimpleFileTransferFileIO_OpenVersionedFile(const char *fileName, uint64_t version, size_t *fileSize)
+{
+    struct stat status;
+    int result = _openRegularFile(fileName, &status);
+
+    if (result >= 0) {
+        if (_getVersionFromStatus(&status) == version) {
+            *fileSize = (size_t) status.st_size;
+        } else {
+            close(result);
+            result = -1;
+        }
+    }
+
+    return result;
+}
+
+bool
+ccnxSimpleFileTransferFileIO_GetOpenFileVersion(int fileDescriptor, size_t *fileSize, uint64_t *version)
+{
+    struct stat status;
+    bool result = fstat(fileDescriptor, &status) == 0;
+
+    if (result) {
+        *fileSize = (size_t) status.st_size;
+        *version = _getVersionFromStatus(&status);
+    }
+
+    return result;
+}
+
+bool
+ccnxSimpleFileTransferFileIO_ReadFileChunkIntoBuffer(int fileDescriptor, PARCBuffer *buffer, size_t chunkSize,
+                                                     uint64_t chunkNumber)
+{
+    assertTrue(parcBuffer_Capacity(buffer) >= chunkSize, "The buffer is smaller than a chunk");
+
+    off_t offset = (off_t) (chunkSize * chunkNumber);
+    size_t totalNumberOfBytesRead = 0;
+    ssize_t numberOfBytesRead = 0;
+
+    parcBuffer_Clear(buffer);
+
+    // Read until we get the required number of bytes, or reach the end of the file.
+    while (totalNumberOfBytesRead < chunkSize
+           && (numberOfBytesRead = pread(fileDescriptor, parcBuffer_Overlay(buffer, 0), chunkSize - totalNumberOfBytesRead,
+                                         offset + totalNumberOfBytesRead)) > 0) {
+        totalNumberOfBytesRead += numberOfBytesRead;
+        parcBuffer_SetPosition(buffer, totalNumberOfBytesRead);
+    }
+
+    if (numberOfBytesRead < 0) {
+        return false;
+    }
+
+    parcBuffer_SetLimit(buffer, totalNumberOfBytesRead);
+    parcBuffer_Flip(buffer);
+    return true;
+}
+
+bool
+ccnxSimpleFileTransferFileIO_IsHole(int fileDescriptor, uint64_t offset, size_t length)
+{
+    bool result = false;
+
+#ifdef SEEK_DATA
+    // Where the next data is, at or after the offset. A file system that doesn't track holes says it's right there.
+    off_t dataOffset = lseek(fileDescriptor, (off_t) offset, SEEK_DATA);
+    if (dataOffset >= 0) {
+        result = (uint64_t) dataOffset >= offset + length;
+    } else {
+        result = (errno == ENXIO); // There is no data after the offset: the rest of the file is a hole.
+    }
+#endif
+
+    return result;
+}
+
+PARCBuffer *
+ccnxSimpleFileTransferFileIO_ReadFileChunk(int fileDescriptor, size_t chunkSize, uint64_t chunkNumber)
+{
+    PARCBuffer *result = parcBuffer_Allocate(chunkSize);
+
+    if (!ccnxSimpleFileTransferFileIO_ReadFileChunkIntoBuffer(fileDescriptor, result, chunkSize, chunkNumber)) {
+        parcBuffer_Release(&result);
+    }
+
+    return result;
+}
+
+PARCBuffer *
+ccnxSimpleFileTransferFileIO_GetVersionedFileChunk(const char *fileName, size_t chunkSize, uint64_t chunkNumber,
+                                                   uint64_t version, size_t *fileSize)
+{
+    PARCBuffer *result = NULL;
+
+    int fd = ccnxSimpleFileTransferFileIO_OpenVersionedFile(fileName, version, fileSize);
+
+    if (fd >= 0) {
+        result = ccnxSimpleFileTransferFileIO_ReadFileChunk(fd, chunkSize, chunkNumber);
+        close(fd);
+    }
+
+    return result;
+}
+
 PARCBuffer *
 ccnxSimpleFileTransferFileIO_CreateDirectoryListing(const char *directoryName)
 {
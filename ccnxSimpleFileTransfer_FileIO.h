@@ -95,6 +95,99 @@ bool ccnxSimpleFileTransferFileIO_IsFileAvailable(const char *fileName);
  */
 size_t ccnxSimpleFileTransferFileIO_GetFileSize(const char *fileName);
 
+/**
+ * Get the size and the version of a readable, regular file with a single open() and fstat().
+ *
+ * The version identifies the file's current contents. It is a hash of the file's device, inode, size and
+ * modification time, so it changes whenever the file is rewritten or replaced, and is never 0.
+ *
+ * @param [in] fileName A pointer to a string containing the name of the file.
+ * @param [out] fileSize Set to the size of the file, in bytes.
+ * @param [out] version Set to the version of the file.
+ *
+ * @return true If the file exists and is readable.
+ * @return false If the file doesn't exist, or is not readable, or is not a regular file.
+ */
+bool ccnxSimpleFileTransferFileIO_GetFileVersion(const char *fileName, size_t *fileSize, uint64_t *version);
+
+/**
+ * Open a readable, regular file for reading, but only if it is at the specified version.
+ *
+ * @param [in] fileName A pointer to a string containing the name of the file.
+ * @param [in] version The version, from ccnxSimpleFileTransferFileIO_GetFileVersion(), the file must be at.
+ * @param [out] fileSize Set to the size of the file, in bytes.
+ *
+ * @return A file descriptor open for reading, which the caller must close(), or -1 if the file couldn't be
+ *         opened or has changed since that version.
+ */
+int ccnxSimpleFileTransferFileIO_OpenVersionedFile(const char *fileName, uint64_t version, size_t *fileSize);
+
+/**
+ * Get the current version and size of a file that is already open.
+ *
+ * @param [in] fileDescriptor A file descriptor open for reading.
+ * @param [out] fileSize Set to the size of the file, in bytes.
+ * @param [out] version Set to the version of the file, as from ccnxSimpleFileTransferFileIO_GetFileVersion().
+ *
+ * @return true If the file's status could be read, false otherwise.
+ */
+bool ccnxSimpleFileTransferFileIO_GetOpenFileVersion(int fileDescriptor, size_t *fileSize, uint64_t *version);
+
+/**
+ * Read a chunk of a file that is already open, with pread(), so the file's offset isn't used.
+ *
+ * @param [in] fileDescriptor A file descriptor open for reading.
+ * @param [in] chunkSize The maximum number of bytes to be returned in each chunk.
+ * @param [in] chunkNumber The 0-based number of chunk to return from the file.
+ *
+ * @return A newly created PARCBuffer containing the contents of the specified chunk, which is empty past the end
+ *         of the file, or NULL if the file couldn't be read.
+ */
+PARCBuffer *ccnxSimpleFileTransferFileIO_ReadFileChunk(int fileDescriptor, size_t chunkSize, uint64_t chunkNumber);
+
+/**
+ * Read a chunk of a file that is already open into a buffer we already have, such as one from a
+ * CCNxSimpleFileTransferBufferPool, as ccnxSimpleFileTransferFileIO_ReadFileChunk() does.
+ *
+ * @param [in] fileDescriptor A file descriptor open for reading.
+ * @param [in,out] buffer The buffer to read into, with a capacity of at least chunkSize. On success, it holds
+ *                        the chunk, ready to be read, and is empty past the end of the file.
+ * @param [in] chunkSize The maximum number of bytes in each chunk.
+ * @param [in] chunkNumber The 0-based number of chunk to read from the file.
+ *
+ * @return true If the chunk was read, false if the file couldn't be read.
+ */
+bool ccnxSimpleFileTransferFileIO_ReadFileChunkIntoBuffer(int fileDescriptor, PARCBuffer *buffer, size_t chunkSize,
+                                                          uint64_t chunkNumber);
+
+/**
+ * Whether a range of a file that is already open lies entirely in a hole, so reads as zeros without being read,
+ * as in a sparse disk image. Uses lseek() with SEEK_DATA, which moves the file's offset.
+ *
+ * @param [in] fileDescriptor A file descriptor open for reading.
+ * @param [in] offset The offset of the range, which must be within the file.
+ * @param [in] length The length of the range, which must not go past the end of the file.
+ *
+ * @return true If the range is a hole, false if it has data, or holes can't be found on this system.
+ */
+bool ccnxSimpleFileTransferFileIO_IsHole(int fileDescriptor, uint64_t offset, size_t length);
+
+/**
+ * Same as ccnxSimpleFileTransferFileIO_GetFileChunk(), but only if the file is still at the specified version.
+ * The file is opened once, checked with fstat() and read with pread(), so no separate stat of the file is needed.
+ *
+ * @param [in] fileName A pointer to a string containing the name of the file to read from.
+ * @param [in] chunkSize The maximum number of bytes to be returned in each chunk.
+ * @param [in] chunkNumber The 0-based number of chunk to return from the file.
+ * @param [in] version The version, from ccnxSimpleFileTransferFileIO_GetFileVersion(), the file must be at.
+ * @param [out] fileSize Set to the size of the file, in bytes.
+ *
+ * @return A newly created PARCBuffer containing the contents of the specified chunk, or NULL if the file
+ *         couldn't be read or has changed since that version.
+ */
+PARCBuffer *ccnxSimpleFileTransferFileIO_GetVersionedFileChunk(const char *fileName, size_t chunkSize, uint64_t chunkNumber,
+                                                               uint64_t version, size_t *fileSize);
+
 
 /**
  * Return a PARCBuffer containing a string representing the list of files and their sizes in the directory
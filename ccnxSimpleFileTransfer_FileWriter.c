@@ -0,0 +1,462 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // for O_DIRECT
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "ccnxSimpleFileTransfer_FileWriter.h"
+
+const size_t ccnxSimpleFileTransferFileWriter_DefaultBufferSize = 1024 * 1024;
+
+const size_t ccnxSimpleFileTransferFileWriter_DefaultNumberOfBuffers = 8;
+
+typedef struct fileWriterBuffer {
+    uint8_t *bytes;
+    size_t length;
+    uint64_t holeLength;    // The zeros after the bytes, left as a hole in the file rather than written.
+} _FileWriterBuffer;
+
+/**
+ * Written in place of zeros when the output can't have holes.
+ */
+static const uint8_t _zeros[4096];
+
+struct ccnxSimpleFileTransfer_FileWriter {
+    int fileDescriptor;
+    bool isDirectIO;
+    bool isClosed;
+    bool canLeaveHoles;     // Whether the output is a regular file, which we can seek past zeros in.
+
+    size_t bufferSize;
+    size_t numBuffers;
+    _FileWriterBuffer *buffers;
+
+    size_t fillSlot;    // The buffer the caller is copying into. Only touched by the caller.
+    size_t writeSlot;   // The next buffer the background thread will write. Only touched by the thread.
+    size_t numPending;  // The number of buffers handed to the background thread but not yet written.
+    bool isStopping;
+
+    int writeError;     // The errno of the first failed write, or 0.
+    uint64_t bytesWritten;
+    uint64_t stallCount;
+
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t bufferReady;
+    pthread_cond_t bufferFree;
+};
+
+/**
+ * Write all of the specified bytes to the file descriptor, retrying on short writes and interrupts.
+ *
+ * @return 0 on success, otherwise the errno of the failed write.
+ */
+static int
+_writeFully(int fileDescriptor, const uint8_t *bytes, size_t length)
+{
+    while (length > 0) {
+        ssize_t numBytesWritten = write(fileDescriptor, bytes, length);
+        if (numBytesWritten < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        bytes += numBytesWritten;
+        length -= (size_t) numBytesWritten;
+    }
+    return 0;
+}
+
+/**
+ * Write a buffer's bytes, and then seek past its hole.
+ *
+ * @return 0 on success, otherwise the errno of the failed write or seek.
+ */
+static int
+_writeBuffer(int fileDescriptor, const _FileWriterBuffer *buffer)
+{
+    int result = _writeFully(fileDescriptor, buffer->bytes, buffer->length);
+    if (result == 0 && buffer->holeLength > 0 && lseek(fileDescriptor, (off_t) buffer->holeLength, SEEK_CUR) < 0) {
+        result = errno;
+    }
+    return result;
+}
+
+/**
+ * The body of the background thread. Write full buffers, in order, until told to stop.
+ */
+static void *
+_fileWriter_Run(void *arg)
+{
+    CCNxSimpleFileTransferFileWriter *writer = (CCNxSimpleFileTransferFileWriter *) arg;
+
+    pthread_mutex_lock(&writer->mutex);
+    while (true) {
+        while (writer->numPending == 0 && !writer->isStopping) {
+            pthread_cond_wait(&writer->bufferReady, &writer->mutex);
+        }
+        if (writer->numPending == 0) {
+            break; // Stopping, and there's nothing left to write.
+        }
+
+        _FileWriterBuffer *buffer = &writer->buffers[writer->writeSlot];
+        bool isFailed = (writer->writeError != 0);
+        pthread_mutex_unlock(&writer->mutex);
+
+        // Don't hold the lock while we're blocked on the disk. The caller can keep filling other buffers.
+        int error = isFailed ? 0 : _writeBuffer(writer->fileDescriptor, buffer);
+
+        pthread_mutex_lock(&writer->mutex);
+        if (error != 0) {
+            writer->writeError = error;
+        } else if (!isFailed) {
+            writer->bytesWritten += buffer->length + buffer->holeLength;
+        }
+        buffer->length = 0;
+        buffer->holeLength = 0;
+        writer->writeSlot = (writer->writeSlot + 1) % writer->numBuffers;
+        writer->numPending--;
+        pthread_cond_signal(&writer->bufferFree);
+    }
+    pthread_mutex_unlock(&writer->mutex);
+
+    return NULL;
+}
+
+/**
+ * Hand the buffer currently being filled to the background thread and move on to the next one,
+ * waiting for it to be written first if the background thread has fallen behind.
+ */
+static void
+_fileWriter_HandOff(CCNxSimpleFileTransferFileWriter *writer)
+{
+    pthread_mutex_lock(&writer->mutex);
+
+    writer->numPending++;
+    pthread_cond_signal(&writer->bufferReady);
+
+    writer->fillSlot = (writer->fillSlot + 1) % writer->numBuffers;
+
+    if (writer->numPending == writer->numBuffers) {
+        // Every buffer, including the one we want to fill next, is waiting on the disk. Apply backpressure.
+        writer->stallCount++;
+        while (writer->numPending == writer->numBuffers) {
+            pthread_cond_wait(&writer->bufferFree, &writer->mutex);
+        }
+    }
+
+    pthread_mutex_unlock(&writer->mutex);
+}
+
+static void
+_fileWriter_Finalize(CCNxSimpleFileTransferFileWriter **writerPtr)
+{
+    CCNxSimpleFileTransferFileWriter *writer = *writerPtr;
+
+    if (!writer->isClosed) {
+        ccnxSimpleFileTransferFileWriter_Close(writer);
+    }
+
+    for (size_t i = 0; i < writer->numBuffers; i++) {
+        free(writer->buffers[i].bytes); // Allocated with posix_memalign()
+    }
+    parcMemory_Deallocate(&writer->buffers);
+
+    pthread_cond_destroy(&writer->bufferFree);
+    pthread_cond_destroy(&writer->bufferReady);
+    pthread_mutex_destroy(&writer->mutex);
+}
+
+parcObject_ExtendPARCObject(CCNxSimpleFileTransferFileWriter,
+                            _fileWriter_Finalize,
+                            NULL, NULL, NULL, NULL, NULL, NULL);
+
+parcObject_ImplementAcquire(ccnxSimpleFileTransferFileWriter, CCNxSimpleFileTransferFileWriter);
+
+parcObject_ImplementRelease(ccnxSimpleFileTransferFileWriter, CCNxSimpleFileTransferFileWriter);
+
+/**
+ * Open the output file, with O_DIRECT if requested and supported. Not every file system supports
+ * O_DIRECT (e.g. tmpfs), so fall back to a normal open if it is refused.
+ */
+static int
+_openOutputFile(const char *fileName, bool *useDirectIO)
+{
+    int flags = O_CREAT | O_WRONLY | O_TRUNC;
+    int result = -1;
+
+#ifdef O_DIRECT
+    if (*useDirectIO) {
+        result = open(fileName, flags | O_DIRECT, 0777);
+    }
+#endif
+
+    if (result < 0) {
+        *useDirectIO = false;
+        result = open(fileName, flags, 0777);
+    }
+
+    return result;
+}
+
+CCNxSimpleFileTransferFileWriter *
+ccnxSimpleFileTransferFileWriter_Create(const char *fileName, size_t bufferSize, size_t numBuffers, bool useDirectIO)
+{
+    assertNotNull(fileName, "fileName must not be NULL");
+
+    int fileDescriptor = _openOutputFile(fileName, &useDirectIO);
+    if (fileDescriptor < 0) {
+        return NULL;
+    }
+
+    CCNxSimpleFileTransferFileWriter *result =
+        ccnxSimpleFileTransferFileWriter_CreateWithDescriptor(fileDescriptor, bufferSize, numBuffers);
+    result->isDirectIO = useDirectIO;
+
+    return result;
+}
+
+CCNxSimpleFileTransferFileWriter *
+ccnxSimpleFileTransferFileWriter_CreateWithDescriptor(int fileDescriptor, size_t bufferSize, size_t numBuffers)
+{
+    assertTrue(fileDescriptor >= 0, "Invalid file descriptor %d", fileDescriptor);
+    assertTrue(numBuffers >= 2, "A FileWriter needs at least 2 buffers, got %zu", numBuffers);
+
+    CCNxSimpleFileTransferFileWriter *result = parcObject_CreateAndClearInstance(CCNxSimpleFileTransferFileWriter);
+
+    // O_DIRECT requires the memory, the file offset and the length of each write to be aligned.
+    // Page alignment satisfies the block size of any file system we're likely to see.
+    size_t alignment = (size_t) sysconf(_SC_PAGESIZE);
+    bufferSize = ((bufferSize + alignment - 1) / alignment) * alignment;
+
+    struct stat statbuf;
+    result->fileDescriptor = fileDescriptor;
+    result->isDirectIO = false;
+    result->canLeaveHoles = (fstat(fileDescriptor, &statbuf) == 0 && S_ISREG(statbuf.st_mode));
+    result->bufferSize = bufferSize;
+    result->numBuffers = numBuffers;
+    result->buffers = parcMemory_AllocateAndClear(numBuffers * sizeof(_FileWriterBuffer));
+    assertNotNull(result->buffers, "parcMemory_AllocateAndClear(%zu) returned NULL", numBuffers * sizeof(_FileWriterBuffer));
+
+    for (size_t i = 0; i < numBuffers; i++) {
+        void *bytes = NULL;
+        int error = posix_memalign(&bytes, alignment, bufferSize);
+        assertTrue(error == 0, "posix_memalign(%zu, %zu) failed: %s", alignment, bufferSize, strerror(error));
+        result->buffers[i].bytes = bytes;
+    }
+
+    pthread_mutex_init(&result->mutex, NULL);
+    pthread_cond_init(&result->bufferReady, NULL);
+    pthread_cond_init(&result->bufferFree, NULL);
+
+    int error = pthread_create(&result->thread, NULL, _fileWriter_Run, result);
+    assertTrue(error == 0, "pthread_create() failed: %s", strerror(error));
+
+    return result;
+}
+
+bool
+ccnxSimpleFileTransferFileWriter_Write(CCNxSimpleFileTransferFileWriter *writer, const void *bytes, size_t length)
+{
+    if (writer->isClosed) {
+        return false;
+    }
+
+    const uint8_t *source = bytes;
+    while (length > 0) {
+        _FileWriterBuffer *buffer = &writer->buffers[writer->fillSlot];
+        if (buffer->holeLength > 0) {
+            // The bytes go after the hole, so into the next buffer.
+            _fileWriter_HandOff(writer);
+            continue;
+        }
+
+        size_t space = writer->bufferSize - buffer->length;
+        size_t numBytesToCopy = (length < space) ? length : space;
+
+        memcpy(buffer->bytes + buffer->length, source, numBytesToCopy);
+        buffer->length += numBytesToCopy;
+        source += numBytesToCopy;
+        length -= numBytesToCopy;
+
+        if (buffer->length == writer->bufferSize) {
+            _fileWriter_HandOff(writer);
+        }
+    }
+
+    pthread_mutex_lock(&writer->mutex);
+    bool result = (writer->writeError == 0);
+    pthread_mutex_unlock(&writer->mutex);
+
+    return result;
+}
+
+bool
+ccnxSimpleFileTransferFileWriter_WriteZeros(CCNxSimpleFileTransferFileWriter *writer, size_t length)
+{
+    if (writer->isClosed) {
+        return false;
+    }
+
+    // A hole would leave the file offset unaligned for O_DIRECT.
+    if (!writer->canLeaveHoles || writer->isDirectIO) {
+        bool result = true;
+        while (length > 0 && result) {
+            size_t numBytesToWrite = (length < sizeof(_zeros)) ? length : sizeof(_zeros);
+            result = ccnxSimpleFileTransferFileWriter_Write(writer, _zeros, numBytesToWrite);
+            length -= numBytesToWrite;
+        }
+        return result;
+    }
+
+    // Runs of zeros next to each other make one hole, after the bytes already in the buffer.
+    writer->buffers[writer->fillSlot].holeLength += length;
+
+    pthread_mutex_lock(&writer->mutex);
+    bool result = (writer->writeError == 0);
+    pthread_mutex_unlock(&writer->mutex);
+
+    return result;
+}
+
+bool
+ccnxSimpleFileTransferFileWriter_Close(CCNxSimpleFileTransferFileWriter *writer)
+{
+    if (writer->isClosed) {
+        return writer->writeError == 0;
+    }
+
+    pthread_mutex_lock(&writer->mutex);
+    writer->isStopping = true;
+    pthread_cond_signal(&writer->bufferReady);
+    pthread_mutex_unlock(&writer->mutex);
+
+    pthread_join(writer->thread, NULL);
+
+    // The background thread only writes full buffers. Whatever is left in the buffer being filled is
+    // the tail of the file, and is written here.
+    _FileWriterBuffer *tail = &writer->buffers[writer->fillSlot];
+    if ((tail->length > 0 || tail->holeLength > 0) && writer->writeError == 0) {
+#ifdef O_DIRECT
+        if (writer->isDirectIO && (tail->length % writer->bufferSize) != 0) {
+            // A partial buffer can't be written with O_DIRECT, so turn it off for the final write.
+            int flags = fcntl(writer->fileDescriptor, F_GETFL);
+            fcntl(writer->fileDescriptor, F_SETFL, flags & ~O_DIRECT);
+        }
+#endif
+        writer->writeError = _writeBuffer(writer->fileDescriptor, tail);
+        if (writer->writeError == 0 && tail->holeLength > 0) {
+            // Seeking past the end doesn't make the file longer, so the hole at the end needs it extended.
+            off_t end = lseek(writer->fileDescriptor, 0, SEEK_CUR);
+            if (end < 0 || ftruncate(writer->fileDescriptor, end) != 0) {
+                writer->writeError = errno;
+            }
+        }
+        if (writer->writeError == 0) {
+            writer->bytesWritten += tail->length + tail->holeLength;
+        }
+        tail->length = 0;
+        tail->holeLength = 0;
+    }
+
+    if (close(writer->fileDescriptor) != 0 && writer->writeError == 0) {
+        writer->writeError = errno;
+    }
+    writer->fileDescriptor = -1;
+    writer->isClosed = true;
+
+    return writer->writeError == 0;
+}
+
+uint64_t
+ccnxSimpleFileTransferFileWriter_GetBytesWritten(const CCNxSimpleFileTransferFileWriter *writer)
+{
+    CCNxSimpleFileTransferFileWriter *mutableWriter = (CCNxSimpleFileTransferFileWriter *) writer;
+
+    pthread_mutex_lock(&mutableWriter->mutex);
+    uint64_t result = writer->bytesWritten;
+    pthread_mutex_unlock(&mutableWriter->mutex);
+
+    return result;
+}
+
+uint64_t
+ccnxSimpleFileTransferFileWriter_GetStallCount(const CCNxSimpleFileTransferFileWriter *writer)
+{
+    CCNxSimpleFileTransferFileWriter *mutableWriter = (CCNxSimpleFileTransferFileWriter *) writer;
+
+    pthread_mutex_lock(&mutableWriter->mutex);
+    uint64_t result = writer->stallCount;
+    pthread_mutex_unlock(&mutableWriter->mutex);
+
+    return result;
+}
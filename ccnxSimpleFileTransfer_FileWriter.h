@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+#ifndef ccnxSimpleFileTransfer_FileWriter_h
+#define ccnxSimpleFileTransfer_FileWriter_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct ccnxSimpleFileTransfer_FileWriter;
+
+/**
+ * A `CCNxSimpleFileTransferFileWriter` gathers small writes (e.g. the payloads of received chunks)
+ * into a ring of large, page-aligned buffers and hands full buffers off to a background thread that
+ * writes them to the output file. The caller only ever copies into memory, so a stalled disk doesn't
+ * block the receive loop until every buffer in the ring is waiting to be written. At that point
+ * `ccnxSimpleFileTransferFileWriter_Write` blocks until the background thread catches up.
+ */
+typedef struct ccnxSimpleFileTransfer_FileWriter CCNxSimpleFileTransferFileWriter;
+
+/**
+ * The default size, in bytes, of each buffer in a `CCNxSimpleFileTransferFileWriter`'s ring.
+ */
+extern const size_t ccnxSimpleFileTransferFileWriter_DefaultBufferSize;
+
+/**
+ * The default number of buffers in a `CCNxSimpleFileTransferFileWriter`'s ring.
+ */
+extern const size_t ccnxSimpleFileTransferFileWriter_DefaultNumberOfBuffers;
+
+/**
+ * Create a new instance of `CCNxSimpleFileTransferFileWriter`, writing to the specified file.
+ * The file is created if it doesn't exist and truncated if it does. If `useDirectIO` is true,
+ * and the platform supports it, the file is opened with O_DIRECT so that the written data bypasses
+ * the page cache.
+ *
+ * The bufferSize is rounded up to a multiple of the buffer alignment (the page size).
+ * The newly created instance must eventually be released by calling `ccnxSimpleFileTransferFileWriter_Release`.
+ *
+ * @param [in] fileName - the name of the file to write.
+ * @param [in] bufferSize - the size, in bytes, of each buffer in the ring.
+ * @param [in] numBuffers - the number of buffers in the ring. Must be at least 2.
+ * @param [in] useDirectIO - true if the file should be opened with O_DIRECT.
+ *
+ * @return A new `CCNxSimpleFileTransferFileWriter`, or NULL if the file could not be opened.
+ */
+CCNxSimpleFileTransferFileWriter *ccnxSimpleFileTransferFileWriter_Create(const char *fileName,
+                                                                          size_t bufferSize,
+                                                                          size_t numBuffers,
+                                                                          bool useDirectIO);
+
+/**
+ * Create a new instance of `CCNxSimpleFileTransferFileWriter`, writing to an already open file
+ * descriptor, such as STDOUT_FILENO or a named pipe. Writes are sequential, so the descriptor does
+ * not need to be seekable. The writer takes ownership of the descriptor and closes it when the
+ * writer is closed.
+ *
+ * The newly created instance must eventually be released by calling `ccnxSimpleFileTransferFileWriter_Release`.
+ *
+ * @param [in] fileDescriptor - the open file descriptor to write to.
+ * @param [in] bufferSize - the size, in bytes, of each buffer in the ring.
+ * @param [in] numBuffers - the number of buffers in the ring. Must be at least 2.
+ *
+ * @return A new `CCNxSimpleFileTransferFileWriter`.
+ */
+CCNxSimpleFileTransferFileWriter *ccnxSimpleFileTransferFileWriter_CreateWithDescriptor(int fileDescriptor,
+                                                                                        size_t bufferSize,
+                                                                                        size_t numBuffers);
+
+/**
+ * Increase the number of references to a `CCNxSimpleFileTransferFileWriter` instance.
+ *
+ * @param [in] instance A pointer to the original `CCNxSimpleFileTransferFileWriter`.
+ * @return The value of the input parameter @p instance.
+ *
+ * @see ccnxSimpleFileTransferFileWriter_Release
+ */
+CCNxSimpleFileTransferFileWriter *ccnxSimpleFileTransferFileWriter_Acquire(
+    const CCNxSimpleFileTransferFileWriter *instance);
+
+/**
+ * Release a previously acquired reference to the specified instance,
+ * decrementing the reference count for the instance.
+ *
+ * If the invocation causes the last reference to the instance to be released, any buffered
+ * data is flushed, the background thread is stopped and the file is closed.
+ *
+ * @param [in,out] writerPtr A pointer to a pointer to the instance to release.
+ *
+ * @see ccnxSimpleFileTransferFileWriter_Acquire
+ */
+void ccnxSimpleFileTransferFileWriter_Release(CCNxSimpleFileTransferFileWriter **writerPtr);
+
+/**
+ * Append the specified bytes to the file. The bytes are copied, so the caller may reuse the
+ * memory as soon as this returns. If every buffer in the ring is waiting to be written, this
+ * blocks until one becomes free.
+ *
+ * @param [in] writer - the `CCNxSimpleFileTransferFileWriter` to write to.
+ * @param [in] bytes - a pointer to the bytes to write.
+ * @param [in] length - the number of bytes to write.
+ *
+ * @return true if the bytes were accepted, false if an earlier write to the file failed.
+ */
+bool ccnxSimpleFileTransferFileWriter_Write(CCNxSimpleFileTransferFileWriter *writer,
+                                            const void *bytes, size_t length);
+
+/**
+ * Append the specified number of zeros to the file. When the file is a regular file, not opened for direct I/O,
+ * the zeros are left as a hole, which takes no space on disk, rather than written.
+ *
+ * @param [in] writer - the `CCNxSimpleFileTransferFileWriter` to write to.
+ * @param [in] length - the number of zeros to write.
+ *
+ * @return true if the zeros were accepted, false if an earlier write to the file failed.
+ */
+bool ccnxSimpleFileTransferFileWriter_WriteZeros(CCNxSimpleFileTransferFileWriter *writer, size_t length);
+
+/**
+ * Write any buffered data, wait for the background thread to finish, and close the file.
+ * Subsequent calls to `ccnxSimpleFileTransferFileWriter_Write` will fail.
+ *
+ * @param [in] writer - the `CCNxSimpleFileTransferFileWriter` to close.
+ *
+ * @return true if every byte passed to `ccnxSimpleFileTransferFileWriter_Write` was written to the file.
+ */
+bool ccnxSimpleFileTransferFileWriter_Close(CCNxSimpleFileTransferFileWriter *writer);
+
+/**
+ * Return the number of bytes that have been written to the file so far.
+ *
+ * @param [in] writer - the `CCNxSimpleFileTransferFileWriter` to query.
+ * @return the number of bytes written to the file.
+ */
+uint64_t ccnxSimpleFileTransferFileWriter_GetBytesWritten(const CCNxSimpleFileTransferFileWriter *writer);
+
+/**
+ * Return the number of times `ccnxSimpleFileTransferFileWriter_Write` had to wait for the background
+ * thread because every buffer in the ring was full. A non-zero value means the disk is slower than
+ * the incoming data.
+ *
+ * @param [in] writer - the `CCNxSimpleFileTransferFileWriter` to query.
+ * @return the number of times the writer applied backpressure.
+ */
+uint64_t ccnxSimpleFileTransferFileWriter_GetStallCount(const CCNxSimpleFileTransferFileWriter *writer);
+#endif // ccnxSimpleFileTransfer_FileWriter_h
@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <pthread.h>
+#include <time.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+#include <parc/algol/parc_HashMap.h>
+
+#include "ccnxSimpleFileTransfer_InFlightTable.h"
+
+/**
+ * The value of a table entry. The key is the name of the Interest.
+ */
+typedef struct inFlightEntry {
+    bool isBuilt;
+    CCNxContentObject *response;    // NULL until built, or if there is no response.
+} _InFlightEntry;
+
+static void
+_inFlightEntry_Finalize(_InFlightEntry **entryPtr)
+{
+    _InFlightEntry *entry = *entryPtr;
+    if (entry->response != NULL) {
+        ccnxContentObject_Release(&entry->response);
+    }
+}
+
+parcObject_ExtendPARCObject(_InFlightEntry, _inFlightEntry_Finalize, NULL, NULL, NULL, NULL, NULL, NULL);
+
+/**
+ * A built response that is lingering in the table. As every response lingers for the same time,
+ * they expire in the order they were built.
+ */
+typedef struct lingeringEntry {
+    CCNxName *name;
+    _InFlightEntry *entry;
+    uint64_t expiryMillis;
+} _LingeringEntry;
+
+struct ccnxSimpleFileTransfer_InFlightTable {
+    uint64_t lingerMillis;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t responseBuilt;   // Signalled whenever a response has been built.
+
+    PARCHashMap *entries;           // CCNxName -> _InFlightEntry
+
+    // The lingering entries, oldest first, in a ring.
+    _LingeringEntry *lingering;
+    size_t lingeringOldest;
+    size_t numLingering;
+    size_t lingeringCapacity;
+};
+
+static uint64_t
+_nowMillis(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000 + (uint64_t) now.tv_nsec / 1000000;
+}
+
+/**
+ * Remove the entry for `name`, if it is still `entry`.
+ */
+static void
+_removeEntry(CCNxSimpleFileTransferInFlightTable *table, const CCNxName *name, const _InFlightEntry *entry)
+{
+    if (parcHashMap_Get(table->entries, name) == entry) {
+        parcHashMap_Remove(table->entries, name);
+    }
+}
+
+static void
+_removeExpired(CCNxSimpleFileTransferInFlightTable *table, uint64_t nowMillis)
+{
+    while (table->numLingering > 0 && table->lingering[table->lingeringOldest].expiryMillis <= nowMillis) {
+        _LingeringEntry *oldest = &table->lingering[table->lingeringOldest];
+        _removeEntry(table, oldest->name, oldest->entry);
+        ccnxName_Release(&oldest->name);
+        parcObject_Release((PARCObject **) &oldest->entry);
+
+        table->lingeringOldest = (table->lingeringOldest + 1) % table->lingeringCapacity;
+        table->numLingering--;
+    }
+}
+
+static void
+_addLingering(CCNxSimpleFileTransferInFlightTable *table, const CCNxName *name, _InFlightEntry *entry, uint64_t expiryMillis)
+{
+    if (table->numLingering == table->lingeringCapacity) {
+        size_t newCapacity = (table->lingeringCapacity == 0) ? 64 : table->lingeringCapacity * 2;
+        _LingeringEntry *newLingering = parcMemory_AllocateAndClear(newCapacity * sizeof(_LingeringEntry));
+        assertNotNull(newLingering, "parcMemory_AllocateAndClear(%zu) returned NULL", newCapacity * sizeof(_LingeringEntry));
+        for (size_t i = 0; i < table->numLingering; i++) {
+            newLingering[i] = table->lingering[(table->lingeringOldest + i) % table->lingeringCapacity];
+        }
+        if (table->lingering != NULL) {
+            parcMemory_Deallocate((void **) &table->lingering);
+        }
+        table->lingering = newLingering;
+        table->lingeringOldest = 0;
+        table->lingeringCapacity = newCapacity;
+    }
+
+    _LingeringEntry *newest = &table->lingering[(table->lingeringOldest + table->numLingering) % table->lingeringCapacity];
+    newest->name = ccnxName_Acquire(name);
+    newest->entry = parcObject_Acquire(entry);
+    newest->expiryMillis = expiryMillis;
+    table->numLingering++;
+}
+
+static void
+_inFlightTable_Finalize(CCNxSimpleFileTransferInFlightTable **tablePtr)
+{
+    CCNxSimpleFileTransferInFlightTable *table = *tablePtr;
+
+    _removeExpired(table, UINT64_MAX);
+    if (table->lingering != NULL) {
+        parcMemory_Deallocate((void **) &table->lingering);
+    }
+    parcHashMap_Release(&table->entries);
+
+    pthread_cond_destroy(&table->responseBuilt);
+    pthread_mutex_destroy(&table->mutex);
+}
+
+parcObject_ExtendPARCObject(CCNxSimpleFileTransferInFlightTable,
+                            _inFlightTable_Finalize,
+                            NULL, NULL, NULL, NULL, NULL, NULL);
+
+parcObject_ImplementAcquire(ccnxSimpleFileTransferInFlightTable, CCNxSimpleFileTransferInFlightTable);
+
+parcObject_ImplementRelease(ccnxSimpleFileTransferInFlightTable, CCNxSimpleFileTransferInFlightTable);
+
+CCNxSimpleFileTransferInFlightTable *
+ccnxSimpleFileTransferInFlightTable_Create(uint64_t lingerMillis)
+{
+    CCNxSimpleFileTransferInFlightTable *result = parcObject_CreateAndClearInstance(CCNxSimpleFileTransferInFlightTable);
+
+    result->lingerMillis = lingerMillis;
+    result->entries = parcHashMap_Create();
+    pthread_mutex_init(&result->mutex, NULL);
+    pthread_cond_init(&result->responseBuilt, NULL);
+
+    return result;
+}
+
+CCNxContentObject *
+ccnxSimpleFileTransferInFlightTable_GetResponse(CCNxSimpleFileTransferInFlightTable *table,
+                                                const CCNxInterest *interest,
+                                                CCNxSimpleFileTransferInFlightTableBuilder *builder,
+                                                void *builderContext,
+                                                bool *wasCoalesced)
+{
+    CCNxContentObject *result = NULL;
+    const CCNxName *name = ccnxInterest_GetName(interest);
+
+    pthread_mutex_lock(&table->mutex);
+
+    _removeExpired(table, _nowMillis());
+
+    _InFlightEntry *entry = (_InFlightEntry *) parcHashMap_Get(table->entries, name);
+    bool isLeader = (entry == NULL);
+
+    if (isLeader) {
+        entry = parcObject_CreateAndClearInstance(_InFlightEntry);
+        parcHashMap_Put(table->entries, name, entry);
+
+        pthread_mutex_unlock(&table->mutex);
+        CCNxContentObject *response = builder(builderContext, interest);
+        pthread_mutex_lock(&table->mutex);
+
+        entry->response = response;
+        entry->isBuilt = true;
+        pthread_cond_broadcast(&table->responseBuilt);
+
+        if (table->lingerMillis > 0) {
+            _addLingering(table, name, entry, _nowMillis() + table->lingerMillis);
+        } else {
+            _removeEntry(table, name, entry);
+        }
+    } else {
+        // Keep the entry alive while we wait, in case the leader removes it from the table.
+        entry = parcObject_Acquire(entry);
+        while (!entry->isBuilt) {
+            pthread_cond_wait(&table->responseBuilt, &table->mutex);
+        }
+    }
+
+    if (entry->response != NULL) {
+        result = ccnxContentObject_Acquire(entry->response);
+    }
+    parcObject_Release((PARCObject **) &entry);
+
+    pthread_mutex_unlock(&table->mutex);
+
+    if (wasCoalesced != NULL) {
+        *wasCoalesced = !isLeader;
+    }
+
+    return result;
+}
+
+size_t
+ccnxSimpleFileTransferInFlightTable_GetSize(CCNxSimpleFileTransferInFlightTable *table)
+{
+    pthread_mutex_lock(&table->mutex);
+    _removeExpired(table, _nowMillis());
+    size_t result = parcHashMap_Size(table->entries);
+    pthread_mutex_unlock(&table->mutex);
+
+    return result;
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+#ifndef ccnxSimpleFileTransfer_InFlightTable_h
+#define ccnxSimpleFileTransfer_InFlightTable_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <ccnx/common/ccnx_Interest.h>
+#include <ccnx/common/ccnx_ContentObject.h>
+
+struct ccnxSimpleFileTransfer_InFlightTable;
+
+/**
+ * A `CCNxSimpleFileTransferInFlightTable` coalesces identical Interests, so that the response to a name is
+ * built once however many Interests for it arrive together.
+ *
+ * The first Interest for a name (the leader) builds the response. Interests for the same name that arrive,
+ * on any thread, while it is being built wait for it and share it. The built response then lingers in the
+ * table for a configurable time, so that Interests arriving shortly afterwards (e.g. from the other clients
+ * in a flash crowd) share it too, rather than each causing another disk read.
+ *
+ * The table is keyed by the Interest's name only.
+ */
+typedef struct ccnxSimpleFileTransfer_InFlightTable CCNxSimpleFileTransferInFlightTable;
+
+/**
+ * Build the response to an Interest. Return a new CCNxContentObject, or NULL if there is no response.
+ */
+typedef CCNxContentObject *(CCNxSimpleFileTransferInFlightTableBuilder)(void *builderContext, const CCNxInterest *interest);
+
+/**
+ * Create a new, empty `CCNxSimpleFileTransferInFlightTable`.
+ * The newly created instance must eventually be released by calling `ccnxSimpleFileTransferInFlightTable_Release`.
+ *
+ * @param [in] lingerMillis - how long a built response is kept for later Interests. With 0, only Interests
+ *                            that arrive while the response is being built share it.
+ */
+CCNxSimpleFileTransferInFlightTable *ccnxSimpleFileTransferInFlightTable_Create(uint64_t lingerMillis);
+
+/**
+ * Increase the number of references to a `CCNxSimpleFileTransferInFlightTable` instance.
+ *
+ * @param [in] instance A pointer to the original `CCNxSimpleFileTransferInFlightTable`.
+ * @return The value of the input parameter @p instance.
+ *
+ * @see ccnxSimpleFileTransferInFlightTable_Release
+ */
+CCNxSimpleFileTransferInFlightTable *ccnxSimpleFileTransferInFlightTable_Acquire(const CCNxSimpleFileTransferInFlightTable *instance);
+
+/**
+ * Release a previously acquired reference to the specified instance,
+ * decrementing the reference count for the instance.
+ *
+ * @param [in,out] tablePtr A pointer to a pointer to the instance to release.
+ *
+ * @see ccnxSimpleFileTransferInFlightTable_Acquire
+ */
+void ccnxSimpleFileTransferInFlightTable_Release(CCNxSimpleFileTransferInFlightTable **tablePtr);
+
+/**
+ * Get the response to an Interest, either one already built (or being built) for the same name, or a new
+ * one from the specified builder. The builder is called without the table locked.
+ * The returned CCNxContentObject must eventually be released by calling ccnxContentObject_Release().
+ *
+ * @param [in] table - the table.
+ * @param [in] interest - the Interest to respond to.
+ * @param [in] builder - builds the response if there isn't one for the Interest's name.
+ * @param [in] builderContext - passed to `builder`.
+ * @param [out] wasCoalesced - if not NULL, set to whether the response was shared rather than built for this Interest.
+ *
+ * @return The response, or NULL if the builder returned NULL.
+ */
+CCNxContentObject *ccnxSimpleFileTransferInFlightTable_GetResponse(CCNxSimpleFileTransferInFlightTable *table,
+                                                                   const CCNxInterest *interest,
+                                                                   CCNxSimpleFileTransferInFlightTableBuilder *builder,
+                                                                   void *builderContext,
+                                                                   bool *wasCoalesced);
+
+/**
+ * Return the number of names in the table, whether being built or lingering.
+ *
+ * @param [in] table - the table.
+ */
+size_t ccnxSimpleFileTransferInFlightTable_GetSize(CCNxSimpleFileTransferInFlightTable *table);
+
+#endif // ccnxSimpleFileTransfer_InFlightTable_h
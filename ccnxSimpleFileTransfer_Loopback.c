@@ -0,0 +1,428 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <stdio.h>
+#include <unistd.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+#include <parc/algol/parc_HashMap.h>
+
+#include "ccnxSimpleFileTransfer_Loopback.h"
+
+/**
+ * The bytes we assume each packet carries in addition to its payload (fixed header, name, signature).
+ * It only affects the serialization delay on a bandwidth limited link.
+ */
+static const size_t _packetOverheadBytes = 128;
+
+const CCNxSimpleFileTransferLoopbackConfig ccnxSimpleFileTransferLoopback_DefaultConfig = {
+    .linkDelayMicros        = 1000,
+    .producerDelayMicros    = 0,
+    .lossProbability        = 0.0,
+    .bandwidthBitsPerSecond = 0,
+    .contentStoreCapacity   = 0,
+    .interestLifetimeMicros = 4000000,
+    .randomSeed             = 1,
+};
+
+typedef enum {
+    _LoopbackEventType_InterestAtForwarder,
+    _LoopbackEventType_ContentAtForwarder,
+    _LoopbackEventType_ContentAtConsumer,
+} _LoopbackEventType;
+
+typedef struct loopbackEvent {
+    uint64_t timeMicros;
+    uint64_t sequenceNumber;    // Orders events scheduled for the same time.
+    _LoopbackEventType type;
+    PARCObject *message;        // A CCNxInterest or a CCNxContentObject.
+} _LoopbackEvent;
+
+/**
+ * The value of a PIT entry. The key is the name of the Interest.
+ */
+typedef struct loopbackPendingInterest {
+    uint64_t expiryMicros;
+} _LoopbackPendingInterest;
+
+parcObject_ExtendPARCObject(_LoopbackPendingInterest, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+
+struct ccnxSimpleFileTransfer_Loopback {
+    CCNxSimpleFileTransferLoopbackConfig config;
+    CCNxSimpleFileTransferLoopbackProducer *producer;
+    void *producerContext;
+
+    uint64_t nowMicros;
+    uint64_t randomState;
+    uint64_t nextSequenceNumber;
+
+    // The events in flight, as a binary min-heap ordered by time.
+    _LoopbackEvent *events;
+    size_t numEvents;
+    size_t eventCapacity;
+
+    // When each direction of the link finishes sending what it has been given.
+    uint64_t upstreamFreeAtMicros;
+    uint64_t downstreamFreeAtMicros;
+
+    PARCHashMap *pendingInterestTable;  // CCNxName -> _LoopbackPendingInterest
+
+    PARCHashMap *contentStore;          // CCNxName -> CCNxContentObject
+    CCNxName **contentStoreNames;       // The names in the Content Store, oldest first, in a ring.
+    size_t contentStoreOldest;
+
+    CCNxSimpleFileTransferLoopbackStats stats;
+};
+
+static bool
+_isEarlier(const _LoopbackEvent *a, const _LoopbackEvent *b)
+{
+    return (a->timeMicros < b->timeMicros)
+           || (a->timeMicros == b->timeMicros && a->sequenceNumber < b->sequenceNumber);
+}
+
+static void
+_swapEvents(_LoopbackEvent *a, _LoopbackEvent *b)
+{
+    _LoopbackEvent temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+static void
+_pushEvent(CCNxSimpleFileTransferLoopback *loopback, uint64_t timeMicros, _LoopbackEventType type, const PARCObject *message)
+{
+    if (loopback->numEvents == loopback->eventCapacity) {
+        loopback->eventCapacity = (loopback->eventCapacity == 0) ? 64 : loopback->eventCapacity * 2;
+        loopback->events = parcMemory_Reallocate(loopback->events, loopback->eventCapacity * sizeof(_LoopbackEvent));
+        assertNotNull(loopback->events, "parcMemory_Reallocate(%zu) returned NULL", loopback->eventCapacity * sizeof(_LoopbackEvent));
+    }
+
+    size_t index = loopback->numEvents++;
+    _LoopbackEvent *event = &loopback->events[index];
+    event->timeMicros = timeMicros;
+    event->sequenceNumber = loopback->nextSequenceNumber++;
+    event->type = type;
+    event->message = parcObject_Acquire(message);
+
+    // Sift up.
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (!_isEarlier(&loopback->events[index], &loopback->events[parent])) {
+            break;
+        }
+        _swapEvents(&loopback->events[index], &loopback->events[parent]);
+        index = parent;
+    }
+}
+
+static _LoopbackEvent
+_popEvent(CCNxSimpleFileTransferLoopback *loopback)
+{
+    _LoopbackEvent result = loopback->events[0];
+    loopback->events[0] = loopback->events[--loopback->numEvents];
+
+    // Sift down.
+    size_t index = 0;
+    while (true) {
+        size_t earliest = index;
+        size_t left = (2 * index) + 1;
+        size_t right = left + 1;
+        if (left < loopback->numEvents && _isEarlier(&loopback->events[left], &loopback->events[earliest])) {
+            earliest = left;
+        }
+        if (right < loopback->numEvents && _isEarlier(&loopback->events[right], &loopback->events[earliest])) {
+            earliest = right;
+        }
+        if (earliest == index) {
+            break;
+        }
+        _swapEvents(&loopback->events[index], &loopback->events[earliest]);
+        index = earliest;
+    }
+
+    return result;
+}
+
+/**
+ * Return a pseudo-random number in [0, 1), from a xorshift64* generator.
+ */
+static double
+_nextRandom(CCNxSimpleFileTransferLoopback *loopback)
+{
+    uint64_t x = loopback->randomState;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    loopback->randomState = x;
+    return (double) ((x * 2685821657736338717ULL) >> 11) / (double) (1ULL << 53);
+}
+
+/**
+ * Put a packet of the specified size on one direction of the link, and return the time it arrives at
+ * the other end, or 0 if it is lost.
+ */
+static uint64_t
+_transmit(CCNxSimpleFileTransferLoopback *loopback, uint64_t *linkFreeAtMicros, size_t packetBytes)
+{
+    uint64_t startMicros = (*linkFreeAtMicros > loopback->nowMicros) ? *linkFreeAtMicros : loopback->nowMicros;
+    uint64_t serializationMicros = 0;
+    if (loopback->config.bandwidthBitsPerSecond > 0) {
+        serializationMicros = ((uint64_t) packetBytes * 8 * 1000000) / loopback->config.bandwidthBitsPerSecond;
+    }
+    *linkFreeAtMicros = startMicros + serializationMicros;
+
+    // A lost packet still used the link.
+    if (loopback->config.lossProbability > 0.0 && _nextRandom(loopback) < loopback->config.lossProbability) {
+        loopback->stats.packetsLost++;
+        return 0;
+    }
+
+    return *linkFreeAtMicros + loopback->config.linkDelayMicros;
+}
+
+static void
+_sendContentToConsumer(CCNxSimpleFileTransferLoopback *loopback, const CCNxContentObject *contentObject)
+{
+    PARCBuffer *payload = ccnxContentObject_GetPayload(contentObject);
+    size_t payloadBytes = (payload != NULL) ? parcBuffer_Remaining(payload) : 0;
+
+    uint64_t arrivalMicros = _transmit(loopback, &loopback->downstreamFreeAtMicros, payloadBytes + _packetOverheadBytes);
+    if (arrivalMicros != 0) {
+        _pushEvent(loopback, arrivalMicros, _LoopbackEventType_ContentAtConsumer, contentObject);
+    }
+}
+
+static void
+_addToContentStore(CCNxSimpleFileTransferLoopback *loopback, const CCNxName *name, const CCNxContentObject *contentObject)
+{
+    size_t capacity = loopback->config.contentStoreCapacity;
+    if (capacity == 0 || parcHashMap_Contains(loopback->contentStore, name)) {
+        return;
+    }
+
+    size_t size = parcHashMap_Size(loopback->contentStore);
+    size_t slot = (loopback->contentStoreOldest + size) % capacity;
+    if (size == capacity) {
+        // Evict the oldest entry, whose slot the new entry takes.
+        parcHashMap_Remove(loopback->contentStore, loopback->contentStoreNames[slot]);
+        ccnxName_Release(&loopback->contentStoreNames[slot]);
+        loopback->contentStoreOldest = (loopback->contentStoreOldest + 1) % capacity;
+    }
+
+    loopback->contentStoreNames[slot] = ccnxName_Acquire(name);
+    parcHashMap_Put(loopback->contentStore, name, contentObject);
+}
+
+static void
+_interestAtForwarder(CCNxSimpleFileTransferLoopback *loopback, const CCNxInterest *interest)
+{
+    CCNxName *name = ccnxInterest_GetName(interest);
+
+    const CCNxContentObject *cached = parcHashMap_Get(loopback->contentStore, name);
+    if (cached != NULL) {
+        loopback->stats.contentStoreHits++;
+        _sendContentToConsumer(loopback, cached);
+        return;
+    }
+
+    const _LoopbackPendingInterest *pending = parcHashMap_Get(loopback->pendingInterestTable, name);
+    if (pending != NULL && pending->expiryMicros > loopback->nowMicros) {
+        loopback->stats.interestsAggregated++;
+        return;
+    }
+
+    _LoopbackPendingInterest *entry = parcObject_CreateAndClearInstance(_LoopbackPendingInterest);
+    entry->expiryMicros = loopback->nowMicros + loopback->config.interestLifetimeMicros;
+    parcHashMap_Put(loopback->pendingInterestTable, name, entry);
+    parcObject_Release((PARCObject **) &entry);
+
+    loopback->stats.interestsForwarded++;
+    CCNxContentObject *contentObject = loopback->producer(loopback->producerContext, interest);
+
+    if (contentObject != NULL) {
+        _pushEvent(loopback, loopback->nowMicros + loopback->config.producerDelayMicros,
+                   _LoopbackEventType_ContentAtForwarder, contentObject);
+        ccnxContentObject_Release(&contentObject);
+    }
+}
+
+static void
+_contentAtForwarder(CCNxSimpleFileTransferLoopback *loopback, const CCNxContentObject *contentObject)
+{
+    CCNxName *name = ccnxContentObject_GetName(contentObject);
+
+    // Content that doesn't match a PIT entry was not asked for, and is dropped.
+    if (parcHashMap_Remove(loopback->pendingInterestTable, name)) {
+        _addToContentStore(loopback, name, contentObject);
+        _sendContentToConsumer(loopback, contentObject);
+    }
+}
+
+static void
+_loopback_Finalize(CCNxSimpleFileTransferLoopback **loopbackPtr)
+{
+    CCNxSimpleFileTransferLoopback *loopback = *loopbackPtr;
+
+    for (size_t i = 0; i < loopback->numEvents; i++) {
+        parcObject_Release(&loopback->events[i].message);
+    }
+    if (loopback->events != NULL) {
+        parcMemory_Deallocate((void **) &loopback->events);
+    }
+
+    if (loopback->contentStoreNames != NULL) {
+        size_t size = parcHashMap_Size(loopback->contentStore);
+        for (size_t i = 0; i < size; i++) {
+            ccnxName_Release(&loopback->contentStoreNames[(loopback->contentStoreOldest + i) % loopback->config.contentStoreCapacity]);
+        }
+        parcMemory_Deallocate((void **) &loopback->contentStoreNames);
+    }
+
+    parcHashMap_Release(&loopback->contentStore);
+    parcHashMap_Release(&loopback->pendingInterestTable);
+}
+
+parcObject_ExtendPARCObject(CCNxSimpleFileTransferLoopback,
+                            _loopback_Finalize,
+                            NULL, NULL, NULL, NULL, NULL, NULL);
+
+parcObject_ImplementAcquire(ccnxSimpleFileTransferLoopback, CCNxSimpleFileTransferLoopback);
+
+parcObject_ImplementRelease(ccnxSimpleFileTransferLoopback, CCNxSimpleFileTransferLoopback);
+
+CCNxSimpleFileTransferLoopback *
+ccnxSimpleFileTransferLoopback_Create(const CCNxSimpleFileTransferLoopbackConfig *config,
+                                      CCNxSimpleFileTransferLoopbackProducer *producer,
+                                      void *producerContext)
+{
+    assertNotNull(producer, "The producer must not be NULL");
+
+    CCNxSimpleFileTransferLoopback *result = parcObject_CreateAndClearInstance(CCNxSimpleFileTransferLoopback);
+
+    result->config = *config;
+    result->producer = producer;
+    result->producerContext = producerContext;
+
+    // xorshift must not be seeded with 0.
+    result->randomState = (config->randomSeed == 0) ? 0x9E3779B97F4A7C15ULL : config->randomSeed;
+
+    result->pendingInterestTable = parcHashMap_Create();
+    result->contentStore = parcHashMap_Create();
+    if (config->contentStoreCapacity > 0) {
+        result->contentStoreNames = parcMemory_AllocateAndClear(config->contentStoreCapacity * sizeof(CCNxName *));
+        assertNotNull(result->contentStoreNames, "parcMemory_AllocateAndClear(%zu) returned NULL",
+                      config->contentStoreCapacity * sizeof(CCNxName *));
+    }
+
+    return result;
+}
+
+void
+ccnxSimpleFileTransferLoopback_SendInterest(CCNxSimpleFileTransferLoopback *loopback, const CCNxInterest *interest)
+{
+    loopback->stats.interestsSent++;
+
+    uint64_t arrivalMicros = _transmit(loopback, &loopback->upstreamFreeAtMicros, _packetOverheadBytes);
+    if (arrivalMicros != 0) {
+        _pushEvent(loopback, arrivalMicros, _LoopbackEventType_InterestAtForwarder, interest);
+    }
+}
+
+CCNxContentObject *
+ccnxSimpleFileTransferLoopback_Receive(CCNxSimpleFileTransferLoopback *loopback, uint64_t deadlineMicros)
+{
+    while (loopback->numEvents > 0 && loopback->events[0].timeMicros <= deadlineMicros) {
+        _LoopbackEvent event = _popEvent(loopback);
+        loopback->nowMicros = event.timeMicros;
+
+        if (event.type == _LoopbackEventType_ContentAtConsumer) {
+            CCNxContentObject *result = event.message;
+            PARCBuffer *payload = ccnxContentObject_GetPayload(result);
+            loopback->stats.contentObjectsDelivered++;
+            loopback->stats.bytesDelivered += (payload != NULL) ? parcBuffer_Remaining(payload) : 0;
+            return result; // The event's reference passes to the caller.
+        }
+
+        if (event.type == _LoopbackEventType_InterestAtForwarder) {
+            _interestAtForwarder(loopback, event.message);
+        } else {
+            _contentAtForwarder(loopback, event.message);
+        }
+        parcObject_Release(&event.message);
+    }
+
+    if (deadlineMicros != UINT64_MAX && deadlineMicros > loopback->nowMicros) {
+        loopback->nowMicros = deadlineMicros;
+    }
+
+    return NULL;
+}
+
+uint64_t
+ccnxSimpleFileTransferLoopback_GetNowMicros(const CCNxSimpleFileTransferLoopback *loopback)
+{
+    return loopback->nowMicros;
+}
+
+CCNxSimpleFileTransferLoopbackStats
+ccnxSimpleFileTransferLoopback_GetStats(const CCNxSimpleFileTransferLoopback *loopback)
+{
+    return loopback->stats;
+}
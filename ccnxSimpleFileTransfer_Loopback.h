@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+#ifndef ccnxSimpleFileTransfer_Loopback_h
+#define ccnxSimpleFileTransfer_Loopback_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <ccnx/common/ccnx_Interest.h>
+#include <ccnx/common/ccnx_ContentObject.h>
+
+struct ccnxSimpleFileTransfer_Loopback;
+
+/**
+ * A `CCNxSimpleFileTransferLoopback` is an in-memory stand-in for a forwarder (e.g. Metis or Athena),
+ * for testing and benchmarking the client and server logic without a running forwarder.
+ *
+ * It is a discrete event simulation on a virtual clock, in microseconds. A consumer sends Interests over a
+ * simulated link to the forwarder, which has a Pending Interest Table (PIT) that aggregates Interests for the
+ * same name, and an optional Content Store. Interests that aren't satisfied from the Content Store are handed
+ * to a producer function (e.g. the server's response logic). Its answer reaches the forwarder after a configurable
+ * producer delay, satisfies the PIT entry, and travels back over the link.
+ * The link has a configurable one-way delay, loss probability and bandwidth. Losses are drawn from a seeded
+ * pseudo-random generator, so a run is repeatable.
+ *
+ * The loopback is single-threaded: the producer is called from within `ccnxSimpleFileTransferLoopback_Receive`.
+ */
+typedef struct ccnxSimpleFileTransfer_Loopback CCNxSimpleFileTransferLoopback;
+
+/**
+ * The producer behind the forwarder. Given an Interest, return a new CCNxContentObject that answers it,
+ * or NULL to leave it unanswered. The loopback releases the returned CCNxContentObject.
+ */
+typedef CCNxContentObject *(CCNxSimpleFileTransferLoopbackProducer)(void *producerContext, const CCNxInterest *interest);
+
+/**
+ * The simulated network.
+ */
+typedef struct {
+    uint64_t linkDelayMicros;           // One-way propagation delay between the consumer and the forwarder.
+    uint64_t producerDelayMicros;       // Time from the forwarder handing an Interest to the producer until it has the answer.
+    double lossProbability;             // The probability, from 0 to 1, that a packet is lost in each direction.
+    uint64_t bandwidthBitsPerSecond;    // The link bandwidth in each direction. 0 means unlimited.
+    size_t contentStoreCapacity;        // The number of Content Objects cached by the forwarder. 0 disables the Content Store.
+    uint64_t interestLifetimeMicros;    // How long a PIT entry aggregates Interests for its name.
+    uint32_t randomSeed;                // Seeds the loss process.
+} CCNxSimpleFileTransferLoopbackConfig;
+
+/**
+ * A lossless link with a 1ms one-way delay, unlimited bandwidth, no producer delay, no Content Store and
+ * a 4 second Interest lifetime.
+ */
+extern const CCNxSimpleFileTransferLoopbackConfig ccnxSimpleFileTransferLoopback_DefaultConfig;
+
+/**
+ * Counts of what the loopback has done.
+ */
+typedef struct {
+    uint64_t interestsSent;             // Interests sent by the consumer.
+    uint64_t interestsForwarded;        // Interests handed to the producer.
+    uint64_t interestsAggregated;       // Interests absorbed by an existing PIT entry.
+    uint64_t contentStoreHits;          // Interests answered from the Content Store.
+    uint64_t contentObjectsDelivered;   // Content Objects delivered to the consumer.
+    uint64_t bytesDelivered;            // Payload bytes delivered to the consumer.
+    uint64_t packetsLost;               // Interests and Content Objects lost on the link.
+} CCNxSimpleFileTransferLoopbackStats;
+
+/**
+ * Create a new `CCNxSimpleFileTransferLoopback` whose Interests are answered by the specified producer.
+ * The virtual clock starts at 0.
+ * The newly created instance must eventually be released by calling `ccnxSimpleFileTransferLoopback_Release`.
+ *
+ * @param [in] config - the simulated network.
+ * @param [in] producer - the function that answers Interests.
+ * @param [in] producerContext - passed to every call of `producer`.
+ */
+CCNxSimpleFileTransferLoopback *ccnxSimpleFileTransferLoopback_Create(const CCNxSimpleFileTransferLoopbackConfig *config,
+                                                                      CCNxSimpleFileTransferLoopbackProducer *producer,
+                                                                      void *producerContext);
+
+/**
+ * Increase the number of references to a `CCNxSimpleFileTransferLoopback` instance.
+ *
+ * @param [in] instance A pointer to the original `CCNxSimpleFileTransferLoopback`.
+ * @return The value of the input parameter @p instance.
+ *
+ * @see ccnxSimpleFileTransferLoopback_Release
+ */
+CCNxSimpleFileTransferLoopback *ccnxSimpleFileTransferLoopback_Acquire(const CCNxSimpleFileTransferLoopback *instance);
+
+/**
+ * Release a previously acquired reference to the specified instance,
+ * decrementing the reference count for the instance.
+ *
+ * @param [in,out] loopbackPtr A pointer to a pointer to the instance to release.
+ *
+ * @see ccnxSimpleFileTransferLoopback_Acquire
+ */
+void ccnxSimpleFileTransferLoopback_Release(CCNxSimpleFileTransferLoopback **loopbackPtr);
+
+/**
+ * Send an Interest from the consumer at the current virtual time.
+ *
+ * @param [in] loopback - the loopback to send through.
+ * @param [in] interest - the Interest to send.
+ */
+void ccnxSimpleFileTransferLoopback_SendInterest(CCNxSimpleFileTransferLoopback *loopback, const CCNxInterest *interest);
+
+/**
+ * Advance the virtual clock until the next Content Object reaches the consumer, and return it. If nothing
+ * reaches the consumer by `deadlineMicros`, the clock is advanced to `deadlineMicros` (unless there is nothing
+ * left in flight and the deadline is UINT64_MAX) and NULL is returned.
+ * The returned CCNxContentObject must eventually be released by calling ccnxContentObject_Release().
+ *
+ * @param [in] loopback - the loopback to receive from.
+ * @param [in] deadlineMicros - the virtual time to give up at, or UINT64_MAX to wait until nothing is in flight.
+ * @return A Content Object, or NULL.
+ */
+CCNxContentObject *ccnxSimpleFileTransferLoopback_Receive(CCNxSimpleFileTransferLoopback *loopback, uint64_t deadlineMicros);
+
+/**
+ * Return the current virtual time, in microseconds.
+ *
+ * @param [in] loopback - the loopback to query.
+ * @return the virtual time.
+ */
+uint64_t ccnxSimpleFileTransferLoopback_GetNowMicros(const CCNxSimpleFileTransferLoopback *loopback);
+
+/**
+ * Return counts of what the loopback has done so far.
+ *
+ * @param [in] loopback - the loopback to query.
+ * @return the counts.
+ */
+CCNxSimpleFileTransferLoopbackStats ccnxSimpleFileTransferLoopback_GetStats(const CCNxSimpleFileTransferLoopback *loopback);
+#endif // ccnxSimpleFileTransfer_Loopback_h
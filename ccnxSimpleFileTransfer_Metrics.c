@@ -0,0 +1,535 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+#include <parc/algol/parc_BufferComposer.h>
+
+#include "ccnxSimpleFileTransfer_Metrics.h"
+
+static const char *_unixSocketTargetPrefix = "unix:";
+
+typedef struct metricsHistogram {
+    uint64_t buckets[CCNxSimpleFileTransferMetrics_NumHistogramBuckets];
+    uint64_t count;
+    uint64_t sumNanos;
+} _MetricsHistogram;
+
+struct ccnxSimpleFileTransfer_Metrics {
+    char *role;
+    uint64_t counters[CCNxSimpleFileTransferMetricsCounter_NumCounters];
+    _MetricsHistogram histograms[CCNxSimpleFileTransferMetricsHistogram_NumHistograms];
+
+    // The exporter.
+    bool isExporting;
+    bool isStopping;
+    char *exportFileName;       // Set when exporting to a file.
+    char *exportSocketPath;     // Set when exporting on a Unix socket.
+    int listenSocket;
+    unsigned int intervalSeconds;
+    pthread_t exportThread;
+    pthread_mutex_t mutex;
+    pthread_cond_t stopSignal;
+};
+
+static const struct {
+    const char *name;
+    const char *help;
+} _counterInfo[CCNxSimpleFileTransferMetricsCounter_NumCounters] = {
+    { "interests_received_total",       "Interests received."                           },
+    { "responses_sent_total",           "Content Objects sent in response to Interests." },
+    { "cache_hits_total",               "Chunks served from the pre-chunked cache."     },
+    { "cache_misses_total",             "Chunk requests that had to pre-chunk a file."  },
+    { "bytes_sent_total",               "Payload bytes sent."                           },
+    { "send_failures_total",            "Failed sends to the forwarder."                },
+    { "interests_coalesced_total",      "Interests answered with a response built for an identical Interest." },
+    { "cache_admission_rejections_total", "Chunk requests served from disk because the file wasn't popular enough to pre-chunk." },
+    { "cache_evictions_total",          "Pre-chunked files evicted to make room for others." },
+    { "content_objects_received_total", "Content Objects received."                     },
+    { "bytes_received_total",           "Payload bytes received."                       },
+    { "interests_dropped_total",        "Interests dropped to make room for those of less busy classes." },
+    { "duplicate_chunks_total",         "Pre-chunked chunks that share their payload with an identical chunk." },
+};
+
+static const struct {
+    const char *name;
+    const char *help;
+} _histogramInfo[CCNxSimpleFileTransferMetricsHistogram_NumHistograms] = {
+    { "disk_read_seconds",      "Time to read a chunk from disk."                 },
+    { "response_build_seconds", "Time to build the response to an Interest."      },
+    { "send_seconds",           "Time to hand a message to the Portal."           },
+    { "write_seconds",          "Time to hand a received chunk to the file sink." },
+    { "metadata_queue_seconds", "Time a list, stat, sums or digests Interest waited to be answered." },
+    { "fetch_queue_seconds",    "Time a fetch Interest waited to be answered."    },
+};
+
+static uint64_t
+_nowNanos(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t) now.tv_sec * 1000000000ULL) + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * Return the index of the histogram bucket that the specified latency falls into.
+ */
+static unsigned int
+_getBucketIndex(uint64_t nanos)
+{
+    // The number of significant bits in nanos, less one, is the power of two just below it.
+    unsigned int result = (nanos == 0) ? 0 : (unsigned int) (63 - __builtin_clzll(nanos));
+    return (result < CCNxSimpleFileTransferMetrics_NumHistogramBuckets) ? result
+                                                                        : CCNxSimpleFileTransferMetrics_NumHistogramBuckets - 1;
+}
+
+static uint64_t
+_atomicLoad(const uint64_t *value)
+{
+    return __atomic_load_n(value, __ATOMIC_RELAXED);
+}
+
+static void
+_metrics_Finalize(CCNxSimpleFileTransferMetrics **metricsPtr)
+{
+    CCNxSimpleFileTransferMetrics *metrics = *metricsPtr;
+
+    ccnxSimpleFileTransferMetrics_StopExporter(metrics);
+
+    pthread_cond_destroy(&metrics->stopSignal);
+    pthread_mutex_destroy(&metrics->mutex);
+
+    parcMemory_Deallocate(&metrics->role);
+}
+
+parcObject_ExtendPARCObject(CCNxSimpleFileTransferMetrics,
+                            _metrics_Finalize,
+                            NULL, NULL, NULL, NULL, NULL, NULL);
+
+parcObject_ImplementAcquire(ccnxSimpleFileTransferMetrics, CCNxSimpleFileTransferMetrics);
+
+parcObject_ImplementRelease(ccnxSimpleFileTransferMetrics, CCNxSimpleFileTransferMetrics);
+
+CCNxSimpleFileTransferMetrics *
+ccnxSimpleFileTransferMetrics_Create(const char *role)
+{
+    CCNxSimpleFileTransferMetrics *result = parcObject_CreateAndClearInstance(CCNxSimpleFileTransferMetrics);
+
+    result->role = parcMemory_StringDuplicate(role, strlen(role));
+    result->listenSocket = -1;
+
+    pthread_mutex_init(&result->mutex, NULL);
+    pthread_cond_init(&result->stopSignal, NULL);
+
+    return result;
+}
+
+void
+ccnxSimpleFileTransferMetrics_Increment(CCNxSimpleFileTransferMetrics *metrics,
+                                        CCNxSimpleFileTransferMetricsCounter counter, uint64_t amount)
+{
+    if (metrics != NULL) {
+        __atomic_fetch_add(&metrics->counters[counter], amount, __ATOMIC_RELAXED);
+    }
+}
+
+uint64_t
+ccnxSimpleFileTransferMetrics_GetCounter(const CCNxSimpleFileTransferMetrics *metrics,
+                                         CCNxSimpleFileTransferMetricsCounter counter)
+{
+    return _atomicLoad(&metrics->counters[counter]);
+}
+
+uint64_t
+ccnxSimpleFileTransferMetrics_StartTimer(const CCNxSimpleFileTransferMetrics *metrics)
+{
+    return (metrics != NULL) ? _nowNanos() : 0;
+}
+
+void
+ccnxSimpleFileTransferMetrics_RecordLatencySince(CCNxSimpleFileTransferMetrics *metrics,
+                                                 CCNxSimpleFileTransferMetricsHistogram histogram,
+                                                 uint64_t startNanos)
+{
+    if (metrics != NULL) {
+        ccnxSimpleFileTransferMetrics_RecordLatency(metrics, histogram, _nowNanos() - startNanos);
+    }
+}
+
+void
+ccnxSimpleFileTransferMetrics_RecordLatency(CCNxSimpleFileTransferMetrics *metrics,
+                                            CCNxSimpleFileTransferMetricsHistogram histogram,
+                                            uint64_t nanos)
+{
+    if (metrics != NULL) {
+        _MetricsHistogram *h = &metrics->histograms[histogram];
+        __atomic_fetch_add(&h->buckets[_getBucketIndex(nanos)], 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&h->sumNanos, nanos, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&h->count, 1, __ATOMIC_RELAXED);
+    }
+}
+
+uint64_t
+ccnxSimpleFileTransferMetrics_GetHistogramCount(const CCNxSimpleFileTransferMetrics *metrics,
+                                                CCNxSimpleFileTransferMetricsHistogram histogram)
+{
+    return _atomicLoad(&metrics->histograms[histogram].count);
+}
+
+/**
+ * Add the value at `from` to the value at `to`, and zero `from`.
+ */
+static void
+_moveCount(uint64_t *from, uint64_t *to)
+{
+    if (*from != 0) {
+        __atomic_fetch_add(to, *from, __ATOMIC_RELAXED);
+        *from = 0;
+    }
+}
+
+void
+ccnxSimpleFileTransferMetrics_Flush(CCNxSimpleFileTransferMetrics *batch, CCNxSimpleFileTransferMetrics *metrics)
+{
+    if (batch == NULL || metrics == NULL) {
+        return;
+    }
+
+    for (int i = 0; i < CCNxSimpleFileTransferMetricsCounter_NumCounters; i++) {
+        _moveCount(&batch->counters[i], &metrics->counters[i]);
+    }
+
+    for (int i = 0; i < CCNxSimpleFileTransferMetricsHistogram_NumHistograms; i++) {
+        _MetricsHistogram *from = &batch->histograms[i];
+        _MetricsHistogram *to = &metrics->histograms[i];
+        if (from->count != 0) {
+            for (int bucket = 0; bucket < CCNxSimpleFileTransferMetrics_NumHistogramBuckets; bucket++) {
+                _moveCount(&from->buckets[bucket], &to->buckets[bucket]);
+            }
+            _moveCount(&from->sumNanos, &to->sumNanos);
+            _moveCount(&from->count, &to->count);
+        }
+    }
+}
+
+PARCBuffer *
+ccnxSimpleFileTransferMetrics_CreateReport(const CCNxSimpleFileTransferMetrics *metrics)
+{
+    PARCBufferComposer *composer = parcBufferComposer_Create();
+
+    for (int i = 0; i < CCNxSimpleFileTransferMetricsCounter_NumCounters; i++) {
+        parcBufferComposer_Format(composer, "# HELP ccnx_sft_%s %s\n", _counterInfo[i].name, _counterInfo[i].help);
+        parcBufferComposer_Format(composer, "# TYPE ccnx_sft_%s counter\n", _counterInfo[i].name);
+        parcBufferComposer_Format(composer, "ccnx_sft_%s{role=\"%s\"} %" PRIu64 "\n",
+                                  _counterInfo[i].name, metrics->role, _atomicLoad(&metrics->counters[i]));
+    }
+
+    for (int i = 0; i < CCNxSimpleFileTransferMetricsHistogram_NumHistograms; i++) {
+        const _MetricsHistogram *h = &metrics->histograms[i];
+        const char *name = _histogramInfo[i].name;
+
+        parcBufferComposer_Format(composer, "# HELP ccnx_sft_%s %s\n", name, _histogramInfo[i].help);
+        parcBufferComposer_Format(composer, "# TYPE ccnx_sft_%s histogram\n", name);
+
+        // Prometheus buckets are cumulative.
+        uint64_t cumulativeCount = 0;
+        for (int b = 0; b < CCNxSimpleFileTransferMetrics_NumHistogramBuckets - 1; b++) {
+            cumulativeCount += _atomicLoad(&h->buckets[b]);
+            double upperBoundSeconds = (double) (2ULL << b) / 1e9;
+            parcBufferComposer_Format(composer, "ccnx_sft_%s_bucket{role=\"%s\",le=\"%.9g\"} %" PRIu64 "\n",
+                                      name, metrics->role, upperBoundSeconds, cumulativeCount);
+        }
+        uint64_t count = _atomicLoad(&h->count);
+        parcBufferComposer_Format(composer, "ccnx_sft_%s_bucket{role=\"%s\",le=\"+Inf\"} %" PRIu64 "\n",
+                                  name, metrics->role, count);
+        parcBufferComposer_Format(composer, "ccnx_sft_%s_sum{role=\"%s\"} %.9f\n",
+                                  name, metrics->role, (double) _atomicLoad(&h->sumNanos) / 1e9);
+        parcBufferComposer_Format(composer, "ccnx_sft_%s_count{role=\"%s\"} %" PRIu64 "\n",
+                                  name, metrics->role, count);
+    }
+
+    PARCBuffer *result = parcBufferComposer_ProduceBuffer(composer);
+    parcBufferComposer_Release(&composer);
+
+    return result;
+}
+
+/**
+ * Write all of the remaining bytes in the specified buffer to a file descriptor.
+ */
+static bool
+_writeBuffer(int fileDescriptor, PARCBuffer *buffer)
+{
+    size_t length = parcBuffer_Remaining(buffer);
+    const uint8_t *bytes = parcBuffer_Overlay(buffer, 0);
+
+    while (length > 0) {
+        ssize_t numBytesWritten = write(fileDescriptor, bytes, length);
+        if (numBytesWritten < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += numBytesWritten;
+        length -= (size_t) numBytesWritten;
+    }
+    return true;
+}
+
+bool
+ccnxSimpleFileTransferMetrics_WriteReport(const CCNxSimpleFileTransferMetrics *metrics, const char *fileName)
+{
+    bool result = false;
+
+    // Write to a temporary file and rename it, so a reader never sees a partially written report.
+    char *tempFileName = parcMemory_Format("%s.tmp", fileName);
+    FILE *file = fopen(tempFileName, "w");
+
+    if (file != NULL) {
+        PARCBuffer *report = ccnxSimpleFileTransferMetrics_CreateReport(metrics);
+        result = _writeBuffer(fileno(file), report);
+        parcBuffer_Release(&report);
+
+        result = (fclose(file) == 0) && result;
+        result = result && (rename(tempFileName, fileName) == 0);
+    }
+
+    parcMemory_Deallocate(&tempFileName);
+
+    return result;
+}
+
+/**
+ * Serve the report to one client connected to the metrics socket. We answer with a minimal HTTP
+ * response so that HTTP clients (and Prometheus, through a Unix socket proxy) can read it.
+ */
+static void
+_serveReport(CCNxSimpleFileTransferMetrics *metrics, int clientSocket)
+{
+    // Drain whatever request the client sent. We don't care what it asked for.
+    char request[1024];
+    struct pollfd pollEntry = { .fd = clientSocket, .events = POLLIN };
+    if (poll(&pollEntry, 1, 100) > 0) {
+        ssize_t ignored = read(clientSocket, request, sizeof(request));
+        (void) ignored;
+    }
+
+    PARCBuffer *report = ccnxSimpleFileTransferMetrics_CreateReport(metrics);
+
+    PARCBufferComposer *composer = parcBufferComposer_Create();
+    parcBufferComposer_Format(composer,
+                              "HTTP/1.0 200 OK\r\n"
+                              "Content-Type: text/plain; version=0.0.4\r\n"
+                              "Content-Length: %zu\r\n\r\n",
+                              parcBuffer_Remaining(report));
+    parcBufferComposer_PutBuffer(composer, report);
+    PARCBuffer *response = parcBufferComposer_ProduceBuffer(composer);
+
+    _writeBuffer(clientSocket, response);
+
+    parcBuffer_Release(&response);
+    parcBufferComposer_Release(&composer);
+    parcBuffer_Release(&report);
+}
+
+static bool
+_isStopping(CCNxSimpleFileTransferMetrics *metrics)
+{
+    pthread_mutex_lock(&metrics->mutex);
+    bool result = metrics->isStopping;
+    pthread_mutex_unlock(&metrics->mutex);
+    return result;
+}
+
+static void *
+_exporter_Run(void *arg)
+{
+    CCNxSimpleFileTransferMetrics *metrics = (CCNxSimpleFileTransferMetrics *) arg;
+
+    if (metrics->exportSocketPath != NULL) {
+        while (!_isStopping(metrics)) {
+            // Wake up periodically to see if we've been asked to stop.
+            struct pollfd pollEntry = { .fd = metrics->listenSocket, .events = POLLIN };
+            if (poll(&pollEntry, 1, 250) > 0) {
+                int clientSocket = accept(metrics->listenSocket, NULL, NULL);
+                if (clientSocket >= 0) {
+                    _serveReport(metrics, clientSocket);
+                    close(clientSocket);
+                }
+            }
+        }
+    } else {
+        pthread_mutex_lock(&metrics->mutex);
+        while (!metrics->isStopping) {
+            pthread_mutex_unlock(&metrics->mutex);
+            ccnxSimpleFileTransferMetrics_WriteReport(metrics, metrics->exportFileName);
+            pthread_mutex_lock(&metrics->mutex);
+
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_sec += metrics->intervalSeconds;
+            while (!metrics->isStopping
+                   && pthread_cond_timedwait(&metrics->stopSignal, &metrics->mutex, &deadline) != ETIMEDOUT) {
+                // Spurious wakeup. Keep waiting.
+            }
+        }
+        pthread_mutex_unlock(&metrics->mutex);
+    }
+
+    return NULL;
+}
+
+/**
+ * Create a Unix domain socket listening on the specified path, replacing any stale socket file.
+ *
+ * @return the listening socket, or -1 on failure.
+ */
+static int
+_createListenSocket(const char *socketPath)
+{
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    if (strlen(socketPath) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Metrics socket path '%s' is too long.\n", socketPath);
+        return -1;
+    }
+    strncpy(address.sun_path, socketPath, sizeof(address.sun_path) - 1);
+
+    int result = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (result >= 0) {
+        unlink(socketPath);
+        if (bind(result, (struct sockaddr *) &address, sizeof(address)) != 0 || listen(result, 16) != 0) {
+            fprintf(stderr, "Could not listen on metrics socket '%s': %s\n", socketPath, strerror(errno));
+            close(result);
+            result = -1;
+        }
+    }
+
+    return result;
+}
+
+bool
+ccnxSimpleFileTransferMetrics_StartExporter(CCNxSimpleFileTransferMetrics *metrics,
+                                            const char *target, unsigned int intervalSeconds)
+{
+    assertFalse(metrics->isExporting, "The metrics exporter is already running");
+
+    size_t prefixLength = strlen(_unixSocketTargetPrefix);
+    if (strncmp(target, _unixSocketTargetPrefix, prefixLength) == 0) {
+        const char *socketPath = target + prefixLength;
+        metrics->listenSocket = _createListenSocket(socketPath);
+        if (metrics->listenSocket < 0) {
+            return false;
+        }
+        metrics->exportSocketPath = parcMemory_StringDuplicate(socketPath, strlen(socketPath));
+    } else {
+        metrics->exportFileName = parcMemory_StringDuplicate(target, strlen(target));
+    }
+
+    metrics->intervalSeconds = (intervalSeconds > 0) ? intervalSeconds : 1;
+    metrics->isStopping = false;
+
+    int error = pthread_create(&metrics->exportThread, NULL, _exporter_Run, metrics);
+    assertTrue(error == 0, "pthread_create() failed: %s", strerror(error));
+
+    metrics->isExporting = true;
+
+    return true;
+}
+
+void
+ccnxSimpleFileTransferMetrics_StopExporter(CCNxSimpleFileTransferMetrics *metrics)
+{
+    if (!metrics->isExporting) {
+        return;
+    }
+
+    pthread_mutex_lock(&metrics->mutex);
+    metrics->isStopping = true;
+    pthread_cond_signal(&metrics->stopSignal);
+    pthread_mutex_unlock(&metrics->mutex);
+
+    pthread_join(metrics->exportThread, NULL);
+    metrics->isExporting = false;
+
+    if (metrics->exportFileName != NULL) {
+        // Leave the final values behind.
+        ccnxSimpleFileTransferMetrics_WriteReport(metrics, metrics->exportFileName);
+        parcMemory_Deallocate(&metrics->exportFileName);
+    }
+
+    if (metrics->exportSocketPath != NULL) {
+        close(metrics->listenSocket);
+        metrics->listenSocket = -1;
+        unlink(metrics->exportSocketPath);
+        parcMemory_Deallocate(&metrics->exportSocketPath);
+    }
+}
@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+#ifndef ccnxSimpleFileTransfer_Metrics_h
+#define ccnxSimpleFileTransfer_Metrics_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <parc/algol/parc_Buffer.h>
+
+struct ccnxSimpleFileTransfer_Metrics;
+
+/**
+ * A `CCNxSimpleFileTransferMetrics` holds the transfer-level counters and latency histograms for the
+ * client or the server. Updating a counter or a histogram is a single relaxed atomic add, so they may be
+ * updated from any thread without a lock. The values can be exported periodically, in the Prometheus
+ * text exposition format, to a file or to a Unix domain socket.
+ *
+ * Every function that updates a `CCNxSimpleFileTransferMetrics` accepts NULL and does nothing, so
+ * callers can pass a NULL instance when metrics are disabled.
+ */
+typedef struct ccnxSimpleFileTransfer_Metrics CCNxSimpleFileTransferMetrics;
+
+/**
+ * The counters we keep.
+ */
+typedef enum {
+    CCNxSimpleFileTransferMetricsCounter_InterestsReceived,
+    CCNxSimpleFileTransferMetricsCounter_ResponsesSent,
+    CCNxSimpleFileTransferMetricsCounter_CacheHits,
+    CCNxSimpleFileTransferMetricsCounter_CacheMisses,
+    CCNxSimpleFileTransferMetricsCounter_BytesSent,
+    CCNxSimpleFileTransferMetricsCounter_SendFailures,
+    CCNxSimpleFileTransferMetricsCounter_InterestsCoalesced,
+    CCNxSimpleFileTransferMetricsCounter_CacheAdmissionRejections,
+    CCNxSimpleFileTransferMetricsCounter_CacheEvictions,
+    CCNxSimpleFileTransferMetricsCounter_ContentObjectsReceived,
+    CCNxSimpleFileTransferMetricsCounter_BytesReceived,
+    CCNxSimpleFileTransferMetricsCounter_InterestsDropped,
+    CCNxSimpleFileTransferMetricsCounter_DuplicateChunks,
+    CCNxSimpleFileTransferMetricsCounter_NumCounters // Must be last
+} CCNxSimpleFileTransferMetricsCounter;
+
+/**
+ * The latency histograms we keep. Each histogram has power-of-two buckets, in nanoseconds.
+ */
+typedef enum {
+    CCNxSimpleFileTransferMetricsHistogram_DiskReadLatency,
+    CCNxSimpleFileTransferMetricsHistogram_ResponseBuildLatency,
+    CCNxSimpleFileTransferMetricsHistogram_SendLatency,
+    CCNxSimpleFileTransferMetricsHistogram_WriteLatency,
+    CCNxSimpleFileTransferMetricsHistogram_MetadataQueueLatency,
+    CCNxSimpleFileTransferMetricsHistogram_FetchQueueLatency,
+    CCNxSimpleFileTransferMetricsHistogram_NumHistograms // Must be last
+} CCNxSimpleFileTransferMetricsHistogram;
+
+/**
+ * The number of buckets in each histogram. Bucket i counts latencies less than 2^(i+1) nanoseconds
+ * that didn't fit in bucket i-1. The last bucket counts everything else.
+ */
+#define CCNxSimpleFileTransferMetrics_NumHistogramBuckets 32
+
+/**
+ * Create a new, zeroed, instance of `CCNxSimpleFileTransferMetrics`. The `role` (e.g. "server") is
+ * added as a label to every exported metric.
+ * The newly created instance must eventually be released by calling `ccnxSimpleFileTransferMetrics_Release`.
+ *
+ * @param [in] role - the name of the program the metrics describe.
+ */
+CCNxSimpleFileTransferMetrics *ccnxSimpleFileTransferMetrics_Create(const char *role);
+
+/**
+ * Increase the number of references to a `CCNxSimpleFileTransferMetrics` instance.
+ *
+ * @param [in] instance A pointer to the original `CCNxSimpleFileTransferMetrics`.
+ * @return The value of the input parameter @p instance.
+ *
+ * @see ccnxSimpleFileTransferMetrics_Release
+ */
+CCNxSimpleFileTransferMetrics *ccnxSimpleFileTransferMetrics_Acquire(const CCNxSimpleFileTransferMetrics *instance);
+
+/**
+ * Release a previously acquired reference to the specified instance,
+ * decrementing the reference count for the instance. If an exporter is running when the last
+ * reference is released, it is stopped.
+ *
+ * @param [in,out] metricsPtr A pointer to a pointer to the instance to release.
+ *
+ * @see ccnxSimpleFileTransferMetrics_Acquire
+ */
+void ccnxSimpleFileTransferMetrics_Release(CCNxSimpleFileTransferMetrics **metricsPtr);
+
+/**
+ * Add `amount` to the specified counter. Does nothing if `metrics` is NULL.
+ *
+ * @param [in] metrics - the metrics to update, or NULL.
+ * @param [in] counter - the counter to update.
+ * @param [in] amount - the amount to add.
+ */
+void ccnxSimpleFileTransferMetrics_Increment(CCNxSimpleFileTransferMetrics *metrics,
+                                             CCNxSimpleFileTransferMetricsCounter counter, uint64_t amount);
+
+/**
+ * Return the current value of the specified counter.
+ *
+ * @param [in] metrics - the metrics to query.
+ * @param [in] counter - the counter to read.
+ * @return the value of the counter.
+ */
+uint64_t ccnxSimpleFileTransferMetrics_GetCounter(const CCNxSimpleFileTransferMetrics *metrics,
+                                                  CCNxSimpleFileTransferMetricsCounter counter);
+
+/**
+ * Return a timestamp, in nanoseconds, to pass to `ccnxSimpleFileTransferMetrics_RecordLatencySince`.
+ * Returns 0 without reading the clock if `metrics` is NULL, so timing costs nothing when metrics are disabled.
+ *
+ * @param [in] metrics - the metrics that will record the latency, or NULL.
+ * @return a monotonic timestamp in nanoseconds, or 0.
+ */
+uint64_t ccnxSimpleFileTransferMetrics_StartTimer(const CCNxSimpleFileTransferMetrics *metrics);
+
+/**
+ * Record the time elapsed since `startNanos` (from `ccnxSimpleFileTransferMetrics_StartTimer`) in
+ * the specified histogram. Does nothing if `metrics` is NULL.
+ *
+ * @param [in] metrics - the metrics to update, or NULL.
+ * @param [in] histogram - the histogram to update.
+ * @param [in] startNanos - the timestamp returned by `ccnxSimpleFileTransferMetrics_StartTimer`.
+ */
+void ccnxSimpleFileTransferMetrics_RecordLatencySince(CCNxSimpleFileTransferMetrics *metrics,
+                                                      CCNxSimpleFileTransferMetricsHistogram histogram,
+                                                      uint64_t startNanos);
+
+/**
+ * Record a latency, in nanoseconds, in the specified histogram. Does nothing if `metrics` is NULL.
+ *
+ * @param [in] metrics - the metrics to update, or NULL.
+ * @param [in] histogram - the histogram to update.
+ * @param [in] nanos - the latency to record.
+ */
+void ccnxSimpleFileTransferMetrics_RecordLatency(CCNxSimpleFileTransferMetrics *metrics,
+                                                 CCNxSimpleFileTransferMetricsHistogram histogram,
+                                                 uint64_t nanos);
+
+/**
+ * Return the number of latencies recorded in the specified histogram.
+ *
+ * @param [in] metrics - the metrics to query.
+ * @param [in] histogram - the histogram to read.
+ * @return the number of latencies recorded.
+ */
+uint64_t ccnxSimpleFileTransferMetrics_GetHistogramCount(const CCNxSimpleFileTransferMetrics *metrics,
+                                                         CCNxSimpleFileTransferMetricsHistogram histogram);
+
+/**
+ * Add every counter and histogram in `batch` to `metrics`, then zero `batch`.
+ *
+ * A thread that updates the shared metrics for every message pays for a contended atomic add each
+ * time. Instead, it can record into a private batch (one created with
+ * `ccnxSimpleFileTransferMetrics_Create` and never exported) and flush it once per wakeup. Only
+ * the thread that owns `batch` may update it.
+ *
+ * @param [in,out] batch - the metrics to move. Ignored if NULL.
+ * @param [in] metrics - the metrics to add them to. Ignored if NULL.
+ */
+void ccnxSimpleFileTransferMetrics_Flush(CCNxSimpleFileTransferMetrics *batch, CCNxSimpleFileTransferMetrics *metrics);
+
+/**
+ * Return a PARCBuffer containing the current value of every counter and histogram, in the
+ * Prometheus text exposition format. The returned PARCBuffer must eventually be released by calling
+ * parcBuffer_Release().
+ *
+ * @param [in] metrics - the metrics to report.
+ * @return A PARCBuffer containing the report.
+ */
+PARCBuffer *ccnxSimpleFileTransferMetrics_CreateReport(const CCNxSimpleFileTransferMetrics *metrics);
+
+/**
+ * Write the report (see `ccnxSimpleFileTransferMetrics_CreateReport`) to the specified file. The
+ * file is replaced atomically, so a reader never sees a partial report.
+ *
+ * @param [in] metrics - the metrics to report.
+ * @param [in] fileName - the file to write.
+ * @return true if the file was written.
+ */
+bool ccnxSimpleFileTransferMetrics_WriteReport(const CCNxSimpleFileTransferMetrics *metrics, const char *fileName);
+
+/**
+ * Start a background thread that exports the metrics. If `target` starts with "unix:", the rest of it
+ * is the path of a Unix domain socket on which the report is served to each connecting client (e.g.
+ * `curl --unix-socket <path> http://localhost/metrics`). Otherwise `target` is the name of a file that
+ * is rewritten with the report every `intervalSeconds` seconds.
+ *
+ * @param [in] metrics - the metrics to export.
+ * @param [in] target - the file name, or "unix:" followed by a socket path.
+ * @param [in] intervalSeconds - how often to rewrite the file.
+ * @return true if the exporter was started.
+ */
+bool ccnxSimpleFileTransferMetrics_StartExporter(CCNxSimpleFileTransferMetrics *metrics,
+                                                 const char *target, unsigned int intervalSeconds);
+
+/**
+ * Stop the exporter started by `ccnxSimpleFileTransferMetrics_StartExporter`, if any. When exporting
+ * to a file, the file is written one final time.
+ *
+ * @param [in] metrics - the metrics being exported.
+ */
+void ccnxSimpleFileTransferMetrics_StopExporter(CCNxSimpleFileTransferMetrics *metrics);
+#endif // ccnxSimpleFileTransfer_Metrics_h
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "ccnxSimpleFileTransfer_OpenFileCache.h"
+#include "ccnxSimpleFileTransfer_FileIO.h"
+
+typedef struct openFile {
+    char *fileName;                 // NULL while the entry isn't in use.
+    uint64_t version;
+    int fileDescriptor;
+    uint64_t lastUsed;
+} _OpenFile;
+
+struct ccnxSimpleFileTransfer_OpenFileCache {
+    size_t capacity;
+    _OpenFile *files;
+    size_t numFiles;
+    uint64_t useCount;
+};
+
+static void
+_closeFile(CCNxSimpleFileTransferOpenFileCache *cache, _OpenFile *file)
+{
+    close(file->fileDescriptor);
+    parcMemory_Deallocate((void **) &file->fileName);
+    cache->numFiles--;
+}
+
+static void
+_openFileCache_Finalize(CCNxSimpleFileTransferOpenFileCache **cachePtr)
+{
+    CCNxSimpleFileTransferOpenFileCache *cache = *cachePtr;
+
+    for (size_t i = 0; i < cache->capacity; i++) {
+        if (cache->files[i].fileName != NULL) {
+            _closeFile(cache, &cache->files[i]);
+        }
+    }
+    parcMemory_Deallocate((void **) &cache->files);
+}
+
+parcObject_ExtendPARCObject(CCNxSimpleFileTransferOpenFileCache, _openFileCache_Finalize, NULL, NULL, NULL, NULL, NULL, NULL);
+
+parcObject_ImplementAcquire(ccnxSimpleFileTransferOpenFileCache, CCNxSimpleFileTransferOpenFileCache);
+
+parcObject_ImplementRelease(ccnxSimpleFileTransferOpenFileCache, CCNxSimpleFileTransferOpenFileCache);
+
+CCNxSimpleFileTransferOpenFileCache *
+ccnxSimpleFileTransferOpenFileCache_Create(size_t capacity)
+{
+    assertTrue(capacity > 0, "The capacity must be at least 1");
+
+    CCNxSimpleFileTransferOpenFileCache *result = parcObject_CreateAndClearInstance(CCNxSimpleFileTransferOpenFileCache);
+
+    result->capacity = capacity;
+    result->files = parcMemory_AllocateAndClear(capacity * sizeof(_OpenFile));
+    assertNotNull(result->files, "parcMemory_AllocateAndClear(%zu) returned NULL", capacity * sizeof(_OpenFile));
+
+    return result;
+}
+
+/**
+ * Find the open file of a version, or else the entry to open it in: an unused one, or the one used least recently.
+ */
+static _OpenFile *
+_findFile(CCNxSimpleFileTransferOpenFileCache *cache, const char *fileName, uint64_t version, bool *isOpen)
+{
+    *isOpen = false;
+    _OpenFile *result = NULL;
+    for (size_t i = 0; i < cache->capacity; i++) {
+        _OpenFile *file = &cache->files[i];
+        if (file->fileName == NULL) {
+            if (result == NULL || result->fileName != NULL) {
+                result = file;
+            }
+        } else if (file->version == version && strcmp(file->fileName, fileName) == 0) {
+            *isOpen = true;
+            return file;
+        } else if (result == NULL || (result->fileName != NULL && file->lastUsed < result->lastUsed)) {
+            result = file;
+        }
+    }
+    return result;
+}
+
+int
+ccnxSimpleFileTransferOpenFileCache_GetFile(CCNxSimpleFileTransferOpenFileCache *cache, const char *fileName,
+                                            uint64_t version, size_t *fileSize)
+{
+    bool isOpen;
+    _OpenFile *file = _findFile(cache, fileName, version, &isOpen);
+
+    if (isOpen) {
+        // Still open, but the file may have been written to since.
+        uint64_t currentVersion = 0;
+        if (ccnxSimpleFileTransferFileIO_GetOpenFileVersion(file->fileDescriptor, fileSize, &currentVersion)
+            && currentVersion == version) {
+            file->lastUsed = ++cache->useCount;
+            return file->fileDescriptor;
+        }
+        _closeFile(cache, file);
+        return -1;
+    }
+
+    int result = ccnxSimpleFileTransferFileIO_OpenVersionedFile(fileName, version, fileSize);
+    if (result >= 0) {
+        if (file->fileName != NULL) {
+            _closeFile(cache, file);
+        }
+#ifdef POSIX_FADV_SEQUENTIAL
+        // Chunks are mostly asked for in order, so have the kernel read further ahead than usual.
+        posix_fadvise(result, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        file->fileName = parcMemory_StringDuplicate(fileName, strlen(fileName));
+        file->version = version;
+        file->fileDescriptor = result;
+        file->lastUsed = ++cache->useCount;
+        cache->numFiles++;
+    }
+    return result;
+}
+
+size_t
+ccnxSimpleFileTransferOpenFileCache_GetSize(const CCNxSimpleFileTransferOpenFileCache *cache)
+{
+    return cache->numFiles;
+}
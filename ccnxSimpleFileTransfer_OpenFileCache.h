@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+#ifndef ccnxSimpleFileTransfer_OpenFileCache_h
+#define ccnxSimpleFileTransfer_OpenFileCache_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct ccnxSimpleFileTransfer_OpenFileCache;
+
+/**
+ * A `CCNxSimpleFileTransferOpenFileCache` keeps the versioned files a server is serving from disk open between
+ * chunks. Reading a chunk then costs an fstat() and a pread() on a descriptor we already have, rather than a
+ * path lookup, open(), fstat(), pread() and close(), and the kernel's read-ahead for the file is kept.
+ *
+ * Every time a file is asked for, it is checked to still be at the version asked for, as
+ * ccnxSimpleFileTransferFileIO_OpenVersionedFile() does. When the cache is full, the file used least recently is
+ * closed. It is not safe to use from more than one thread.
+ *
+ * This only saves the open() and close(). It isn't a zero-copy path: each chunk is still copied from the page
+ * cache into a payload buffer, and from there by the Portal stack when it encodes the response. Sending straight
+ * from the file (with sendfile() or splice()) would need a transport under the Portal API, which owns the
+ * connection to the forwarder and the wire encoding, and which is part of the CCNx stack, not this tree.
+ */
+typedef struct ccnxSimpleFileTransfer_OpenFileCache CCNxSimpleFileTransferOpenFileCache;
+
+/**
+ * Create a new, empty `CCNxSimpleFileTransferOpenFileCache`.
+ * The newly created instance must eventually be released by calling `ccnxSimpleFileTransferOpenFileCache_Release`.
+ *
+ * @param [in] capacity - the most files to keep open.
+ * @return A new instance.
+ */
+CCNxSimpleFileTransferOpenFileCache *ccnxSimpleFileTransferOpenFileCache_Create(size_t capacity);
+
+/**
+ * Increase the number of references to a `CCNxSimpleFileTransferOpenFileCache` instance.
+ *
+ * @param [in] instance A pointer to the original `CCNxSimpleFileTransferOpenFileCache`.
+ * @return The value of the input parameter @p instance.
+ *
+ * @see ccnxSimpleFileTransferOpenFileCache_Release
+ */
+CCNxSimpleFileTransferOpenFileCache *ccnxSimpleFileTransferOpenFileCache_Acquire(const CCNxSimpleFileTransferOpenFileCache *instance);
+
+/**
+ * Release a previously acquired reference to the specified instance,
+ * decrementing the reference count for the instance.
+ *
+ * The files still open are closed.
+ *
+ * @param [in,out] cachePtr A pointer to a pointer to the instance to release.
+ *
+ * @see ccnxSimpleFileTransferOpenFileCache_Acquire
+ */
+void ccnxSimpleFileTransferOpenFileCache_Release(CCNxSimpleFileTransferOpenFileCache **cachePtr);
+
+/**
+ * Get a descriptor open for reading a file, but only if the file is at the specified version.
+ *
+ * @param [in] cache - the cache.
+ * @param [in] fileName - the path of the file.
+ * @param [in] version - the version, from ccnxSimpleFileTransferFileIO_GetFileVersion(), the file must be at.
+ * @param [out] fileSize - set to the size of the file, in bytes.
+ * @return A file descriptor, which belongs to the cache and stays open until the next call, or -1 if the file
+ *         couldn't be opened or has changed since that version.
+ */
+int ccnxSimpleFileTransferOpenFileCache_GetFile(CCNxSimpleFileTransferOpenFileCache *cache, const char *fileName,
+                                                uint64_t version, size_t *fileSize);
+
+/**
+ * Return the number of files open.
+ */
+size_t ccnxSimpleFileTransferOpenFileCache_GetSize(const CCNxSimpleFileTransferOpenFileCache *cache);
+#endif // ccnxSimpleFileTransfer_OpenFileCache_h
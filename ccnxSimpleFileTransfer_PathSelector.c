@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "ccnxSimpleFileTransfer_PathSelector.h"
+
+/**
+ * A path on which this many Interests in a row have timed out is down.
+ */
+static const unsigned int _maxConsecutiveTimeouts = 3;
+
+/**
+ * The round trip time taken for a path before any has been measured on any path. Its value doesn't matter, as
+ * long as it's the same for every path.
+ */
+static const uint64_t _unmeasuredRttMicros = 1000;
+
+/**
+ * A timed out path's round trip time is doubled, but not beyond this.
+ */
+static const uint64_t _maxRttMicros = 60 * 1000 * 1000;
+
+typedef struct pathSelectorPath {
+    size_t numOutstanding;
+    uint64_t smoothedRttMicros;         // 0 until measured.
+    unsigned int numConsecutiveTimeouts;
+    uint64_t numChunksReceived;
+    uint64_t numBytesReceived;
+    uint64_t numTimeouts;
+} _PathSelectorPath;
+
+typedef struct pathSelectorChunk {
+    uint64_t chunkNumber;
+    uint64_t sentAtMicros;              // When the latest Interest for it was sent.
+    uint32_t path;                      // The path the latest Interest for it was sent on.
+    bool isOutstanding;
+    bool isResent;
+} _PathSelectorChunk;
+
+struct ccnxSimpleFileTransfer_PathSelector {
+    size_t numPaths;
+    _PathSelectorPath *paths;
+
+    size_t maxSpan;
+    _PathSelectorChunk *chunks;         // Indexed by chunk number, modulo the span.
+};
+
+static void
+_pathSelector_Finalize(CCNxSimpleFileTransferPathSelector **selectorPtr)
+{
+    CCNxSimpleFileTransferPathSelector *selector = *selectorPtr;
+
+    parcMemory_Deallocate((void **) &selector->chunks);
+    parcMemory_Deallocate((void **) &selector->paths);
+}
+
+parcObject_ExtendPARCObject(CCNxSimpleFileTransferPathSelector, _pathSelector_Finalize, NULL, NULL, NULL, NULL, NULL, NULL);
+
+parcObject_ImplementAcquire(ccnxSimpleFileTransferPathSelector, CCNxSimpleFileTransferPathSelector);
+
+parcObject_ImplementRelease(ccnxSimpleFileTransferPathSelector, CCNxSimpleFileTransferPathSelector);
+
+CCNxSimpleFileTransferPathSelector *
+ccnxSimpleFileTransferPathSelector_Create(size_t numPaths, size_t maxSpan)
+{
+    assertTrue(numPaths > 0 && numPaths <= UINT32_MAX, "There must be from 1 to %u paths", UINT32_MAX);
+    assertTrue(maxSpan > 0, "The span must be greater than zero");
+
+    CCNxSimpleFileTransferPathSelector *result = parcObject_CreateAndClearInstance(CCNxSimpleFileTransferPathSelector);
+
+    result->numPaths = numPaths;
+    result->paths = parcMemory_AllocateAndClear(numPaths * sizeof(_PathSelectorPath));
+    assertNotNull(result->paths, "parcMemory_AllocateAndClear(%zu) returned NULL", numPaths * sizeof(_PathSelectorPath));
+
+    result->maxSpan = maxSpan;
+    result->chunks = parcMemory_AllocateAndClear(maxSpan * sizeof(_PathSelectorChunk));
+    assertNotNull(result->chunks, "parcMemory_AllocateAndClear(%zu) returned NULL", maxSpan * sizeof(_PathSelectorChunk));
+
+    return result;
+}
+
+static bool
+_isPathUp(const _PathSelectorPath *path)
+{
+    return path->numConsecutiveTimeouts < _maxConsecutiveTimeouts;
+}
+
+/**
+ * The round trip time to expect on a path. One that hasn't been measured is taken to be as fast as the fastest
+ * that has, so it's tried.
+ */
+static uint64_t
+_getExpectedRttMicros(const CCNxSimpleFileTransferPathSelector *selector, size_t path)
+{
+    if (selector->paths[path].smoothedRttMicros != 0) {
+        return selector->paths[path].smoothedRttMicros;
+    }
+
+    uint64_t result = 0;
+    for (size_t i = 0; i < selector->numPaths; i++) {
+        uint64_t rttMicros = selector->paths[i].smoothedRttMicros;
+        if (rttMicros != 0 && (result == 0 || rttMicros < result)) {
+            result = rttMicros;
+        }
+    }
+    return (result != 0) ? result : _unmeasuredRttMicros;
+}
+
+static void
+_timeOut(CCNxSimpleFileTransferPathSelector *selector, size_t path)
+{
+    uint64_t rttMicros = 2 * _getExpectedRttMicros(selector, path);
+
+    _PathSelectorPath *timedOutPath = &selector->paths[path];
+    timedOutPath->numOutstanding--;
+    timedOutPath->numTimeouts++;
+    timedOutPath->numConsecutiveTimeouts++;
+    timedOutPath->smoothedRttMicros = (rttMicros < _maxRttMicros) ? rttMicros : _maxRttMicros;
+}
+
+/**
+ * Return a path that is down and has no Interest outstanding, to probe, or numPaths if there is none.
+ */
+static size_t
+_selectPathToProbe(const CCNxSimpleFileTransferPathSelector *selector)
+{
+    for (size_t i = 0; i < selector->numPaths; i++) {
+        if (!_isPathUp(&selector->paths[i]) && selector->paths[i].numOutstanding == 0) {
+            return i;
+        }
+    }
+    return selector->numPaths;
+}
+
+/**
+ * Return the path expected to answer an Interest sent on it now first, other than the excluded path. A path
+ * that is down is only chosen if every other path is too.
+ */
+static size_t
+_selectFastestPath(const CCNxSimpleFileTransferPathSelector *selector, size_t excludedPath)
+{
+    size_t result = 0;
+    bool isFound = false;
+    bool isResultUp = false;
+    uint64_t resultCost = 0;
+
+    for (size_t i = 0; i < selector->numPaths; i++) {
+        const _PathSelectorPath *path = &selector->paths[i];
+        if (i == excludedPath) {
+            continue;
+        }
+
+        bool isUp = _isPathUp(path);
+        uint64_t cost = (path->numOutstanding + 1) * _getExpectedRttMicros(selector, i);
+        if (!isFound || (isUp && !isResultUp) || (isUp == isResultUp && cost < resultCost)) {
+            result = i;
+            isFound = true;
+            isResultUp = isUp;
+            resultCost = cost;
+        }
+    }
+
+    return isFound ? result : excludedPath;
+}
+
+size_t
+ccnxSimpleFileTransferPathSelector_SelectPath(CCNxSimpleFileTransferPathSelector *selector, uint64_t chunkNumber,
+                                              uint64_t nowMicros)
+{
+    _PathSelectorChunk *chunk = &selector->chunks[chunkNumber % selector->maxSpan];
+
+    size_t excludedPath = selector->numPaths; // None.
+    bool isResent = chunk->isOutstanding && chunk->chunkNumber == chunkNumber;
+    if (isResent) {
+        _timeOut(selector, chunk->path);
+        excludedPath = chunk->path;
+    }
+
+    // A new chunk probes a path that is down, to find out when it comes back. A chunk sent again goes on the
+    // fastest path, so it isn't held up any longer.
+    size_t result = isResent ? selector->numPaths : _selectPathToProbe(selector);
+    if (result == selector->numPaths) {
+        result = _selectFastestPath(selector, excludedPath);
+    }
+
+    chunk->chunkNumber = chunkNumber;
+    chunk->sentAtMicros = nowMicros;
+    chunk->path = (uint32_t) result;
+    chunk->isOutstanding = true;
+    chunk->isResent = isResent;
+    selector->paths[result].numOutstanding++;
+
+    return result;
+}
+
+void
+ccnxSimpleFileTransferPathSelector_Receive(CCNxSimpleFileTransferPathSelector *selector, uint64_t chunkNumber,
+                                           size_t path, size_t numBytes, uint64_t nowMicros)
+{
+    assertTrue(path < selector->numPaths, "There is no path %zu", path);
+
+    _PathSelectorPath *arrivalPath = &selector->paths[path];
+    bool hasTimedOut = (arrivalPath->numConsecutiveTimeouts > 0);
+    arrivalPath->numChunksReceived++;
+    arrivalPath->numBytesReceived += numBytes;
+    arrivalPath->numConsecutiveTimeouts = 0;
+
+    _PathSelectorChunk *chunk = &selector->chunks[chunkNumber % selector->maxSpan];
+    if (chunk->isOutstanding && chunk->chunkNumber == chunkNumber) {
+        selector->paths[chunk->path].numOutstanding--;
+        chunk->isOutstanding = false;
+
+        // As in Karn's algorithm, a chunk asked for more than once may be answering any of its Interests.
+        if (!chunk->isResent && chunk->path == path && nowMicros >= chunk->sentAtMicros) {
+            uint64_t rttMicros = nowMicros - chunk->sentAtMicros;
+            // A path that has timed out has had its round trip time doubled, which no longer holds.
+            if (arrivalPath->smoothedRttMicros == 0 || hasTimedOut) {
+                arrivalPath->smoothedRttMicros = rttMicros;
+            } else {
+                arrivalPath->smoothedRttMicros = (7 * arrivalPath->smoothedRttMicros + rttMicros) / 8;
+            }
+        }
+    }
+}
+
+size_t
+ccnxSimpleFileTransferPathSelector_GetNumPaths(const CCNxSimpleFileTransferPathSelector *selector)
+{
+    return selector->numPaths;
+}
+
+bool
+ccnxSimpleFileTransferPathSelector_IsPathUp(const CCNxSimpleFileTransferPathSelector *selector, size_t path)
+{
+    return _isPathUp(&selector->paths[path]);
+}
+
+size_t
+ccnxSimpleFileTransferPathSelector_GetNumOutstanding(const CCNxSimpleFileTransferPathSelector *selector, size_t path)
+{
+    return selector->paths[path].numOutstanding;
+}
+
+uint64_t
+ccnxSimpleFileTransferPathSelector_GetNumChunksReceived(const CCNxSimpleFileTransferPathSelector *selector, size_t path)
+{
+    return selector->paths[path].numChunksReceived;
+}
+
+uint64_t
+ccnxSimpleFileTransferPathSelector_GetNumBytesReceived(const CCNxSimpleFileTransferPathSelector *selector, size_t path)
+{
+    return selector->paths[path].numBytesReceived;
+}
+
+uint64_t
+ccnxSimpleFileTransferPathSelector_GetNumTimeouts(const CCNxSimpleFileTransferPathSelector *selector, size_t path)
+{
+    return selector->paths[path].numTimeouts;
+}
+
+uint64_t
+ccnxSimpleFileTransferPathSelector_GetSmoothedRttMicros(const CCNxSimpleFileTransferPathSelector *selector, size_t path)
+{
+    return selector->paths[path].smoothedRttMicros;
+}
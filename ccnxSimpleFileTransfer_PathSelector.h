@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+#ifndef ccnxSimpleFileTransfer_PathSelector_h
+#define ccnxSimpleFileTransfer_PathSelector_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct ccnxSimpleFileTransfer_PathSelector;
+
+/**
+ * A `CCNxSimpleFileTransferPathSelector` decides which of several paths to the same file (e.g. replicas of it
+ * served under different prefixes) to send each chunk's Interest on, so one fetch uses all of them at once. Like
+ * a CCNxSimpleFileTransferFetchWindow, it doesn't send or receive anything itself: the caller asks it for the
+ * path of each Interest it sends, and tells it which path each chunk arrives on.
+ *
+ * Each Interest goes on the path expected to answer it first: the one with the least `(outstanding + 1) * RTT`,
+ * from the number of Interests outstanding on it and its smoothed round trip time. As a path's Interests queue
+ * up, its round trip time grows, so the Interests outstanding on each path settle in proportion to the
+ * throughput it delivers.
+ *
+ * A chunk asked for again is taken to have timed out on the path it was last sent on. It's sent on another
+ * path, and the timed out path's round trip time is doubled, so it's given fewer Interests. A path on which
+ * several Interests in a row have timed out is down: it's given one Interest at a time, as a probe, until one
+ * arrives on it.
+ *
+ * The paths are numbered from 0.
+ */
+typedef struct ccnxSimpleFileTransfer_PathSelector CCNxSimpleFileTransferPathSelector;
+
+/**
+ * Create a new `CCNxSimpleFileTransferPathSelector`.
+ * The newly created instance must eventually be released by calling `ccnxSimpleFileTransferPathSelector_Release`.
+ *
+ * @param [in] numPaths - the number of paths. At least 1.
+ * @param [in] maxSpan - the span of the fetch window: no two chunks outstanding at once are this far apart.
+ * @return A new instance.
+ */
+CCNxSimpleFileTransferPathSelector *ccnxSimpleFileTransferPathSelector_Create(size_t numPaths, size_t maxSpan);
+
+/**
+ * Increase the number of references to a `CCNxSimpleFileTransferPathSelector` instance.
+ *
+ * @param [in] instance A pointer to the original `CCNxSimpleFileTransferPathSelector`.
+ * @return The value of the input parameter @p instance.
+ *
+ * @see ccnxSimpleFileTransferPathSelector_Release
+ */
+CCNxSimpleFileTransferPathSelector *ccnxSimpleFileTransferPathSelector_Acquire(const CCNxSimpleFileTransferPathSelector *instance);
+
+/**
+ * Release a previously acquired reference to the specified instance,
+ * decrementing the reference count for the instance.
+ *
+ * @param [in,out] selectorPtr A pointer to a pointer to the instance to release.
+ *
+ * @see ccnxSimpleFileTransferPathSelector_Acquire
+ */
+void ccnxSimpleFileTransferPathSelector_Release(CCNxSimpleFileTransferPathSelector **selectorPtr);
+
+/**
+ * Choose the path to send an Interest for a chunk on, now. If the chunk has already been sent and hasn't
+ * arrived, its Interest is taken to have timed out on the path it was sent on, and another path is chosen.
+ *
+ * @param [in] selector - the path selector.
+ * @param [in] chunkNumber - the chunk being sent.
+ * @param [in] nowMicros - the current time, in microseconds from any fixed point.
+ * @return The path to send the Interest on.
+ */
+size_t ccnxSimpleFileTransferPathSelector_SelectPath(CCNxSimpleFileTransferPathSelector *selector, uint64_t chunkNumber,
+                                                     uint64_t nowMicros);
+
+/**
+ * Note that a chunk has arrived on a path, which may not be the one it was last sent on.
+ *
+ * @param [in] selector - the path selector.
+ * @param [in] chunkNumber - the chunk that arrived.
+ * @param [in] path - the path it arrived on.
+ * @param [in] numBytes - its size.
+ * @param [in] nowMicros - the current time, in microseconds from any fixed point.
+ */
+void ccnxSimpleFileTransferPathSelector_Receive(CCNxSimpleFileTransferPathSelector *selector, uint64_t chunkNumber,
+                                                size_t path, size_t numBytes, uint64_t nowMicros);
+
+/**
+ * Return the number of paths.
+ */
+size_t ccnxSimpleFileTransferPathSelector_GetNumPaths(const CCNxSimpleFileTransferPathSelector *selector);
+
+/**
+ * Return whether a path is up: whether fewer than a few Interests in a row have timed out on it.
+ */
+bool ccnxSimpleFileTransferPathSelector_IsPathUp(const CCNxSimpleFileTransferPathSelector *selector, size_t path);
+
+/**
+ * Return the number of Interests outstanding on a path.
+ */
+size_t ccnxSimpleFileTransferPathSelector_GetNumOutstanding(const CCNxSimpleFileTransferPathSelector *selector, size_t path);
+
+/**
+ * Return the number of chunks that have arrived on a path.
+ */
+uint64_t ccnxSimpleFileTransferPathSelector_GetNumChunksReceived(const CCNxSimpleFileTransferPathSelector *selector, size_t path);
+
+/**
+ * Return the number of bytes that have arrived on a path.
+ */
+uint64_t ccnxSimpleFileTransferPathSelector_GetNumBytesReceived(const CCNxSimpleFileTransferPathSelector *selector, size_t path);
+
+/**
+ * Return the number of Interests that have timed out on a path.
+ */
+uint64_t ccnxSimpleFileTransferPathSelector_GetNumTimeouts(const CCNxSimpleFileTransferPathSelector *selector, size_t path);
+
+/**
+ * Return the smoothed round trip time of a path, in microseconds, or 0 if none has been measured.
+ */
+uint64_t ccnxSimpleFileTransferPathSelector_GetSmoothedRttMicros(const CCNxSimpleFileTransferPathSelector *selector, size_t path);
+
+#endif // ccnxSimpleFileTransfer_PathSelector_h
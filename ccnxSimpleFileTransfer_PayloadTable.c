@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <string.h>
+#include <pthread.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "ccnxSimpleFileTransfer_PayloadTable.h"
+
+/**
+ * The number of hash buckets a new table starts with. It doubles as payloads are added.
+ */
+static const size_t _initialNumBuckets = 1024;
+
+typedef struct payloadEntry {
+    PARCBuffer *payload;
+    uint64_t hash;
+    struct payloadEntry *next;  // The next entry in the same bucket.
+} _PayloadEntry;
+
+struct ccnxSimpleFileTransfer_PayloadTable {
+    pthread_mutex_t mutex;
+    _PayloadEntry **buckets;
+    size_t numBuckets;          // Always a power of 2.
+    size_t numEntries;
+};
+
+static void
+_freeEntry(_PayloadEntry **entryPtr)
+{
+    parcBuffer_Release(&(*entryPtr)->payload);
+    parcMemory_Deallocate((void **) entryPtr);
+}
+
+static void
+_payloadTable_Finalize(CCNxSimpleFileTransferPayloadTable **tablePtr)
+{
+    CCNxSimpleFileTransferPayloadTable *table = *tablePtr;
+
+    for (size_t i = 0; i < table->numBuckets; i++) {
+        while (table->buckets[i] != NULL) {
+            _PayloadEntry *entry = table->buckets[i];
+            table->buckets[i] = entry->next;
+            _freeEntry(&entry);
+        }
+    }
+    parcMemory_Deallocate((void **) &table->buckets);
+
+    pthread_mutex_destroy(&table->mutex);
+}
+
+parcObject_ExtendPARCObject(CCNxSimpleFileTransferPayloadTable, _payloadTable_Finalize, NULL, NULL, NULL, NULL, NULL, NULL);
+
+parcObject_ImplementAcquire(ccnxSimpleFileTransferPayloadTable, CCNxSimpleFileTransferPayloadTable);
+
+parcObject_ImplementRelease(ccnxSimpleFileTransferPayloadTable, CCNxSimpleFileTransferPayloadTable);
+
+static _PayloadEntry **
+_allocateBuckets(size_t numBuckets)
+{
+    _PayloadEntry **result = parcMemory_AllocateAndClear(numBuckets * sizeof(_PayloadEntry *));
+    assertNotNull(result, "parcMemory_AllocateAndClear(%zu) returned NULL", numBuckets * sizeof(_PayloadEntry *));
+    return result;
+}
+
+CCNxSimpleFileTransferPayloadTable *
+ccnxSimpleFileTransferPayloadTable_Create(void)
+{
+    CCNxSimpleFileTransferPayloadTable *result = parcObject_CreateAndClearInstance(CCNxSimpleFileTransferPayloadTable);
+
+    pthread_mutex_init(&result->mutex, NULL);
+    result->numBuckets = _initialNumBuckets;
+    result->buckets = _allocateBuckets(result->numBuckets);
+
+    return result;
+}
+
+/**
+ * The 64 bit FNV-1a hash of a payload's bytes.
+ */
+static uint64_t
+_hashPayload(const PARCBuffer *payload)
+{
+    const uint8_t *bytes = parcBuffer_Overlay((PARCBuffer *) payload, 0);
+    size_t length = parcBuffer_Remaining(payload);
+
+    uint64_t result = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; i++) {
+        result = (result ^ bytes[i]) * 1099511628211ULL;
+    }
+    return result;
+}
+
+/**
+ * Forget the payloads that only the table still references.
+ */
+static void
+_removeUnused(CCNxSimpleFileTransferPayloadTable *table)
+{
+    for (size_t i = 0; i < table->numBuckets; i++) {
+        _PayloadEntry **link = &table->buckets[i];
+        while (*link != NULL) {
+            _PayloadEntry *entry = *link;
+            if (parcObject_GetReferenceCount(entry->payload) == 1) {
+                *link = entry->next;
+                _freeEntry(&entry);
+                table->numEntries--;
+            } else {
+                link = &entry->next;
+            }
+        }
+    }
+}
+
+/**
+ * Make room for another entry. When the table is as full as it has buckets, the unused payloads are forgotten
+ * first, and the buckets are only doubled if that doesn't free at least half of them.
+ */
+static void
+_makeRoom(CCNxSimpleFileTransferPayloadTable *table)
+{
+    if (table->numEntries < table->numBuckets) {
+        return;
+    }
+
+    _removeUnused(table);
+    if (table->numEntries < table->numBuckets / 2) {
+        return;
+    }
+
+    size_t numBuckets = table->numBuckets * 2;
+    _PayloadEntry **buckets = _allocateBuckets(numBuckets);
+    for (size_t i = 0; i < table->numBuckets; i++) {
+        while (table->buckets[i] != NULL) {
+            _PayloadEntry *entry = table->buckets[i];
+            table->buckets[i] = entry->next;
+            entry->next = buckets[entry->hash & (numBuckets - 1)];
+            buckets[entry->hash & (numBuckets - 1)] = entry;
+        }
+    }
+    parcMemory_Deallocate((void **) &table->buckets);
+    table->buckets = buckets;
+    table->numBuckets = numBuckets;
+}
+
+PARCBuffer *
+ccnxSimpleFileTransferPayloadTable_Intern(CCNxSimpleFileTransferPayloadTable *table, PARCBuffer *payload)
+{
+    uint64_t hash = _hashPayload(payload);
+    PARCBuffer *result = NULL;
+
+    pthread_mutex_lock(&table->mutex);
+
+    for (_PayloadEntry *entry = table->buckets[hash & (table->numBuckets - 1)]; entry != NULL; entry = entry->next) {
+        if (entry->hash == hash && parcBuffer_Equals(entry->payload, payload)) {
+            result = parcBuffer_Acquire(entry->payload);
+            break;
+        }
+    }
+
+    if (result == NULL) {
+        _makeRoom(table);
+
+        _PayloadEntry *entry = parcMemory_AllocateAndClear(sizeof(_PayloadEntry));
+        assertNotNull(entry, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(_PayloadEntry));
+        entry->payload = parcBuffer_Acquire(payload);
+        entry->hash = hash;
+        entry->next = table->buckets[hash & (table->numBuckets - 1)];
+        table->buckets[hash & (table->numBuckets - 1)] = entry;
+        table->numEntries++;
+
+        result = parcBuffer_Acquire(payload);
+    }
+
+    pthread_mutex_unlock(&table->mutex);
+
+    return result;
+}
+
+void
+ccnxSimpleFileTransferPayloadTable_GetUsage(CCNxSimpleFileTransferPayloadTable *table, uint64_t *bytesUsed,
+                                            uint64_t *bytesStored)
+{
+    *bytesUsed = 0;
+    *bytesStored = 0;
+
+    pthread_mutex_lock(&table->mutex);
+    for (size_t i = 0; i < table->numBuckets; i++) {
+        for (_PayloadEntry *entry = table->buckets[i]; entry != NULL; entry = entry->next) {
+            // Every reference but the table's is a chunk using the payload.
+            uint64_t numUsers = parcObject_GetReferenceCount(entry->payload) - 1;
+            if (numUsers > 0) {
+                uint64_t length = parcBuffer_Remaining(entry->payload);
+                *bytesUsed += numUsers * length;
+                *bytesStored += length;
+            }
+        }
+    }
+    pthread_mutex_unlock(&table->mutex);
+}
+
+size_t
+ccnxSimpleFileTransferPayloadTable_GetSize(CCNxSimpleFileTransferPayloadTable *table)
+{
+    pthread_mutex_lock(&table->mutex);
+    size_t result = table->numEntries;
+    pthread_mutex_unlock(&table->mutex);
+
+    return result;
+}
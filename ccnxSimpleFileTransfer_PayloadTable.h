@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+#ifndef ccnxSimpleFileTransfer_PayloadTable_h
+#define ccnxSimpleFileTransfer_PayloadTable_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <parc/algol/parc_Buffer.h>
+
+struct ccnxSimpleFileTransfer_PayloadTable;
+
+/**
+ * A `CCNxSimpleFileTransferPayloadTable` lets the pre-chunked files held in memory share one copy of each distinct
+ * chunk payload: the chunks that files have in common, such as the layers of build artifacts, the headers of logs,
+ * or the unchanged parts of another version of a file.
+ *
+ * A payload is looked up by a hash of its bytes, and only shared with one whose bytes are the same. The table
+ * keeps a reference to each payload it has, and forgets it once that is the last reference left: when every
+ * chunk it was the payload of has been evicted. It is safe to use from more than one thread.
+ */
+typedef struct ccnxSimpleFileTransfer_PayloadTable CCNxSimpleFileTransferPayloadTable;
+
+/**
+ * Create a new, empty `CCNxSimpleFileTransferPayloadTable`.
+ * The newly created instance must eventually be released by calling `ccnxSimpleFileTransferPayloadTable_Release`.
+ *
+ * @return A new instance.
+ */
+CCNxSimpleFileTransferPayloadTable *ccnxSimpleFileTransferPayloadTable_Create(void);
+
+/**
+ * Increase the number of references to a `CCNxSimpleFileTransferPayloadTable` instance.
+ *
+ * @param [in] instance A pointer to the original `CCNxSimpleFileTransferPayloadTable`.
+ * @return The value of the input parameter @p instance.
+ *
+ * @see ccnxSimpleFileTransferPayloadTable_Release
+ */
+CCNxSimpleFileTransferPayloadTable *ccnxSimpleFileTransferPayloadTable_Acquire(const CCNxSimpleFileTransferPayloadTable *instance);
+
+/**
+ * Release a previously acquired reference to the specified instance,
+ * decrementing the reference count for the instance.
+ *
+ * The payloads in the table stay valid until their last reference is released.
+ *
+ * @param [in,out] tablePtr A pointer to a pointer to the instance to release.
+ *
+ * @see ccnxSimpleFileTransferPayloadTable_Acquire
+ */
+void ccnxSimpleFileTransferPayloadTable_Release(CCNxSimpleFileTransferPayloadTable **tablePtr);
+
+/**
+ * Return the payload in the table with the same bytes as the specified one, or else add the specified payload to
+ * the table and return it. The payload must not be modified once it's been added.
+ * The returned PARCBuffer must eventually be released by calling parcBuffer_Release().
+ *
+ * @param [in] table - the table.
+ * @param [in] payload - the payload, from its position to its limit.
+ * @return A reference to the payload to use in its place.
+ */
+PARCBuffer *ccnxSimpleFileTransferPayloadTable_Intern(CCNxSimpleFileTransferPayloadTable *table, PARCBuffer *payload);
+
+/**
+ * Measure how much the sharing saves. A payload used by more than one chunk counts once towards the bytes stored
+ * and once per chunk towards the bytes used.
+ *
+ * @param [in] table - the table.
+ * @param [out] bytesUsed - set to the total length of the payloads of the chunks held in memory.
+ * @param [out] bytesStored - set to the total length of the distinct payloads they share.
+ */
+void ccnxSimpleFileTransferPayloadTable_GetUsage(CCNxSimpleFileTransferPayloadTable *table, uint64_t *bytesUsed,
+                                                 uint64_t *bytesStored);
+
+/**
+ * Return the number of distinct payloads in the table.
+ */
+size_t ccnxSimpleFileTransferPayloadTable_GetSize(CCNxSimpleFileTransferPayloadTable *table);
+#endif // ccnxSimpleFileTransfer_PayloadTable_h
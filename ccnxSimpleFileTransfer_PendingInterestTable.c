@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <inttypes.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "ccnxSimpleFileTransfer_PendingInterestTable.h"
+
+/**
+ * Marks the end of a bucket's chain, or of the free list.
+ */
+static const uint32_t _noEntry = UINT32_MAX;
+
+struct ccnxSimpleFileTransfer_PendingInterestTable {
+    size_t capacity;
+    CCNxSimpleFileTransferPendingInterest *entries; // All of them, in use or free.
+    uint32_t freeEntries;                           // The first free entry, chained through their 'next'.
+    size_t numEntries;
+
+    uint32_t *buckets;                              // The first entry of each bucket, chained through their 'next'.
+    uint64_t bucketMask;
+
+    CCNxSimpleFileTransferTimerWheel *timeouts;
+};
+
+static void
+_pendingInterestTable_Finalize(CCNxSimpleFileTransferPendingInterestTable **tablePtr)
+{
+    CCNxSimpleFileTransferPendingInterestTable *table = *tablePtr;
+
+    ccnxSimpleFileTransferTimerWheel_Release(&table->timeouts);
+    parcMemory_Deallocate((void **) &table->buckets);
+    parcMemory_Deallocate((void **) &table->entries);
+}
+
+parcObject_ExtendPARCObject(CCNxSimpleFileTransferPendingInterestTable, _pendingInterestTable_Finalize,
+                            NULL, NULL, NULL, NULL, NULL, NULL);
+
+parcObject_ImplementAcquire(ccnxSimpleFileTransferPendingInterestTable, CCNxSimpleFileTransferPendingInterestTable);
+
+parcObject_ImplementRelease(ccnxSimpleFileTransferPendingInterestTable, CCNxSimpleFileTransferPendingInterestTable);
+
+CCNxSimpleFileTransferPendingInterestTable *
+ccnxSimpleFileTransferPendingInterestTable_Create(size_t capacity, uint64_t tickMicros, uint64_t nowMicros)
+{
+    assertTrue(capacity > 0 && capacity < _noEntry, "The capacity must be from 1 to %u", _noEntry - 1);
+
+    CCNxSimpleFileTransferPendingInterestTable *result =
+        parcObject_CreateAndClearInstance(CCNxSimpleFileTransferPendingInterestTable);
+
+    result->capacity = capacity;
+    result->entries = parcMemory_AllocateAndClear(capacity * sizeof(CCNxSimpleFileTransferPendingInterest));
+    assertNotNull(result->entries, "parcMemory_AllocateAndClear(%zu) returned NULL",
+                  capacity * sizeof(CCNxSimpleFileTransferPendingInterest));
+    for (size_t i = 0; i < capacity; i++) {
+        result->entries[i].next = (i + 1 < capacity) ? (uint32_t) (i + 1) : _noEntry;
+    }
+    result->freeEntries = 0;
+
+    size_t numBuckets = 1;
+    while (numBuckets < capacity) {
+        numBuckets <<= 1;
+    }
+    result->buckets = parcMemory_Allocate(numBuckets * sizeof(uint32_t));
+    assertNotNull(result->buckets, "parcMemory_Allocate(%zu) returned NULL", numBuckets * sizeof(uint32_t));
+    for (size_t i = 0; i < numBuckets; i++) {
+        result->buckets[i] = _noEntry;
+    }
+    result->bucketMask = numBuckets - 1;
+
+    result->timeouts = ccnxSimpleFileTransferTimerWheel_Create(tickMicros, nowMicros);
+
+    return result;
+}
+
+/**
+ * The bucket of a chunk. The chunks outstanding at once are mostly consecutive, so their low bits alone spread
+ * them evenly over the buckets, and neighbouring chunks' buckets are neighbours in memory.
+ */
+static uint32_t *
+_getBucket(const CCNxSimpleFileTransferPendingInterestTable *table, uint64_t chunkNumber)
+{
+    return &table->buckets[chunkNumber & table->bucketMask];
+}
+
+CCNxSimpleFileTransferPendingInterest *
+ccnxSimpleFileTransferPendingInterestTable_Insert(CCNxSimpleFileTransferPendingInterestTable *table, uint64_t chunkNumber)
+{
+    if (table->freeEntries == _noEntry) {
+        return NULL;
+    }
+
+    uint32_t index = table->freeEntries;
+    CCNxSimpleFileTransferPendingInterest *result = &table->entries[index];
+    table->freeEntries = result->next;
+
+    uint32_t *bucket = _getBucket(table, chunkNumber);
+    ccnxSimpleFileTransferTimer_Init(&result->timer);
+    result->chunkNumber = chunkNumber;
+    result->sentAtMicros = 0;
+    result->numTransmissions = 0;
+    result->next = *bucket;
+    *bucket = index;
+    table->numEntries++;
+
+    return result;
+}
+
+CCNxSimpleFileTransferPendingInterest *
+ccnxSimpleFileTransferPendingInterestTable_Get(const CCNxSimpleFileTransferPendingInterestTable *table, uint64_t chunkNumber)
+{
+    for (uint32_t index = *_getBucket(table, chunkNumber); index != _noEntry; index = table->entries[index].next) {
+        if (table->entries[index].chunkNumber == chunkNumber) {
+            return &table->entries[index];
+        }
+    }
+    return NULL;
+}
+
+void
+ccnxSimpleFileTransferPendingInterestTable_Remove(CCNxSimpleFileTransferPendingInterestTable *table,
+                                                  CCNxSimpleFileTransferPendingInterest *entry)
+{
+    uint32_t index = (uint32_t) (entry - table->entries);
+    assertTrue(index < table->capacity, "The entry isn't in this table");
+
+    uint32_t *link = _getBucket(table, entry->chunkNumber);
+    while (*link != index) {
+        assertTrue(*link != _noEntry, "The entry for chunk %" PRIu64 " isn't in the table", entry->chunkNumber);
+        link = &table->entries[*link].next;
+    }
+    *link = entry->next;
+
+    ccnxSimpleFileTransferTimerWheel_Cancel(table->timeouts, &entry->timer);
+    entry->next = table->freeEntries;
+    table->freeEntries = index;
+    table->numEntries--;
+}
+
+void
+ccnxSimpleFileTransferPendingInterestTable_SetTimeout(CCNxSimpleFileTransferPendingInterestTable *table,
+                                                      CCNxSimpleFileTransferPendingInterest *entry, uint64_t timeoutMicros)
+{
+    ccnxSimpleFileTransferTimerWheel_Schedule(table->timeouts, &entry->timer, timeoutMicros);
+}
+
+CCNxSimpleFileTransferPendingInterest *
+ccnxSimpleFileTransferPendingInterestTable_TakeTimedOut(CCNxSimpleFileTransferPendingInterestTable *table, uint64_t nowMicros)
+{
+    // The timer is the first member of its entry.
+    return (CCNxSimpleFileTransferPendingInterest *) ccnxSimpleFileTransferTimerWheel_TakeExpired(table->timeouts, nowMicros);
+}
+
+uint64_t
+ccnxSimpleFileTransferPendingInterestTable_GetNextTimeoutMicros(const CCNxSimpleFileTransferPendingInterestTable *table)
+{
+    return ccnxSimpleFileTransferTimerWheel_GetNextExpiryMicros(table->timeouts);
+}
+
+size_t
+ccnxSimpleFileTransferPendingInterestTable_GetSize(const CCNxSimpleFileTransferPendingInterestTable *table)
+{
+    return table->numEntries;
+}
+
+size_t
+ccnxSimpleFileTransferPendingInterestTable_GetCapacity(const CCNxSimpleFileTransferPendingInterestTable *table)
+{
+    return table->capacity;
+}
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+#ifndef ccnxSimpleFileTransfer_PendingInterestTable_h
+#define ccnxSimpleFileTransfer_PendingInterestTable_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ccnxSimpleFileTransfer_TimerWheel.h"
+
+struct ccnxSimpleFileTransfer_PendingInterestTable;
+
+/**
+ * A `CCNxSimpleFileTransferPendingInterestTable` holds a consumer's outstanding Interests, one per chunk, each
+ * with the time it times out. Adding, finding, removing and timing out an Interest each cost the same however
+ * many are outstanding, e.g. for a window of a hundred thousand.
+ *
+ * The entries are kept in a single array, allocated when the table is created, and found by chunk number
+ * through a hash table of indexes into it. Their timeouts are kept in a CCNxSimpleFileTransferTimerWheel.
+ */
+typedef struct ccnxSimpleFileTransfer_PendingInterestTable CCNxSimpleFileTransferPendingInterestTable;
+
+/**
+ * An outstanding Interest. The caller may use `sentAtMicros` and `numTransmissions` as it likes; the other fields
+ * belong to the table.
+ */
+typedef struct ccnxSimpleFileTransfer_PendingInterest {
+    CCNxSimpleFileTransferTimer timer;
+    uint64_t chunkNumber;
+    uint64_t sentAtMicros;
+    unsigned int numTransmissions;
+    uint32_t next;
+} CCNxSimpleFileTransferPendingInterest;
+
+/**
+ * Create a new, empty `CCNxSimpleFileTransferPendingInterestTable`.
+ * The newly created instance must eventually be released by calling `ccnxSimpleFileTransferPendingInterestTable_Release`.
+ *
+ * @param [in] capacity - the most Interests the table can hold.
+ * @param [in] tickMicros - how late an Interest may time out (see CCNxSimpleFileTransferTimerWheel).
+ * @param [in] nowMicros - the current time, in microseconds from any fixed point.
+ * @return A new instance.
+ */
+CCNxSimpleFileTransferPendingInterestTable *ccnxSimpleFileTransferPendingInterestTable_Create(size_t capacity,
+                                                                                            uint64_t tickMicros,
+                                                                                            uint64_t nowMicros);
+
+/**
+ * Increase the number of references to a `CCNxSimpleFileTransferPendingInterestTable` instance.
+ *
+ * @param [in] instance A pointer to the original `CCNxSimpleFileTransferPendingInterestTable`.
+ * @return The value of the input parameter @p instance.
+ *
+ * @see ccnxSimpleFileTransferPendingInterestTable_Release
+ */
+CCNxSimpleFileTransferPendingInterestTable *ccnxSimpleFileTransferPendingInterestTable_Acquire(
+    const CCNxSimpleFileTransferPendingInterestTable *instance);
+
+/**
+ * Release a previously acquired reference to the specified instance,
+ * decrementing the reference count for the instance.
+ *
+ * @param [in,out] tablePtr A pointer to a pointer to the instance to release.
+ *
+ * @see ccnxSimpleFileTransferPendingInterestTable_Acquire
+ */
+void ccnxSimpleFileTransferPendingInterestTable_Release(CCNxSimpleFileTransferPendingInterestTable **tablePtr);
+
+/**
+ * Add an Interest for a chunk that isn't in the table yet. It has no timeout until one is set.
+ *
+ * @param [in] table - the table.
+ * @param [in] chunkNumber - the chunk the Interest asks for.
+ * @return The new entry, with `sentAtMicros` and `numTransmissions` set to 0, or NULL if the table is full.
+ *         It belongs to the table, and stays valid until it's removed.
+ */
+CCNxSimpleFileTransferPendingInterest *ccnxSimpleFileTransferPendingInterestTable_Insert(
+    CCNxSimpleFileTransferPendingInterestTable *table, uint64_t chunkNumber);
+
+/**
+ * Find the Interest for a chunk.
+ *
+ * @param [in] table - the table.
+ * @param [in] chunkNumber - the chunk.
+ * @return The entry, or NULL if there's no Interest for the chunk in the table.
+ */
+CCNxSimpleFileTransferPendingInterest *ccnxSimpleFileTransferPendingInterestTable_Get(
+    const CCNxSimpleFileTransferPendingInterestTable *table, uint64_t chunkNumber);
+
+/**
+ * Remove an Interest from the table, e.g. because its chunk has arrived, and cancel its timeout.
+ *
+ * @param [in] table - the table.
+ * @param [in] entry - an entry in the table, which is no longer valid afterwards.
+ */
+void ccnxSimpleFileTransferPendingInterestTable_Remove(CCNxSimpleFileTransferPendingInterestTable *table,
+                                                       CCNxSimpleFileTransferPendingInterest *entry);
+
+/**
+ * Set when an Interest times out, replacing any timeout it had.
+ *
+ * @param [in] table - the table.
+ * @param [in] entry - an entry in the table.
+ * @param [in] timeoutMicros - when it times out.
+ */
+void ccnxSimpleFileTransferPendingInterestTable_SetTimeout(CCNxSimpleFileTransferPendingInterestTable *table,
+                                                           CCNxSimpleFileTransferPendingInterest *entry,
+                                                           uint64_t timeoutMicros);
+
+/**
+ * Take an Interest that has timed out by the given time. It stays in the table, with no timeout, until it's
+ * removed or given a new one. Call this until it returns NULL to take all of them.
+ *
+ * @param [in] table - the table.
+ * @param [in] nowMicros - the current time, which must not be earlier than in previous calls.
+ * @return An entry that has timed out, or NULL if none has.
+ */
+CCNxSimpleFileTransferPendingInterest *ccnxSimpleFileTransferPendingInterestTable_TakeTimedOut(
+    CCNxSimpleFileTransferPendingInterestTable *table, uint64_t nowMicros);
+
+/**
+ * Return the earliest time at which an Interest may time out.
+ *
+ * @param [in] table - the table.
+ * @return The time, which may already have passed, or UINT64_MAX if no Interest has a timeout.
+ */
+uint64_t ccnxSimpleFileTransferPendingInterestTable_GetNextTimeoutMicros(const CCNxSimpleFileTransferPendingInterestTable *table);
+
+/**
+ * Return the number of Interests in the table.
+ */
+size_t ccnxSimpleFileTransferPendingInterestTable_GetSize(const CCNxSimpleFileTransferPendingInterestTable *table);
+
+/**
+ * Return the most Interests the table can hold.
+ */
+size_t ccnxSimpleFileTransferPendingInterestTable_GetCapacity(const CCNxSimpleFileTransferPendingInterestTable *table);
+#endif // ccnxSimpleFileTransfer_PendingInterestTable_h
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <stdio.h>
+#include <unistd.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "ccnxSimpleFileTransfer_ReorderBuffer.h"
+
+struct ccnxSimpleFileTransfer_ReorderBuffer {
+    size_t windowSize;
+    size_t count;
+    uint64_t nextChunkNumber;
+    PARCBuffer **slots;     // Chunk N is held in slot (N % windowSize).
+};
+
+static void
+_reorderBuffer_Finalize(CCNxSimpleFileTransferReorderBuffer **reorderBufferPtr)
+{
+    CCNxSimpleFileTransferReorderBuffer *reorderBuffer = *reorderBufferPtr;
+
+    for (size_t i = 0; i < reorderBuffer->windowSize; i++) {
+        if (reorderBuffer->slots[i] != NULL) {
+            parcBuffer_Release(&reorderBuffer->slots[i]);
+        }
+    }
+
+    parcMemory_Deallocate(&reorderBuffer->slots);
+}
+
+parcObject_ExtendPARCObject(CCNxSimpleFileTransferReorderBuffer,
+                            _reorderBuffer_Finalize,
+                            NULL, NULL, NULL, NULL, NULL, NULL);
+
+parcObject_ImplementAcquire(ccnxSimpleFileTransferReorderBuffer, CCNxSimpleFileTransferReorderBuffer);
+
+parcObject_ImplementRelease(ccnxSimpleFileTransferReorderBuffer, CCNxSimpleFileTransferReorderBuffer);
+
+CCNxSimpleFileTransferReorderBuffer *
+ccnxSimpleFileTransferReorderBuffer_Create(size_t windowSize)
+{
+    assertTrue(windowSize > 0, "windowSize must be greater than 0");
+
+    CCNxSimpleFileTransferReorderBuffer *result = parcObject_CreateAndClearInstance(CCNxSimpleFileTransferReorderBuffer);
+
+    size_t sizeNeeded = windowSize * sizeof(PARCBuffer *);
+    result->slots = parcMemory_AllocateAndClear(sizeNeeded);
+    assertNotNull(result->slots, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeNeeded);
+
+    result->windowSize = windowSize;
+    result->count = 0;
+    result->nextChunkNumber = 0;
+
+    return result;
+}
+
+bool
+ccnxSimpleFileTransferReorderBuffer_Put(CCNxSimpleFileTransferReorderBuffer *reorderBuffer,
+                                        uint64_t chunkNumber, const PARCBuffer *payload)
+{
+    if (chunkNumber < reorderBuffer->nextChunkNumber) {
+        return true; // Already delivered. A duplicate.
+    }
+
+    if (chunkNumber - reorderBuffer->nextChunkNumber >= reorderBuffer->windowSize) {
+        return false; // Too far ahead. It would overwrite a slot we still need.
+    }
+
+    size_t slot = chunkNumber % reorderBuffer->windowSize;
+    if (reorderBuffer->slots[slot] == NULL) {
+        reorderBuffer->slots[slot] = parcBuffer_Acquire(payload);
+        reorderBuffer->count++;
+    }
+
+    return true;
+}
+
+PARCBuffer *
+ccnxSimpleFileTransferReorderBuffer_TakeNext(CCNxSimpleFileTransferReorderBuffer *reorderBuffer)
+{
+    size_t slot = reorderBuffer->nextChunkNumber % reorderBuffer->windowSize;
+
+    PARCBuffer *result = reorderBuffer->slots[slot];
+    if (result != NULL) {
+        // Hand our reference to the caller.
+        reorderBuffer->slots[slot] = NULL;
+        reorderBuffer->count--;
+        reorderBuffer->nextChunkNumber++;
+    }
+
+    return result;
+}
+
+uint64_t
+ccnxSimpleFileTransferReorderBuffer_GetNextChunkNumber(const CCNxSimpleFileTransferReorderBuffer *reorderBuffer)
+{
+    return reorderBuffer->nextChunkNumber;
+}
+
+size_t
+ccnxSimpleFileTransferReorderBuffer_GetCount(const CCNxSimpleFileTransferReorderBuffer *reorderBuffer)
+{
+    return reorderBuffer->count;
+}
+
+size_t
+ccnxSimpleFileTransferReorderBuffer_GetWindowSize(const CCNxSimpleFileTransferReorderBuffer *reorderBuffer)
+{
+    return reorderBuffer->windowSize;
+}
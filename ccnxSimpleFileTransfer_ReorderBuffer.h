@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+#ifndef ccnxSimpleFileTransfer_ReorderBuffer_h
+#define ccnxSimpleFileTransfer_ReorderBuffer_h
+
+#include <parc/algol/parc_Buffer.h>
+
+struct ccnxSimpleFileTransfer_ReorderBuffer;
+
+/**
+ * A `CCNxSimpleFileTransferReorderBuffer` holds chunk payloads that arrive out of order until all of
+ * the chunks before them have arrived, so they can be written to a sequential sink (e.g. a pipe)
+ * in chunk order. It holds at most `windowSize` chunks, starting at the next chunk to be delivered.
+ */
+typedef struct ccnxSimpleFileTransfer_ReorderBuffer CCNxSimpleFileTransferReorderBuffer;
+
+/**
+ * Create a new instance of `CCNxSimpleFileTransferReorderBuffer` that can hold up to `windowSize`
+ * chunks. The first chunk it delivers is chunk 0.
+ * The newly created instance must eventually be released by calling `ccnxSimpleFileTransferReorderBuffer_Release`.
+ *
+ * @param [in] windowSize - the maximum number of chunks to hold.
+ */
+CCNxSimpleFileTransferReorderBuffer *ccnxSimpleFileTransferReorderBuffer_Create(size_t windowSize);
+
+/**
+ * Increase the number of references to a `CCNxSimpleFileTransferReorderBuffer` instance.
+ *
+ * @param [in] instance A pointer to the original `CCNxSimpleFileTransferReorderBuffer`.
+ * @return The value of the input parameter @p instance.
+ *
+ * @see ccnxSimpleFileTransferReorderBuffer_Release
+ */
+CCNxSimpleFileTransferReorderBuffer *ccnxSimpleFileTransferReorderBuffer_Acquire(
+    const CCNxSimpleFileTransferReorderBuffer *instance);
+
+/**
+ * Release a previously acquired reference to the specified instance,
+ * decrementing the reference count for the instance. Any payloads still held are released.
+ *
+ * @param [in,out] reorderBufferPtr A pointer to a pointer to the instance to release.
+ *
+ * @see ccnxSimpleFileTransferReorderBuffer_Acquire
+ */
+void ccnxSimpleFileTransferReorderBuffer_Release(CCNxSimpleFileTransferReorderBuffer **reorderBufferPtr);
+
+/**
+ * Hold the payload of the specified chunk until it can be delivered in order. The reorder buffer
+ * acquires a reference to the payload. Chunks that have already been delivered, or are already held,
+ * are ignored.
+ *
+ * @param [in] reorderBuffer - the reorder buffer.
+ * @param [in] chunkNumber - the number of the chunk the payload belongs to.
+ * @param [in] payload - the payload of the chunk.
+ *
+ * @return true if the chunk was accepted (or was a duplicate).
+ * @return false if the chunk is too far ahead of the next chunk to be delivered to fit in the window.
+ */
+bool ccnxSimpleFileTransferReorderBuffer_Put(CCNxSimpleFileTransferReorderBuffer *reorderBuffer,
+                                             uint64_t chunkNumber, const PARCBuffer *payload);
+
+/**
+ * If the next chunk in order has arrived, remove it from the reorder buffer and return it.
+ * The returned PARCBuffer must eventually be released by calling parcBuffer_Release().
+ *
+ * @param [in] reorderBuffer - the reorder buffer.
+ *
+ * @return the payload of the next chunk in order, or NULL if it hasn't arrived yet.
+ */
+PARCBuffer *ccnxSimpleFileTransferReorderBuffer_TakeNext(CCNxSimpleFileTransferReorderBuffer *reorderBuffer);
+
+/**
+ * Return the number of the next chunk that `ccnxSimpleFileTransferReorderBuffer_TakeNext` will deliver.
+ * This is also the number of chunks delivered so far.
+ *
+ * @param [in] reorderBuffer - the reorder buffer.
+ * @return the number of the next chunk to be delivered.
+ */
+uint64_t ccnxSimpleFileTransferReorderBuffer_GetNextChunkNumber(const CCNxSimpleFileTransferReorderBuffer *reorderBuffer);
+
+/**
+ * Return the number of chunks currently held, waiting for earlier chunks to arrive.
+ *
+ * @param [in] reorderBuffer - the reorder buffer.
+ * @return the number of chunks held.
+ */
+size_t ccnxSimpleFileTransferReorderBuffer_GetCount(const CCNxSimpleFileTransferReorderBuffer *reorderBuffer);
+
+/**
+ * Return the maximum number of chunks the reorder buffer can hold.
+ *
+ * @param [in] reorderBuffer - the reorder buffer.
+ * @return the window size the reorder buffer was created with.
+ */
+size_t ccnxSimpleFileTransferReorderBuffer_GetWindowSize(const CCNxSimpleFileTransferReorderBuffer *reorderBuffer);
+#endif // ccnxSimpleFileTransfer_ReorderBuffer_h
@@ -57,16 +57,37 @@
  * @copyright (c) 2014-2015, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
  */
 
+#define _GNU_SOURCE // For pthread_setaffinity_np()
+
 #include <strings.h>
+#include <string.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/time.h>
 
 #include "ccnxSimpleFileTransfer_Common.h"
 #include "ccnxSimpleFileTransfer_FileIO.h"
 #include "ccnxSimpleFileTransfer_ChunkList.h"
-
-#include <parc/algol/parc_HashMap.h>
+#include "ccnxSimpleFileTransfer_Metrics.h"
+#include "ccnxSimpleFileTransfer_Trace.h"
+#include "ccnxSimpleFileTransfer_EventLoop.h"
+#include "ccnxSimpleFileTransfer_InFlightTable.h"
+#include "ccnxSimpleFileTransfer_ChunkCache.h"
+#include "ccnxSimpleFileTransfer_CacheWarmer.h"
+#include "ccnxSimpleFileTransfer_ChunkStore.h"
+#include "ccnxSimpleFileTransfer_BlockSignatures.h"
+#include "ccnxSimpleFileTransfer_ChunkDigests.h"
+#include "ccnxSimpleFileTransfer_Compressor.h"
+#include "ccnxSimpleFileTransfer_FairQueue.h"
+#include "ccnxSimpleFileTransfer_OpenFileCache.h"
+#include "ccnxSimpleFileTransfer_BufferPool.h"
+#include "ccnxSimpleFileTransfer_PayloadTable.h"
 
 #include <ccnx/api/ccnx_Portal/ccnx_PortalRTA.h>
 
@@ -78,10 +99,180 @@ typedef struct serverState {
     size_t chunkSize;
     char *sourceDirectoryPath;
     bool doPreChunkIntoMemory;
+    size_t cacheCapacityBytes;              // The most each Portal's pre-chunked files may add up to. 0 for no limit.
     bool beVerbose;
+    char *metricsTarget;                    // Where to export metrics, or NULL.
+    CCNxSimpleFileTransferMetrics *metrics; // NULL unless metrics are being exported.
+    char *traceFileName;                    // Where to write the event trace, or NULL.
+    unsigned int numPortals;                // The number of Portals, each with its own thread, to serve from.
+    bool shardByFileName;                   // Whether each Portal serves only its share of the files.
+    int aggregationMillis;                  // How long built responses are shared with identical Interests. -1 to not share.
+    CCNxSimpleFileTransferInFlightTable *inFlightTable; // Shared by all Portals. NULL unless aggregating Interests.
+    char *warmListPath;                     // The files to pre-chunk at startup, saved again at shutdown. May be NULL.
+    uint64_t warmBytesPerSecond;            // The most the warming threads may read per second. 0 for no limit.
+    char *chunkStorePath;                   // Where to keep the signed chunks of pre-chunked files, or NULL.
+    CCNxSimpleFileTransferChunkStore *chunkStore; // NULL unless keeping signed chunks on disk.
+    PARCSigner *chunkSigner;                // Signs the chunks put in the chunk store.
+    uint64_t classBytesPerSecond;           // How fast each class of Interests may be answered. 0 for no limit.
+    CCNxSimpleFileTransferPayloadTable *payloadTable; // Shared by all Portals. NULL unless pre-chunking.
+
+    // Each Portal has its own copy of the state, with the following set for that Portal.
+    unsigned int shardNumber;
+    CCNxSimpleFileTransferChunkCache *chunkCache; // Pre-chunked files, when doPreChunkIntoMemory is set.
+    CCNxSimpleFileTransferChunkCache *signatureCache; // The block signatures of recently requested file versions.
+    CCNxSimpleFileTransferChunkCache *digestCache; // The chunk digests of recently requested file versions.
+    CCNxSimpleFileTransferChunkCache *codecCache; // The codec chosen for each recently compressed file version.
+    CCNxSimpleFileTransferCompressor *compressor; // Compresses the chunks this Portal serves from disk.
+    CCNxSimpleFileTransferOpenFileCache *openFiles; // The file versions this Portal serves from disk, kept open.
+    CCNxSimpleFileTransferBufferPool *payloadPool; // The buffers this Portal reads chunks from disk into. NULL when aggregating.
 } ServerState;
 
-static PARCHashMap *_contentByFilename = NULL;
+/**
+ * The most responses we hold for a Portal that can't take them yet. While it is full, we stop reading
+ * Interests from the Portal, so a slow send pushes back on the forwarder rather than growing the queue.
+ */
+static const size_t _sendQueueCapacity = 256;
+
+/**
+ * The most Interests we hold, sorted into classes, before answering them. Answering them from here in fair order
+ * rather than as they arrive keeps a bulk fetch from making the Interests of everyone else wait behind its window.
+ */
+static const size_t _interestQueueCapacity = 1024;
+
+/**
+ * The priorities Interests are answered in. Metadata is small, and is what a user is waiting on, so it is answered
+ * ahead of the chunks of files.
+ */
+typedef enum {
+    _InterestPriority_Metadata,     // 'list', 'stat', 'sums' and 'digests'.
+    _InterestPriority_Bulk,         // 'fetch' and 'zfetch'.
+    _InterestPriority_NumPriorities // Must be last
+} _InterestPriority;
+
+/**
+ * How many metadata Interests may be answered in a row while chunks of files are waiting. A steady stream of
+ * metadata therefore still leaves the fetches a share of the answers.
+ */
+static const size_t _maxBulkPassedOver = 16;
+
+/**
+ * How many queued Interests we answer before checking for more arriving, so that one arriving for a quiet class
+ * is queued, and answered in its turn, without waiting for all the Interests already queued to be answered.
+ */
+static const size_t _answerBatchSize = 8;
+
+/**
+ * Roughly what a response costs to send beyond its payload, in bytes. Each answered Interest is charged this,
+ * so that even Interests with little or no response take their turn.
+ */
+static const size_t _responseOverheadBytes = 100;
+
+/**
+ * How often Interests held back by their class's rate limit are looked at again, when rates are limited.
+ */
+static const uint64_t _rateLimitPeriodMillis = 10;
+
+/**
+ * Roughly how many different files we expect to be requested in a while. It sizes the admission filter
+ * that decides which files are popular enough to pre-chunk when the cache is limited.
+ */
+static const size_t _admissionFilterExpectedFiles = 1024;
+
+/**
+ * The most each Portal's cached block signatures may add up to. At 20 bytes per chunk, this is enough for
+ * the signatures of about 4 GB of files at the default chunk size.
+ */
+static const size_t _signatureCacheCapacityBytes = 64 * 1024 * 1024;
+
+/**
+ * The most each Portal's cached chunk digests may add up to. At 32 bytes per chunk, this is enough for the
+ * digests of about 2.5 GB of files at the default chunk size.
+ */
+static const size_t _digestCacheCapacityBytes = 64 * 1024 * 1024;
+
+/**
+ * The most entries in each Portal's cache of the codecs chosen for files, counting each as _codecCacheEntrySize.
+ */
+static const size_t _codecCacheCapacityBytes = 1024 * 1024;
+static const size_t _codecCacheEntrySize = 64;
+
+/**
+ * The most file versions each Portal keeps open to serve chunks from disk. A file being fetched stays open
+ * while no more than this many others are being fetched at the same time.
+ */
+static const size_t _openFileCacheCapacity = 16;
+
+/**
+ * The most chunk buffers each Portal keeps for reading chunks from disk into: enough for a full send queue, and
+ * the responses the Portal's stack is still sending.
+ */
+static const size_t _payloadPoolCapacity = 320;
+
+/**
+ * Added to a cache key for the compressed chunks of a version of a file, e.g. "file.txt/1234/z". A file name
+ * can't contain '/', so it can't be mistaken for the key of another file.
+ */
+static const char *_compressedCacheKeySuffix = "/z";
+
+/**
+ * The number of threads pre-chunking the files in the warm list.
+ */
+static const unsigned int _numWarmingThreads = 2;
+
+/**
+ * How long, in milliseconds, a response to a 'stat' command may be kept by caches on the way to the client.
+ */
+static const uint64_t _statResponseLifetimeMillis = 1000;
+
+/**
+ * How often each Portal's event loop does its housekeeping.
+ */
+static const uint64_t _housekeepingPeriodMillis = 100;
+
+/**
+ * The signal handler writes to this pipe to stop every Portal's event loop.
+ */
+static int _stopPipe[2] = { -1, -1 };
+
+typedef struct queuedResponse {
+    CCNxMetaMessage *message;
+    size_t payloadSize;
+    uint64_t sendStartTime;     // When the batch that answered it started, from ccnxSimpleFileTransferMetrics_StartTimer().
+} _QueuedResponse;
+
+/**
+ * The event loop answering the Interests arriving on one Portal.
+ */
+typedef struct serverLoop {
+    const ServerState *serverState;
+    CCNxPortal *portal;
+    int portalFileDescriptor;
+    CCNxSimpleFileTransferEventLoop *eventLoop;
+
+    _QueuedResponse *sendQueue;     // A ring of the responses the Portal hasn't taken yet.
+    size_t sendQueueHead;
+    size_t sendQueueLength;
+
+    CCNxSimpleFileTransferFairQueue *interestQueue; // The Interests received but not yet answered.
+
+    // What this loop has counted since its last wakeup, added to the server's metrics when it goes back to
+    // waiting, so that the Portals' loops don't contend for the shared counters on every message.
+    // NULL unless metrics are being exported.
+    CCNxSimpleFileTransferMetrics *metrics;
+    uint64_t answerBatchStartTime;  // From ccnxSimpleFileTransferMetrics_StartTimer(), read once per answer batch.
+
+    bool result;                    // Whether we have responded to at least one Interest.
+} _ServerLoop;
+
+/**
+ * One of the server's Portals, and the thread that answers its Interests.
+ */
+typedef struct serverShard {
+    ServerState state;
+    CCNxPortal *portal;
+    pthread_t thread;
+    bool result;
+} _ServerShard;
 
 /**
  * Create a new CCNxPortalFactory instance using a randomly generated identity saved to
@@ -115,6 +306,20 @@ _getNumberOfChunksRequired(uint64_t dataLength, size_t chunkSize)
     return (chunks == 0) ? 1 : chunks;
 }
 
+/**
+ * Same as _getFinalChunkNumberOfFile(), but for a file whose size is already known.
+ */
+static u_int64_t
+_getFinalChunkNumberForFileSize(size_t fileSize, size_t chunkSize)
+{
+    uint64_t totalNumberOfChunksInFile = _getNumberOfChunksRequired(fileSize, chunkSize);
+
+    // If the file size == 0, the the final chunk number is 0. Else, it's one less
+    // than the number of chunks in the file.
+
+    return totalNumberOfChunksInFile > 0 ? (totalNumberOfChunksInFile - 1) : 0;
+}
+
 /**
  * Given the full path to a file, calculate and return the number of the final chunk in the file.
  * The final chunk nunber is a function of the size of the file and the specified chunk size. It
@@ -128,13 +333,7 @@ _getNumberOfChunksRequired(uint64_t dataLength, size_t chunkSize)
 static u_int64_t
 _getFinalChunkNumberOfFile(const char *filePath, size_t chunkSize)
 {
-    size_t fileSize = ccnxSimpleFileTransferFileIO_GetFileSize(filePath);
-    uint64_t totalNumberOfChunksInFile = _getNumberOfChunksRequired(fileSize, chunkSize);
-
-    // If the file size == 0, the the final chunk number is 0. Else, it's one less
-    // than the number of chunks in the file.
-
-    return totalNumberOfChunksInFile > 0 ? (totalNumberOfChunksInFile - 1) : 0;
+    return _getFinalChunkNumberForFileSize(ccnxSimpleFileTransferFileIO_GetFileSize(filePath), chunkSize);
 }
 
 /**
@@ -154,29 +353,298 @@ _createContentObject(const CCNxName *name, const PARCBuffer *payload, const uint
 {
     // In the call below, we are un-const'ing name for ccnxContentObject_CreateWithNameAndPayload()
     // but we will not be changing it.
+    uint64_t traceStartTime = ccnxSimpleFileTransferTrace_Begin();
+
     CCNxContentObject *result = ccnxContentObject_CreateWithNameAndPayload((CCNxName *) name, payload);
     ccnxContentObject_SetFinalChunkNumber(result, finalChunkNumber);
 
+    ccnxSimpleFileTransferTrace_End(CCNxSimpleFileTransferTraceEvent_Build, traceStartTime);
+
+    return result;
+}
+
+/**
+ * Create a CCNxContentObject from its wire format, e.g. as kept in the chunk store. It keeps the wire format,
+ * so the Portal sends it as it is, rather than encoding and signing it again.
+ * The new CCNxContentObject must eventually be released by calling ccnxContentObject_Release().
+ *
+ * @return The new CCNxContentObject, or NULL if the wire format isn't a valid Content Object.
+ */
+static CCNxContentObject *
+_createContentObjectFromWireFormat(PARCBuffer *wireFormat)
+{
+    CCNxContentObject *result = NULL;
+
+    CCNxMetaMessage *message = ccnxMetaMessage_CreateFromWireFormatBuffer(wireFormat);
+    if (message != NULL) {
+        if (ccnxMetaMessage_IsContentObject(message)) {
+            result = ccnxContentObject_Acquire(ccnxMetaMessage_GetContentObject(message));
+        }
+        ccnxMetaMessage_Release(&message);
+    }
+
+    return result;
+}
+
+/**
+ * Encode and sign a chunk, and append it to a new segment of the chunk store. Return the chunk as it was
+ * stored, which is sent already signed, just as it will be when served from the store after a restart.
+ * If it can't be stored, the segment is abandoned and the chunk itself is returned.
+ *
+ * @param [in] contentObject - the chunk, which is released.
+ *
+ * @return The chunk to send, which must eventually be released by calling ccnxContentObject_Release().
+ */
+static CCNxContentObject *
+_storeContentObject(const ServerState *serverState, CCNxSimpleFileTransferChunkStoreSegment *segment,
+                    CCNxContentObject *contentObject)
+{
+    CCNxContentObject *result = NULL;
+
+    CCNxMetaMessage *message = ccnxMetaMessage_CreateFromContentObject(contentObject);
+    PARCBuffer *wireFormat = ccnxMetaMessage_CreateWireFormatBuffer(message, serverState->chunkSigner);
+    ccnxMetaMessage_Release(&message);
+
+    if (wireFormat != NULL) {
+        if (ccnxSimpleFileTransferChunkStoreSegment_AppendChunk(segment, wireFormat)) {
+            result = _createContentObjectFromWireFormat(wireFormat);
+        }
+        parcBuffer_Release(&wireFormat);
+    }
+
+    if (result != NULL) {
+        ccnxContentObject_Release(&contentObject);
+    } else {
+        result = contentObject;
+    }
+    return result;
+}
+
+/**
+ * Build the chunks of a file from its segment in the chunk store, without reading or signing the file.
+ *
+ * @return A new CCNxSimpleFileTransferChunkList, or NULL if the segment is damaged or the warmer was stopped.
+ */
+static CCNxSimpleFileTransferChunkList *
+_loadStoredChunks(const ServerState *serverState, char *fullFilePath, CCNxSimpleFileTransferChunkStoreSegment *segment,
+                  CCNxSimpleFileTransferCacheWarmer *warmer)
+{
+    uint64_t numChunks = ccnxSimpleFileTransferChunkStoreSegment_GetNumChunks(segment);
+    CCNxSimpleFileTransferChunkList *result = ccnxSimpleFileTransferChunkList_Create(fullFilePath, numChunks);
+
+    for (uint64_t i = 0; i < numChunks && result != NULL; i++) {
+        uint64_t readStartTime = ccnxSimpleFileTransferMetrics_StartTimer(serverState->metrics);
+        uint64_t traceStartTime = ccnxSimpleFileTransferTrace_Begin();
+        PARCBuffer *wireFormat = ccnxSimpleFileTransferChunkStoreSegment_GetChunk(segment, i);
+        ccnxSimpleFileTransferTrace_End(CCNxSimpleFileTransferTraceEvent_DiskRead, traceStartTime);
+        ccnxSimpleFileTransferMetrics_RecordLatencySince(serverState->metrics,
+                                                         CCNxSimpleFileTransferMetricsHistogram_DiskReadLatency,
+                                                         readStartTime);
+
+        CCNxContentObject *contentObject = NULL;
+        size_t length = 0;
+        if (wireFormat != NULL) {
+            length = parcBuffer_Remaining(wireFormat);
+            contentObject = _createContentObjectFromWireFormat(wireFormat);
+            parcBuffer_Release(&wireFormat);
+        }
+
+        if (contentObject != NULL) {
+            ccnxSimpleFileTransferChunkList_SetChunk(result, i, contentObject);
+            ccnxContentObject_Release(&contentObject);
+
+            if (warmer != NULL && !ccnxSimpleFileTransferCacheWarmer_Pace(warmer, length)) {
+                ccnxSimpleFileTransferChunkList_Release(&result); // The server is stopping.
+            }
+        } else {
+            printf("## !! ## The stored chunks of %s are damaged. Re-chunking it. ## !! ##\n", fullFilePath);
+            ccnxSimpleFileTransferChunkList_Release(&result);
+        }
+    }
+
+    if (result != NULL) {
+        printf("## Loaded the %" PRIu64 " stored chunks of %s into memory.\n", numChunks, fullFilePath);
+    }
+    return result;
+}
+
+/**
+ * Decide which codec to compress a file's chunks with, from a sample of the file at the given version, or at its
+ * current version if the version is 0.
+ */
+static CCNxSimpleFileTransferCodec
+_selectCodecForFile(const ServerState *serverState, CCNxSimpleFileTransferCompressor *compressor,
+                    const char *fullFilePath, uint64_t version)
+{
+    CCNxSimpleFileTransferCodec result = CCNxSimpleFileTransferCodec_None;
+
+    size_t fileSize = 0;
+    if (version != 0 || ccnxSimpleFileTransferFileIO_GetFileVersion(fullFilePath, &fileSize, &version)) {
+        int fd = ccnxSimpleFileTransferFileIO_OpenVersionedFile(fullFilePath, version, &fileSize);
+        if (fd >= 0) {
+            result = ccnxSimpleFileTransferCompressor_SelectCodecForFile(compressor, fd, fileSize, serverState->chunkSize);
+            close(fd);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Say how much memory the pre-chunked files of the directory we serve save by sharing identical payloads.
+ */
+static void
+_reportPayloadSharing(const ServerState *serverState)
+{
+    if (serverState->payloadTable != NULL) {
+        uint64_t bytesUsed = 0;
+        uint64_t bytesStored = 0;
+        ccnxSimpleFileTransferPayloadTable_GetUsage(serverState->payloadTable, &bytesUsed, &bytesStored);
+        if (bytesStored > 0) {
+            printf("## The pre-chunked files of %s hold %" PRIu64 " bytes of payloads in %" PRIu64 " bytes (%.2fx).\n",
+                   serverState->sourceDirectoryPath, bytesUsed, bytesStored, (double) bytesUsed / (double) bytesStored);
+        }
+    }
+}
+
+/**
+ * If a chunk of an open file lies in a hole of the file, return it framed as a compressed chunk of zeros, without
+ * reading it. Otherwise, or if holes can't be found on this system, return NULL, and the chunk must be read.
+ *
+ * Only a compressed chunk can say it is all zeros: a plain 'fetch' payload is the chunk's bytes as they are.
+ */
+static PARCBuffer *
+_encodeChunkIfHole(int fileDescriptor, size_t fileSize, size_t chunkSize, uint64_t chunkNumber)
+{
+    PARCBuffer *result = NULL;
+
+    uint64_t offset = chunkSize * chunkNumber;
+    if (offset < fileSize) {
+        size_t chunkLength = (fileSize - offset < chunkSize) ? fileSize - offset : chunkSize;
+        if (ccnxSimpleFileTransferFileIO_IsHole(fileDescriptor, offset, chunkLength)) {
+            result = ccnxSimpleFileTransferCompressor_EncodeZeros(chunkLength);
+        }
+    }
+
     return result;
 }
 
+/**
+ * Read a file and build all of its chunks.
+ *
+ * With a chunk store, the chunks are loaded from the file's segment in the store if it is up to date. Otherwise
+ * they are signed as they are built and saved in a new segment. Compressed chunks are not stored.
+ *
+ * @param [in] version - if not 0, the version of the file to chunk. Every chunk is read from that version, so if
+ *                       the file is at another version, or changes while it's being read, nothing is returned.
+ * @param [in] isCompressed - true to compress each chunk with the codec chosen for the file.
+ * @param [in] warmer - if not NULL, the file is being pre-chunked in the background, and its reads are paced by
+ *                      the warmer. NULL if a client is waiting for it.
+ *
+ * @return A new CCNxSimpleFileTransferChunkList, or NULL if the file couldn't be read, isn't at the requested
+ *         version, or the warmer was stopped.
+ */
 CCNxSimpleFileTransferChunkList *
-_chunkFileIntoMemory(char *fullFilePath, const CCNxName *baseName, size_t chunkSize)
+_chunkFileIntoMemory(const ServerState *serverState, const char *fileName, char *fullFilePath, const CCNxName *baseName,
+                     uint64_t version, bool isCompressed, CCNxSimpleFileTransferCacheWarmer *warmer)
 {
+    size_t chunkSize = serverState->chunkSize;
     CCNxSimpleFileTransferChunkList *result = NULL;
 
-    printf("## Pre-chunking %s into memory...\n", fullFilePath);
+    char *baseNameString = NULL;
+    if (serverState->chunkStore != NULL && !isCompressed) {
+        baseNameString = ccnxName_ToString(baseName);
+
+        CCNxSimpleFileTransferChunkStoreSegment *storedSegment =
+            ccnxSimpleFileTransferChunkStore_OpenSegment(serverState->chunkStore, fileName, fullFilePath, baseNameString,
+                                                         chunkSize);
+        if (storedSegment != NULL) {
+            result = _loadStoredChunks(serverState, fullFilePath, storedSegment, warmer);
+            ccnxSimpleFileTransferChunkStoreSegment_Release(&storedSegment);
+        }
+    }
+
+    size_t fileSize = 0;
+    uint64_t currentVersion = 0;
+
+    if (result != NULL) {
+        // Loaded from the chunk store. Its segment is only valid while the file is unchanged, and was named
+        // for the version that was chunked, so it is the requested version.
+    } else if (!ccnxSimpleFileTransferFileIO_GetFileVersion(fullFilePath, &fileSize, &currentVersion)) {
+        //trapUnexpectedState("Could not open file %s for chunking.", fullFilePath);
+
+        printf("## !! ## Could not access requested file [%s]. Could not pre-chunk. ## !! ##\n", fullFilePath);
+    } else if (version != 0 && version != currentVersion) {
+        printf("## %s has changed since the requested version. Not pre-chunking it.\n", fullFilePath);
+    } else {
+        // The file exists and is accessible, so build its ContentObject responses.
+        printf("## Pre-chunking %s into memory...\n", fullFilePath);
 
-    // Make sure the file exists and is accessible before creating a ContentObject response.
-    if (ccnxSimpleFileTransferFileIO_IsFileAvailable(fullFilePath)) {
-        uint64_t finalChunkNumber = _getFinalChunkNumberOfFile(fullFilePath, chunkSize);
+        uint64_t finalChunkNumber = _getFinalChunkNumberForFileSize(fileSize, chunkSize);
 
         result = ccnxSimpleFileTransferChunkList_Create(fullFilePath, finalChunkNumber + 1);
 
+        // This may run on a warming thread, so it can't share the Portal's compressor.
+        CCNxSimpleFileTransferCompressor *compressor = NULL;
+        CCNxSimpleFileTransferCodec codec = CCNxSimpleFileTransferCodec_None;
+        if (isCompressed) {
+            compressor = ccnxSimpleFileTransferCompressor_Create();
+            codec = _selectCodecForFile(serverState, compressor, fullFilePath, currentVersion);
+            printf("## Compressing the chunks of %s with %s.\n", fullFilePath,
+                   ccnxSimpleFileTransferCompressor_GetCodecName(codec));
+        }
+
+        // The holes of the version being chunked are found on a descriptor kept open for the whole file.
+        int holeFileDescriptor = -1;
+        if (compressor != NULL) {
+            size_t holeFileSize = 0;
+            holeFileDescriptor = ccnxSimpleFileTransferFileIO_OpenVersionedFile(fullFilePath, currentVersion,
+                                                                                &holeFileSize);
+        }
+
+        CCNxSimpleFileTransferChunkStoreSegment *newSegment = NULL;
+        if (baseNameString != NULL) {
+            newSegment = ccnxSimpleFileTransferChunkStore_CreateSegment(serverState->chunkStore, fileName, fullFilePath,
+                                                                        baseNameString, chunkSize, finalChunkNumber + 1);
+        }
 
         for (uint64_t i = 0; i <= finalChunkNumber; i++) {
             // Get the actual contents of the specified chunk of the file.
-            PARCBuffer *payload = ccnxSimpleFileTransferFileIO_GetFileChunk(fullFilePath, chunkSize, i);
+            uint64_t readStartTime = ccnxSimpleFileTransferMetrics_StartTimer(serverState->metrics);
+            uint64_t traceStartTime = ccnxSimpleFileTransferTrace_Begin();
+            PARCBuffer *payload = NULL;
+            bool isHole = false;
+            if (holeFileDescriptor >= 0) {
+                payload = _encodeChunkIfHole(holeFileDescriptor, fileSize, chunkSize, i);
+                isHole = (payload != NULL);
+            }
+            if (!isHole) {
+                payload =
+                    (version != 0) ? ccnxSimpleFileTransferFileIO_GetVersionedFileChunk(fullFilePath, chunkSize, i, version, &fileSize)
+                                   : ccnxSimpleFileTransferFileIO_GetFileChunk(fullFilePath, chunkSize, i);
+            }
+            ccnxSimpleFileTransferTrace_End(CCNxSimpleFileTransferTraceEvent_DiskRead, traceStartTime);
+            ccnxSimpleFileTransferMetrics_RecordLatencySince(serverState->metrics,
+                                                             CCNxSimpleFileTransferMetricsHistogram_DiskReadLatency,
+                                                             readStartTime);
+
+            if (payload != NULL && compressor != NULL && !isHole) {
+                PARCBuffer *compressed = ccnxSimpleFileTransferCompressor_Encode(compressor, codec, payload);
+                parcBuffer_Release(&payload);
+                payload = compressed;
+            }
+
+            if (payload != NULL && serverState->payloadTable != NULL && newSegment == NULL) {
+                // Hold one copy of a chunk's payload however many files, or versions of this one, have it.
+                // Stored chunks aren't shared, as they're replaced by the signed chunks read back from the store.
+                PARCBuffer *shared = ccnxSimpleFileTransferPayloadTable_Intern(serverState->payloadTable, payload);
+                if (shared != payload) {
+                    ccnxSimpleFileTransferMetrics_Increment(serverState->metrics,
+                                                            CCNxSimpleFileTransferMetricsCounter_DuplicateChunks, 1);
+                }
+                parcBuffer_Release(&payload);
+                payload = shared;
+            }
 
             if (payload != NULL) {
                 CCNxName *chunkName = ccnxName_Copy(baseName);
@@ -184,303 +652,1303 @@ _chunkFileIntoMemory(char *fullFilePath, const CCNxName *baseName, size_t chunkS
                 ccnxName_Append(chunkName, chunkSegment);
 
                 CCNxContentObject *contentObject = _createContentObject(chunkName, payload, finalChunkNumber);
+                if (newSegment != NULL) {
+                    contentObject = _storeContentObject(serverState, newSegment, contentObject);
+                }
 
                 parcBuffer_Release(&payload);
                 ccnxName_Release(&chunkName);
                 ccnxNameSegment_Release(&chunkSegment);
 
                 ccnxSimpleFileTransferChunkList_SetChunk(result, i, contentObject);
+                ccnxContentObject_Release(&contentObject);
+            } else if (version != 0) {
+                printf("## %s changed while it was being pre-chunked. Discarding its chunks.\n", fullFilePath);
+                ccnxSimpleFileTransferChunkList_Release(&result);
+                break;
             } else {
                 trapUnexpectedState("Could not get required chunk");
             }
+
+            if (warmer != NULL && !ccnxSimpleFileTransferCacheWarmer_Pace(warmer, chunkSize)) {
+                ccnxSimpleFileTransferChunkList_Release(&result); // The server is stopping.
+                break;
+            }
+        }
+        if (result != NULL) {
+            printf("## Finished chunking %s into memory. Resulted in %" PRIu64 " content objects.\n", fullFilePath,
+                   finalChunkNumber + 1);
+            _reportPayloadSharing(serverState);
         }
-        printf("## Finished chunking %s into memory. Resulted in %llu content objects.\n", fullFilePath,
-               finalChunkNumber + 1);
-    } else {
-        //trapUnexpectedState("Could not open file %s for chunking.", fullFilePath);
 
-        printf("## !! ## Could not access requested file [%s]. Could not pre-chunk. ## !! ##\n", fullFilePath);
+        if (newSegment != NULL) {
+            if (result != NULL && !ccnxSimpleFileTransferChunkStoreSegment_Commit(newSegment)) {
+                printf("## !! ## Could not save the chunks of %s in the chunk store. ## !! ##\n", fullFilePath);
+            }
+            ccnxSimpleFileTransferChunkStoreSegment_Release(&newSegment);
+        }
+
+        if (holeFileDescriptor >= 0) {
+            close(holeFileDescriptor);
+        }
+
+        if (compressor != NULL) {
+            ccnxSimpleFileTransferCompressor_Release(&compressor);
+        }
+    }
+
+    if (baseNameString != NULL) {
+        parcMemory_Deallocate((void **) &baseNameString);
     }
 
     return result;
 }
 
 
+/**
+ * Combine the directoryPath and fileName into the full path name of the desired file.
+ * The returned string must eventually be freed by calling parcMemory_Deallocate().
+ */
+static char *
+_createFullFilePath(const ServerState *serverState, const char *fileName)
+{
+    size_t filePathBufferSize =
+        strlen(fileName) + strlen(serverState->sourceDirectoryPath) + 2; // +2 for '/' and trailing null.
+    char *result = parcMemory_Allocate(filePathBufferSize);
+    assertNotNull(result, "parcMemory_Allocate(%zu) returned NULL", filePathBufferSize);
+    snprintf(result, filePathBufferSize, "%s/%s", serverState->sourceDirectoryPath, fileName);
+
+    return result;
+}
+
+/**
+ * Return the key that a file's chunks are cached under. The chunks of a version of a file are cached under the file
+ * name and the version, e.g. "file.txt/1234", so a cached version never has to be checked against the file: a
+ * changed file is a new version, with a new key. Chunks fetched without a version are cached under the file name.
+ * The returned string must eventually be freed by calling parcMemory_Deallocate().
+ */
+static char *
+_createCacheKey(const char *fileName, uint64_t version)
+{
+    return (version != 0) ? parcMemory_Format("%s/%" PRIu64, fileName, version)
+                          : parcMemory_StringDuplicate(fileName, strlen(fileName));
+}
+
+/**
+ * Return the key that the compressed chunks of a version of a file are cached under, e.g. "file.txt/1234/z".
+ * The returned string must eventually be freed by calling parcMemory_Deallocate().
+ */
+static char *
+_createCompressedCacheKey(const char *fileName, uint64_t version)
+{
+    return parcMemory_Format("%s/%" PRIu64 "%s", fileName, version, _compressedCacheKeySuffix);
+}
+
+/**
+ * Compress a chunk of a file read from disk, with the codec chosen for the file. The codec is chosen when a
+ * version of the file is first compressed, and remembered in the codec cache, so the file is only sampled once.
+ * A chunk fetched without a version uses the codec of the file's current version, so a file rewritten in place is
+ * sampled again. If the file's version can't be found, the chunk is framed as it is.
+ *
+ * @param [in,out] payloadPtr - the chunk, which is released and replaced with its compressed form.
+ */
+static void
+_compressFileChunk(const ServerState *serverState, const char *fileName, const char *fullFilePath, uint64_t version,
+                   PARCBuffer **payloadPtr)
+{
+    size_t fileSize = 0;
+    bool isVersionKnown = (version != 0) || ccnxSimpleFileTransferFileIO_GetFileVersion(fullFilePath, &fileSize, &version);
+
+    CCNxSimpleFileTransferCodec codec = CCNxSimpleFileTransferCodec_None;
+    if (isVersionKnown) {
+        char *cacheKey = _createCacheKey(fileName, version);
+
+        PARCBuffer *codecBuffer = (PARCBuffer *) ccnxSimpleFileTransferChunkCache_Get(serverState->codecCache, cacheKey);
+        if (codecBuffer != NULL) {
+            codec = (CCNxSimpleFileTransferCodec) parcBuffer_GetAtIndex(codecBuffer, 0);
+        } else {
+            codec = _selectCodecForFile(serverState, serverState->compressor, fullFilePath, version);
+
+            codecBuffer = parcBuffer_Allocate(1);
+            parcBuffer_Flip(parcBuffer_PutUint8(codecBuffer, (uint8_t) codec));
+            ccnxSimpleFileTransferChunkCache_Put(serverState->codecCache, cacheKey, codecBuffer, _codecCacheEntrySize);
+        }
+        parcBuffer_Release(&codecBuffer);
+
+        parcMemory_Deallocate((void **) &cacheKey);
+    }
+
+    uint64_t traceStartTime = ccnxSimpleFileTransferTrace_Begin();
+    PARCBuffer *compressed = ccnxSimpleFileTransferCompressor_Encode(serverState->compressor, codec, *payloadPtr);
+    ccnxSimpleFileTransferTrace_End(CCNxSimpleFileTransferTraceEvent_Build, traceStartTime);
+
+    parcBuffer_Release(payloadPtr);
+    *payloadPtr = compressed;
+}
+
 /**
  * Given a CCNxName, a directory path, a file name, and a requested chunk number, return a new CCNxContentObject
  * with that CCNxName and containing the specified chunk of the file. The new CCNxContentObject will also
  * contain the number of the last chunk required to transfer the complete file. Note that the last chunk of the
  * file being retrieved is calculated each time we retrieve a chunk so the file can be growing in size as we
  * transfer it.
+ *
+ * If the name is versioned, the chunk is only returned if the file is still at that version, so the client
+ * gets every chunk from the same contents. The version check and the size come from the same open file as
+ * the chunk, so there is no separate stat of the file.
+ *
  * The new CCnxContentObject must eventually be released by calling ccnxContentObject_Release().
  *
  * @param [in] name The CCNxName to use when creating the new CCNxContentObject.
  * @param [in] directoryPath The directory in which to find the specified file.
  * @param [in] fileName The name of the file.
  * @param [in] requestedChunkNumber The number of the requested chunk from the file.
+ * @param [in] version The version of the file named by the request, or 0 if the name isn't versioned.
+ * @param [in] isCompressed True if the chunk should be compressed, as for a "zfetch" request.
  *
  * @return A new CCNxContentObject instance containing the request chunk of the specified file, or NULL if
- *         the file did not exist or was otherwise unavailable.
+ *         the file did not exist, was otherwise unavailable, or has changed since the requested version.
  */
 static CCNxContentObject *
 _createFetchResponse(const ServerState *serverState, const CCNxName *name,
-                     const char *fileName, const int64_t requestedChunkNumber)
+                     const char *fileName, const int64_t requestedChunkNumber, uint64_t version, bool isCompressed)
 {
     CCNxContentObject *result = NULL;
     uint64_t finalChunkNumber = 0;
 
-    // Combine the directoryPath and fileName into the full path name of the desired file
-    size_t filePathBufferSize =
-        strlen(fileName) + strlen(serverState->sourceDirectoryPath) + 2; // +2 for '/' and trailing null.
-    char *fullFilePath = parcMemory_Allocate(filePathBufferSize);
-    assertNotNull(fullFilePath, "parcMemory_Allocate(%zu) returned NULL", filePathBufferSize);
-    snprintf(fullFilePath, filePathBufferSize, "%s/%s", serverState->sourceDirectoryPath, fileName);
-
-    // Make sure the file exists and is accessible before creating a ContentObject response.
-    if (ccnxSimpleFileTransferFileIO_IsFileAvailable(fullFilePath)) {
-        // Since the file's length can change (e.g. if it is being written to while we're fetching
-        // it), the final chunk number can change between requests for content chunks. So, update
-        // it each time this function is called.
-        finalChunkNumber = _getFinalChunkNumberOfFile(fullFilePath, serverState->chunkSize);
-
-        // Get the actual contents of the specified chunk of the file.
-        PARCBuffer *payload = ccnxSimpleFileTransferFileIO_GetFileChunk(fullFilePath,
-                                                                        serverState->chunkSize,
-                                                                        requestedChunkNumber);
+    char *fullFilePath = _createFullFilePath(serverState, fileName);
+
+    if (version != 0) {
+        uint64_t readStartTime = ccnxSimpleFileTransferMetrics_StartTimer(serverState->metrics);
+        uint64_t traceStartTime = ccnxSimpleFileTransferTrace_Begin();
+        size_t fileSize = 0;
+        PARCBuffer *payload = NULL;
+        bool isHole = false;
+        if (serverState->openFiles != NULL) {
+            // Read from the descriptor we kept open for the previous chunk of this version. This saves opening the
+            // file again, but the chunk is still copied into the payload, and again when the Portal encodes it.
+            int fd = ccnxSimpleFileTransferOpenFileCache_GetFile(serverState->openFiles, fullFilePath, version, &fileSize);
+            if (fd >= 0 && isCompressed) {
+                payload = _encodeChunkIfHole(fd, fileSize, serverState->chunkSize, requestedChunkNumber);
+                isHole = (payload != NULL);
+            }
+            if (fd >= 0 && !isHole) {
+                // Into a buffer that a response we have already sent was finished with, unless responses are
+                // shared with other Portals, whose threads the pool can't tell apart from its own.
+                if (serverState->payloadPool != NULL) {
+                    payload = ccnxSimpleFileTransferBufferPool_GetBuffer(serverState->payloadPool);
+                } else {
+                    payload = parcBuffer_Allocate(serverState->chunkSize);
+                }
+                if (!ccnxSimpleFileTransferFileIO_ReadFileChunkIntoBuffer(fd, payload, serverState->chunkSize,
+                                                                          requestedChunkNumber)) {
+                    parcBuffer_Release(&payload);
+                }
+            }
+        } else {
+            int fd = ccnxSimpleFileTransferFileIO_OpenVersionedFile(fullFilePath, version, &fileSize);
+            if (fd >= 0) {
+                if (isCompressed) {
+                    payload = _encodeChunkIfHole(fd, fileSize, serverState->chunkSize, requestedChunkNumber);
+                    isHole = (payload != NULL);
+                }
+                if (!isHole) {
+                    payload = ccnxSimpleFileTransferFileIO_ReadFileChunk(fd, serverState->chunkSize,
+                                                                         requestedChunkNumber);
+                }
+                close(fd);
+            }
+        }
+        ccnxSimpleFileTransferTrace_End(CCNxSimpleFileTransferTraceEvent_DiskRead, traceStartTime);
+        ccnxSimpleFileTransferMetrics_RecordLatencySince(serverState->metrics,
+                                                         CCNxSimpleFileTransferMetricsHistogram_DiskReadLatency,
+                                                         readStartTime);
 
         if (payload != NULL) {
+            finalChunkNumber = _getFinalChunkNumberForFileSize(fileSize, serverState->chunkSize);
+            if (isCompressed && !isHole) {
+                _compressFileChunk(serverState, fileName, fullFilePath, version, &payload);
+            }
             result = _createContentObject(name, payload, finalChunkNumber);
             parcBuffer_Release(&payload);
+        } else {
+            printf("Version %" PRIu64 " of %s is no longer available. Returning NULL\n", version, fileName);
         }
+    } else {
+        // Make sure the file exists and is accessible before creating a ContentObject response.
+        uint64_t traceStartTime = ccnxSimpleFileTransferTrace_Begin();
+        bool isFileAvailable = ccnxSimpleFileTransferFileIO_IsFileAvailable(fullFilePath);
+        if (isFileAvailable) {
+            // Since the file's length can change (e.g. if it is being written to while we're fetching
+            // it), the final chunk number can change between requests for content chunks. So, update
+            // it each time this function is called.
+            finalChunkNumber = _getFinalChunkNumberOfFile(fullFilePath, serverState->chunkSize);
+        }
+        ccnxSimpleFileTransferTrace_End(CCNxSimpleFileTransferTraceEvent_Lookup, traceStartTime);
+
+        if (isFileAvailable) {
+            // Get the actual contents of the specified chunk of the file.
+            uint64_t readStartTime = ccnxSimpleFileTransferMetrics_StartTimer(serverState->metrics);
+            traceStartTime = ccnxSimpleFileTransferTrace_Begin();
+            PARCBuffer *payload = NULL;
+            bool isHole = false;
+            if (isCompressed) {
+                // An unversioned chunk is read by name, so the file is opened only to look for the hole.
+                int fd = open(fullFilePath, O_RDONLY);
+                size_t fileSize = 0;
+                uint64_t currentVersion = 0;
+                if (fd >= 0) {
+                    if (ccnxSimpleFileTransferFileIO_GetOpenFileVersion(fd, &fileSize, &currentVersion)) {
+                        payload = _encodeChunkIfHole(fd, fileSize, serverState->chunkSize, requestedChunkNumber);
+                        isHole = (payload != NULL);
+                    }
+                    close(fd);
+                }
+            }
+            if (!isHole) {
+                payload = ccnxSimpleFileTransferFileIO_GetFileChunk(fullFilePath, serverState->chunkSize,
+                                                                    requestedChunkNumber);
+            }
+            ccnxSimpleFileTransferTrace_End(CCNxSimpleFileTransferTraceEvent_DiskRead, traceStartTime);
+            ccnxSimpleFileTransferMetrics_RecordLatencySince(serverState->metrics,
+                                                             CCNxSimpleFileTransferMetricsHistogram_DiskReadLatency,
+                                                             readStartTime);
+
+            if (payload != NULL) {
+                if (isCompressed && !isHole) {
+                    _compressFileChunk(serverState, fileName, fullFilePath, version, &payload);
+                }
+                result = _createContentObject(name, payload, finalChunkNumber);
+                parcBuffer_Release(&payload);
+            }
+        }
+    }
+
+    parcMemory_Deallocate((void **) &fullFilePath);
+
+    return result; // Could be NULL if there was no payload
+}
+
+/**
+ * Same as _createFetchResponse(), but pre-calculates ALL of the content objects and stores them in memory for quick retrieval.
+ *
+ * If the cache is limited in size, a file is only pre-chunked if it has been requested more often recently than the
+ * files it would evict. Otherwise it's served from disk by _createFetchResponse(), so that a one-off fetch of a big,
+ * cold file doesn't push the popular files out of the cache.
+ *
+ * A versioned request that hits the cache is answered without looking at the file at all. Compressed chunks are
+ * only pre-chunked for versioned requests, and are cached separately from the uncompressed ones.
+ */
+static CCNxContentObject *
+_createFetchResponseWithPreChunking(const ServerState *serverState, const CCNxName *name,
+                                    const char *fileName, const uint64_t requestedChunkNumber, uint64_t version,
+                                    bool isCompressed)
+{
+    CCNxContentObject *result = NULL;
+
+    char *cacheKey = isCompressed ? _createCompressedCacheKey(fileName, version) : _createCacheKey(fileName, version);
+
+    // A fetch starts with the first chunk, so count that as a request for the file.
+    if (requestedChunkNumber == 0) {
+        ccnxSimpleFileTransferChunkCache_RecordRequest(serverState->chunkCache, cacheKey);
+    }
+
+    uint64_t traceStartTime = ccnxSimpleFileTransferTrace_Begin();
+    CCNxSimpleFileTransferChunkList *fileChunks =
+        (CCNxSimpleFileTransferChunkList *) ccnxSimpleFileTransferChunkCache_Get(serverState->chunkCache, cacheKey);
+    ccnxSimpleFileTransferTrace_End(CCNxSimpleFileTransferTraceEvent_Lookup, traceStartTime);
+
+    if (fileChunks == NULL) {
+        ccnxSimpleFileTransferMetrics_Increment(serverState->metrics, CCNxSimpleFileTransferMetricsCounter_CacheMisses, 1);
+
+        char *fullFilePath = _createFullFilePath(serverState, fileName);
+
+        size_t fileSize = 0;
+        uint64_t currentVersion = 0;
+        if (ccnxSimpleFileTransferFileIO_GetFileVersion(fullFilePath, &fileSize, &currentVersion)
+            && (version == 0 || version == currentVersion)) {
+            if (ccnxSimpleFileTransferChunkCache_ShouldAdmit(serverState->chunkCache, cacheKey, fileSize)) {
+                // Chunk list for this file was empty. Build it. This will take a while.
+                CCNxName *baseName = ccnxSimpleFileTransferCommon_CreateWithBaseName(name);
+                fileChunks = _chunkFileIntoMemory(serverState, fileName, fullFilePath, baseName, version, isCompressed,
+                                                  NULL);
+                ccnxName_Release(&baseName);
+
+                if (fileChunks != NULL) {
+                    uint64_t numEvictions = ccnxSimpleFileTransferChunkCache_GetStats(serverState->chunkCache).evictions;
+                    ccnxSimpleFileTransferChunkCache_Put(serverState->chunkCache, cacheKey, fileChunks, fileSize);
+                    ccnxSimpleFileTransferMetrics_Increment(serverState->metrics,
+                                                            CCNxSimpleFileTransferMetricsCounter_CacheEvictions,
+                                                            ccnxSimpleFileTransferChunkCache_GetStats(serverState->chunkCache).evictions
+                                                            - numEvictions);
+                }
+            } else {
+                ccnxSimpleFileTransferMetrics_Increment(serverState->metrics,
+                                                        CCNxSimpleFileTransferMetricsCounter_CacheAdmissionRejections, 1);
+            }
+        }
+        parcMemory_Deallocate((void **) &fullFilePath);
+    } else {
+        ccnxSimpleFileTransferMetrics_Increment(serverState->metrics, CCNxSimpleFileTransferMetricsCounter_CacheHits, 1);
+    }
+
+    if (fileChunks != NULL) {
+        if (requestedChunkNumber < ccnxSimpleFileTransferChunkList_GetNumChunks(fileChunks)) {
+            result = ccnxSimpleFileTransferChunkList_GetChunk(fileChunks, requestedChunkNumber);
+            if (result != NULL) {
+                // We actually want to return a reference to the ContentObject chunk, as
+                // the calling code expects to be able to release what we return.
+                result = ccnxContentObject_Acquire(result);
+            }
+        } else {
+            printf("Requested out of range chunk %" PRIu64 " for %s. Returning NULL\n", requestedChunkNumber, fileName);
+        }
+        ccnxSimpleFileTransferChunkList_Release(&fileChunks);
+    } else {
+        // The file isn't cached, and isn't popular enough to be. Serve it from disk.
+        result = _createFetchResponse(serverState, name, fileName, requestedChunkNumber, version, isCompressed);
+    }
+
+    parcMemory_Deallocate((void **) &cacheKey);
+
+    return result; // Could be NULL if there was no payload
+}
+
+/**
+ * The current time, in milliseconds since the epoch, as used for the expiry time of a CCNxContentObject.
+ */
+static uint64_t
+_getTimeInMillis(void)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return (uint64_t) now.tv_sec * 1000 + (uint64_t) now.tv_usec / 1000;
+}
+
+/**
+ * The current time, in microseconds since the epoch.
+ */
+static uint64_t
+_getTimeInMicros(void)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return (uint64_t) now.tv_sec * 1000000 + (uint64_t) now.tv_usec;
+}
+
+/**
+ * Given a CCNxName and a file name, return a new CCNxContentObject whose payload is the current version and size
+ * of the file, as created by ccnxSimpleFileTransferCommon_CreateStatPayload(). A client asks for this before
+ * fetching the file, and then fetches every chunk of that version.
+ *
+ * The response expires quickly, so that caches on the way to the client don't hand out a version that the file
+ * has since moved on from.
+ * The new CCnxContentObject must eventually be released by calling ccnxContentObject_Release().
+ *
+ * @return A new CCNxContentObject, or NULL if the file did not exist or was otherwise unavailable.
+ */
+static CCNxContentObject *
+_createStatResponse(const ServerState *serverState, const CCNxName *name, const char *fileName,
+                    uint64_t requestedChunkNumber)
+{
+    CCNxContentObject *result = NULL;
+
+    char *fullFilePath = _createFullFilePath(serverState, fileName);
+
+    size_t fileSize = 0;
+    uint64_t version = 0;
+    if (requestedChunkNumber == 0 && ccnxSimpleFileTransferFileIO_GetFileVersion(fullFilePath, &fileSize, &version)) {
+        PARCBuffer *payload = ccnxSimpleFileTransferCommon_CreateStatPayload(version, fileSize);
+        result = _createContentObject(name, payload, 0);
+        ccnxContentObject_SetExpiryTime(result, _getTimeInMillis() + _statResponseLifetimeMillis);
+        parcBuffer_Release(&payload);
     }
 
     parcMemory_Deallocate((void **) &fullFilePath);
 
-    return result; // Could be NULL if there was no payload
+    return result;
+}
+
+
+/**
+ * Given a CCNxName, a buffer and a requested chunk number, return the specified chunk of the buffer as the payload
+ * of a newly created CCNxContentObject. The buffer itself is left unchanged.
+ * The new CCnxContentObject must eventually be released by calling ccnxContentObject_Release().
+ *
+ * @param [in] name The CCNxName to use when creating the new CCNxContentObject.
+ * @param [in] buffer The buffer to take the chunk from, between its position and its limit.
+ * @param [in] requestedChunkNumber The number of the requested chunk of the buffer.
+ *
+ * @return A new CCNxContentObject instance containing the requested chunk, or NULL if the buffer has no such chunk.
+ */
+static CCNxContentObject *
+_createChunkOfBufferResponse(const ServerState *serverState, const CCNxName *name, const PARCBuffer *buffer,
+                             uint64_t requestedChunkNumber)
+{
+    CCNxContentObject *result = NULL;
+
+    PARCBuffer *chunk = parcBuffer_Slice(buffer);
+
+    uint64_t totalChunksInBuffer = _getNumberOfChunksRequired(parcBuffer_Limit(chunk), serverState->chunkSize);
+    if (requestedChunkNumber < totalChunksInBuffer) {
+        // Set the buffer's position to the start of the desired chunk.
+        parcBuffer_SetPosition(chunk, (requestedChunkNumber * serverState->chunkSize));
+
+        // See if we have more than 1 chunk's worth of data to in the buffer. If so, set the buffer's limit
+        // to the end of the chunk.
+        size_t chunkLen = parcBuffer_Remaining(chunk);
+
+        if (chunkLen > serverState->chunkSize) {
+            parcBuffer_SetLimit(chunk, parcBuffer_Position(chunk) + serverState->chunkSize);
+        }
+
+        // Calculate the final chunk number
+        uint64_t finalChunkNumber = (totalChunksInBuffer > 0) ? totalChunksInBuffer - 1
+                                                              : 0; // the final chunk, 0-based
+
+        // At this point, the chunk has its position and limit set to the beginning and end of the
+        // specified chunk.
+        result = _createContentObject(name, chunk, finalChunkNumber);
+    }
+
+    parcBuffer_Release(&chunk);
+
+    return result;
+}
+
+/**
+ * Given a CCNxName, a directory path, and a requested chunk number, create a directory listing and return the specified
+ * chunk of the directory listing as the payload of a newly created CCNxContentObject.
+ * The new CCnxContentObject must eventually be released by calling ccnxContentObject_Release().
+ *
+ * @param [in] name The CCNxName to use when creating the new CCNxContentObject.
+ * @param [in] directoryPath The directory whose contents are being listed.
+ * @param [in] requestedChunkNumber The number of the requested chunk from the complete directory listing.
+ *
+ * @return A new CCNxContentObject instance containing the request chunk of the directory listing.
+ */
+static CCNxContentObject *
+_createListResponse(const ServerState *serverState, CCNxName *name, uint64_t requestedChunkNumber)
+{
+    PARCBuffer *directoryList = ccnxSimpleFileTransferFileIO_CreateDirectoryListing(serverState->sourceDirectoryPath);
+
+    CCNxContentObject *result = _createChunkOfBufferResponse(serverState, name, directoryList, requestedChunkNumber);
+
+    parcBuffer_Release(&directoryList);
+
+    return result;
+}
+
+/**
+ * Computes a summary of a version of a file, such as its block signatures, from a descriptor open on it, encoded
+ * for sending. Returns NULL if the file couldn't be read.
+ */
+typedef PARCBuffer *(_CreateFileSummaryBuffer)(int fileDescriptor, size_t fileSize, size_t chunkSize);
+
+static PARCBuffer *
+_createBlockSignaturesBuffer(int fileDescriptor, size_t fileSize, size_t chunkSize)
+{
+    PARCBuffer *result = NULL;
+
+    CCNxSimpleFileTransferBlockSignatures *signatures =
+        ccnxSimpleFileTransferBlockSignatures_CreateFromFile(fileDescriptor, fileSize, chunkSize);
+    if (signatures != NULL) {
+        result = ccnxSimpleFileTransferBlockSignatures_CreateBuffer(signatures);
+        ccnxSimpleFileTransferBlockSignatures_Release(&signatures);
+    }
+
+    return result;
+}
+
+static PARCBuffer *
+_createChunkDigestsBuffer(int fileDescriptor, size_t fileSize, size_t chunkSize)
+{
+    PARCBuffer *result = NULL;
+
+    CCNxSimpleFileTransferChunkDigests *digests =
+        ccnxSimpleFileTransferChunkDigests_CreateFromFile(fileDescriptor, fileSize, chunkSize);
+    if (digests != NULL) {
+        result = ccnxSimpleFileTransferChunkDigests_CreateBuffer(digests);
+        ccnxSimpleFileTransferChunkDigests_Release(&digests);
+    }
+
+    return result;
+}
+
+/**
+ * Given a CCNxName, a file name and a version of the file, return the specified chunk of a summary of that version,
+ * with one entry per chunk of the file, such as its block signatures.
+ *
+ * A version never changes, so neither does its summary. It's computed once, on the first request, and kept in the
+ * given cache under the same key as the version's chunks.
+ * The new CCnxContentObject must eventually be released by calling ccnxContentObject_Release().
+ *
+ * @return A new CCNxContentObject, or NULL if the file isn't at that version any more, or was otherwise unavailable.
+ */
+static CCNxContentObject *
+_createFileSummaryResponse(const ServerState *serverState, const CCNxName *name, const char *fileName,
+                           uint64_t requestedChunkNumber, uint64_t version,
+                           CCNxSimpleFileTransferChunkCache *summaryCache, _CreateFileSummaryBuffer *createSummaryBuffer)
+{
+    CCNxContentObject *result = NULL;
+
+    if (version != 0) {
+        char *cacheKey = _createCacheKey(fileName, version);
+
+        PARCBuffer *summaryBuffer = (PARCBuffer *) ccnxSimpleFileTransferChunkCache_Get(summaryCache, cacheKey);
+
+        if (summaryBuffer == NULL) {
+            char *fullFilePath = _createFullFilePath(serverState, fileName);
+
+            size_t fileSize = 0;
+            int fd = ccnxSimpleFileTransferFileIO_OpenVersionedFile(fullFilePath, version, &fileSize);
+            if (fd >= 0) {
+                uint64_t traceStartTime = ccnxSimpleFileTransferTrace_Begin();
+                summaryBuffer = createSummaryBuffer(fd, fileSize, serverState->chunkSize);
+                ccnxSimpleFileTransferTrace_End(CCNxSimpleFileTransferTraceEvent_DiskRead, traceStartTime);
+                close(fd);
+
+                // The file may have been rewritten while we were reading it. Only keep a summary of the version asked for.
+                size_t currentFileSize = 0;
+                uint64_t currentVersion = 0;
+                if (summaryBuffer != NULL
+                    && ccnxSimpleFileTransferFileIO_GetFileVersion(fullFilePath, &currentFileSize, &currentVersion)
+                    && currentVersion == version) {
+                    ccnxSimpleFileTransferChunkCache_Put(summaryCache, cacheKey, summaryBuffer,
+                                                         parcBuffer_Remaining(summaryBuffer));
+                } else if (summaryBuffer != NULL) {
+                    parcBuffer_Release(&summaryBuffer);
+                }
+            }
+
+            parcMemory_Deallocate((void **) &fullFilePath);
+        }
+
+        if (summaryBuffer != NULL) {
+            result = _createChunkOfBufferResponse(serverState, name, summaryBuffer, requestedChunkNumber);
+            parcBuffer_Release(&summaryBuffer);
+        }
+
+        parcMemory_Deallocate((void **) &cacheKey);
+    }
+
+    return result;
+}
+
+/**
+ * Given a CCnxInterest that matched our domain prefix, see what the embedded command is and
+ * create a corresponding CCNxContentObject as a response. The resulting CCNxContentObject
+ * must eventually be released by calling ccnxContentObject_Release().
+ *
+ * @param [in] interest A CCNxInterest that matched the specified domain prefix.
+ * @param [in] domainPrefix A CCNxName containing the domain prefix.
+ * @param [in] directoryPath A string containing the path to the directory being served.
+ *
+ * @return A newly creatd CCNxContentObject contaning a response to the specified Interest,
+ *         or NULL if the Interest couldn't be answered.
+ */
+static CCNxContentObject *
+_createInterestResponse(const ServerState *serverState, const CCNxInterest *interest)
+{
+    CCNxName *interestName = ccnxInterest_GetName(interest);
+
+    uint64_t traceStartTime = ccnxSimpleFileTransferTrace_Begin();
+
+    char *command = ccnxSimpleFileTransferCommon_CreateCommandStringFromName(interestName,
+                                                                             (const CCNxName *) serverState->namePrefix);
+
+    uint64_t requestedChunkNumber = ccnxSimpleFileTransferCommon_GetChunkNumberFromName(interestName);
+
+    ccnxSimpleFileTransferTrace_End(CCNxSimpleFileTransferTraceEvent_Parse, traceStartTime);
+
+    CCNxContentObject *result = NULL;
+    if (strncasecmp(command, ccnxSimpleFileTransferCommon_CommandList, strlen(command)) == 0) {
+        // This was a 'list' command. We should return the requested chunk of the directory listing.
+        result = _createListResponse(serverState, interestName, requestedChunkNumber);
+    } else if (strncasecmp(command, ccnxSimpleFileTransferCommon_CommandFetch, strlen(command)) == 0
+               || strncasecmp(command, ccnxSimpleFileTransferCommon_CommandFetchCompressed, strlen(command)) == 0) {
+        // This was a 'fetch' or 'zfetch' command. We should return the requested chunk of the file specified,
+        // compressed for 'zfetch'.
+        traceStartTime = ccnxSimpleFileTransferTrace_Begin();
+        bool isCompressed = strncasecmp(command, ccnxSimpleFileTransferCommon_CommandFetchCompressed, strlen(command)) == 0;
+        char *fileName = ccnxSimpleFileTransferCommon_CreateFileNameFromName(interestName);
+        uint64_t version = ccnxSimpleFileTransferCommon_GetVersionFromName(interestName);
+        ccnxSimpleFileTransferTrace_End(CCNxSimpleFileTransferTraceEvent_Parse, traceStartTime);
+
+        // An unversioned file can change between chunks, and chunks compressed from different versions can't be
+        // told apart, so only versioned compressed chunks are pre-chunked.
+        if (serverState->doPreChunkIntoMemory && (!isCompressed || version != 0)) {
+            result = _createFetchResponseWithPreChunking(serverState,
+                                                         interestName,
+                                                         fileName,
+                                                         requestedChunkNumber,
+                                                         version,
+                                                         isCompressed);
+        } else {
+            result = _createFetchResponse(serverState,
+                                          interestName,
+                                          fileName,
+                                          requestedChunkNumber,
+                                          version,
+                                          isCompressed);
+        }
+
+        parcMemory_Deallocate((void **) &fileName);
+    } else if (strncasecmp(command, ccnxSimpleFileTransferCommon_CommandStat, strlen(command)) == 0) {
+        // This was a 'stat' command. We should return the current version of the file specified.
+        char *fileName = ccnxSimpleFileTransferCommon_CreateFileNameFromName(interestName);
+        result = _createStatResponse(serverState, interestName, fileName, requestedChunkNumber);
+        parcMemory_Deallocate((void **) &fileName);
+    } else if (strncasecmp(command, ccnxSimpleFileTransferCommon_CommandSums, strlen(command)) == 0) {
+        // This was a 'sums' command. We should return the requested chunk of the block signatures of the file specified.
+        // A client that already has an older copy of the file uses them to find which chunks it doesn't need to fetch.
+        char *fileName = ccnxSimpleFileTransferCommon_CreateFileNameFromName(interestName);
+        uint64_t version = ccnxSimpleFileTransferCommon_GetVersionFromName(interestName);
+        result = _createFileSummaryResponse(serverState, interestName, fileName, requestedChunkNumber, version,
+                                            serverState->signatureCache, _createBlockSignaturesBuffer);
+        parcMemory_Deallocate((void **) &fileName);
+    } else if (strncasecmp(command, ccnxSimpleFileTransferCommon_CommandDigests, strlen(command)) == 0) {
+        // This was a 'digests' command. We should return the requested chunk of the chunk digests of the file
+        // specified, which the client checks each chunk of the file against.
+        char *fileName = ccnxSimpleFileTransferCommon_CreateFileNameFromName(interestName);
+        uint64_t version = ccnxSimpleFileTransferCommon_GetVersionFromName(interestName);
+        result = _createFileSummaryResponse(serverState, interestName, fileName, requestedChunkNumber, version,
+                                            serverState->digestCache, _createChunkDigestsBuffer);
+        parcMemory_Deallocate((void **) &fileName);
+    } else {
+        printf("_createInterestResponse() called with unknown command: %s\n", command);
+    }
+
+    parcMemory_Deallocate((void **) &command);
+
+    return result;
+}
+
+/**
+ * Given an Interest, return the name of the class it is answered in: its command and, for the commands about a
+ * file, the file's name, e.g. "fetch/movie.mp4". The Portal doesn't tell us which face an Interest arrived on,
+ * so the Interests for one file are one class, however many consumers are asking for it.
+ * The returned string must eventually be deallocated by calling parcMemory_Deallocate().
+ *
+ * @param [out] priority - set to the priority of the class.
+ */
+static char *
+_createInterestClassName(const ServerState *serverState, const CCNxInterest *interest, _InterestPriority *priority)
+{
+    CCNxName *interestName = ccnxInterest_GetName(interest);
+
+    char *result = ccnxSimpleFileTransferCommon_CreateCommandStringFromName(interestName,
+                                                                            (const CCNxName *) serverState->namePrefix);
+    bool isFetch = strncasecmp(result, ccnxSimpleFileTransferCommon_CommandFetch, strlen(result)) == 0
+                   || strncasecmp(result, ccnxSimpleFileTransferCommon_CommandFetchCompressed, strlen(result)) == 0;
+    *priority = isFetch ? _InterestPriority_Bulk : _InterestPriority_Metadata;
+
+    if (strncasecmp(result, ccnxSimpleFileTransferCommon_CommandList, strlen(result)) != 0) {
+        char *command = result;
+        char *fileName = ccnxSimpleFileTransferCommon_CreateFileNameFromName(interestName);
+        size_t length = strlen(command) + 1 + strlen(fileName) + 1;
+        result = parcMemory_Allocate(length);
+        assertNotNull(result, "parcMemory_Allocate(%zu) returned NULL", length);
+        snprintf(result, length, "%s/%s", command, fileName);
+        parcMemory_Deallocate((void **) &command);
+        parcMemory_Deallocate((void **) &fileName);
+    }
+    return result;
+}
+
+static void
+_enqueueResponse(_ServerLoop *serverLoop, CCNxContentObject *response)
+{
+    PARCBuffer *payload = ccnxContentObject_GetPayload(response);
+
+    _QueuedResponse *entry = &serverLoop->sendQueue[(serverLoop->sendQueueHead + serverLoop->sendQueueLength) % _sendQueueCapacity];
+    entry->message = ccnxMetaMessage_CreateFromContentObject(response);
+    entry->payloadSize = (payload != NULL) ? parcBuffer_Remaining(payload) : 0;
+    entry->sendStartTime = serverLoop->answerBatchStartTime;
+    serverLoop->sendQueueLength++;
+}
+
+static void
+_dequeueResponse(_ServerLoop *serverLoop)
+{
+    _QueuedResponse *entry = &serverLoop->sendQueue[serverLoop->sendQueueHead];
+    ccnxMetaMessage_Release(&entry->message);
+    serverLoop->sendQueueHead = (serverLoop->sendQueueHead + 1) % _sendQueueCapacity;
+    serverLoop->sendQueueLength--;
+}
+
+/**
+ * Whether a failed send is worth retrying, because the Portal's stack just couldn't take the message yet.
+ */
+static bool
+_isSendRetryable(int error)
+{
+    return error == EAGAIN || error == EWOULDBLOCK || error == EBUSY || error == ETIMEDOUT;
+}
+
+/**
+ * Hand the Portal as many of the queued responses, in order, as it will take without blocking.
+ *
+ * The clock is read once for the whole pass, and each response's send latency measured to it.
+ */
+static void
+_sendQueuedResponses(_ServerLoop *serverLoop)
+{
+    if (serverLoop->sendQueueLength == 0) {
+        return;
+    }
+    uint64_t sendTime = ccnxSimpleFileTransferMetrics_StartTimer(serverLoop->metrics);
+
+    while (serverLoop->sendQueueLength > 0) {
+        _QueuedResponse *entry = &serverLoop->sendQueue[serverLoop->sendQueueHead];
+
+        uint64_t traceStartTime = ccnxSimpleFileTransferTrace_Begin();
+        bool wasSent = ccnxPortal_Send(serverLoop->portal, entry->message, CCNxStackTimeout_Immediate);
+        ccnxSimpleFileTransferTrace_End(CCNxSimpleFileTransferTraceEvent_Send, traceStartTime);
+
+        if (wasSent) {
+            ccnxSimpleFileTransferMetrics_RecordLatency(serverLoop->metrics, CCNxSimpleFileTransferMetricsHistogram_SendLatency,
+                                                        sendTime - entry->sendStartTime);
+            ccnxSimpleFileTransferMetrics_Increment(serverLoop->metrics,
+                                                    CCNxSimpleFileTransferMetricsCounter_ResponsesSent, 1);
+            ccnxSimpleFileTransferMetrics_Increment(serverLoop->metrics,
+                                                    CCNxSimpleFileTransferMetricsCounter_BytesSent, entry->payloadSize);
+            serverLoop->result = true; // We have received, and responded to, at least one Interest.
+        } else {
+            int error = ccnxPortal_GetError(serverLoop->portal);
+            if (_isSendRetryable(error)) {
+                break; // Try again when the Portal is writable, or at the next housekeeping.
+            }
+            fprintf(stderr, "ccnxPortal_Send failed (error %d). Is the Forwarder running?\n", error);
+            ccnxSimpleFileTransferMetrics_Increment(serverLoop->metrics,
+                                                    CCNxSimpleFileTransferMetricsCounter_SendFailures, 1);
+        }
+        _dequeueResponse(serverLoop);
+    }
+}
+
+static CCNxContentObject *
+_buildInFlightResponse(void *builderContext, const CCNxInterest *interest)
+{
+    return _createInterestResponse(builderContext, interest);
+}
+
+/**
+ * Build the response to an Interest and queue it to be sent.
+ *
+ * @return The size of the response's payload, or 0 if there was no response.
+ */
+static size_t
+_answerInterest(_ServerLoop *serverLoop, const CCNxInterest *interest)
+{
+    const ServerState *serverState = serverLoop->serverState;
+
+    ccnxSimpleFileTransferTrace_StartInterest();
+
+    if (serverState->beVerbose) {
+        CCNxName *interestName = ccnxInterest_GetName(interest);
+        char *nameString = ccnxName_ToString(interestName);
+        uint64_t requestedChunkNumber = ccnxSimpleFileTransferCommon_GetChunkNumberFromName(interestName);
+        printf("<- Received interest for [%s] (chunk #%" PRIu64 ")\n", nameString, requestedChunkNumber);
+        parcMemory_Deallocate(&nameString);
+    }
+
+    uint64_t buildStartTime = ccnxSimpleFileTransferMetrics_StartTimer(serverLoop->metrics);
+    CCNxContentObject *response = NULL;
+    if (serverState->inFlightTable != NULL) {
+        // Identical Interests arriving together share one disk read and one built response.
+        bool wasCoalesced = false;
+        response = ccnxSimpleFileTransferInFlightTable_GetResponse(serverState->inFlightTable, interest,
+                                                                   _buildInFlightResponse, (void *) serverState,
+                                                                   &wasCoalesced);
+        if (wasCoalesced) {
+            ccnxSimpleFileTransferMetrics_Increment(serverLoop->metrics,
+                                                    CCNxSimpleFileTransferMetricsCounter_InterestsCoalesced, 1);
+        }
+    } else {
+        response = _createInterestResponse(serverState, interest);
+    }
+    ccnxSimpleFileTransferMetrics_RecordLatencySince(serverLoop->metrics,
+                                                     CCNxSimpleFileTransferMetricsHistogram_ResponseBuildLatency,
+                                                     buildStartTime);
+
+    // At this point, response has either the requested chunk of the request file/command,
+    // or remains NULL.
+
+    size_t payloadSize = 0;
+    if (response != NULL) {
+        PARCBuffer *payload = ccnxContentObject_GetPayload(response);
+        if (payload != NULL) {
+            payloadSize = parcBuffer_Limit(payload);
+        }
+        if (serverState->beVerbose) {
+            printf(" -> Responding with %ld bytes\n", payloadSize);
+        }
+
+        _enqueueResponse(serverLoop, response);
+        ccnxContentObject_Release(&response);
+    }
+    return payloadSize;
+}
+
+/**
+ * Whether to receive more Interests. We stop only when both queues are full: while responses can still be
+ * queued, an Interest arriving to a full Interest queue displaces one of the busiest class's instead.
+ */
+static bool
+_canReceiveInterests(const _ServerLoop *serverLoop)
+{
+    return serverLoop->sendQueueLength < _sendQueueCapacity
+           || ccnxSimpleFileTransferFairQueue_GetSize(serverLoop->interestQueue) < _interestQueueCapacity;
+}
+
+/**
+ * Queue the Interests that have arrived, in their classes, as long as we can take them.
+ *
+ * @return The number of Interests received.
+ */
+static size_t
+_receiveInterests(_ServerLoop *serverLoop)
+{
+    const ServerState *serverState = serverLoop->serverState;
+
+    // One timestamp serves every Interest received in this pass.
+    uint64_t now = _getTimeInMicros();
+
+    size_t result = 0;
+    CCNxMetaMessage *inboundMessage = NULL;
+    while (result < _interestQueueCapacity && _canReceiveInterests(serverLoop)
+           && (inboundMessage = ccnxPortal_Receive(serverLoop->portal, CCNxStackTimeout_Immediate)) != NULL) {
+        if (ccnxMetaMessage_IsInterest(inboundMessage)) {
+            CCNxInterest *interest = ccnxMetaMessage_GetInterest(inboundMessage);
+            ccnxSimpleFileTransferMetrics_Increment(serverLoop->metrics,
+                                                    CCNxSimpleFileTransferMetricsCounter_InterestsReceived, 1);
+
+            _InterestPriority priority;
+            char *className = _createInterestClassName(serverState, interest, &priority);
+            if (ccnxSimpleFileTransferFairQueue_Enqueue(serverLoop->interestQueue, className, priority, interest, now)) {
+                ccnxSimpleFileTransferMetrics_Increment(serverLoop->metrics,
+                                                        CCNxSimpleFileTransferMetricsCounter_InterestsDropped, 1);
+            }
+            parcMemory_Deallocate((void **) &className);
+            result++;
+        }
+        ccnxMetaMessage_Release(&inboundMessage);
+    }
+    return result;
+}
+
+/**
+ * Answer up to a batch of the queued Interests, in fair order, as long as there is room to queue the responses.
+ *
+ * @return The number of Interests answered.
+ */
+static size_t
+_answerQueuedInterests(_ServerLoop *serverLoop)
+{
+    uint64_t now = _getTimeInMicros();
+    serverLoop->answerBatchStartTime = ccnxSimpleFileTransferMetrics_StartTimer(serverLoop->metrics);
+
+    size_t result = 0;
+    while (result < _answerBatchSize && serverLoop->sendQueueLength < _sendQueueCapacity) {
+        size_t classNumber;
+        uint64_t waitMicros;
+        CCNxInterest *interest = ccnxSimpleFileTransferFairQueue_Dequeue(serverLoop->interestQueue, now, &classNumber, &waitMicros);
+        if (interest == NULL) {
+            break;
+        }
+        CCNxSimpleFileTransferMetricsHistogram queueLatency = CCNxSimpleFileTransferMetricsHistogram_FetchQueueLatency;
+        if (ccnxSimpleFileTransferFairQueue_GetClassPriority(serverLoop->interestQueue, classNumber) == _InterestPriority_Metadata) {
+            queueLatency = CCNxSimpleFileTransferMetricsHistogram_MetadataQueueLatency;
+        }
+        ccnxSimpleFileTransferMetrics_RecordLatency(serverLoop->metrics, queueLatency, waitMicros * 1000);
+
+        size_t payloadSize = _answerInterest(serverLoop, interest);
+        ccnxSimpleFileTransferFairQueue_Charge(serverLoop->interestQueue, classNumber, payloadSize + _responseOverheadBytes);
+        ccnxInterest_Release(&interest);
+        result++;
+    }
+    return result;
+}
+
+/**
+ * Receive, answer and send until there's nothing more we can do without waiting: no Interests arriving, and none
+ * queued that are within their class's rate, or no room for their responses.
+ */
+static void
+_serveInterests(_ServerLoop *serverLoop)
+{
+    size_t numReceived;
+    size_t numAnswered;
+    do {
+        numReceived = _receiveInterests(serverLoop);
+        numAnswered = _answerQueuedInterests(serverLoop);
+        _sendQueuedResponses(serverLoop);
+    } while (numReceived > 0 || numAnswered > 0);
 }
 
 /**
- * Same as _createFetchResponse(), but pre-calculates ALL of the content objects and stores them in memory for quick retrieval.
+ * Watch the Portal for Interests while we can take them, and for room to send while there are responses queued.
  */
-static CCNxContentObject *
-_createFetchResponseWithPreChunking(const ServerState *serverState, const CCNxName *name,
-                                    const char *fileName, const uint64_t requestedChunkNumber)
+static void
+_updatePortalEvents(_ServerLoop *serverLoop)
 {
-    CCNxContentObject *result = NULL;
+    unsigned int events = 0;
+    if (_canReceiveInterests(serverLoop)) {
+        events |= CCNxSimpleFileTransferEventLoopEvent_Readable;
+    }
+    if (serverLoop->sendQueueLength > 0) {
+        events |= CCNxSimpleFileTransferEventLoopEvent_Writable;
+    }
+    ccnxSimpleFileTransferEventLoop_SetEvents(serverLoop->eventLoop, serverLoop->portalFileDescriptor, events);
+}
 
-    CCNxSimpleFileTransferChunkList *fileChunks = NULL;
+static void
+_onPortalEvents(CCNxSimpleFileTransferEventLoop *eventLoop, int fileDescriptor, unsigned int events, void *context)
+{
+    _ServerLoop *serverLoop = context;
 
-    // Get a copy of the name, but without the chunk number.
-    CCNxName *baseName = ccnxSimpleFileTransferCommon_CreateWithBaseName(name);
+    if (events & CCNxSimpleFileTransferEventLoopEvent_Writable) {
+        _sendQueuedResponses(serverLoop);
+    }
 
-    fileChunks = (CCNxSimpleFileTransferChunkList *) parcHashMap_Get(_contentByFilename, baseName);
-    // We're assuming no name collisions in the hashmap...
+    if (events & (CCNxSimpleFileTransferEventLoopEvent_Readable | CCNxSimpleFileTransferEventLoopEvent_Writable)) {
+        // Take everything that has arrived, and answer what we have room for.
+        _serveInterests(serverLoop);
+    }
 
-    if (fileChunks == NULL) {
-        // Chunk list for this file was empty. Build it. This will take a while.
+    if (events & CCNxSimpleFileTransferEventLoopEvent_Error) {
+        fprintf(stderr, "ccnxSimpleFileTransfer_Server: lost the connection to the Forwarder (error %d).\n",
+                ccnxPortal_GetError(serverLoop->portal));
+        ccnxSimpleFileTransferEventLoop_Stop(eventLoop);
+    }
 
-        // Combine the directoryPath and fileName into the full path name of the desired file
-        size_t filePathBufferSize =
-            strlen(fileName) + strlen(serverState->sourceDirectoryPath) + 2; // +2 for '/' and trailing null.
-        char *fullFilePath = parcMemory_Allocate(filePathBufferSize);
-        assertNotNull(fullFilePath, "parcMemory_Allocate(%zu) returned NULL", filePathBufferSize);
-        snprintf(fullFilePath, filePathBufferSize, "%s/%s", serverState->sourceDirectoryPath, fileName);
+    _updatePortalEvents(serverLoop);
+    ccnxSimpleFileTransferMetrics_Flush(serverLoop->metrics, serverLoop->serverState->metrics);
+}
 
-        fileChunks = _chunkFileIntoMemory(fullFilePath, baseName, serverState->chunkSize);
+static void
+_onStopRequested(CCNxSimpleFileTransferEventLoop *eventLoop, int fileDescriptor, unsigned int events, void *context)
+{
+    // We leave the byte in the pipe, so that every Portal's loop sees it.
+    ccnxSimpleFileTransferEventLoop_Stop(eventLoop);
+}
 
-        if (fileChunks != NULL) {
-            parcHashMap_Put(_contentByFilename, baseName, fileChunks);
-            parcMemory_Deallocate((void **) &fullFilePath);
-        }
-    }
-    ccnxName_Release(&baseName);
+/**
+ * Periodic work that mustn't wait for an Interest to arrive.
+ */
+static void
+_doHousekeeping(CCNxSimpleFileTransferEventLoop *eventLoop, void *context)
+{
+    _ServerLoop *serverLoop = context;
 
-    if (fileChunks != NULL) {
+    // The stack can make room for a message without the Portal's file descriptor becoming writable.
+    _sendQueuedResponses(serverLoop);
+    _serveInterests(serverLoop);
+    _updatePortalEvents(serverLoop);
+    ccnxSimpleFileTransferMetrics_Flush(serverLoop->metrics, serverLoop->serverState->metrics);
+}
 
-        if (requestedChunkNumber < ccnxSimpleFileTransferChunkList_GetNumChunks(fileChunks)) {
-            result = ccnxSimpleFileTransferChunkList_GetChunk(fileChunks, requestedChunkNumber);
-            if (result != NULL) {
-                // We actually want to return a reference to the ContentObject chunk, as
-                // the calling code expects to be able to release what we return.
-                result = ccnxContentObject_Acquire(result);
-            }
-        } else {
-            printf("Requested out of range chunk %lld for %s. Returning NULL\n", requestedChunkNumber, fileName);
-        }
-    }
+/**
+ * Answer the Interests whose classes have come back within their rate.
+ */
+static void
+_serveRateLimitedInterests(CCNxSimpleFileTransferEventLoop *eventLoop, void *context)
+{
+    _ServerLoop *serverLoop = context;
 
-    return result; // Could be NULL if there was no payload
+    if (ccnxSimpleFileTransferFairQueue_GetSize(serverLoop->interestQueue) > 0) {
+        _serveInterests(serverLoop);
+        _updatePortalEvents(serverLoop);
+        ccnxSimpleFileTransferMetrics_Flush(serverLoop->metrics, serverLoop->serverState->metrics);
+    }
 }
 
-
 /**
- * Given a CCNxName, a directory path, and a requested chunk number, create a directory listing and return the specified
- * chunk of the directory listing as the payload of a newly created CCNxContentObject.
- * The new CCnxContentObject must eventually be released by calling ccnxContentObject_Release().
+ * Listen for arriving Interests and respond to them if possible. We expect that the Portal we are passed is
+ * listening for messages matching the specified domainPrefix.
  *
- * @param [in] name The CCNxName to use when creating the new CCNxContentObject.
- * @param [in] directoryPath The directory whose contents are being listed.
- * @param [in] requestedChunkNumber The number of the requested chunk from the complete directory listing.
+ * The Portal is never allowed to block us. We wait in an event loop for its file descriptor to become readable,
+ * and then receive with an immediate timeout until there's nothing left. Responses are queued and sent with an
+ * immediate timeout too, whatever the Portal won't take yet being sent when it becomes writable. This keeps
+ * a slow send from holding up receiving, and lets timers do housekeeping while no Interests are arriving.
  *
- * @return A new CCNxContentObject instance containing the request chunk of the directory listing.
+ * Received Interests are queued by class (see _createInterestClassName()) and answered a few at a time in deficit
+ * round robin order, receiving again between each few, so that a consumer fetching a large file with a wide window
+ * doesn't hold up the Interests of everyone else. Metadata Interests go ahead of fetches, but not so often in a row
+ * that the fetches starve. Each class may also be limited to a rate.
+ *
+ * Each wakeup drains every Interest that has arrived, answers them a batch at a time and hands the batch's
+ * responses to the Portal back to back. The loop's metrics are kept privately and added to the server's once per
+ * wakeup, rather than with a contended atomic add for every message. Queue and send latencies are measured with
+ * one clock read per answer batch and one per send pass; only the time to build each response is timed per message.
+ *
+ * We return when the Portal's connection to the forwarder fails, or when the server is told to stop.
+ *
+ * @param [in] serverState The configuration of the server.
+ * @param [in] portal The CCNxPortal that we will read from.
+ *
+ * @return true if at least one Interest is received and responded to, false otherwise.
  */
-static CCNxContentObject *
-_createListResponse(const ServerState *serverState, CCNxName *name, uint64_t requestedChunkNumber)
+static bool
+_receiveAndAnswerInterests(const ServerState *serverState, CCNxPortal *portal)
 {
-    CCNxContentObject *result = NULL;
-
-    PARCBuffer *directoryList = ccnxSimpleFileTransferFileIO_CreateDirectoryListing(serverState->sourceDirectoryPath);
-
-    uint64_t totalChunksInDirList = _getNumberOfChunksRequired(parcBuffer_Limit(directoryList),
-                                                               serverState->chunkSize);
-    if (requestedChunkNumber < totalChunksInDirList) {
-        // Set the buffer's position to the start of the desired chunk.
-        parcBuffer_SetPosition(directoryList, (requestedChunkNumber * serverState->chunkSize));
+    _ServerLoop serverLoop;
+    memset(&serverLoop, 0, sizeof(serverLoop));
+    serverLoop.serverState = serverState;
+    serverLoop.portal = portal;
+    serverLoop.portalFileDescriptor = ccnxPortal_GetFileId(portal);
+    serverLoop.sendQueue = parcMemory_AllocateAndClear(_sendQueueCapacity * sizeof(_QueuedResponse));
+    assertNotNull(serverLoop.sendQueue, "parcMemory_AllocateAndClear(%zu) returned NULL", _sendQueueCapacity * sizeof(_QueuedResponse));
+    serverLoop.interestQueue = ccnxSimpleFileTransferFairQueue_Create(_interestQueueCapacity,
+                                                                      _InterestPriority_NumPriorities, _maxBulkPassedOver,
+                                                                      serverState->chunkSize + _responseOverheadBytes,
+                                                                      serverState->classBytesPerSecond,
+                                                                      serverState->classBytesPerSecond / 10);
+    if (serverState->metrics != NULL) {
+        serverLoop.metrics = ccnxSimpleFileTransferMetrics_Create("server");
+    }
 
-        // See if we have more than 1 chunk's worth of data to in the buffer. If so, set the buffer's limit
-        // to the end of the chunk.
-        size_t chunkLen = parcBuffer_Remaining(directoryList);
+    serverLoop.eventLoop = ccnxSimpleFileTransferEventLoop_Create();
+    assertNotNull(serverLoop.eventLoop, "Could not create an event loop: %s", strerror(errno));
 
-        if (chunkLen > serverState->chunkSize) {
-            parcBuffer_SetLimit(directoryList,
-                                parcBuffer_Position(directoryList) + serverState->chunkSize);
+    if (ccnxSimpleFileTransferEventLoop_Watch(serverLoop.eventLoop, serverLoop.portalFileDescriptor,
+                                              CCNxSimpleFileTransferEventLoopEvent_Readable, _onPortalEvents, &serverLoop)) {
+        if (_stopPipe[0] >= 0) {
+            ccnxSimpleFileTransferEventLoop_Watch(serverLoop.eventLoop, _stopPipe[0],
+                                                  CCNxSimpleFileTransferEventLoopEvent_Readable, _onStopRequested, NULL);
+        }
+        ccnxSimpleFileTransferEventLoop_AddTimer(serverLoop.eventLoop, _housekeepingPeriodMillis, _doHousekeeping, &serverLoop);
+        if (serverState->classBytesPerSecond > 0) {
+            ccnxSimpleFileTransferEventLoop_AddTimer(serverLoop.eventLoop, _rateLimitPeriodMillis,
+                                                     _serveRateLimitedInterests, &serverLoop);
         }
 
-        // Calculate the final chunk number
-        uint64_t finalChunkNumber = (totalChunksInDirList > 0) ? totalChunksInDirList - 1
-                                                               : 0; // the final chunk, 0-based
-
-        // At this point, dirListBuf has its position and limit set to the beginning and end of the
-        // specified chunk.
-        result = _createContentObject(name, directoryList, finalChunkNumber);
+        ccnxSimpleFileTransferEventLoop_Run(serverLoop.eventLoop);
+    } else {
+        fprintf(stderr, "ccnxSimpleFileTransfer_Server: cannot wait on the Portal's file descriptor (%d).\n",
+                serverLoop.portalFileDescriptor);
     }
 
-    parcBuffer_Release(&directoryList);
+    while (serverLoop.sendQueueLength > 0) {
+        _dequeueResponse(&serverLoop);
+    }
+    parcMemory_Deallocate((void **) &serverLoop.sendQueue);
+    ccnxSimpleFileTransferFairQueue_Release(&serverLoop.interestQueue);
+    ccnxSimpleFileTransferEventLoop_Release(&serverLoop.eventLoop);
+    if (serverLoop.metrics != NULL) {
+        ccnxSimpleFileTransferMetrics_Flush(serverLoop.metrics, serverState->metrics);
+        ccnxSimpleFileTransferMetrics_Release(&serverLoop.metrics);
+    }
 
-    return result;
+    return serverLoop.result;
 }
 
 /**
- * Given a CCnxInterest that matched our domain prefix, see what the embedded command is and
- * create a corresponding CCNxContentObject as a response. The resulting CCNxContentObject
- * must eventually be released by calling ccnxContentObject_Release().
- *
- * @param [in] interest A CCNxInterest that matched the specified domain prefix.
- * @param [in] domainPrefix A CCNxName containing the domain prefix.
- * @param [in] directoryPath A string containing the path to the directory being served.
+ * Run the calling thread only on the specified core (modulo the number of cores), so that a Portal's
+ * receive/build/send loop and its cache stay on one core. Does nothing where thread affinity isn't supported.
  *
- * @return A newly creatd CCNxContentObject contaning a response to the specified Interest,
- *         or NULL if the Interest couldn't be answered.
+ * @param [in] core The number of the core to run on.
  */
-static CCNxContentObject *
-_createInterestResponse(const ServerState *serverState, const CCNxInterest *interest)
+static void
+_pinToCore(unsigned int core)
 {
-    CCNxName *interestName = ccnxInterest_GetName(interest);
-
-    char *command = ccnxSimpleFileTransferCommon_CreateCommandStringFromName(interestName,
-                                                                             (const CCNxName *) serverState->namePrefix);
-
-    uint64_t requestedChunkNumber = ccnxSimpleFileTransferCommon_GetChunkNumberFromName(interestName);
+#ifdef __linux__
+    long numCores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (numCores > 0) {
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(core % numCores, &cpuSet);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+    }
+#endif
+}
 
-    CCNxContentObject *result = NULL;
-    if (strncasecmp(command, ccnxSimpleFileTransferCommon_CommandList, strlen(command)) == 0) {
-        // This was a 'list' command. We should return the requested chunk of the directory listing.
-        result = _createListResponse(serverState, interestName, requestedChunkNumber);
-    } else if (strncasecmp(command, ccnxSimpleFileTransferCommon_CommandFetch, strlen(command)) == 0) {
-        // This was a 'fetch' command. We should return the requested chunk of the file specified.
-        char *fileName = ccnxSimpleFileTransferCommon_CreateFileNameFromName(interestName);
+/**
+ * Create an empty cache for pre-chunked files. If it is limited in size, files are only admitted
+ * if they are popular enough.
+ */
+static CCNxSimpleFileTransferChunkCache *
+_createChunkCache(const ServerState *serverState)
+{
+    CCNxSimpleFileTransferAdmissionFilter *admissionFilter = NULL;
+    if (serverState->cacheCapacityBytes > 0) {
+        admissionFilter = ccnxSimpleFileTransferAdmissionFilter_Create(_admissionFilterExpectedFiles);
+    }
 
-        if (serverState->doPreChunkIntoMemory) {
-            result = _createFetchResponseWithPreChunking(serverState,
-                                                         interestName,
-                                                         fileName,
-                                                         requestedChunkNumber);
-        } else {
-            result = _createFetchResponse(serverState,
-                                          interestName,
-                                          fileName,
-                                          requestedChunkNumber);
-        }
+    CCNxSimpleFileTransferChunkCache *result = ccnxSimpleFileTransferChunkCache_Create(serverState->cacheCapacityBytes,
+                                                                                       admissionFilter);
+    if (admissionFilter != NULL) {
+        ccnxSimpleFileTransferAdmissionFilter_Release(&admissionFilter);
+    }
+    return result;
+}
 
-        parcMemory_Deallocate((void **) &fileName);
-    } else {
-        printf("_createInterestResponse() called with unknown command: %s\n", command);
+/**
+ * Create the base name (without the chunk number) under which a Portal serves the chunks of a file for the given
+ * fetch command, or of a version of the file if the version isn't 0.
+ * The new CCNxName must eventually be released by calling ccnxName_Release().
+ */
+static CCNxName *
+_createFetchBaseName(const CCNxName *namePrefix, const char *command, const char *fileName, uint64_t version)
+{
+    CCNxName *result = ccnxName_Copy(namePrefix);
+
+    const char *segments[] = { command, fileName };
+    for (size_t i = 0; i < sizeof(segments) / sizeof(segments[0]); i++) {
+        PARCBuffer *value = parcBuffer_WrapCString((char *) segments[i]);
+        CCNxNameSegment *segment = ccnxNameSegment_CreateTypeValue(CCNxNameLabelType_NAME, value);
+        ccnxName_Append(result, segment);
+        ccnxNameSegment_Release(&segment);
+        parcBuffer_Release(&value);
     }
 
-    parcMemory_Deallocate((void **) &command);
+    if (version != 0) {
+        CCNxNameSegment *versionSegment = ccnxNameSegmentNumber_Create(CCNxNameLabelType_SERIAL, version);
+        ccnxName_Append(result, versionSegment);
+        ccnxNameSegment_Release(&versionSegment);
+    }
 
     return result;
 }
 
 /**
- * Listen for arriving Interests and respond to them if possible. We expect that the Portal we are passed is
- * listening for messages matching the specified domainPrefix.
- *
- * @param [in] portal The CCNxPortal that we will read from.
- * @param [in] domainPrefix A CCNxName containing the domain prefix that the specified `portal` is listening for.
- * @param [in] directoryPath A string containing the path to the directory being served.
+ * The Portals whose caches are being warmed.
+ */
+typedef struct serverWarming {
+    _ServerShard *shards;
+    unsigned int numShards;
+} _ServerWarming;
+
+/**
+ * Pre-chunk a file from the warm list into the cache of each Portal that serves it, unless they have already
+ * cached it or have no room left. Called on the warming threads while the Portals serve requests.
  *
- * @return true if at least one Interest is received and responded to, false otherwise.
+ * The list names the keys the files were cached under. A versioned key, e.g. "file.txt/1234", is for clients that
+ * fetch by version, so the file is warmed at whatever version it is now: that is the version they will ask for.
+ * A key ending in "/z", e.g. "file.txt/1234/z", is for the compressed chunks of a version.
  */
 static bool
-_receiveAndAnswerInterests(const ServerState *serverState, CCNxPortal *portal)
+_warmFile(void *loaderContext, CCNxSimpleFileTransferCacheWarmer *warmer, const char *listEntry)
 {
+    _ServerWarming *warming = loaderContext;
     bool result = false;
-    CCNxMetaMessage *inboundMessage = NULL;
-
-    while ((inboundMessage = ccnxPortal_Receive(portal, CCNxStackTimeout_Never)) != NULL) {
-        if (ccnxMetaMessage_IsInterest(inboundMessage)) {
-            CCNxInterest *interest = ccnxMetaMessage_GetInterest(inboundMessage);
-
-            if (serverState->beVerbose) {
-                CCNxName *interestName = ccnxInterest_GetName(interest);
-                char *nameString = ccnxName_ToString(interestName);
-                uint64_t requestedChunkNumber = ccnxSimpleFileTransferCommon_GetChunkNumberFromName(interestName);
-                printf("<- Received interest for [%s] (chunk #%" PRIu64 ")\n", nameString, requestedChunkNumber);
-                parcMemory_Deallocate(&nameString);
-            }
 
-            CCNxContentObject *response = _createInterestResponse(serverState, interest);
+    const char *versionSeparator = strchr(listEntry, '/');
+    size_t fileNameLength = (versionSeparator != NULL) ? (size_t) (versionSeparator - listEntry) : strlen(listEntry);
+    char *fileName = parcMemory_StringDuplicate(listEntry, fileNameLength);
 
-            // At this point, response has either the requested chunk of the request file/command,
-            // or remains NULL.
+    unsigned int firstShard = 0;
+    unsigned int endShard = warming->numShards;
+    if (warming->shards[0].state.shardByFileName) {
+        firstShard = ccnxSimpleFileTransferCommon_GetShardForFileName(fileName, warming->numShards);
+        endShard = firstShard + 1;
+    }
+    const ServerState *serverState = &warming->shards[firstShard].state;
+
+    char *fullFilePath = _createFullFilePath(serverState, fileName);
+
+    size_t fileSize = 0;
+    uint64_t currentVersion = 0;
+    if (ccnxSimpleFileTransferFileIO_GetFileVersion(fullFilePath, &fileSize, &currentVersion)) {
+        uint64_t version = (versionSeparator != NULL) ? currentVersion : 0;
+        size_t suffixLength = strlen(_compressedCacheKeySuffix);
+        bool isCompressed = version != 0 && strlen(versionSeparator) > suffixLength
+                            && strcmp(listEntry + strlen(listEntry) - suffixLength, _compressedCacheKeySuffix) == 0;
+        char *cacheKey = isCompressed ? _createCompressedCacheKey(fileName, version) : _createCacheKey(fileName, version);
+
+        bool isWanted = false;
+        for (unsigned int i = firstShard; i < endShard && !isWanted; i++) {
+            isWanted = ccnxSimpleFileTransferChunkCache_HasRoomFor(warming->shards[i].state.chunkCache, cacheKey, fileSize);
+        }
 
-            if (serverState->beVerbose) {
-                if (response != NULL) {
-                    PARCBuffer *payload = ccnxContentObject_GetPayload(response);
-                    size_t payloadSize = 0;
-                    if (payload != NULL) {
-                        payloadSize = parcBuffer_Limit(payload);
+        if (isWanted) {
+            const char *command = isCompressed ? ccnxSimpleFileTransferCommon_CommandFetchCompressed
+                                               : ccnxSimpleFileTransferCommon_CommandFetch;
+            CCNxName *baseName = _createFetchBaseName(serverState->namePrefix, command, fileName, version);
+            CCNxSimpleFileTransferChunkList *fileChunks =
+                _chunkFileIntoMemory(serverState, fileName, fullFilePath, baseName, version, isCompressed, warmer);
+            ccnxName_Release(&baseName);
+
+            if (fileChunks != NULL) {
+                for (unsigned int i = firstShard; i < endShard; i++) {
+                    // A request may have cached the file meanwhile, which is fine.
+                    if (ccnxSimpleFileTransferChunkCache_PutIfRoom(warming->shards[i].state.chunkCache, cacheKey,
+                                                                   fileChunks, fileSize)) {
+                        result = true;
                     }
-                    printf(" -> Responding with %ld bytes\n", payloadSize);
                 }
+                ccnxSimpleFileTransferChunkList_Release(&fileChunks);
             }
+        }
+        parcMemory_Deallocate((void **) &cacheKey);
+    }
+    parcMemory_Deallocate((void **) &fullFilePath);
+    parcMemory_Deallocate((void **) &fileName);
 
-            if (response != NULL) {
-                // We had a response, so send it back through the Portal.
-                CCNxMetaMessage *responseMessage = ccnxMetaMessage_CreateFromContentObject(response);
+    return result;
+}
 
-                if (ccnxPortal_Send(portal, responseMessage, CCNxStackTimeout_Never) == false) {
-                    fprintf(stderr, "ccnxPortal_Send failed (error %d). Is the Forwarder running?\n",
-                            ccnxPortal_GetError(portal));
-                }
+static void
+_writeWarmListEntry(void *callbackContext, const char *cacheKey, size_t sizeBytes)
+{
+    fprintf((FILE *) callbackContext, "%s %zu\n", cacheKey, sizeBytes);
+}
 
-                ccnxMetaMessage_Release(&responseMessage);
-                ccnxContentObject_Release(&response);
+/**
+ * Save the names of the files in each Portal's cache, most recently used first, so that the next run of the
+ * server can warm its caches with them. The list is written to a temporary file which then replaces the old list,
+ * so it is never left half written.
+ */
+static void
+_saveWarmList(const char *warmListPath, _ServerShard *shards, unsigned int numShards)
+{
+    size_t tempPathSize = strlen(warmListPath) + sizeof(".tmp");
+    char *tempPath = parcMemory_Allocate(tempPathSize);
+    assertNotNull(tempPath, "parcMemory_Allocate(%zu) returned NULL", tempPathSize);
+    snprintf(tempPath, tempPathSize, "%s.tmp", warmListPath);
+
+    FILE *file = fopen(tempPath, "w");
+    if (file != NULL) {
+        fprintf(file, "# The files cached by ccnxSimpleFileTransfer_Server, most recently used first.\n");
+        for (unsigned int i = 0; i < numShards; i++) {
+            ccnxSimpleFileTransferChunkCache_ForEachKey(shards[i].state.chunkCache, _writeWarmListEntry, file);
+        }
+        bool isWritten = (fclose(file) == 0);
 
-                result = true; // We have received, and responded to, at least one Interest.
-            }
+        if (isWritten && rename(tempPath, warmListPath) == 0) {
+            printf("## Saved the cached files to %s\n", warmListPath);
+        } else {
+            fprintf(stderr, "Could not save the cached files to '%s': %s\n", warmListPath, strerror(errno));
+            unlink(tempPath);
         }
-        ccnxMetaMessage_Release(&inboundMessage);
+    } else {
+        fprintf(stderr, "Could not save the cached files to '%s': %s\n", tempPath, strerror(errno));
     }
 
-    return result;
+    parcMemory_Deallocate((void **) &tempPath);
+}
+
+static void *
+_runShard(void *arg)
+{
+    _ServerShard *shard = arg;
+
+    _pinToCore(shard->state.shardNumber);
+    shard->result = _receiveAndAnswerInterests(&shard->state, shard->portal);
+
+    return NULL;
 }
 
 /**
  * Using the CCNxPortal API, listen for and respond to Interests matching our domain prefix (as defined in ccnxSimpleFileTransfer_Common.c).
  * The specified directoryPath is the location of the directory from which file and listing responses will originate.
  *
+ * A single Portal is a single connection to the forwarder, so the server can open several, each answered by
+ * its own thread with its own cache of pre-chunked files. Either every Portal listens on the domain prefix
+ * (and the forwarder spreads Interests across them), or, when sharding by file name, each listens on its own
+ * sub-prefix and serves only the files that hash to it, so each file is only ever cached by one of them.
+ *
  * @param [in] directoryPath A string containing the path to the directory being served.
  *
  * @return true if at least one Interest is received and responded to, false otherwise.
@@ -492,17 +1960,108 @@ _serveFiles(ServerState *serverState)
 
     CCNxPortalFactory *factory = _setupServerPortalFactory();
 
-    CCNxPortal *portal = ccnxPortalFactory_CreatePortal(factory, ccnxPortalRTA_Message);
+    // Chunks kept in the chunk store are signed with the same identity the Portals would sign them with.
+    if (serverState->chunkStore != NULL) {
+        serverState->chunkSigner = parcIdentity_CreateSigner(ccnxPortalFactory_GetIdentity(factory),
+                                                             PARCCryptoSuite_RSA_SHA256);
+    }
 
-    assertNotNull(portal, "Expected a non-null CCNxPortal pointer. Is the Forwarder running?");
+    unsigned int numShards = serverState->numPortals;
+    _ServerShard *shards = parcMemory_AllocateAndClear(numShards * sizeof(_ServerShard));
+    assertNotNull(shards, "parcMemory_AllocateAndClear(%zu) returned NULL", numShards * sizeof(_ServerShard));
 
     time_t secondsToLive = 365 * 86400; // 365 days
-    if (ccnxPortal_Listen(portal, serverState->namePrefix, secondsToLive, CCNxStackTimeout_Never)) {
+    unsigned int numListening = 0;
+
+    for (unsigned int i = 0; i < numShards; i++) {
+        _ServerShard *shard = &shards[i];
+        shard->state = *serverState;
+        shard->state.shardNumber = i;
+        shard->state.chunkCache = _createChunkCache(serverState);
+        shard->state.signatureCache = ccnxSimpleFileTransferChunkCache_Create(_signatureCacheCapacityBytes, NULL);
+        shard->state.digestCache = ccnxSimpleFileTransferChunkCache_Create(_digestCacheCapacityBytes, NULL);
+        shard->state.codecCache = ccnxSimpleFileTransferChunkCache_Create(_codecCacheCapacityBytes, NULL);
+        shard->state.compressor = ccnxSimpleFileTransferCompressor_Create();
+        shard->state.openFiles = ccnxSimpleFileTransferOpenFileCache_Create(_openFileCacheCapacity);
+        if (serverState->inFlightTable == NULL) {
+            // A response in the in-flight table is handed to other Portals, so its payload can't come from a pool
+            // that only this Portal's thread checks.
+            shard->state.payloadPool = ccnxSimpleFileTransferBufferPool_Create(serverState->chunkSize, _payloadPoolCapacity);
+        }
+        if (serverState->shardByFileName) {
+            shard->state.namePrefix = ccnxSimpleFileTransferCommon_CreateShardPrefix(serverState->namePrefix, i);
+        } else {
+            shard->state.namePrefix = ccnxName_Acquire(serverState->namePrefix);
+        }
+
+        shard->portal = ccnxPortalFactory_CreatePortal(factory, ccnxPortalRTA_Message);
+
+        assertNotNull(shard->portal, "Expected a non-null CCNxPortal pointer. Is the Forwarder running?");
+
+        if (ccnxPortal_Listen(shard->portal, shard->state.namePrefix, secondsToLive, CCNxStackTimeout_Never)) {
+            numListening++;
+        } else {
+            ccnxPortal_Release(&shard->portal);
+        }
+    }
+
+    if (numListening == numShards) {
+        // Pre-chunk the files in the warm list in the background, while serving.
+        CCNxSimpleFileTransferCacheWarmer *warmer = NULL;
+        _ServerWarming warming = { .shards = shards, .numShards = numShards };
+        if (serverState->doPreChunkIntoMemory && serverState->warmListPath != NULL) {
+            warmer = ccnxSimpleFileTransferCacheWarmer_Create(_warmFile, &warming, _numWarmingThreads,
+                                                              serverState->warmBytesPerSecond);
+            int numFiles = ccnxSimpleFileTransferCacheWarmer_AddNamesFromFile(warmer, serverState->warmListPath);
+            if (numFiles > 0) {
+                printf("## Pre-chunking the %d files listed in %s\n", numFiles, serverState->warmListPath);
+                ccnxSimpleFileTransferCacheWarmer_Start(warmer);
+            }
+        }
+
         printf("ccnxSimpleFileTransfer_Server: now serving files from %s\n", serverState->sourceDirectoryPath);
-        result = _receiveAndAnswerInterests(serverState, portal);
+
+        if (numShards == 1) {
+            result = _receiveAndAnswerInterests(&shards[0].state, shards[0].portal);
+        } else {
+            for (unsigned int i = 0; i < numShards; i++) {
+                int failure = pthread_create(&shards[i].thread, NULL, _runShard, &shards[i]);
+                assertTrue(failure == 0, "Could not start the thread for Portal %u: %s", i, strerror(failure));
+            }
+            for (unsigned int i = 0; i < numShards; i++) {
+                pthread_join(shards[i].thread, NULL);
+                result = result || shards[i].result;
+            }
+        }
+
+        if (warmer != NULL) {
+            ccnxSimpleFileTransferCacheWarmer_Stop(warmer);
+            ccnxSimpleFileTransferCacheWarmer_Release(&warmer);
+
+            _saveWarmList(serverState->warmListPath, shards, numShards);
+        }
     }
 
-    ccnxPortal_Release(&portal);
+    for (unsigned int i = 0; i < numShards; i++) {
+        if (shards[i].portal != NULL) {
+            ccnxPortal_Release(&shards[i].portal);
+        }
+        ccnxName_Release(&shards[i].state.namePrefix);
+        ccnxSimpleFileTransferChunkCache_Release(&shards[i].state.chunkCache);
+        ccnxSimpleFileTransferChunkCache_Release(&shards[i].state.signatureCache);
+        ccnxSimpleFileTransferChunkCache_Release(&shards[i].state.digestCache);
+        ccnxSimpleFileTransferChunkCache_Release(&shards[i].state.codecCache);
+        ccnxSimpleFileTransferCompressor_Release(&shards[i].state.compressor);
+        ccnxSimpleFileTransferOpenFileCache_Release(&shards[i].state.openFiles);
+        if (shards[i].state.payloadPool != NULL) {
+            ccnxSimpleFileTransferBufferPool_Release(&shards[i].state.payloadPool);
+        }
+    }
+    parcMemory_Deallocate((void **) &shards);
+
+    if (serverState->chunkSigner != NULL) {
+        parcSigner_Release(&serverState->chunkSigner);
+    }
     ccnxPortalFactory_Release(&factory);
 
     return result;
@@ -522,11 +2081,32 @@ _displayUsage(char *programName)
     printf(" A CCNx forwarder (e.g. Metis or Athena) must be running before running it. Once running, the peer\n");
     printf(" ccnxSimpleFileTransfer_Client application can request a listing or a specified file.\n\n");
 
-    printf("Usage: %s [-h] [-s chunkSizeInBytes] [-m] [-l <name>] <directory path>\n", programName);
+    printf("Usage: %s [-h] [-s chunkSizeInBytes] [-m [-c <MB>] [-w <file> [-r <KB/s>]] [-C <dir>]] [-M <target>] [-t <trace file>] [-p <count> | -S <count>] [-a <ms>] [-R <KB/s>]\n",
+           programName);
+    printf("          [-l <name>] <directory path>\n");
     printf("    -l <CCN name> specifies the name the server will listen for.\n");
     printf("    -s <size in bytes> specifies the size of the chunks to be returned.\n");
     printf("    -m specifies that files should be pre-chunked into memory. This increases\n");
     printf("       performance at the expense of memory.\n");
+    printf("    -c <MB> limits the memory used by -m, per Portal, to <MB> megabytes. Only files requested more often\n");
+    printf("       recently than the files they would evict are pre-chunked. Other files are served from disk.\n");
+    printf("    -w <file> pre-chunks the files listed in <file>, one per line, in the background at startup, as far as\n");
+    printf("       the cache has room for them. When the server stops, the files it has cached are saved to <file>.\n");
+    printf("    -r <KB/s> limits how fast -w reads the files, so that it doesn't slow down the requests being served.\n");
+    printf("    -C <dir> keeps the signed chunks of pre-chunked files in <dir>, and reuses them while the files are\n");
+    printf("       unchanged, so that a restarted server doesn't have to chunk and sign the files again.\n");
+    printf("    -M <target> exports metrics in the Prometheus text format. <target> is either a file, which\n");
+    printf("       is rewritten every second, or 'unix:<path>' to serve them on a Unix domain socket.\n");
+    printf("    -t <trace file> records a binary trace of where time is spent on each Interest. Convert it\n");
+    printf("       for chrome://tracing or Perfetto with ccnxSimpleFileTransfer_TraceConvert.\n");
+    printf("    -p <count> serves from <count> Portals, one per core, each listening on the same name.\n");
+    printf("    -S <count> serves from <count> Portals, one per core, each listening on its own sub-prefix and\n");
+    printf("       serving only the files that hash to it. Clients must be given the same '-S <count>'.\n");
+    printf("    -a <ms> builds each response once for all the identical Interests that arrive while it is being built,\n");
+    printf("       or within <ms> milliseconds afterwards, even on different Portals. Use this when many clients\n");
+    printf("       fetch the same file at once through a forwarder without a cache.\n");
+    printf("    -R <KB/s> limits how fast the Interests for each file, and those for the listing, are answered. Whatever\n");
+    printf("       the limit, they take turns, so that a 'list' doesn't wait behind a large 'fetch'.\n");
     printf("Examples:\n");
     printf("  '%s ~/files' will serve the files in ~/files\n", programName);
     printf("  '%s -l ccnx:/foo/bar -d ~/files' will serve the files in ~/files, \n", programName);
@@ -548,9 +2128,19 @@ _dumpState(ServerState *config)
 
     printf("  namePrefix:    [%s]\n", nameString == NULL ? "MISSING" : nameString);
     printf("  doPreChunk:    [%s]\n", config->doPreChunkIntoMemory ? "true" : "false");
+    printf("  cacheBytes:    [%zu]\n", config->cacheCapacityBytes);
+    printf("  warmList:      [%s]\n", config->warmListPath == NULL ? "" : config->warmListPath);
+    printf("  warmBytes/s:   [%" PRIu64 "]\n", config->warmBytesPerSecond);
+    printf("  chunkStore:    [%s]\n", config->chunkStorePath == NULL ? "" : config->chunkStorePath);
     printf("  directoryPath: [%s]\n", config->sourceDirectoryPath == NULL ? "MISSING" : config->sourceDirectoryPath);
     printf("  chunkSize:     [%ld]\n", config->chunkSize);
     printf("  beVerbose:     [%s]\n", config->beVerbose ? "true" : "false");
+    printf("  metrics:       [%s]\n", config->metricsTarget == NULL ? "" : config->metricsTarget);
+    printf("  traceFile:     [%s]\n", config->traceFileName == NULL ? "" : config->traceFileName);
+    printf("  numPortals:    [%u]\n", config->numPortals);
+    printf("  shardByName:   [%s]\n", config->shardByFileName ? "true" : "false");
+    printf("  aggregateMs:   [%d]\n", config->aggregationMillis);
+    printf("  classBytes/s:  [%" PRIu64 "]\n", config->classBytesPerSecond);
 
     if (nameString != NULL) {
         parcMemory_Deallocate(&nameString);
@@ -561,7 +2151,7 @@ static bool
 _parseCommandLine(int argc, char *argv[], ServerState *serverState)
 {
     int c;
-    while ((c = getopt(argc, argv, "l:s:mhv")) != -1) {
+    while ((c = getopt(argc, argv, "l:s:mc:w:r:C:M:t:p:S:a:R:hv")) != -1) {
         switch (c) {
             case 'l': // -l ccnx:/foo/bar
                 if (serverState->namePrefix != NULL) {
@@ -575,14 +2165,48 @@ _parseCommandLine(int argc, char *argv[], ServerState *serverState)
             case 'm': // -m
                 serverState->doPreChunkIntoMemory = true;
                 break;
+            case 'c': // -c 512
+                serverState->cacheCapacityBytes = (size_t) strtoull(optarg, NULL, 10) * 1024 * 1024;
+                break;
+            case 'w': // -w /var/tmp/server.warm
+                serverState->warmListPath = optarg;
+                break;
+            case 'r': // -r 10240
+                serverState->warmBytesPerSecond = strtoull(optarg, NULL, 10) * 1024;
+                break;
+            case 'C': // -C /var/cache/sft
+                serverState->chunkStorePath = optarg;
+                break;
             case 'v': // -v (verbose)
                 serverState->beVerbose = true;
                 break;
+            case 'M': // -M /tmp/server.prom or -M unix:/tmp/server.sock
+                serverState->metricsTarget = optarg;
+                break;
+            case 't': // -t /tmp/server.trace
+                serverState->traceFileName = optarg;
+                break;
+            case 'p': // -p 8
+                serverState->numPortals = atoi(optarg);
+                serverState->shardByFileName = false;
+                break;
+            case 'S': // -S 8
+                serverState->numPortals = atoi(optarg);
+                serverState->shardByFileName = true;
+                break;
+            case 'a': // -a 50
+                serverState->aggregationMillis = atoi(optarg);
+                break;
+            case 'R': // -R 1024
+                serverState->classBytesPerSecond = strtoull(optarg, NULL, 10) * 1024;
+                break;
             case 'h':
                 _displayUsage(argv[0]);
                 return false;
             case '?':
-                if (optopt == 'l' || optopt == 's') {
+                if (optopt == 'l' || optopt == 's' || optopt == 'M' || optopt == 't'
+                    || optopt == 'p' || optopt == 'S' || optopt == 'a' || optopt == 'c'
+                    || optopt == 'w' || optopt == 'r' || optopt == 'C' || optopt == 'R') {
                     fprintf(stderr, "Option -%c requires an argument.\n", optopt);
                 } else if (isascii(optopt)) {
                     fprintf(stderr, "Unknown option `-%c'.\n", optopt);
@@ -604,10 +2228,40 @@ _parseCommandLine(int argc, char *argv[], ServerState *serverState)
     return true;
 }
 
+/**
+ * The server normally runs until it is interrupted. Rather than exiting from the signal handler, wake every
+ * Portal's event loop through the stop pipe, so that they finish cleanly and the trace, if any, is saved.
+ * A second signal stops the server immediately.
+ */
+static void
+_requestStop(int signalNumber)
+{
+    ssize_t numWritten = write(_stopPipe[1], "x", 1);
+    (void) numWritten;
+}
+
+static void
+_stopOnSignals(void)
+{
+    if (pipe(_stopPipe) == 0) {
+        fcntl(_stopPipe[1], F_SETFL, O_NONBLOCK);
+
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = _requestStop;
+        action.sa_flags = SA_RESETHAND;
+        sigemptyset(&action.sa_mask);
+
+        sigaction(SIGINT, &action, NULL);
+        sigaction(SIGTERM, &action, NULL);
+    }
+}
+
 static bool
 _isStateValid(ServerState *serverState)
 {
     return (serverState->chunkSize > 0)
+           && (serverState->numPortals > 0)
            && (serverState->sourceDirectoryPath != 0)
            && (serverState->namePrefix != NULL);
 }
@@ -623,12 +2277,93 @@ main(int argc, char *argv[argc])
     serverState.namePrefix = ccnxName_CreateFromCString(ccnxSimpleFileTransferCommon_NamePrefix);
     serverState.sourceDirectoryPath = NULL;
     serverState.beVerbose = false;
+    serverState.metricsTarget = NULL;
+    serverState.metrics = NULL;
+    serverState.traceFileName = NULL;
+    serverState.numPortals = 1;
+    serverState.shardByFileName = false;
+    serverState.shardNumber = 0;
+    serverState.chunkCache = NULL;
+    serverState.signatureCache = NULL;
+    serverState.digestCache = NULL;
+    serverState.codecCache = NULL;
+    serverState.compressor = NULL;
+    serverState.openFiles = NULL;
+    serverState.payloadPool = NULL;
+    serverState.cacheCapacityBytes = 0;
+    serverState.aggregationMillis = -1;
+    serverState.inFlightTable = NULL;
+    serverState.payloadTable = NULL;
+    serverState.warmListPath = NULL;
+    serverState.warmBytesPerSecond = 0;
+    serverState.chunkStorePath = NULL;
+    serverState.chunkStore = NULL;
+    serverState.chunkSigner = NULL;
+    serverState.classBytesPerSecond = 0;
 
     if (_parseCommandLine(argc, argv, &serverState)) {
         if (_isStateValid(&serverState)) {
             _dumpState(&serverState);
-            _contentByFilename = parcHashMap_Create();
+
+            if (serverState.warmListPath != NULL && !serverState.doPreChunkIntoMemory) {
+                fprintf(stderr, "Ignoring '-w %s', as files are only cached with -m.\n", serverState.warmListPath);
+            }
+
+            if (serverState.chunkStorePath != NULL) {
+                if (!serverState.doPreChunkIntoMemory) {
+                    fprintf(stderr, "Ignoring '-C %s', as files are only chunked in advance with -m.\n",
+                            serverState.chunkStorePath);
+                } else {
+                    serverState.chunkStore = ccnxSimpleFileTransferChunkStore_Create(serverState.chunkStorePath);
+                    if (serverState.chunkStore == NULL) {
+                        fprintf(stderr, "Could not use '%s' as a chunk store: %s\n", serverState.chunkStorePath,
+                                strerror(errno));
+                    }
+                }
+            }
+
+            if (serverState.metricsTarget != NULL) {
+                serverState.metrics = ccnxSimpleFileTransferMetrics_Create("server");
+                if (!ccnxSimpleFileTransferMetrics_StartExporter(serverState.metrics, serverState.metricsTarget, 1)) {
+                    fprintf(stderr, "Could not export metrics to '%s'.\n", serverState.metricsTarget);
+                }
+            }
+
+            if (serverState.traceFileName != NULL) {
+                if (!ccnxSimpleFileTransferTrace_Open(serverState.traceFileName)) {
+                    fprintf(stderr, "Could not write the trace file '%s'.\n", serverState.traceFileName);
+                }
+            }
+
+            if (serverState.aggregationMillis >= 0) {
+                serverState.inFlightTable = ccnxSimpleFileTransferInFlightTable_Create(serverState.aggregationMillis);
+            }
+
+            if (serverState.doPreChunkIntoMemory) {
+                serverState.payloadTable = ccnxSimpleFileTransferPayloadTable_Create();
+            }
+
+            _stopOnSignals();
+
             status = (_serveFiles(&serverState) ? EXIT_SUCCESS : EXIT_FAILURE);
+
+            ccnxSimpleFileTransferTrace_Close();
+
+            if (serverState.inFlightTable != NULL) {
+                ccnxSimpleFileTransferInFlightTable_Release(&serverState.inFlightTable);
+            }
+
+            if (serverState.payloadTable != NULL) {
+                ccnxSimpleFileTransferPayloadTable_Release(&serverState.payloadTable);
+            }
+
+            if (serverState.chunkStore != NULL) {
+                ccnxSimpleFileTransferChunkStore_Release(&serverState.chunkStore);
+            }
+
+            if (serverState.metrics != NULL) {
+                ccnxSimpleFileTransferMetrics_Release(&serverState.metrics);
+            }
         } else {
             _displayUsage(argv[0]);
             printf("Cannot proceed with the specified parameters - stopping.\n");
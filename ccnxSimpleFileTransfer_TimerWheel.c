@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "ccnxSimpleFileTransfer_TimerWheel.h"
+
+/**
+ * Each level has 64 slots, so which of them hold timers fits in one word, and the next one that does is found
+ * with a single instruction.
+ */
+#define _slotBits 6
+#define _slotsPerLevel (1 << _slotBits)
+#define _numLevels 6
+
+static const uint64_t _slotMask = _slotsPerLevel - 1;
+
+/**
+ * The slot of a timer that has expired but hasn't been taken yet.
+ */
+static const uint16_t _expiredSlot = UINT16_MAX;
+
+struct ccnxSimpleFileTransfer_TimerWheel {
+    uint64_t tickMicros;
+    uint64_t currentTick;                   // The next tick to expire timers in.
+
+    CCNxSimpleFileTransferTimer slots[_numLevels * _slotsPerLevel]; // The head of each slot's circular list.
+    uint64_t isOccupied[_numLevels];        // A bit for each slot of each level that holds a timer.
+    CCNxSimpleFileTransferTimer expired;    // Timers that have expired but haven't been taken yet.
+
+    size_t numInSlots;
+    size_t numExpired;
+};
+
+void
+ccnxSimpleFileTransferTimer_Init(CCNxSimpleFileTransferTimer *timer)
+{
+    timer->next = NULL;
+    timer->previous = NULL;
+    timer->dueTick = 0;
+    timer->slot = 0;
+    timer->isScheduled = false;
+}
+
+bool
+ccnxSimpleFileTransferTimer_IsScheduled(const CCNxSimpleFileTransferTimer *timer)
+{
+    return timer->isScheduled;
+}
+
+static void
+_initList(CCNxSimpleFileTransferTimer *head)
+{
+    head->next = head;
+    head->previous = head;
+}
+
+static void
+_append(CCNxSimpleFileTransferTimer *head, CCNxSimpleFileTransferTimer *timer)
+{
+    timer->previous = head->previous;
+    timer->next = head;
+    head->previous->next = timer;
+    head->previous = timer;
+}
+
+static void
+_unlink(CCNxSimpleFileTransferTimer *timer)
+{
+    timer->previous->next = timer->next;
+    timer->next->previous = timer->previous;
+    timer->next = NULL;
+    timer->previous = NULL;
+}
+
+parcObject_ExtendPARCObject(CCNxSimpleFileTransferTimerWheel, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+
+parcObject_ImplementAcquire(ccnxSimpleFileTransferTimerWheel, CCNxSimpleFileTransferTimerWheel);
+
+parcObject_ImplementRelease(ccnxSimpleFileTransferTimerWheel, CCNxSimpleFileTransferTimerWheel);
+
+CCNxSimpleFileTransferTimerWheel *
+ccnxSimpleFileTransferTimerWheel_Create(uint64_t tickMicros, uint64_t nowMicros)
+{
+    assertTrue(tickMicros > 0, "The tick length must be greater than zero");
+
+    CCNxSimpleFileTransferTimerWheel *result = parcObject_CreateAndClearInstance(CCNxSimpleFileTransferTimerWheel);
+
+    result->tickMicros = tickMicros;
+    result->currentTick = nowMicros / tickMicros + 1;
+    for (size_t i = 0; i < _numLevels * _slotsPerLevel; i++) {
+        _initList(&result->slots[i]);
+    }
+    _initList(&result->expired);
+
+    return result;
+}
+
+/**
+ * Put a scheduled timer in the slot of the lowest level that reaches its due tick from the current one.
+ */
+static void
+_insert(CCNxSimpleFileTransferTimerWheel *wheel, CCNxSimpleFileTransferTimer *timer)
+{
+    uint64_t ticksAhead = timer->dueTick - wheel->currentTick;
+
+    unsigned int level = 0;
+    while (level < _numLevels - 1 && ticksAhead >= (1ULL << (_slotBits * (level + 1)))) {
+        level++;
+    }
+    unsigned int index = (unsigned int) ((timer->dueTick >> (_slotBits * level)) & _slotMask);
+
+    timer->slot = (uint16_t) (level * _slotsPerLevel + index);
+    _append(&wheel->slots[timer->slot], timer);
+    wheel->isOccupied[level] |= 1ULL << index;
+}
+
+/**
+ * Take a timer out of its slot, or out of the expired list.
+ */
+static void
+_remove(CCNxSimpleFileTransferTimerWheel *wheel, CCNxSimpleFileTransferTimer *timer)
+{
+    _unlink(timer);
+    if (timer->slot == _expiredSlot) {
+        wheel->numExpired--;
+    } else {
+        CCNxSimpleFileTransferTimer *head = &wheel->slots[timer->slot];
+        if (head->next == head) {
+            wheel->isOccupied[timer->slot / _slotsPerLevel] &= ~(1ULL << (timer->slot % _slotsPerLevel));
+        }
+        wheel->numInSlots--;
+    }
+}
+
+void
+ccnxSimpleFileTransferTimerWheel_Cancel(CCNxSimpleFileTransferTimerWheel *wheel, CCNxSimpleFileTransferTimer *timer)
+{
+    if (timer->isScheduled) {
+        _remove(wheel, timer);
+        timer->isScheduled = false;
+    }
+}
+
+void
+ccnxSimpleFileTransferTimerWheel_Schedule(CCNxSimpleFileTransferTimerWheel *wheel, CCNxSimpleFileTransferTimer *timer,
+                                          uint64_t dueMicros)
+{
+    ccnxSimpleFileTransferTimerWheel_Cancel(wheel, timer);
+
+    // Round up, so a timer never expires early.
+    uint64_t dueTick = dueMicros / wheel->tickMicros + (dueMicros % wheel->tickMicros != 0);
+    if (dueTick < wheel->currentTick) {
+        dueTick = wheel->currentTick;
+    }
+
+    timer->dueTick = dueTick;
+    timer->isScheduled = true;
+    _insert(wheel, timer);
+    wheel->numInSlots++;
+}
+
+/**
+ * Return the first tick, from the current one, at which a slot of the given level needs attention: the tick its
+ * timers are due in, for the first level, or the tick its timers are to be moved down, for the others.
+ */
+static uint64_t
+_findNextTickAtLevel(const CCNxSimpleFileTransferTimerWheel *wheel, unsigned int level)
+{
+    uint64_t isOccupied = wheel->isOccupied[level];
+    if (isOccupied == 0) {
+        return UINT64_MAX;
+    }
+
+    unsigned int shift = _slotBits * level;
+    uint64_t period = wheel->currentTick >> shift;
+    unsigned int index = (unsigned int) (period & _slotMask);
+
+    // Look at the slots in the order they come round, starting from the current one.
+    uint64_t fromCurrent = (index == 0) ? isOccupied : (isOccupied >> index) | (isOccupied << (_slotsPerLevel - index));
+
+    // The current slot of a higher level was moved down when its period began, unless that's now, so any timers in
+    // it now are a whole turn ahead.
+    bool isCurrentSlotDue = (level == 0) || (wheel->currentTick & ((1ULL << shift) - 1)) == 0;
+
+    uint64_t offset;
+    if ((fromCurrent & 1) != 0 && isCurrentSlotDue) {
+        offset = 0;
+    } else if ((fromCurrent & ~1ULL) != 0) {
+        offset = (uint64_t) __builtin_ctzll(fromCurrent & ~1ULL);
+    } else {
+        offset = _slotsPerLevel;
+    }
+    return (period + offset) << shift;
+}
+
+static uint64_t
+_findNextTick(const CCNxSimpleFileTransferTimerWheel *wheel)
+{
+    uint64_t result = UINT64_MAX;
+    for (unsigned int level = 0; level < _numLevels; level++) {
+        uint64_t tick = _findNextTickAtLevel(wheel, level);
+        if (tick < result) {
+            result = tick;
+        }
+    }
+    return result;
+}
+
+/**
+ * Move the timers of the current tick's slot in each higher level whose period begins now down to lower levels,
+ * then expire the timers of the current tick.
+ */
+static void
+_processCurrentTick(CCNxSimpleFileTransferTimerWheel *wheel)
+{
+    uint64_t tick = wheel->currentTick;
+
+    for (unsigned int level = 1; level < _numLevels; level++) {
+        unsigned int shift = _slotBits * level;
+        if ((tick & ((1ULL << shift) - 1)) != 0) {
+            break;
+        }
+        unsigned int index = (unsigned int) ((tick >> shift) & _slotMask);
+        CCNxSimpleFileTransferTimer *head = &wheel->slots[level * _slotsPerLevel + index];
+
+        CCNxSimpleFileTransferTimer list;
+        _initList(&list);
+        while (head->next != head) {
+            CCNxSimpleFileTransferTimer *timer = head->next;
+            _unlink(timer);
+            _append(&list, timer);
+        }
+        wheel->isOccupied[level] &= ~(1ULL << index);
+
+        while (list.next != &list) {
+            CCNxSimpleFileTransferTimer *timer = list.next;
+            _unlink(timer);
+            _insert(wheel, timer);
+        }
+    }
+
+    unsigned int index = (unsigned int) (tick & _slotMask);
+    CCNxSimpleFileTransferTimer *head = &wheel->slots[index];
+    while (head->next != head) {
+        CCNxSimpleFileTransferTimer *timer = head->next;
+        _unlink(timer);
+        _append(&wheel->expired, timer);
+        timer->slot = _expiredSlot;
+        wheel->numInSlots--;
+        wheel->numExpired++;
+    }
+    wheel->isOccupied[0] &= ~(1ULL << index);
+
+    wheel->currentTick++;
+}
+
+CCNxSimpleFileTransferTimer *
+ccnxSimpleFileTransferTimerWheel_TakeExpired(CCNxSimpleFileTransferTimerWheel *wheel, uint64_t nowMicros)
+{
+    uint64_t nowTick = nowMicros / wheel->tickMicros;
+
+    while (wheel->numExpired == 0 && wheel->currentTick <= nowTick) {
+        // Skip the ticks in which nothing happens, rather than visit each of them.
+        uint64_t nextTick = (wheel->numInSlots == 0) ? UINT64_MAX : _findNextTick(wheel);
+        if (nextTick > nowTick) {
+            wheel->currentTick = nowTick + 1;
+            break;
+        }
+        wheel->currentTick = nextTick;
+        _processCurrentTick(wheel);
+    }
+
+    CCNxSimpleFileTransferTimer *result = NULL;
+    if (wheel->numExpired > 0) {
+        result = wheel->expired.next;
+        _remove(wheel, result);
+        result->isScheduled = false;
+    }
+    return result;
+}
+
+uint64_t
+ccnxSimpleFileTransferTimerWheel_GetNextExpiryMicros(const CCNxSimpleFileTransferTimerWheel *wheel)
+{
+    if (wheel->numExpired > 0) {
+        return 0;
+    }
+    if (wheel->numInSlots == 0) {
+        return UINT64_MAX;
+    }
+    return _findNextTick(wheel) * wheel->tickMicros;
+}
+
+size_t
+ccnxSimpleFileTransferTimerWheel_GetSize(const CCNxSimpleFileTransferTimerWheel *wheel)
+{
+    return wheel->numInSlots + wheel->numExpired;
+}
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+#ifndef ccnxSimpleFileTransfer_TimerWheel_h
+#define ccnxSimpleFileTransfer_TimerWheel_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct ccnxSimpleFileTransfer_TimerWheel;
+
+/**
+ * A `CCNxSimpleFileTransferTimerWheel` keeps track of many timers at once, such as one for each outstanding
+ * Interest, at a constant cost to start, stop or expire each one, however many there are.
+ *
+ * Time is divided into ticks. The wheel is a hierarchy of levels of 64 slots each: a slot of the first level
+ * holds the timers due in one tick, a slot of the second level those due in one of the 64 ticks after that, and
+ * so on, each level's slots 64 times as long as the one below. A timer is kept in the slot of the lowest level
+ * that reaches its due time, so starting or stopping it is just adding it to, or removing it from, a list. As
+ * time passes, the timers of each slot of a higher level are moved down, and those of the first level expire.
+ * Six levels reach 64^6 ticks ahead (about two years of millisecond ticks); timers due even later wait in the top
+ * level for more turns.
+ *
+ * Timers never expire early, but may expire up to a tick late. The wheel doesn't read the clock: the caller
+ * passes in the current time, in microseconds from any fixed point.
+ */
+typedef struct ccnxSimpleFileTransfer_TimerWheel CCNxSimpleFileTransferTimerWheel;
+
+/**
+ * A timer, kept in a `CCNxSimpleFileTransferTimerWheel`. The caller owns it, typically as a member of whatever
+ * it times, so starting a timer never allocates. Its fields belong to the wheel.
+ */
+typedef struct ccnxSimpleFileTransfer_Timer {
+    struct ccnxSimpleFileTransfer_Timer *next;
+    struct ccnxSimpleFileTransfer_Timer *previous;
+    uint64_t dueTick;
+    uint16_t slot;
+    bool isScheduled;
+} CCNxSimpleFileTransferTimer;
+
+/**
+ * Set up a timer that isn't scheduled. A timer must be initialized before it's first used.
+ *
+ * @param [out] timer - the timer.
+ */
+void ccnxSimpleFileTransferTimer_Init(CCNxSimpleFileTransferTimer *timer);
+
+/**
+ * Return whether a timer is scheduled, i.e. started and not yet stopped or taken from the wheel.
+ */
+bool ccnxSimpleFileTransferTimer_IsScheduled(const CCNxSimpleFileTransferTimer *timer);
+
+/**
+ * Create a new, empty `CCNxSimpleFileTransferTimerWheel`.
+ * The newly created instance must eventually be released by calling `ccnxSimpleFileTransferTimerWheel_Release`.
+ *
+ * @param [in] tickMicros - the length of a tick, which is how late a timer may expire.
+ * @param [in] nowMicros - the current time.
+ * @return A new instance.
+ */
+CCNxSimpleFileTransferTimerWheel *ccnxSimpleFileTransferTimerWheel_Create(uint64_t tickMicros, uint64_t nowMicros);
+
+/**
+ * Increase the number of references to a `CCNxSimpleFileTransferTimerWheel` instance.
+ *
+ * @param [in] instance A pointer to the original `CCNxSimpleFileTransferTimerWheel`.
+ * @return The value of the input parameter @p instance.
+ *
+ * @see ccnxSimpleFileTransferTimerWheel_Release
+ */
+CCNxSimpleFileTransferTimerWheel *ccnxSimpleFileTransferTimerWheel_Acquire(const CCNxSimpleFileTransferTimerWheel *instance);
+
+/**
+ * Release a previously acquired reference to the specified instance,
+ * decrementing the reference count for the instance.
+ *
+ * The timers still in the wheel are left as they are, so they must not be used with it again.
+ *
+ * @param [in,out] wheelPtr A pointer to a pointer to the instance to release.
+ *
+ * @see ccnxSimpleFileTransferTimerWheel_Acquire
+ */
+void ccnxSimpleFileTransferTimerWheel_Release(CCNxSimpleFileTransferTimerWheel **wheelPtr);
+
+/**
+ * Start a timer, due at the given time. A timer that's already scheduled is moved to the new time.
+ * A time that has already passed is due at the next tick.
+ *
+ * @param [in] wheel - the wheel.
+ * @param [in] timer - an initialized timer.
+ * @param [in] dueMicros - when the timer is due.
+ */
+void ccnxSimpleFileTransferTimerWheel_Schedule(CCNxSimpleFileTransferTimerWheel *wheel, CCNxSimpleFileTransferTimer *timer,
+                                              uint64_t dueMicros);
+
+/**
+ * Stop a timer, if it's scheduled, so it won't expire.
+ *
+ * @param [in] wheel - the wheel.
+ * @param [in] timer - the timer.
+ */
+void ccnxSimpleFileTransferTimerWheel_Cancel(CCNxSimpleFileTransferTimerWheel *wheel, CCNxSimpleFileTransferTimer *timer);
+
+/**
+ * Take a timer that has expired by the given time from the wheel. Call this until it returns NULL to take all of
+ * them. Timers are taken in the order of the ticks they were due in.
+ *
+ * @param [in] wheel - the wheel.
+ * @param [in] nowMicros - the current time, which must not be earlier than in previous calls.
+ * @return An expired timer, which is no longer scheduled, or NULL if none has expired.
+ */
+CCNxSimpleFileTransferTimer *ccnxSimpleFileTransferTimerWheel_TakeExpired(CCNxSimpleFileTransferTimerWheel *wheel,
+                                                                          uint64_t nowMicros);
+
+/**
+ * Return the earliest time at which a timer may expire, e.g. to know how long to wait for something else.
+ * When the earliest timer is in a higher level, this is when its slot is due to be moved down, which may be
+ * before the timer is due.
+ *
+ * @param [in] wheel - the wheel.
+ * @return The time, which may already have passed, or UINT64_MAX if no timer is scheduled.
+ */
+uint64_t ccnxSimpleFileTransferTimerWheel_GetNextExpiryMicros(const CCNxSimpleFileTransferTimerWheel *wheel);
+
+/**
+ * Return the number of timers scheduled in the wheel, including those that have expired but not been taken.
+ */
+size_t ccnxSimpleFileTransferTimerWheel_GetSize(const CCNxSimpleFileTransferTimerWheel *wheel);
+
+#endif // ccnxSimpleFileTransfer_TimerWheel_h
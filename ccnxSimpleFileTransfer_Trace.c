@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <LongBow/runtime.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "ccnxSimpleFileTransfer_Trace.h"
+
+/**
+ * The number of records each thread buffers before appending them to the trace file.
+ */
+#define _RingCapacity 4096
+
+/**
+ * The trace file starts with this header, followed by records, all in the byte order of the
+ * machine that wrote it.
+ */
+typedef struct traceFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+} _TraceFileHeader;
+
+static const char _traceFileMagic[8] = "SFTTRACE";
+static const uint32_t _traceFileVersion = 1;
+
+typedef struct traceRecord {
+    uint64_t startNanos;
+    uint32_t durationNanos;
+    uint32_t interestId;
+    uint32_t threadId;
+    uint16_t event;
+    uint16_t reserved;
+} _TraceRecord;
+
+typedef struct traceRing {
+    struct traceRing *next;
+    uint32_t threadId;
+    size_t count;
+    _TraceRecord records[_RingCapacity];
+} _TraceRing;
+
+static const char *_eventNames[CCNxSimpleFileTransferTraceEvent_NumEvents] = {
+    "receive",
+    "parse",
+    "lookup",
+    "disk_read",
+    "build",
+    "send",
+};
+
+static bool _isEnabled = false;
+static int _traceFileDescriptor = -1;
+static uint32_t _traceGeneration = 0;     // Incremented by each Open, to invalidate old thread rings.
+static uint32_t _nextInterestId = 0;
+static uint32_t _nextThreadId = 0;
+static _TraceRing *_allRings = NULL;      // Every thread's ring, so they can be flushed together.
+
+static __thread _TraceRing *_threadRing = NULL;
+static __thread uint32_t _threadRingGeneration = 0;
+static __thread uint32_t _threadInterestId = 0;
+
+static uint64_t
+_nowNanos(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t) now.tv_sec * 1000000000ULL) + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * Write all of the specified bytes, retrying after short writes.
+ */
+static bool
+_writeFully(int fd, const void *bytes, size_t length)
+{
+    const uint8_t *next = bytes;
+    while (length > 0) {
+        ssize_t numWritten = write(fd, next, length);
+        if (numWritten <= 0) {
+            return false;
+        }
+        next += numWritten;
+        length -= (size_t) numWritten;
+    }
+    return true;
+}
+
+static void
+_flushRing(_TraceRing *ring)
+{
+    if (ring->count > 0) {
+        // The trace file is opened with O_APPEND, so rings flushed from different threads don't interleave.
+        _writeFully(_traceFileDescriptor, ring->records, ring->count * sizeof(_TraceRecord));
+        ring->count = 0;
+    }
+}
+
+/**
+ * Return the calling thread's ring, creating it on first use in this trace.
+ */
+static _TraceRing *
+_getThreadRing(void)
+{
+    uint32_t generation = __atomic_load_n(&_traceGeneration, __ATOMIC_ACQUIRE);
+    if (_threadRing == NULL || _threadRingGeneration != generation) {
+        _TraceRing *ring = parcMemory_AllocateAndClear(sizeof(_TraceRing));
+        assertNotNull(ring, "parcMemory_AllocateAndClear(%zu) returned NULL", sizeof(_TraceRing));
+        ring->threadId = __atomic_add_fetch(&_nextThreadId, 1, __ATOMIC_RELAXED);
+
+        // Push the new ring onto the list of all rings.
+        ring->next = __atomic_load_n(&_allRings, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&_allRings, &ring->next, ring, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+            // ring->next was updated with the current head of the list. Try again.
+        }
+
+        _threadRing = ring;
+        _threadRingGeneration = generation;
+    }
+    return _threadRing;
+}
+
+static void
+_appendRecord(CCNxSimpleFileTransferTraceEvent event, uint64_t startNanos, uint64_t durationNanos)
+{
+    _TraceRing *ring = _getThreadRing();
+
+    _TraceRecord *record = &ring->records[ring->count];
+    record->startNanos = startNanos;
+    record->durationNanos = (durationNanos > UINT32_MAX) ? UINT32_MAX : (uint32_t) durationNanos;
+    record->interestId = _threadInterestId;
+    record->threadId = ring->threadId;
+    record->event = (uint16_t) event;
+    record->reserved = 0;
+
+    if (++ring->count == _RingCapacity) {
+        _flushRing(ring);
+    }
+}
+
+bool
+ccnxSimpleFileTransferTrace_Open(const char *fileName)
+{
+    ccnxSimpleFileTransferTrace_Close();
+
+    int fd = open(fileName, O_CREAT | O_WRONLY | O_TRUNC | O_APPEND, 0644);
+    if (fd < 0) {
+        return false;
+    }
+
+    _TraceFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, _traceFileMagic, sizeof(header.magic));
+    header.version = _traceFileVersion;
+    header.recordSize = sizeof(_TraceRecord);
+
+    if (!_writeFully(fd, &header, sizeof(header))) {
+        close(fd);
+        return false;
+    }
+
+    _traceFileDescriptor = fd;
+    __atomic_add_fetch(&_traceGeneration, 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&_isEnabled, true, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+void
+ccnxSimpleFileTransferTrace_Flush(void)
+{
+    if (_traceFileDescriptor >= 0) {
+        for (_TraceRing *ring = __atomic_load_n(&_allRings, __ATOMIC_ACQUIRE); ring != NULL; ring = ring->next) {
+            _flushRing(ring);
+        }
+    }
+}
+
+void
+ccnxSimpleFileTransferTrace_Close(void)
+{
+    __atomic_store_n(&_isEnabled, false, __ATOMIC_RELEASE);
+
+    ccnxSimpleFileTransferTrace_Flush();
+
+    if (_traceFileDescriptor >= 0) {
+        close(_traceFileDescriptor);
+        _traceFileDescriptor = -1;
+    }
+
+    _TraceRing *ring = __atomic_exchange_n(&_allRings, NULL, __ATOMIC_ACQ_REL);
+    while (ring != NULL) {
+        _TraceRing *next = ring->next;
+        parcMemory_Deallocate((void **) &ring);
+        ring = next;
+    }
+    _threadRing = NULL;
+}
+
+bool
+ccnxSimpleFileTransferTrace_IsEnabled(void)
+{
+    return __atomic_load_n(&_isEnabled, __ATOMIC_RELAXED);
+}
+
+uint32_t
+ccnxSimpleFileTransferTrace_StartInterest(void)
+{
+    uint32_t result = 0;
+    if (ccnxSimpleFileTransferTrace_IsEnabled()) {
+        result = __atomic_add_fetch(&_nextInterestId, 1, __ATOMIC_RELAXED);
+        _threadInterestId = result;
+        _appendRecord(CCNxSimpleFileTransferTraceEvent_Receive, _nowNanos(), 0);
+    }
+    return result;
+}
+
+uint64_t
+ccnxSimpleFileTransferTrace_Begin(void)
+{
+    return ccnxSimpleFileTransferTrace_IsEnabled() ? _nowNanos() : 0;
+}
+
+void
+ccnxSimpleFileTransferTrace_End(CCNxSimpleFileTransferTraceEvent event, uint64_t startNanos)
+{
+    // startNanos is 0 if tracing was enabled after the span began.
+    if (ccnxSimpleFileTransferTrace_IsEnabled() && startNanos != 0) {
+        _appendRecord(event, startNanos, _nowNanos() - startNanos);
+    }
+}
+
+const char *
+ccnxSimpleFileTransferTrace_GetEventName(CCNxSimpleFileTransferTraceEvent event)
+{
+    return (event < CCNxSimpleFileTransferTraceEvent_NumEvents) ? _eventNames[event] : "unknown";
+}
+
+int64_t
+ccnxSimpleFileTransferTrace_WriteChromeTrace(const char *traceFileName, FILE *output)
+{
+    FILE *input = fopen(traceFileName, "rb");
+    if (input == NULL) {
+        return -1;
+    }
+
+    _TraceFileHeader header;
+    if (fread(&header, sizeof(header), 1, input) != 1
+        || memcmp(header.magic, _traceFileMagic, sizeof(header.magic)) != 0
+        || header.version != _traceFileVersion
+        || header.recordSize != sizeof(_TraceRecord)) {
+        fclose(input);
+        return -1;
+    }
+
+    int64_t result = 0;
+
+    // Timestamps in the Chrome trace event format are in microseconds.
+    fprintf(output, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+    _TraceRecord record;
+    while (fread(&record, sizeof(record), 1, input) == 1) {
+        fprintf(output, "%s\n{\"name\":\"%s\",\"cat\":\"interest\",\"pid\":1,\"tid\":%" PRIu32 ",\"ts\":%" PRIu64 ".%03" PRIu64,
+                (result == 0) ? "" : ",",
+                ccnxSimpleFileTransferTrace_GetEventName(record.event), record.threadId,
+                record.startNanos / 1000, record.startNanos % 1000);
+
+        if (record.event == CCNxSimpleFileTransferTraceEvent_Receive) {
+            fprintf(output, ",\"ph\":\"i\",\"s\":\"t\"");
+        } else {
+            fprintf(output, ",\"ph\":\"X\",\"dur\":%" PRIu32 ".%03" PRIu32,
+                    record.durationNanos / 1000, record.durationNanos % 1000);
+        }
+
+        fprintf(output, ",\"args\":{\"interest\":%" PRIu32 "}}", record.interestId);
+        result++;
+    }
+
+    fprintf(output, "\n]}\n");
+
+    fclose(input);
+
+    return result;
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+#ifndef ccnxSimpleFileTransfer_Trace_h
+#define ccnxSimpleFileTransfer_Trace_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Binary event tracing for the Interest pipeline.
+ *
+ * Each thread appends fixed size, timestamped records to its own ring buffer, so recording an event takes
+ * no lock and does no I/O. When a ring fills, it is appended to the trace file with a single write().
+ * The trace file can be converted to the Chrome trace event format (which Perfetto and chrome://tracing
+ * can load) with `ccnxSimpleFileTransferTrace_WriteChromeTrace`, or with the ccnxSimpleFileTransfer_TraceConvert
+ * program.
+ *
+ * Tracing is process wide. Until `ccnxSimpleFileTransferTrace_Open` is called, every tracing function
+ * returns immediately without reading the clock.
+ */
+
+/**
+ * The events we trace. Every event except Receive is a span with a start time and a duration.
+ */
+typedef enum {
+    CCNxSimpleFileTransferTraceEvent_Receive,   // An Interest was received. Has no duration.
+    CCNxSimpleFileTransferTraceEvent_Parse,     // Extracting the command, file name and chunk number from the name.
+    CCNxSimpleFileTransferTraceEvent_Lookup,    // Finding the file, or its pre-chunked content.
+    CCNxSimpleFileTransferTraceEvent_DiskRead,  // Reading a chunk of a file.
+    CCNxSimpleFileTransferTraceEvent_Build,     // Building the response Content Object.
+    CCNxSimpleFileTransferTraceEvent_Send,      // Handing the response to the Portal.
+    CCNxSimpleFileTransferTraceEvent_NumEvents  // Must be last
+} CCNxSimpleFileTransferTraceEvent;
+
+/**
+ * Start tracing to the specified file, which is created or truncated. Records from any
+ * previous trace are discarded.
+ *
+ * @param [in] fileName - the name of the trace file.
+ * @return true if the trace file was opened.
+ */
+bool ccnxSimpleFileTransferTrace_Open(const char *fileName);
+
+/**
+ * Flush every thread's ring buffer to the trace file, stop tracing, and free the ring buffers.
+ * No other thread may be recording events when this is called.
+ */
+void ccnxSimpleFileTransferTrace_Close(void);
+
+/**
+ * Append every thread's buffered records to the trace file. This function only calls write(),
+ * so it may be called from a signal handler (e.g. to save the trace when the server is interrupted).
+ */
+void ccnxSimpleFileTransferTrace_Flush(void);
+
+/**
+ * Return true if events are being traced.
+ */
+bool ccnxSimpleFileTransferTrace_IsEnabled(void);
+
+/**
+ * Record the arrival of an Interest, and assign it the identifier that subsequent events
+ * recorded by the calling thread will be tagged with.
+ *
+ * @return the identifier of the Interest, or 0 if tracing is disabled.
+ */
+uint32_t ccnxSimpleFileTransferTrace_StartInterest(void);
+
+/**
+ * Return a timestamp to pass to `ccnxSimpleFileTransferTrace_End`. Returns 0 without reading
+ * the clock if tracing is disabled.
+ *
+ * @return a monotonic timestamp in nanoseconds, or 0.
+ */
+uint64_t ccnxSimpleFileTransferTrace_Begin(void);
+
+/**
+ * Record a span of the specified event, from `startNanos` (from `ccnxSimpleFileTransferTrace_Begin`)
+ * until now, tagged with the calling thread's current Interest. Does nothing if tracing is disabled.
+ *
+ * @param [in] event - the event that took place.
+ * @param [in] startNanos - the timestamp returned by `ccnxSimpleFileTransferTrace_Begin`.
+ */
+void ccnxSimpleFileTransferTrace_End(CCNxSimpleFileTransferTraceEvent event, uint64_t startNanos);
+
+/**
+ * Return the name of the specified event, e.g. "disk_read".
+ *
+ * @param [in] event - the event.
+ * @return A static string naming the event.
+ */
+const char *ccnxSimpleFileTransferTrace_GetEventName(CCNxSimpleFileTransferTraceEvent event);
+
+/**
+ * Read the specified trace file and write it to `output` in the Chrome trace event (JSON) format.
+ *
+ * @param [in] traceFileName - the trace file to convert.
+ * @param [in] output - where to write the JSON.
+ * @return the number of events written, or -1 if the trace file could not be read.
+ */
+int64_t ccnxSimpleFileTransferTrace_WriteChromeTrace(const char *traceFileName, FILE *output);
+#endif // ccnxSimpleFileTransfer_Trace_h
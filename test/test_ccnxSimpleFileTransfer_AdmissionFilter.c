@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../ccnxSimpleFileTransfer_AdmissionFilter.c"
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <unistd.h>
+
+LONGBOW_TEST_RUNNER(ccnxSimpleFileTransfer_AdmissionFilter)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(ccnxSimpleFileTransfer_AdmissionFilter)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(ccnxSimpleFileTransfer_AdmissionFilter)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, createRelease);
+    LONGBOW_RUN_TEST_CASE(Global, estimateFrequency);
+    LONGBOW_RUN_TEST_CASE(Global, saturates);
+    LONGBOW_RUN_TEST_CASE(Global, aging);
+    LONGBOW_RUN_TEST_CASE(Global, admit);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_CASE(Global, createRelease)
+{
+    CCNxSimpleFileTransferAdmissionFilter *filter = ccnxSimpleFileTransferAdmissionFilter_Create(1000);
+    assertNotNull(filter, "Expected a new filter");
+    assertTrue(filter->width == 1024, "Expected the width to be rounded up to 1024, got %zu", filter->width);
+
+    CCNxSimpleFileTransferAdmissionFilter *reference = ccnxSimpleFileTransferAdmissionFilter_Acquire(filter);
+    ccnxSimpleFileTransferAdmissionFilter_Release(&reference);
+    assertNull(reference, "Expected Release to clear the pointer");
+
+    ccnxSimpleFileTransferAdmissionFilter_Release(&filter);
+}
+
+LONGBOW_TEST_CASE(Global, estimateFrequency)
+{
+    CCNxSimpleFileTransferAdmissionFilter *filter = ccnxSimpleFileTransferAdmissionFilter_Create(1000);
+
+    assertTrue(ccnxSimpleFileTransferAdmissionFilter_EstimateFrequency(filter, "hot.zip") == 0, "Expected 0 before any access");
+
+    for (int i = 0; i < 5; i++) {
+        ccnxSimpleFileTransferAdmissionFilter_RecordAccess(filter, "hot.zip");
+    }
+    ccnxSimpleFileTransferAdmissionFilter_RecordAccess(filter, "cold.iso");
+
+    unsigned int hot = ccnxSimpleFileTransferAdmissionFilter_EstimateFrequency(filter, "hot.zip");
+    unsigned int cold = ccnxSimpleFileTransferAdmissionFilter_EstimateFrequency(filter, "cold.iso");
+    assertTrue(hot == 5, "Expected 5, got %u", hot);
+    assertTrue(cold == 1, "Expected 1, got %u", cold);
+
+    ccnxSimpleFileTransferAdmissionFilter_Release(&filter);
+}
+
+LONGBOW_TEST_CASE(Global, saturates)
+{
+    CCNxSimpleFileTransferAdmissionFilter *filter = ccnxSimpleFileTransferAdmissionFilter_Create(1000);
+
+    for (int i = 0; i < 100; i++) {
+        ccnxSimpleFileTransferAdmissionFilter_RecordAccess(filter, "hot.zip");
+    }
+    unsigned int hot = ccnxSimpleFileTransferAdmissionFilter_EstimateFrequency(filter, "hot.zip");
+    assertTrue(hot == 15, "Expected the estimate to saturate at 15, got %u", hot);
+
+    ccnxSimpleFileTransferAdmissionFilter_Release(&filter);
+}
+
+LONGBOW_TEST_CASE(Global, aging)
+{
+    CCNxSimpleFileTransferAdmissionFilter *filter = ccnxSimpleFileTransferAdmissionFilter_Create(64);
+
+    for (int i = 0; i < 8; i++) {
+        ccnxSimpleFileTransferAdmissionFilter_RecordAccess(filter, "once-hot.zip");
+    }
+
+    // Fill the rest of the sample with other keys, so the counters are halved.
+    char key[32];
+    for (uint64_t i = filter->numAccesses; i < filter->sampleSize; i++) {
+        sprintf(key, "other%" PRIu64, i);
+        ccnxSimpleFileTransferAdmissionFilter_RecordAccess(filter, key);
+    }
+
+    unsigned int estimate = ccnxSimpleFileTransferAdmissionFilter_EstimateFrequency(filter, "once-hot.zip");
+    assertTrue(estimate >= 4 && estimate < 8, "Expected the estimate to have been halved, got %u", estimate);
+
+    ccnxSimpleFileTransferAdmissionFilter_Release(&filter);
+}
+
+LONGBOW_TEST_CASE(Global, admit)
+{
+    CCNxSimpleFileTransferAdmissionFilter *filter = ccnxSimpleFileTransferAdmissionFilter_Create(1000);
+
+    for (int i = 0; i < 3; i++) {
+        ccnxSimpleFileTransferAdmissionFilter_RecordAccess(filter, "hot.zip");
+    }
+    ccnxSimpleFileTransferAdmissionFilter_RecordAccess(filter, "cold.iso");
+
+    assertTrue(ccnxSimpleFileTransferAdmissionFilter_Admit(filter, "hot.zip", "cold.iso"), "Expected the hot file to be admitted");
+    assertFalse(ccnxSimpleFileTransferAdmissionFilter_Admit(filter, "cold.iso", "hot.zip"), "Expected the cold file to be refused");
+    assertFalse(ccnxSimpleFileTransferAdmissionFilter_Admit(filter, "cold.iso", "cold.iso"), "Expected a tie to be refused");
+
+    ccnxSimpleFileTransferAdmissionFilter_Release(&filter);
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(ccnxSimpleFileTransfer_AdmissionFilter);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../ccnxSimpleFileTransfer_BlockSignatures.c"
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <unistd.h>
+
+LONGBOW_TEST_RUNNER(ccnxSimpleFileTransfer_BlockSignatures)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(ccnxSimpleFileTransfer_BlockSignatures)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(ccnxSimpleFileTransfer_BlockSignatures)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, weakChecksum);
+    LONGBOW_RUN_TEST_CASE(Global, rollWeakChecksum);
+    LONGBOW_RUN_TEST_CASE(Global, createFromFile);
+    LONGBOW_RUN_TEST_CASE(Global, createFromBuffer);
+    LONGBOW_RUN_TEST_CASE(Global, findLocalBlocks);
+    LONGBOW_RUN_TEST_CASE(Global, findRepeatedBlocks);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+/**
+ * Fill a buffer with repeatable pseudo-random bytes.
+ */
+static void
+_fillRandom(uint8_t *data, size_t length, uint32_t seed)
+{
+    for (size_t i = 0; i < length; i++) {
+        seed = seed * 1103515245U + 12345U;
+        data[i] = (uint8_t) (seed >> 16);
+    }
+}
+
+/**
+ * Write data to a new temporary file, and return a descriptor open on it.
+ */
+static int
+_createTestFile(const uint8_t *data, size_t length)
+{
+    char fileName[] = "/tmp/ccnxSimpleFileTransfer_testBlockSignatures.XXXXXX";
+    int result = mkstemp(fileName);
+    assertTrue(result >= 0, "Could not create a temporary file");
+    unlink(fileName);
+
+    assertTrue(write(result, data, length) == (ssize_t) length, "Could not write the temporary file");
+    return result;
+}
+
+LONGBOW_TEST_CASE(Global, weakChecksum)
+{
+    uint8_t data[1000];
+    _fillRandom(data, sizeof(data), 1);
+
+    // Every length, so the SSE2 groups and the bytes left over are both covered.
+    for (size_t length = 0; length <= sizeof(data); length += 7) {
+        uint32_t a = 0;
+        uint32_t b = 0;
+        _addToWeakChecksum(data, length, &a, &b);
+        uint32_t expected = (b << 16) | (a & 0xffff);
+
+        uint32_t checksum = ccnxSimpleFileTransferBlockSignatures_WeakChecksum(data, length);
+        assertTrue(checksum == expected, "Expected %08x for %zu bytes, got %08x", expected, length, checksum);
+    }
+
+    memset(data, 0xff, sizeof(data));
+    uint32_t a = 0;
+    uint32_t b = 0;
+    _addToWeakChecksum(data, sizeof(data), &a, &b);
+    assertTrue(ccnxSimpleFileTransferBlockSignatures_WeakChecksum(data, sizeof(data)) == ((b << 16) | (a & 0xffff)),
+               "Expected the same checksum for bytes of 0xff");
+}
+
+LONGBOW_TEST_CASE(Global, rollWeakChecksum)
+{
+    uint8_t data[500];
+    _fillRandom(data, sizeof(data), 2);
+
+    size_t window = 64;
+    uint32_t checksum = ccnxSimpleFileTransferBlockSignatures_WeakChecksum(data, window);
+    for (size_t offset = 0; offset + window < sizeof(data); offset++) {
+        checksum = ccnxSimpleFileTransferBlockSignatures_RollWeakChecksum(checksum, window, data[offset], data[offset + window]);
+        uint32_t expected = ccnxSimpleFileTransferBlockSignatures_WeakChecksum(data + offset + 1, window);
+        assertTrue(checksum == expected, "Expected %08x at offset %zu, got %08x", expected, offset + 1, checksum);
+    }
+}
+
+LONGBOW_TEST_CASE(Global, createFromFile)
+{
+    size_t blockSize = 100;
+    uint8_t data[1050];
+    _fillRandom(data, sizeof(data), 3);
+    int fd = _createTestFile(data, sizeof(data));
+
+    CCNxSimpleFileTransferBlockSignatures *signatures =
+        ccnxSimpleFileTransferBlockSignatures_CreateFromFile(fd, sizeof(data), blockSize);
+    assertNotNull(signatures, "Expected signatures");
+    assertTrue(ccnxSimpleFileTransferBlockSignatures_GetNumBlocks(signatures) == 11, "Expected 11 blocks");
+    assertTrue(ccnxSimpleFileTransferBlockSignatures_GetFileSize(signatures) == sizeof(data), "Expected the file's size");
+    assertTrue(signatures->blocks[10].weak == ccnxSimpleFileTransferBlockSignatures_WeakChecksum(data + 1000, 50),
+               "Expected the short last block's checksum");
+    ccnxSimpleFileTransferBlockSignatures_Release(&signatures);
+
+    // A file shorter than expected can't be signed.
+    signatures = ccnxSimpleFileTransferBlockSignatures_CreateFromFile(fd, sizeof(data) + 1, blockSize);
+    assertNull(signatures, "Did not expect signatures of a short file");
+
+    signatures = ccnxSimpleFileTransferBlockSignatures_CreateFromFile(fd, 0, blockSize);
+    assertTrue(ccnxSimpleFileTransferBlockSignatures_GetNumBlocks(signatures) == 0, "Expected no blocks in an empty file");
+    ccnxSimpleFileTransferBlockSignatures_Release(&signatures);
+
+    close(fd);
+}
+
+LONGBOW_TEST_CASE(Global, createFromBuffer)
+{
+    uint8_t data[5000];
+    _fillRandom(data, sizeof(data), 4);
+    int fd = _createTestFile(data, sizeof(data));
+
+    CCNxSimpleFileTransferBlockSignatures *signatures = ccnxSimpleFileTransferBlockSignatures_CreateFromFile(fd, sizeof(data), 1200);
+    PARCBuffer *buffer = ccnxSimpleFileTransferBlockSignatures_CreateBuffer(signatures);
+
+    CCNxSimpleFileTransferBlockSignatures *copy = ccnxSimpleFileTransferBlockSignatures_CreateFromBuffer(buffer);
+    assertNotNull(copy, "Expected the signatures to be read back");
+    assertTrue(copy->numBlocks == signatures->numBlocks && copy->blockSize == signatures->blockSize
+               && copy->fileSize == signatures->fileSize, "Expected the same shape");
+    assertTrue(memcmp(copy->blocks, signatures->blocks, signatures->numBlocks * sizeof(_BlockSignature)) == 0,
+               "Expected the same blocks");
+    ccnxSimpleFileTransferBlockSignatures_Release(&copy);
+
+    // Truncated signatures are refused.
+    parcBuffer_SetLimit(buffer, parcBuffer_Limit(buffer) - 1);
+    assertNull(ccnxSimpleFileTransferBlockSignatures_CreateFromBuffer(buffer), "Did not expect truncated signatures to be read");
+
+    PARCBuffer *nonsense = parcBuffer_WrapCString("not signatures at all");
+    assertNull(ccnxSimpleFileTransferBlockSignatures_CreateFromBuffer(nonsense), "Did not expect nonsense to be read");
+    parcBuffer_Release(&nonsense);
+
+    parcBuffer_Release(&buffer);
+    ccnxSimpleFileTransferBlockSignatures_Release(&signatures);
+    close(fd);
+}
+
+LONGBOW_TEST_CASE(Global, findLocalBlocks)
+{
+    size_t blockSize = 256;
+    size_t newSize = 40 * blockSize + 100;
+    uint8_t *newData = parcMemory_Allocate(newSize);
+    _fillRandom(newData, newSize, 5);
+
+    // The local copy is the new file with 3 bytes inserted in block 10, and block 30 changed.
+    size_t localSize = newSize + 3;
+    uint8_t *localData = parcMemory_Allocate(localSize);
+    size_t insertAt = 10 * blockSize + 17;
+    memcpy(localData, newData, insertAt);
+    memcpy(localData + insertAt, "abc", 3);
+    memcpy(localData + insertAt + 3, newData + insertAt, newSize - insertAt);
+    localData[30 * blockSize + 3 + 5] ^= 0x55;
+
+    int fd = _createTestFile(newData, newSize);
+    CCNxSimpleFileTransferBlockSignatures *signatures = ccnxSimpleFileTransferBlockSignatures_CreateFromFile(fd, newSize, blockSize);
+
+    int64_t localOffsets[41];
+    uint64_t numFound = ccnxSimpleFileTransferBlockSignatures_FindLocalBlocks(signatures, localData, localSize, localOffsets);
+
+    assertTrue(numFound == 39, "Expected all but 2 blocks to be found, got %" PRIu64, numFound);
+    for (uint64_t i = 0; i < 41; i++) {
+        int64_t expected = (i == 10 || i == 30) ? -1 : (int64_t) (i * blockSize + (i > 10 ? 3 : 0));
+        assertTrue(localOffsets[i] == expected, "Expected block %" PRIu64 " at %" PRId64 ", got %" PRId64,
+                   i, expected, localOffsets[i]);
+    }
+
+    // Nothing is found in an unrelated file.
+    _fillRandom(localData, localSize, 6);
+    numFound = ccnxSimpleFileTransferBlockSignatures_FindLocalBlocks(signatures, localData, localSize, localOffsets);
+    assertTrue(numFound == 0, "Expected no blocks to be found, got %" PRIu64, numFound);
+
+    ccnxSimpleFileTransferBlockSignatures_Release(&signatures);
+    close(fd);
+    parcMemory_Deallocate((void **) &localData);
+    parcMemory_Deallocate((void **) &newData);
+}
+
+LONGBOW_TEST_CASE(Global, findRepeatedBlocks)
+{
+    size_t blockSize = 64;
+    uint8_t newData[4 * 64];
+    memset(newData, 'x', sizeof(newData));
+
+    int fd = _createTestFile(newData, sizeof(newData));
+    CCNxSimpleFileTransferBlockSignatures *signatures =
+        ccnxSimpleFileTransferBlockSignatures_CreateFromFile(fd, sizeof(newData), blockSize);
+
+    // One copy of the repeated block is enough for all of them.
+    int64_t localOffsets[4];
+    uint64_t numFound = ccnxSimpleFileTransferBlockSignatures_FindLocalBlocks(signatures, newData, blockSize, localOffsets);
+    assertTrue(numFound == 4, "Expected all 4 blocks to be found, got %" PRIu64, numFound);
+    for (int i = 0; i < 4; i++) {
+        assertTrue(localOffsets[i] == 0, "Expected block %d at 0, got %" PRId64, i, localOffsets[i]);
+    }
+
+    ccnxSimpleFileTransferBlockSignatures_Release(&signatures);
+    close(fd);
+}
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(ccnxSimpleFileTransfer_BlockSignatures);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
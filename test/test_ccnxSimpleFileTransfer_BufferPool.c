@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../ccnxSimpleFileTransfer_BufferPool.c"
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+#include <stdio.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+LONGBOW_TEST_RUNNER(ccnxSimpleFileTransfer_BufferPool)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(ccnxSimpleFileTransfer_BufferPool)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(ccnxSimpleFileTransfer_BufferPool)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, createRelease);
+    LONGBOW_RUN_TEST_CASE(Global, reuse);
+    LONGBOW_RUN_TEST_CASE(Global, inUse);
+    LONGBOW_RUN_TEST_CASE(Global, inUseBySlice);
+    LONGBOW_RUN_TEST_CASE(Global, millionInterests);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_CASE(Global, createRelease)
+{
+    CCNxSimpleFileTransferBufferPool *pool = ccnxSimpleFileTransferBufferPool_Create(1200, 4);
+    assertNotNull(pool, "Expected a non-NULL pool");
+    assertTrue(ccnxSimpleFileTransferBufferPool_GetSize(pool) == 0, "Expected an empty pool");
+
+    CCNxSimpleFileTransferBufferPool *reference = ccnxSimpleFileTransferBufferPool_Acquire(pool);
+    ccnxSimpleFileTransferBufferPool_Release(&pool);
+    assertNull(pool, "Expected Release to NULL the pointer");
+    ccnxSimpleFileTransferBufferPool_Release(&reference);
+}
+
+LONGBOW_TEST_CASE(Global, reuse)
+{
+    CCNxSimpleFileTransferBufferPool *pool = ccnxSimpleFileTransferBufferPool_Create(1200, 4);
+
+    PARCBuffer *buffer = ccnxSimpleFileTransferBufferPool_GetBuffer(pool);
+    assertTrue(parcBuffer_Capacity(buffer) == 1200, "Expected a buffer of the pool's capacity");
+    parcBuffer_SetPosition(buffer, 100);
+    parcBuffer_Flip(buffer);
+    PARCBuffer *first = buffer;
+    parcBuffer_Release(&buffer);
+
+    buffer = ccnxSimpleFileTransferBufferPool_GetBuffer(pool);
+    assertTrue(buffer == first, "Expected the released buffer back");
+    assertTrue(parcBuffer_Position(buffer) == 0 && parcBuffer_Limit(buffer) == 1200, "Expected the buffer cleared");
+    assertTrue(ccnxSimpleFileTransferBufferPool_GetNumAllocated(pool) == 1, "Expected only 1 buffer allocated");
+    parcBuffer_Release(&buffer);
+
+    ccnxSimpleFileTransferBufferPool_Release(&pool);
+}
+
+LONGBOW_TEST_CASE(Global, inUse)
+{
+    CCNxSimpleFileTransferBufferPool *pool = ccnxSimpleFileTransferBufferPool_Create(1200, 2);
+
+    // A buffer still referenced elsewhere, as by a Content Object the Portal is sending, isn't handed out again.
+    PARCBuffer *buffer = ccnxSimpleFileTransferBufferPool_GetBuffer(pool);
+    PARCBuffer *payload = parcBuffer_Acquire(buffer);
+    parcBuffer_Release(&buffer);
+
+    PARCBuffer *second = ccnxSimpleFileTransferBufferPool_GetBuffer(pool);
+    assertTrue(second != payload, "Expected a different buffer while the first is in use");
+    PARCBuffer *third = ccnxSimpleFileTransferBufferPool_GetBuffer(pool);
+    assertTrue(ccnxSimpleFileTransferBufferPool_GetSize(pool) == 2, "Expected the pool to keep only 2 buffers");
+    assertTrue(ccnxSimpleFileTransferBufferPool_GetNumAllocated(pool) == 3, "Expected a buffer allocated when the pool was full");
+
+    parcBuffer_Release(&third);
+    parcBuffer_Release(&second);
+
+    // Buffers in use outlive the pool.
+    ccnxSimpleFileTransferBufferPool_Release(&pool);
+    assertTrue(parcBuffer_Capacity(payload) == 1200, "Expected the buffer to still be valid");
+    parcBuffer_Release(&payload);
+}
+
+LONGBOW_TEST_CASE(Global, inUseBySlice)
+{
+    CCNxSimpleFileTransferBufferPool *pool = ccnxSimpleFileTransferBufferPool_Create(1200, 2);
+
+    // A slice of the payload, as an encoder may keep, shares its bytes, so the buffer isn't free until it goes too.
+    PARCBuffer *buffer = ccnxSimpleFileTransferBufferPool_GetBuffer(pool);
+    PARCBuffer *first = buffer;
+    PARCBuffer *slice = parcBuffer_Slice(buffer);
+    parcBuffer_Release(&buffer);
+
+    buffer = ccnxSimpleFileTransferBufferPool_GetBuffer(pool);
+    assertTrue(buffer != first, "Expected a different buffer while a slice of the first is in use");
+    parcBuffer_Release(&buffer);
+
+    parcBuffer_Release(&slice);
+    buffer = ccnxSimpleFileTransferBufferPool_GetBuffer(pool);
+    assertTrue(buffer == first, "Expected the first buffer back once its slice was released");
+    parcBuffer_Release(&buffer);
+
+    ccnxSimpleFileTransferBufferPool_Release(&pool);
+}
+
+LONGBOW_TEST_CASE(Global, millionInterests)
+{
+    // Answer a million Interests, each response's payload held until 64 later responses have been sent. Only the
+    // payloads are pooled: each response's Content Object and message are still allocated.
+    const size_t numInFlight = 64;
+    CCNxSimpleFileTransferBufferPool *pool = ccnxSimpleFileTransferBufferPool_Create(1200, 128);
+    PARCBuffer *inFlight[64] = { NULL };
+
+    for (size_t i = 0; i < 1000000; i++) {
+        PARCBuffer *payload = ccnxSimpleFileTransferBufferPool_GetBuffer(pool);
+        if (inFlight[i % numInFlight] != NULL) {
+            parcBuffer_Release(&inFlight[i % numInFlight]);
+        }
+        inFlight[i % numInFlight] = payload;
+    }
+
+    assertTrue(ccnxSimpleFileTransferBufferPool_GetNumAllocated(pool) == numInFlight + 1,
+               "Expected only the payloads in flight at once to be allocated, not %" PRIu64,
+               ccnxSimpleFileTransferBufferPool_GetNumAllocated(pool));
+
+    for (size_t i = 0; i < numInFlight; i++) {
+        parcBuffer_Release(&inFlight[i]);
+    }
+    ccnxSimpleFileTransferBufferPool_Release(&pool);
+}
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(ccnxSimpleFileTransfer_BufferPool);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../ccnxSimpleFileTransfer_CacheWarmer.c"
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <unistd.h>
+
+LONGBOW_TEST_RUNNER(ccnxSimpleFileTransfer_CacheWarmer)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(ccnxSimpleFileTransfer_CacheWarmer)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(ccnxSimpleFileTransfer_CacheWarmer)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, createRelease);
+    LONGBOW_RUN_TEST_CASE(Global, loadsInOrder);
+    LONGBOW_RUN_TEST_CASE(Global, addNamesFromFile);
+    LONGBOW_RUN_TEST_CASE(Global, pacesReads);
+    LONGBOW_RUN_TEST_CASE(Global, stopInterruptsPacing);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+/**
+ * Records the names it is asked to load, and loads all but those starting with 'x'.
+ */
+typedef struct testLoader {
+    pthread_mutex_t mutex;
+    char loaded[64];
+    size_t bytesPerLoad;
+    int numPaceFailures;
+} _TestLoader;
+
+static bool
+_testLoad(void *loaderContext, CCNxSimpleFileTransferCacheWarmer *warmer, const char *name)
+{
+    _TestLoader *loader = loaderContext;
+
+    bool isPaced = ccnxSimpleFileTransferCacheWarmer_Pace(warmer, loader->bytesPerLoad);
+
+    pthread_mutex_lock(&loader->mutex);
+    strcat(loader->loaded, name);
+    if (!isPaced) {
+        loader->numPaceFailures++;
+    }
+    pthread_mutex_unlock(&loader->mutex);
+
+    return name[0] != 'x';
+}
+
+static void
+_initLoader(_TestLoader *loader, size_t bytesPerLoad)
+{
+    memset(loader, 0, sizeof(*loader));
+    pthread_mutex_init(&loader->mutex, NULL);
+    loader->bytesPerLoad = bytesPerLoad;
+}
+
+static uint64_t
+_elapsedMillisSince(uint64_t startNanos)
+{
+    return (_nowNanos() - startNanos) / 1000000;
+}
+
+LONGBOW_TEST_CASE(Global, createRelease)
+{
+    _TestLoader loader;
+    _initLoader(&loader, 0);
+
+    CCNxSimpleFileTransferCacheWarmer *warmer = ccnxSimpleFileTransferCacheWarmer_Create(_testLoad, &loader, 1, 0);
+    assertNotNull(warmer, "Expected a new warmer");
+
+    CCNxSimpleFileTransferCacheWarmer *reference = ccnxSimpleFileTransferCacheWarmer_Acquire(warmer);
+    ccnxSimpleFileTransferCacheWarmer_Release(&reference);
+    ccnxSimpleFileTransferCacheWarmer_Release(&warmer);
+    assertNull(warmer, "Expected release to clear the pointer");
+}
+
+LONGBOW_TEST_CASE(Global, loadsInOrder)
+{
+    _TestLoader loader;
+    _initLoader(&loader, 0);
+
+    CCNxSimpleFileTransferCacheWarmer *warmer = ccnxSimpleFileTransferCacheWarmer_Create(_testLoad, &loader, 1, 0);
+    ccnxSimpleFileTransferCacheWarmer_AddName(warmer, "a");
+    ccnxSimpleFileTransferCacheWarmer_AddName(warmer, "x");
+    ccnxSimpleFileTransferCacheWarmer_AddName(warmer, "b");
+
+    ccnxSimpleFileTransferCacheWarmer_Start(warmer);
+    ccnxSimpleFileTransferCacheWarmer_Join(warmer);
+
+    assertTrue(strcmp(loader.loaded, "axb") == 0, "Expected the names in order, got '%s'", loader.loaded);
+    assertTrue(ccnxSimpleFileTransferCacheWarmer_GetNumLoaded(warmer) == 2,
+               "Expected the failed load not to be counted, got %zu", ccnxSimpleFileTransferCacheWarmer_GetNumLoaded(warmer));
+
+    ccnxSimpleFileTransferCacheWarmer_Release(&warmer);
+}
+
+LONGBOW_TEST_CASE(Global, addNamesFromFile)
+{
+    char path[] = "/tmp/test_ccnxSimpleFileTransfer_CacheWarmerXXXXXX";
+    int fd = mkstemp(path);
+    assertTrue(fd >= 0, "Could not create a temporary file");
+    const char *contents = "# Most recently used first\na 1024\n\nb\tsomething else\nc\n";
+    assertTrue(write(fd, contents, strlen(contents)) == (ssize_t) strlen(contents), "Could not write the temporary file");
+    close(fd);
+
+    _TestLoader loader;
+    _initLoader(&loader, 0);
+
+    CCNxSimpleFileTransferCacheWarmer *warmer = ccnxSimpleFileTransferCacheWarmer_Create(_testLoad, &loader, 2, 0);
+    int numNames = ccnxSimpleFileTransferCacheWarmer_AddNamesFromFile(warmer, path);
+    unlink(path);
+    assertTrue(numNames == 3, "Expected 3 names, got %d", numNames);
+
+    ccnxSimpleFileTransferCacheWarmer_Start(warmer);
+    ccnxSimpleFileTransferCacheWarmer_Join(warmer);
+    assertTrue(strlen(loader.loaded) == 3 && strchr(loader.loaded, 'a') && strchr(loader.loaded, 'b') && strchr(loader.loaded, 'c'),
+               "Expected a, b and c to be loaded, got '%s'", loader.loaded);
+
+    assertTrue(ccnxSimpleFileTransferCacheWarmer_AddNamesFromFile(warmer, path) == -1, "Expected -1 for a missing file");
+
+    ccnxSimpleFileTransferCacheWarmer_Release(&warmer);
+}
+
+LONGBOW_TEST_CASE(Global, pacesReads)
+{
+    _TestLoader loader;
+    _initLoader(&loader, 10000);
+
+    // 4 loads of 10000 bytes at 100000 bytes per second take at least 400ms, even on 2 threads.
+    CCNxSimpleFileTransferCacheWarmer *warmer = ccnxSimpleFileTransferCacheWarmer_Create(_testLoad, &loader, 2, 100000);
+    const char *names[] = { "a", "b", "c", "d" };
+    for (size_t i = 0; i < 4; i++) {
+        ccnxSimpleFileTransferCacheWarmer_AddName(warmer, names[i]);
+    }
+
+    uint64_t startNanos = _nowNanos();
+    ccnxSimpleFileTransferCacheWarmer_Start(warmer);
+    ccnxSimpleFileTransferCacheWarmer_Join(warmer);
+    uint64_t elapsedMillis = _elapsedMillisSince(startNanos);
+
+    assertTrue(elapsedMillis >= 390, "Expected at least 400ms, took %" PRIu64 "ms", elapsedMillis);
+    assertTrue(loader.numPaceFailures == 0, "Expected no pacing failures, got %d", loader.numPaceFailures);
+
+    ccnxSimpleFileTransferCacheWarmer_Release(&warmer);
+}
+
+LONGBOW_TEST_CASE(Global, stopInterruptsPacing)
+{
+    _TestLoader loader;
+    _initLoader(&loader, 1000);
+
+    // At 10 bytes per second, each load would take 100 seconds.
+    CCNxSimpleFileTransferCacheWarmer *warmer = ccnxSimpleFileTransferCacheWarmer_Create(_testLoad, &loader, 1, 10);
+    ccnxSimpleFileTransferCacheWarmer_AddName(warmer, "a");
+    ccnxSimpleFileTransferCacheWarmer_AddName(warmer, "b");
+
+    uint64_t startNanos = _nowNanos();
+    ccnxSimpleFileTransferCacheWarmer_Start(warmer);
+    usleep(50000);
+    ccnxSimpleFileTransferCacheWarmer_Stop(warmer);
+    uint64_t elapsedMillis = _elapsedMillisSince(startNanos);
+
+    assertTrue(elapsedMillis < 5000, "Expected stopping to interrupt the wait, took %" PRIu64 "ms", elapsedMillis);
+    assertTrue(strcmp(loader.loaded, "a") == 0, "Expected only the first load to have started, got '%s'", loader.loaded);
+    assertTrue(loader.numPaceFailures == 1, "Expected the loader to be told to give up, got %d", loader.numPaceFailures);
+
+    ccnxSimpleFileTransferCacheWarmer_Release(&warmer);
+}
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(ccnxSimpleFileTransfer_CacheWarmer);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
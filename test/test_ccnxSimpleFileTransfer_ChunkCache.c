@@ -0,0 +1,333 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../ccnxSimpleFileTransfer_ChunkCache.c"
+#include "../ccnxSimpleFileTransfer_AdmissionFilter.c"
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <unistd.h>
+
+LONGBOW_TEST_RUNNER(ccnxSimpleFileTransfer_ChunkCache)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(ccnxSimpleFileTransfer_ChunkCache)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(ccnxSimpleFileTransfer_ChunkCache)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, createRelease);
+    LONGBOW_RUN_TEST_CASE(Global, getAndPut);
+    LONGBOW_RUN_TEST_CASE(Global, replace);
+    LONGBOW_RUN_TEST_CASE(Global, evictsLeastRecentlyUsed);
+    LONGBOW_RUN_TEST_CASE(Global, unlimited);
+    LONGBOW_RUN_TEST_CASE(Global, tooBig);
+    LONGBOW_RUN_TEST_CASE(Global, admissionProtectsHotSet);
+    LONGBOW_RUN_TEST_CASE(Global, putIfRoom);
+    LONGBOW_RUN_TEST_CASE(Global, forEachKey);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+static PARCBuffer *
+_createValue(const char *contents)
+{
+    return parcBuffer_WrapCString((char *) contents);
+}
+
+static void
+_put(CCNxSimpleFileTransferChunkCache *cache, const char *key, size_t sizeBytes)
+{
+    PARCBuffer *value = _createValue(key);
+    ccnxSimpleFileTransferChunkCache_Put(cache, key, value, sizeBytes);
+    parcBuffer_Release(&value);
+}
+
+static bool
+_contains(CCNxSimpleFileTransferChunkCache *cache, const char *key)
+{
+    // Look without disturbing the recency order or the statistics.
+    return _findEntry(cache, key) != NULL;
+}
+
+LONGBOW_TEST_CASE(Global, createRelease)
+{
+    CCNxSimpleFileTransferChunkCache *cache = ccnxSimpleFileTransferChunkCache_Create(1000, NULL);
+    assertNotNull(cache, "Expected a new cache");
+
+    CCNxSimpleFileTransferChunkCache *reference = ccnxSimpleFileTransferChunkCache_Acquire(cache);
+    ccnxSimpleFileTransferChunkCache_Release(&reference);
+    assertNull(reference, "Expected Release to clear the pointer");
+
+    ccnxSimpleFileTransferChunkCache_Release(&cache);
+}
+
+LONGBOW_TEST_CASE(Global, getAndPut)
+{
+    CCNxSimpleFileTransferChunkCache *cache = ccnxSimpleFileTransferChunkCache_Create(1000, NULL);
+
+    assertNull(ccnxSimpleFileTransferChunkCache_Get(cache, "a"), "Expected a miss");
+
+    PARCBuffer *value = _createValue("a");
+    ccnxSimpleFileTransferChunkCache_Put(cache, "a", value, 100);
+
+    PARCObject *cached = ccnxSimpleFileTransferChunkCache_Get(cache, "a");
+    assertTrue(cached == value, "Expected the value that was put");
+    parcObject_Release(&cached);
+    parcBuffer_Release(&value);
+
+    CCNxSimpleFileTransferChunkCacheStats stats = ccnxSimpleFileTransferChunkCache_GetStats(cache);
+    assertTrue(stats.hits == 1 && stats.misses == 1, "Expected 1 hit and 1 miss, got %" PRIu64 " and %" PRIu64, stats.hits, stats.misses);
+    assertTrue(stats.numEntries == 1 && stats.sizeBytes == 100, "Expected 1 entry of 100 bytes, got %zu and %zu",
+               stats.numEntries, stats.sizeBytes);
+
+    ccnxSimpleFileTransferChunkCache_Release(&cache);
+}
+
+LONGBOW_TEST_CASE(Global, replace)
+{
+    CCNxSimpleFileTransferChunkCache *cache = ccnxSimpleFileTransferChunkCache_Create(1000, NULL);
+
+    _put(cache, "a", 100);
+    _put(cache, "a", 300);
+
+    CCNxSimpleFileTransferChunkCacheStats stats = ccnxSimpleFileTransferChunkCache_GetStats(cache);
+    assertTrue(stats.numEntries == 1 && stats.sizeBytes == 300, "Expected 1 entry of 300 bytes, got %zu and %zu",
+               stats.numEntries, stats.sizeBytes);
+
+    ccnxSimpleFileTransferChunkCache_Release(&cache);
+}
+
+LONGBOW_TEST_CASE(Global, evictsLeastRecentlyUsed)
+{
+    CCNxSimpleFileTransferChunkCache *cache = ccnxSimpleFileTransferChunkCache_Create(300, NULL);
+
+    _put(cache, "a", 100);
+    _put(cache, "b", 100);
+    _put(cache, "c", 100);
+
+    // Use 'a', so 'b' is now the least recently used.
+    PARCObject *cached = ccnxSimpleFileTransferChunkCache_Get(cache, "a");
+    parcObject_Release(&cached);
+
+    _put(cache, "d", 100);
+    assertTrue(_contains(cache, "a"), "Expected 'a' to be kept");
+    assertFalse(_contains(cache, "b"), "Expected 'b' to be evicted");
+    assertTrue(_contains(cache, "c") && _contains(cache, "d"), "Expected 'c' and 'd' to be kept");
+
+    _put(cache, "e", 250);
+    CCNxSimpleFileTransferChunkCacheStats stats = ccnxSimpleFileTransferChunkCache_GetStats(cache);
+    assertTrue(stats.numEntries == 1 && _contains(cache, "e"), "Expected only 'e' to be left, have %zu entries", stats.numEntries);
+    assertTrue(stats.evictions == 4, "Expected 4 evictions, got %" PRIu64, stats.evictions);
+
+    ccnxSimpleFileTransferChunkCache_Release(&cache);
+}
+
+LONGBOW_TEST_CASE(Global, unlimited)
+{
+    CCNxSimpleFileTransferChunkCache *cache = ccnxSimpleFileTransferChunkCache_Create(0, NULL);
+
+    for (int i = 0; i < 10; i++) {
+        char key[8];
+        sprintf(key, "%d", i);
+        assertTrue(ccnxSimpleFileTransferChunkCache_ShouldAdmit(cache, key, 1 << 30), "Expected everything to be admitted");
+        _put(cache, key, 1 << 30);
+    }
+    assertTrue(ccnxSimpleFileTransferChunkCache_GetStats(cache).numEntries == 10, "Expected nothing to be evicted");
+
+    ccnxSimpleFileTransferChunkCache_Release(&cache);
+}
+
+LONGBOW_TEST_CASE(Global, tooBig)
+{
+    CCNxSimpleFileTransferChunkCache *cache = ccnxSimpleFileTransferChunkCache_Create(300, NULL);
+
+    assertTrue(ccnxSimpleFileTransferChunkCache_ShouldAdmit(cache, "a", 300), "Expected an entry that fits to be admitted");
+    assertFalse(ccnxSimpleFileTransferChunkCache_ShouldAdmit(cache, "a", 301), "Expected an entry that can't fit to be refused");
+
+    ccnxSimpleFileTransferChunkCache_Release(&cache);
+}
+
+LONGBOW_TEST_CASE(Global, admissionProtectsHotSet)
+{
+    CCNxSimpleFileTransferAdmissionFilter *filter = ccnxSimpleFileTransferAdmissionFilter_Create(1000);
+    CCNxSimpleFileTransferChunkCache *cache = ccnxSimpleFileTransferChunkCache_Create(300, filter);
+
+    // 'hot1' and 'hot2' are requested often, and cached.
+    for (int i = 0; i < 5; i++) {
+        ccnxSimpleFileTransferChunkCache_RecordRequest(cache, "hot1");
+        ccnxSimpleFileTransferChunkCache_RecordRequest(cache, "hot2");
+
+        PARCObject *cached = ccnxSimpleFileTransferChunkCache_Get(cache, "hot1");
+        if (cached == NULL) {
+            assertTrue(ccnxSimpleFileTransferChunkCache_ShouldAdmit(cache, "hot1", 100), "Expected room for 'hot1'");
+            _put(cache, "hot1", 100);
+        } else {
+            parcObject_Release(&cached);
+        }
+        cached = ccnxSimpleFileTransferChunkCache_Get(cache, "hot2");
+        if (cached == NULL) {
+            assertTrue(ccnxSimpleFileTransferChunkCache_ShouldAdmit(cache, "hot2", 100), "Expected room for 'hot2'");
+            _put(cache, "hot2", 100);
+        } else {
+            parcObject_Release(&cached);
+        }
+    }
+
+    // A one-off request for a big cold file would evict both.
+    ccnxSimpleFileTransferChunkCache_RecordRequest(cache, "cold");
+    assertNull(ccnxSimpleFileTransferChunkCache_Get(cache, "cold"), "Expected a miss");
+    assertFalse(ccnxSimpleFileTransferChunkCache_ShouldAdmit(cache, "cold", 300), "Expected the cold file to be refused");
+
+    // A small one fits in the free space without evicting anything.
+    assertTrue(ccnxSimpleFileTransferChunkCache_ShouldAdmit(cache, "cold", 100), "Expected a file that fits to be admitted");
+
+    CCNxSimpleFileTransferChunkCacheStats stats = ccnxSimpleFileTransferChunkCache_GetStats(cache);
+    assertTrue(stats.rejections == 1, "Expected 1 rejection, got %" PRIu64, stats.rejections);
+
+    ccnxSimpleFileTransferChunkCache_Release(&cache);
+    ccnxSimpleFileTransferAdmissionFilter_Release(&filter);
+}
+
+
+LONGBOW_TEST_CASE(Global, putIfRoom)
+{
+    CCNxSimpleFileTransferChunkCache *cache = ccnxSimpleFileTransferChunkCache_Create(100, NULL);
+    PARCBuffer *value = _createValue("value");
+
+    assertTrue(ccnxSimpleFileTransferChunkCache_HasRoomFor(cache, "a", 60), "Expected room in an empty cache");
+    assertTrue(ccnxSimpleFileTransferChunkCache_PutIfRoom(cache, "a", value, 60), "Expected a to be added");
+    assertFalse(ccnxSimpleFileTransferChunkCache_HasRoomFor(cache, "a", 10), "Expected no room for a key already cached");
+    assertFalse(ccnxSimpleFileTransferChunkCache_PutIfRoom(cache, "a", value, 10), "Expected a not to be replaced");
+    assertFalse(ccnxSimpleFileTransferChunkCache_PutIfRoom(cache, "b", value, 50), "Expected b not to evict a");
+    assertTrue(ccnxSimpleFileTransferChunkCache_PutIfRoom(cache, "c", value, 40), "Expected c to fit");
+
+    CCNxSimpleFileTransferChunkCacheStats stats = ccnxSimpleFileTransferChunkCache_GetStats(cache);
+    assertTrue(stats.numEntries == 2 && stats.sizeBytes == 100, "Expected a and c, got %zu entries of %zu bytes",
+               stats.numEntries, stats.sizeBytes);
+    assertTrue(stats.evictions == 0, "Expected no evictions, got %" PRIu64, stats.evictions);
+    assertFalse(_contains(cache, "b"), "Expected b not to be cached");
+
+    parcBuffer_Release(&value);
+    ccnxSimpleFileTransferChunkCache_Release(&cache);
+}
+
+static void
+_appendKey(void *callbackContext, const char *key, size_t sizeBytes)
+{
+    strcat((char *) callbackContext, key);
+}
+
+LONGBOW_TEST_CASE(Global, forEachKey)
+{
+    CCNxSimpleFileTransferChunkCache *cache = ccnxSimpleFileTransferChunkCache_Create(0, NULL);
+    _put(cache, "a", 1);
+    _put(cache, "b", 1);
+    _put(cache, "c", 1);
+
+    PARCObject *value = ccnxSimpleFileTransferChunkCache_Get(cache, "a");
+    parcObject_Release(&value);
+
+    char keys[8] = "";
+    ccnxSimpleFileTransferChunkCache_ForEachKey(cache, _appendKey, keys);
+    assertTrue(strcmp(keys, "acb") == 0, "Expected the most recently used first, got '%s'", keys);
+
+    ccnxSimpleFileTransferChunkCache_Release(&cache);
+}
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(ccnxSimpleFileTransfer_ChunkCache);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
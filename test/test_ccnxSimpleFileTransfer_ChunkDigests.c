@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../ccnxSimpleFileTransfer_ChunkDigests.c"
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <unistd.h>
+
+LONGBOW_TEST_RUNNER(ccnxSimpleFileTransfer_ChunkDigests)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(ccnxSimpleFileTransfer_ChunkDigests)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(ccnxSimpleFileTransfer_ChunkDigests)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, createFromFile);
+    LONGBOW_RUN_TEST_CASE(Global, createFromBuffer);
+    LONGBOW_RUN_TEST_CASE(Global, verifyChunk);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+/**
+ * Fill a buffer with repeatable pseudo-random bytes.
+ */
+static void
+_fillRandom(uint8_t *data, size_t length, uint32_t seed)
+{
+    for (size_t i = 0; i < length; i++) {
+        seed = seed * 1103515245U + 12345U;
+        data[i] = (uint8_t) (seed >> 16);
+    }
+}
+
+/**
+ * Write data to a new temporary file, and return a descriptor open on it.
+ */
+static int
+_createTestFile(const uint8_t *data, size_t length)
+{
+    char fileName[] = "/tmp/ccnxSimpleFileTransfer_testChunkDigests.XXXXXX";
+    int result = mkstemp(fileName);
+    assertTrue(result >= 0, "Could not create a temporary file");
+    unlink(fileName);
+
+    assertTrue(write(result, data, length) == (ssize_t) length, "Could not write the temporary file");
+    return result;
+}
+
+LONGBOW_TEST_CASE(Global, createFromFile)
+{
+    size_t chunkSize = 100;
+    uint8_t data[1050];
+    _fillRandom(data, sizeof(data), 1);
+    int fd = _createTestFile(data, sizeof(data));
+
+    CCNxSimpleFileTransferChunkDigests *digests = ccnxSimpleFileTransferChunkDigests_CreateFromFile(fd, sizeof(data), chunkSize);
+    assertNotNull(digests, "Expected digests");
+    assertTrue(ccnxSimpleFileTransferChunkDigests_GetNumChunks(digests) == 11, "Expected 11 chunks");
+    assertTrue(ccnxSimpleFileTransferChunkDigests_GetFileSize(digests) == sizeof(data), "Expected the file's size");
+    assertTrue(ccnxSimpleFileTransferChunkDigests_GetChunkSize(digests) == chunkSize, "Expected the chunk size");
+
+    uint8_t expected[ccnxSimpleFileTransferChunkDigests_DigestLength];
+    _computeDigest(digests->hasher, data + 1000, 50, expected);
+    assertTrue(memcmp(digests->chunkDigests + 10 * ccnxSimpleFileTransferChunkDigests_DigestLength, expected,
+                      sizeof(expected)) == 0, "Expected the digest of the short last chunk");
+
+    _computeDigest(digests->hasher, digests->chunkDigests, 11 * ccnxSimpleFileTransferChunkDigests_DigestLength, expected);
+    assertTrue(memcmp(ccnxSimpleFileTransferChunkDigests_GetFileDigest(digests), expected, sizeof(expected)) == 0,
+               "Expected the file digest to be the digest of the chunk digests");
+    ccnxSimpleFileTransferChunkDigests_Release(&digests);
+
+    // A file shorter than expected can't be digested.
+    digests = ccnxSimpleFileTransferChunkDigests_CreateFromFile(fd, sizeof(data) + 1, chunkSize);
+    assertNull(digests, "Did not expect digests of a short file");
+
+    digests = ccnxSimpleFileTransferChunkDigests_CreateFromFile(fd, 0, chunkSize);
+    assertTrue(ccnxSimpleFileTransferChunkDigests_GetNumChunks(digests) == 0, "Expected no chunks in an empty file");
+    ccnxSimpleFileTransferChunkDigests_Release(&digests);
+
+    close(fd);
+}
+
+LONGBOW_TEST_CASE(Global, createFromBuffer)
+{
+    uint8_t data[5000];
+    _fillRandom(data, sizeof(data), 2);
+    int fd = _createTestFile(data, sizeof(data));
+
+    CCNxSimpleFileTransferChunkDigests *digests = ccnxSimpleFileTransferChunkDigests_CreateFromFile(fd, sizeof(data), 1200);
+    PARCBuffer *buffer = ccnxSimpleFileTransferChunkDigests_CreateBuffer(digests);
+
+    CCNxSimpleFileTransferChunkDigests *copy = ccnxSimpleFileTransferChunkDigests_CreateFromBuffer(buffer);
+    assertNotNull(copy, "Expected the digests to be read back");
+    assertTrue(copy->numChunks == digests->numChunks && copy->chunkSize == digests->chunkSize
+               && copy->fileSize == digests->fileSize, "Expected the same shape");
+    assertTrue(memcmp(copy->chunkDigests, digests->chunkDigests,
+                      digests->numChunks * ccnxSimpleFileTransferChunkDigests_DigestLength) == 0,
+               "Expected the same chunk digests");
+    ccnxSimpleFileTransferChunkDigests_Release(&copy);
+
+    // A chunk digest that doesn't match the file digest is refused.
+    size_t lastByte = parcBuffer_Limit(buffer) - 1;
+    parcBuffer_PutAtIndex(buffer, lastByte, parcBuffer_GetAtIndex(buffer, lastByte) ^ 0x01);
+    assertNull(ccnxSimpleFileTransferChunkDigests_CreateFromBuffer(buffer), "Did not expect damaged digests to be read");
+
+    // Truncated digests are refused.
+    parcBuffer_SetLimit(buffer, lastByte);
+    assertNull(ccnxSimpleFileTransferChunkDigests_CreateFromBuffer(buffer), "Did not expect truncated digests to be read");
+
+    PARCBuffer *nonsense = parcBuffer_WrapCString("not digests at all");
+    assertNull(ccnxSimpleFileTransferChunkDigests_CreateFromBuffer(nonsense), "Did not expect nonsense to be read");
+    parcBuffer_Release(&nonsense);
+
+    parcBuffer_Release(&buffer);
+    ccnxSimpleFileTransferChunkDigests_Release(&digests);
+    close(fd);
+}
+
+LONGBOW_TEST_CASE(Global, verifyChunk)
+{
+    size_t chunkSize = 1200;
+    uint8_t data[3000];
+    _fillRandom(data, sizeof(data), 3);
+    int fd = _createTestFile(data, sizeof(data));
+
+    CCNxSimpleFileTransferChunkDigests *digests = ccnxSimpleFileTransferChunkDigests_CreateFromFile(fd, sizeof(data), chunkSize);
+
+    for (uint64_t i = 0; i < 3; i++) {
+        size_t length = (i < 2) ? chunkSize : sizeof(data) - 2 * chunkSize;
+        PARCBuffer *chunk = parcBuffer_Wrap(data, sizeof(data), i * chunkSize, i * chunkSize + length);
+        assertTrue(ccnxSimpleFileTransferChunkDigests_VerifyChunk(digests, i, chunk), "Expected chunk %" PRIu64 " to verify", i);
+        assertFalse(ccnxSimpleFileTransferChunkDigests_VerifyChunk(digests, (i + 1) % 3, chunk),
+                    "Did not expect chunk %" PRIu64 " to verify as another chunk", i);
+        parcBuffer_Release(&chunk);
+    }
+
+    // A damaged chunk, a short chunk, and a chunk past the end of the file all fail.
+    data[1] ^= 0x80;
+    PARCBuffer *chunk = parcBuffer_Wrap(data, sizeof(data), 0, chunkSize);
+    assertFalse(ccnxSimpleFileTransferChunkDigests_VerifyChunk(digests, 0, chunk), "Did not expect a damaged chunk to verify");
+    parcBuffer_Release(&chunk);
+    data[1] ^= 0x80;
+
+    chunk = parcBuffer_Wrap(data, sizeof(data), 0, chunkSize - 1);
+    assertFalse(ccnxSimpleFileTransferChunkDigests_VerifyChunk(digests, 0, chunk), "Did not expect a short chunk to verify");
+    parcBuffer_Release(&chunk);
+
+    chunk = parcBuffer_Wrap(data, sizeof(data), 0, 0);
+    assertFalse(ccnxSimpleFileTransferChunkDigests_VerifyChunk(digests, 3, chunk), "Did not expect chunk 3 to verify");
+    ccnxSimpleFileTransferChunkDigests_Release(&digests);
+
+    // An empty file is sent as one empty chunk.
+    digests = ccnxSimpleFileTransferChunkDigests_CreateFromFile(fd, 0, chunkSize);
+    assertTrue(ccnxSimpleFileTransferChunkDigests_VerifyChunk(digests, 0, chunk), "Expected the empty chunk 0 to verify");
+    assertFalse(ccnxSimpleFileTransferChunkDigests_VerifyChunk(digests, 1, chunk), "Did not expect chunk 1 to verify");
+    parcBuffer_Release(&chunk);
+    ccnxSimpleFileTransferChunkDigests_Release(&digests);
+
+    close(fd);
+}
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(ccnxSimpleFileTransfer_ChunkDigests);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
@@ -0,0 +1,338 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../ccnxSimpleFileTransfer_ChunkStore.c"
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <unistd.h>
+
+LONGBOW_TEST_RUNNER(ccnxSimpleFileTransfer_ChunkStore)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(ccnxSimpleFileTransfer_ChunkStore)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(ccnxSimpleFileTransfer_ChunkStore)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, createRelease);
+    LONGBOW_RUN_TEST_CASE(Global, storeAndLoad);
+    LONGBOW_RUN_TEST_CASE(Global, uncommittedIsDiscarded);
+    LONGBOW_RUN_TEST_CASE(Global, outOfDateWhenSourceChanges);
+    LONGBOW_RUN_TEST_CASE(Global, mustMatchNameAndChunkSize);
+    LONGBOW_RUN_TEST_CASE(Global, damagedIsRejected);
+    LONGBOW_RUN_TEST_CASE(Global, unsafeNameIsRejected);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+/**
+ * A store in a new temporary directory, with a source file in it, which are removed by _tearDown().
+ */
+typedef struct testStore {
+    char directory[64];
+    char sourcePath[96];
+    char segmentPath[96];
+    CCNxSimpleFileTransferChunkStore *store;
+} _TestStore;
+
+static void
+_writeSource(_TestStore *test, const char *contents)
+{
+    FILE *file = fopen(test->sourcePath, "w");
+    assertNotNull(file, "Could not create %s", test->sourcePath);
+    fputs(contents, file);
+    fclose(file);
+}
+
+static void
+_setUp(_TestStore *test)
+{
+    strcpy(test->directory, "/tmp/test_ccnxSimpleFileTransfer_ChunkStoreXXXXXX");
+    assertNotNull(mkdtemp(test->directory), "Could not create a temporary directory");
+    snprintf(test->sourcePath, sizeof(test->sourcePath), "%s/source.txt", test->directory);
+    snprintf(test->segmentPath, sizeof(test->segmentPath), "%s/store/source.txt.chunks", test->directory);
+    _writeSource(test, "hello, world");
+
+    char storePath[96];
+    snprintf(storePath, sizeof(storePath), "%s/store", test->directory);
+    test->store = ccnxSimpleFileTransferChunkStore_Create(storePath);
+    assertNotNull(test->store, "Expected a new store");
+}
+
+static void
+_tearDown(_TestStore *test)
+{
+    char storePath[96];
+    snprintf(storePath, sizeof(storePath), "%s/store", test->directory);
+
+    ccnxSimpleFileTransferChunkStore_Release(&test->store);
+    unlink(test->segmentPath);
+    unlink(test->sourcePath);
+    rmdir(storePath);
+    rmdir(test->directory);
+}
+
+/**
+ * Store a segment of the specified chunks for the source file.
+ */
+static bool
+_storeChunks(_TestStore *test, const char *baseName, size_t chunkSize, size_t numChunks, const char *chunks[])
+{
+    CCNxSimpleFileTransferChunkStoreSegment *segment =
+        ccnxSimpleFileTransferChunkStore_CreateSegment(test->store, "source.txt", test->sourcePath, baseName, chunkSize, numChunks);
+    assertNotNull(segment, "Expected a new segment");
+
+    for (size_t i = 0; i < numChunks; i++) {
+        PARCBuffer *chunk = parcBuffer_WrapCString((char *) chunks[i]);
+        assertTrue(ccnxSimpleFileTransferChunkStoreSegment_AppendChunk(segment, chunk), "Could not append chunk %zu", i);
+        parcBuffer_Release(&chunk);
+    }
+    bool result = ccnxSimpleFileTransferChunkStoreSegment_Commit(segment);
+
+    ccnxSimpleFileTransferChunkStoreSegment_Release(&segment);
+    return result;
+}
+
+static CCNxSimpleFileTransferChunkStoreSegment *
+_openSegment(_TestStore *test, const char *baseName, size_t chunkSize)
+{
+    return ccnxSimpleFileTransferChunkStore_OpenSegment(test->store, "source.txt", test->sourcePath, baseName, chunkSize);
+}
+
+LONGBOW_TEST_CASE(Global, createRelease)
+{
+    _TestStore test;
+    _setUp(&test);
+
+    CCNxSimpleFileTransferChunkStore *reference = ccnxSimpleFileTransferChunkStore_Acquire(test.store);
+    ccnxSimpleFileTransferChunkStore_Release(&reference);
+    assertNull(_openSegment(&test, "ccnx:/a/fetch/source.txt", 4), "Expected no segment in a new store");
+
+    _tearDown(&test);
+    assertNull(test.store, "Expected release to clear the pointer");
+}
+
+LONGBOW_TEST_CASE(Global, storeAndLoad)
+{
+    _TestStore test;
+    _setUp(&test);
+
+    const char *chunks[] = { "hell", "o, w", "orl", "d" };
+    assertTrue(_storeChunks(&test, "ccnx:/a/fetch/source.txt", 4, 4, chunks), "Expected the segment to be stored");
+
+    CCNxSimpleFileTransferChunkStoreSegment *segment = _openSegment(&test, "ccnx:/a/fetch/source.txt", 4);
+    assertNotNull(segment, "Expected the stored segment");
+    assertTrue(ccnxSimpleFileTransferChunkStoreSegment_GetNumChunks(segment) == 4, "Expected 4 chunks, got %" PRIu64,
+               ccnxSimpleFileTransferChunkStoreSegment_GetNumChunks(segment));
+
+    for (uint64_t i = 0; i < 4; i++) {
+        PARCBuffer *chunk = ccnxSimpleFileTransferChunkStoreSegment_GetChunk(segment, i);
+        assertNotNull(chunk, "Expected chunk %" PRIu64, i);
+        char *contents = parcBuffer_ToString(chunk);
+        assertTrue(strcmp(contents, chunks[i]) == 0, "Expected '%s', got '%s'", chunks[i], contents);
+        parcMemory_Deallocate((void **) &contents);
+        parcBuffer_Release(&chunk);
+    }
+    assertNull(ccnxSimpleFileTransferChunkStoreSegment_GetChunk(segment, 4), "Expected no chunk past the end");
+
+    ccnxSimpleFileTransferChunkStoreSegment_Release(&segment);
+    _tearDown(&test);
+}
+
+LONGBOW_TEST_CASE(Global, uncommittedIsDiscarded)
+{
+    _TestStore test;
+    _setUp(&test);
+
+    CCNxSimpleFileTransferChunkStoreSegment *segment =
+        ccnxSimpleFileTransferChunkStore_CreateSegment(test.store, "source.txt", test.sourcePath, "ccnx:/a", 4, 1);
+    PARCBuffer *chunk = parcBuffer_WrapCString("hell");
+    ccnxSimpleFileTransferChunkStoreSegment_AppendChunk(segment, chunk);
+    parcBuffer_Release(&chunk);
+    ccnxSimpleFileTransferChunkStoreSegment_Release(&segment);
+
+    assertNull(_openSegment(&test, "ccnx:/a", 4), "Expected an uncommitted segment not to be stored");
+
+    // An incomplete segment can't be committed, and doesn't replace the one that is stored.
+    const char *chunks[] = { "hell" };
+    assertTrue(_storeChunks(&test, "ccnx:/a", 4, 1, chunks), "Expected the segment to be stored");
+    segment = ccnxSimpleFileTransferChunkStore_CreateSegment(test.store, "source.txt", test.sourcePath, "ccnx:/b", 4, 2);
+    chunk = parcBuffer_WrapCString("hell");
+    ccnxSimpleFileTransferChunkStoreSegment_AppendChunk(segment, chunk);
+    parcBuffer_Release(&chunk);
+    assertFalse(ccnxSimpleFileTransferChunkStoreSegment_Commit(segment), "Expected an incomplete segment not to be committed");
+    ccnxSimpleFileTransferChunkStoreSegment_Release(&segment);
+
+    assertNull(_openSegment(&test, "ccnx:/b", 4), "Expected the incomplete segment not to be stored");
+    CCNxSimpleFileTransferChunkStoreSegment *old = _openSegment(&test, "ccnx:/a", 4);
+    assertNotNull(old, "Expected the old segment to remain");
+    ccnxSimpleFileTransferChunkStoreSegment_Release(&old);
+
+    _tearDown(&test);
+}
+
+LONGBOW_TEST_CASE(Global, outOfDateWhenSourceChanges)
+{
+    _TestStore test;
+    _setUp(&test);
+
+    const char *chunks[] = { "hello, world" };
+    assertTrue(_storeChunks(&test, "ccnx:/a", 16, 1, chunks), "Expected the segment to be stored");
+
+    _writeSource(&test, "hello, world!");
+    assertNull(_openSegment(&test, "ccnx:/a", 16), "Expected a segment built from an older source not to be used");
+
+    _tearDown(&test);
+}
+
+LONGBOW_TEST_CASE(Global, mustMatchNameAndChunkSize)
+{
+    _TestStore test;
+    _setUp(&test);
+
+    const char *chunks[] = { "hello, world" };
+    assertTrue(_storeChunks(&test, "ccnx:/a", 16, 1, chunks), "Expected the segment to be stored");
+
+    assertNull(_openSegment(&test, "ccnx:/b", 16), "Expected a segment built for another name not to be used");
+    assertNull(_openSegment(&test, "ccnx:/a", 8), "Expected a segment built for another chunk size not to be used");
+
+    CCNxSimpleFileTransferChunkStoreSegment *segment = _openSegment(&test, "ccnx:/a", 16);
+    assertNotNull(segment, "Expected the segment with the same name and chunk size to be used");
+    ccnxSimpleFileTransferChunkStoreSegment_Release(&segment);
+
+    _tearDown(&test);
+}
+
+LONGBOW_TEST_CASE(Global, damagedIsRejected)
+{
+    _TestStore test;
+    _setUp(&test);
+
+    const char *chunks[] = { "hello, ", "world" };
+    assertTrue(_storeChunks(&test, "ccnx:/a", 8, 2, chunks), "Expected the segment to be stored");
+
+    // Cut off the index.
+    struct stat status;
+    stat(test.segmentPath, &status);
+    assertTrue(truncate(test.segmentPath, status.st_size - 8) == 0, "Could not truncate %s", test.segmentPath);
+
+    assertNull(_openSegment(&test, "ccnx:/a", 8), "Expected a truncated segment not to be used");
+
+    _tearDown(&test);
+}
+
+LONGBOW_TEST_CASE(Global, unsafeNameIsRejected)
+{
+    _TestStore test;
+    _setUp(&test);
+
+    // Any of these would name a file outside the store.
+    const char *names[] = { "../source.txt", "a/../../b", "/tmp/x", "..", ".", "" };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        CCNxSimpleFileTransferChunkStoreSegment *segment =
+            ccnxSimpleFileTransferChunkStore_CreateSegment(test.store, names[i], test.sourcePath, "ccnx:/a", 8, 1);
+        assertNull(segment, "Expected no segment for '%s'", names[i]);
+        segment = ccnxSimpleFileTransferChunkStore_OpenSegment(test.store, names[i], test.sourcePath, "ccnx:/a", 8);
+        assertNull(segment, "Expected no segment for '%s'", names[i]);
+    }
+
+    _tearDown(&test);
+}
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(ccnxSimpleFileTransfer_ChunkStore);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
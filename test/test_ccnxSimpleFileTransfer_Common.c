@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../ccnxSimpleFileTransfer_Common.c"
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <unistd.h>
+
+LONGBOW_TEST_RUNNER(ccnxSimpleFileTransfer_Common)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(ccnxSimpleFileTransfer_Common)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(ccnxSimpleFileTransfer_Common)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, getChunkNumberFromName);
+    LONGBOW_RUN_TEST_CASE(Global, createFileNameFromName);
+    LONGBOW_RUN_TEST_CASE(Global, getVersionFromName);
+    LONGBOW_RUN_TEST_CASE(Global, statPayload);
+    LONGBOW_RUN_TEST_CASE(Global, getShardForFileName);
+    LONGBOW_RUN_TEST_CASE(Global, createShardPrefix);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_CASE(Global, getChunkNumberFromName)
+{
+    CCNxName *name = ccnxName_CreateFromCString("ccnx:/a/b/c/chunk=42");
+    assertTrue(ccnxSimpleFileTransferCommon_GetChunkNumberFromName(name) == 42,
+               "Expected chunk 42, got %" PRIu64, ccnxSimpleFileTransferCommon_GetChunkNumberFromName(name));
+    ccnxName_Release(&name);
+}
+
+LONGBOW_TEST_CASE(Global, createFileNameFromName)
+{
+    CCNxName *name = ccnxName_CreateFromCString("ccnx:/a/b/c/chunk=42");
+    char *fileName = ccnxSimpleFileTransferCommon_CreateFileNameFromName(name);
+    assertTrue(strcmp(fileName, "c") == 0, "Expected 'c', got '%s'", fileName);
+    parcMemory_Deallocate((void **) &fileName);
+    ccnxName_Release(&name);
+}
+
+LONGBOW_TEST_CASE(Global, getVersionFromName)
+{
+    CCNxName *name = ccnxName_CreateFromCString("ccnx:/a/b/c/chunk=42");
+    assertTrue(ccnxSimpleFileTransferCommon_GetVersionFromName(name) == 0, "Expected no version");
+    ccnxName_Release(&name);
+
+    name = ccnxName_CreateFromCString("ccnx:/a/b/c/serial=1234/chunk=42");
+    assertTrue(ccnxSimpleFileTransferCommon_GetVersionFromName(name) == 1234,
+               "Expected version 1234, got %" PRIu64, ccnxSimpleFileTransferCommon_GetVersionFromName(name));
+    assertTrue(ccnxSimpleFileTransferCommon_GetChunkNumberFromName(name) == 42, "Expected chunk 42");
+
+    char *fileName = ccnxSimpleFileTransferCommon_CreateFileNameFromName(name);
+    assertTrue(strcmp(fileName, "c") == 0, "Expected 'c', got '%s'", fileName);
+    parcMemory_Deallocate((void **) &fileName);
+    ccnxName_Release(&name);
+}
+
+LONGBOW_TEST_CASE(Global, statPayload)
+{
+    PARCBuffer *payload = ccnxSimpleFileTransferCommon_CreateStatPayload(18446744073709551615ULL, 5678);
+
+    uint64_t version = 0;
+    uint64_t fileSize = 0;
+    assertTrue(ccnxSimpleFileTransferCommon_ParseStatPayload(payload, &version, &fileSize), "Expected a valid payload");
+    assertTrue(version == 18446744073709551615ULL, "Expected the largest version, got %" PRIu64, version);
+    assertTrue(fileSize == 5678, "Expected a size of 5678, got %" PRIu64, fileSize);
+    parcBuffer_Release(&payload);
+
+    payload = parcBuffer_WrapCString("nonsense");
+    assertFalse(ccnxSimpleFileTransferCommon_ParseStatPayload(payload, &version, &fileSize), "Expected an invalid payload");
+    parcBuffer_Release(&payload);
+}
+
+LONGBOW_TEST_CASE(Global, getShardForFileName)
+{
+    assertTrue(ccnxSimpleFileTransferCommon_GetShardForFileName("foo.zip", 0) == 0, "Expected shard 0 when not sharding");
+    assertTrue(ccnxSimpleFileTransferCommon_GetShardForFileName("foo.zip", 1) == 0, "Expected shard 0 of 1");
+
+    unsigned int numShards = 8;
+    unsigned int counts[8] = { 0 };
+    char fileName[32];
+    for (int i = 0; i < 800; i++) {
+        sprintf(fileName, "file%d.dat", i);
+        unsigned int shard = ccnxSimpleFileTransferCommon_GetShardForFileName(fileName, numShards);
+        assertTrue(shard < numShards, "Expected a shard less than %u, got %u", numShards, shard);
+        assertTrue(shard == ccnxSimpleFileTransferCommon_GetShardForFileName(fileName, numShards),
+                   "Expected the same shard every time");
+        counts[shard]++;
+    }
+    for (unsigned int i = 0; i < numShards; i++) {
+        assertTrue(counts[i] > 0, "Expected some files in shard %u", i);
+    }
+}
+
+LONGBOW_TEST_CASE(Global, createShardPrefix)
+{
+    CCNxName *domainPrefix = ccnxName_CreateFromCString(ccnxSimpleFileTransferCommon_NamePrefix);
+    CCNxName *shardPrefix = ccnxSimpleFileTransferCommon_CreateShardPrefix(domainPrefix, 3);
+
+    assertTrue(ccnxName_GetSegmentCount(shardPrefix) == ccnxName_GetSegmentCount(domainPrefix) + 1,
+               "Expected the shard prefix to have one more segment than the domain prefix");
+    assertTrue(ccnxName_StartsWith(shardPrefix, domainPrefix), "Expected the shard prefix to start with the domain prefix");
+
+    CCNxName *other = ccnxSimpleFileTransferCommon_CreateShardPrefix(domainPrefix, 4);
+    assertFalse(ccnxName_Equals(shardPrefix, other), "Expected different shards to have different prefixes");
+
+    ccnxName_Release(&other);
+    ccnxName_Release(&shardPrefix);
+    ccnxName_Release(&domainPrefix);
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(ccnxSimpleFileTransfer_Common);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
@@ -0,0 +1,334 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../ccnxSimpleFileTransfer_Compressor.c"
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+LONGBOW_TEST_RUNNER(ccnxSimpleFileTransfer_Compressor)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(ccnxSimpleFileTransfer_Compressor)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(ccnxSimpleFileTransfer_Compressor)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, encodeDecode);
+    LONGBOW_RUN_TEST_CASE(Global, encodeIncompressible);
+    LONGBOW_RUN_TEST_CASE(Global, encodeZeros);
+    LONGBOW_RUN_TEST_CASE(Global, decodeMalformed);
+    LONGBOW_RUN_TEST_CASE(Global, selectCodecForFile);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+/**
+ * Fill a chunk with lines of text, as found in a log file.
+ */
+static PARCBuffer *
+_createTextChunk(size_t length)
+{
+    PARCBuffer *result = parcBuffer_Allocate(length);
+    for (size_t i = 0; i < length; i++) {
+        char line[64];
+        int lineLength = snprintf(line, sizeof(line), "2016-01-01 12:00:%02zu INFO request served\n", (i / 64) % 60);
+        parcBuffer_PutUint8(result, (uint8_t) line[i % lineLength]);
+    }
+    return parcBuffer_Flip(result);
+}
+
+static PARCBuffer *
+_createRandomChunk(size_t length)
+{
+    PARCBuffer *result = parcBuffer_Allocate(length);
+    for (size_t i = 0; i < length; i++) {
+        parcBuffer_PutUint8(result, (uint8_t) random());
+    }
+    return parcBuffer_Flip(result);
+}
+
+static char *
+_createTestFile(PARCBuffer *(*createChunk)(size_t), size_t chunkSize, int numChunks)
+{
+    const char *template = "/tmp/ccnxSimpleFileTransfer_testCompressor.XXXXXX";
+    char *fileName = parcMemory_StringDuplicate(template, strlen(template));
+    int fd = mkstemp(fileName);
+    for (int i = 0; i < numChunks; i++) {
+        PARCBuffer *chunk = createChunk(chunkSize);
+        write(fd, parcBuffer_Overlay(chunk, 0), parcBuffer_Remaining(chunk));
+        parcBuffer_Release(&chunk);
+    }
+    close(fd);
+    return fileName;
+}
+
+LONGBOW_TEST_CASE(Global, encodeDecode)
+{
+    CCNxSimpleFileTransferCompressor *compressor = ccnxSimpleFileTransferCompressor_Create();
+    PARCBuffer *chunk = _createTextChunk(1200);
+
+    CCNxSimpleFileTransferCodec codecs[] = {
+        CCNxSimpleFileTransferCodec_None, CCNxSimpleFileTransferCodec_LZ4, CCNxSimpleFileTransferCodec_Zstd
+    };
+    for (size_t i = 0; i < sizeof(codecs) / sizeof(codecs[0]); i++) {
+        PARCBuffer *encoded = ccnxSimpleFileTransferCompressor_Encode(compressor, codecs[i], chunk);
+
+        if (codecs[i] != CCNxSimpleFileTransferCodec_None && ccnxSimpleFileTransferCompressor_IsAvailable(codecs[i])) {
+            assertTrue(parcBuffer_GetAtIndex(encoded, 0) == codecs[i], "Expected the chunk to be compressed with %s",
+                       ccnxSimpleFileTransferCompressor_GetCodecName(codecs[i]));
+            assertTrue(parcBuffer_Remaining(encoded) < parcBuffer_Remaining(chunk) / 2,
+                       "Expected text to compress to less than half, got %zu bytes", parcBuffer_Remaining(encoded));
+        } else {
+            assertTrue(parcBuffer_GetAtIndex(encoded, 0) == CCNxSimpleFileTransferCodec_None,
+                       "Expected the chunk to be sent as it is");
+            assertTrue(parcBuffer_Remaining(encoded) == 1 + parcBuffer_Remaining(chunk), "Expected only the codec to be added");
+        }
+
+        PARCBuffer *decoded = ccnxSimpleFileTransferCompressor_Decode(compressor, encoded, 1200);
+        assertNotNull(decoded, "Expected the chunk to be decoded");
+        assertTrue(parcBuffer_Equals(decoded, chunk), "Expected the decoded chunk to equal the original");
+        assertFalse(ccnxSimpleFileTransferCompressor_IsZeros(compressor, decoded), "Expected text not to be taken for zeros");
+
+        parcBuffer_Release(&decoded);
+        parcBuffer_Release(&encoded);
+    }
+
+    parcBuffer_Release(&chunk);
+    ccnxSimpleFileTransferCompressor_Release(&compressor);
+}
+
+LONGBOW_TEST_CASE(Global, encodeIncompressible)
+{
+    CCNxSimpleFileTransferCompressor *compressor = ccnxSimpleFileTransferCompressor_Create();
+    PARCBuffer *chunk = _createRandomChunk(1200);
+
+    PARCBuffer *encoded = ccnxSimpleFileTransferCompressor_Encode(compressor, CCNxSimpleFileTransferCodec_Zstd, chunk);
+    assertTrue(parcBuffer_GetAtIndex(encoded, 0) == CCNxSimpleFileTransferCodec_None,
+               "Expected random bytes to be sent as they are");
+    assertTrue(parcBuffer_Remaining(encoded) == 1201, "Expected 1201 bytes, got %zu", parcBuffer_Remaining(encoded));
+
+    PARCBuffer *decoded = ccnxSimpleFileTransferCompressor_Decode(compressor, encoded, 1200);
+    assertTrue(parcBuffer_Equals(decoded, chunk), "Expected the decoded chunk to equal the original");
+
+    parcBuffer_Release(&decoded);
+    parcBuffer_Release(&encoded);
+    parcBuffer_Release(&chunk);
+    ccnxSimpleFileTransferCompressor_Release(&compressor);
+}
+
+LONGBOW_TEST_CASE(Global, encodeZeros)
+{
+    CCNxSimpleFileTransferCompressor *compressor = ccnxSimpleFileTransferCompressor_Create();
+    PARCBuffer *chunk = parcBuffer_Allocate(1200);
+    memset(parcBuffer_Overlay(chunk, 0), 0, 1200);
+
+    // Whatever the file's codec, a chunk of zeros is sent as just its length.
+    CCNxSimpleFileTransferCodec codecs[] = {
+        CCNxSimpleFileTransferCodec_None, CCNxSimpleFileTransferCodec_LZ4, CCNxSimpleFileTransferCodec_Zstd
+    };
+    for (size_t i = 0; i < sizeof(codecs) / sizeof(codecs[0]); i++) {
+        PARCBuffer *encoded = ccnxSimpleFileTransferCompressor_Encode(compressor, codecs[i], chunk);
+        assertTrue(parcBuffer_GetAtIndex(encoded, 0) == CCNxSimpleFileTransferCodec_Zeros, "Expected a run of zeros");
+        assertTrue(parcBuffer_Remaining(encoded) == 5, "Expected 5 bytes, got %zu", parcBuffer_Remaining(encoded));
+
+        PARCBuffer *decoded = ccnxSimpleFileTransferCompressor_Decode(compressor, encoded, 1200);
+        assertNotNull(decoded, "Expected the run of zeros to be decoded");
+        assertTrue(parcBuffer_Equals(decoded, chunk), "Expected the decoded chunk to equal the original");
+        assertTrue(ccnxSimpleFileTransferCompressor_IsZeros(compressor, decoded), "Expected the chunk known to be zeros");
+
+        parcBuffer_Release(&decoded);
+        parcBuffer_Release(&encoded);
+    }
+
+    PARCBuffer *encoded = ccnxSimpleFileTransferCompressor_EncodeZeros(1200);
+    assertNull(ccnxSimpleFileTransferCompressor_Decode(compressor, encoded, 1000), "Expected a run that is too long to be rejected");
+    parcBuffer_Release(&encoded);
+
+    // A shorter run, such as the final chunk, shares the same zeros.
+    encoded = ccnxSimpleFileTransferCompressor_EncodeZeros(100);
+    PARCBuffer *decoded = ccnxSimpleFileTransferCompressor_Decode(compressor, encoded, 1200);
+    assertTrue(parcBuffer_Remaining(decoded) == 100, "Expected 100 bytes, got %zu", parcBuffer_Remaining(decoded));
+    assertTrue(ccnxSimpleFileTransferCompressor_IsZeros(compressor, decoded), "Expected the chunk known to be zeros");
+    parcBuffer_Release(&decoded);
+    parcBuffer_Release(&encoded);
+
+    // A chunk with a byte that isn't zero is sent as it is.
+    parcBuffer_PutAtIndex(chunk, 1199, 1);
+    encoded = ccnxSimpleFileTransferCompressor_Encode(compressor, CCNxSimpleFileTransferCodec_None, chunk);
+    assertTrue(parcBuffer_GetAtIndex(encoded, 0) == CCNxSimpleFileTransferCodec_None, "Expected the chunk as it is");
+    decoded = ccnxSimpleFileTransferCompressor_Decode(compressor, encoded, 1200);
+    assertFalse(ccnxSimpleFileTransferCompressor_IsZeros(compressor, decoded), "Expected the chunk not known to be zeros");
+    parcBuffer_Release(&decoded);
+    parcBuffer_Release(&encoded);
+
+    parcBuffer_Release(&chunk);
+    ccnxSimpleFileTransferCompressor_Release(&compressor);
+}
+
+LONGBOW_TEST_CASE(Global, decodeMalformed)
+{
+    CCNxSimpleFileTransferCompressor *compressor = ccnxSimpleFileTransferCompressor_Create();
+
+    PARCBuffer *empty = parcBuffer_Allocate(0);
+    assertNull(ccnxSimpleFileTransferCompressor_Decode(compressor, empty, 1200), "Expected an empty payload to be rejected");
+    parcBuffer_Release(&empty);
+
+    uint8_t unknownCodec[] = { 9, 0, 0, 0, 4, 'a', 'b', 'c', 'd' };
+    PARCBuffer *payload = parcBuffer_Wrap(unknownCodec, sizeof(unknownCodec), 0, sizeof(unknownCodec));
+    assertNull(ccnxSimpleFileTransferCompressor_Decode(compressor, payload, 1200), "Expected an unknown codec to be rejected");
+    parcBuffer_Release(&payload);
+
+    PARCBuffer *chunk = _createTextChunk(1200);
+    PARCBuffer *encoded = ccnxSimpleFileTransferCompressor_Encode(compressor, CCNxSimpleFileTransferCodec_None, chunk);
+    assertNull(ccnxSimpleFileTransferCompressor_Decode(compressor, encoded, 1000), "Expected a chunk that is too long to be rejected");
+    parcBuffer_Release(&encoded);
+
+    CCNxSimpleFileTransferCodec codecs[] = { CCNxSimpleFileTransferCodec_LZ4, CCNxSimpleFileTransferCodec_Zstd };
+    for (size_t i = 0; i < sizeof(codecs) / sizeof(codecs[0]); i++) {
+        if (ccnxSimpleFileTransferCompressor_IsAvailable(codecs[i])) {
+            encoded = ccnxSimpleFileTransferCompressor_Encode(compressor, codecs[i], chunk);
+            assertNull(ccnxSimpleFileTransferCompressor_Decode(compressor, encoded, 1000),
+                       "Expected a chunk that is too long to be rejected");
+
+            parcBuffer_SetLimit(encoded, parcBuffer_Limit(encoded) - 10);
+            assertNull(ccnxSimpleFileTransferCompressor_Decode(compressor, encoded, 1200),
+                       "Expected a truncated chunk to be rejected");
+            parcBuffer_Release(&encoded);
+        }
+    }
+
+    parcBuffer_Release(&chunk);
+    ccnxSimpleFileTransferCompressor_Release(&compressor);
+}
+
+LONGBOW_TEST_CASE(Global, selectCodecForFile)
+{
+    CCNxSimpleFileTransferCompressor *compressor = ccnxSimpleFileTransferCompressor_Create();
+    bool isAnyCodecAvailable = ccnxSimpleFileTransferCompressor_IsAvailable(CCNxSimpleFileTransferCodec_LZ4)
+                               || ccnxSimpleFileTransferCompressor_IsAvailable(CCNxSimpleFileTransferCodec_Zstd);
+
+    char *fileName = _createTestFile(_createTextChunk, 1200, 20);
+    int fd = open(fileName, O_RDONLY);
+    CCNxSimpleFileTransferCodec codec = ccnxSimpleFileTransferCompressor_SelectCodecForFile(compressor, fd, 20 * 1200, 1200);
+    if (isAnyCodecAvailable) {
+        assertTrue(codec != CCNxSimpleFileTransferCodec_None, "Expected a codec to be chosen for text");
+        assertTrue(ccnxSimpleFileTransferCompressor_IsAvailable(codec), "Expected an available codec to be chosen");
+    } else {
+        assertTrue(codec == CCNxSimpleFileTransferCodec_None, "Expected no codec without any codecs");
+    }
+    codec = ccnxSimpleFileTransferCompressor_SelectCodecForFile(compressor, fd, 0, 1200);
+    assertTrue(codec == CCNxSimpleFileTransferCodec_None, "Expected no codec for an empty file");
+    close(fd);
+    unlink(fileName);
+    parcMemory_Deallocate((void **) &fileName);
+
+    fileName = _createTestFile(_createRandomChunk, 1200, 20);
+    fd = open(fileName, O_RDONLY);
+    codec = ccnxSimpleFileTransferCompressor_SelectCodecForFile(compressor, fd, 20 * 1200, 1200);
+    assertTrue(codec == CCNxSimpleFileTransferCodec_None, "Expected no codec for random bytes");
+    close(fd);
+    unlink(fileName);
+    parcMemory_Deallocate((void **) &fileName);
+
+    ccnxSimpleFileTransferCompressor_Release(&compressor);
+}
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(ccnxSimpleFileTransfer_Compressor);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
@@ -0,0 +1,316 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../ccnxSimpleFileTransfer_EventLoop.c"
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+LONGBOW_TEST_RUNNER(ccnxSimpleFileTransfer_EventLoop)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(ccnxSimpleFileTransfer_EventLoop)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(ccnxSimpleFileTransfer_EventLoop)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, createRelease);
+    LONGBOW_RUN_TEST_CASE(Global, readable);
+    LONGBOW_RUN_TEST_CASE(Global, setEvents);
+    LONGBOW_RUN_TEST_CASE(Global, unwatchFromCallback);
+    LONGBOW_RUN_TEST_CASE(Global, hangup);
+    LONGBOW_RUN_TEST_CASE(Global, timer);
+    LONGBOW_RUN_TEST_CASE(Global, runUntilStopped);
+    LONGBOW_RUN_TEST_CASE(Global, pollFallback);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+typedef struct {
+    int numCalls;
+    unsigned int lastEvents;
+    int otherFileDescriptor;        // Unwatched by the callback, if not -1.
+} _TestCallbackState;
+
+static void
+_recordEvents(CCNxSimpleFileTransferEventLoop *eventLoop, int fileDescriptor, unsigned int events, void *context)
+{
+    _TestCallbackState *state = context;
+    state->numCalls++;
+    state->lastEvents = events;
+    if (state->otherFileDescriptor >= 0) {
+        ccnxSimpleFileTransferEventLoop_Unwatch(eventLoop, state->otherFileDescriptor);
+    }
+}
+
+static void
+_countTimer(CCNxSimpleFileTransferEventLoop *eventLoop, void *context)
+{
+    int *numCalls = context;
+    (*numCalls)++;
+}
+
+static void
+_stopAfterThree(CCNxSimpleFileTransferEventLoop *eventLoop, void *context)
+{
+    int *numCalls = context;
+    if (++(*numCalls) == 3) {
+        ccnxSimpleFileTransferEventLoop_Stop(eventLoop);
+    }
+}
+
+LONGBOW_TEST_CASE(Global, createRelease)
+{
+    CCNxSimpleFileTransferEventLoop *eventLoop = ccnxSimpleFileTransferEventLoop_Create();
+    assertNotNull(eventLoop, "Expected a new event loop");
+
+    CCNxSimpleFileTransferEventLoop *reference = ccnxSimpleFileTransferEventLoop_Acquire(eventLoop);
+    ccnxSimpleFileTransferEventLoop_Release(&reference);
+    assertNull(reference, "Expected Release to clear the pointer");
+
+    ccnxSimpleFileTransferEventLoop_Release(&eventLoop);
+}
+
+LONGBOW_TEST_CASE(Global, readable)
+{
+    int pipeFileDescriptors[2];
+    assertTrue(pipe(pipeFileDescriptors) == 0, "pipe() failed");
+
+    CCNxSimpleFileTransferEventLoop *eventLoop = ccnxSimpleFileTransferEventLoop_Create();
+    _TestCallbackState state = { .otherFileDescriptor = -1 };
+    assertTrue(ccnxSimpleFileTransferEventLoop_Watch(eventLoop, pipeFileDescriptors[0],
+                                                     CCNxSimpleFileTransferEventLoopEvent_Readable, _recordEvents, &state),
+               "Expected to watch the pipe");
+
+    assertTrue(ccnxSimpleFileTransferEventLoop_RunOnce(eventLoop, 0) == 0, "Expected nothing to read yet");
+    assertTrue(state.numCalls == 0, "Expected no calls, got %d", state.numCalls);
+
+    assertTrue(write(pipeFileDescriptors[1], "x", 1) == 1, "write() failed");
+    assertTrue(ccnxSimpleFileTransferEventLoop_RunOnce(eventLoop, 1000) == 1, "Expected one callback");
+    assertTrue(state.numCalls == 1, "Expected 1 call, got %d", state.numCalls);
+    assertTrue(state.lastEvents == CCNxSimpleFileTransferEventLoopEvent_Readable, "Expected Readable, got %u", state.lastEvents);
+
+    ccnxSimpleFileTransferEventLoop_Release(&eventLoop);
+    close(pipeFileDescriptors[0]);
+    close(pipeFileDescriptors[1]);
+}
+
+LONGBOW_TEST_CASE(Global, setEvents)
+{
+    int pipeFileDescriptors[2];
+    assertTrue(pipe(pipeFileDescriptors) == 0, "pipe() failed");
+
+    CCNxSimpleFileTransferEventLoop *eventLoop = ccnxSimpleFileTransferEventLoop_Create();
+    _TestCallbackState state = { .otherFileDescriptor = -1 };
+    ccnxSimpleFileTransferEventLoop_Watch(eventLoop, pipeFileDescriptors[1], 0, _recordEvents, &state);
+
+    ccnxSimpleFileTransferEventLoop_RunOnce(eventLoop, 0);
+    assertTrue(state.numCalls == 0, "Expected no calls when not watching for any events, got %d", state.numCalls);
+
+    assertTrue(ccnxSimpleFileTransferEventLoop_SetEvents(eventLoop, pipeFileDescriptors[1],
+                                                         CCNxSimpleFileTransferEventLoopEvent_Writable),
+               "Expected to change the events");
+    ccnxSimpleFileTransferEventLoop_RunOnce(eventLoop, 1000);
+    assertTrue(state.numCalls == 1, "Expected 1 call, got %d", state.numCalls);
+    assertTrue(state.lastEvents == CCNxSimpleFileTransferEventLoopEvent_Writable, "Expected Writable, got %u", state.lastEvents);
+
+    assertFalse(ccnxSimpleFileTransferEventLoop_SetEvents(eventLoop, pipeFileDescriptors[0], 0),
+                "Expected SetEvents to fail for a file descriptor that isn't watched");
+
+    ccnxSimpleFileTransferEventLoop_Release(&eventLoop);
+    close(pipeFileDescriptors[0]);
+    close(pipeFileDescriptors[1]);
+}
+
+LONGBOW_TEST_CASE(Global, unwatchFromCallback)
+{
+    int first[2];
+    int second[2];
+    assertTrue(pipe(first) == 0 && pipe(second) == 0, "pipe() failed");
+
+    CCNxSimpleFileTransferEventLoop *eventLoop = ccnxSimpleFileTransferEventLoop_Create();
+
+    // Whichever callback runs first unwatches the other, so only one of them may be called.
+    _TestCallbackState firstState = { .otherFileDescriptor = second[0] };
+    _TestCallbackState secondState = { .otherFileDescriptor = first[0] };
+    ccnxSimpleFileTransferEventLoop_Watch(eventLoop, first[0], CCNxSimpleFileTransferEventLoopEvent_Readable, _recordEvents, &firstState);
+    ccnxSimpleFileTransferEventLoop_Watch(eventLoop, second[0], CCNxSimpleFileTransferEventLoopEvent_Readable, _recordEvents, &secondState);
+
+    assertTrue(write(first[1], "x", 1) == 1 && write(second[1], "x", 1) == 1, "write() failed");
+    ccnxSimpleFileTransferEventLoop_RunOnce(eventLoop, 1000);
+    assertTrue(firstState.numCalls + secondState.numCalls == 1, "Expected exactly one callback, got %d",
+               firstState.numCalls + secondState.numCalls);
+    assertTrue(eventLoop->numWatchers == 1, "Expected the unwatched watcher to be removed, have %zu", eventLoop->numWatchers);
+
+    ccnxSimpleFileTransferEventLoop_Release(&eventLoop);
+    close(first[0]);
+    close(first[1]);
+    close(second[0]);
+    close(second[1]);
+}
+
+LONGBOW_TEST_CASE(Global, hangup)
+{
+    int pipeFileDescriptors[2];
+    assertTrue(pipe(pipeFileDescriptors) == 0, "pipe() failed");
+
+    CCNxSimpleFileTransferEventLoop *eventLoop = ccnxSimpleFileTransferEventLoop_Create();
+    _TestCallbackState state = { .otherFileDescriptor = -1 };
+    ccnxSimpleFileTransferEventLoop_Watch(eventLoop, pipeFileDescriptors[0], 0, _recordEvents, &state);
+
+    close(pipeFileDescriptors[1]);
+    ccnxSimpleFileTransferEventLoop_RunOnce(eventLoop, 1000);
+    assertTrue(state.numCalls == 1, "Expected the hang-up to be reported, got %d calls", state.numCalls);
+    assertTrue(state.lastEvents & CCNxSimpleFileTransferEventLoopEvent_Error, "Expected Error, got %u", state.lastEvents);
+
+    ccnxSimpleFileTransferEventLoop_Release(&eventLoop);
+    close(pipeFileDescriptors[0]);
+}
+
+LONGBOW_TEST_CASE(Global, timer)
+{
+    CCNxSimpleFileTransferEventLoop *eventLoop = ccnxSimpleFileTransferEventLoop_Create();
+    int numCalls = 0;
+    ccnxSimpleFileTransferEventLoop_AddTimer(eventLoop, 20, _countTimer, &numCalls);
+
+    assertTrue(ccnxSimpleFileTransferEventLoop_RunOnce(eventLoop, 0) == 0, "Expected the timer not to be due yet");
+
+    // Waiting indefinitely must still return when the timer is due.
+    assertTrue(ccnxSimpleFileTransferEventLoop_RunOnce(eventLoop, -1) == 1, "Expected the timer to be called");
+    assertTrue(numCalls == 1, "Expected 1 call, got %d", numCalls);
+
+    ccnxSimpleFileTransferEventLoop_Release(&eventLoop);
+}
+
+LONGBOW_TEST_CASE(Global, runUntilStopped)
+{
+    CCNxSimpleFileTransferEventLoop *eventLoop = ccnxSimpleFileTransferEventLoop_Create();
+    int numCalls = 0;
+    ccnxSimpleFileTransferEventLoop_AddTimer(eventLoop, 1, _stopAfterThree, &numCalls);
+
+    ccnxSimpleFileTransferEventLoop_Run(eventLoop);
+    assertTrue(numCalls == 3, "Expected Run to return after the third call, got %d", numCalls);
+
+    ccnxSimpleFileTransferEventLoop_Release(&eventLoop);
+}
+
+LONGBOW_TEST_CASE(Global, pollFallback)
+{
+    int pipeFileDescriptors[2];
+    assertTrue(pipe(pipeFileDescriptors) == 0, "pipe() failed");
+
+    // Behave as we do where there is no epoll.
+    CCNxSimpleFileTransferEventLoop *eventLoop = ccnxSimpleFileTransferEventLoop_Create();
+    if (eventLoop->epollFileDescriptor >= 0) {
+        close(eventLoop->epollFileDescriptor);
+        eventLoop->epollFileDescriptor = -1;
+    }
+
+    _TestCallbackState state = { .otherFileDescriptor = -1 };
+    ccnxSimpleFileTransferEventLoop_Watch(eventLoop, pipeFileDescriptors[0], CCNxSimpleFileTransferEventLoopEvent_Readable,
+                                          _recordEvents, &state);
+
+    assertTrue(write(pipeFileDescriptors[1], "x", 1) == 1, "write() failed");
+    ccnxSimpleFileTransferEventLoop_RunOnce(eventLoop, 1000);
+    assertTrue(state.numCalls == 1, "Expected 1 call, got %d", state.numCalls);
+    assertTrue(state.lastEvents == CCNxSimpleFileTransferEventLoopEvent_Readable, "Expected Readable, got %u", state.lastEvents);
+
+    ccnxSimpleFileTransferEventLoop_Release(&eventLoop);
+    close(pipeFileDescriptors[0]);
+    close(pipeFileDescriptors[1]);
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(ccnxSimpleFileTransfer_EventLoop);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../ccnxSimpleFileTransfer_FairQueue.c"
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <unistd.h>
+
+LONGBOW_TEST_RUNNER(ccnxSimpleFileTransfer_FairQueue)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(ccnxSimpleFileTransfer_FairQueue)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(ccnxSimpleFileTransfer_FairQueue)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, createRelease);
+    LONGBOW_RUN_TEST_CASE(Global, listNotBehindFetch);
+    LONGBOW_RUN_TEST_CASE(Global, deficitRoundRobin);
+    LONGBOW_RUN_TEST_CASE(Global, tokenBucket);
+    LONGBOW_RUN_TEST_CASE(Global, dropFromLongest);
+    LONGBOW_RUN_TEST_CASE(Global, manyClasses);
+    LONGBOW_RUN_TEST_CASE(Global, priorities);
+    LONGBOW_RUN_TEST_CASE(Global, starvation);
+    LONGBOW_RUN_TEST_CASE(Global, dropLowestPriority);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+static CCNxInterest *
+_createInterest(const char *uri)
+{
+    CCNxName *name = ccnxName_CreateFromCString(uri);
+    CCNxInterest *result = ccnxInterest_CreateSimple(name);
+    ccnxName_Release(&name);
+    return result;
+}
+
+static void
+_enqueue(CCNxSimpleFileTransferFairQueue *queue, const char *className, unsigned int priority, int count)
+{
+    CCNxInterest *interest = _createInterest("ccnx:/test/fairQueue");
+    for (int i = 0; i < count; i++) {
+        ccnxSimpleFileTransferFairQueue_Enqueue(queue, className, priority, interest, 0);
+    }
+    ccnxInterest_Release(&interest);
+}
+
+LONGBOW_TEST_CASE(Global, createRelease)
+{
+    CCNxSimpleFileTransferFairQueue *queue = ccnxSimpleFileTransferFairQueue_Create(16, 1, 0, 1200, 0, 0);
+    assertNotNull(queue, "Expected a non-NULL queue");
+    assertTrue(ccnxSimpleFileTransferFairQueue_GetCapacity(queue) == 16, "Expected a capacity of 16");
+    assertTrue(ccnxSimpleFileTransferFairQueue_GetSize(queue) == 0, "Expected an empty queue");
+
+    // Interests still queued are released with the queue.
+    _enqueue(queue, "fetch/a", 0, 2);
+    assertTrue(ccnxSimpleFileTransferFairQueue_GetSize(queue) == 2, "Expected 2 Interests queued");
+
+    CCNxSimpleFileTransferFairQueue *reference = ccnxSimpleFileTransferFairQueue_Acquire(queue);
+    ccnxSimpleFileTransferFairQueue_Release(&queue);
+    assertNull(queue, "Expected Release to NULL the pointer");
+    ccnxSimpleFileTransferFairQueue_Release(&reference);
+}
+
+LONGBOW_TEST_CASE(Global, listNotBehindFetch)
+{
+    CCNxSimpleFileTransferFairQueue *queue = ccnxSimpleFileTransferFairQueue_Create(256, 1, 0, 1200, 0, 0);
+
+    _enqueue(queue, "fetch/big", 0, 200);
+    _enqueue(queue, "list", 0, 1);
+
+    // The 'list' Interest waits only for the turn of the class already being answered.
+    int position = 0;
+    size_t classNumber;
+    CCNxInterest *interest;
+    while ((interest = ccnxSimpleFileTransferFairQueue_Dequeue(queue, 0, &classNumber, NULL)) != NULL) {
+        position++;
+        bool wasList = ccnxSimpleFileTransferFairQueue_GetClassSize(queue, "list") == 0;
+        ccnxSimpleFileTransferFairQueue_Charge(queue, classNumber, 1200);
+        ccnxInterest_Release(&interest);
+        if (wasList) {
+            break;
+        }
+    }
+    assertTrue(position == 2, "Expected the 'list' Interest to be answered second, not %d", position);
+    assertTrue(ccnxSimpleFileTransferFairQueue_GetSize(queue) == 199, "Expected 199 Interests left");
+
+    ccnxSimpleFileTransferFairQueue_Release(&queue);
+}
+
+LONGBOW_TEST_CASE(Global, deficitRoundRobin)
+{
+    CCNxSimpleFileTransferFairQueue *queue = ccnxSimpleFileTransferFairQueue_Create(256, 1, 0, 1000, 0, 0);
+
+    // Each class gets the same number of bytes, however large its responses.
+    _enqueue(queue, "large", 0, 50);
+    _enqueue(queue, "small", 0, 50);
+
+    int numLarge = 0;
+    int numSmall = 0;
+    for (int i = 0; i < 22; i++) {
+        size_t classNumber;
+        CCNxInterest *interest = ccnxSimpleFileTransferFairQueue_Dequeue(queue, 0, &classNumber, NULL);
+        assertNotNull(interest, "Expected an Interest");
+        bool isLarge = ccnxSimpleFileTransferFairQueue_GetClassSize(queue, "large") == (size_t) (49 - numLarge);
+        if (isLarge) {
+            numLarge++;
+        } else {
+            numSmall++;
+        }
+        ccnxSimpleFileTransferFairQueue_Charge(queue, classNumber, isLarge ? 1000 : 100);
+        ccnxInterest_Release(&interest);
+    }
+    assertTrue(numLarge == 2 && numSmall == 20, "Expected 2 large and 20 small, got %d and %d", numLarge, numSmall);
+
+    ccnxSimpleFileTransferFairQueue_Release(&queue);
+}
+
+LONGBOW_TEST_CASE(Global, tokenBucket)
+{
+    // 1000 bytes per second, at most 1000 at once.
+    CCNxSimpleFileTransferFairQueue *queue = ccnxSimpleFileTransferFairQueue_Create(16, 1, 0, 1000, 1000, 1000);
+
+    _enqueue(queue, "fetch/a", 0, 4);
+
+    size_t classNumber;
+    CCNxInterest *interest = ccnxSimpleFileTransferFairQueue_Dequeue(queue, 0, &classNumber, NULL);
+    assertNotNull(interest, "Expected the first Interest within the burst");
+    ccnxSimpleFileTransferFairQueue_Charge(queue, classNumber, 1000);
+    ccnxInterest_Release(&interest);
+
+    assertNull(ccnxSimpleFileTransferFairQueue_Dequeue(queue, 0, &classNumber, NULL), "Expected the class to be over its rate");
+
+    // Another class isn't held up by it.
+    _enqueue(queue, "list", 0, 1);
+    interest = ccnxSimpleFileTransferFairQueue_Dequeue(queue, 0, &classNumber, NULL);
+    assertNotNull(interest, "Expected the other class's Interest");
+    assertTrue(ccnxSimpleFileTransferFairQueue_GetClassSize(queue, "list") == 0, "Expected the 'list' Interest");
+    ccnxSimpleFileTransferFairQueue_Charge(queue, classNumber, 100);
+    ccnxInterest_Release(&interest);
+
+    interest = ccnxSimpleFileTransferFairQueue_Dequeue(queue, 1000000, &classNumber, NULL);
+    assertNotNull(interest, "Expected the class to have refilled after a second");
+    ccnxInterest_Release(&interest);
+
+    ccnxSimpleFileTransferFairQueue_Release(&queue);
+}
+
+LONGBOW_TEST_CASE(Global, dropFromLongest)
+{
+    CCNxSimpleFileTransferFairQueue *queue = ccnxSimpleFileTransferFairQueue_Create(4, 1, 0, 1200, 0, 0);
+
+    _enqueue(queue, "fetch/a", 0, 3);
+    CCNxInterest *interest = _createInterest("ccnx:/test/fairQueue");
+    assertFalse(ccnxSimpleFileTransferFairQueue_Enqueue(queue, "list", 0, interest, 0), "Expected room for a 4th Interest");
+    assertTrue(ccnxSimpleFileTransferFairQueue_Enqueue(queue, "stat/b", 0, interest, 0), "Expected an Interest to be dropped");
+    ccnxInterest_Release(&interest);
+
+    assertTrue(ccnxSimpleFileTransferFairQueue_GetSize(queue) == 4, "Expected a full queue");
+    assertTrue(ccnxSimpleFileTransferFairQueue_GetClassSize(queue, "fetch/a") == 2, "Expected the longest class to lose one");
+    assertTrue(ccnxSimpleFileTransferFairQueue_GetClassSize(queue, "list") == 1, "Expected the 'list' Interest to stay");
+    assertTrue(ccnxSimpleFileTransferFairQueue_GetClassSize(queue, "stat/b") == 1, "Expected the new Interest to be queued");
+
+    ccnxSimpleFileTransferFairQueue_Release(&queue);
+}
+
+LONGBOW_TEST_CASE(Global, manyClasses)
+{
+    // More classes over time than the queue keeps, so idle classes are reused.
+    CCNxSimpleFileTransferFairQueue *queue = ccnxSimpleFileTransferFairQueue_Create(8, 1, 0, 1200, 0, 0);
+
+    char className[32];
+    for (int i = 0; i < 1000; i++) {
+        sprintf(className, "fetch/%d", i);
+        _enqueue(queue, className, 0, 1 + i % 3);
+
+        size_t classNumber;
+        CCNxInterest *interest = ccnxSimpleFileTransferFairQueue_Dequeue(queue, 0, &classNumber, NULL);
+        assertNotNull(interest, "Expected an Interest");
+        ccnxSimpleFileTransferFairQueue_Charge(queue, classNumber, 1200);
+        ccnxInterest_Release(&interest);
+    }
+    // Interests arrive faster than they're taken, so the queue is kept full by dropping them.
+    assertTrue(ccnxSimpleFileTransferFairQueue_GetSize(queue) == 7, "Expected a full queue less the last taken, got %zu",
+               ccnxSimpleFileTransferFairQueue_GetSize(queue));
+
+    ccnxSimpleFileTransferFairQueue_Release(&queue);
+}
+
+/**
+ * Take the next Interest, charge it a chunk, and return its class's priority.
+ */
+static unsigned int
+_dequeuePriority(CCNxSimpleFileTransferFairQueue *queue, uint64_t nowMicros, uint64_t *waitMicros)
+{
+    size_t classNumber;
+    CCNxInterest *interest = ccnxSimpleFileTransferFairQueue_Dequeue(queue, nowMicros, &classNumber, waitMicros);
+    assertNotNull(interest, "Expected an Interest");
+    ccnxSimpleFileTransferFairQueue_Charge(queue, classNumber, 1200);
+    ccnxInterest_Release(&interest);
+    return ccnxSimpleFileTransferFairQueue_GetClassPriority(queue, classNumber);
+}
+
+LONGBOW_TEST_CASE(Global, priorities)
+{
+    CCNxSimpleFileTransferFairQueue *queue = ccnxSimpleFileTransferFairQueue_Create(256, 2, 0, 1200, 0, 0);
+
+    _enqueue(queue, "fetch/big", 1, 100);
+    CCNxInterest *interest = _createInterest("ccnx:/test/fairQueue");
+    ccnxSimpleFileTransferFairQueue_Enqueue(queue, "list", 0, interest, 100);
+    ccnxSimpleFileTransferFairQueue_Enqueue(queue, "stat/big", 0, interest, 200);
+    ccnxInterest_Release(&interest);
+
+    // The metadata goes first, although it was queued last.
+    uint64_t waitMicros = 0;
+    assertTrue(_dequeuePriority(queue, 350, &waitMicros) == 0, "Expected the 'list' Interest first");
+    assertTrue(waitMicros == 250, "Expected it to have waited 250 us, not %" PRIu64, waitMicros);
+    assertTrue(_dequeuePriority(queue, 350, &waitMicros) == 0, "Expected the 'stat' Interest second");
+    assertTrue(waitMicros == 150, "Expected it to have waited 150 us, not %" PRIu64, waitMicros);
+    assertTrue(_dequeuePriority(queue, 350, &waitMicros) == 1, "Expected the fetch Interests last");
+    assertTrue(waitMicros == 350, "Expected it to have waited 350 us, not %" PRIu64, waitMicros);
+
+    ccnxSimpleFileTransferFairQueue_Release(&queue);
+}
+
+LONGBOW_TEST_CASE(Global, starvation)
+{
+    // A fetch Interest is answered after at most 4 metadata Interests in a row.
+    CCNxSimpleFileTransferFairQueue *queue = ccnxSimpleFileTransferFairQueue_Create(256, 2, 4, 1200, 0, 0);
+
+    _enqueue(queue, "fetch/big", 1, 20);
+    _enqueue(queue, "list", 0, 20);
+
+    for (int i = 1; i <= 20; i++) {
+        unsigned int expected = (i % 5 == 0) ? 1 : 0;
+        assertTrue(_dequeuePriority(queue, 0, NULL) == expected, "Expected priority %u for Interest %d", expected, i);
+    }
+
+    ccnxSimpleFileTransferFairQueue_Release(&queue);
+}
+
+LONGBOW_TEST_CASE(Global, dropLowestPriority)
+{
+    CCNxSimpleFileTransferFairQueue *queue = ccnxSimpleFileTransferFairQueue_Create(4, 2, 0, 1200, 0, 0);
+
+    // The metadata class is the longest, but the fetch class loses an Interest.
+    _enqueue(queue, "list", 0, 3);
+    _enqueue(queue, "fetch/big", 1, 1);
+    _enqueue(queue, "stat/big", 0, 1);
+
+    assertTrue(ccnxSimpleFileTransferFairQueue_GetClassSize(queue, "list") == 3, "Expected the 'list' Interests to stay");
+    assertTrue(ccnxSimpleFileTransferFairQueue_GetClassSize(queue, "fetch/big") == 0, "Expected the fetch Interest to be dropped");
+    assertTrue(ccnxSimpleFileTransferFairQueue_GetClassSize(queue, "stat/big") == 1, "Expected the 'stat' Interest to be queued");
+
+    ccnxSimpleFileTransferFairQueue_Release(&queue);
+}
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(ccnxSimpleFileTransfer_FairQueue);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../ccnxSimpleFileTransfer_FetchWindow.c"
+#include "../ccnxSimpleFileTransfer_PendingInterestTable.c"
+#include "../ccnxSimpleFileTransfer_TimerWheel.c"
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+#include <inttypes.h>
+#include <unistd.h>
+
+LONGBOW_TEST_RUNNER(ccnxSimpleFileTransfer_FetchWindow)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(ccnxSimpleFileTransfer_FetchWindow)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(ccnxSimpleFileTransfer_FetchWindow)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, createRelease);
+    LONGBOW_RUN_TEST_CASE(Global, window);
+    LONGBOW_RUN_TEST_CASE(Global, retransmit);
+    LONGBOW_RUN_TEST_CASE(Global, roundTripTime);
+    LONGBOW_RUN_TEST_CASE(Global, skip);
+    LONGBOW_RUN_TEST_CASE(Global, unusableChunkIsAskedForAgain);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+/**
+ * Take every chunk the window has to send now, returning how many there were.
+ */
+static size_t
+_takeAll(CCNxSimpleFileTransferFetchWindow *window, uint64_t nowMicros, uint64_t *chunkNumbers, size_t maxChunks)
+{
+    size_t result = 0;
+    uint64_t chunkNumber;
+    while (ccnxSimpleFileTransferFetchWindow_TakeNextToSend(window, nowMicros, &chunkNumber)) {
+        if (result < maxChunks) {
+            chunkNumbers[result] = chunkNumber;
+        }
+        result++;
+    }
+    return result;
+}
+
+LONGBOW_TEST_CASE(Global, createRelease)
+{
+    CCNxSimpleFileTransferFetchWindow *window = ccnxSimpleFileTransferFetchWindow_Create(8, 8, 100000, 3, 0);
+    CCNxSimpleFileTransferFetchWindow *ref = ccnxSimpleFileTransferFetchWindow_Acquire(window);
+
+    assertFalse(ccnxSimpleFileTransferFetchWindow_IsNumChunksKnown(window), "Expected the number of chunks to be unknown");
+    assertFalse(ccnxSimpleFileTransferFetchWindow_IsComplete(window), "Expected the fetch not to be complete");
+    assertTrue(ccnxSimpleFileTransferFetchWindow_GetRtoMicros(window) == 100000, "Expected the initial RTO");
+    assertTrue(ccnxSimpleFileTransferFetchWindow_GetSmoothedRttMicros(window) == 0, "Expected no round trip time yet");
+
+    ccnxSimpleFileTransferFetchWindow_Release(&window);
+    ccnxSimpleFileTransferFetchWindow_Release(&ref);
+}
+
+LONGBOW_TEST_CASE(Global, window)
+{
+    CCNxSimpleFileTransferFetchWindow *window = ccnxSimpleFileTransferFetchWindow_Create(4, 6, 100000, 3, 0);
+    uint64_t sent[8];
+
+    // Only chunk 0 is asked for until the size of the file is known.
+    assertTrue(_takeAll(window, 0, sent, 8) == 1 && sent[0] == 0, "Expected only chunk 0");
+    assertTrue(ccnxSimpleFileTransferFetchWindow_Receive(window, 0, 1000), "Expected chunk 0 to be waited for");
+    assertFalse(ccnxSimpleFileTransferFetchWindow_Receive(window, 0, 1000), "Expected a duplicate to be ignored");
+    ccnxSimpleFileTransferFetchWindow_SetNumChunks(window, 10);
+
+    assertTrue(_takeAll(window, 1000, sent, 8) == 4, "Expected a window of 4 chunks");
+    assertTrue(sent[0] == 1 && sent[3] == 4, "Expected chunks 1 to 4");
+    assertTrue(ccnxSimpleFileTransferFetchWindow_GetNumOutstanding(window) == 4, "Expected 4 outstanding chunks");
+
+    // Later chunks arriving make room while chunk 1 is missing, but only up to 6 chunks beyond it.
+    assertTrue(ccnxSimpleFileTransferFetchWindow_Receive(window, 3, 2000), "Expected chunk 3 to be waited for");
+    assertTrue(_takeAll(window, 2000, sent, 8) == 1 && sent[0] == 5, "Expected chunk 5");
+    assertTrue(ccnxSimpleFileTransferFetchWindow_Receive(window, 4, 2000), "Expected chunk 4 to be waited for");
+    assertTrue(ccnxSimpleFileTransferFetchWindow_Receive(window, 5, 2000), "Expected chunk 5 to be waited for");
+    assertTrue(_takeAll(window, 2000, sent, 8) == 1 && sent[0] == 6, "Expected just chunk 6, as chunk 1 is missing");
+    assertFalse(ccnxSimpleFileTransferFetchWindow_Receive(window, 7, 2000), "Expected a chunk not asked for to be ignored");
+
+    assertTrue(ccnxSimpleFileTransferFetchWindow_Receive(window, 1, 2000), "Expected chunk 1 to be waited for");
+    assertTrue(_takeAll(window, 2000, sent, 8) == 1 && sent[0] == 7, "Expected just chunk 7, as chunk 2 is missing");
+
+    for (uint64_t chunk = 2; chunk < 10; chunk++) {
+        ccnxSimpleFileTransferFetchWindow_Receive(window, chunk, 3000);
+        _takeAll(window, 3000, sent, 8);
+    }
+    assertTrue(ccnxSimpleFileTransferFetchWindow_IsComplete(window), "Expected the fetch to be complete");
+    assertTrue(ccnxSimpleFileTransferFetchWindow_GetNumOutstanding(window) == 0, "Expected no outstanding chunks");
+    assertTrue(ccnxSimpleFileTransferFetchWindow_GetNextTimeoutMicros(window) == UINT64_MAX, "Expected no timeout");
+    assertTrue(ccnxSimpleFileTransferFetchWindow_GetNumRetransmissions(window) == 0, "Expected no retransmissions");
+
+    ccnxSimpleFileTransferFetchWindow_Release(&window);
+}
+
+LONGBOW_TEST_CASE(Global, retransmit)
+{
+    CCNxSimpleFileTransferFetchWindow *window = ccnxSimpleFileTransferFetchWindow_Create(4, 4, 100000, 3, 0);
+    uint64_t sent[8];
+
+    _takeAll(window, 0, sent, 8);
+    ccnxSimpleFileTransferFetchWindow_Receive(window, 0, 0);
+    ccnxSimpleFileTransferFetchWindow_SetNumChunks(window, 3);
+    uint64_t rtoMicros = ccnxSimpleFileTransferFetchWindow_GetRtoMicros(window);
+    assertTrue(_takeAll(window, 0, sent, 8) == 2, "Expected chunks 1 and 2");
+    ccnxSimpleFileTransferFetchWindow_Receive(window, 2, 0);
+
+    // Only the missing chunk is asked for again, once its timeout has passed, and then after twice as long.
+    assertTrue(ccnxSimpleFileTransferFetchWindow_GetNextTimeoutMicros(window) >= rtoMicros, "Expected a timeout after the RTO");
+    assertTrue(_takeAll(window, rtoMicros - 1, sent, 8) == 0, "Expected nothing to send before the timeout");
+    assertTrue(_takeAll(window, rtoMicros + 1000, sent, 8) == 1 && sent[0] == 1, "Expected chunk 1 again");
+    assertTrue(_takeAll(window, rtoMicros + 1000 + rtoMicros + 1000, sent, 8) == 0, "Expected the timeout to have doubled");
+    assertTrue(_takeAll(window, rtoMicros + 1000 + 2 * rtoMicros + 1000, sent, 8) == 1, "Expected chunk 1 again");
+    assertTrue(ccnxSimpleFileTransferFetchWindow_GetNumRetransmissions(window) == 2, "Expected 2 retransmissions");
+
+    // After the third Interest times out, the fetch fails.
+    assertFalse(ccnxSimpleFileTransferFetchWindow_HasFailed(window), "Expected the fetch not to have failed yet");
+    assertTrue(_takeAll(window, 60 * 1000 * 1000, sent, 8) == 0, "Expected nothing more to send");
+    assertTrue(ccnxSimpleFileTransferFetchWindow_HasFailed(window), "Expected the fetch to have failed");
+
+    ccnxSimpleFileTransferFetchWindow_Release(&window);
+}
+
+LONGBOW_TEST_CASE(Global, roundTripTime)
+{
+    CCNxSimpleFileTransferFetchWindow *window = ccnxSimpleFileTransferFetchWindow_Create(64, 64, 1000000, 3, 0);
+    uint64_t sent[64];
+
+    _takeAll(window, 0, sent, 64);
+    ccnxSimpleFileTransferFetchWindow_Receive(window, 0, 40000);
+    assertTrue(ccnxSimpleFileTransferFetchWindow_GetSmoothedRttMicros(window) == 40000, "Expected the first round trip time");
+    assertTrue(ccnxSimpleFileTransferFetchWindow_GetRtoMicros(window) == 40000 + 4 * 20000, "Expected SRTT + 4 * RTTVAR");
+
+    // A steady round trip time brings the RTO down towards it.
+    ccnxSimpleFileTransferFetchWindow_SetNumChunks(window, 1000);
+    uint64_t now = 40000;
+    for (int i = 0; i < 10; i++) {
+        size_t numSent = _takeAll(window, now, sent, 64);
+        now += 40000;
+        for (size_t j = 0; j < numSent; j++) {
+            ccnxSimpleFileTransferFetchWindow_Receive(window, sent[j], now);
+        }
+    }
+    uint64_t rtoMicros = ccnxSimpleFileTransferFetchWindow_GetRtoMicros(window);
+    assertTrue(rtoMicros >= 40000 && rtoMicros < 45000, "Expected an RTO near 40ms, got %" PRIu64, rtoMicros);
+
+    // A chunk that was asked for twice doesn't change the estimate (Karn's algorithm).
+    uint64_t chunk;
+    assertTrue(_takeAll(window, now, sent, 64) > 0, "Expected chunks to send");
+    now += 10 * rtoMicros;
+    assertTrue(ccnxSimpleFileTransferFetchWindow_TakeNextToSend(window, now, &chunk), "Expected a retransmission");
+    ccnxSimpleFileTransferFetchWindow_Receive(window, chunk, now + 1000000);
+    assertTrue(ccnxSimpleFileTransferFetchWindow_GetRtoMicros(window) == rtoMicros, "Expected the RTO not to change");
+
+    ccnxSimpleFileTransferFetchWindow_Release(&window);
+}
+
+LONGBOW_TEST_CASE(Global, skip)
+{
+    CCNxSimpleFileTransferFetchWindow *window = ccnxSimpleFileTransferFetchWindow_Create(2, 2, 100000, 3, 0);
+    ccnxSimpleFileTransferFetchWindow_SetNumChunks(window, 6);
+
+    // Ask for the odd chunks only.
+    uint64_t chunk;
+    uint64_t numSent = 0;
+    while (ccnxSimpleFileTransferFetchWindow_TakeNextToSend(window, 0, &chunk)) {
+        if (chunk % 2 == 0) {
+            ccnxSimpleFileTransferFetchWindow_Skip(window, chunk);
+        } else {
+            numSent++;
+        }
+    }
+    assertTrue(numSent == 1, "Expected only chunk 1 to fit in the window");
+
+    for (uint64_t received = 1; !ccnxSimpleFileTransferFetchWindow_IsComplete(window); received += 2) {
+        assertTrue(ccnxSimpleFileTransferFetchWindow_Receive(window, received, 1000), "Expected chunk %" PRIu64, received);
+        while (ccnxSimpleFileTransferFetchWindow_TakeNextToSend(window, 1000, &chunk)) {
+            if (chunk % 2 == 0) {
+                ccnxSimpleFileTransferFetchWindow_Skip(window, chunk);
+            }
+        }
+    }
+    assertTrue(ccnxSimpleFileTransferFetchWindow_GetNumOutstanding(window) == 0, "Expected no outstanding chunks");
+
+    ccnxSimpleFileTransferFetchWindow_Release(&window);
+}
+
+LONGBOW_TEST_CASE(Global, unusableChunkIsAskedForAgain)
+{
+    CCNxSimpleFileTransferFetchWindow *window = ccnxSimpleFileTransferFetchWindow_Create(1, 1, 100000, 3, 0);
+    ccnxSimpleFileTransferFetchWindow_SetNumChunks(window, 1);
+
+    uint64_t chunk;
+    assertTrue(ccnxSimpleFileTransferFetchWindow_TakeNextToSend(window, 0, &chunk), "Expected chunk 0 to be sent");
+    assertTrue(ccnxSimpleFileTransferFetchWindow_IsOutstanding(window, 0), "Expected chunk 0 to be outstanding");
+    assertFalse(ccnxSimpleFileTransferFetchWindow_IsOutstanding(window, 1), "Did not expect chunk 1 to be outstanding");
+
+    // Chunk 0 arrives, but can't be used, so it isn't received, and is sent again when it times out.
+    assertFalse(ccnxSimpleFileTransferFetchWindow_TakeNextToSend(window, 1000, &chunk), "Expected nothing to send yet");
+    assertTrue(ccnxSimpleFileTransferFetchWindow_TakeNextToSend(window, 100000, &chunk) && chunk == 0,
+               "Expected chunk 0 to be sent again");
+
+    assertTrue(ccnxSimpleFileTransferFetchWindow_Receive(window, 0, 101000), "Expected chunk 0");
+    assertFalse(ccnxSimpleFileTransferFetchWindow_IsOutstanding(window, 0), "Did not expect chunk 0 to be outstanding");
+    assertTrue(ccnxSimpleFileTransferFetchWindow_IsComplete(window), "Expected the fetch to be complete");
+
+    ccnxSimpleFileTransferFetchWindow_Release(&window);
+}
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(ccnxSimpleFileTransfer_FetchWindow);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
@@ -90,6 +90,11 @@ LONGBOW_TEST_FIXTURE(Global)
     LONGBOW_RUN_TEST_CASE(Global, getFileChunk);
     LONGBOW_RUN_TEST_CASE(Global, isFileAvailable);
     LONGBOW_RUN_TEST_CASE(Global, createDirectoryListing);
+    LONGBOW_RUN_TEST_CASE(Global, getFileVersion);
+    LONGBOW_RUN_TEST_CASE(Global, getVersionedFileChunk);
+    LONGBOW_RUN_TEST_CASE(Global, openVersionedFile);
+    LONGBOW_RUN_TEST_CASE(Global, readFileChunkIntoBuffer);
+    LONGBOW_RUN_TEST_CASE(Global, isHole);
 }
 
 LONGBOW_TEST_FIXTURE_SETUP(Global)
@@ -212,6 +217,155 @@ LONGBOW_TEST_CASE(Global, createDirectoryListing)
     parcBuffer_Release(&listing);
 }
 
+LONGBOW_TEST_CASE(Global, getFileVersion)
+{
+    char *fileName = _createTempFileName("/tmp/ccnxSimpleFileTransfer_testData-getFileVersion.XXXXXXXX");
+    size_t fileSize = 0;
+    uint64_t version = 0;
+
+    assertFalse(ccnxSimpleFileTransferFileIO_GetFileVersion(fileName, &fileSize, &version),
+                "Did not expect a version for a missing file.");
+
+    FILE *fp = _createTestFile(fileName, 50, 11);
+    fclose(fp);
+
+    assertTrue(ccnxSimpleFileTransferFileIO_GetFileVersion(fileName, &fileSize, &version), "Expected the file's version.");
+    assertTrue(fileSize == 550, "Expected a size of 550, got %zu", fileSize);
+    assertTrue(version != 0, "Expected a version other than 0");
+
+    uint64_t sameVersion = 0;
+    ccnxSimpleFileTransferFileIO_GetFileVersion(fileName, &fileSize, &sameVersion);
+    assertTrue(sameVersion == version, "Expected the version of an unchanged file to stay the same");
+
+    fp = fopen(fileName, "a");
+    fputc('z', fp);
+    fclose(fp);
+
+    uint64_t newVersion = 0;
+    ccnxSimpleFileTransferFileIO_GetFileVersion(fileName, &fileSize, &newVersion);
+    assertTrue(newVersion != version, "Expected a new version once the file changed");
+    assertTrue(fileSize == 551, "Expected a size of 551, got %zu", fileSize);
+
+    assertFalse(ccnxSimpleFileTransferFileIO_GetFileVersion("/tmp", &fileSize, &version),
+                "Did not expect a version for a directory.");
+
+    unlink(fileName);
+    parcMemory_Deallocate((void **) &fileName);
+}
+
+LONGBOW_TEST_CASE(Global, getVersionedFileChunk)
+{
+    char *fileName = _createTempFileName("/tmp/ccnxSimpleFileTransfer_testData-getVersionedFileChunk.XXXXXXXX");
+    size_t chunkSize = 100;
+
+    FILE *fp = _createTestFile(fileName, chunkSize, 5);
+    fclose(fp);
+
+    size_t fileSize = 0;
+    uint64_t version = 0;
+    ccnxSimpleFileTransferFileIO_GetFileVersion(fileName, &fileSize, &version);
+
+    size_t chunkFileSize = 0;
+    PARCBuffer *chunk = ccnxSimpleFileTransferFileIO_GetVersionedFileChunk(fileName, chunkSize, 3, version, &chunkFileSize);
+    assertNotNull(chunk, "Expected the chunk of the current version");
+    assertTrue(parcBuffer_Remaining(chunk) == chunkSize, "Expected a full chunk, got %zu bytes", parcBuffer_Remaining(chunk));
+    assertTrue('d' == (char) parcBuffer_GetAtIndex(chunk, 0), "Expected 'd' at the start of chunk 3");
+    assertTrue(chunkFileSize == 500, "Expected a size of 500, got %zu", chunkFileSize);
+    parcBuffer_Release(&chunk);
+
+    chunk = ccnxSimpleFileTransferFileIO_GetVersionedFileChunk(fileName, chunkSize, 5, version, &chunkFileSize);
+    assertNotNull(chunk, "Expected an empty chunk past the end of the file");
+    assertTrue(parcBuffer_Remaining(chunk) == 0, "Expected an empty chunk, got %zu bytes", parcBuffer_Remaining(chunk));
+    parcBuffer_Release(&chunk);
+
+    chunk = ccnxSimpleFileTransferFileIO_GetVersionedFileChunk(fileName, chunkSize, 3, version + 1, &chunkFileSize);
+    assertNull(chunk, "Did not expect a chunk of another version");
+
+    unlink(fileName);
+    chunk = ccnxSimpleFileTransferFileIO_GetVersionedFileChunk(fileName, chunkSize, 3, version, &chunkFileSize);
+    assertNull(chunk, "Did not expect a chunk of a missing file");
+
+    parcMemory_Deallocate((void **) &fileName);
+}
+
+LONGBOW_TEST_CASE(Global, openVersionedFile)
+{
+    char *fileName = _createTempFileName("/tmp/ccnxSimpleFileTransfer_testData-openVersionedFile.XXXXXXXX");
+
+    FILE *fp = _createTestFile(fileName, 100, 3);
+    fclose(fp);
+
+    size_t fileSize = 0;
+    uint64_t version = 0;
+    ccnxSimpleFileTransferFileIO_GetFileVersion(fileName, &fileSize, &version);
+
+    size_t openedFileSize = 0;
+    int fd = ccnxSimpleFileTransferFileIO_OpenVersionedFile(fileName, version, &openedFileSize);
+    assertTrue(fd >= 0, "Expected the current version to be opened");
+    assertTrue(openedFileSize == 300, "Expected a size of 300, got %zu", openedFileSize);
+    close(fd);
+
+    fd = ccnxSimpleFileTransferFileIO_OpenVersionedFile(fileName, version + 1, &openedFileSize);
+    assertTrue(fd < 0, "Did not expect another version to be opened");
+
+    unlink(fileName);
+    fd = ccnxSimpleFileTransferFileIO_OpenVersionedFile(fileName, version, &openedFileSize);
+    assertTrue(fd < 0, "Did not expect a missing file to be opened");
+
+    parcMemory_Deallocate((void **) &fileName);
+}
+
+LONGBOW_TEST_CASE(Global, readFileChunkIntoBuffer)
+{
+    char *fileName = _createTempFileName("/tmp/ccnxSimpleFileTransfer_testData-readFileChunkIntoBuffer.XXXXXXXX");
+
+    FILE *fp = _createTestFile(fileName, 100, 3);
+    fclose(fp);
+
+    int fd = open(fileName, O_RDONLY);
+    PARCBuffer *buffer = parcBuffer_Allocate(100);
+
+    // The buffer is reused, whatever was left in it.
+    parcBuffer_SetPosition(buffer, 50);
+    assertTrue(ccnxSimpleFileTransferFileIO_ReadFileChunkIntoBuffer(fd, buffer, 100, 1), "Expected chunk 1 to be read");
+    assertTrue(parcBuffer_Remaining(buffer) == 100, "Expected 100 bytes, got %zu", parcBuffer_Remaining(buffer));
+    assertTrue(parcBuffer_GetAtIndex(buffer, 0) == 'b', "Expected the contents of chunk 1");
+
+    assertTrue(ccnxSimpleFileTransferFileIO_ReadFileChunkIntoBuffer(fd, buffer, 100, 3), "Expected a chunk past the end to be read");
+    assertTrue(parcBuffer_Remaining(buffer) == 0, "Expected no bytes past the end of the file");
+
+    parcBuffer_Release(&buffer);
+    close(fd);
+    unlink(fileName);
+    parcMemory_Deallocate((void **) &fileName);
+}
+
+LONGBOW_TEST_CASE(Global, isHole)
+{
+    char *fileName = _createTempFileName("/tmp/ccnxSimpleFileTransfer_testData-isHole.XXXXXXXX");
+
+    // 4KB of data, then a hole to the end of the 1MB file.
+    FILE *fp = _createTestFile(fileName, 4096, 1);
+    fclose(fp);
+    truncate(fileName, 1024 * 1024);
+
+    int fd = open(fileName, O_RDONLY);
+    assertFalse(ccnxSimpleFileTransferFileIO_IsHole(fd, 0, 1200), "Did not expect the data to be a hole");
+    assertFalse(ccnxSimpleFileTransferFileIO_IsHole(fd, 3600, 1200), "Did not expect a range ending in data to be a hole");
+
+#ifdef SEEK_HOLE
+    // Only a file system that tracks holes will report one.
+    if (lseek(fd, 0, SEEK_HOLE) < 1024 * 1024) {
+        assertTrue(ccnxSimpleFileTransferFileIO_IsHole(fd, 512 * 1024, 1200), "Expected the middle of the hole to be one");
+        assertTrue(ccnxSimpleFileTransferFileIO_IsHole(fd, 1024 * 1024 - 1200, 1200), "Expected the end of the hole to be one");
+    }
+#endif
+
+    close(fd);
+    unlink(fileName);
+    parcMemory_Deallocate((void **) &fileName);
+}
+
 int
 main(int argc, char *argv[])
 {
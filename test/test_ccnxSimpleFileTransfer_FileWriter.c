@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../ccnxSimpleFileTransfer_FileWriter.c"
+#include "../ccnxSimpleFileTransfer_FileIO.c"
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+LONGBOW_TEST_RUNNER(ccnxSimpleFileTransfer_FileWriter)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(ccnxSimpleFileTransfer_FileWriter)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(ccnxSimpleFileTransfer_FileWriter)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, createRelease);
+    LONGBOW_RUN_TEST_CASE(Global, createWithBadPath);
+    LONGBOW_RUN_TEST_CASE(Global, writeAndClose);
+    LONGBOW_RUN_TEST_CASE(Global, writeAfterClose);
+    LONGBOW_RUN_TEST_CASE(Global, writeZeros);
+    LONGBOW_RUN_TEST_CASE(Global, writeZerosToPipe);
+    LONGBOW_RUN_TEST_CASE(Global, directIO);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+/**
+ * Create a temporary filename from a template.
+ * The resulting fileName must be freed by calling parcMemory_Deallocate()
+ */
+static char *
+_createTempFileName(char *template)
+{
+    int numberOfChars = (int) strlen(template) + 1;
+    char *fileName = parcMemory_AllocateAndClear(numberOfChars * sizeof(char));
+    assertNotNull(fileName, "parcMemory_AllocateAndClear(%zu) returned NULL", numberOfChars * sizeof(char));
+    strncpy(fileName, template, numberOfChars);
+    mktemp(fileName);
+
+    return fileName; // This must be parcMemory_Deallocate()'d by the caller.
+}
+
+LONGBOW_TEST_CASE(Global, createRelease)
+{
+    char *fileName = _createTempFileName("/tmp/ccnxSimpleFileTransfer_testData-writer.XXXXXXXX");
+
+    CCNxSimpleFileTransferFileWriter *writer = ccnxSimpleFileTransferFileWriter_Create(fileName, 4096, 2, false);
+    assertNotNull(writer, "Expected a non-null FileWriter");
+
+    CCNxSimpleFileTransferFileWriter *ref = ccnxSimpleFileTransferFileWriter_Acquire(writer);
+    ccnxSimpleFileTransferFileWriter_Release(&writer);
+    ccnxSimpleFileTransferFileWriter_Release(&ref);
+
+    assertTrue(ccnxSimpleFileTransferFileIO_GetFileSize(fileName) == 0, "Expected an empty file");
+
+    unlink(fileName);
+    parcMemory_Deallocate((void **) &fileName);
+}
+
+LONGBOW_TEST_CASE(Global, createWithBadPath)
+{
+    CCNxSimpleFileTransferFileWriter *writer =
+        ccnxSimpleFileTransferFileWriter_Create("/this/directory/does/not/exist/file.txt", 4096, 2, false);
+    assertNull(writer, "Expected a NULL FileWriter for a file that can't be opened");
+}
+
+LONGBOW_TEST_CASE(Global, writeAndClose)
+{
+    char *fileName = _createTempFileName("/tmp/ccnxSimpleFileTransfer_testData-writer.XXXXXXXX");
+    size_t chunkSize = 1200;    // arbitrary, but deliberately not a divisor of the buffer size
+    int numChunks = 100;
+    size_t finalChunkSize = 17; // a short final chunk, like the last chunk of a file
+
+    // Only 2 small buffers, so the writer has to wait on the background thread.
+    CCNxSimpleFileTransferFileWriter *writer = ccnxSimpleFileTransferFileWriter_Create(fileName, 4096, 2, false);
+
+    uint8_t chunk[chunkSize];
+    for (int c = 0; c < numChunks; c++) {
+        memset(chunk, (int) (c + 'a') & 0x7f, chunkSize);
+        size_t length = (c == numChunks - 1) ? finalChunkSize : chunkSize;
+        assertTrue(ccnxSimpleFileTransferFileWriter_Write(writer, chunk, length), "Expected the write to succeed");
+    }
+
+    assertTrue(ccnxSimpleFileTransferFileWriter_Close(writer), "Expected the close to succeed");
+
+    size_t expectedSize = (chunkSize * (numChunks - 1)) + finalChunkSize;
+    assertTrue(ccnxSimpleFileTransferFileWriter_GetBytesWritten(writer) == expectedSize,
+               "Expected %zu bytes written, got %" PRIu64, expectedSize,
+               ccnxSimpleFileTransferFileWriter_GetBytesWritten(writer));
+    assertTrue(ccnxSimpleFileTransferFileIO_GetFileSize(fileName) == expectedSize, "File size didn't match expected size");
+
+    // The data should be in order.
+    PARCBuffer *buf = ccnxSimpleFileTransferFileIO_GetFileChunk(fileName, chunkSize, 5);
+    assertTrue('f' == (char) parcBuffer_GetAtIndex(buf, 0), "Expected 'f' at this location in the chunk buffer");
+    assertTrue('f' == (char) parcBuffer_GetAtIndex(buf, chunkSize - 1), "Expected 'f' at this location in the chunk buffer");
+    parcBuffer_Release(&buf);
+
+    ccnxSimpleFileTransferFileWriter_Release(&writer);
+
+    unlink(fileName);
+    parcMemory_Deallocate((void **) &fileName);
+}
+
+LONGBOW_TEST_CASE(Global, writeZeros)
+{
+    char *fileName = _createTempFileName("/tmp/ccnxSimpleFileTransfer_testData-writeZeros.XXXXXXXX");
+    size_t chunkSize = 1200;
+    size_t holeSize = 1024 * 1024;
+
+    CCNxSimpleFileTransferFileWriter *writer = ccnxSimpleFileTransferFileWriter_Create(fileName, 4096, 2, false);
+
+    // Data, a hole made of two runs of zeros, more data, and a hole at the end of the file.
+    uint8_t chunk[chunkSize];
+    memset(chunk, 'a', chunkSize);
+    assertTrue(ccnxSimpleFileTransferFileWriter_Write(writer, chunk, chunkSize), "Expected the write to succeed");
+    assertTrue(ccnxSimpleFileTransferFileWriter_WriteZeros(writer, holeSize / 2), "Expected the zeros to be accepted");
+    assertTrue(ccnxSimpleFileTransferFileWriter_WriteZeros(writer, holeSize / 2), "Expected the zeros to be accepted");
+    memset(chunk, 'b', chunkSize);
+    assertTrue(ccnxSimpleFileTransferFileWriter_Write(writer, chunk, chunkSize), "Expected the write to succeed");
+    assertTrue(ccnxSimpleFileTransferFileWriter_WriteZeros(writer, holeSize), "Expected the zeros to be accepted");
+
+    assertTrue(ccnxSimpleFileTransferFileWriter_Close(writer), "Expected the close to succeed");
+
+    size_t expectedSize = 2 * (chunkSize + holeSize);
+    assertTrue(ccnxSimpleFileTransferFileWriter_GetBytesWritten(writer) == expectedSize,
+               "Expected %zu bytes written, got %" PRIu64, expectedSize,
+               ccnxSimpleFileTransferFileWriter_GetBytesWritten(writer));
+    assertTrue(ccnxSimpleFileTransferFileIO_GetFileSize(fileName) == expectedSize, "File size didn't match expected size");
+
+    PARCBuffer *buf = ccnxSimpleFileTransferFileIO_GetFileChunk(fileName, chunkSize, 1);
+    assertTrue(parcBuffer_GetAtIndex(buf, 0) == 0, "Expected zeros after the first chunk");
+    parcBuffer_Release(&buf);
+    buf = ccnxSimpleFileTransferFileIO_GetFileChunk(fileName, chunkSize + holeSize, 1);
+    assertTrue('b' == (char) parcBuffer_GetAtIndex(buf, 0), "Expected the second chunk after the hole");
+    assertTrue(parcBuffer_GetAtIndex(buf, chunkSize) == 0, "Expected zeros after the second chunk");
+    parcBuffer_Release(&buf);
+
+#ifdef SEEK_HOLE
+    int fd = open(fileName, O_RDONLY);
+    if (lseek(fd, 0, SEEK_HOLE) < (off_t) expectedSize) {
+        // The file system tracks holes, so the zeros shouldn't have been written.
+        assertTrue(ccnxSimpleFileTransferFileIO_IsHole(fd, chunkSize + 4096, holeSize - 8192), "Expected a hole in the middle");
+        assertTrue(ccnxSimpleFileTransferFileIO_IsHole(fd, expectedSize - holeSize + 4096, holeSize - 4096),
+                   "Expected a hole at the end");
+    }
+    close(fd);
+#endif
+
+    ccnxSimpleFileTransferFileWriter_Release(&writer);
+
+    unlink(fileName);
+    parcMemory_Deallocate((void **) &fileName);
+}
+
+LONGBOW_TEST_CASE(Global, writeZerosToPipe)
+{
+    int pipeFds[2];
+    assertTrue(pipe(pipeFds) == 0, "Could not create a pipe");
+
+    // A pipe can't have holes, so the zeros are written.
+    CCNxSimpleFileTransferFileWriter *writer = ccnxSimpleFileTransferFileWriter_CreateWithDescriptor(pipeFds[1], 4096, 2);
+    assertTrue(ccnxSimpleFileTransferFileWriter_Write(writer, "ab", 2), "Expected the write to succeed");
+    assertTrue(ccnxSimpleFileTransferFileWriter_WriteZeros(writer, 5000), "Expected the zeros to be accepted");
+    assertTrue(ccnxSimpleFileTransferFileWriter_Close(writer), "Expected the close to succeed");
+
+    uint8_t bytes[6000];
+    size_t numRead = 0;
+    ssize_t n;
+    while ((n = read(pipeFds[0], bytes + numRead, sizeof(bytes) - numRead)) > 0) {
+        numRead += (size_t) n;
+    }
+    assertTrue(numRead == 5002, "Expected 5002 bytes, got %zu", numRead);
+    assertTrue(bytes[1] == 'b' && bytes[2] == 0 && bytes[5001] == 0, "Expected the zeros after the bytes");
+
+    close(pipeFds[0]);
+    ccnxSimpleFileTransferFileWriter_Release(&writer);
+}
+
+LONGBOW_TEST_CASE(Global, writeAfterClose)
+{
+    char *fileName = _createTempFileName("/tmp/ccnxSimpleFileTransfer_testData-writer.XXXXXXXX");
+
+    CCNxSimpleFileTransferFileWriter *writer = ccnxSimpleFileTransferFileWriter_Create(fileName, 4096, 2, false);
+    assertTrue(ccnxSimpleFileTransferFileWriter_Write(writer, "abc", 3), "Expected the write to succeed");
+    assertTrue(ccnxSimpleFileTransferFileWriter_Close(writer), "Expected the close to succeed");
+    assertFalse(ccnxSimpleFileTransferFileWriter_Write(writer, "abc", 3), "Expected a write after close to fail");
+
+    ccnxSimpleFileTransferFileWriter_Release(&writer);
+
+    unlink(fileName);
+    parcMemory_Deallocate((void **) &fileName);
+}
+
+LONGBOW_TEST_CASE(Global, directIO)
+{
+    char *fileName = _createTempFileName("/tmp/ccnxSimpleFileTransfer_testData-writer.XXXXXXXX");
+
+    // O_DIRECT may not be supported where the test runs; the writer falls back to buffered I/O.
+    CCNxSimpleFileTransferFileWriter *writer = ccnxSimpleFileTransferFileWriter_Create(fileName, 4096, 4, true);
+
+    uint8_t chunk[1000];
+    memset(chunk, 'x', sizeof(chunk));
+    for (int i = 0; i < 10; i++) {
+        ccnxSimpleFileTransferFileWriter_Write(writer, chunk, sizeof(chunk));
+    }
+    assertTrue(ccnxSimpleFileTransferFileWriter_Close(writer), "Expected the close to succeed");
+    assertTrue(ccnxSimpleFileTransferFileIO_GetFileSize(fileName) == 10000, "File size didn't match expected size");
+
+    ccnxSimpleFileTransferFileWriter_Release(&writer);
+
+    unlink(fileName);
+    parcMemory_Deallocate((void **) &fileName);
+}
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(ccnxSimpleFileTransfer_FileWriter);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../ccnxSimpleFileTransfer_InFlightTable.c"
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+#include <pthread.h>
+#include <unistd.h>
+
+LONGBOW_TEST_RUNNER(ccnxSimpleFileTransfer_InFlightTable)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(ccnxSimpleFileTransfer_InFlightTable)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(ccnxSimpleFileTransfer_InFlightTable)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, createRelease);
+    LONGBOW_RUN_TEST_CASE(Global, lingeringResponseIsShared);
+    LONGBOW_RUN_TEST_CASE(Global, differentNames);
+    LONGBOW_RUN_TEST_CASE(Global, noResponse);
+    LONGBOW_RUN_TEST_CASE(Global, lingerExpires);
+    LONGBOW_RUN_TEST_CASE(Global, noLinger);
+    LONGBOW_RUN_TEST_CASE(Global, concurrentRequestsShareOneBuild);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+typedef struct {
+    int numBuilds;
+    bool returnNull;
+    useconds_t buildMicros;
+    pthread_mutex_t mutex;
+} _TestBuilder;
+
+static CCNxContentObject *
+_testBuild(void *builderContext, const CCNxInterest *interest)
+{
+    _TestBuilder *builder = builderContext;
+
+    pthread_mutex_lock(&builder->mutex);
+    builder->numBuilds++;
+    pthread_mutex_unlock(&builder->mutex);
+
+    if (builder->buildMicros > 0) {
+        usleep(builder->buildMicros);
+    }
+
+    CCNxContentObject *result = NULL;
+    if (!builder->returnNull) {
+        PARCBuffer *payload = parcBuffer_WrapCString("payload");
+        result = ccnxContentObject_CreateWithNameAndPayload(ccnxInterest_GetName(interest), payload);
+        parcBuffer_Release(&payload);
+    }
+    return result;
+}
+
+static CCNxInterest *
+_createInterest(const char *uri)
+{
+    CCNxName *name = ccnxName_CreateFromCString(uri);
+    CCNxInterest *result = ccnxInterest_CreateSimple(name);
+    ccnxName_Release(&name);
+    return result;
+}
+
+LONGBOW_TEST_CASE(Global, createRelease)
+{
+    CCNxSimpleFileTransferInFlightTable *table = ccnxSimpleFileTransferInFlightTable_Create(100);
+    assertNotNull(table, "Expected a new table");
+    assertTrue(ccnxSimpleFileTransferInFlightTable_GetSize(table) == 0, "Expected an empty table");
+
+    CCNxSimpleFileTransferInFlightTable *reference = ccnxSimpleFileTransferInFlightTable_Acquire(table);
+    ccnxSimpleFileTransferInFlightTable_Release(&reference);
+    assertNull(reference, "Expected Release to clear the pointer");
+
+    ccnxSimpleFileTransferInFlightTable_Release(&table);
+}
+
+LONGBOW_TEST_CASE(Global, lingeringResponseIsShared)
+{
+    _TestBuilder builder = { .mutex = PTHREAD_MUTEX_INITIALIZER };
+    CCNxSimpleFileTransferInFlightTable *table = ccnxSimpleFileTransferInFlightTable_Create(60000);
+    CCNxInterest *interest = _createInterest("ccnx:/a/b/chunk=1");
+    bool wasCoalesced = true;
+
+    CCNxContentObject *first = ccnxSimpleFileTransferInFlightTable_GetResponse(table, interest, _testBuild, &builder, &wasCoalesced);
+    assertNotNull(first, "Expected a response");
+    assertFalse(wasCoalesced, "Expected the first response to be built");
+
+    CCNxContentObject *second = ccnxSimpleFileTransferInFlightTable_GetResponse(table, interest, _testBuild, &builder, &wasCoalesced);
+    assertTrue(second == first, "Expected the same response");
+    assertTrue(wasCoalesced, "Expected the second response to be shared");
+    assertTrue(builder.numBuilds == 1, "Expected 1 build, got %d", builder.numBuilds);
+    assertTrue(ccnxSimpleFileTransferInFlightTable_GetSize(table) == 1, "Expected 1 entry");
+
+    ccnxContentObject_Release(&first);
+    ccnxContentObject_Release(&second);
+    ccnxInterest_Release(&interest);
+    ccnxSimpleFileTransferInFlightTable_Release(&table);
+}
+
+LONGBOW_TEST_CASE(Global, differentNames)
+{
+    _TestBuilder builder = { .mutex = PTHREAD_MUTEX_INITIALIZER };
+    CCNxSimpleFileTransferInFlightTable *table = ccnxSimpleFileTransferInFlightTable_Create(60000);
+    CCNxInterest *interest1 = _createInterest("ccnx:/a/b/chunk=1");
+    CCNxInterest *interest2 = _createInterest("ccnx:/a/b/chunk=2");
+
+    CCNxContentObject *first = ccnxSimpleFileTransferInFlightTable_GetResponse(table, interest1, _testBuild, &builder, NULL);
+    CCNxContentObject *second = ccnxSimpleFileTransferInFlightTable_GetResponse(table, interest2, _testBuild, &builder, NULL);
+    assertTrue(first != second, "Expected different responses for different names");
+    assertTrue(builder.numBuilds == 2, "Expected 2 builds, got %d", builder.numBuilds);
+    assertTrue(ccnxSimpleFileTransferInFlightTable_GetSize(table) == 2, "Expected 2 entries");
+
+    ccnxContentObject_Release(&first);
+    ccnxContentObject_Release(&second);
+    ccnxInterest_Release(&interest1);
+    ccnxInterest_Release(&interest2);
+    ccnxSimpleFileTransferInFlightTable_Release(&table);
+}
+
+LONGBOW_TEST_CASE(Global, noResponse)
+{
+    _TestBuilder builder = { .returnNull = true, .mutex = PTHREAD_MUTEX_INITIALIZER };
+    CCNxSimpleFileTransferInFlightTable *table = ccnxSimpleFileTransferInFlightTable_Create(60000);
+    CCNxInterest *interest = _createInterest("ccnx:/a/b/chunk=1");
+
+    assertNull(ccnxSimpleFileTransferInFlightTable_GetResponse(table, interest, _testBuild, &builder, NULL), "Expected no response");
+    assertNull(ccnxSimpleFileTransferInFlightTable_GetResponse(table, interest, _testBuild, &builder, NULL), "Expected no response");
+    assertTrue(builder.numBuilds == 1, "Expected the missing response to be shared too, got %d builds", builder.numBuilds);
+
+    ccnxInterest_Release(&interest);
+    ccnxSimpleFileTransferInFlightTable_Release(&table);
+}
+
+LONGBOW_TEST_CASE(Global, lingerExpires)
+{
+    _TestBuilder builder = { .mutex = PTHREAD_MUTEX_INITIALIZER };
+    CCNxSimpleFileTransferInFlightTable *table = ccnxSimpleFileTransferInFlightTable_Create(20);
+    CCNxInterest *interest = _createInterest("ccnx:/a/b/chunk=1");
+
+    CCNxContentObject *response = ccnxSimpleFileTransferInFlightTable_GetResponse(table, interest, _testBuild, &builder, NULL);
+    ccnxContentObject_Release(&response);
+
+    usleep(50 * 1000);
+    assertTrue(ccnxSimpleFileTransferInFlightTable_GetSize(table) == 0, "Expected the response to have expired");
+
+    response = ccnxSimpleFileTransferInFlightTable_GetResponse(table, interest, _testBuild, &builder, NULL);
+    ccnxContentObject_Release(&response);
+    assertTrue(builder.numBuilds == 2, "Expected 2 builds, got %d", builder.numBuilds);
+
+    ccnxInterest_Release(&interest);
+    ccnxSimpleFileTransferInFlightTable_Release(&table);
+}
+
+LONGBOW_TEST_CASE(Global, noLinger)
+{
+    _TestBuilder builder = { .mutex = PTHREAD_MUTEX_INITIALIZER };
+    CCNxSimpleFileTransferInFlightTable *table = ccnxSimpleFileTransferInFlightTable_Create(0);
+    CCNxInterest *interest = _createInterest("ccnx:/a/b/chunk=1");
+
+    for (int i = 0; i < 3; i++) {
+        CCNxContentObject *response = ccnxSimpleFileTransferInFlightTable_GetResponse(table, interest, _testBuild, &builder, NULL);
+        assertNotNull(response, "Expected a response");
+        ccnxContentObject_Release(&response);
+        assertTrue(ccnxSimpleFileTransferInFlightTable_GetSize(table) == 0, "Expected nothing to linger");
+    }
+    assertTrue(builder.numBuilds == 3, "Expected 3 builds, got %d", builder.numBuilds);
+
+    ccnxInterest_Release(&interest);
+    ccnxSimpleFileTransferInFlightTable_Release(&table);
+}
+
+typedef struct {
+    CCNxSimpleFileTransferInFlightTable *table;
+    CCNxInterest *interest;
+    _TestBuilder *builder;
+    CCNxContentObject *response;
+    bool wasCoalesced;
+} _TestRequester;
+
+static void *
+_request(void *arg)
+{
+    _TestRequester *requester = arg;
+    requester->response = ccnxSimpleFileTransferInFlightTable_GetResponse(requester->table, requester->interest,
+                                                                           _testBuild, requester->builder,
+                                                                           &requester->wasCoalesced);
+    return NULL;
+}
+
+LONGBOW_TEST_CASE(Global, concurrentRequestsShareOneBuild)
+{
+    // Without lingering, only the Interests that arrive while the response is being built can share it.
+    _TestBuilder builder = { .buildMicros = 200 * 1000, .mutex = PTHREAD_MUTEX_INITIALIZER };
+    CCNxSimpleFileTransferInFlightTable *table = ccnxSimpleFileTransferInFlightTable_Create(0);
+    CCNxInterest *interest = _createInterest("ccnx:/a/b/chunk=1");
+
+    const int numRequesters = 8;
+    pthread_t threads[numRequesters];
+    _TestRequester requesters[numRequesters];
+    for (int i = 0; i < numRequesters; i++) {
+        requesters[i] = (_TestRequester) { .table = table, .interest = interest, .builder = &builder };
+        pthread_create(&threads[i], NULL, _request, &requesters[i]);
+    }
+
+    int numCoalesced = 0;
+    for (int i = 0; i < numRequesters; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    for (int i = 0; i < numRequesters; i++) {
+        assertNotNull(requesters[i].response, "Expected every requester to get the response");
+        assertTrue(requesters[i].response == requesters[0].response, "Expected every requester to get the same response");
+        numCoalesced += requesters[i].wasCoalesced ? 1 : 0;
+    }
+    for (int i = 0; i < numRequesters; i++) {
+        ccnxContentObject_Release(&requesters[i].response);
+    }
+    assertTrue(builder.numBuilds == 1, "Expected 1 build, got %d", builder.numBuilds);
+    assertTrue(numCoalesced == numRequesters - 1, "Expected %d coalesced, got %d", numRequesters - 1, numCoalesced);
+    assertTrue(ccnxSimpleFileTransferInFlightTable_GetSize(table) == 0, "Expected nothing to linger");
+
+    ccnxInterest_Release(&interest);
+    ccnxSimpleFileTransferInFlightTable_Release(&table);
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(ccnxSimpleFileTransfer_InFlightTable);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
@@ -0,0 +1,312 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../ccnxSimpleFileTransfer_Loopback.c"
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+LONGBOW_TEST_RUNNER(ccnxSimpleFileTransfer_Loopback)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(ccnxSimpleFileTransfer_Loopback)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(ccnxSimpleFileTransfer_Loopback)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, createRelease);
+    LONGBOW_RUN_TEST_CASE(Global, roundTrip);
+    LONGBOW_RUN_TEST_CASE(Global, deadline);
+    LONGBOW_RUN_TEST_CASE(Global, pendingInterestTable);
+    LONGBOW_RUN_TEST_CASE(Global, contentStore);
+    LONGBOW_RUN_TEST_CASE(Global, bandwidth);
+    LONGBOW_RUN_TEST_CASE(Global, loss);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+/**
+ * A producer that answers every Interest with a 1000 byte payload, and counts the Interests it sees.
+ */
+static CCNxContentObject *
+_testProducer(void *producerContext, const CCNxInterest *interest)
+{
+    unsigned int *numInterests = producerContext;
+    (*numInterests)++;
+
+    PARCBuffer *payload = parcBuffer_Allocate(1000);
+    CCNxContentObject *result = ccnxContentObject_CreateWithNameAndPayload(ccnxInterest_GetName(interest), payload);
+    parcBuffer_Release(&payload);
+
+    return result;
+}
+
+static void
+_sendInterest(CCNxSimpleFileTransferLoopback *loopback, const char *uri)
+{
+    CCNxName *name = ccnxName_CreateFromCString(uri);
+    CCNxInterest *interest = ccnxInterest_CreateSimple(name);
+    ccnxSimpleFileTransferLoopback_SendInterest(loopback, interest);
+    ccnxInterest_Release(&interest);
+    ccnxName_Release(&name);
+}
+
+LONGBOW_TEST_CASE(Global, createRelease)
+{
+    unsigned int numInterests = 0;
+    CCNxSimpleFileTransferLoopback *loopback =
+        ccnxSimpleFileTransferLoopback_Create(&ccnxSimpleFileTransferLoopback_DefaultConfig, _testProducer, &numInterests);
+    CCNxSimpleFileTransferLoopback *ref = ccnxSimpleFileTransferLoopback_Acquire(loopback);
+
+    ccnxSimpleFileTransferLoopback_Release(&loopback);
+    ccnxSimpleFileTransferLoopback_Release(&ref);
+}
+
+LONGBOW_TEST_CASE(Global, roundTrip)
+{
+    unsigned int numInterests = 0;
+    CCNxSimpleFileTransferLoopbackConfig config = ccnxSimpleFileTransferLoopback_DefaultConfig;
+    config.linkDelayMicros = 500;
+    config.producerDelayMicros = 100;
+
+    CCNxSimpleFileTransferLoopback *loopback = ccnxSimpleFileTransferLoopback_Create(&config, _testProducer, &numInterests);
+
+    _sendInterest(loopback, "ccnx:/test/a");
+    CCNxContentObject *contentObject = ccnxSimpleFileTransferLoopback_Receive(loopback, UINT64_MAX);
+
+    assertNotNull(contentObject, "Expected a Content Object");
+    assertTrue(ccnxSimpleFileTransferLoopback_GetNowMicros(loopback) == 1100,
+               "Expected a 1100us round trip, got %" PRIu64, ccnxSimpleFileTransferLoopback_GetNowMicros(loopback));
+    assertTrue(numInterests == 1, "Expected the producer to see 1 Interest");
+
+    CCNxSimpleFileTransferLoopbackStats stats = ccnxSimpleFileTransferLoopback_GetStats(loopback);
+    assertTrue(stats.contentObjectsDelivered == 1, "Expected 1 Content Object delivered");
+    assertTrue(stats.bytesDelivered == 1000, "Expected 1000 bytes delivered");
+
+    ccnxContentObject_Release(&contentObject);
+
+    assertNull(ccnxSimpleFileTransferLoopback_Receive(loopback, UINT64_MAX), "Expected nothing left in flight");
+
+    ccnxSimpleFileTransferLoopback_Release(&loopback);
+}
+
+LONGBOW_TEST_CASE(Global, deadline)
+{
+    unsigned int numInterests = 0;
+    CCNxSimpleFileTransferLoopback *loopback =
+        ccnxSimpleFileTransferLoopback_Create(&ccnxSimpleFileTransferLoopback_DefaultConfig, _testProducer, &numInterests);
+
+    _sendInterest(loopback, "ccnx:/test/a");
+
+    // The answer can't arrive before 2ms.
+    assertNull(ccnxSimpleFileTransferLoopback_Receive(loopback, 1500), "Expected nothing before the deadline");
+    assertTrue(ccnxSimpleFileTransferLoopback_GetNowMicros(loopback) == 1500, "Expected the clock to stop at the deadline");
+
+    CCNxContentObject *contentObject = ccnxSimpleFileTransferLoopback_Receive(loopback, 3000);
+    assertNotNull(contentObject, "Expected a Content Object before the second deadline");
+    ccnxContentObject_Release(&contentObject);
+
+    ccnxSimpleFileTransferLoopback_Release(&loopback);
+}
+
+LONGBOW_TEST_CASE(Global, pendingInterestTable)
+{
+    unsigned int numInterests = 0;
+    CCNxSimpleFileTransferLoopbackConfig config = ccnxSimpleFileTransferLoopback_DefaultConfig;
+    config.producerDelayMicros = 10000;
+
+    CCNxSimpleFileTransferLoopback *loopback = ccnxSimpleFileTransferLoopback_Create(&config, _testProducer, &numInterests);
+
+    // The second Interest reaches the forwarder while the first is still pending.
+    _sendInterest(loopback, "ccnx:/test/a");
+    _sendInterest(loopback, "ccnx:/test/a");
+
+    CCNxContentObject *contentObject = ccnxSimpleFileTransferLoopback_Receive(loopback, UINT64_MAX);
+    assertNotNull(contentObject, "Expected a Content Object");
+    ccnxContentObject_Release(&contentObject);
+    assertNull(ccnxSimpleFileTransferLoopback_Receive(loopback, UINT64_MAX), "Expected only one Content Object");
+
+    CCNxSimpleFileTransferLoopbackStats stats = ccnxSimpleFileTransferLoopback_GetStats(loopback);
+    assertTrue(numInterests == 1, "Expected the producer to see 1 Interest, saw %u", numInterests);
+    assertTrue(stats.interestsAggregated == 1, "Expected 1 aggregated Interest");
+
+    ccnxSimpleFileTransferLoopback_Release(&loopback);
+}
+
+LONGBOW_TEST_CASE(Global, contentStore)
+{
+    unsigned int numInterests = 0;
+    CCNxSimpleFileTransferLoopbackConfig config = ccnxSimpleFileTransferLoopback_DefaultConfig;
+    config.contentStoreCapacity = 1;
+
+    CCNxSimpleFileTransferLoopback *loopback = ccnxSimpleFileTransferLoopback_Create(&config, _testProducer, &numInterests);
+
+    const char *uris[] = { "ccnx:/test/a", "ccnx:/test/a", "ccnx:/test/b", "ccnx:/test/a" };
+    for (int i = 0; i < sizeof(uris) / sizeof(uris[0]); i++) {
+        _sendInterest(loopback, uris[i]);
+        CCNxContentObject *contentObject = ccnxSimpleFileTransferLoopback_Receive(loopback, UINT64_MAX);
+        assertNotNull(contentObject, "Expected a Content Object for %s", uris[i]);
+        ccnxContentObject_Release(&contentObject);
+    }
+
+    // The second 'a' is a hit. 'b' evicts 'a', so the third 'a' is not.
+    CCNxSimpleFileTransferLoopbackStats stats = ccnxSimpleFileTransferLoopback_GetStats(loopback);
+    assertTrue(stats.contentStoreHits == 1, "Expected 1 Content Store hit, got %" PRIu64, stats.contentStoreHits);
+    assertTrue(numInterests == 3, "Expected the producer to see 3 Interests, saw %u", numInterests);
+
+    ccnxSimpleFileTransferLoopback_Release(&loopback);
+}
+
+LONGBOW_TEST_CASE(Global, bandwidth)
+{
+    unsigned int numInterests = 0;
+    CCNxSimpleFileTransferLoopbackConfig config = ccnxSimpleFileTransferLoopback_DefaultConfig;
+    config.linkDelayMicros = 0;
+    config.bandwidthBitsPerSecond = 8000000; // 1 byte per microsecond
+
+    CCNxSimpleFileTransferLoopback *loopback = ccnxSimpleFileTransferLoopback_Create(&config, _testProducer, &numInterests);
+
+    _sendInterest(loopback, "ccnx:/test/a");
+    _sendInterest(loopback, "ccnx:/test/b");
+
+    CCNxContentObject *first = ccnxSimpleFileTransferLoopback_Receive(loopback, UINT64_MAX);
+    uint64_t firstArrival = ccnxSimpleFileTransferLoopback_GetNowMicros(loopback);
+    CCNxContentObject *second = ccnxSimpleFileTransferLoopback_Receive(loopback, UINT64_MAX);
+    uint64_t secondArrival = ccnxSimpleFileTransferLoopback_GetNowMicros(loopback);
+
+    // The second Content Object queues behind the first on the link.
+    assertTrue(secondArrival - firstArrival == 1000 + _packetOverheadBytes,
+               "Expected the Content Objects %zu us apart, got %" PRIu64, 1000 + _packetOverheadBytes,
+               secondArrival - firstArrival);
+
+    ccnxContentObject_Release(&first);
+    ccnxContentObject_Release(&second);
+    ccnxSimpleFileTransferLoopback_Release(&loopback);
+}
+
+LONGBOW_TEST_CASE(Global, loss)
+{
+    unsigned int numInterests = 0;
+    CCNxSimpleFileTransferLoopbackConfig config = ccnxSimpleFileTransferLoopback_DefaultConfig;
+    config.lossProbability = 0.5;
+
+    // The same seed must lose the same packets.
+    uint64_t numDelivered[2] = { 0, 0 };
+    for (int run = 0; run < 2; run++) {
+        CCNxSimpleFileTransferLoopback *loopback = ccnxSimpleFileTransferLoopback_Create(&config, _testProducer, &numInterests);
+
+        for (int i = 0; i < 100; i++) {
+            char *uri = parcMemory_Format("ccnx:/test/%d", i);
+            _sendInterest(loopback, uri);
+            parcMemory_Deallocate((void **) &uri);
+        }
+
+        CCNxContentObject *contentObject = NULL;
+        while ((contentObject = ccnxSimpleFileTransferLoopback_Receive(loopback, UINT64_MAX)) != NULL) {
+            ccnxContentObject_Release(&contentObject);
+        }
+
+        CCNxSimpleFileTransferLoopbackStats stats = ccnxSimpleFileTransferLoopback_GetStats(loopback);
+        numDelivered[run] = stats.contentObjectsDelivered;
+        assertTrue(stats.packetsLost > 0, "Expected some packets to be lost");
+        assertTrue(stats.contentObjectsDelivered < 100, "Expected some Content Objects to be lost");
+
+        ccnxSimpleFileTransferLoopback_Release(&loopback);
+    }
+
+    assertTrue(numDelivered[0] == numDelivered[1], "Expected the same losses from the same seed");
+}
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(ccnxSimpleFileTransfer_Loopback);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
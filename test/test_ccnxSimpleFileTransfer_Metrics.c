@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../ccnxSimpleFileTransfer_Metrics.c"
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+LONGBOW_TEST_RUNNER(ccnxSimpleFileTransfer_Metrics)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(ccnxSimpleFileTransfer_Metrics)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(ccnxSimpleFileTransfer_Metrics)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, createRelease);
+    LONGBOW_RUN_TEST_CASE(Global, increment);
+    LONGBOW_RUN_TEST_CASE(Global, nullMetrics);
+    LONGBOW_RUN_TEST_CASE(Global, histogram);
+    LONGBOW_RUN_TEST_CASE(Global, flush);
+    LONGBOW_RUN_TEST_CASE(Global, createReport);
+    LONGBOW_RUN_TEST_CASE(Global, exportToFile);
+    LONGBOW_RUN_TEST_CASE(Global, exportToSocket);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+/**
+ * Return true if the specified string occurs in the specified PARCBuffer.
+ */
+static bool
+_reportContains(PARCBuffer *report, const char *string)
+{
+    char *reportString = parcBuffer_ToString(report);
+    bool result = (strstr(reportString, string) != NULL);
+    parcMemory_Deallocate((void **) &reportString);
+    return result;
+}
+
+LONGBOW_TEST_CASE(Global, createRelease)
+{
+    CCNxSimpleFileTransferMetrics *metrics = ccnxSimpleFileTransferMetrics_Create("test");
+    CCNxSimpleFileTransferMetrics *ref = ccnxSimpleFileTransferMetrics_Acquire(metrics);
+
+    ccnxSimpleFileTransferMetrics_Release(&metrics);
+    ccnxSimpleFileTransferMetrics_Release(&ref);
+}
+
+LONGBOW_TEST_CASE(Global, increment)
+{
+    CCNxSimpleFileTransferMetrics *metrics = ccnxSimpleFileTransferMetrics_Create("test");
+
+    ccnxSimpleFileTransferMetrics_Increment(metrics, CCNxSimpleFileTransferMetricsCounter_InterestsReceived, 1);
+    ccnxSimpleFileTransferMetrics_Increment(metrics, CCNxSimpleFileTransferMetricsCounter_InterestsReceived, 1);
+    ccnxSimpleFileTransferMetrics_Increment(metrics, CCNxSimpleFileTransferMetricsCounter_BytesSent, 1200);
+
+    assertTrue(ccnxSimpleFileTransferMetrics_GetCounter(metrics, CCNxSimpleFileTransferMetricsCounter_InterestsReceived) == 2,
+               "Expected 2 Interests received");
+    assertTrue(ccnxSimpleFileTransferMetrics_GetCounter(metrics, CCNxSimpleFileTransferMetricsCounter_BytesSent) == 1200,
+               "Expected 1200 bytes sent");
+    assertTrue(ccnxSimpleFileTransferMetrics_GetCounter(metrics, CCNxSimpleFileTransferMetricsCounter_CacheHits) == 0,
+               "Expected no cache hits");
+
+    ccnxSimpleFileTransferMetrics_Release(&metrics);
+}
+
+LONGBOW_TEST_CASE(Global, nullMetrics)
+{
+    // Updating NULL metrics must be harmless, and must not read the clock.
+    ccnxSimpleFileTransferMetrics_Increment(NULL, CCNxSimpleFileTransferMetricsCounter_InterestsReceived, 1);
+    ccnxSimpleFileTransferMetrics_RecordLatency(NULL, CCNxSimpleFileTransferMetricsHistogram_SendLatency, 1000);
+
+    uint64_t startTime = ccnxSimpleFileTransferMetrics_StartTimer(NULL);
+    assertTrue(startTime == 0, "Expected a zero start time for NULL metrics");
+    ccnxSimpleFileTransferMetrics_RecordLatencySince(NULL, CCNxSimpleFileTransferMetricsHistogram_SendLatency, startTime);
+}
+
+LONGBOW_TEST_CASE(Global, histogram)
+{
+    CCNxSimpleFileTransferMetrics *metrics = ccnxSimpleFileTransferMetrics_Create("test");
+
+    assertTrue(_getBucketIndex(0) == 0, "Expected 0ns in bucket 0");
+    assertTrue(_getBucketIndex(1) == 0, "Expected 1ns in bucket 0");
+    assertTrue(_getBucketIndex(1024) == 10, "Expected 1024ns in bucket 10");
+    assertTrue(_getBucketIndex(UINT64_MAX) == CCNxSimpleFileTransferMetrics_NumHistogramBuckets - 1,
+               "Expected huge latencies in the last bucket");
+
+    ccnxSimpleFileTransferMetrics_RecordLatency(metrics, CCNxSimpleFileTransferMetricsHistogram_DiskReadLatency, 1500);
+    uint64_t startTime = ccnxSimpleFileTransferMetrics_StartTimer(metrics);
+    ccnxSimpleFileTransferMetrics_RecordLatencySince(metrics, CCNxSimpleFileTransferMetricsHistogram_DiskReadLatency, startTime);
+
+    assertTrue(ccnxSimpleFileTransferMetrics_GetHistogramCount(metrics, CCNxSimpleFileTransferMetricsHistogram_DiskReadLatency) == 2,
+               "Expected 2 latencies recorded");
+    assertTrue(metrics->histograms[CCNxSimpleFileTransferMetricsHistogram_DiskReadLatency].buckets[10] == 1,
+               "Expected 1500ns in bucket 10");
+
+    ccnxSimpleFileTransferMetrics_Release(&metrics);
+}
+
+LONGBOW_TEST_CASE(Global, flush)
+{
+    CCNxSimpleFileTransferMetrics *metrics = ccnxSimpleFileTransferMetrics_Create("test");
+    CCNxSimpleFileTransferMetrics *batch = ccnxSimpleFileTransferMetrics_Create("test");
+
+    ccnxSimpleFileTransferMetrics_Increment(metrics, CCNxSimpleFileTransferMetricsCounter_ResponsesSent, 1);
+    ccnxSimpleFileTransferMetrics_Increment(batch, CCNxSimpleFileTransferMetricsCounter_ResponsesSent, 3);
+    ccnxSimpleFileTransferMetrics_RecordLatency(batch, CCNxSimpleFileTransferMetricsHistogram_SendLatency, 1500);
+
+    ccnxSimpleFileTransferMetrics_Flush(batch, metrics);
+
+    assertTrue(ccnxSimpleFileTransferMetrics_GetCounter(metrics, CCNxSimpleFileTransferMetricsCounter_ResponsesSent) == 4,
+               "Expected the batch's count added to the metrics");
+    assertTrue(ccnxSimpleFileTransferMetrics_GetHistogramCount(metrics, CCNxSimpleFileTransferMetricsHistogram_SendLatency) == 1,
+               "Expected the batch's latency added to the metrics");
+    assertTrue(metrics->histograms[CCNxSimpleFileTransferMetricsHistogram_SendLatency].buckets[10] == 1,
+               "Expected the batch's latency in bucket 10");
+
+    assertTrue(ccnxSimpleFileTransferMetrics_GetCounter(batch, CCNxSimpleFileTransferMetricsCounter_ResponsesSent) == 0,
+               "Expected the batch to be emptied");
+    assertTrue(ccnxSimpleFileTransferMetrics_GetHistogramCount(batch, CCNxSimpleFileTransferMetricsHistogram_SendLatency) == 0,
+               "Expected the batch's histogram to be emptied");
+
+    // Flushing again adds nothing, and NULL batches and metrics are ignored.
+    ccnxSimpleFileTransferMetrics_Flush(batch, metrics);
+    ccnxSimpleFileTransferMetrics_Flush(NULL, metrics);
+    ccnxSimpleFileTransferMetrics_Flush(batch, NULL);
+    assertTrue(ccnxSimpleFileTransferMetrics_GetCounter(metrics, CCNxSimpleFileTransferMetricsCounter_ResponsesSent) == 4,
+               "Expected an empty batch to add nothing");
+
+    ccnxSimpleFileTransferMetrics_Release(&batch);
+    ccnxSimpleFileTransferMetrics_Release(&metrics);
+}
+
+LONGBOW_TEST_CASE(Global, createReport)
+{
+    CCNxSimpleFileTransferMetrics *metrics = ccnxSimpleFileTransferMetrics_Create("test");
+
+    ccnxSimpleFileTransferMetrics_Increment(metrics, CCNxSimpleFileTransferMetricsCounter_ResponsesSent, 42);
+    ccnxSimpleFileTransferMetrics_RecordLatency(metrics, CCNxSimpleFileTransferMetricsHistogram_SendLatency, 3000);
+
+    PARCBuffer *report = ccnxSimpleFileTransferMetrics_CreateReport(metrics);
+
+    assertTrue(_reportContains(report, "# TYPE ccnx_sft_responses_sent_total counter"), "Expected a TYPE line");
+    assertTrue(_reportContains(report, "ccnx_sft_responses_sent_total{role=\"test\"} 42"), "Expected the counter value");
+    assertTrue(_reportContains(report, "ccnx_sft_send_seconds_bucket{role=\"test\",le=\"+Inf\"} 1"), "Expected the +Inf bucket");
+    assertTrue(_reportContains(report, "ccnx_sft_send_seconds_count{role=\"test\"} 1"), "Expected the histogram count");
+
+    parcBuffer_Release(&report);
+    ccnxSimpleFileTransferMetrics_Release(&metrics);
+}
+
+LONGBOW_TEST_CASE(Global, exportToFile)
+{
+    char fileName[] = "/tmp/ccnxSimpleFileTransfer_testData-metrics.XXXXXXXX";
+    mktemp(fileName);
+
+    CCNxSimpleFileTransferMetrics *metrics = ccnxSimpleFileTransferMetrics_Create("test");
+    ccnxSimpleFileTransferMetrics_Increment(metrics, CCNxSimpleFileTransferMetricsCounter_CacheHits, 7);
+
+    assertTrue(ccnxSimpleFileTransferMetrics_StartExporter(metrics, fileName, 1), "Expected the exporter to start");
+    ccnxSimpleFileTransferMetrics_StopExporter(metrics);
+
+    assertTrue(access(fileName, R_OK) == 0, "Expected the exporter to write '%s'", fileName);
+
+    unlink(fileName);
+    ccnxSimpleFileTransferMetrics_Release(&metrics);
+}
+
+LONGBOW_TEST_CASE(Global, exportToSocket)
+{
+    char socketPath[] = "/tmp/ccnxSimpleFileTransfer_testData-metrics.XXXXXXXX";
+    mktemp(socketPath);
+    char *target = parcMemory_Format("unix:%s", socketPath);
+
+    CCNxSimpleFileTransferMetrics *metrics = ccnxSimpleFileTransferMetrics_Create("test");
+    assertTrue(ccnxSimpleFileTransferMetrics_StartExporter(metrics, target, 1), "Expected the exporter to start");
+
+    int clientSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketPath, sizeof(address.sun_path) - 1);
+    assertTrue(connect(clientSocket, (struct sockaddr *) &address, sizeof(address)) == 0, "Expected to connect");
+
+    const char *request = "GET /metrics HTTP/1.0\r\n\r\n";
+    assertTrue(write(clientSocket, request, strlen(request)) > 0, "Expected to send a request");
+
+    char response[64];
+    ssize_t numBytesRead = read(clientSocket, response, sizeof(response) - 1);
+    assertTrue(numBytesRead > 0, "Expected a response");
+    response[numBytesRead] = 0;
+    assertTrue(strncmp(response, "HTTP/1.0 200 OK", 15) == 0, "Expected an HTTP response, got '%s'", response);
+
+    close(clientSocket);
+    ccnxSimpleFileTransferMetrics_StopExporter(metrics);
+    assertFalse(access(socketPath, F_OK) == 0, "Expected the socket to be removed");
+
+    parcMemory_Deallocate((void **) &target);
+    ccnxSimpleFileTransferMetrics_Release(&metrics);
+}
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(ccnxSimpleFileTransfer_Metrics);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../ccnxSimpleFileTransfer_OpenFileCache.c"
+#include "../ccnxSimpleFileTransfer_FileIO.c"
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+#include <stdio.h>
+#include <unistd.h>
+
+LONGBOW_TEST_RUNNER(ccnxSimpleFileTransfer_OpenFileCache)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(ccnxSimpleFileTransfer_OpenFileCache)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(ccnxSimpleFileTransfer_OpenFileCache)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, createRelease);
+    LONGBOW_RUN_TEST_CASE(Global, getFile);
+    LONGBOW_RUN_TEST_CASE(Global, fileChanged);
+    LONGBOW_RUN_TEST_CASE(Global, leastRecentlyUsed);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+/**
+ * Create a file of 'size' bytes, each the letter 'fill', and return its version.
+ */
+static uint64_t
+_writeTestFile(const char *fileName, size_t size, char fill)
+{
+    FILE *fp = fopen(fileName, "w");
+    assertNotNull(fp, "Could not create '%s'", fileName);
+    for (size_t i = 0; i < size; i++) {
+        fputc(fill, fp);
+    }
+    fclose(fp);
+
+    size_t fileSize = 0;
+    uint64_t version = 0;
+    ccnxSimpleFileTransferFileIO_GetFileVersion(fileName, &fileSize, &version);
+    return version;
+}
+
+/**
+ * Create an empty temporary file, and return its name, which must be freed by calling parcMemory_Deallocate().
+ */
+static char *
+_createTempFile(void)
+{
+    char template[] = "/tmp/ccnxSimpleFileTransfer_testData-openFileCache.XXXXXXXX";
+    int fd = mkstemp(template);
+    assertTrue(fd >= 0, "Could not create a temporary file");
+    close(fd);
+    return parcMemory_StringDuplicate(template, strlen(template));
+}
+
+LONGBOW_TEST_CASE(Global, createRelease)
+{
+    CCNxSimpleFileTransferOpenFileCache *cache = ccnxSimpleFileTransferOpenFileCache_Create(4);
+    assertNotNull(cache, "Expected a non-NULL cache");
+    assertTrue(ccnxSimpleFileTransferOpenFileCache_GetSize(cache) == 0, "Expected an empty cache");
+
+    CCNxSimpleFileTransferOpenFileCache *reference = ccnxSimpleFileTransferOpenFileCache_Acquire(cache);
+    ccnxSimpleFileTransferOpenFileCache_Release(&cache);
+    assertNull(cache, "Expected Release to NULL the pointer");
+    ccnxSimpleFileTransferOpenFileCache_Release(&reference);
+}
+
+LONGBOW_TEST_CASE(Global, getFile)
+{
+    CCNxSimpleFileTransferOpenFileCache *cache = ccnxSimpleFileTransferOpenFileCache_Create(4);
+    char *fileName = _createTempFile();
+    uint64_t version = _writeTestFile(fileName, 250, 'a');
+
+    size_t fileSize = 0;
+    int fd = ccnxSimpleFileTransferOpenFileCache_GetFile(cache, fileName, version, &fileSize);
+    assertTrue(fd >= 0, "Expected the file to be opened");
+    assertTrue(fileSize == 250, "Expected a size of 250, got %zu", fileSize);
+
+    // The same descriptor is used for the next chunk.
+    assertTrue(ccnxSimpleFileTransferOpenFileCache_GetFile(cache, fileName, version, &fileSize) == fd,
+               "Expected the file to be kept open");
+    assertTrue(ccnxSimpleFileTransferOpenFileCache_GetSize(cache) == 1, "Expected 1 file open");
+
+    PARCBuffer *chunk = ccnxSimpleFileTransferFileIO_ReadFileChunk(fd, 100, 2);
+    assertTrue(parcBuffer_Remaining(chunk) == 50, "Expected the last 50 bytes, got %zu", parcBuffer_Remaining(chunk));
+    assertTrue(parcBuffer_GetAtIndex(chunk, 0) == 'a', "Expected the file's contents");
+    parcBuffer_Release(&chunk);
+
+    assertTrue(ccnxSimpleFileTransferOpenFileCache_GetFile(cache, fileName, version + 1, &fileSize) < 0,
+               "Did not expect another version to be opened");
+
+    unlink(fileName);
+    parcMemory_Deallocate((void **) &fileName);
+    ccnxSimpleFileTransferOpenFileCache_Release(&cache);
+}
+
+LONGBOW_TEST_CASE(Global, fileChanged)
+{
+    CCNxSimpleFileTransferOpenFileCache *cache = ccnxSimpleFileTransferOpenFileCache_Create(4);
+    char *fileName = _createTempFile();
+    uint64_t version = _writeTestFile(fileName, 250, 'a');
+
+    size_t fileSize = 0;
+    assertTrue(ccnxSimpleFileTransferOpenFileCache_GetFile(cache, fileName, version, &fileSize) >= 0,
+               "Expected the file to be opened");
+
+    // Rewritten in place, so the open descriptor now reads the new contents.
+    uint64_t newVersion = _writeTestFile(fileName, 300, 'b');
+    assertTrue(ccnxSimpleFileTransferOpenFileCache_GetFile(cache, fileName, version, &fileSize) < 0,
+               "Did not expect the old version once the file changed");
+    assertTrue(ccnxSimpleFileTransferOpenFileCache_GetSize(cache) == 0, "Expected the old version to be closed");
+
+    assertTrue(ccnxSimpleFileTransferOpenFileCache_GetFile(cache, fileName, newVersion, &fileSize) >= 0,
+               "Expected the new version to be opened");
+    assertTrue(fileSize == 300, "Expected a size of 300, got %zu", fileSize);
+
+    unlink(fileName);
+    parcMemory_Deallocate((void **) &fileName);
+    ccnxSimpleFileTransferOpenFileCache_Release(&cache);
+}
+
+LONGBOW_TEST_CASE(Global, leastRecentlyUsed)
+{
+    CCNxSimpleFileTransferOpenFileCache *cache = ccnxSimpleFileTransferOpenFileCache_Create(2);
+    char *fileNames[3];
+    uint64_t versions[3];
+    int fds[3];
+    size_t fileSize = 0;
+    for (int i = 0; i < 3; i++) {
+        fileNames[i] = _createTempFile();
+        versions[i] = _writeTestFile(fileNames[i], 100, 'a');
+    }
+
+    fds[0] = ccnxSimpleFileTransferOpenFileCache_GetFile(cache, fileNames[0], versions[0], &fileSize);
+    fds[1] = ccnxSimpleFileTransferOpenFileCache_GetFile(cache, fileNames[1], versions[1], &fileSize);
+    ccnxSimpleFileTransferOpenFileCache_GetFile(cache, fileNames[0], versions[0], &fileSize);
+
+    // The third file takes the place of the second, which was used less recently than the first.
+    fds[2] = ccnxSimpleFileTransferOpenFileCache_GetFile(cache, fileNames[2], versions[2], &fileSize);
+    assertTrue(fds[2] >= 0, "Expected the third file to be opened");
+    assertTrue(ccnxSimpleFileTransferOpenFileCache_GetSize(cache) == 2, "Expected 2 files open");
+    assertTrue(ccnxSimpleFileTransferOpenFileCache_GetFile(cache, fileNames[0], versions[0], &fileSize) == fds[0],
+               "Expected the first file to still be open");
+
+    for (int i = 0; i < 3; i++) {
+        unlink(fileNames[i]);
+        parcMemory_Deallocate((void **) &fileNames[i]);
+    }
+    ccnxSimpleFileTransferOpenFileCache_Release(&cache);
+}
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(ccnxSimpleFileTransfer_OpenFileCache);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
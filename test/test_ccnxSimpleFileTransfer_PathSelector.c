@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../ccnxSimpleFileTransfer_PathSelector.c"
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+#include <inttypes.h>
+#include <unistd.h>
+
+LONGBOW_TEST_RUNNER(ccnxSimpleFileTransfer_PathSelector)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(ccnxSimpleFileTransfer_PathSelector)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(ccnxSimpleFileTransfer_PathSelector)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, createRelease);
+    LONGBOW_RUN_TEST_CASE(Global, spread);
+    LONGBOW_RUN_TEST_CASE(Global, proportional);
+    LONGBOW_RUN_TEST_CASE(Global, failover);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+/**
+ * A simulated path: Interests on it are answered in order, each taking serviceMicros of the path's bandwidth,
+ * after a fixed delay.
+ */
+typedef struct simulatedPath {
+    uint64_t delayMicros;
+    uint64_t serviceMicros;
+    uint64_t nextFreeMicros;
+    bool isDead;
+} SimulatedPath;
+
+typedef struct simulatedInterest {
+    uint64_t chunkNumber;
+    size_t path;
+    uint64_t answeredAtMicros;
+    bool isAnswered;
+} SimulatedInterest;
+
+/**
+ * Fetch numChunks chunks over the simulated paths, keeping windowSize Interests outstanding, and sending again
+ * any Interest not answered within timeoutMicros.
+ */
+static void
+_simulateFetch(CCNxSimpleFileTransferPathSelector *selector, SimulatedPath *paths, size_t windowSize,
+               uint64_t numChunks, uint64_t timeoutMicros)
+{
+    SimulatedInterest *interests = parcMemory_AllocateAndClear(windowSize * sizeof(SimulatedInterest));
+    uint64_t *sentAtMicros = parcMemory_AllocateAndClear(windowSize * sizeof(uint64_t));
+    size_t numOutstanding = 0;
+    uint64_t nextChunk = 0;
+    uint64_t numReceived = 0;
+
+    for (uint64_t now = 0; numReceived < numChunks; now += 100) {
+        // Take the answers that are due, and send again the Interests that have timed out.
+        for (size_t i = 0; i < numOutstanding; i++) {
+            SimulatedInterest *interest = &interests[i];
+            if (interest->isAnswered && interest->answeredAtMicros <= now) {
+                ccnxSimpleFileTransferPathSelector_Receive(selector, interest->chunkNumber, interest->path, 1000, now);
+                numReceived++;
+                interests[i] = interests[numOutstanding - 1];
+                sentAtMicros[i] = sentAtMicros[numOutstanding - 1];
+                numOutstanding--;
+                i--;
+            } else if (now - sentAtMicros[i] >= timeoutMicros) {
+                interest->path = ccnxSimpleFileTransferPathSelector_SelectPath(selector, interest->chunkNumber, now);
+                sentAtMicros[i] = now;
+                SimulatedPath *path = &paths[interest->path];
+                interest->isAnswered = !path->isDead;
+                path->nextFreeMicros = ((now > path->nextFreeMicros) ? now : path->nextFreeMicros) + path->serviceMicros;
+                interest->answeredAtMicros = path->nextFreeMicros + path->delayMicros;
+            }
+        }
+
+        while (numOutstanding < windowSize && nextChunk < numChunks) {
+            SimulatedInterest *interest = &interests[numOutstanding];
+            interest->chunkNumber = nextChunk++;
+            interest->path = ccnxSimpleFileTransferPathSelector_SelectPath(selector, interest->chunkNumber, now);
+            sentAtMicros[numOutstanding] = now;
+            SimulatedPath *path = &paths[interest->path];
+            interest->isAnswered = !path->isDead;
+            path->nextFreeMicros = ((now > path->nextFreeMicros) ? now : path->nextFreeMicros) + path->serviceMicros;
+            interest->answeredAtMicros = path->nextFreeMicros + path->delayMicros;
+            numOutstanding++;
+        }
+    }
+
+    parcMemory_Deallocate((void **) &sentAtMicros);
+    parcMemory_Deallocate((void **) &interests);
+}
+
+LONGBOW_TEST_CASE(Global, createRelease)
+{
+    CCNxSimpleFileTransferPathSelector *selector = ccnxSimpleFileTransferPathSelector_Create(3, 64);
+    assertNotNull(selector, "Expected a non-NULL selector");
+    assertTrue(ccnxSimpleFileTransferPathSelector_GetNumPaths(selector) == 3, "Expected 3 paths");
+    for (size_t i = 0; i < 3; i++) {
+        assertTrue(ccnxSimpleFileTransferPathSelector_IsPathUp(selector, i), "Expected path %zu to be up", i);
+    }
+
+    CCNxSimpleFileTransferPathSelector *reference = ccnxSimpleFileTransferPathSelector_Acquire(selector);
+    ccnxSimpleFileTransferPathSelector_Release(&selector);
+    assertNull(selector, "Expected Release to NULL the pointer");
+    ccnxSimpleFileTransferPathSelector_Release(&reference);
+}
+
+LONGBOW_TEST_CASE(Global, spread)
+{
+    CCNxSimpleFileTransferPathSelector *selector = ccnxSimpleFileTransferPathSelector_Create(3, 64);
+
+    // With nothing measured, the paths take turns.
+    for (uint64_t chunk = 0; chunk < 30; chunk++) {
+        ccnxSimpleFileTransferPathSelector_SelectPath(selector, chunk, 0);
+    }
+    for (size_t i = 0; i < 3; i++) {
+        assertTrue(ccnxSimpleFileTransferPathSelector_GetNumOutstanding(selector, i) == 10,
+                   "Expected 10 Interests on path %zu", i);
+    }
+
+    // A chunk arriving on another path than it was sent on still leaves the path it was sent on.
+    size_t path = ccnxSimpleFileTransferPathSelector_SelectPath(selector, 30, 0);
+    ccnxSimpleFileTransferPathSelector_Receive(selector, 30, (path + 1) % 3, 1000, 500);
+    assertTrue(ccnxSimpleFileTransferPathSelector_GetNumOutstanding(selector, path) == 10, "Expected 10 Interests on path %zu", path);
+    assertTrue(ccnxSimpleFileTransferPathSelector_GetNumChunksReceived(selector, (path + 1) % 3) == 1,
+               "Expected the chunk to count for the path it arrived on");
+    assertTrue(ccnxSimpleFileTransferPathSelector_GetSmoothedRttMicros(selector, path) == 0,
+               "Expected no round trip time from a chunk that arrived on another path");
+
+    ccnxSimpleFileTransferPathSelector_Release(&selector);
+}
+
+LONGBOW_TEST_CASE(Global, proportional)
+{
+    CCNxSimpleFileTransferPathSelector *selector = ccnxSimpleFileTransferPathSelector_Create(2, 4096);
+
+    // Path 0 has three times the bandwidth of path 1, and half its delay.
+    SimulatedPath paths[2] = {
+        { .delayMicros = 2000, .serviceMicros = 100 },
+        { .delayMicros = 4000, .serviceMicros = 300 },
+    };
+    _simulateFetch(selector, paths, 128, 20000, 1000 * 1000);
+
+    uint64_t numOnFast = ccnxSimpleFileTransferPathSelector_GetNumChunksReceived(selector, 0);
+    uint64_t numOnSlow = ccnxSimpleFileTransferPathSelector_GetNumChunksReceived(selector, 1);
+    assertTrue(numOnFast + numOnSlow == 20000, "Expected 20000 chunks, got %" PRIu64, numOnFast + numOnSlow);
+    double fastShare = (double) numOnFast / 20000.0;
+    assertTrue(fastShare > 0.65 && fastShare < 0.85, "Expected about 3/4 of the chunks on the fast path, got %.3f", fastShare);
+    assertTrue(ccnxSimpleFileTransferPathSelector_GetNumTimeouts(selector, 0) == 0, "Expected no timeouts");
+    assertTrue(ccnxSimpleFileTransferPathSelector_GetNumTimeouts(selector, 1) == 0, "Expected no timeouts");
+
+    ccnxSimpleFileTransferPathSelector_Release(&selector);
+}
+
+LONGBOW_TEST_CASE(Global, failover)
+{
+    CCNxSimpleFileTransferPathSelector *selector = ccnxSimpleFileTransferPathSelector_Create(2, 4096);
+
+    SimulatedPath paths[2] = {
+        { .delayMicros = 2000, .serviceMicros = 100 },
+        { .delayMicros = 2000, .serviceMicros = 100, .isDead = true },
+    };
+    _simulateFetch(selector, paths, 64, 5000, 20 * 1000);
+
+    assertFalse(ccnxSimpleFileTransferPathSelector_IsPathUp(selector, 1), "Expected the dead path to be down");
+    assertTrue(ccnxSimpleFileTransferPathSelector_GetNumChunksReceived(selector, 0) == 5000,
+               "Expected every chunk on the live path");
+    assertTrue(ccnxSimpleFileTransferPathSelector_GetNumOutstanding(selector, 1) <= 1,
+               "Expected at most a probe on the dead path");
+    // Each probe waits out a timeout. Most chunks shouldn't have been sent on the dead path.
+    assertTrue(ccnxSimpleFileTransferPathSelector_GetNumTimeouts(selector, 1) < 100,
+               "Expected few Interests on the dead path, got %" PRIu64,
+               ccnxSimpleFileTransferPathSelector_GetNumTimeouts(selector, 1));
+
+    // When the path comes back, its probe is answered, and it's used again.
+    paths[1].isDead = false;
+    _simulateFetch(selector, paths, 64, 5000, 20 * 1000);
+    assertTrue(ccnxSimpleFileTransferPathSelector_IsPathUp(selector, 1), "Expected the path to be up again");
+    assertTrue(ccnxSimpleFileTransferPathSelector_GetNumChunksReceived(selector, 1) > 1000,
+               "Expected the path to be used again, got %" PRIu64,
+               ccnxSimpleFileTransferPathSelector_GetNumChunksReceived(selector, 1));
+
+    ccnxSimpleFileTransferPathSelector_Release(&selector);
+}
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(ccnxSimpleFileTransfer_PathSelector);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
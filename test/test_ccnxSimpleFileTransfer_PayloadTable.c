@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../ccnxSimpleFileTransfer_PayloadTable.c"
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+#include <stdio.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+LONGBOW_TEST_RUNNER(ccnxSimpleFileTransfer_PayloadTable)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(ccnxSimpleFileTransfer_PayloadTable)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(ccnxSimpleFileTransfer_PayloadTable)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, createRelease);
+    LONGBOW_RUN_TEST_CASE(Global, intern);
+    LONGBOW_RUN_TEST_CASE(Global, forgetUnused);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+static PARCBuffer *
+_createPayload(size_t length, uint8_t fill)
+{
+    PARCBuffer *result = parcBuffer_Allocate(length);
+    memset(parcBuffer_Overlay(result, 0), fill, length);
+    return result;
+}
+
+LONGBOW_TEST_CASE(Global, createRelease)
+{
+    CCNxSimpleFileTransferPayloadTable *table = ccnxSimpleFileTransferPayloadTable_Create();
+    assertNotNull(table, "Expected a non-NULL table");
+    assertTrue(ccnxSimpleFileTransferPayloadTable_GetSize(table) == 0, "Expected an empty table");
+
+    CCNxSimpleFileTransferPayloadTable *reference = ccnxSimpleFileTransferPayloadTable_Acquire(table);
+    ccnxSimpleFileTransferPayloadTable_Release(&table);
+    assertNull(table, "Expected Release to NULL the pointer");
+    ccnxSimpleFileTransferPayloadTable_Release(&reference);
+}
+
+LONGBOW_TEST_CASE(Global, intern)
+{
+    CCNxSimpleFileTransferPayloadTable *table = ccnxSimpleFileTransferPayloadTable_Create();
+
+    PARCBuffer *a = _createPayload(1200, 'a');
+    PARCBuffer *sameAsA = _createPayload(1200, 'a');
+    PARCBuffer *b = _createPayload(1200, 'b');
+    PARCBuffer *shorterA = _createPayload(17, 'a');
+
+    PARCBuffer *internedA = ccnxSimpleFileTransferPayloadTable_Intern(table, a);
+    assertTrue(internedA == a, "Expected the first payload to be added");
+    PARCBuffer *internedSameAsA = ccnxSimpleFileTransferPayloadTable_Intern(table, sameAsA);
+    assertTrue(internedSameAsA == a, "Expected an identical payload to share the first");
+    PARCBuffer *internedB = ccnxSimpleFileTransferPayloadTable_Intern(table, b);
+    assertTrue(internedB == b, "Expected a different payload to be added");
+    PARCBuffer *internedShorterA = ccnxSimpleFileTransferPayloadTable_Intern(table, shorterA);
+    assertTrue(internedShorterA == shorterA, "Expected a payload of another length to be added");
+    assertTrue(ccnxSimpleFileTransferPayloadTable_GetSize(table) == 3, "Expected 3 distinct payloads");
+
+    parcBuffer_Release(&a);
+    parcBuffer_Release(&sameAsA);
+    parcBuffer_Release(&b);
+    parcBuffer_Release(&shorterA);
+
+    // 'a' is used twice, 'b' and the short 'a' once.
+    uint64_t bytesUsed = 0;
+    uint64_t bytesStored = 0;
+    ccnxSimpleFileTransferPayloadTable_GetUsage(table, &bytesUsed, &bytesStored);
+    assertTrue(bytesUsed == 3 * 1200 + 17, "Expected %u bytes used, got %" PRIu64, 3 * 1200 + 17, bytesUsed);
+    assertTrue(bytesStored == 2 * 1200 + 17, "Expected %u bytes stored, got %" PRIu64, 2 * 1200 + 17, bytesStored);
+
+    parcBuffer_Release(&internedA);
+    parcBuffer_Release(&internedSameAsA);
+    parcBuffer_Release(&internedB);
+    parcBuffer_Release(&internedShorterA);
+
+    ccnxSimpleFileTransferPayloadTable_GetUsage(table, &bytesUsed, &bytesStored);
+    assertTrue(bytesUsed == 0 && bytesStored == 0, "Expected nothing in use once every chunk is released");
+
+    ccnxSimpleFileTransferPayloadTable_Release(&table);
+}
+
+LONGBOW_TEST_CASE(Global, forgetUnused)
+{
+    CCNxSimpleFileTransferPayloadTable *table = ccnxSimpleFileTransferPayloadTable_Create();
+
+    // Many more distinct payloads than the table starts with buckets, none kept: the table forgets them rather
+    // than growing.
+    for (uint32_t i = 0; i < 10 * _initialNumBuckets; i++) {
+        PARCBuffer *payload = parcBuffer_Allocate(sizeof(i));
+        parcBuffer_Flip(parcBuffer_PutUint32(payload, i));
+        PARCBuffer *interned = ccnxSimpleFileTransferPayloadTable_Intern(table, payload);
+        parcBuffer_Release(&interned);
+        parcBuffer_Release(&payload);
+    }
+    assertTrue(ccnxSimpleFileTransferPayloadTable_GetSize(table) <= _initialNumBuckets, "Expected unused payloads to be forgotten");
+    assertTrue(table->numBuckets == _initialNumBuckets, "Did not expect the table to grow");
+
+    // Payloads still in use are kept, and the table grows to hold them.
+    PARCBuffer *kept[2 * _initialNumBuckets];
+    for (uint32_t i = 0; i < 2 * _initialNumBuckets; i++) {
+        PARCBuffer *payload = parcBuffer_Allocate(sizeof(i));
+        parcBuffer_Flip(parcBuffer_PutUint32(payload, i));
+        kept[i] = ccnxSimpleFileTransferPayloadTable_Intern(table, payload);
+        parcBuffer_Release(&payload);
+    }
+    assertTrue(ccnxSimpleFileTransferPayloadTable_GetSize(table) >= 2 * _initialNumBuckets, "Expected the payloads in use to be kept");
+    assertTrue(table->numBuckets > _initialNumBuckets, "Expected the table to grow");
+
+    for (uint32_t i = 0; i < 2 * _initialNumBuckets; i++) {
+        PARCBuffer *payload = parcBuffer_Allocate(sizeof(i));
+        parcBuffer_Flip(parcBuffer_PutUint32(payload, i));
+        PARCBuffer *interned = ccnxSimpleFileTransferPayloadTable_Intern(table, payload);
+        assertTrue(interned == kept[i], "Expected payload %u to still be shared", i);
+        parcBuffer_Release(&interned);
+        parcBuffer_Release(&payload);
+        parcBuffer_Release(&kept[i]);
+    }
+
+    ccnxSimpleFileTransferPayloadTable_Release(&table);
+}
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(ccnxSimpleFileTransfer_PayloadTable);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
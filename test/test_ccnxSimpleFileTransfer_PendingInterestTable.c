@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../ccnxSimpleFileTransfer_PendingInterestTable.c"
+#include "../ccnxSimpleFileTransfer_TimerWheel.c"
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+#include <inttypes.h>
+#include <unistd.h>
+
+LONGBOW_TEST_RUNNER(ccnxSimpleFileTransfer_PendingInterestTable)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(ccnxSimpleFileTransfer_PendingInterestTable)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(ccnxSimpleFileTransfer_PendingInterestTable)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, createRelease);
+    LONGBOW_RUN_TEST_CASE(Global, insertGetRemove);
+    LONGBOW_RUN_TEST_CASE(Global, timeouts);
+    LONGBOW_RUN_TEST_CASE(Global, manyEntries);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_CASE(Global, createRelease)
+{
+    CCNxSimpleFileTransferPendingInterestTable *table = ccnxSimpleFileTransferPendingInterestTable_Create(16, 1000, 0);
+    assertNotNull(table, "Expected a non-NULL table");
+    assertTrue(ccnxSimpleFileTransferPendingInterestTable_GetCapacity(table) == 16, "Expected a capacity of 16");
+    assertTrue(ccnxSimpleFileTransferPendingInterestTable_GetSize(table) == 0, "Expected an empty table");
+
+    CCNxSimpleFileTransferPendingInterestTable *reference = ccnxSimpleFileTransferPendingInterestTable_Acquire(table);
+    ccnxSimpleFileTransferPendingInterestTable_Release(&table);
+    assertNull(table, "Expected Release to NULL the pointer");
+    ccnxSimpleFileTransferPendingInterestTable_Release(&reference);
+}
+
+LONGBOW_TEST_CASE(Global, insertGetRemove)
+{
+    // Fewer buckets than the chunk numbers used, so some share a bucket.
+    CCNxSimpleFileTransferPendingInterestTable *table = ccnxSimpleFileTransferPendingInterestTable_Create(10, 1000, 0);
+
+    CCNxSimpleFileTransferPendingInterest *entries[10];
+    for (uint64_t i = 0; i < 10; i++) {
+        entries[i] = ccnxSimpleFileTransferPendingInterestTable_Insert(table, i * 3);
+        assertNotNull(entries[i], "Expected room for chunk %" PRIu64, i * 3);
+        assertTrue(entries[i]->chunkNumber == i * 3, "Expected the entry to be for chunk %" PRIu64, i * 3);
+        assertTrue(entries[i]->numTransmissions == 0, "Expected a new entry not to have been sent");
+    }
+    assertNull(ccnxSimpleFileTransferPendingInterestTable_Insert(table, 100), "Expected a full table to refuse an entry");
+    assertTrue(ccnxSimpleFileTransferPendingInterestTable_GetSize(table) == 10, "Expected 10 entries");
+
+    for (uint64_t i = 0; i < 30; i++) {
+        CCNxSimpleFileTransferPendingInterest *entry = ccnxSimpleFileTransferPendingInterestTable_Get(table, i);
+        if (i % 3 == 0) {
+            assertTrue(entry == entries[i / 3], "Expected to find chunk %" PRIu64, i);
+        } else {
+            assertNull(entry, "Expected not to find chunk %" PRIu64, i);
+        }
+    }
+
+    ccnxSimpleFileTransferPendingInterestTable_Remove(table, entries[4]);
+    ccnxSimpleFileTransferPendingInterestTable_Remove(table, entries[0]);
+    assertNull(ccnxSimpleFileTransferPendingInterestTable_Get(table, 12), "Expected chunk 12 to be gone");
+    assertNull(ccnxSimpleFileTransferPendingInterestTable_Get(table, 0), "Expected chunk 0 to be gone");
+    assertTrue(ccnxSimpleFileTransferPendingInterestTable_Get(table, 27) == entries[9], "Expected chunk 27 to remain");
+    assertTrue(ccnxSimpleFileTransferPendingInterestTable_GetSize(table) == 8, "Expected 8 entries");
+
+    CCNxSimpleFileTransferPendingInterest *entry = ccnxSimpleFileTransferPendingInterestTable_Insert(table, 100);
+    assertNotNull(entry, "Expected a removed entry to be reused");
+    assertTrue(ccnxSimpleFileTransferPendingInterestTable_Get(table, 100) == entry, "Expected to find chunk 100");
+
+    ccnxSimpleFileTransferPendingInterestTable_Release(&table);
+}
+
+LONGBOW_TEST_CASE(Global, timeouts)
+{
+    CCNxSimpleFileTransferPendingInterestTable *table = ccnxSimpleFileTransferPendingInterestTable_Create(4, 1000, 0);
+
+    CCNxSimpleFileTransferPendingInterest *first = ccnxSimpleFileTransferPendingInterestTable_Insert(table, 1);
+    CCNxSimpleFileTransferPendingInterest *second = ccnxSimpleFileTransferPendingInterestTable_Insert(table, 2);
+    CCNxSimpleFileTransferPendingInterest *third = ccnxSimpleFileTransferPendingInterestTable_Insert(table, 3);
+    ccnxSimpleFileTransferPendingInterestTable_SetTimeout(table, first, 5000);
+    ccnxSimpleFileTransferPendingInterestTable_SetTimeout(table, second, 3000);
+    ccnxSimpleFileTransferPendingInterestTable_SetTimeout(table, third, 4000);
+    assertTrue(ccnxSimpleFileTransferPendingInterestTable_GetNextTimeoutMicros(table) == 3000, "Expected the next timeout at 3000");
+
+    // Removing an entry cancels its timeout.
+    ccnxSimpleFileTransferPendingInterestTable_Remove(table, third);
+
+    assertNull(ccnxSimpleFileTransferPendingInterestTable_TakeTimedOut(table, 2000), "Expected nothing to time out yet");
+    assertTrue(ccnxSimpleFileTransferPendingInterestTable_TakeTimedOut(table, 10000) == second, "Expected chunk 2 to time out first");
+    assertTrue(ccnxSimpleFileTransferPendingInterestTable_TakeTimedOut(table, 10000) == first, "Expected chunk 1 to time out next");
+    assertNull(ccnxSimpleFileTransferPendingInterestTable_TakeTimedOut(table, 10000), "Expected nothing else to time out");
+
+    // A timed out entry stays in the table until it is removed.
+    assertTrue(ccnxSimpleFileTransferPendingInterestTable_Get(table, 1) == first, "Expected chunk 1 to remain");
+    assertTrue(ccnxSimpleFileTransferPendingInterestTable_GetSize(table) == 2, "Expected 2 entries");
+
+    ccnxSimpleFileTransferPendingInterestTable_SetTimeout(table, first, 20000);
+    assertNull(ccnxSimpleFileTransferPendingInterestTable_TakeTimedOut(table, 19000), "Expected the new timeout not to be due yet");
+    assertTrue(ccnxSimpleFileTransferPendingInterestTable_TakeTimedOut(table, 20000) == first, "Expected chunk 1 to time out again");
+
+    ccnxSimpleFileTransferPendingInterestTable_Release(&table);
+}
+
+LONGBOW_TEST_CASE(Global, manyEntries)
+{
+    const size_t capacity = 100000;
+    CCNxSimpleFileTransferPendingInterestTable *table = ccnxSimpleFileTransferPendingInterestTable_Create(capacity, 1000, 0);
+
+    for (uint64_t i = 0; i < capacity; i++) {
+        CCNxSimpleFileTransferPendingInterest *entry = ccnxSimpleFileTransferPendingInterestTable_Insert(table, i);
+        ccnxSimpleFileTransferPendingInterestTable_SetTimeout(table, entry, 1000 * (1 + i % 1000));
+    }
+    assertTrue(ccnxSimpleFileTransferPendingInterestTable_GetSize(table) == capacity, "Expected a full table");
+
+    // Slide the window along: each chunk that arrives is replaced by the next one.
+    for (uint64_t i = 0; i < capacity; i++) {
+        CCNxSimpleFileTransferPendingInterest *entry = ccnxSimpleFileTransferPendingInterestTable_Get(table, i);
+        assertNotNull(entry, "Expected to find chunk %" PRIu64, i);
+        ccnxSimpleFileTransferPendingInterestTable_Remove(table, entry);
+        entry = ccnxSimpleFileTransferPendingInterestTable_Insert(table, i + capacity);
+        ccnxSimpleFileTransferPendingInterestTable_SetTimeout(table, entry, 2000 * 1000);
+    }
+    assertNull(ccnxSimpleFileTransferPendingInterestTable_TakeTimedOut(table, 1999 * 1000), "Expected nothing to time out yet");
+
+    size_t numTimedOut = 0;
+    while (ccnxSimpleFileTransferPendingInterestTable_TakeTimedOut(table, 2000 * 1000) != NULL) {
+        numTimedOut++;
+    }
+    assertTrue(numTimedOut == capacity, "Expected %zu timeouts, got %zu", capacity, numTimedOut);
+
+    ccnxSimpleFileTransferPendingInterestTable_Release(&table);
+}
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(ccnxSimpleFileTransfer_PendingInterestTable);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
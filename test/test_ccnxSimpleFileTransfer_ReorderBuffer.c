@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../ccnxSimpleFileTransfer_ReorderBuffer.c"
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+LONGBOW_TEST_RUNNER(ccnxSimpleFileTransfer_ReorderBuffer)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(ccnxSimpleFileTransfer_ReorderBuffer)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(ccnxSimpleFileTransfer_ReorderBuffer)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, createRelease);
+    LONGBOW_RUN_TEST_CASE(Global, inOrder);
+    LONGBOW_RUN_TEST_CASE(Global, outOfOrder);
+    LONGBOW_RUN_TEST_CASE(Global, outsideWindow);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+static PARCBuffer *
+_createPayload(uint64_t chunkNumber)
+{
+    PARCBuffer *result = parcBuffer_Allocate(sizeof(uint64_t));
+    parcBuffer_PutUint64(result, chunkNumber);
+    return parcBuffer_Flip(result);
+}
+
+LONGBOW_TEST_CASE(Global, createRelease)
+{
+    CCNxSimpleFileTransferReorderBuffer *reorderBuffer = ccnxSimpleFileTransferReorderBuffer_Create(16);
+    CCNxSimpleFileTransferReorderBuffer *ref = ccnxSimpleFileTransferReorderBuffer_Acquire(reorderBuffer);
+
+    assertTrue(ccnxSimpleFileTransferReorderBuffer_GetWindowSize(reorderBuffer) == 16, "Expected a window size of 16");
+    assertTrue(ccnxSimpleFileTransferReorderBuffer_GetNextChunkNumber(reorderBuffer) == 0, "Expected to start at chunk 0");
+
+    ccnxSimpleFileTransferReorderBuffer_Release(&reorderBuffer);
+    ccnxSimpleFileTransferReorderBuffer_Release(&ref);
+}
+
+LONGBOW_TEST_CASE(Global, inOrder)
+{
+    CCNxSimpleFileTransferReorderBuffer *reorderBuffer = ccnxSimpleFileTransferReorderBuffer_Create(4);
+
+    for (uint64_t i = 0; i < 10; i++) {
+        PARCBuffer *payload = _createPayload(i);
+        assertTrue(ccnxSimpleFileTransferReorderBuffer_Put(reorderBuffer, i, payload), "Expected chunk %" PRIu64 " to be accepted", i);
+        parcBuffer_Release(&payload);
+
+        PARCBuffer *next = ccnxSimpleFileTransferReorderBuffer_TakeNext(reorderBuffer);
+        assertNotNull(next, "Expected chunk %" PRIu64 " to be delivered", i);
+        assertTrue(parcBuffer_GetUint64(next) == i, "Expected the payload of chunk %" PRIu64, i);
+        parcBuffer_Release(&next);
+    }
+
+    assertTrue(ccnxSimpleFileTransferReorderBuffer_GetNextChunkNumber(reorderBuffer) == 10, "Expected 10 chunks delivered");
+
+    ccnxSimpleFileTransferReorderBuffer_Release(&reorderBuffer);
+}
+
+LONGBOW_TEST_CASE(Global, outOfOrder)
+{
+    CCNxSimpleFileTransferReorderBuffer *reorderBuffer = ccnxSimpleFileTransferReorderBuffer_Create(4);
+
+    uint64_t arrivalOrder[] = { 2, 1, 3, 0 };
+    for (int i = 0; i < 4; i++) {
+        PARCBuffer *payload = _createPayload(arrivalOrder[i]);
+        ccnxSimpleFileTransferReorderBuffer_Put(reorderBuffer, arrivalOrder[i], payload);
+        parcBuffer_Release(&payload);
+
+        if (arrivalOrder[i] != 0) {
+            assertNull(ccnxSimpleFileTransferReorderBuffer_TakeNext(reorderBuffer), "Expected nothing until chunk 0 arrives");
+        }
+    }
+
+    assertTrue(ccnxSimpleFileTransferReorderBuffer_GetCount(reorderBuffer) == 4, "Expected 4 chunks held");
+
+    for (uint64_t i = 0; i < 4; i++) {
+        PARCBuffer *next = ccnxSimpleFileTransferReorderBuffer_TakeNext(reorderBuffer);
+        assertNotNull(next, "Expected chunk %" PRIu64 " to be delivered", i);
+        assertTrue(parcBuffer_GetUint64(next) == i, "Expected the payload of chunk %" PRIu64, i);
+        parcBuffer_Release(&next);
+    }
+    assertNull(ccnxSimpleFileTransferReorderBuffer_TakeNext(reorderBuffer), "Expected nothing more");
+    assertTrue(ccnxSimpleFileTransferReorderBuffer_GetCount(reorderBuffer) == 0, "Expected no chunks held");
+
+    ccnxSimpleFileTransferReorderBuffer_Release(&reorderBuffer);
+}
+
+LONGBOW_TEST_CASE(Global, outsideWindow)
+{
+    CCNxSimpleFileTransferReorderBuffer *reorderBuffer = ccnxSimpleFileTransferReorderBuffer_Create(4);
+    PARCBuffer *payload = _createPayload(0);
+
+    assertTrue(ccnxSimpleFileTransferReorderBuffer_Put(reorderBuffer, 3, payload), "Expected chunk 3 to fit in the window");
+    assertFalse(ccnxSimpleFileTransferReorderBuffer_Put(reorderBuffer, 4, payload), "Expected chunk 4 to be outside the window");
+
+    assertTrue(ccnxSimpleFileTransferReorderBuffer_Put(reorderBuffer, 0, payload), "Expected chunk 0 to be accepted");
+    PARCBuffer *next = ccnxSimpleFileTransferReorderBuffer_TakeNext(reorderBuffer);
+    parcBuffer_Release(&next);
+
+    // Now that chunk 0 has been delivered, the window has moved on.
+    assertTrue(ccnxSimpleFileTransferReorderBuffer_Put(reorderBuffer, 4, payload), "Expected chunk 4 to fit in the window");
+
+    // A chunk that was already delivered is a harmless duplicate.
+    assertTrue(ccnxSimpleFileTransferReorderBuffer_Put(reorderBuffer, 0, payload), "Expected a duplicate to be accepted");
+    assertTrue(ccnxSimpleFileTransferReorderBuffer_GetCount(reorderBuffer) == 2, "Expected 2 chunks held");
+
+    parcBuffer_Release(&payload);
+    ccnxSimpleFileTransferReorderBuffer_Release(&reorderBuffer);
+}
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(ccnxSimpleFileTransfer_ReorderBuffer);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../ccnxSimpleFileTransfer_TimerWheel.c"
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+#include <unistd.h>
+
+LONGBOW_TEST_RUNNER(ccnxSimpleFileTransfer_TimerWheel)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(ccnxSimpleFileTransfer_TimerWheel)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(ccnxSimpleFileTransfer_TimerWheel)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, createRelease);
+    LONGBOW_RUN_TEST_CASE(Global, expire);
+    LONGBOW_RUN_TEST_CASE(Global, cancel);
+    LONGBOW_RUN_TEST_CASE(Global, levels);
+    LONGBOW_RUN_TEST_CASE(Global, manyTimers);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_CASE(Global, createRelease)
+{
+    CCNxSimpleFileTransferTimerWheel *wheel = ccnxSimpleFileTransferTimerWheel_Create(1000, 0);
+    CCNxSimpleFileTransferTimerWheel *ref = ccnxSimpleFileTransferTimerWheel_Acquire(wheel);
+
+    assertTrue(ccnxSimpleFileTransferTimerWheel_GetSize(wheel) == 0, "Expected an empty wheel");
+    assertTrue(ccnxSimpleFileTransferTimerWheel_GetNextExpiryMicros(wheel) == UINT64_MAX, "Expected no timer to expire");
+    assertNull(ccnxSimpleFileTransferTimerWheel_TakeExpired(wheel, 1000000), "Expected no expired timer");
+
+    ccnxSimpleFileTransferTimerWheel_Release(&wheel);
+    ccnxSimpleFileTransferTimerWheel_Release(&ref);
+}
+
+LONGBOW_TEST_CASE(Global, expire)
+{
+    CCNxSimpleFileTransferTimerWheel *wheel = ccnxSimpleFileTransferTimerWheel_Create(1000, 0);
+
+    CCNxSimpleFileTransferTimer timers[3];
+    for (int i = 0; i < 3; i++) {
+        ccnxSimpleFileTransferTimer_Init(&timers[i]);
+    }
+    ccnxSimpleFileTransferTimerWheel_Schedule(wheel, &timers[0], 5000);
+    ccnxSimpleFileTransferTimerWheel_Schedule(wheel, &timers[1], 2500);
+    ccnxSimpleFileTransferTimerWheel_Schedule(wheel, &timers[2], 5000);
+    assertTrue(ccnxSimpleFileTransferTimerWheel_GetSize(wheel) == 3, "Expected 3 timers");
+    assertTrue(ccnxSimpleFileTransferTimer_IsScheduled(&timers[1]), "Expected timer 1 to be scheduled");
+
+    // Timers never expire early, so the one due at 2500 waits for the tick at 3000.
+    assertTrue(ccnxSimpleFileTransferTimerWheel_GetNextExpiryMicros(wheel) == 3000, "Expected the next expiry at 3000");
+    assertNull(ccnxSimpleFileTransferTimerWheel_TakeExpired(wheel, 2999), "Expected nothing to expire before 3000");
+    assertTrue(ccnxSimpleFileTransferTimerWheel_TakeExpired(wheel, 3000) == &timers[1], "Expected timer 1 to expire");
+    assertFalse(ccnxSimpleFileTransferTimer_IsScheduled(&timers[1]), "Expected an expired timer not to be scheduled");
+    assertNull(ccnxSimpleFileTransferTimerWheel_TakeExpired(wheel, 3000), "Expected nothing else to expire");
+
+    assertTrue(ccnxSimpleFileTransferTimerWheel_TakeExpired(wheel, 10000) == &timers[0], "Expected timer 0 to expire");
+    assertTrue(ccnxSimpleFileTransferTimerWheel_TakeExpired(wheel, 10000) == &timers[2], "Expected timer 2 to expire");
+    assertNull(ccnxSimpleFileTransferTimerWheel_TakeExpired(wheel, 10000), "Expected nothing else to expire");
+    assertTrue(ccnxSimpleFileTransferTimerWheel_GetSize(wheel) == 0, "Expected an empty wheel");
+
+    // A time that has already passed is due at the next tick.
+    ccnxSimpleFileTransferTimerWheel_Schedule(wheel, &timers[0], 0);
+    assertNull(ccnxSimpleFileTransferTimerWheel_TakeExpired(wheel, 10000), "Expected nothing to expire in the current tick");
+    assertTrue(ccnxSimpleFileTransferTimerWheel_TakeExpired(wheel, 11000) == &timers[0], "Expected timer 0 to expire");
+
+    ccnxSimpleFileTransferTimerWheel_Release(&wheel);
+}
+
+LONGBOW_TEST_CASE(Global, cancel)
+{
+    CCNxSimpleFileTransferTimerWheel *wheel = ccnxSimpleFileTransferTimerWheel_Create(1000, 0);
+
+    CCNxSimpleFileTransferTimer timers[2];
+    for (int i = 0; i < 2; i++) {
+        ccnxSimpleFileTransferTimer_Init(&timers[i]);
+        ccnxSimpleFileTransferTimerWheel_Schedule(wheel, &timers[i], 2000);
+    }
+
+    ccnxSimpleFileTransferTimerWheel_Cancel(wheel, &timers[0]);
+    assertFalse(ccnxSimpleFileTransferTimer_IsScheduled(&timers[0]), "Expected a cancelled timer not to be scheduled");
+    ccnxSimpleFileTransferTimerWheel_Cancel(wheel, &timers[0]);
+    assertTrue(ccnxSimpleFileTransferTimerWheel_GetSize(wheel) == 1, "Expected 1 timer");
+
+    // Moving a timer takes it out of its old slot.
+    ccnxSimpleFileTransferTimerWheel_Schedule(wheel, &timers[1], 7000);
+    assertTrue(ccnxSimpleFileTransferTimerWheel_GetSize(wheel) == 1, "Expected 1 timer");
+    assertNull(ccnxSimpleFileTransferTimerWheel_TakeExpired(wheel, 6000), "Expected nothing to expire before 7000");
+    assertTrue(ccnxSimpleFileTransferTimerWheel_TakeExpired(wheel, 7000) == &timers[1], "Expected timer 1 to expire");
+
+    // A timer that has expired but not been taken can still be cancelled.
+    ccnxSimpleFileTransferTimerWheel_Schedule(wheel, &timers[0], 8000);
+    ccnxSimpleFileTransferTimerWheel_Schedule(wheel, &timers[1], 8000);
+    assertTrue(ccnxSimpleFileTransferTimerWheel_TakeExpired(wheel, 9000) == &timers[0], "Expected timer 0 to expire");
+    ccnxSimpleFileTransferTimerWheel_Cancel(wheel, &timers[1]);
+    assertNull(ccnxSimpleFileTransferTimerWheel_TakeExpired(wheel, 9000), "Expected the cancelled timer not to be taken");
+    assertTrue(ccnxSimpleFileTransferTimerWheel_GetSize(wheel) == 0, "Expected an empty wheel");
+
+    ccnxSimpleFileTransferTimerWheel_Release(&wheel);
+}
+
+LONGBOW_TEST_CASE(Global, levels)
+{
+    CCNxSimpleFileTransferTimerWheel *wheel = ccnxSimpleFileTransferTimerWheel_Create(1000, 0);
+
+    // Due in the first level, the second, the third, the fourth, and beyond the top level.
+    uint64_t dueMicros[] = { 5000, 100 * 1000, 10 * 1000 * 1000, 3600ULL * 1000 * 1000, 100ULL * 365 * 24 * 3600 * 1000 * 1000 };
+    CCNxSimpleFileTransferTimer timers[5];
+    for (int i = 4; i >= 0; i--) {
+        ccnxSimpleFileTransferTimer_Init(&timers[i]);
+        ccnxSimpleFileTransferTimerWheel_Schedule(wheel, &timers[i], dueMicros[i]);
+    }
+    assertTrue(ccnxSimpleFileTransferTimerWheel_GetNextExpiryMicros(wheel) == 5000, "Expected the next expiry at 5000");
+
+    for (int i = 0; i < 5; i++) {
+        assertNull(ccnxSimpleFileTransferTimerWheel_TakeExpired(wheel, dueMicros[i] - 1000),
+                   "Expected timer %d not to expire early", i);
+        uint64_t nextExpiryMicros = ccnxSimpleFileTransferTimerWheel_GetNextExpiryMicros(wheel);
+        assertTrue(nextExpiryMicros <= dueMicros[i], "Expected the next expiry no later than timer %d", i);
+        assertTrue(ccnxSimpleFileTransferTimerWheel_TakeExpired(wheel, dueMicros[i]) == &timers[i], "Expected timer %d to expire", i);
+    }
+    assertTrue(ccnxSimpleFileTransferTimerWheel_GetSize(wheel) == 0, "Expected an empty wheel");
+
+    ccnxSimpleFileTransferTimerWheel_Release(&wheel);
+}
+
+LONGBOW_TEST_CASE(Global, manyTimers)
+{
+    const size_t numTimers = 50000;
+    CCNxSimpleFileTransferTimerWheel *wheel = ccnxSimpleFileTransferTimerWheel_Create(1000, 0);
+    CCNxSimpleFileTransferTimer *timers = parcMemory_AllocateAndClear(numTimers * sizeof(CCNxSimpleFileTransferTimer));
+
+    for (size_t i = 0; i < numTimers; i++) {
+        ccnxSimpleFileTransferTimer_Init(&timers[i]);
+        // Spread over ten minutes, so the timers start in the first three levels.
+        ccnxSimpleFileTransferTimerWheel_Schedule(wheel, &timers[i], (uint64_t) ((i * 7919) % 600000) * 1000 + 1000);
+    }
+    for (size_t i = 0; i < numTimers; i += 2) {
+        ccnxSimpleFileTransferTimerWheel_Cancel(wheel, &timers[i]);
+    }
+    assertTrue(ccnxSimpleFileTransferTimerWheel_GetSize(wheel) == numTimers / 2, "Expected %zu timers", numTimers / 2);
+
+    size_t numExpired = 0;
+    uint64_t lastDueTick = 0;
+    for (uint64_t now = 0; now <= 601000000; now += 10000) {
+        CCNxSimpleFileTransferTimer *timer;
+        while ((timer = ccnxSimpleFileTransferTimerWheel_TakeExpired(wheel, now)) != NULL) {
+            assertTrue((timer - timers) % 2 == 1, "Expected only the timers that weren't cancelled to expire");
+            assertTrue(timer->dueTick * 1000 <= now, "Expected no timer to expire early");
+            assertTrue(timer->dueTick * 1000 > now - 10000, "Expected no timer to expire late");
+            assertTrue(timer->dueTick >= lastDueTick, "Expected timers to expire in order");
+            lastDueTick = timer->dueTick;
+            numExpired++;
+        }
+    }
+    assertTrue(numExpired == numTimers / 2, "Expected %zu timers to expire, got %zu", numTimers / 2, numExpired);
+
+    parcMemory_Deallocate((void **) &timers);
+    ccnxSimpleFileTransferTimerWheel_Release(&wheel);
+}
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(ccnxSimpleFileTransfer_TimerWheel);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+
+// Include the file(s) containing the functions to be tested.
+// This permits internal static functions to be visible to this Test Framework.
+#include "../ccnxSimpleFileTransfer_Trace.c"
+
+#include <sys/stat.h>
+
+#include <parc/algol/parc_SafeMemory.h>
+#include <LongBow/unit-test.h>
+
+LONGBOW_TEST_RUNNER(ccnxSimpleFileTransfer_Trace)
+{
+    // The following Test Fixtures will run their corresponding Test Cases.
+    // Test Fixtures are run in the order specified, but all tests should be idempotent.
+    // Never rely on the execution order of tests or share state between them.
+    LONGBOW_RUN_TEST_FIXTURE(Global);
+}
+
+// The Test Runner calls this function once before any Test Fixtures are run.
+LONGBOW_TEST_RUNNER_SETUP(ccnxSimpleFileTransfer_Trace)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+// The Test Runner calls this function once after all the Test Fixtures are run.
+LONGBOW_TEST_RUNNER_TEARDOWN(ccnxSimpleFileTransfer_Trace)
+{
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE(Global)
+{
+    LONGBOW_RUN_TEST_CASE(Global, disabled);
+    LONGBOW_RUN_TEST_CASE(Global, eventNames);
+    LONGBOW_RUN_TEST_CASE(Global, traceAndConvert);
+    LONGBOW_RUN_TEST_CASE(Global, ringWrapsToFile);
+    LONGBOW_RUN_TEST_CASE(Global, convertBadFile);
+}
+
+LONGBOW_TEST_FIXTURE_SETUP(Global)
+{
+    parcMemory_SetInterface(&PARCSafeMemoryAsPARCMemory);
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+LONGBOW_TEST_FIXTURE_TEARDOWN(Global)
+{
+    uint32_t outstandingAllocations = parcSafeMemory_ReportAllocation(STDERR_FILENO);
+    if (outstandingAllocations != 0) {
+        printf("%s leaks memory by %d allocations\n", longBowTestCase_GetName(testCase), outstandingAllocations);
+        return LONGBOW_STATUS_MEMORYLEAK;
+    }
+    return LONGBOW_STATUS_SUCCEEDED;
+}
+
+/**
+ * Convert the specified trace file to JSON and return it as a string, which must be freed.
+ */
+static char *
+_convertTrace(const char *traceFileName, int64_t *numEvents)
+{
+    char *result = NULL;
+    size_t resultLength = 0;
+    FILE *output = open_memstream(&result, &resultLength);
+
+    *numEvents = ccnxSimpleFileTransferTrace_WriteChromeTrace(traceFileName, output);
+    fclose(output);
+
+    return result;
+}
+
+LONGBOW_TEST_CASE(Global, disabled)
+{
+    assertFalse(ccnxSimpleFileTransferTrace_IsEnabled(), "Expected tracing to be disabled");
+    assertTrue(ccnxSimpleFileTransferTrace_StartInterest() == 0, "Expected no Interest identifier");
+    assertTrue(ccnxSimpleFileTransferTrace_Begin() == 0, "Expected no timestamp");
+
+    // Must be harmless.
+    ccnxSimpleFileTransferTrace_End(CCNxSimpleFileTransferTraceEvent_Send, 0);
+    ccnxSimpleFileTransferTrace_Flush();
+    ccnxSimpleFileTransferTrace_Close();
+}
+
+LONGBOW_TEST_CASE(Global, eventNames)
+{
+    assertTrue(strcmp(ccnxSimpleFileTransferTrace_GetEventName(CCNxSimpleFileTransferTraceEvent_Receive), "receive") == 0,
+               "Unexpected event name");
+    assertTrue(strcmp(ccnxSimpleFileTransferTrace_GetEventName(CCNxSimpleFileTransferTraceEvent_DiskRead), "disk_read") == 0,
+               "Unexpected event name");
+    assertTrue(strcmp(ccnxSimpleFileTransferTrace_GetEventName(CCNxSimpleFileTransferTraceEvent_NumEvents), "unknown") == 0,
+               "Unexpected event name");
+}
+
+LONGBOW_TEST_CASE(Global, traceAndConvert)
+{
+    char fileName[] = "/tmp/ccnxSimpleFileTransfer_testData-trace.XXXXXXXX";
+    mktemp(fileName);
+
+    assertTrue(ccnxSimpleFileTransferTrace_Open(fileName), "Expected to open '%s'", fileName);
+    assertTrue(ccnxSimpleFileTransferTrace_IsEnabled(), "Expected tracing to be enabled");
+
+    uint32_t interestId = ccnxSimpleFileTransferTrace_StartInterest();
+    assertTrue(interestId != 0, "Expected an Interest identifier");
+
+    uint64_t startTime = ccnxSimpleFileTransferTrace_Begin();
+    assertTrue(startTime != 0, "Expected a timestamp");
+    ccnxSimpleFileTransferTrace_End(CCNxSimpleFileTransferTraceEvent_DiskRead, startTime);
+
+    ccnxSimpleFileTransferTrace_Close();
+    assertFalse(ccnxSimpleFileTransferTrace_IsEnabled(), "Expected tracing to be disabled");
+
+    int64_t numEvents = 0;
+    char *json = _convertTrace(fileName, &numEvents);
+
+    assertTrue(numEvents == 2, "Expected 2 events, got %" PRId64, numEvents);
+    assertNotNull(strstr(json, "\"name\":\"receive\""), "Expected a receive event: %s", json);
+    assertNotNull(strstr(json, "\"name\":\"disk_read\""), "Expected a disk_read event: %s", json);
+    assertNotNull(strstr(json, "\"ph\":\"X\""), "Expected a complete event: %s", json);
+
+    free(json);
+    unlink(fileName);
+}
+
+LONGBOW_TEST_CASE(Global, ringWrapsToFile)
+{
+    char fileName[] = "/tmp/ccnxSimpleFileTransfer_testData-trace.XXXXXXXX";
+    mktemp(fileName);
+
+    assertTrue(ccnxSimpleFileTransferTrace_Open(fileName), "Expected to open '%s'", fileName);
+
+    // Record more events than fit in a ring, so some are written before Close.
+    size_t numRecorded = _RingCapacity + 10;
+    for (size_t i = 0; i < numRecorded; i++) {
+        ccnxSimpleFileTransferTrace_End(CCNxSimpleFileTransferTraceEvent_Build, ccnxSimpleFileTransferTrace_Begin());
+    }
+
+    struct stat fileStat;
+    stat(fileName, &fileStat);
+    assertTrue(fileStat.st_size == sizeof(_TraceFileHeader) + _RingCapacity * sizeof(_TraceRecord),
+               "Expected one full ring in the file");
+
+    ccnxSimpleFileTransferTrace_Close();
+
+    int64_t numEvents = 0;
+    char *json = _convertTrace(fileName, &numEvents);
+    assertTrue(numEvents == numRecorded, "Expected %zu events, got %" PRId64, numRecorded, numEvents);
+
+    free(json);
+    unlink(fileName);
+}
+
+LONGBOW_TEST_CASE(Global, convertBadFile)
+{
+    char fileName[] = "/tmp/ccnxSimpleFileTransfer_testData-trace.XXXXXXXX";
+    mktemp(fileName);
+
+    int64_t numEvents = 0;
+    char *json = _convertTrace(fileName, &numEvents);
+    assertTrue(numEvents == -1, "Expected a missing file to fail");
+    free(json);
+
+    FILE *file = fopen(fileName, "w");
+    fprintf(file, "not a trace file");
+    fclose(file);
+
+    json = _convertTrace(fileName, &numEvents);
+    assertTrue(numEvents == -1, "Expected a file without a trace header to fail");
+    free(json);
+
+    unlink(fileName);
+}
+
+int
+main(int argc, char *argv[])
+{
+    LongBowRunner *testRunner = LONGBOW_TEST_RUNNER_CREATE(ccnxSimpleFileTransfer_Trace);
+    int exitStatus = longBowMain(argc, argv, testRunner, NULL);
+    longBowTestRunner_Destroy(&testRunner);
+    exit(exitStatus);
+}